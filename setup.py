@@ -427,7 +427,12 @@ MACROS = {
     'mu':     [('SIMUPOP_MODULE', 'simuPOP_mu'),   ('MUTANTALLELE', None)] + STD_MACROS,
     'muop':   [('SIMUPOP_MODULE', 'simuPOP_muop'), ('MUTANTALLELE', None)] + OPT_MACROS,
     'lin':    [('SIMUPOP_MODULE', 'simuPOP_lin'),  ('LINEAGE', None)] + STD_MACROS,
-    'linop':  [('SIMUPOP_MODULE', 'simuPOP_linop'),('LINEAGE', None)] + OPT_MACROS
+    'linop':  [('SIMUPOP_MODULE', 'simuPOP_linop'),('LINEAGE', None)] + OPT_MACROS,
+    # a fixed-geometry profile: ploidy is a compile-time constant so that
+    # the compiler can unroll per-ploidy loops. Populations of any other
+    # ploidy are rejected by this module. A custom build may additionally
+    # fix the number of chromosomes with ('FIXED_NUMCHROM', '24').
+    'fixop':  [('SIMUPOP_MODULE', 'simuPOP_fixop'),('FIXED_PLOIDY', '2')] + OPT_MACROS
 }
 
 WRAP_INFO = {
@@ -441,6 +446,7 @@ WRAP_INFO = {
     'muop':   ['src/simuPOP_muop_wrap.cpp', 'src/simuPOP_muop.i', '-DMUTANTALLELE -DOPTIMIZED'],
     'lin':    ['src/simuPOP_lin_wrap.cpp', 'src/simuPOP_lin.i', '-DLINEAGE'],
     'linop':  ['src/simuPOP_linop_wrap.cpp', 'src/simuPOP_linop.i', '-DLINEAGE -DOPTIMIZED'],
+    'fixop':  ['src/simuPOP_fixop_wrap.cpp', 'src/simuPOP_fixop.i', '-DOPTIMIZED -DFIXED_PLOIDY=2'],
 }
 
 
@@ -642,7 +648,7 @@ if __name__ == '__main__':
         # only build and test half of the modules to save time
         MODULES = ['std', 'ba', 'la', 'mu', 'lin']
     else:
-        MODULES = ['std', 'op', 'ba', 'baop', 'la', 'laop', 'mu', 'muop', 'lin', 'linop']
+        MODULES = ['std', 'op', 'ba', 'baop', 'la', 'laop', 'mu', 'muop', 'lin', 'linop', 'fixop']
     COMMON_MACROS.extend([
         ('SIMUPOP_VER', SIMUPOP_VER),
         ('SIMUPOP_REV', SIMUPOP_REV)
@@ -686,8 +692,11 @@ if __name__ == '__main__':
     #
     # if any of the wrap files does not exist
     # or if the wrap files are older than any of the source files.
-    if not os.path.isfile('src/gsl_wrap.c') or (not os.path.isfile('src/swigpyrun.h')) or \
-            False in [os.path.isfile(WRAP_INFO[x][0]) for x in MODULES]:
+    SWIG_INPUTS = glob.glob('src/*.i') + ['src/' + x for x in HEADER_FILES]
+    WRAP_FILES = ['src/gsl_wrap.c', 'src/swigpyrun.h'] + [WRAP_INFO[x][0] for x in MODULES]
+    if False in [os.path.isfile(x) for x in WRAP_FILES] or \
+            max([os.path.getmtime(x) for x in SWIG_INPUTS]) > \
+            min([os.path.getmtime(x) for x in WRAP_FILES]):
         # generate header file
         print("Generating external runtime header file src/swigpyrun.h...")
         os.system('swig {} src/swigpyrun.h'.format(SWIG_RUNTIME_FLAGS))
@@ -783,6 +792,7 @@ if __name__ == '__main__':
             'simuPOP.utils',
             'simuPOP.demography',
             'simuPOP.sampling',
+            'simuPOP.perf',
         ] + ['simuPOP.simuPOP_%s' % x for x in MODULES],
         ext_modules = EXT_MODULES,
         cmdclass = {'build_py': build_py},
@@ -146,6 +146,7 @@ __all__ = [
     'MonogamousMating',
     'SelfMating',
     'HermaphroditicMating',
+    'MixedMating',
     'CloneMating',
     'HaplodiploidMating',
     #'consanguineousMating',
@@ -206,6 +207,7 @@ __all__ = [
     'PyMlPenetrance',
     #
     'PyQuanTrait',
+    'AdditiveQuanTrait',
     #
     'Stat',
     #
@@ -218,6 +220,7 @@ __all__ = [
     'SummaryTagger',
     #
     'TerminateIf',
+    'TerminateIfFixed',
     'RevertIf',
     'DiscardIf',
     'discardIf',
@@ -275,6 +278,7 @@ __all__ = [
     #
     'closeOutput',
     'describeEvolProcess',
+    'replaySnapshots',
     'loadPopulation',
     'loadPedigree',
     'moduleInfo',
@@ -294,6 +298,7 @@ __all__ = [
     'pyMlSelect',
     #
     'pyQuanTrait',
+    'additiveQuanTrait',
     #
     # For testing only
     'applyDuringMatingOperator',
@@ -313,7 +318,12 @@ import os, sys, re
 
 if simuOptions['Optimized']:
     if simuOptions['AlleleType'] == 'short':
-        from simuPOP.simuPOP_op import *
+        # SIMUFIXEDPLOIDY selects the fixed-geometry build (see setup.py),
+        # which only accepts diploid populations
+        if os.getenv('SIMUFIXEDPLOIDY') is not None:
+            from simuPOP.simuPOP_fixop import *
+        else:
+            from simuPOP.simuPOP_op import *
     elif simuOptions['AlleleType'] == 'long':
         from simuPOP.simuPOP_laop import *
     elif simuOptions['AlleleType'] == 'binary':
@@ -583,6 +593,22 @@ Simulator.__deepcopy__ = _deepcopy
 BaseOperator.__deepcopy__ = _deepcopy
 
 
+# expose the binary snapshot methods to the Python pickle module. The
+# snapshot format is much cheaper than the compressed text archive and
+# the bytes object is handed to pickle without an extra copy.
+def _popFromBytes(data):
+    pop = Population()
+    pop.fromBytes(data)
+    return pop
+
+
+def _pop_reduce(self):
+    return (_popFromBytes, (self.toBytes(),))
+
+
+Population.__reduce__ = _pop_reduce
+
+
 def ind_setInfo2(self, field, value):
     self.setInfo(value, field)
 
@@ -840,13 +866,14 @@ class RandomMating(HomoMating):
                  subPopSize=[],
                  subPops=ALL_AVAIL,
                  weight=0,
-                 selectionField='fitness'):
+                 selectionField='fitness',
+                 inPlace=False):
         '''Creates a random mating ssheme that selects two parents randomly and
         transmit genotypes according to Mendelian laws. Please refer to class
         ``RandomParentsChooser`` for parameter *selectionField*, to class
         ``OffspringGenerator`` for parameters *ops*, *sexMode* and
-        *numOffspring*, and to class ``HomoMating`` for parameters
-        *subPopSize*, *subPops* and *weight*.
+        *numOffspring*, and to classes ``HomoMating`` and ``MatingScheme``
+        for parameters *subPopSize*, *subPops*, *weight* and *inPlace*.
         '''
         HomoMating.__init__(
             self,
@@ -854,7 +881,8 @@ class RandomMating(HomoMating):
             generator=OffspringGenerator(ops, numOffspring, sexMode),
             subPopSize=subPopSize,
             subPops=subPops,
-            weight=weight)
+            weight=weight,
+            inPlace=inPlace)
 
 
 class MonogamousMating(HomoMating):
@@ -1518,6 +1546,13 @@ def pyQuanTrait(pop, func, loci=[], ancGens=ALL_AVAIL, *args, **kwargs):
     PyQuanTrait(func, loci, ancGens, *args, **kwargs).apply(pop)
 
 
+def additiveQuanTrait(pop, loci=[], effects=[], baseline=0, ancGens=ALL_AVAIL, *args, **kwargs):
+    '''Apply opertor ``AdditiveQuanTrait`` to population *pop*. Unlike the
+    operator form of this operator that only handles the current generation,
+    this function by default assign trait values to all generations.'''
+    AdditiveQuanTrait(loci, effects, baseline, ancGens, *args, **kwargs).apply(pop)
+
+
 def discardIf(pop, *args, **kwargs):
     '''Apply operator ``DiscardIf`` to population *pop* to remove individuals according
     to an expression or a Python function.'''
@@ -29,22 +29,85 @@
 
 using namespace boost::lambda;
 
+#include <cstdlib>
+#include <fstream>
 #include <set>
 using std::set;
 
 namespace simuPOP {
 
+// shared interning pool for locus names. A deque keeps stored strings in
+// place when the pool grows, so references returned by internedLocusName()
+// remain valid. Structures are created and destroyed from code that holds
+// the interpreter lock, so the pool needs no locking of its own.
+static deque<string> g_lociNamePool;
+static map<string, size_t> g_lociNamePoolIndex;
+
+size_t internLocusName(const string & name)
+{
+	map<string, size_t>::const_iterator it = g_lociNamePoolIndex.find(name);
+
+	if (it != g_lociNamePoolIndex.end())
+		return it->second;
+	g_lociNamePool.push_back(name);
+	g_lociNamePoolIndex[name] = g_lociNamePool.size() - 1;
+	return g_lociNamePool.size() - 1;
+}
+
+
+const string & internedLocusName(size_t id)
+{
+	DBG_ASSERT(id < g_lociNamePool.size(), IndexError,
+		"Locus name index out of range of the shared name pool.");
+	return g_lociNamePool[id];
+}
+
+
+size_t findLocusName(const string & name)
+{
+	map<string, size_t>::const_iterator it = g_lociNamePoolIndex.find(name);
+
+	return it == g_lociNamePoolIndex.end() ? NOT_FOUND : it->second;
+}
+
+
+void GenoStructure::appendLociNames(vectorstr & names, size_t beginLocus, size_t endLocus) const
+{
+	for (size_t i = beginLocus; i < endLocus; ++i)
+		names.push_back(internedLocusName(m_lociNameIds[i]));
+}
+
+
+vectorstr GenoStructure::lociNamesVec() const
+{
+	vectorstr names;
+
+	names.reserve(m_lociNameIds.size());
+	appendLociNames(names, 0, m_lociNameIds.size());
+	return names;
+}
+
+
 GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru & chromTypes, bool haplodiploid,
 	const vectorf & lociPos, const vectorstr & chromNames, const matrixstr & alleleNames,
 	const vectorstr & lociNames, const vectorstr & infoFields)
 	: m_ploidy(ploidy), m_numLoci(loci), m_chromTypes(),
 	m_haplodiploid(haplodiploid), m_lociPos(lociPos), m_chromIndex(loci.size() + 1),
-	m_chromNames(chromNames), m_alleleNames(alleleNames), m_lociNames(lociNames),
-	m_infoFields(infoFields), m_lociPosMap(), m_refCount(0)
+	m_chromNames(chromNames), m_alleleNames(alleleNames), m_lociNameIds(),
+	m_infoFields(infoFields), m_infoFieldMap(), m_lociPosMap(), m_refCount(0)
 {
 	DBG_ASSERT(ploidy >= 1, ValueError,
 		(boost::format("Ploidy must be >= 1. Given %1%") % ploidy).str());
 
+#ifdef FIXED_PLOIDY
+	// ploidy() returns the macro unconditionally in a fixed-geometry
+	// build, so any other value has to be rejected here
+	if (ploidy != FIXED_PLOIDY)
+		throw ValueError((boost::format("This simuPOP module was compiled for a fixed "
+			"ploidy of %1% and cannot handle a population with ploidy %2%.")
+			% FIXED_PLOIDY % ploidy).str());
+#endif
+
 	// default: one chromosome, one locus
 	// otherwise, Loci copies from loci
 	if (loci.empty()) {
@@ -63,8 +126,23 @@ GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru &
 
 	m_totNumLoci = m_chromIndex[m_numLoci.size()];
 
-	DBG_ASSERT(m_lociNames.empty() || m_lociNames.size() == m_totNumLoci, ValueError,
+#ifdef FIXED_NUMCHROM
+	// the counterpart of the FIXED_PLOIDY check above, for numChrom()
+	if (m_numLoci.size() != FIXED_NUMCHROM)
+		throw ValueError((boost::format("This simuPOP module was compiled for a fixed "
+			"number of %1% chromosomes and cannot handle a population with %2% chromosomes.")
+			% FIXED_NUMCHROM % m_numLoci.size()).str());
+#endif
+
+	DBG_ASSERT(lociNames.empty() || lociNames.size() == m_totNumLoci, ValueError,
 		"Loci names, if specified, should be given to every loci");
+
+	// locus names are kept as indexes into a pool that is shared by all
+	// entries of the structure repository, so that replicated populations
+	// with dense maps do not duplicate millions of strings.
+	m_lociNameIds.reserve(lociNames.size());
+	for (size_t i = 0; i < lociNames.size(); ++i)
+		m_lociNameIds.push_back(internLocusName(lociNames[i]));
 	DBG_FAILIF(m_alleleNames.size() > 1 && m_alleleNames.size() != m_totNumLoci,
 		ValueError, "Please specify a common set allele names or names for all loci.");
 
@@ -116,10 +194,10 @@ GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru &
 					"Loci on the same chromosome should have different positions.");
 			}
 			// lociNames?
-			if (!m_lociNames.empty()) {
-				vectorstr lociNames(m_lociNames.begin() + begin, m_lociNames.begin() + end);
+			if (!m_lociNameIds.empty()) {
+				vectoru nameIds(m_lociNameIds.begin() + begin, m_lociNameIds.begin() + end);
 				for (size_t i = 0; i < rank.size(); ++i)
-					m_lociNames[begin + i] = lociNames[rank[i]];
+					m_lociNameIds[begin + i] = nameIds[rank[i]];
 			}
 			// allele names
 			if (m_alleleNames.size() > 1) {
@@ -131,13 +209,13 @@ GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru &
 	}
 
 	// set up a map for loci names and check uniqueness of the names
-	if (!m_lociNames.empty()) {
+	if (!m_lociNameIds.empty()) {
 		for (size_t i = 0; i < m_totNumLoci; ++i) {
-			if (m_lociNames[i].empty())
+			if (internedLocusName(m_lociNameIds[i]).empty())
 				continue;
-			if (m_lociNameMap.find(m_lociNames[i]) != m_lociNameMap.end())
+			if (m_lociNameMap.find(m_lociNameIds[i]) != m_lociNameMap.end())
 				throw ValueError("Given loci names should be unique");
-			m_lociNameMap[m_lociNames[i]] = i;
+			m_lociNameMap[m_lociNameIds[i]] = i;
 		}
 	}
 	DBG_ASSERT(m_chromNames.empty() || m_chromNames.size() == m_numLoci.size(), ValueError,
@@ -174,6 +252,10 @@ GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru &
 		m_infoFields.clear();
 		std::copy(infoMap.begin(), infoMap.end(), std::back_inserter(m_infoFields));
 	}
+	// intern information field names so that name lookups do not have to
+	// scan the list of fields
+	for (size_t i = 0; i < m_infoFields.size(); ++i)
+		m_infoFieldMap[m_infoFields[i]] = i;
 	// shrink allele names
 	for (size_t i = 0; i < m_alleleNames.size(); ++i)
 		if (!m_alleleNames[i].empty() && static_cast<UINT>(m_alleleNames[i].size() - 1) > ModuleMaxAllele)
@@ -214,7 +296,7 @@ bool GenoStructure::operator==(const GenoStructure & rhs)
 	                     (m_lociPos == rhs.m_lociPos) &&
 	                     (m_chromNames == rhs.m_chromNames) &&
 	                     (m_alleleNames == rhs.m_alleleNames) &&
-	                     (m_lociNames == rhs.m_lociNames) &&
+	                     (m_lociNameIds == rhs.m_lociNameIds) &&
 	                     (m_infoFields == rhs.m_infoFields)
 	                     ))
 		return true;
@@ -356,10 +438,274 @@ size_t GenoStruTrait::lociCovered(size_t loc, double dist) const
 }
 
 
+namespace {
+
+// flat binary writers and readers used by the warm-start structure cache.
+// The cache is local to one machine and module, so values are stored in
+// native byte order and width.
+template <typename T>
+void writeStru(std::ostream & out, const T & value)
+{
+	out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+
+void writeStru(std::ostream & out, const string & value)
+{
+	writeStru(out, value.size());
+	out.write(value.data(), value.size());
+}
+
+
+template <typename T>
+void writeStruVec(std::ostream & out, const vector<T> & values)
+{
+	writeStru(out, values.size());
+	if (!values.empty())
+		out.write(reinterpret_cast<const char *>(&values[0]), values.size() * sizeof(T));
+}
+
+
+void writeStruVec(std::ostream & out, const vectorstr & values)
+{
+	writeStru(out, values.size());
+	for (size_t i = 0; i < values.size(); ++i)
+		writeStru(out, values[i]);
+}
+
+
+template <typename T>
+void readStru(std::istream & in, T & value)
+{
+	in.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+
+void readStru(std::istream & in, string & value)
+{
+	size_t sz = 0;
+
+	readStru(in, sz);
+	value.resize(sz);
+	if (sz > 0)
+		in.read(&value[0], sz);
+}
+
+
+template <typename T>
+void readStruVec(std::istream & in, vector<T> & values)
+{
+	size_t sz = 0;
+
+	readStru(in, sz);
+	values.resize(sz);
+	if (sz > 0)
+		in.read(reinterpret_cast<char *>(&values[0]), sz * sizeof(T));
+}
+
+
+void readStruVec(std::istream & in, vectorstr & values)
+{
+	size_t sz = 0;
+
+	readStru(in, sz);
+	values.resize(sz);
+	for (size_t i = 0; i < sz; ++i)
+		readStru(in, values[i]);
+}
+
+
+// bump when the layout of the cache file changes
+const ULONG g_struCacheMagic = 0x53504753u;
+const ULONG g_struCacheVersion = 1;
+
+// FNV-1a, accumulated over the raw bytes of the structure arguments
+void hashStruBytes(ULONG & h, const void * data, size_t size)
+{
+	const unsigned char * p = reinterpret_cast<const unsigned char *>(data);
+
+	for (size_t i = 0; i < size; ++i) {
+		h ^= p[i];
+		h *= 1099511628211UL;
+	}
+}
+
+
+void hashStruString(ULONG & h, const string & value)
+{
+	size_t sz = value.size();
+
+	hashStruBytes(h, &sz, sizeof(sz));
+	hashStruBytes(h, value.data(), sz);
+}
+
+
+void hashStruStrings(ULONG & h, const vectorstr & values)
+{
+	size_t sz = values.size();
+
+	hashStruBytes(h, &sz, sizeof(sz));
+	for (size_t i = 0; i < sz; ++i)
+		hashStruString(h, values[i]);
+}
+
+}
+
+
+bool GenoStructure::saveStruCache(const string & filename) const
+{
+	std::ofstream out(filename.c_str(), std::ios::binary);
+
+	if (!out)
+		return false;
+	writeStru(out, g_struCacheMagic);
+	writeStru(out, g_struCacheVersion);
+	// allele names are shrunk to the allele range of the present module
+	writeStru(out, ModuleMaxAllele);
+	writeStru(out, m_ploidy);
+	writeStru(out, m_totNumLoci);
+	writeStruVec(out, m_numLoci);
+	writeStruVec(out, m_chromTypes);
+	writeStru(out, m_chromX);
+	writeStru(out, m_chromY);
+	writeStru(out, m_mitochondrial);
+	writeStruVec(out, m_customized);
+	writeStru(out, m_haplodiploid);
+	writeStruVec(out, m_lociPos);
+	writeStruVec(out, m_chromIndex);
+	writeStruVec(out, m_chromNames);
+	writeStru(out, m_alleleNames.size());
+	for (size_t i = 0; i < m_alleleNames.size(); ++i)
+		writeStruVec(out, m_alleleNames[i]);
+	writeStruVec(out, lociNamesVec());
+	writeStruVec(out, m_infoFields);
+	// the cache file stores names rather than pool indexes so that it stays
+	// valid across processes with differently populated name pools
+	writeStru(out, m_lociNameMap.size());
+	for (map<size_t, size_t>::const_iterator it = m_lociNameMap.begin();
+	     it != m_lociNameMap.end(); ++it) {
+		writeStru(out, internedLocusName(it->first));
+		writeStru(out, it->second);
+	}
+	// written in key order so that it can be rebuilt with hinted
+	// insertion in linear time
+	writeStru(out, m_infoFieldMap.size());
+	for (map<string, size_t>::const_iterator it = m_infoFieldMap.begin();
+	     it != m_infoFieldMap.end(); ++it) {
+		writeStru(out, it->first);
+		writeStru(out, it->second);
+	}
+	return bool(out);
+}
+
+
+bool GenoStructure::loadStruCache(const string & filename)
+{
+	std::ifstream in(filename.c_str(), std::ios::binary);
+
+	if (!in)
+		return false;
+	ULONG magic = 0, version = 0, maxAllele = 0;
+	readStru(in, magic);
+	readStru(in, version);
+	readStru(in, maxAllele);
+	if (!in || magic != g_struCacheMagic || version != g_struCacheVersion ||
+	    maxAllele != ModuleMaxAllele)
+		return false;
+	readStru(in, m_ploidy);
+#ifdef FIXED_PLOIDY
+	// let the regular construction path reject the ploidy with a clear error
+	if (m_ploidy != FIXED_PLOIDY)
+		return false;
+#endif
+	readStru(in, m_totNumLoci);
+	readStruVec(in, m_numLoci);
+	readStruVec(in, m_chromTypes);
+	readStru(in, m_chromX);
+	readStru(in, m_chromY);
+	readStru(in, m_mitochondrial);
+	readStruVec(in, m_customized);
+	readStru(in, m_haplodiploid);
+	readStruVec(in, m_lociPos);
+	readStruVec(in, m_chromIndex);
+	readStruVec(in, m_chromNames);
+	size_t sz = 0;
+	readStru(in, sz);
+	m_alleleNames.resize(sz);
+	for (size_t i = 0; i < sz; ++i)
+		readStruVec(in, m_alleleNames[i]);
+	vectorstr lociNames;
+	readStruVec(in, lociNames);
+	m_lociNameIds.clear();
+	m_lociNameIds.reserve(lociNames.size());
+	for (size_t i = 0; i < lociNames.size(); ++i)
+		m_lociNameIds.push_back(internLocusName(lociNames[i]));
+	readStruVec(in, m_infoFields);
+	readStru(in, sz);
+	m_lociNameMap.clear();
+	for (size_t i = 0; i < sz; ++i) {
+		string name;
+		size_t idx = 0;
+		readStru(in, name);
+		readStru(in, idx);
+		// pool indexes do not follow the name order of the cache file so
+		// no insertion hint is used here
+		m_lociNameMap[internLocusName(name)] = idx;
+	}
+	readStru(in, sz);
+	m_infoFieldMap.clear();
+	for (size_t i = 0; i < sz; ++i) {
+		string name;
+		size_t idx = 0;
+		readStru(in, name);
+		readStru(in, idx);
+		m_infoFieldMap.insert(m_infoFieldMap.end(), std::make_pair(name, idx));
+	}
+	m_lociPosMap.clear();
+	m_refCount = 0;
+	return bool(in);
+}
+
+
 void GenoStruTrait::setGenoStructure(UINT ploidy, const vectoru & loci, const vectoru & chromTypes, bool haplodiploid,
                                      const vectorf & lociPos, const vectorstr & chromNames, const matrixstr & alleleNames,
                                      const vectorstr & lociNames, const vectorstr & infoFields)
 {
+	// if environment variable SIMUPOP_STRU_CACHE names a directory, the
+	// validated and sorted structure is kept there in a binary file keyed
+	// by a content hash of the arguments, so that later processes (e.g.
+	// workers simulating the same large genetic map) skip construction
+	const char * cacheDir = getenv("SIMUPOP_STRU_CACHE");
+
+	if (cacheDir != NULL && *cacheDir != '\0') {
+		ULONG key = 14695981039346656037UL;
+		hashStruBytes(key, &ploidy, sizeof(ploidy));
+		hashStruBytes(key, &haplodiploid, sizeof(haplodiploid));
+		if (!loci.empty())
+			hashStruBytes(key, &loci[0], loci.size() * sizeof(loci[0]));
+		if (!chromTypes.empty())
+			hashStruBytes(key, &chromTypes[0], chromTypes.size() * sizeof(chromTypes[0]));
+		if (!lociPos.empty())
+			hashStruBytes(key, &lociPos[0], lociPos.size() * sizeof(lociPos[0]));
+		hashStruStrings(key, chromNames);
+		for (size_t i = 0; i < alleleNames.size(); ++i)
+			hashStruStrings(key, alleleNames[i]);
+		hashStruStrings(key, lociNames);
+		hashStruStrings(key, infoFields);
+		string file = string(cacheDir) + "/" +
+		              (boost::format("%016x") % key).str() + ".gsc";
+		GenoStructure cached;
+		if (cached.loadStruCache(file)) {
+			setGenoStructure(cached);
+			return;
+		}
+		GenoStructure tmp = GenoStructure(ploidy, loci, chromTypes, haplodiploid,
+			lociPos, chromNames, alleleNames, lociNames, infoFields);
+		tmp.saveStruCache(file);
+		setGenoStructure(tmp);
+		return;
+	}
+
 	GenoStructure tmp = GenoStructure(ploidy, loci, chromTypes, haplodiploid,
 		lociPos, chromNames, alleleNames, lociNames, infoFields);
 
@@ -448,18 +794,18 @@ const GenoStructure GenoStruTrait::gsAddChromFromStru(size_t idx) const
 			alleleNames.insert(alleleNames.end(), gs2.m_alleleNames.begin(), gs2.m_alleleNames.end());
 	}
 	//
-	vectorstr lociNames = gs1.m_lociNames;
-	if (gs1.m_lociNames.empty()) {
-		if (!gs2.m_lociNames.empty()) {
+	vectorstr lociNames = gs1.lociNamesVec();
+	if (gs1.m_lociNameIds.empty()) {
+		if (!gs2.m_lociNameIds.empty()) {
 			lociNames.resize(gs1.m_totNumLoci, string());
-			lociNames.insert(lociNames.end(), gs2.m_lociNames.begin(), gs2.m_lociNames.end());
+			gs2.appendLociNames(lociNames, 0, gs2.m_totNumLoci);
 		}
 		// if both empty, do nothing.
 	} else {
-		if (gs2.m_lociNames.empty())
+		if (gs2.m_lociNameIds.empty())
 			lociNames.resize(gs1.m_totNumLoci + gs2.m_totNumLoci, string());
 		else
-			lociNames.insert(lociNames.end(), gs2.m_lociNames.begin(), gs2.m_lociNames.end());
+			gs2.appendLociNames(lociNames, 0, gs2.m_totNumLoci);
 	}
 	//
 	vectoru chromTypes = gs1.m_chromTypes;
@@ -504,20 +850,17 @@ const GenoStructure GenoStruTrait::gsAddLociFromStru(size_t idx, vectoru & index
 				gs1.m_lociPos.begin() + gs1.m_chromIndex[ch + 1]);
 			lociPos.insert(lociPos.end(), gs2.m_lociPos.begin() + gs2.m_chromIndex[ch],
 				gs2.m_lociPos.begin() + gs2.m_chromIndex[ch + 1]);
-			if (gs1.m_lociNames.empty()) {
-				if (!gs2.m_lociNames.empty()) {
+			if (gs1.m_lociNameIds.empty()) {
+				if (!gs2.m_lociNameIds.empty()) {
 					lociNames.resize(lociNames.size() + gs1.m_numLoci[ch], string());
-					lociNames.insert(lociNames.end(), gs2.m_lociNames.begin() + gs2.m_chromIndex[ch],
-						gs2.m_lociNames.begin() + gs2.m_chromIndex[ch + 1]);
+					gs2.appendLociNames(lociNames, gs2.m_chromIndex[ch], gs2.m_chromIndex[ch + 1]);
 				}
 			} else {
-				lociNames.insert(lociNames.end(), gs1.m_lociNames.begin() + gs1.m_chromIndex[ch],
-					gs1.m_lociNames.begin() + gs1.m_chromIndex[ch + 1]);
-				if (gs2.m_lociNames.empty())
+				gs1.appendLociNames(lociNames, gs1.m_chromIndex[ch], gs1.m_chromIndex[ch + 1]);
+				if (gs2.m_lociNameIds.empty())
 					lociNames.resize(lociNames.size() + gs2.m_numLoci[ch], string());
 				else
-					lociNames.insert(lociNames.end(), gs2.m_lociNames.begin() + gs2.m_chromIndex[ch],
-						gs2.m_lociNames.begin() + gs2.m_chromIndex[ch + 1]);
+					gs2.appendLociNames(lociNames, gs2.m_chromIndex[ch], gs2.m_chromIndex[ch + 1]);
 			}
 			// allele names
 			if (gs1.m_alleleNames.empty())
@@ -541,12 +884,11 @@ const GenoStructure GenoStruTrait::gsAddLociFromStru(size_t idx, vectoru & index
 			chromTypes.push_back(gs1.m_chromTypes[ch]);
 			lociPos.insert(lociPos.end(), gs1.m_lociPos.begin() + gs1.m_chromIndex[ch],
 				gs1.m_lociPos.begin() + gs1.m_chromIndex[ch + 1]);
-			if (gs1.m_lociNames.empty()) {
+			if (gs1.m_lociNameIds.empty()) {
 				if (!lociNames.empty())
 					lociNames.resize(lociNames.size() + gs1.m_numLoci[ch], string());
 			} else {
-				lociNames.insert(lociNames.end(), gs1.m_lociNames.begin() + gs1.m_chromIndex[ch],
-					gs1.m_lociNames.begin() + gs1.m_chromIndex[ch + 1]);
+				gs1.appendLociNames(lociNames, gs1.m_chromIndex[ch], gs1.m_chromIndex[ch + 1]);
 			}
 			// allele names
 			if (gs1.m_alleleNames.empty())
@@ -563,12 +905,11 @@ const GenoStructure GenoStruTrait::gsAddLociFromStru(size_t idx, vectoru & index
 			chromTypes.push_back(gs2.m_chromTypes[ch]);
 			lociPos.insert(lociPos.end(), gs2.m_lociPos.begin() + gs2.m_chromIndex[ch],
 				gs2.m_lociPos.begin() + gs2.m_chromIndex[ch + 1]);
-			if (gs2.m_lociNames.empty()) {
+			if (gs2.m_lociNameIds.empty()) {
 				if (!lociNames.empty())
 					lociNames.resize(lociNames.size() + gs2.m_numLoci[ch], string());
 			} else {
-				lociNames.insert(lociNames.end(), gs2.m_lociNames.begin() + gs2.m_chromIndex[ch],
-					gs2.m_lociNames.begin() + gs2.m_chromIndex[ch + 1]);
+				gs2.appendLociNames(lociNames, gs2.m_chromIndex[ch], gs2.m_chromIndex[ch + 1]);
 			}
 			if (gs2.m_alleleNames.empty())
 				alleleNames.resize(alleleNames.size() + gs2.m_numLoci[ch], vectorstr());
@@ -648,12 +989,11 @@ const GenoStructure GenoStruTrait::gsAddLociByNameFromStru(size_t idx, vectoru &
 			chromTypes.push_back(gs1.m_chromTypes[ch1]);
 			lociPos.insert(lociPos.end(), gs1.m_lociPos.begin() + gs1.m_chromIndex[ch1],
 				gs1.m_lociPos.begin() + gs1.m_chromIndex[ch1 + 1]);
-			if (gs1.m_lociNames.empty()) {
+			if (gs1.m_lociNameIds.empty()) {
 				if (!lociNames.empty())
 					lociNames.resize(lociNames.size() + gs1.m_numLoci[ch1], string());
 			} else {
-				lociNames.insert(lociNames.end(), gs1.m_lociNames.begin() + gs1.m_chromIndex[ch1],
-					gs1.m_lociNames.begin() + gs1.m_chromIndex[ch1 + 1]);
+				gs1.appendLociNames(lociNames, gs1.m_chromIndex[ch1], gs1.m_chromIndex[ch1 + 1]);
 			}
 			// allele names
 			if (gs1.m_alleleNames.empty())
@@ -675,20 +1015,17 @@ const GenoStructure GenoStruTrait::gsAddLociByNameFromStru(size_t idx, vectoru &
 				gs1.m_lociPos.begin() + gs1.m_chromIndex[ch1 + 1]);
 			lociPos.insert(lociPos.end(), gs2.m_lociPos.begin() + gs2.m_chromIndex[ch2],
 				gs2.m_lociPos.begin() + gs2.m_chromIndex[ch2 + 1]);
-			if (gs1.m_lociNames.empty()) {
-				if (!gs2.m_lociNames.empty()) {
+			if (gs1.m_lociNameIds.empty()) {
+				if (!gs2.m_lociNameIds.empty()) {
 					lociNames.resize(lociNames.size() + gs1.m_numLoci[ch1], string());
-					lociNames.insert(lociNames.end(), gs2.m_lociNames.begin() + gs2.m_chromIndex[ch2],
-						gs2.m_lociNames.begin() + gs2.m_chromIndex[ch2 + 1]);
+					gs2.appendLociNames(lociNames, gs2.m_chromIndex[ch2], gs2.m_chromIndex[ch2 + 1]);
 				}
 			} else {
-				lociNames.insert(lociNames.end(), gs1.m_lociNames.begin() + gs1.m_chromIndex[ch1],
-					gs1.m_lociNames.begin() + gs1.m_chromIndex[ch1 + 1]);
-				if (gs2.m_lociNames.empty())
+				gs1.appendLociNames(lociNames, gs1.m_chromIndex[ch1], gs1.m_chromIndex[ch1 + 1]);
+				if (gs2.m_lociNameIds.empty())
 					lociNames.resize(lociNames.size() + gs2.m_numLoci[ch2], string());
 				else
-					lociNames.insert(lociNames.end(), gs2.m_lociNames.begin() + gs2.m_chromIndex[ch2],
-						gs2.m_lociNames.begin() + gs2.m_chromIndex[ch2 + 1]);
+					gs2.appendLociNames(lociNames, gs2.m_chromIndex[ch2], gs2.m_chromIndex[ch2 + 1]);
 			}
 			// allele names
 			if (gs1.m_alleleNames.empty())
@@ -719,12 +1056,11 @@ const GenoStructure GenoStruTrait::gsAddLociByNameFromStru(size_t idx, vectoru &
 			chromTypes.push_back(gs2.m_chromTypes[ch2]);
 			lociPos.insert(lociPos.end(), gs2.m_lociPos.begin() + gs2.m_chromIndex[ch2],
 				gs2.m_lociPos.begin() + gs2.m_chromIndex[ch2 + 1]);
-			if (gs2.m_lociNames.empty()) {
+			if (gs2.m_lociNameIds.empty()) {
 				if (!lociNames.empty())
 					lociNames.resize(lociNames.size() + gs2.m_numLoci[ch2], string());
 			} else {
-				lociNames.insert(lociNames.end(), gs2.m_lociNames.begin() + gs2.m_chromIndex[ch2],
-					gs2.m_lociNames.begin() + gs2.m_chromIndex[ch2 + 1]);
+				gs2.appendLociNames(lociNames, gs2.m_chromIndex[ch2], gs2.m_chromIndex[ch2 + 1]);
 			}
 			if (gs2.m_alleleNames.empty())
 				alleleNames.resize(alleleNames.size() + gs2.m_numLoci[ch2], vectorstr());
@@ -781,7 +1117,7 @@ const GenoStructure GenoStruTrait::gsRemoveLoci(const vectoru & kept)
 		size_t ch = chromLocusPair(*loc).first;
 		numLoci[ch]++;
 		lociPos.push_back(locusPos(*loc));
-		if (!gs.m_lociNames.empty()) {
+		if (!gs.m_lociNameIds.empty()) {
 			lociNames.push_back(locusName(*loc));
 			// for locus-specific allele names
 			if (gs.m_alleleNames.size() > 1)
@@ -819,7 +1155,7 @@ const GenoStructure GenoStruTrait::gsAddChrom(const vectorf & lociPos, const vec
 	vectorf newLociPos = gs.m_lociPos;
 	newLociPos.insert(newLociPos.end(), lociPos.begin(), lociPos.end());
 	//
-	vectorstr newLociNames = gs.m_lociNames;
+	vectorstr newLociNames = gs.lociNamesVec();
 	if (newLociNames.empty()) {
 		if (!lociNames.empty()) {
 			newLociNames.resize(gs.m_totNumLoci, string());
@@ -864,7 +1200,7 @@ const GenoStructure GenoStruTrait::gsSetAlleleNames(const lociList & loci_, cons
 	// if alleleNames is used totally redefined ...
 	if (loci_.allAvail())
 		return GenoStructure(gs.m_ploidy, gs.m_numLoci, gs.m_chromTypes, gs.m_haplodiploid,
-			gs.m_lociPos, gs.m_chromNames, alleleNames, gs.m_lociNames, gs.m_infoFields);
+			gs.m_lociPos, gs.m_chromNames, alleleNames, gs.lociNamesVec(), gs.m_infoFields);
 
 	const vectoru & loci = loci_.elems(this);
 	matrixstr names = gs.m_alleleNames;
@@ -900,7 +1236,7 @@ const GenoStructure GenoStruTrait::gsSetAlleleNames(const lociList & loci_, cons
 	}
 	// replace common alleles
 	return GenoStructure(gs.m_ploidy, gs.m_numLoci, gs.m_chromTypes, gs.m_haplodiploid,
-		gs.m_lociPos, gs.m_chromNames, names, gs.m_lociNames, gs.m_infoFields);
+		gs.m_lociPos, gs.m_chromNames, names, gs.lociNamesVec(), gs.m_infoFields);
 }
 
 
@@ -920,7 +1256,7 @@ const GenoStructure GenoStruTrait::gsAddLoci(const vectoru & chrom, const vector
 	GenoStructure & gs = s_genoStruRepository[m_genoStruIdx];
 
 	// original names
-	vectorstr newLociNames = gs.m_lociNames;
+	vectorstr newLociNames = gs.lociNamesVec();
 	if (newLociNames.empty() && !lociNames.empty())
 		newLociNames.resize(gs.m_totNumLoci, string());
 
@@ -1054,13 +1390,16 @@ vectoru GenoStruTrait::lociByNames(const vectorstr & names) const
 {
 	vectoru indexes(names.size());
 
-	const map<string, size_t> & nameMap = s_genoStruRepository[m_genoStruIdx].m_lociNameMap;
+	const map<size_t, size_t> & nameMap = s_genoStruRepository[m_genoStruIdx].m_lociNameMap;
 
 	vectorstr::const_iterator name = names.begin();
 	vectorstr::const_iterator nameEnd = names.end();
 
 	for (size_t i = 0; name != nameEnd; ++name, ++i) {
-		map<string, size_t>::const_iterator it = nameMap.find(*name);
+		// a name that has never been interned cannot belong to any structure
+		size_t id = findLocusName(*name);
+		map<size_t, size_t>::const_iterator it = id == NOT_FOUND
+			? nameMap.end() : nameMap.find(id);
 
 		if (it == nameMap.end())
 			throw ValueError("Failed to find locus with name " + *name);
@@ -1115,11 +1454,12 @@ vectorstr GenoStruTrait::alleleNames(const size_t locus) const
 
 size_t GenoStruTrait::infoIdx(const string & name) const
 {
-	vectorstr & names = s_genoStruRepository[m_genoStruIdx].m_infoFields;
+	const map<string, size_t> & nameMap = s_genoStruRepository[m_genoStruIdx].m_infoFieldMap;
+
+	map<string, size_t>::const_iterator it = nameMap.find(name);
 
-	for (size_t i = 0; i < names.size(); ++i)
-		if (names[i] == name)
-			return i;
+	if (it != nameMap.end())
+		return it->second;
 	throw IndexError("Info field '" + name + "' is not found. Plese use infoFields=['"
 		+ name + "'] option of population() during construction\n" +
 		"or use addInfoField('" + name + "') to add to an existing population.");
@@ -1139,6 +1479,9 @@ const GenoStructure GenoStruTrait::gsAddInfoFields(const vectorstr & fields)
 		if (std::find(gs.m_infoFields.begin(), gs.m_infoFields.end(), *it) == gs.m_infoFields.end())
 			gs.m_infoFields.push_back(*it);
 	}
+	gs.m_infoFieldMap.clear();
+	for (size_t i = 0; i < gs.m_infoFields.size(); ++i)
+		gs.m_infoFieldMap[gs.m_infoFields[i]] = i;
 	gs.m_refCount = 0;
 	return gs;
 }
@@ -1155,6 +1498,9 @@ const GenoStructure GenoStruTrait::gsSetInfoFields(const vectorstr & fields)
 		if (std::find(gs.m_infoFields.begin(), gs.m_infoFields.end(), *it) == gs.m_infoFields.end())
 			gs.m_infoFields.push_back(*it);
 	}
+	gs.m_infoFieldMap.clear();
+	for (size_t i = 0; i < gs.m_infoFields.size(); ++i)
+		gs.m_infoFieldMap[gs.m_infoFields[i]] = i;
 	gs.m_refCount = 0;
 	return gs;
 }
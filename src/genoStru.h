@@ -51,6 +51,24 @@ using std::dec;
 using std::pair;
 
 namespace simuPOP {
+
+/** CPPONLY Intern locus name \e name in the shared name pool and return its
+ *  index. Each distinct name is stored only once, so structures that carry
+ *  the names of another structure (e.g. a structure created by adding an
+ *  information field to an existing population) refer to the same stored
+ *  strings.
+ */
+size_t internLocusName(const string & name);
+
+/// CPPONLY return the locus name stored at index \e id of the shared name pool
+const string & internedLocusName(size_t id);
+
+/** CPPONLY Return the pool index of locus name \e name, or \c NOT_FOUND if
+ *  the name was never interned and therefore does not name a locus of any
+ *  existing structure.
+ */
+size_t findLocusName(const string & name);
+
 /// CPPONLY
 /** genetic structure. Shared by individuals of one population
 
@@ -71,8 +89,8 @@ public:
 	GenoStructure() : m_ploidy(2), m_totNumLoci(0),
 		m_numLoci(0), m_chromTypes(), m_chromX(-1), m_chromY(-1), m_mitochondrial(-1), m_customized(),
 		m_haplodiploid(false), m_lociPos(0), m_chromIndex(0),
-		m_chromNames(), m_alleleNames(), m_lociNames(), m_lociNameMap(), m_infoFields(0), m_lociPosMap(),
-		m_refCount(0)
+		m_chromNames(), m_alleleNames(), m_lociNameIds(), m_lociNameMap(), m_infoFields(0),
+		m_infoFieldMap(), m_lociPosMap(), m_refCount(0)
 	{
 	}
 
@@ -122,12 +140,31 @@ public:
 	}
 
 
+	/// CPPONLY append locus names [\e beginLocus, \e endLocus) from the
+	/// shared name pool to \e names
+	void appendLociNames(vectorstr & names, size_t beginLocus, size_t endLocus) const;
+
+	/// CPPONLY materialize all locus names from the shared name pool
+	vectorstr lociNamesVec() const;
+
 	/// CPPONLY
 	void buildLociPosMap() const;
 
 	/// CPPONLY
 	void setChromTypes(const vectoru & chromTypes);
 
+	/** CPPONLY write the constructed (validated and sorted) structure to
+	 *  warm-start cache file \e filename in a flat binary format. Return
+	 *  \c false if the file cannot be written.
+	 */
+	bool saveStruCache(const string & filename) const;
+
+	/** CPPONLY read a structure back from warm-start cache file
+	 *  \e filename, skipping validation and name-map construction costs.
+	 *  Return \c false if the file is absent, incompatible or damaged.
+	 */
+	bool loadStruCache(const string & filename);
+
 private:
 	friend class boost::serialization::access;
 
@@ -141,7 +178,10 @@ private:
 		ar & m_lociPos;
 		ar & m_chromNames;
 		ar & m_alleleNames;
-		ar & m_lociNames;
+		// locus names are materialized from the shared name pool so that
+		// the archive format does not depend on pool indexes
+		const vectorstr lociNames = lociNamesVec();
+		ar & lociNames;
 		ar & m_infoFields;
 		/// do not save load chromosome map
 	}
@@ -164,15 +204,22 @@ private:
 		ar & m_lociPos;
 		ar & m_chromNames;
 		ar & m_alleleNames;
-		ar & m_lociNames;
+		vectorstr lociNames;
+		ar & lociNames;
 		ar & m_infoFields;
 
+		m_infoFieldMap.clear();
+		for (size_t i = 0; i < m_infoFields.size(); ++i)
+			m_infoFieldMap[m_infoFields[i]] = i;
+
+		m_lociNameIds.clear();
+		m_lociNameIds.reserve(lociNames.size());
+		for (size_t i = 0; i < lociNames.size(); ++i)
+			m_lociNameIds.push_back(internLocusName(lociNames[i]));
 		m_lociNameMap.clear();
-		if (!m_lociNames.empty()) {
-			for (size_t i = 0; i < m_lociNames.size(); ++i) {
-				if (!m_lociNames[i].empty())
-					m_lociNameMap[m_lociNames[i]] = i;
-			}
+		for (size_t i = 0; i < lociNames.size(); ++i) {
+			if (!lociNames[i].empty())
+				m_lociNameMap[m_lociNameIds[i]] = i;
 		}
 
 		// build chromosome index
@@ -227,15 +274,19 @@ private:
 	/// allele names
 	matrixstr m_alleleNames;
 
-	/// loci names
-	vectorstr m_lociNames;
+	/// indexes of locus names in the shared name pool, empty if no name
+	/// was given
+	vectoru m_lociNameIds;
 
-	/// map of locinames
-	map<string, size_t> m_lociNameMap;
+	/// map of locinames, from name pool index to locus index
+	map<size_t, size_t> m_lociNameMap;
 
 	/// name of the information field
 	vectorstr m_infoFields;
 
+	/// map of information field names
+	map<string, size_t> m_infoFieldMap;
+
 	mutable map<genomic_pos, size_t> m_lociPosMap;
 
 	mutable UINT m_refCount;
@@ -413,11 +464,17 @@ public:
 	 */
 	UINT ploidy() const
 	{
-
+#ifdef FIXED_PLOIDY
+		// a fixed-geometry build: the constructor of GenoStructure rejects
+		// any other ploidy, so this is a compile-time constant and loops
+		// over homologous sets can be unrolled by the compiler
+		return FIXED_PLOIDY;
+#else
 		DBG_FAILIF(m_genoStruIdx == MaxTraitIndex, SystemError,
 			"Ploidy: You have not set genoStructure. Please use setGenoStrucutre to set such info.");
 
 		return s_genoStruRepository[m_genoStruIdx].m_ploidy;
+#endif
 	}
 
 
@@ -575,10 +632,15 @@ public:
 	 */
 	size_t numChrom() const
 	{
+#ifdef FIXED_NUMCHROM
+		// see ploidy() for the fixed-geometry builds
+		return FIXED_NUMCHROM;
+#else
 		DBG_FAILIF(m_genoStruIdx == MaxTraitIndex, SystemError,
 			"numChrom: You have not set genoStructure. Please use setGenoStrucutre to set such info.");
 
 		return s_genoStruRepository[m_genoStruIdx].m_numLoci.size();
+#endif
 	}
 
 
@@ -738,8 +800,8 @@ public:
 			(boost::format("Locus index %1% out of range of 0 ~ %2%") % locus %
 			 s_genoStruRepository[m_genoStruIdx].m_totNumLoci).str());
 
-		const vectorstr & names = s_genoStruRepository[m_genoStruIdx].m_lociNames;
-		return names.empty() ? string() : names[locus];
+		const vectoru & nameIds = s_genoStruRepository[m_genoStruIdx].m_lociNameIds;
+		return nameIds.empty() ? string() : internedLocusName(nameIds[locus]);
 	}
 
 
@@ -750,7 +812,7 @@ public:
 	 */
 	vectorstr lociNames() const
 	{
-		return s_genoStruRepository[m_genoStruIdx].m_lociNames;
+		return s_genoStruRepository[m_genoStruIdx].lociNamesVec();
 	}
 
 
@@ -761,13 +823,16 @@ public:
 	 */
 	size_t locusByName(const string name) const
 	{
-		const map<string, size_t> & names = s_genoStruRepository[m_genoStruIdx].m_lociNameMap;
+		const map<size_t, size_t> & names = s_genoStruRepository[m_genoStruIdx].m_lociNameMap;
 
-		map<string, size_t>::const_iterator it = names.find(name);
+		size_t id = findLocusName(name);
 
-		if (it == names.end())
-			throw ValueError("Failed to find locus with name " + name);
-		return it->second;
+		if (id != NOT_FOUND) {
+			map<size_t, size_t>::const_iterator it = names.find(id);
+			if (it != names.end())
+				return it->second;
+		}
+		throw ValueError("Failed to find locus with name " + name);
 	}
 
 
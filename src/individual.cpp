@@ -38,6 +38,8 @@ extern "C" PyObject * PyDefDict_New();
 
 namespace simuPOP {
 
+ATOMICLONG g_indGenoModCount = 0;
+
 
 Individual & Individual::operator=(const Individual & rhs)
 {
@@ -60,7 +62,7 @@ Individual & Individual::copyFrom(const Individual & rhs)
 	copy(rhs.genoBegin(), rhs.genoEnd(), genoBegin());
 #endif
 	copy(rhs.infoBegin(), rhs.infoEnd(), infoBegin());
-	LINEAGE_EXPR(copy(rhs.lineageBegin(), rhs.lineageEnd(), lineageBegin()));
+	LINEAGE_EXPR(copyLineage(rhs.lineageBegin(), rhs.lineageEnd(), lineageBegin()));
 	// also copy genoStru pointer...
 	this->setGenoStruIdx(rhs.genoStruIdx());
 	return *this;
@@ -234,6 +236,10 @@ PyObject * Individual::genotype(const uintList & ply, const uintList & ch)
 		             "It will become invalid once the population changes. Please use "
 		             "list(ind.genotype()) if you would like to keep a copy of genotypes");
 
+	// the returned array is writable and writes through it cannot be
+	// observed, so the export itself counts as a modification
+	fetchAndIncrement(&g_indGenoModCount);
+
 	size_t beginP = 0;
 	size_t endP = 0;
 	size_t beginCh = 0;
@@ -819,6 +825,9 @@ void Individual::setAllele(ULONG allele, size_t idx, int p, int chrom)
 {
 	DBG_FAILIF(p < 0 && chrom >= 0, ValueError,
 		"A valid ploidy index has to be specified if chrom is non-positive");
+	// an individual does not know its population, so cached statistics
+	// are invalidated through a module-wide counter
+	fetchAndIncrement(&g_indGenoModCount);
 	if (p < 0) {
 		CHECKRANGEGENOSIZE(idx);
 #ifdef MUTANTALLELE
@@ -876,6 +885,8 @@ void Individual::setAlleleLineage(long lineage, size_t idx, int p, int chrom)
 
 void Individual::setGenotype(const uintList & genoList, const uintList & ply, const uintList & ch)
 {
+	// see setAllele for the reason of this module-wide invalidation
+	fetchAndIncrement(&g_indGenoModCount);
 	const vectoru & geno = genoList.elems();
 
 	size_t sz = geno.size();
@@ -52,6 +52,17 @@ using std::pair;
 
 namespace simuPOP {
 
+/** CPPONLY
+ *  A module-wide counter that is bumped by individual-level genotype
+ *  writes (Individual.setAllele, Individual.setGenotype and the export
+ *  of writable genotype arrays), which do not know which population
+ *  owns their storage and therefore cannot call
+ *  Population::markGenoModified directly. Population folds this counter
+ *  into its own modification stamp so that cached statistics and
+ *  genotype digests are also invalidated by these write paths.
+ */
+extern ATOMICLONG g_indGenoModCount;
+
 
 /** this class implements a Python itertor class that can be used to iterate
  *  through individuals in a (sub)population. If allInds are true,
@@ -331,7 +342,10 @@ public:
 	 *  will be returned. If multiple chromosomes are specified, there should
 	 *  not be gaps between chromosomes. This function ignores type of
 	 *  chromosomes so it will return unused alleles for sex and mitochondrial
-	 *  chromosomes.
+	 *  chromosomes. Exporting the array invalidates cached statistics, but
+	 *  writes through it later cannot be observed, so statistics calculated
+	 *  between such writes may be served from cache until the next export or
+	 *  genotype-modifying operation.
 	 *  <group>2-genotype</group>
 	 */
 	PyObject * genotype(const uintList & ploidy = uintList(), const uintList & chroms = uintList());
@@ -504,6 +518,24 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  raw flags byte, used when ancestral generations are spilled to disk.
+	 */
+	unsigned char flags() const
+	{
+		return m_flags;
+	}
+
+
+	/** CPPONLY
+	 *  restore a raw flags byte.
+	 */
+	void setFlags(unsigned char flags)
+	{
+		m_flags = flags;
+	}
+
+
 	/** Return the value of an information field \e filed (by index or name).
 	 *  <tt>ind.info(name)</tt> is equivalent to <tt>ind.name</tt> although the
 	 *  function form allows the use of indexes of information fieldes.
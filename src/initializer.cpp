@@ -57,10 +57,6 @@ bool InitSex::apply(Population & pop) const
 			vectorf prop(2, m_maleProp);
 			prop[1] = 1 - prop[0];
 			ws.set(prop.begin(), prop.end(), pop.subPopSize(*sp));
-		} else if (m_sex.empty()) {
-			vectorf prop(2, m_maleFreq);
-			prop[1] = 1 - prop[0];
-			ws.set(prop.begin(), prop.end());
 		}
 		pop.activateVirtualSubPop(*sp);
 		IndIterator ind = pop.indIterator(sp->subPop());
@@ -68,7 +64,9 @@ bool InitSex::apply(Population & pop) const
 		if (!m_sex.empty())
 			for (; ind.valid(); ++ind, ++idx)
 				ind->setSex(m_sex[idx % sexSz] == 1 ? MALE : FEMALE);
-		else {
+		else if (m_maleProp >= 0) {
+			// exact proportions read the pre-shuffled sequence of the
+			// sampler, which does not consume random numbers per draw
 			if (numThreads() > 1) {
 #ifdef _OPENMP
 #  pragma omp parallel private(ind)
@@ -81,6 +79,41 @@ bool InitSex::apply(Population & pop) const
 			} else
 				for (; ind.valid(); ++ind)
 					ind->setSex(ws.draw() == 0 ? MALE : FEMALE);
+		} else {
+			// random sex is decided by comparing batches of uniform
+			// deviates against the male frequency, avoiding a call into
+			// the random number generator or a sampler per individual
+			if (numThreads() > 1) {
+#ifdef _OPENMP
+#  pragma omp parallel private(ind)
+				{
+					ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
+					double buf[256];
+					size_t nBuf = 0;
+					size_t iBuf = 0;
+					for (; ind.valid(); ++ind) {
+						if (iBuf == nBuf) {
+							nBuf = 256;
+							getRNG().fillUniform(buf, nBuf);
+							iBuf = 0;
+						}
+						ind->setSex(buf[iBuf++] < m_maleFreq ? MALE : FEMALE);
+					}
+				}
+#endif
+			} else {
+				double buf[256];
+				size_t nBuf = 0;
+				size_t iBuf = 0;
+				for (; ind.valid(); ++ind) {
+					if (iBuf == nBuf) {
+						nBuf = 256;
+						getRNG().fillUniform(buf, nBuf);
+						iBuf = 0;
+					}
+					ind->setSex(buf[iBuf++] < m_maleFreq ? MALE : FEMALE);
+				}
+			}
 		}
 		pop.deactivateVirtualSubPop(sp->subPop());
 	}
@@ -215,6 +248,7 @@ string InitGenotype::describe(bool /* format */) const
 
 vectorf InitGenotype::getFreqOrProp(size_t locus, const vspID & vsp) const
 {
+	GILGuard gil;
 	pyFunc func = m_freq.func().isValid() ? m_freq.func() : m_prop.func();
 
 	PyObject * args = PyTuple_New(func.numArgs());
@@ -252,6 +286,7 @@ vectorf InitGenotype::getFreqOrProp(size_t locus, const vspID & vsp) const
 
 bool InitGenotype::apply(Population & pop) const
 {
+	pop.markGenoModified();
 	const subPopList subPops = applicableSubPops(pop);
 
 	const vectoru & loci = m_loci.elems(&pop);
@@ -406,24 +441,127 @@ bool InitGenotype::apply(Population & pop) const
 			} else {
 				// use allele frequency
 				if (m_freq.func().isValid()) {
-					for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
-						WeightedSampler ws(getFreqOrProp(*loc, *sp));
-						//
-						IndIterator it = pop.indIterator(sp->subPop());
-						for (; it.valid(); ++it) {
-							for (vectoru::iterator p = ploidy.begin(); p != ploidy.end(); ++p) {
-								it->setAllele(TO_ALLELE(ws.draw()), *loc, static_cast<int>(*p));
-							}
+					// The user-provided Python function has to be called
+					// serially, so cumulative tables for all loci are built
+					// up-front and alleles are then drawn from batches of
+					// uniform random numbers.
+					vector<WeightedSampler> samplers(loci.size());
+					for (size_t j = 0; j < loci.size(); ++j) {
+						vectorf freq = getFreqOrProp(loci[j], *sp);
+						samplers[j].set(freq.begin(), freq.end());
+					}
+#if defined(_OPENMP) && !defined(MUTANTALLELE)
+					// writing to the compressed mutant module is not thread-safe.
+					if (numThreads() > 1) {
+#  pragma omp parallel
+						{
+							IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
+							double buf[256];
+							size_t nBuf = 0;
+							size_t iBuf = 0;
+							for (; it.valid(); ++it)
+								for (vectoru::iterator p = ploidy.begin(); p != ploidy.end(); ++p)
+									for (size_t j = 0; j < loci.size(); ++j) {
+										if (iBuf == nBuf) {
+											nBuf = 256;
+											getRNG().fillUniform(buf, nBuf);
+											iBuf = 0;
+										}
+										it->setAllele(TO_ALLELE(samplers[j].draw(buf[iBuf++])), loci[j], static_cast<int>(*p));
+									}
 						}
+					} else
+#endif
+					{
+						IndIterator it = pop.indIterator(sp->subPop());
+						double buf[256];
+						size_t nBuf = 0;
+						size_t iBuf = 0;
+						for (; it.valid(); ++it)
+							for (vectoru::iterator p = ploidy.begin(); p != ploidy.end(); ++p)
+								for (size_t j = 0; j < loci.size(); ++j) {
+									if (iBuf == nBuf) {
+										nBuf = 256;
+										getRNG().fillUniform(buf, nBuf);
+										iBuf = 0;
+									}
+									it->setAllele(TO_ALLELE(samplers[j].draw(buf[iBuf++])), loci[j], static_cast<int>(*p));
+								}
 					}
 				} else {
-					// use specified frequencies
-					IndIterator it = pop.indIterator(sp->subPop());
-					WeightedSampler ws(m_freq.elems());
-					for (; it.valid(); ++it) {
-						for (vectoru::iterator p = ploidy.begin(); p != ploidy.end(); ++p) {
-							for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
-								it->setAllele(TO_ALLELE(ws.draw()), *loc, static_cast<int>(*p));
+#ifdef MUTANTALLELE
+					// Drawing an allele for every slot writes mostly zeros
+					// when the wildtype frequency is high, and even a zero
+					// write has to walk the compressed storage. If no mutant
+					// is stored yet, draw the number of mutant copies at
+					// each locus and write only those positions, so that
+					// initialization cost is proportional to the number of
+					// mutants instead of the number of allele slots.
+					const vectorf & freqs = m_freq.elems();
+					if (pop.totNumMutants() == 0 && !sp->isVirtual() &&
+					    freqs.size() > 1 && freqs[0] >= 0.5) {
+						std::vector<Individual *> inds;
+						for (IndIterator it = pop.indIterator(sp->subPop()); it.valid(); ++it)
+							inds.push_back(&*it);
+						size_t nSlots = inds.size() * ploidy.size();
+						// conditional distribution of non-wildtype alleles
+						WeightedSampler mutant(vectorf(freqs.begin() + 1, freqs.end()));
+						for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+							size_t numMutants = getRNG().randBinomial(static_cast<UINT>(nSlots), 1. - freqs[0]);
+							// draw numMutants distinct slots (Floyd's algorithm)
+							std::set<size_t> slots;
+							for (size_t j = nSlots - numMutants; j < nSlots; ++j) {
+								size_t s = getRNG().randInt(j + 1);
+								if (!slots.insert(s).second)
+									slots.insert(j);
+							}
+							for (std::set<size_t>::const_iterator s = slots.begin(); s != slots.end(); ++s)
+								inds[*s / ploidy.size()]->setAllele(TO_ALLELE(mutant.draw() + 1),
+									*loc, static_cast<int>(ploidy[*s % ploidy.size()]));
+						}
+					} else
+#endif
+					{
+						// use specified frequencies. The cumulative table is
+						// read-only after set() so one sampler can be shared
+						// by all threads.
+						WeightedSampler ws(m_freq.elems());
+#if defined(_OPENMP) && !defined(MUTANTALLELE)
+						if (numThreads() > 1) {
+#  pragma omp parallel
+							{
+								IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
+								double buf[256];
+								size_t nBuf = 0;
+								size_t iBuf = 0;
+								for (; it.valid(); ++it)
+									for (vectoru::iterator p = ploidy.begin(); p != ploidy.end(); ++p)
+										for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+											if (iBuf == nBuf) {
+												nBuf = 256;
+												getRNG().fillUniform(buf, nBuf);
+												iBuf = 0;
+											}
+											it->setAllele(TO_ALLELE(ws.draw(buf[iBuf++])), *loc, static_cast<int>(*p));
+										}
+							}
+						} else
+#endif
+						{
+							IndIterator it = pop.indIterator(sp->subPop());
+							double buf[256];
+							size_t nBuf = 0;
+							size_t iBuf = 0;
+							for (; it.valid(); ++it)
+								for (vectoru::iterator p = ploidy.begin(); p != ploidy.end(); ++p)
+									for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+										if (iBuf == nBuf) {
+											nBuf = 256;
+											getRNG().fillUniform(buf, nBuf);
+											iBuf = 0;
+										}
+										it->setAllele(TO_ALLELE(ws.draw(buf[iBuf++])), *loc, static_cast<int>(*p));
+									}
 						}
 					}
 				}
@@ -71,6 +71,7 @@ GlobalSeqSexModel::GlobalSeqSexModel(const vectorf &sex) : m_sex(), m_index(0)
 
 Sex FuncSexModel::getSex(UINT count)
 {
+	GILGuard gil;
 	if (m_generator.isValid())
 	{
 		long val;
@@ -109,6 +110,7 @@ Sex FuncSexModel::getSex(UINT count)
 
 UINT FuncNumOffModel::getNumOff(ssize_t gen)
 {
+	GILGuard gil;
 	if (m_generator.isValid())
 	{
 		int attempts = 0;
@@ -166,7 +168,7 @@ UINT FuncNumOffModel::getNumOff(ssize_t gen)
 }
 
 OffspringGenerator::OffspringGenerator(const opList &ops,
-									   const floatListFunc &numOffspring, const floatListFunc &sexMode) : m_numOffModel(NULL), m_sexModel(NULL), m_transmitters(ops), m_initialized(false)
+									   const floatListFunc &numOffspring, const floatListFunc &sexMode) : m_numOffModel(NULL), m_sexModel(NULL), m_transmitters(ops), m_initialized(false), m_opsInitialized(false)
 {
 
 	if (numOffspring.size() == 0)
@@ -304,13 +306,31 @@ Sex OffspringGenerator::getSex(UINT count)
 	return m_sexModel->getSex(count);
 }
 
-void OffspringGenerator::initialize(const Population &pop, size_t /* subPop */)
+void OffspringGenerator::initializeOps(const Population &pop)
 {
 	opList::const_iterator iop = m_transmitters.begin();
 	opList::const_iterator iopEnd = m_transmitters.end();
 
 	for (; iop != iopEnd; ++iop)
 		(*iop)->initializeIfNeeded(*pop.rawIndBegin());
+}
+
+void OffspringGenerator::initialize(const Population &pop, size_t /* subPop */)
+{
+	// in the deme-parallel mode of MatingScheme::mate the one-time operator
+	// initialization was already run, serially, on the scheme this
+	// generator was cloned from, and must not be repeated here because this
+	// function runs inside the parallel region
+	if (!m_opsInitialized)
+		initializeOps(pop);
+
+	// replicate and generation do not change while a generation is being
+	// populated, so applicability can be decided here instead of once per
+	// candidate offspring in generateOffspring().
+	m_activeTransmitters.clear();
+	for (size_t i = 0; i < m_transmitters.size(); ++i)
+		if (m_transmitters[i]->isActive(const_cast<Population &>(pop).rep(), pop.gen()))
+			m_activeTransmitters.push_back(i);
 
 	m_initialized = true;
 }
@@ -352,13 +372,13 @@ UINT OffspringGenerator::generateOffspring(Population &pop, Population &offPop,
 		it->setFirstOffspring(count == 0);
 		//
 		accept = true;
-		opList::const_iterator iop = m_transmitters.begin();
-		opList::const_iterator iopEnd = m_transmitters.end();
-		for (; iop != iopEnd; ++iop)
+		// only the operators found active by initialize() are applied, so
+		// rejected candidates are replaced without re-testing applicability
+		vectoru::const_iterator iidx = m_activeTransmitters.begin();
+		vectoru::const_iterator iidxEnd = m_activeTransmitters.end();
+		for (; iidx != iidxEnd; ++iidx)
 		{
-			if (!(*iop)->isActive(pop.rep(), pop.gen()))
-				continue;
-			if (!(*iop)->applyDuringMating(pop, offPop, it, dad, mom))
+			if (!(*(m_transmitters.begin() + *iidx))->applyDuringMating(pop, offPop, it, dad, mom))
 			{
 				accept = false;
 				break;
@@ -576,11 +596,81 @@ void ControlledOffspringGenerator::initialize(const Population &pop, size_t subP
 	m_aaAttempt = 200;
 }
 
+/// CPPONLY
+bool ControlledOffspringGenerator::acceptableParents(const Population &pop, Individual *dad, Individual *mom)
+{
+	// without parental information every family has to be produced first
+	if (dad == NULL && mom == NULL)
+		return true;
+
+	const vectoru &loci = m_loci.elems(&pop);
+	size_t ply = pop.ploidy();
+
+	if (m_freqRequMet)
+	{
+		// expected allele counts are reached so only families without the
+		// controlled alleles are acceptable. A parent who carries the allele
+		// on all homologous copies transmits it with certainty, so such
+		// families are rejected before they are produced. The escape counter
+		// is decremented as for produced families so that mutation during
+		// mating (which this test cannot see) can not stall the generator.
+		if (m_AAattempt <= 1)
+			return true;
+		for (size_t i = 0; i < loci.size(); ++i)
+		{
+			bool dadHomo = dad != NULL;
+			bool momHomo = mom != NULL;
+			for (size_t p = 0; p < ply; ++p)
+			{
+				if (dadHomo && (m_flip[i] ? (dad->allele(loci[i], p) == m_alleles[i])
+										  : (dad->allele(loci[i], p) != m_alleles[i])))
+					dadHomo = false;
+				if (momHomo && (m_flip[i] ? (mom->allele(loci[i], p) == m_alleles[i])
+										  : (mom->allele(loci[i], p) != m_alleles[i])))
+					momHomo = false;
+			}
+			if (dadHomo || momHomo)
+			{
+				m_AAattempt--;
+				return false;
+			}
+		}
+		return true;
+	}
+	// more controlled alleles are needed: a family can only be accepted if a
+	// parent carries a needed allele, so parents without one are rejected
+	// before transmission. Near fixation this replaces the production and
+	// rejection of many complete families with a few allele lookups.
+	if (m_aaAttempt <= 1)
+		return true;
+	for (size_t i = 0; i < loci.size(); ++i)
+	{
+		if (m_curAllele[i] >= m_totAllele[i])
+			continue;
+		for (size_t p = 0; p < ply; ++p)
+		{
+			if (dad != NULL && (m_flip[i] ? (dad->allele(loci[i], p) != m_alleles[i])
+										  : (dad->allele(loci[i], p) == m_alleles[i])))
+				return true;
+			if (mom != NULL && (m_flip[i] ? (mom->allele(loci[i], p) != m_alleles[i])
+										  : (mom->allele(loci[i], p) == m_alleles[i])))
+				return true;
+		}
+	}
+	m_aaAttempt--;
+	return false;
+}
+
 /// CPPONLY
 UINT ControlledOffspringGenerator::generateOffspring(Population &pop, Population &offPop, Individual *dad, Individual *mom,
 													 RawIndIterator &offBegin,
 													 RawIndIterator &offEnd)
 {
+	// families that can not be accepted are rejected from the parental
+	// genotypes alone, without producing any offspring
+	if (!acceptableParents(pop, dad, mom))
+		return 0;
+
 	const vectoru &loci = m_loci.elems(&pop);
 	size_t nLoci = loci.size();
 	//
@@ -738,7 +828,7 @@ void RandomParentChooser::initialize(Population &pop, size_t sp)
 	// In a virtual subpopulation, because m_begin + ... is **really** slow
 	// It is a good idea to cache IndIterators. This is however inefficient
 	// for non-virtual populations
-	vectorf fitness;
+	m_fitness.clear();
 	if (pop.hasActivatedVirtualSubPop(sp) || m_choice != ANY_SEX)
 	{
 		IndIterator it = pop.indIterator(sp);
@@ -748,7 +838,7 @@ void RandomParentChooser::initialize(Population &pop, size_t sp)
 			{
 				m_index.push_back(it.rawIter());
 				if (m_selection)
-					fitness.push_back(it->info(fit_id));
+					m_fitness.push_back(it->info(fit_id));
 			}
 			DBG_FAILIF(m_index.empty(), RuntimeError, "Can not select parent from an empty subpopulation.");
 		}
@@ -761,7 +851,7 @@ void RandomParentChooser::initialize(Population &pop, size_t sp)
 				{
 					m_index.push_back(it.rawIter());
 					if (m_selection)
-						fitness.push_back(it->info(fit_id));
+						m_fitness.push_back(it->info(fit_id));
 				}
 			}
 			DBG_FAILIF(m_index.empty(), RuntimeError,
@@ -777,13 +867,18 @@ void RandomParentChooser::initialize(Population &pop, size_t sp)
 			IndInfoIterator it = pop.infoBegin(fit_id, sp);
 			IndInfoIterator it_end = pop.infoEnd(fit_id, sp);
 			for (; it != it_end; ++it) {
-				fitness.push_back(*it);
+				m_fitness.push_back(*it);
 			}
 		}
 	}
 
 	if (m_selection)
-		m_sampler.set(fitness.begin(), fitness.end());
+	{
+		m_sampler.set(m_fitness.begin(), m_fitness.end());
+		// indexes pre-drawn under the weights of a previous initialization
+		// are invalid and are discarded here.
+		m_drawn.assign(numThreads(), vectoru());
+	}
 	else
 	{
 		m_size = m_index.size();
@@ -798,6 +893,25 @@ void RandomParentChooser::initialize(Population &pop, size_t sp)
 	m_initialized = true;
 }
 
+// number of parent indexes that are pre-drawn from the weighted sampler
+// when a thread exhausts its block of buffered draws
+#define PREDRAW_BLOCK 512
+
+size_t RandomParentChooser::drawParentIndex()
+{
+#ifdef _OPENMP
+	vectoru & drawn = m_drawn[omp_get_thread_num()];
+#else
+	vectoru & drawn = m_drawn[0];
+#endif
+	if (drawn.empty())
+		m_sampler.drawSamples(PREDRAW_BLOCK, drawn);
+	size_t idx = drawn.back();
+	drawn.pop_back();
+	return idx;
+}
+
+
 ParentChooser::IndividualPair RandomParentChooser::chooseParents()
 {
 	DBG_ASSERT(initialized(), SystemError,
@@ -816,14 +930,14 @@ ParentChooser::IndividualPair RandomParentChooser::chooseParents()
 	{
 		if (m_selection)
 			// basePtr points to the beginning of the population, not subpopulation
-			ind = &*(m_basePtr + m_shift + m_sampler.draw());
+			ind = &*(m_basePtr + m_shift + drawParentIndex());
 		else
 			ind = &*(m_basePtr + m_shift + getRNG().randInt(static_cast<ULONG>(m_size)));
 	}
 	else
 	{
 		if (m_selection)
-			ind = &*(m_index[m_sampler.draw()]);
+			ind = &*(m_index[drawParentIndex()]);
 		else
 			ind = &*(m_index[getRNG().randInt(static_cast<ULONG>(m_size))]);
 	}
@@ -858,20 +972,68 @@ void RandomParentsChooser::initialize(Population &pop, size_t subPop)
 		maleFitness = m_fitness.begin();
 		femaleFitness = m_fitness.rbegin();
 	}
-	IndIterator it = pop.indIterator(subPop);
-	for (; it.valid(); it++)
-	{
-		if (it->sex() == MALE)
+#ifdef _OPENMP
+	// the partition of a subpopulation by sex is a plain scan that can be
+	// sharded over threads: each thread scans its slice of the
+	// subpopulation into local buffers, which are then stitched together
+	// in slice order so that the layout of the serial scan is reproduced
+	// exactly. Small subpopulations are scanned serially because the cost
+	// of the parallel region would exceed that of the scan itself.
+	if (numThreads() > 1 && pop.subPopSize(subPop) >= 10000)
+	{
+		vector<vector<RawIndIterator> > maleIdx(numThreads());
+		vector<vector<RawIndIterator> > femaleIdx(numThreads());
+		vector<vectorf> maleFit(numThreads());
+		vector<vectorf> femaleFit(numThreads());
+#pragma omp parallel
 		{
-			*maleIndex++ = it.rawIter();
-			if (m_selection)
-				*maleFitness++ = it->info(fit_id);
+			size_t id = omp_get_thread_num();
+			IndIterator it = pop.indIterator(subPop, id);
+			for (; it.valid(); ++it)
+			{
+				if (it->sex() == MALE)
+				{
+					maleIdx[id].push_back(it.rawIter());
+					if (m_selection)
+						maleFit[id].push_back(it->info(fit_id));
+				}
+				else
+				{
+					femaleIdx[id].push_back(it.rawIter());
+					if (m_selection)
+						femaleFit[id].push_back(it->info(fit_id));
+				}
+			}
 		}
-		else
+		for (size_t id = 0; id < numThreads(); ++id)
 		{
-			*femaleIndex++ = it.rawIter();
+			maleIndex = std::copy(maleIdx[id].begin(), maleIdx[id].end(), maleIndex);
+			femaleIndex = std::copy(femaleIdx[id].begin(), femaleIdx[id].end(), femaleIndex);
 			if (m_selection)
-				*femaleFitness++ = it->info(fit_id);
+			{
+				maleFitness = std::copy(maleFit[id].begin(), maleFit[id].end(), maleFitness);
+				femaleFitness = std::copy(femaleFit[id].begin(), femaleFit[id].end(), femaleFitness);
+			}
+		}
+	}
+	else
+#endif
+	{
+		IndIterator it = pop.indIterator(subPop);
+		for (; it.valid(); it++)
+		{
+			if (it->sex() == MALE)
+			{
+				*maleIndex++ = it.rawIter();
+				if (m_selection)
+					*maleFitness++ = it->info(fit_id);
+			}
+			else
+			{
+				*femaleIndex++ = it.rawIter();
+				if (m_selection)
+					*femaleFitness++ = it->info(fit_id);
+			}
 		}
 	}
 	// m_numMale + m_numFemale might not be pop.subPopSize because of virtual subpopulation
@@ -896,6 +1058,16 @@ void RandomParentsChooser::initialize(Population &pop, size_t subPop)
 	DBG_FAILIF(!m_replacement && m_selection, ValueError,
 			   "Selection is not allowed in random sample without replacement");
 
+	DBG_FAILIF(m_batchSize > 0 && !m_replacement, ValueError,
+			   "Batched parent draws require choosing parents with replacement");
+
+	if (m_batchSize > 0)
+	{
+		// discard batches drawn for a previous subpopulation or generation
+		m_batch.assign(numThreads(), vector<IndividualPair>());
+		m_batchCursor.assign(numThreads(), 0);
+	}
+
 	m_initialized = true;
 }
 
@@ -926,6 +1098,40 @@ ParentChooser::IndividualPair RandomParentsChooser::chooseParents()
 	if (m_numFemale == 0)
 		throw RuntimeError("RandomParentsChooser fails because there is no female individual in a subpopulation ");
 
+	if (m_batchSize > 0)
+	{
+#ifdef _OPENMP
+		size_t id = omp_get_thread_num();
+#else
+		size_t id = 0;
+#endif
+		vector<IndividualPair> &batch = m_batch[id];
+		if (m_batchCursor[id] >= batch.size())
+		{
+			batch.resize(m_batchSize);
+			for (size_t i = 0; i < m_batchSize; ++i)
+			{
+				if (m_selection)
+				{
+					batch[i].first = &**(m_index.begin() + m_malesampler.draw());
+					batch[i].second = &**(m_index.rbegin() + m_femalesampler.draw());
+				}
+				else
+				{
+					batch[i].first = &**(m_index.begin() + getRNG().randInt(static_cast<ULONG>(m_numMale)));
+					batch[i].second = &**(m_index.rbegin() + getRNG().randInt(static_cast<ULONG>(m_numFemale)));
+				}
+			}
+			// serve pairs in order of the father's location, so that
+			// transmission walks the parental genotype array instead of
+			// jumping randomly through it. Pairs stay intact, so the
+			// drawn matings are exactly those of the unbatched case.
+			std::sort(batch.begin(), batch.end());
+			m_batchCursor[id] = 0;
+		}
+		return batch[m_batchCursor[id]++];
+	}
+
 	if (m_selection)
 	{
 		// using weighted sampler.
@@ -1246,6 +1452,7 @@ PyParentsChooser::PyParentsChooser(PyObject *pc)
 
 void PyParentsChooser::initialize(Population &pop, size_t sp)
 {
+	GILGuard gil;
 #if PY_VERSION_HEX < 0x02040000
 	throw SystemError("Your Python version does not have good support for generator"
 					  " so this python parent chooser can not be used.");
@@ -1283,6 +1490,7 @@ void PyParentsChooser::initialize(Population &pop, size_t sp)
 
 ParentChooser::IndividualPair PyParentsChooser::chooseParents()
 {
+	GILGuard gil;
 	DBG_ASSERT(initialized(), SystemError,
 			   "Please initialize this parent chooser before using it");
 
@@ -1349,6 +1557,7 @@ ParentChooser::IndividualPair PyParentsChooser::chooseParents()
 
 void PyParentsChooser::finalize()
 {
+	GILGuard gil;
 	DBG_FAILIF(m_popObj == NULL, SystemError, "Python generator is not properly initialized.");
 	Py_DECREF(m_popObj);
 	m_generator.set(NULL);
@@ -1356,13 +1565,14 @@ void PyParentsChooser::finalize()
 	m_initialized = false;
 }
 
-MatingScheme::MatingScheme(const uintListFunc &subPopSize)
-	: m_subPopSize(subPopSize)
+MatingScheme::MatingScheme(const uintListFunc &subPopSize, bool inPlace)
+	: m_subPopSize(subPopSize), m_inPlace(inPlace)
 {
 }
 
 bool MatingScheme::prepareScratchPop(Population &pop, Population &scratch)
 {
+	GILGuard gil;
 	if (scratch.genoStruIdx() != pop.genoStruIdx())
 		scratch.fitGenoStru(pop.genoStruIdx());
 
@@ -1415,7 +1625,7 @@ bool MatingScheme::prepareScratchPop(Population &pop, Population &scratch)
 	// The numbers might be used by during mating operator
 	scratch.setGen(pop.gen());
 	scratch.setRep(pop.rep());
-	scratch.clearInfo();
+	// information fields are already zeroed by fitSubPopStru
 #ifdef MUTANTALLELE
 	// for mutant allele, clearing all existing genotype will make subsequent
 	// copyChromosomes much faster ...
@@ -1430,16 +1640,170 @@ bool MatingScheme::prepareScratchPop(Population &pop, Population &scratch)
 
 bool MatingScheme::mate(Population &pop, Population &scratch)
 {
+	// breeding a generation is a long C++ phase, so let other Python
+	// threads of the process run while it lasts. Code paths that call
+	// back into Python (function callbacks, expression evaluation,
+	// population variables) re-acquire the GIL through GILGuard.
+	GILRelease gil;
+
+	// The in-place mode needs a constant population size (so that offspring
+	// slices line up with parental slices) and no stored ancestral
+	// generations (the parental generation is destroyed during mating).
+	if (m_inPlace && pop.ancestralDepth() == 0 &&
+	    m_subPopSize.empty() && !m_subPopSize.func().isValid())
+		return mateInPlace(pop, scratch);
+
 	// scrtach will have the right structure.
 	if (!prepareScratchPop(pop, scratch))
 		return false;
-	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
-		if (!mateSubPop(pop, scratch, sp, scratch.rawIndBegin(sp), scratch.rawIndEnd(sp)))
+#ifdef _OPENMP
+	if (numThreads() > 1 && pop.numSubPop() > 1 && parallelizableAcrossSubPops())
+	{
+		// Subpopulations are mated concurrently, each through its own
+		// clone of this mating scheme so that parent chooser and
+		// offspring generator state stays private, and each into its own
+		// offspring slice. With schedule(static, 1) subpopulation sp is
+		// always handled by thread sp % numThreads(), so the demes served
+		// by one per-thread RNG stream, and the order in which they
+		// consume it, are the same on every run with a given seed and
+		// number of threads.
+		//
+		// The one-time initialization of the during-mating operators may
+		// reset module-global state (e.g. the leased ID blocks of IdTagger)
+		// and must not run while other threads are mating, so it is done
+		// here, once, before the parallel region; the clones below are
+		// marked so that their own initialize() skips the step.
+		initializeOps(pop);
+		bool failed = false;
+		int except = 0;
+		string msg;
+#pragma omp parallel for schedule(static, 1)
+		for (ssize_t sp = 0; sp < static_cast<ssize_t>(pop.numSubPop()); ++sp)
+		{
+			if (failed || except)
+				continue;
+			// deleted after the catch blocks so that a throwing
+			// mateSubPop does not leak the clone and the chooser and
+			// generator it owns
+			MatingScheme *ms = NULL;
+			try
+			{
+				ms = clone();
+				ms->setOpsInitialized(true);
+				if (!ms->mateSubPop(pop, scratch, sp, scratch.rawIndBegin(sp), scratch.rawIndEnd(sp)))
+					failed = true;
+			}
+			catch (StopEvolution e)
+			{
+				if (!except)
+				{
+					except = 1;
+					msg = e.message();
+				}
+			}
+			catch (ValueError e)
+			{
+				if (!except)
+				{
+					except = 2;
+					msg = e.message();
+				}
+			}
+			catch (RuntimeError e)
+			{
+				if (!except)
+				{
+					except = 3;
+					msg = e.message();
+				}
+			}
+			catch (Exception e)
+			{
+				if (!except)
+				{
+					except = 4;
+					msg = e.message();
+				}
+			}
+			catch (...)
+			{
+				if (!except)
+					except = -1;
+			}
+			delete ms;
+		}
+		if (except == 1)
+			throw StopEvolution(msg);
+		else if (except == 2)
+			throw ValueError(msg);
+		else if (except == 3)
+			throw RuntimeError(msg);
+		else if (except == 4)
+			throw Exception(msg);
+		else if (except == -1)
+			throw Exception("Unexpected error from openMP parallel region");
+		if (failed)
 			return false;
+	}
+	else
+#endif
+	{
+		for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
+			if (!mateSubPop(pop, scratch, sp, scratch.rawIndBegin(sp), scratch.rawIndEnd(sp)))
+				return false;
+	}
 	submitScratch(pop, scratch);
 	return true;
 }
 
+
+bool MatingScheme::mateInPlace(Population &pop, Population &scratch)
+{
+	// Each subpopulation is mated into a scratch buffer that only holds the
+	// largest subpopulation. Parents are only chosen from the subpopulation
+	// being mated, so once all of its prospective offspring are finished the
+	// parental slice can be overwritten. Peak memory is one generation plus
+	// one subpopulation instead of two full generations.
+	if (scratch.genoStruIdx() != pop.genoStruIdx())
+		scratch.fitGenoStru(pop.genoStruIdx());
+	// a finished subpopulation must occupy a contiguous slice of the
+	// population arrays before it can be overwritten
+	pop.syncIndPointers();
+	size_t maxSize = 0;
+	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
+		if (pop.subPopSize(sp) > maxSize)
+			maxSize = pop.subPopSize(sp);
+	scratch.fitSubPopStru(vectoru(1, maxSize), vectorstr());
+	scratch.setVirtualSplitter(pop.virtualSplitter());
+	scratch.setGen(pop.gen());
+	scratch.setRep(pop.rep());
+#ifdef MUTANTALLELE
+	// for mutant allele, clearing all existing genotype will make subsequent
+	// copyChromosomes much faster ...
+	scratch.setGenotype(vectoru(1, 0));
+#endif
+	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp) {
+		size_t sz = pop.subPopSize(sp);
+		if (sz == 0)
+			continue;
+		// information fields of the reused buffer must start from zero,
+		// like those of a freshly prepared scratch population
+		scratch.clearInfo();
+		RawIndIterator offBegin = scratch.rawIndBegin();
+		if (!mateSubPop(pop, scratch, sp, offBegin, offBegin + sz))
+			return false;
+		// all prospective offspring of this subpopulation are finished,
+		// release its parents by replacing them
+		RawIndIterator dst = pop.rawIndBegin(sp);
+		RawIndIterator dstEnd = pop.rawIndEnd(sp);
+		RawIndIterator src = offBegin;
+		for (; dst != dstEnd; ++dst, ++src)
+			dst->copyFrom(*src);
+	}
+	pop.markGenoModified();
+	return true;
+}
+
 void MatingScheme::submitScratch(Population &pop, Population &scratch)
 {
 	// use scratch population,
@@ -1450,8 +1814,9 @@ void MatingScheme::submitScratch(Population &pop, Population &scratch)
 HomoMating::HomoMating(ParentChooser &chooser,
 					   OffspringGenerator &generator,
 					   const uintListFunc &subPopSize,
-					   subPopList subPops, double weight)
-	: MatingScheme(subPopSize), m_subPops(subPops), m_weight(weight)
+					   subPopList subPops, double weight,
+					   bool inPlace)
+	: MatingScheme(subPopSize, inPlace), m_subPops(subPops), m_weight(weight)
 {
 	m_ParentChooser = chooser.clone();
 	m_OffspringGenerator = generator.clone();
@@ -1479,9 +1844,23 @@ bool HomoMating::mateSubPop(Population &pop, Population &offPop, size_t subPop,
 
 	// generate scratch.subPopSize(sp) individuals.
 	RawIndIterator it = offBegin;
+#ifdef _OPENMP
+	// In the deme-parallel mode of MatingScheme::mate this function already
+	// runs inside a parallel region. The arena split below would then open
+	// a nested region that serializes into a one-thread team reporting
+	// thread number 0 from every deme thread, so all demes would consume
+	// (and race on) the stream of thread 0 on builds that keep the RNG
+	// streams in an array instead of threadprivate storage. Mating the
+	// deme sequentially keeps every random draw on the per-thread stream
+	// of the deme thread itself: with schedule(static, 1) in mate(), deme
+	// sp always draws from stream sp % numThreads().
+	bool inParallel = omp_in_parallel() != 0;
+#else
+	bool inParallel = false;
+#endif
 	// If the parent chooser is not parallelizable, or if openMP is not supported
 	// or if number of thread is set to 1, use the sequential method.
-	if (!m_ParentChooser->parallelizable() || numThreads() == 1 || !m_OffspringGenerator->parallelizable())
+	if (inParallel || !m_ParentChooser->parallelizable() || numThreads() == 1 || !m_OffspringGenerator->parallelizable())
 	{
 		DBG_DO(DBG_MATING, cerr << "Mating is done in single-thread mode" << endl);
 		while (it != offEnd)
@@ -1501,11 +1880,19 @@ bool HomoMating::mateSubPop(Population &pop, Population &offPop, size_t subPop,
 		// in this case, openMP must have been supported with numThreads() > 1
 #ifdef _OPENMP
 		size_t offPopSize = offEnd - offBegin;
-		ssize_t nBlocks = numThreads() * 2;
+		// Pre-partition the offspring generation into one contiguous slice
+		// (arena) per thread. With schedule(static, 1) block i is always
+		// executed by thread i, so each slice is filled from the same
+		// per-thread RNG stream (seeded as seed + i by setOptions) on every
+		// run, which makes the parallel mode reproducible for a given seed
+		// and number of threads. Transmitters keep their own per-thread
+		// scratch (e.g. the Bernullitrials objects of Recombinator) so no
+		// state is shared between slices.
+		ssize_t nBlocks = numThreads();
 		ssize_t numOffspring = m_OffspringGenerator->numOffspring(pop.gen());
 		int except = 0;
 		string msg;
-#pragma omp parallel for
+#pragma omp parallel for schedule(static, 1)
 		for (int i = 0; i < nBlocks; i++)
 		{
 			try
@@ -1581,8 +1968,77 @@ bool HomoMating::mateSubPop(Population &pop, Population &offPop, size_t subPop,
 	return true;
 }
 
+MixedMating::MixedMating(double probOfSelfing,
+						 const floatListFunc &numOffspring,
+						 const floatListFunc &sexMode,
+						 const uintListFunc &subPopSize,
+						 const string &selectionField,
+						 bool inPlace)
+	: MatingScheme(subPopSize, inPlace), m_probOfSelfing(probOfSelfing), m_bt(getRNG())
+{
+	DBG_FAILIF(probOfSelfing < 0 || probOfSelfing > 1, ValueError,
+			   "Parameter probOfSelfing should be a probability between 0 and 1.");
+	RandomParentChooser chooser(true, selectionField);
+	m_chooser = chooser.clone();
+	SelfingGenoTransmitter selfing;
+	MendelianGenoTransmitter mendelian;
+	m_selfGen = new OffspringGenerator(opList(vectorop(1, &selfing)), numOffspring, sexMode);
+	m_crossGen = new OffspringGenerator(opList(vectorop(1, &mendelian)), numOffspring, sexMode);
+	m_bt.setParameter(vectorf(1, m_probOfSelfing));
+}
+
+string MixedMating::describe(bool format) const
+{
+	string desc = (boost::format("<simuPOP.MixedMating> a mixed mating scheme in which a family "
+								 "is produced by self-fertilization with probability %1% and by a cross "
+								 "between two randomly chosen parents otherwise.") % m_probOfSelfing).str();
+
+	return format ? formatDescription(desc) : desc;
+}
+
+bool MixedMating::mateSubPop(Population &pop, Population &offPop, size_t subPop,
+							 RawIndIterator offBegin, RawIndIterator offEnd)
+{
+	if (offBegin == offEnd)
+		return true;
+
+	if (!m_chooser->initialized())
+		m_chooser->initialize(pop, subPop);
+	if (!m_selfGen->initialized())
+		m_selfGen->initialize(pop, subPop);
+	if (!m_crossGen->initialized())
+		m_crossGen->initialize(pop, subPop);
+
+	RawIndIterator it = offBegin;
+	while (it != offEnd)
+	{
+		// one batched Bernoulli trial decides whether this mating event is
+		// a self-fertilization or an outcross; the trial table is shared
+		// across families, subpopulations and generations
+		m_bt.trial();
+		if (m_bt.trialSucc(0))
+		{
+			Individual *parent = m_chooser->chooseParents().first;
+			m_selfGen->generateOffspring(pop, offPop, parent, NULL, it, offEnd);
+		}
+		else
+		{
+			Individual *dad = m_chooser->chooseParents().first;
+			Individual *mom = m_chooser->chooseParents().first;
+			m_crossGen->generateOffspring(pop, offPop, dad, mom, it, offEnd);
+		}
+	}
+	m_chooser->finalize();
+	m_selfGen->finalize(pop);
+	m_crossGen->finalize(pop);
+	return true;
+}
+
 bool PedigreeMating::mate(Population &pop, Population &scratch)
 {
+	// release the GIL for the breeding phase, like MatingScheme::mate
+	GILRelease gil;
+
 	if (m_gen == -1)
 		return false;
 
@@ -1595,7 +2051,6 @@ bool PedigreeMating::mate(Population &pop, Population &scratch)
 	DBG_DO(DBG_MATING, cerr << "Producing offspring generation of size " << m_ped.subPopSizes() << " using generation " << m_gen << " of the pedigree." << endl);
 	scratch.fitSubPopStru(m_ped.subPopSizes(), m_ped.subPopNames());
 	scratch.setVirtualSplitter(pop.virtualSplitter());
-	scratch.clearInfo();
 
 	// build an index for parents
 	IdMap idMap;
@@ -1704,7 +2159,11 @@ HeteroMating::HeteroMating(const vectormating &matingSchemes,
 						   bool shuffleOffspring, SexChoice weightBy)
 	: MatingScheme(subPopSize),
 	  m_shuffleOffspring(shuffleOffspring),
-	  m_weightBy(weightBy)
+	  m_weightBy(weightBy),
+	  m_planPop(NULL),
+	  m_planModCount(0),
+	  m_planVirtual(false),
+	  m_planValid(false)
 {
 	vectormating::const_iterator it = matingSchemes.begin();
 	vectormating::const_iterator it_end = matingSchemes.end();
@@ -1759,7 +2218,8 @@ HeteroMating::~HeteroMating()
 		delete *it;
 }
 
-HeteroMating::HeteroMating(const HeteroMating &rhs) : MatingScheme(rhs), m_shuffleOffspring(rhs.m_shuffleOffspring), m_weightBy(rhs.m_weightBy)
+HeteroMating::HeteroMating(const HeteroMating &rhs) : MatingScheme(rhs), m_shuffleOffspring(rhs.m_shuffleOffspring), m_weightBy(rhs.m_weightBy),
+													 m_planPop(NULL), m_planModCount(0), m_planVirtual(false), m_planValid(false)
 {
 	vectormating::const_iterator it = rhs.m_matingSchemes.begin();
 	vectormating::const_iterator it_end = rhs.m_matingSchemes.end();
@@ -1775,150 +2235,185 @@ HeteroMating::HeteroMating(const HeteroMating &rhs) : MatingScheme(rhs), m_shuff
 
 bool HeteroMating::mate(Population &pop, Population &scratch)
 {
+	// release the GIL for the breeding phase, like MatingScheme::mate
+	GILRelease gil;
+
 	// scrtach will have the right structure.
 	if (!prepareScratchPop(pop, scratch))
 		return false;
 
-	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
-	{
-		vectormating m;
-		vectorf w_pos;  // positive weights
-		vectorf w_neg;  // negative weights
-		subPopList sps; // each subpopulations
-		//
-		vectormating::iterator it = m_matingSchemes.begin();
-		vectormating::iterator it_end = m_matingSchemes.end();
-		for (; it != it_end; ++it)
+	// The slice plan (which mating scheme fills which slice of each
+	// offspring subpopulation) depends only on scheme weights and on
+	// parental and offspring subpopulation sizes, so it can be reused
+	// across generations (and replicates) while these are unchanged.
+	// Plans with virtual slices also depend on individual membership and
+	// are only reused if the population has not been modified at all.
+	bool reuse = m_planValid &&
+				 m_planPopSizes == pop.subPopSizes() &&
+				 m_planScratchSizes == scratch.subPopSizes() &&
+				 (!m_planVirtual ||
+				  (m_planPop == &pop && m_planModCount == pop.genoModCount()));
+
+	if (!reuse)
+	{
+		m_plans.assign(pop.numSubPop(), SlicePlan());
+		m_planVirtual = false;
+		for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
 		{
-			subPopList subPops = (*it)->subPops().expandFrom(pop);
-			subPopList::const_iterator vsp = subPops.begin();
-			subPopList::const_iterator vspEnd = subPops.end();
-			for (; vsp != vspEnd; ++vsp)
+			vectormating & m = m_plans[sp].m_schemes;
+			subPopList & sps = m_plans[sp].m_slices; // each subpopulations
+			vectorf w_pos;                           // positive weights
+			vectorf w_neg;                           // negative weights
+			//
+			vectormating::iterator it = m_matingSchemes.begin();
+			vectormating::iterator it_end = m_matingSchemes.end();
+			for (; it != it_end; ++it)
 			{
-				if (vsp->subPop() != sp)
-					continue;
-				// if it is used for this subpop, or all subpopulations
-				m.push_back(*it);
-				sps.push_back(*vsp);
-				double w = (*it)->weight();
-				// less than zero...
-				if (fcmp_lt(w, 0.))
-				{
-					w_pos.push_back(0);
-					w_neg.push_back(-w);
-				}
-				else
+				subPopList subPops = (*it)->subPops().expandFrom(pop);
+				subPopList::const_iterator vsp = subPops.begin();
+				subPopList::const_iterator vspEnd = subPops.end();
+				for (; vsp != vspEnd; ++vsp)
 				{
-					w_pos.push_back(w);
-					w_neg.push_back(0);
+					if (vsp->subPop() != sp)
+						continue;
+					// if it is used for this subpop, or all subpopulations
+					m.push_back(*it);
+					sps.push_back(*vsp);
+					if (vsp->isVirtual())
+						m_planVirtual = true;
+					double w = (*it)->weight();
+					// less than zero...
+					if (fcmp_lt(w, 0.))
+					{
+						w_pos.push_back(0);
+						w_neg.push_back(-w);
+					}
+					else
+					{
+						w_pos.push_back(w);
+						w_neg.push_back(0);
+					}
 				}
 			}
-		}
-		DBG_FAILIF(m.empty(), ValueError,
-				   (boost::format("No mating scheme is available for subpopulation %1%") % sp).str());
-		// determine the weight
-		if (m.size() == 1)
-		{
-			w_pos[0] = 1.;
-			w_neg[0] = 0.;
-		}
-
-		vectoru vspSize(m.size());
-		vectoru parentSize(m.size());
-		// the default case (all zero)
-		bool all_zero = fcmp_eq(std::accumulate(w_pos.begin(), w_pos.end(), 0.), 0.);
-		for (size_t i = 0; i < m.size(); ++i)
-		{
-			parentSize[i] = pop.subPopSize(sps[i], -1, m_weightBy);
-			if (all_zero)
+			DBG_FAILIF(m.empty(), ValueError,
+					   (boost::format("No mating scheme is available for subpopulation %1%") % sp).str());
+			// determine the weight
+			if (m.size() == 1)
 			{
-				// if there is no negative weight, use population size as weight
-				if (w_neg[i] == 0)
-					w_pos[i] = static_cast<double>(parentSize[i]);
+				w_pos[0] = 1.;
+				w_neg[0] = 0.;
 			}
-			else
+
+			vectoru & vspSize = m_plans[sp].m_sizes;
+			vspSize.assign(m.size(), 0);
+			vectoru parentSize(m.size());
+			// the default case (all zero)
+			bool all_zero = fcmp_eq(std::accumulate(w_pos.begin(), w_pos.end(), 0.), 0.);
+			for (size_t i = 0; i < m.size(); ++i)
 			{
-				if (parentSize[i] == 0)
+				parentSize[i] = pop.subPopSize(sps[i], -1, m_weightBy);
+				if (all_zero)
+				{
+					// if there is no negative weight, use population size as weight
+					if (w_neg[i] == 0)
+						w_pos[i] = static_cast<double>(parentSize[i]);
+				}
+				else
 				{
-					DBG_WARNIF(parentSize[i] == 0, "WARNING: One of the parental (virtual) subpopulation is empty and will not "
-												   "produce any offspring.");
-					w_pos[i] = 0;
-					w_neg[i] = 0;
+					if (parentSize[i] == 0)
+					{
+						DBG_WARNIF(parentSize[i] == 0, "WARNING: One of the parental (virtual) subpopulation is empty and will not "
+													   "produce any offspring.");
+						w_pos[i] = 0;
+						w_neg[i] = 0;
+					}
 				}
 			}
-		}
-		DBG_DO(DBG_DEVEL, cerr << "Parental Population Size: " << parentSize << "\n"
-							   << "Positive mating scheme weights: " << w_pos << '\n'
-							   << "Negative mating scheme weights: " << w_neg << endl);
+			DBG_DO(DBG_DEVEL, cerr << "Parental Population Size: " << parentSize << "\n"
+								   << "Positive mating scheme weights: " << w_pos << '\n'
+								   << "Negative mating scheme weights: " << w_neg << endl);
+
+			// weight.
+			double overall_pos = std::accumulate(w_pos.begin(), w_pos.end(), 0.);
 
-		// weight.
-		double overall_pos = std::accumulate(w_pos.begin(), w_pos.end(), 0.);
+			// if it happens to be the case that positive weight happens at empty population
+			// we need to distribute the weight to other populations.
+			if (!all_zero && overall_pos == 0) {
+				for (size_t i = 0; i < m.size(); ++i)
+				{
+					// if there is no negative weight, use population size as weight
+					if (w_neg[i] == 0)
+						w_pos[i] = static_cast<double>(parentSize[i]);
+				}
+			}
+			// re-calculate overall pos
+			overall_pos = std::accumulate(w_pos.begin(), w_pos.end(), 0.);
+			double overall_neg = std::accumulate(w_neg.begin(), w_neg.end(), 0.);
+			(void)overall_neg; // silent warning about unused variable.
+			//
+			size_t all = scratch.subPopSize(sp);
 
-		// if it happens to be the case that positive weight happens at empty population
-		// we need to distribute the weight to other populations.
-		if (!all_zero && overall_pos == 0) {
+			DBG_FAILIF(all > 0 && fcmp_eq(overall_pos, 0.) && fcmp_eq(overall_neg, 0.), ValueError,
+					   "No valid parents to produce an non-empty offspring population.");
+			// first count negative ones
 			for (size_t i = 0; i < m.size(); ++i)
 			{
-				// if there is no negative weight, use population size as weight
-				if (w_neg[i] == 0)
-					w_pos[i] = static_cast<double>(parentSize[i]);
+				if (fcmp_gt(w_neg[i], 0.))
+				{
+					// issue 114, allow parental subpopulation to be larger than offspring subpopulation.
+					vspSize[i] = std::min(all, static_cast<size_t>(parentSize[i] * w_neg[i]));
+					all -= vspSize[i];
+				}
 			}
-		}
-		// re-calculate overall pos
-		overall_pos = std::accumulate(w_pos.begin(), w_pos.end(), 0.);
-		double overall_neg = std::accumulate(w_neg.begin(), w_neg.end(), 0.);
-		(void)overall_neg; // silent warning about unused variable.
-		//
-		size_t all = scratch.subPopSize(sp);
-
-		DBG_FAILIF(all > 0 && fcmp_eq(overall_pos, 0.) && fcmp_eq(overall_neg, 0.), ValueError,
-				   "No valid parents to produce an non-empty offspring population.");
-		// first count negative ones
-		for (size_t i = 0; i < m.size(); ++i)
-		{
-			if (fcmp_gt(w_neg[i], 0.))
+			// then count positive ones
+			size_t all_pos = all;
+			for (size_t i = 0; i < m.size(); ++i)
 			{
-				// issue 114, allow parental subpopulation to be larger than offspring subpopulation.
-				vspSize[i] = std::min(all, static_cast<size_t>(parentSize[i] * w_neg[i]));
-				all -= vspSize[i];
+				if (all > 0 && fcmp_gt(w_pos[i], 0.))
+				{
+					vspSize[i] = static_cast<ULONG>(all_pos * w_pos[i] / overall_pos);
+					DBG_ASSERT(all >= vspSize[i], ValueError,
+							   (boost::format("Mating scheme with a positive weight of %1% would like to produce %2%"
+											  " offspring, but there are only %1% unclaimed offspring left.") %
+								w_pos[i] % vspSize[i] % all)
+								   .str());
+					all -= vspSize[i];
+				}
 			}
-		}
-		// then count positive ones
-		size_t all_pos = all;
-		for (size_t i = 0; i < m.size(); ++i)
-		{
-			if (all > 0 && fcmp_gt(w_pos[i], 0.))
+			DBG_FAILIF(fcmp_eq(overall_pos, 0) && all > 0, ValueError,
+					   "An exact (all negative) weight system is used, but does not fill offspring subpopulation.");
+
+			// individuals left by floating point calculation is added to
+			// the last non-zero, positive weight virtual subpopulation.
+			if (all > 0)
 			{
-				vspSize[i] = static_cast<ULONG>(all_pos * w_pos[i] / overall_pos);
-				DBG_ASSERT(all >= vspSize[i], ValueError,
-						   (boost::format("Mating scheme with a positive weight of %1% would like to produce %2%"
-										  " offspring, but there are only %1% unclaimed offspring left.") %
-							w_pos[i] % vspSize[i] % all)
-							   .str());
-				all -= vspSize[i];
+				for (ssize_t i = m.size() - 1; i >= 0; --i)
+					if (vspSize[i] != 0 && w_pos[i] > 0)
+					{
+						vspSize[i] += all;
+						break;
+					}
 			}
-		}
-		DBG_FAILIF(fcmp_eq(overall_pos, 0) && all > 0, ValueError,
-				   "An exact (all negative) weight system is used, but does not fill offspring subpopulation.");
+			DBG_DO(DBG_DEVEL, cerr << "VSP sizes in subpop " << sp << " is "
+								   << vspSize << endl);
 
-		// individuals left by floating point calculation is added to
-		// the last non-zero, positive weight virtual subpopulation.
-		if (all > 0)
-		{
-			for (ssize_t i = m.size() - 1; i >= 0; --i)
-				if (vspSize[i] != 0 && w_pos[i] > 0)
-				{
-					vspSize[i] += all;
-					break;
-				}
+			DBG_ASSERT(vspSize.size() == m.size() && m.size() == sps.size(),
+					   SystemError, "Failed to determine subpopulation size");
 		}
-		DBG_DO(DBG_DEVEL, cerr << "VSP sizes in subpop " << sp << " is "
-							   << vspSize << endl);
+		m_planPopSizes = pop.subPopSizes();
+		m_planScratchSizes = scratch.subPopSizes();
+		m_planPop = &pop;
+		m_planModCount = pop.genoModCount();
+		m_planValid = true;
+	}
 
-		DBG_ASSERT(vspSize.size() == m.size() && m.size() == sps.size(),
-				   SystemError, "Failed to determine subpopulation size");
+	for (size_t sp = 0; sp < static_cast<size_t>(pop.numSubPop()); ++sp)
+	{
+		const vectormating & m = m_plans[sp].m_schemes;
+		const subPopList & sps = m_plans[sp].m_slices;
+		const vectoru & vspSize = m_plans[sp].m_sizes;
 		// it points to the first mating scheme.
-		vectoru::iterator itSize = vspSize.begin();
+		vectoru::const_iterator itSize = vspSize.begin();
 		RawIndIterator ind = scratch.rawIndBegin(sp);
 		DBG_FAILIF(pop.hasActivatedVirtualSubPop(sp), ValueError,
 				   (boost::format("SubPopulation %1% has activated virtual subpopulation.") % sp).str());
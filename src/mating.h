@@ -594,7 +594,10 @@ public:
 
 	/// CPPONLY
 	OffspringGenerator(const OffspringGenerator & rhs)
-		: m_transmitters(rhs.m_transmitters), m_initialized(rhs.m_initialized)
+		: m_transmitters(rhs.m_transmitters),
+		m_activeTransmitters(rhs.m_activeTransmitters),
+		m_initialized(rhs.m_initialized),
+		m_opsInitialized(rhs.m_opsInitialized)
 	{
 		m_numOffModel = rhs.m_numOffModel->clone();
 		m_sexModel = rhs.m_sexModel->clone();
@@ -621,6 +624,24 @@ public:
 	 */
 	virtual void initialize(const Population & pop, size_t subPop);
 
+	/** CPPONLY
+	 *  Run the one-time initialization of the during-mating operators,
+	 *  which is normally done by initialize(). Operators such as IdTagger
+	 *  reset module-global state in this step and must not do so while
+	 *  other threads are mating, so the deme-parallel mode of
+	 *  MatingScheme::mate runs this once, serially, before its parallel
+	 *  region and tells the per-subpopulation clones to skip the step
+	 *  through setOpsInitialized().
+	 */
+	void initializeOps(const Population & pop);
+
+	/// CPPONLY see initializeOps()
+	void setOpsInitialized(bool initialized)
+	{
+		m_opsInitialized = initialized;
+	}
+
+
 	/// CPPONLY
 	virtual UINT generateOffspring(Population & pop, Population & offPop, Individual * dad, Individual * mom,
 		RawIndIterator & offBegin, RawIndIterator & offEnd);
@@ -671,8 +692,19 @@ protected:
 	/// default transmitter
 	opList m_transmitters;
 
+	/// indexes of the transmitters that are active at the generation being
+	/// populated, determined once per generation by initialize() so that
+	/// candidate offspring (including regenerated replacements of discarded
+	/// ones) do not re-test operator applicability one by one
+	vectoru m_activeTransmitters;
+
 protected:
 	bool m_initialized;
+
+	/// whether or not the one-time initialization of the during-mating
+	/// operators was already done on the scheme this generator was cloned
+	/// from, c.f. initializeOps()
+	bool m_opsInitialized;
 };
 
 
@@ -744,6 +776,10 @@ public:
 private:
 	void getExpectedAlleles(const Population & pop, vectorf & expFreq);
 
+	/// whether or not a family of \e dad and \e mom can be accepted at all,
+	/// decided from the parental genotypes before any offspring is produced
+	bool acceptableParents(const Population & pop, Individual * dad, Individual * mom);
+
 	/// locus at which mating is controlled.
 	lociList m_loci;
 	//
@@ -928,7 +964,7 @@ public:
 	RandomParentChooser(bool replacement = true,
 		const string & selectionField = "fitness", SexChoice sexChoice = ANY_SEX)
 		: ParentChooser(selectionField), m_basePtr(), m_replacement(replacement), m_choice(sexChoice),
-		m_index(0), m_chosen(0), m_sampler(), m_size(0), m_shift(0)
+		m_index(0), m_chosen(0), m_fitness(0), m_sampler(), m_drawn(0), m_size(0), m_shift(0)
 	{
 	}
 
@@ -964,6 +1000,14 @@ public:
 	/// Return chosen parents from a population if the parent chooser object is created with a population
 	IndividualPair chooseParents();
 
+protected:
+	/** CPPONLY Return the index of a parent drawn from the fitness weighted
+	 *  sampler. Indexes are pre-drawn in blocks, one block per thread, so
+	 *  that choosing a parent reads a buffered index and the cost of the
+	 *  sampler and of random number generation is amortized across draws.
+	 */
+	size_t drawParentIndex();
+
 protected:
 	RawIndIterator m_basePtr;
 
@@ -975,8 +1019,16 @@ protected:
 	///
 	vector<RawIndIterator> m_index;
 	vector<RawIndIterator> m_chosen;
+	/// fitness values collected during initialization, kept as a member so
+	/// that its buffer is reused when the chooser is re-initialized for the
+	/// next subpopulation or generation.
+	vectorf m_fitness;
 	/// accumulative fitness
 	WeightedSampler m_sampler;
+	/// parent indexes pre-drawn from m_sampler, one block per thread.
+	/// Blocks are discarded when the chooser is re-initialized because
+	/// they were drawn under the weights of the previous initialization.
+	vector<vectoru> m_drawn;
 	/// individuals to choose
 	size_t m_size;
 	/// index to the subpopulation
@@ -1002,11 +1054,20 @@ public:
 	 *  replacement (parameter \e replacement, default to \c True). If selection
 	 *  is enabled and information field \e selectionField exists in the passed
 	 *  population, the probability that a parent is chosen is proportional to
-	 *  his/her fitness value stored in \e selectionField.
+	 *  his/her fitness value stored in \e selectionField. If a positive
+	 *  \e batchSize is given (only valid when parents are chosen with
+	 *  replacement), parent pairs are drawn \e batchSize at a time and served
+	 *  sorted by the location of the father in the parental population. The
+	 *  drawn pairs and their distribution are unaffected, only the order in
+	 *  which they are used, so consecutive offspring read the genotypes of
+	 *  nearby parents, which can be considerably faster for very large
+	 *  populations.
 	 */
-	RandomParentsChooser(bool replacement = true, const string & selectionField = "fitness")
+	RandomParentsChooser(bool replacement = true, const string & selectionField = "fitness",
+		size_t batchSize = 0)
 		: ParentChooser(selectionField), m_replacement(replacement),
-		m_index(0), m_fitness(0), m_malesampler(), m_femalesampler()
+		m_index(0), m_fitness(0), m_malesampler(), m_femalesampler(),
+		m_batchSize(batchSize), m_batch(), m_batchCursor()
 	{
 	}
 
@@ -1063,6 +1124,12 @@ private:
 	// weighted sampler
 	WeightedSampler m_malesampler;
 	WeightedSampler m_femalesampler;
+
+	// number of parent pairs drawn at a time, 0 for one pair per call
+	size_t m_batchSize;
+	// per-thread batches of pre-drawn pairs, served sorted by father location
+	vector<vector<IndividualPair> > m_batch;
+	vectoru m_batchCursor;
 };
 
 
@@ -1441,8 +1508,22 @@ public:
 	 *  prepare for mating. A common practice is to split and merge parental
 	 *  populations in this function so that you demographic related
 	 *  information and actions could be implemented in the same function.
+	 *
+	 *  If \e inPlace is set to \c True, the offspring generation is written
+	 *  over the parental generation subpopulation by subpopulation, using a
+	 *  scratch buffer that only holds the largest subpopulation. This
+	 *  bounds peak memory at roughly one generation plus one subpopulation
+	 *  instead of two full generations, which matters for very large
+	 *  populations with many subpopulations. This mode is only usable for
+	 *  non-overlapping models with constant population size (no
+	 *  \e subPopSize parameter) and without stored ancestral generations
+	 *  (the parental generation is destroyed during mating), and a regular
+	 *  generation cycle is silently used when these conditions do not hold.
+	 *  During-mating operators must not access parents outside of the
+	 *  subpopulation being mated in this mode.
 	 */
-	MatingScheme(const uintListFunc & subPopSize = uintListFunc());
+	MatingScheme(const uintListFunc & subPopSize = uintListFunc(),
+		bool inPlace = false);
 
 	/// destructor
 	virtual ~MatingScheme()
@@ -1480,6 +1561,38 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  Whether or not independent subpopulations can be mated concurrently
+	 *  by per-subpopulation clones of this mating scheme. A mating scheme
+	 *  should only report true if mateSubPop touches nothing outside its
+	 *  own state and its offspring slice.
+	 */
+	virtual bool parallelizableAcrossSubPops() const
+	{
+		return false;
+	}
+
+
+	/** CPPONLY
+	 *  Run the one-time initialization of the during-mating operators of
+	 *  this mating scheme, which may reset module-global state (e.g. the
+	 *  leased ID blocks of IdTagger) and must therefore not run inside a
+	 *  parallel region. The deme-parallel mode of mate() calls this once
+	 *  on the original scheme before subpopulations are mated concurrently
+	 *  by clones, and marks the clones with setOpsInitialized() so that
+	 *  they skip the step.
+	 */
+	virtual void initializeOps(const Population & /* pop */)
+	{
+	}
+
+
+	/// CPPONLY see initializeOps()
+	virtual void setOpsInitialized(bool /* initialized */)
+	{
+	}
+
+
 	/** CPPONLY
 	 *  Generate an offspring population \e scratch from parental population
 	 *  \e pop.
@@ -1491,6 +1604,12 @@ public:
 	 */
 	bool prepareScratchPop(Population & pop, Population & scratch);
 
+	/** CPPONLY
+	 *  Generate the offspring generation over the parental generation,
+	 *  buffering one subpopulation at a time in \e scratch.
+	 */
+	bool mateInPlace(Population & pop, Population & scratch);
+
 	/** CPPONLY
 	 *  Use to generate a warning when subPopSize is specified in a homogeneous
 	 *  mating scheme called in a heterogeneous mating scheme.
@@ -1501,11 +1620,36 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  Access the offspring size setting of this mating scheme, used by
+	 *  Simulator.estimate() to project offspring generation sizes.
+	 */
+	const uintListFunc & subPopSizeConfig() const
+	{
+		return m_subPopSize;
+	}
+
+
+	/** CPPONLY
+	 *  Whether or not this mating scheme was asked to replace parents
+	 *  subpopulation by subpopulation (c.f. parameter \e inPlace). The
+	 *  request is silently ignored by mate() when its preconditions do
+	 *  not hold.
+	 */
+	bool matesInPlace() const
+	{
+		return m_inPlace;
+	}
+
+
 protected:
 	/** Specify subpopulation size of the offspring generation. Can be a
 	 *  list of subpopulation sizes or a function.
 	 */
 	uintListFunc m_subPopSize;
+
+	/// whether or not offspring replace parents subpopulation by subpopulation
+	bool m_inPlace;
 };
 
 
@@ -1533,13 +1677,16 @@ public:
 	 *  Parameters \e subPops and \e weight are used to determine which (virtual)
 	 *  subpopulations this mating scheme will be applied to, and how many
 	 *  offspring this mating scheme will produce. Please refer to mating scheme
-	 *  \c HeteroMating for the use of these two parameters.
+	 *  \c HeteroMating for the use of these two parameters. Parameter
+	 *  \e inPlace is described in class \c MatingScheme and is only honored
+	 *  when this mating scheme is used directly in a simulator.
 	 */
 	HomoMating(ParentChooser & chooser,
 		OffspringGenerator & generator,
 		const uintListFunc & subPopSize = uintListFunc(),
 		subPopList subPops = subPopList(),
-		double weight = 0);
+		double weight = 0,
+		bool inPlace = false);
 
 	/// destructor
 	~HomoMating()
@@ -1565,6 +1712,29 @@ public:
 	}
 
 
+	/// CPPONLY subpopulations are independent when parent choice and
+	/// offspring generation are free of Python callbacks
+	virtual bool parallelizableAcrossSubPops() const
+	{
+		return m_ParentChooser->parallelizable() &&
+		       m_OffspringGenerator->parallelizable();
+	}
+
+
+	/// CPPONLY
+	virtual void initializeOps(const Population & pop)
+	{
+		m_OffspringGenerator->initializeOps(pop);
+	}
+
+
+	/// CPPONLY
+	virtual void setOpsInitialized(bool initialized)
+	{
+		m_OffspringGenerator->setOpsInitialized(initialized);
+	}
+
+
 	/// HIDDEN describe a homogeneous mating scheme.
 	virtual string describe(bool format = true) const;
 
@@ -1600,6 +1770,89 @@ private:
 };
 
 
+/** A mating scheme for the standard plant-genetics model of partial
+ *  selfing, in which each mating event is a self-fertilization with a given
+ *  probability and an outcross between two randomly chosen parents
+ *  otherwise. It produces the same offspring distribution as a
+ *  \c HeteroMating that combines a \c SelfMating and a \c HermaphroditicMating
+ *  scheme with matching weights, but draws the selfing decision per family
+ *  from one batched Bernoulli state and serves both kinds of families from
+ *  a single parent chooser, so it does not pay two chooser initializations
+ *  and virtual subpopulation slicing per subpopulation per generation.
+ */
+class MixedMating : public MatingScheme
+{
+public:
+	/** Create a mating scheme in which a family is produced by the
+	 *  self-fertilization of one randomly chosen parent with probability
+	 *  \e probOfSelfing, and by a cross between two randomly chosen
+	 *  parents following Mendel's laws otherwise. Parents are chosen with
+	 *  replacement from all individuals regardless of sex, with
+	 *  probabilities proportional to their fitness values if natural
+	 *  selection is enabled (stored in information field
+	 *  \e selectionField, c.f. class \c RandomParentChooser); an outcross
+	 *  may pick the same individual twice, as in class
+	 *  \c HermaphroditicMating. Please refer to class \c OffspringGenerator
+	 *  for parameters \e numOffspring and \e sexMode, and to class
+	 *  \c MatingScheme for parameters \e subPopSize and \e inPlace.
+	 */
+	MixedMating(double probOfSelfing,
+		const floatListFunc & numOffspring = 1,
+		const floatListFunc & sexMode = RANDOM_SEX,
+		const uintListFunc & subPopSize = uintListFunc(),
+		const string & selectionField = "fitness",
+		bool inPlace = false);
+
+	/// destructor
+	~MixedMating()
+	{
+		delete m_chooser;
+		delete m_selfGen;
+		delete m_crossGen;
+	}
+
+
+	/// CPPONLY
+	MixedMating(const MixedMating & rhs) :
+		MatingScheme(rhs), m_probOfSelfing(rhs.m_probOfSelfing), m_bt(getRNG())
+	{
+		m_chooser = rhs.m_chooser->clone();
+		m_selfGen = rhs.m_selfGen->clone();
+		m_crossGen = rhs.m_crossGen->clone();
+		m_bt.setParameter(vectorf(1, m_probOfSelfing));
+	}
+
+
+	/// HIDDEN Deep copy of a mixed mating scheme
+	virtual MatingScheme * clone() const
+	{
+		return new MixedMating(*this);
+	}
+
+
+	/// HIDDEN describe a mixed selfing/outcrossing mating scheme
+	virtual string describe(bool format = true) const;
+
+	/// CPPONLY
+	virtual bool mateSubPop(Population & pop, Population & offPop, size_t subPop,
+		RawIndIterator offBegin, RawIndIterator offEnd);
+
+private:
+	/// probability that a mating event is a self-fertilization
+	double m_probOfSelfing;
+
+	/// single parent chooser shared by selfing and outcrossing families
+	ParentChooser * m_chooser;
+
+	/// offspring generators with selfing and Mendelian transmitters
+	OffspringGenerator * m_selfGen;
+	OffspringGenerator * m_crossGen;
+
+	/// batched selfing-vs-outcrossing decisions, one trial per family
+	Bernullitrials m_bt;
+};
+
+
 /** This mating scheme evolves a population following an existing pedigree
  *  structure. If the \c Pedigree object has \c N ancestral generations and a
  *  present generation, it can be used to evolve a population for \c N
@@ -1750,12 +2003,34 @@ public:
 	 */
 	bool mate(Population & pop, Population & scratch);
 
+private:
+	/// how an offspring subpopulation is divided among mating schemes
+	struct SlicePlan
+	{
+		/// mating schemes applicable to this subpopulation (borrowed from m_matingSchemes)
+		vectormating m_schemes;
+		/// parental (virtual) subpopulation of each scheme
+		subPopList m_slices;
+		/// number of offspring each scheme produces
+		vectoru m_sizes;
+	};
+
 private:
 	vectormating m_matingSchemes;
 	///
 	bool m_shuffleOffspring;
 	///
 	SexChoice m_weightBy;
+	/// cached slice plan of each subpopulation, and the conditions
+	/// (subpopulation sizes, and for plans with virtual slices, an
+	/// unmodified parental population) under which it remains valid.
+	vector<SlicePlan> m_plans;
+	vectoru m_planPopSizes;
+	vectoru m_planScratchSizes;
+	const Population * m_planPop;
+	size_t m_planModCount;
+	bool m_planVirtual;
+	bool m_planValid;
 };
 
 
@@ -102,9 +102,16 @@ bool Migrator::apply(Population & pop) const
 
 	// real migration matrix might change from population to population because
 	// of different number of subpopulations, and toSubPops can be ALL_AVAIL, and
-	// then does not have to match subPops.
-	matrixf migrationRate = m_rate;
-	if (m_mode != BY_IND_INFO) {
+	// then does not have to match subPops. The normalized matrix only depends
+	// on the source and destination subpopulation lists, so its compressed
+	// sparse row form and the per-row samplers are built once and reused
+	// until the lists change.
+	vectoru fromList(fromSubPops.size());
+	for (size_t i = 0; i < fromSubPops.size(); ++i)
+		fromList[i] = fromSubPops[i].subPop();
+	if (m_mode != BY_IND_INFO &&
+	    (m_rowIndex.empty() || fromList != m_cachedFrom || toSubPops != m_cachedTo)) {
+		matrixf migrationRate = m_rate;
 		size_t szFrom = migrationRate.size();
 		size_t szTo = migrationRate[0].size();
 
@@ -125,7 +132,7 @@ bool Migrator::apply(Population & pop) const
 		if (m_mode == BY_PROBABILITY || m_mode == BY_PROPORTION) {
 			for (size_t i = 0; i < szFrom; i++) {               // from
 				// look for from=to cell.
-				size_t spFrom = fromSubPops[i].subPop();
+				size_t spFrom = fromList[i];
 				double sum = accumulate(migrationRate[i].begin(), migrationRate[i].end(), 0.0);
 				//
 				vectoru::const_iterator spTo = find(toSubPops.begin(), toSubPops.end(), spFrom);
@@ -144,6 +151,29 @@ bool Migrator::apply(Population & pop) const
 				}
 			}
 		}
+		// compress the rows: only nonzero rates can send a migrant, so
+		// samplers are built over the nonzero entries of each row and
+		// drawn indexes are translated back through the column index.
+		m_rowIndex.assign(1, 0);
+		m_colIndex.clear();
+		m_values.clear();
+		m_samplers.clear();
+		vectorf weights;
+		for (size_t i = 0; i < szFrom; ++i) {
+			weights.clear();
+			for (size_t j = 0; j < migrationRate[i].size(); ++j) {
+				if (migrationRate[i][j] == 0.)
+					continue;
+				m_colIndex.push_back(j);
+				m_values.push_back(migrationRate[i][j]);
+				weights.push_back(migrationRate[i][j]);
+			}
+			m_rowIndex.push_back(m_colIndex.size());
+			if (m_mode == BY_PROBABILITY)
+				m_samplers.push_back(WeightedSampler(weights));
+		}
+		m_cachedFrom.swap(fromList);
+		m_cachedTo = toSubPops;
 	}
 
 	for (size_t from = 0, fromEnd = fromSubPops.size(); from < fromEnd; ++from) {
@@ -179,7 +209,8 @@ bool Migrator::apply(Population & pop) const
 				}
 			}
 		} else if (m_mode == BY_PROBABILITY) {
-			WeightedSampler ws(migrationRate[from]);
+			WeightedSampler & ws = m_samplers[from];
+			const size_t * cols = &m_colIndex[m_rowIndex[from]];
 
 			// for each individual, migrate according to migration probability
 			if (numThreads() > 1) {
@@ -187,8 +218,8 @@ bool Migrator::apply(Population & pop) const
 #  pragma omp parallel private(toIndex)
 				{
 					for (IndIterator ind = pop.indIterator(spFrom, omp_get_thread_num()); ind.valid(); ++ind) {
-						toIndex = ws.draw();
-						DBG_ASSERT(toIndex < migrationRate[from].size(), ValueError,
+						toIndex = cols[ws.draw()];
+						DBG_ASSERT(toIndex <= toSize, ValueError,
 							"Return index out of range.");
 						if (toIndex < toSize && toSubPops[toIndex] != spFrom)
 							ind->setInfo(static_cast<double>(toSubPops[toIndex]), info);
@@ -197,10 +228,11 @@ bool Migrator::apply(Population & pop) const
 #endif
 			} else {
 				for (IndIterator ind = pop.indIterator(spFrom); ind.valid(); ++ind) {
-					//toIndex = getRNG().randIntByFreq( rateSize, &migrationRate[from][0] ) ;
-					toIndex = ws.draw();
+					// the sampler covers the nonzero entries of the row, the
+					// column index translates a draw back to a destination
+					toIndex = cols[ws.draw()];
 
-					DBG_ASSERT(toIndex < migrationRate[from].size(), ValueError,
+					DBG_ASSERT(toIndex <= toSize, ValueError,
 						"Return index out of range.");
 
 					// rateSize == toSize (no i->i addition)
@@ -214,24 +246,26 @@ bool Migrator::apply(Population & pop) const
 		} else {
 			// 2nd, or 3rd method
 			// first find out how many people will move to other subPop
-			// then randomly assign individuals to move
-			vectoru toNum(toSize);
-			if (m_mode == BY_PROPORTION) {
-				// in case that to sub is not in from sub, the last added
-				// element is not used. sum of toNum is not spSize.
-				for (size_t i = 0; i < toSize; ++i)
-					toNum[i] = static_cast<ULONG>(spSize * migrationRate[from][i]);
-			} else {                                                                      // by count
-				for (size_t i = 0; i < toSize; ++i)
-					toNum[i] = static_cast<ULONG>(migrationRate[from][i]);
-			}
+			// then randomly assign individuals to move.
 			// create a vector and assign indexes, then random shuffle
 			// and assign info
 			vectoru toIndices(spSize);
 			size_t k = 0;
-			for (size_t i = 0; i < toSize && k < spSize; ++i)
-				for (size_t j = 0; j < toNum[i] && k < spSize; ++j)
-					toIndices[k++] = toSubPops[i];
+			for (size_t e = m_rowIndex[from]; e < m_rowIndex[from + 1] && k < spSize; ++e) {
+				size_t col = m_colIndex[e];
+				// the i->i entry appended during normalization means stay
+				if (col >= toSize)
+					continue;
+				size_t num = 0;
+				if (m_mode == BY_PROPORTION)
+					// in case that to sub is not in from sub, the last added
+					// element is not used. sum of the counts is not spSize.
+					num = static_cast<ULONG>(spSize * m_values[e]);
+				else                                                          // by count
+					num = static_cast<ULONG>(m_values[e]);
+				for (size_t j = 0; j < num && k < spSize; ++j)
+					toIndices[k++] = toSubPops[col];
+			}
 
 			// the rest of individuals will stay in their original subpopulation.
 			while (k < spSize)
@@ -528,7 +562,7 @@ bool SplitSubPops::apply(Population & pop) const
 		// randomize indiviudlas
 		if (m_randomize) {
 			getRNG().randomShuffle(pop.rawIndBegin(sp), pop.rawIndEnd(sp));
-			pop.setIndOrdered(false);
+			pop.setSubPopUnordered(sp);
 		}
 
 		if (!m_subPopSizes.empty()) {
@@ -542,6 +576,8 @@ bool SplitSubPops::apply(Population & pop) const
 			// using an information field
 			size_t idx = pop.infoIdx(infoField(0));
 			std::sort(pop.rawIndBegin(sp), pop.rawIndEnd(sp), indCompare(idx));
+			// sorting moves Individual objects away from their genotypes
+			pop.setSubPopUnordered(sp);
 			ConstRawIndIterator it = pop.rawIndBegin(sp);
 			ConstRawIndIterator it_end = pop.rawIndEnd(sp);
 			vectorf spSize(1, 1);
@@ -164,6 +164,23 @@ protected:
 	/// from->to subPop index.
 	/// default to 0 - rows of rate - 1, 0 - columns of rate - 1
 	const uintList m_to;
+
+private:
+	/// The normalized migration matrix in compressed sparse row form,
+	/// along with one sampler per source subpopulation. These only depend
+	/// on the source and destination subpopulation lists, so they are
+	/// built on first use and reused across generations until the lists
+	/// change. Landscape models with thousands of demes and a handful of
+	/// neighbors per deme would otherwise copy and scan the full dense
+	/// matrix at every generation.
+	mutable vectoru m_rowIndex;
+	mutable vectoru m_colIndex;
+	mutable vectorf m_values;
+	/// per-row alias samplers for mode BY_PROBABILITY
+	mutable vector<WeightedSampler> m_samplers;
+	/// the subpopulation lists the sparse form was built for
+	mutable vectoru m_cachedFrom;
+	mutable vectoru m_cachedTo;
 };
 
 
@@ -36,6 +36,14 @@ typedef SSIZE_T ssize_t;
 
 namespace simuPOP {
 
+/** CPPONLY
+ *  A sparse genotype container for the mutant module. All alleles of a
+ *  population are kept in a single ordered map from absolute locus index
+ *  to allele value, and zero (wildtype) alleles are never stored. A
+ *  chromosome copy that carries no mutant therefore has no entry at all,
+ *  so wholly-empty (e.g. customizable) chromosomes only cost the map
+ *  lookups that skip over them, not per-individual storage.
+ */
 class vectorm
 {
 public:
@@ -94,6 +102,31 @@ public:
 	}
 
 
+	/** CPPONLY Visit the index range [beg, end) as runs: every maximal
+	 *  stretch without stored mutants is reported once through
+	 *  <tt>f.zeroRun(start, length)</tt>, and every stored mutant through
+	 *  <tt>f.mutant(index, value)</tt>, in index order. Dense consumers
+	 *  thus see reference alleles in bulk instead of paying a container
+	 *  probe per locus.
+	 */
+	template <typename Visitor>
+	void forEachRun(size_t beg, size_t end, Visitor & f) const
+	{
+		const_val_iterator it = m_data.lower_bound(beg);
+		const_val_iterator it_end = m_data.lower_bound(end);
+		size_t cur = beg;
+
+		for (; it != it_end; ++it) {
+			if (it->first > cur)
+				f.zeroRun(cur, it->first - cur);
+			f.mutant(it->first, it->second);
+			cur = it->first + 1;
+		}
+		if (cur < end)
+			f.zeroRun(cur, end - cur);
+	}
+
+
 public:
 	inline void resize(size_t size, bool preserve = true)
 	{
@@ -190,9 +223,13 @@ public:
 				iend > m_size ? m_data.end() : m_data.lower_bound(iend));
 		// insert new data
 		const_val_iterator vbeg = begin.get_val_iterator();
-		const_val_iterator vend = (end - (iend > m_size ? iend - m_size : 0)).get_val_iterator();
-		if (vbeg == vend)
+		// an empty source region (the common case for a mostly wildtype
+		// chromosome) can be detected from the first entry at or after
+		// begin, without a second lookup for the end of the region
+		size_t send = (end - (iend > m_size ? iend - m_size : 0)).index();
+		if (vbeg == begin().data().end() || vbeg->first >= send)
 			return;
+		const_val_iterator vend = begin().data().lower_bound(send);
 		// the first element is insert to get the right location for future insertion
 		DBG_ASSERT(vbeg->second != 0, RuntimeError, "Cannot store zero as mutant");
 		val_iterator dest = m_data.insert(m_data.end(), val_iterator::value_type(vbeg->first + lagging, vbeg->second));
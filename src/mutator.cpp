@@ -91,6 +91,12 @@ void BaseMutator::fillContext(const Population & pop, IndAlleleIterator ptr, siz
 
 bool BaseMutator::apply(Population & pop) const
 {
+	// genotypes are about to change; a mutator restricted to known loci
+	// only invalidates cached statistics at those loci
+	if (m_loci.allAvail())
+		pop.markGenoModified();
+	else
+		pop.markGenoModified(m_loci.elems(&pop));
 	DBG_DO(DBG_MUTATOR, cerr << "Mutate replicate " << pop.rep() << endl);
 
 #ifdef LINEAGE
@@ -136,7 +142,7 @@ bool BaseMutator::apply(Population & pop) const
 	vectorf rates = m_rates;
 	bool rare = true;
 	if (rates.size() == 1) {
-		if (rates[0] > 1e02)
+		if (rates[0] > 1e-2)
 			rare = false;
 		rates.resize(m_loci.allAvail() ? pop.totNumLoci() : m_loci.size());
 		// loci can be empty, in this case rates cannot be expanded.
@@ -149,6 +155,8 @@ bool BaseMutator::apply(Population & pop) const
 				break;
 			}
 	}
+	DBG_DO(DBG_MUTATOR, cerr << "Mutating with the " << (rare ? "geometric skip" : "Bernoulli table")
+		                     << " kernel" << endl);
 	const vectoru & loci = m_loci.elems(&pop);
 	size_t iEnd = m_loci.allAvail() ? pop.totNumLoci() : loci.size();
 	// if no loci to mutate
@@ -184,10 +192,12 @@ bool BaseMutator::apply(Population & pop) const
 				pos = (step == 0 || step > max_pos) ? Bernullitrials::npos : (step - 1);
 			} else
 				pos = bt.trialFirstSucc(i);
-			size_t lastPos = 0;
-			IndAlleleIterator ptr = pop.alleleIterator(locus, sp);
-			LINEAGE_EXPR(IndLineageIterator lineagePtr = pop.lineageIterator(locus, sp));
+			// at realistic rates most loci receive no mutation at all, so
+			// the allele iterators are only set up once a hit is known.
 			if (pos != Bernullitrials::npos) {
+				size_t lastPos = 0;
+				IndAlleleIterator ptr = pop.alleleIterator(locus, sp);
+				LINEAGE_EXPR(IndLineageIterator lineagePtr = pop.lineageIterator(locus, sp));
 				do {
 #ifdef LINEAGE
 					long lineage = 0;
@@ -302,6 +312,7 @@ MatrixMutator::MatrixMutator(const floatMatrix & rate,
 		return;
 	// re-calculate probability
 	m_sampler.clear();
+	m_rowIdx.resize(rateMatrix.size());
 	for (size_t i = 0; i < rateMatrix.size(); ++i) {
 		double sum = 0;
 		for (size_t j = 0; j < rateMatrix[i].size(); ++j) {
@@ -312,19 +323,30 @@ MatrixMutator::MatrixMutator(const floatMatrix & rate,
 		}
 		rateMatrix[i][i] = 1 - sum / mu;
 		DBG_DO(DBG_MUTATOR, cerr << "Setting weight for allele " << i << " to " << rateMatrix[i] << endl);
-		m_sampler.push_back(WeightedSampler(rateMatrix[i]));
+		// alleles with identical rows, which are common in the large
+		// matrices of context-dependent models, share one compiled
+		// sampler instead of getting one each
+		size_t idx = m_sampler.size();
+		for (size_t j = 0; j < i; ++j)
+			if (rateMatrix[j] == rateMatrix[i]) {
+				idx = m_rowIdx[j];
+				break;
+			}
+		m_rowIdx[i] = idx;
+		if (idx == m_sampler.size())
+			m_sampler.push_back(WeightedSampler(rateMatrix[i]));
 	}
 }
 
 
 Allele MatrixMutator::mutate(Allele allele, size_t) const
 {
-	if (static_cast<size_t>(allele) >= m_sampler.size()) {
+	if (static_cast<size_t>(allele) >= m_rowIdx.size()) {
 		DBG_WARNIF(true, (boost::format("Allele %1% will not be mutated because mutate rates are only defined for alleles 0 ... %2%")
-			              % static_cast<size_t>(allele) % (m_sampler.size() - 1)).str());
+			              % static_cast<size_t>(allele) % (m_rowIdx.size() - 1)).str());
 		return allele;
 	}
-	return TO_ALLELE(m_sampler[allele].draw());
+	return TO_ALLELE(m_sampler[m_rowIdx[allele]].draw());
 }
 
 
@@ -418,6 +440,7 @@ Allele StepwiseMutator::mutate(Allele allele, size_t) const
 
 Allele PyMutator::mutate(Allele allele, size_t locus) const
 {
+	GILGuard gil;
 	int resInt = 0;
 
 	PyObject * args = PyTuple_New(m_func.numArgs());
@@ -501,6 +524,10 @@ Allele ContextMutator::mutate(Allele allele, size_t locus) const
 
 bool PointMutator::apply(Population & pop) const
 {
+	if (m_loci.allAvail())
+		pop.markGenoModified();
+	else
+		pop.markGenoModified(m_loci.elems(&pop));
 	subPopList subPops = applicableSubPops(pop);
 
 	subPopList::const_iterator sp = subPops.begin();
@@ -571,6 +598,10 @@ bool PointMutator::apply(Population & pop) const
 
 bool RevertFixedSites::apply(Population & pop) const
 {
+	if (m_loci.allAvail())
+		pop.markGenoModified();
+	else
+		pop.markGenoModified(m_loci.elems(&pop));
 	if (pop.popSize() == 0 || pop.totNumLoci() == 0)
 		return true;
 
@@ -678,6 +709,7 @@ size_t FiniteSitesMutator::locateVacantLocus(Population & /* pop */, size_t beg,
 
 bool FiniteSitesMutator::apply(Population & pop) const
 {
+	pop.markGenoModified();
 	// FIXME:
 	//
 	const matrixi & ranges = m_ranges.elems();
@@ -704,101 +736,121 @@ bool FiniteSitesMutator::apply(Population & pop) const
 	if (!noOutput())
 		out = &getOstream(pop.dict());
 
-	// build a set of existing mutants
-	std::set<size_t> mutants;
-	//bool saturated = false;
-
 	subPopList subPops = applicableSubPops(pop);
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
 	for (; sp != spEnd; ++sp) {
 		DBG_FAILIF(sp->isVirtual(), ValueError, "This operator does not support virtual subpopulation.");
-		for (size_t indIndex = 0; indIndex < pop.subPopSize(sp->subPop()); ++indIndex) {
-			size_t loc = 0;
-			while (true) {
-				// using a geometric distribution to determine mutants
-				loc += getRNG().randGeometric(m_rate);
-				if (loc > indWidth)
-					break;
-				Individual & ind = pop.individual(indIndex);
-				size_t p = (loc - 1) / ploidyWidth;
-				// chromosome and position on chromosome?
-				size_t mutLoc = (loc - 1) - p * ploidyWidth;
-				size_t ch = 0;
-				for (size_t reg = 0; reg < width.size(); ++reg) {
-					if (mutLoc < width[reg]) {
-						ch = reg;
-						break;
-					}
-				}
-				mutLoc += ranges[ch][0];
-				if (ch > 0)
-					mutLoc -= width[ch - 1];
-
-				// FIXME: as the first step, ignore model 2, so you do not have to figure out
-				// the function locateVacantLocus...
-				/*
-				            // mutLoci is the location of the mutant, for individual ..., chromsome ...
-				            if (m_model == 2) {
-				                // under an infinite-site model
-				                if (saturated) {
-				                    if (out)
-				                        (*out)	<< pop.gen() << '\t' << mutLoc << '\t' << indIndex
-				                                << "\t3\n";
-				                    continue;
-				                }
-				                bool ok = false;
-				                //
-				                // if the first time
-				                if (mutants.empty()) {
-				                    // first try our luck...
-				                    // FIXME:
-				                    // Here we are checing all genotypes (mutant), if mutLoc exists.
-				                    // for the new module, yo uneed to check pop.mutBegin()??? (iterate through all
-				                    // loci with non-zero allele)
-				                    ok = find(pop.genoBegin(false), pop.genoEnd(false), TO_ALLELE(mutLoc)) == pop.genoEnd(false);
-				                    if (!ok) {
-				                        std::set<size_t> existing(pop.genoBegin(false), pop.genoEnd(false));
-				                        mutants.swap(existing);
-				                        mutants.erase(0);
-				                        saturated = mutants.size() == ploidyWidth;
-				                        if (saturated)
-				                            cerr << "Failed to introduce new mutants at generation " << pop.gen() << " because all loci have existing mutants." << endl;
-				                    }
-				                }
-				                if (!ok && mutants.find(mutLoc) != mutants.end()) {
-
-				                    size_t newLoc = locateVacantLocus(pop, ranges[ch][0], ranges[ch][1], mutants);
-				                    // nothing is found
-				                    if (out)
-				                        (*out)	<< pop.gen() << '\t' << mutLoc << '\t' << indIndex
-				                                << (newLoc == 0 ? "\t3\n" : "\t2\n");
-				                    if (newLoc != 0)
-				                        mutLoc = newLoc;
-				                    else {
-				                        cerr << "Failed to introduce a new mutant at generation " << pop.gen() << " because all loci have existing mutants." << endl;
-				                        // ignore this mutation, and subsequent mutations...
-				                        saturated = true;
-				                        continue;
-				                    }
-				                    // if there is no existing mutant, new mutant is allowed
-				                }
-				                mutants.insert(mutLoc);
-				            }
-				 */
-				ind.setAllele(1, mutLoc, int(p), int(ch));
-			}   // while
-		}       // each individual
+		// mutation events of different individuals are independent, so
+		// each thread walks its own stripe of individuals with its own
+		// random number stream
+#ifdef _OPENMP
+		if (numThreads() > 1) {
+#  pragma omp parallel
+			{
+				IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
+				for (; ind.valid(); ++ind)
+					mutateIndividual(*ind, ranges, width, indWidth, ploidyWidth);
+			}
+		} else {
+#endif
+			IndIterator ind = pop.indIterator(sp->subPop());
+			for (; ind.valid(); ++ind)
+				mutateIndividual(*ind, ranges, width, indWidth, ploidyWidth);
+#ifdef _OPENMP
+		}
+#endif
 	}           // each subpopulation
 	if (out)
 		closeOstream();
 	return true;
 }
 
+
+void FiniteSitesMutator::mutateIndividual(Individual & ind, const matrixi & ranges,
+                                          const vectoru & width, size_t indWidth, size_t ploidyWidth) const
+{
+	size_t loc = 0;
+
+	while (true) {
+		// using a geometric distribution to determine mutants
+		loc += getRNG().randGeometric(m_rate);
+		if (loc > indWidth)
+			break;
+		size_t p = (loc - 1) / ploidyWidth;
+		// chromosome and position on chromosome?
+		size_t mutLoc = (loc - 1) - p * ploidyWidth;
+		size_t ch = 0;
+		for (size_t reg = 0; reg < width.size(); ++reg) {
+			if (mutLoc < width[reg]) {
+				ch = reg;
+				break;
+			}
+		}
+		mutLoc += ranges[ch][0];
+		if (ch > 0)
+			mutLoc -= width[ch - 1];
+
+		// FIXME: as the first step, ignore model 2, so you do not have to figure out
+		// the function locateVacantLocus...
+		/*
+		            // mutLoci is the location of the mutant, for individual ..., chromsome ...
+		            if (m_model == 2) {
+		                // under an infinite-site model
+		                if (saturated) {
+		                    if (out)
+		                        (*out)	<< pop.gen() << '\t' << mutLoc << '\t' << indIndex
+		                                << "\t3\n";
+		                    continue;
+		                }
+		                bool ok = false;
+		                //
+		                // if the first time
+		                if (mutants.empty()) {
+		                    // first try our luck...
+		                    // FIXME:
+		                    // Here we are checing all genotypes (mutant), if mutLoc exists.
+		                    // for the new module, yo uneed to check pop.mutBegin()??? (iterate through all
+		                    // loci with non-zero allele)
+		                    ok = find(pop.genoBegin(false), pop.genoEnd(false), TO_ALLELE(mutLoc)) == pop.genoEnd(false);
+		                    if (!ok) {
+		                        std::set<size_t> existing(pop.genoBegin(false), pop.genoEnd(false));
+		                        mutants.swap(existing);
+		                        mutants.erase(0);
+		                        saturated = mutants.size() == ploidyWidth;
+		                        if (saturated)
+		                            cerr << "Failed to introduce new mutants at generation " << pop.gen() << " because all loci have existing mutants." << endl;
+		                    }
+		                }
+		                if (!ok && mutants.find(mutLoc) != mutants.end()) {
+
+		                    size_t newLoc = locateVacantLocus(pop, ranges[ch][0], ranges[ch][1], mutants);
+		                    // nothing is found
+		                    if (out)
+		                        (*out)	<< pop.gen() << '\t' << mutLoc << '\t' << indIndex
+		                                << (newLoc == 0 ? "\t3\n" : "\t2\n");
+		                    if (newLoc != 0)
+		                        mutLoc = newLoc;
+		                    else {
+		                        cerr << "Failed to introduce a new mutant at generation " << pop.gen() << " because all loci have existing mutants." << endl;
+		                        // ignore this mutation, and subsequent mutations...
+		                        saturated = true;
+		                        continue;
+		                    }
+		                    // if there is no existing mutant, new mutant is allowed
+		                }
+		                mutants.insert(mutLoc);
+		            }
+		 */
+		ind.setAllele(1, mutLoc, int(p), int(ch));
+	}   // while
+}
+
 #ifdef LONGALLELE
 
 bool MutSpaceRevertFixedSites::apply(Population & pop) const
 {
+	pop.markGenoModified();
 	if (pop.popSize() == 0 || pop.totNumLoci() == 0)
 		return true;
 
@@ -890,6 +942,7 @@ size_t MutSpaceMutator::locateVacantLocus(Population & /* pop */, size_t beg, si
 
 bool MutSpaceMutator::apply(Population & pop) const
 {
+	pop.markGenoModified();
 	const matrixi & ranges = m_ranges.elems();
 	vectoru width(ranges.size());
 
@@ -915,6 +968,13 @@ bool MutSpaceMutator::apply(Population & pop) const
 	for (; sp != spEnd; ++sp) {
 		DBG_FAILIF(sp->isVirtual(), ValueError, "This operator does not support virtual subpopulation.");
 		for (size_t indIndex = 0; indIndex < pop.subPopSize(sp->subPop()); ++indIndex) {
+			// mutation events of this individual. They are accumulated
+			// and merged into the mutant storage in one pass per
+			// chromosome copy. Because loc increases monotonically,
+			// events arrive sorted by ploidy and chromosome.
+			vectoru eventPloidy;
+			vectoru eventChrom;
+			vectoru eventLoc;
 			size_t loc = 0;
 			while (true) {
 				// using a geometric distribution to determine mutants
@@ -982,49 +1042,69 @@ bool MutSpaceMutator::apply(Population & pop) const
 					}
 					mutants.insert(mutLoc);
 				}
-				GenoIterator geno = ind.genoBegin(p, ch);
+				// record the event, it will be applied after all events
+				// of this individual are known.
+				eventPloidy.push_back(p);
+				eventChrom.push_back(ch);
+				eventLoc.push_back(mutLoc);
+			}   // while
+			// merge events into the mutant storage, with one read and
+			// one write pass per chromosome copy.
+			size_t numEvents = eventLoc.size();
+			for (size_t i = 0; i < numEvents; ) {
+				size_t p = eventPloidy[i];
+				size_t ch = eventChrom[i];
+				// events of the same chromosome copy are adjacent
+				size_t last = i;
+				for (; last < numEvents && eventPloidy[last] == p && eventChrom[last] == ch; ++last) ;
+				GenoIterator geno = pop.individual(indIndex).genoBegin(p, ch);
 				size_t nLoci = pop.numLoci(ch);
-				if (*(geno + nLoci - 1) != 0u) {
-					// if the number of mutants at this individual exceeds reserved numbers
-					DBG_DO(DBG_MUTATOR, cerr << "Adding 10 loci to region " << ch << endl);
-					vectorf added(10);
-					for (size_t j = 0; j < 10; ++j)
-						added[j] = static_cast<double>(nLoci + j + 1);
-					vectoru addedChrom(10, ch);
-					pop.addLoci(addedChrom, added);
-					// individual might be shifted...
-					ind = pop.individual(indIndex);
-					geno = ind.genoBegin(p, ch);
-					nLoci += 10;
-				}
-				// find the first non-zero location
-				for (size_t j = 0; j < nLoci; ++j) {
-					if (*(geno + j) == 0u) {
+				// read existing mutants of this chromosome copy, which
+				// occupy a zero-terminated prefix of the region
+				vectoru alleles;
+				for (size_t j = 0; j < nLoci && *(geno + j) != 0u; ++j)
+					alleles.push_back(static_cast<size_t>(*(geno + j)));
+				size_t oldSize = alleles.size();
+				// merge events into the buffer
+				for (; i < last; ++i) {
+					size_t mutLoc = eventLoc[i];
+					DBG_FAILIF(mutLoc >= ModuleMaxAllele, RuntimeError,
+						"Location can not be saved because it exceed max allowed allele.");
+					vectoru::iterator match = std::find(alleles.begin(), alleles.end(), mutLoc);
+					if (match == alleles.end()) {
 						// record mutation here
-						DBG_FAILIF(mutLoc >= ModuleMaxAllele, RuntimeError,
-							"Location can not be saved because it exceed max allowed allele.");
-						*(geno + j) = TO_ALLELE(mutLoc);
+						alleles.push_back(mutLoc);
 						if (out)
 							(*out) << pop.gen() << '\t' << mutLoc << '\t' << indIndex << "\t0\n";
-						break;
-					} else if (static_cast<size_t>(*(geno + j)) == mutLoc) {
-						// back mutation
-						//  from A b c d 0
-						//  to   d b c d 0
-						//  to   d b c 0 0
-						for (size_t k = j + 1; k < nLoci; ++k)
-							if (*(geno + k) == 0u) {
-								*(geno + j) = *(geno + k - 1);
-								*(geno + k - 1) = 0;
-								if (out)
-									(*out) << pop.gen() << '\t' << mutLoc << '\t' << indIndex << "\t1\n";
-								break;
-							}
+					} else {
+						// back mutation, replace by the last mutant
+						*match = alleles.back();
+						alleles.pop_back();
 						DBG_DO(DBG_MUTATOR, cerr << "Back mutation happens at generation " << pop.gen() << " on individual " << indIndex << endl);
-						break;
+						if (out)
+							(*out) << pop.gen() << '\t' << mutLoc << '\t' << indIndex << "\t1\n";
 					}
 				}
-			}   // while
+				if (alleles.size() >= nLoci) {
+					// if the number of mutants at this individual exceeds reserved numbers
+					size_t added = (alleles.size() - nLoci) / 10 * 10 + 10;
+					DBG_DO(DBG_MUTATOR, cerr << "Adding " << added << " loci to region " << ch << endl);
+					vectorf addedPos(added);
+					for (size_t j = 0; j < added; ++j)
+						addedPos[j] = static_cast<double>(nLoci + j + 1);
+					vectoru addedChrom(added, ch);
+					pop.addLoci(addedChrom, addedPos);
+					// individual might be shifted...
+					geno = pop.individual(indIndex).genoBegin(p, ch);
+					nLoci += added;
+				}
+				// write the merged buffer back
+				size_t j = 0;
+				for (; j < alleles.size(); ++j)
+					*(geno + j) = TO_ALLELE(alleles[j]);
+				for (; j <= oldSize && j < nLoci; ++j)
+					*(geno + j) = 0;
+			}
 		}       // each individual
 	}           // each subpopulation
 	if (out)
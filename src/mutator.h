@@ -269,6 +269,10 @@ public:
 
 private:
 	mutable vector<WeightedSampler> m_sampler;
+
+	/// index of the compiled sampler of each source allele; alleles with
+	/// identical matrix rows share one sampler
+	vectoru m_rowIdx;
 };
 
 /** This mutator implements a \e k-allele mutation model that assumes \e k
@@ -823,6 +827,11 @@ public:
 private:
 	size_t locateVacantLocus(Population & pop, size_t beg, size_t end, std::set<size_t> & mutants) const;
 
+	/// CPPONLY apply mutation events to one individual, using the random
+	/// number stream of the calling thread
+	void mutateIndividual(Individual & ind, const matrixi & ranges,
+		const vectoru & width, size_t indWidth, size_t ploidyWidth) const;
+
 private:
 	const double m_rate;
 
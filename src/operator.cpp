@@ -339,6 +339,25 @@ opList::~opList()
 }
 
 
+bool opList::applyFused(const vectoru & ops, Population & pop, size_t & failed) const
+{
+	// each operator filters individuals itself (applicableToOffspring),
+	// so the sweep visits all individuals of the current generation
+	IndIterator ind = pop.indIterator();
+
+	for (; ind.valid(); ++ind) {
+		RawIndIterator raw = ind.rawIter();
+		for (size_t i = 0; i < ops.size(); ++i) {
+			if (!m_elems[ops[i]]->applyDuringMating(pop, pop, raw, NULL, NULL)) {
+				failed = ops[i];
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
 vectori Pause::s_cachedKeys = vectori();
 
 string Pause::describe(bool /* format */) const
@@ -354,6 +373,7 @@ string Pause::describe(bool /* format */) const
 
 bool Pause::apply(Population & pop) const
 {
+	GILGuard gil;
 	char a;
 
 	if (m_stopOnKeyStroke != static_cast<char>(false)) {
@@ -475,6 +495,7 @@ string IfElse::describe(bool format) const
 bool IfElse::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                Individual * dad, Individual * mom) const
 {
+	GILGuard gil;
 	// if offspring does not belong to subPops, do nothing, but does not fail.
 	if (!applicableToAllOffspring() && !applicableToOffspring(offPop, offspring))
 		return true;
@@ -539,6 +560,7 @@ bool IfElse::applyDuringMating(Population & pop, Population & offPop, RawIndIter
 
 bool IfElse::apply(Population & pop) const
 {
+	GILGuard gil;
 	bool res = true;
 
 	if (m_fixedCond != -1)
@@ -620,6 +642,83 @@ bool TerminateIf::apply(Population & pop) const
 }
 
 
+string TerminateIfFixed::describe(bool /* format */) const
+{
+	return string("<simuPOP.TerminateIfFixed> terminate the evolution of ") +
+	       (m_stopAll ? "all populations" : "the current population") +
+	       " if the specified loci are fixed or lost";
+}
+
+
+bool TerminateIfFixed::apply(Population & pop) const
+{
+	const vectoru & loci = m_loci.elems(&pop);
+
+	bool fixed = true;
+
+#ifdef MUTANTALLELE
+	// a population that stores no mutant is fixed for the wildtype allele
+	// at every locus
+	if (pop.totNumMutants() != 0)
+#endif
+	{
+		size_t ply = pop.ploidy();
+		for (size_t i = 0; fixed && i < loci.size(); ++i) {
+			size_t loc = loci[i];
+			DBG_FAILIF(pop.chromType(pop.chromLocusPair(loc).first) != AUTOSOME, ValueError,
+				"Operator TerminateIfFixed only supports loci on autosomes.");
+			// reuse allele counts cached by an earlier Stat call of this
+			// generation, when every subpopulation has an entry
+			bool fromCache = true;
+			std::set<size_t> present;
+			for (size_t sp = 0; fromCache && sp < pop.numSubPop(); ++sp) {
+				size_t allAlleles = 0;
+				const uintDict * cnt = pop.cachedAlleleCnt(loc, vspID(sp), allAlleles);
+				if (cnt == NULL)
+					fromCache = false;
+				else
+					for (uintDict::const_iterator a = cnt->begin(); a != cnt->end(); ++a)
+						if (a->second > 0)
+							present.insert(a->first);
+			}
+			if (fromCache) {
+				if (present.size() > 1)
+					fixed = false;
+				continue;
+			}
+			// otherwise scan genotypes, stopping at the first pair of
+			// different alleles
+			bool seen = false;
+			ULONG first = 0;
+			IndIterator it = pop.indIterator();
+			for (; fixed && it.valid(); ++it)
+				for (size_t p = 0; p < ply; ++p) {
+					ULONG a = it->allele(loc, static_cast<ssize_t>(p));
+					if (!seen) {
+						first = a;
+						seen = true;
+					} else if (a != first) {
+						fixed = false;
+						break;
+					}
+				}
+		}
+	}
+
+	if (fixed) {
+		if (!noOutput()) {
+			ostream & out = getOstream(pop.dict());
+			out << m_message << pop.gen() << endl;
+			closeOstream();
+		}
+		if (m_stopAll)
+			throw StopEvolution(m_message);
+		return false;                                            // return false, this replicate will be stopped
+	}
+	return true;
+}
+
+
 RevertIf::RevertIf(PyObject * cond, const string & fromPop, const opList & ops,
                    const stringFunc & output, int begin, int end, int step, const intList & at,
                    const intList & reps, const subPopList & subPops,
@@ -647,6 +746,7 @@ string RevertIf::describe(bool /* format */) const
 
 bool RevertIf::apply(Population & pop) const
 {
+	GILGuard gil;
 	bool res = true;
 
 	if (m_fixedCond != -1)
@@ -761,6 +861,7 @@ string DiscardIf::describe(bool format) const
 
 bool DiscardIf::apply(Population & pop) const
 {
+	GILGuard gil;
 	// mark as not remove for everyone
 	pop.markIndividuals(vspID(), false);
 
@@ -875,6 +976,7 @@ bool DiscardIf::apply(Population & pop) const
 bool DiscardIf::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                   Individual * dad, Individual * mom) const
 {
+	GILGuard gil;
 	// if offspring does not belong to subPops, do nothing, but does not fail.
 	if (!applicableToAllOffspring() && !applicableToOffspring(offPop, offspring))
 		return true;
@@ -1114,6 +1216,7 @@ string PyOperator::describe(bool /* format */) const
 
 bool PyOperator::apply(Population & pop) const
 {
+	GILGuard gil;
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
@@ -1193,6 +1296,7 @@ bool PyOperator::apply(Population & pop) const
 bool PyOperator::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                    Individual * dad, Individual * mom) const
 {
+	GILGuard gil;
 	// if offspring does not belong to subPops, do nothing, but does not fail.
 	if (!applicableToAllOffspring() && !applicableToOffspring(offPop, offspring))
 		return true;
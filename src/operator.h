@@ -302,6 +302,19 @@ public:
 	}
 
 
+	/** CPPONLY whether or not this operator can join a fused sweep, in
+	 *  which a run of consecutive post-mating operators is applied to
+	 *  every individual in turn during a single pass over the population.
+	 *  An operator should only report true if its apply() is equivalent
+	 *  to calling applyDuringMating on each individual of the current
+	 *  generation.
+	 */
+	virtual bool fusable() const
+	{
+		return false;
+	}
+
+
 	/// CPPONLY
 	virtual void initialize(const Individual & ind) const
 	{
@@ -420,6 +433,14 @@ public:
 	}
 
 
+	/** CPPONLY apply the fusable operators with indexes \e ops to each
+	 *  individual of \e pop in one pass over the population. If an
+	 *  operator returns false, \e failed is set to its index and the
+	 *  sweep stops.
+	 */
+	bool applyFused(const vectoru & ops, Population & pop, size_t & failed) const;
+
+
 protected:
 	vectorop m_elems;
 };
@@ -680,6 +701,71 @@ private:
 };
 
 
+/** This operator terminates the evolution of a population (or of all
+ *  replicates of a simulator if \e stopAll is set to \c True) when all
+ *  specified loci have stopped segregating, namely when every locus carries
+ *  a single allele (which can be the wildtype allele) across the whole
+ *  population. Unlike a \c TerminateIf operator that evaluates an expression
+ *  on variables set by a \c Stat operator, this operator checks genotypes
+ *  directly and stops at the first pair of different alleles, so detecting
+ *  fixation does not require a full allele frequency pass or any Python
+ *  expression evaluation.
+ */
+class TerminateIfFixed : public BaseOperator
+{
+
+public:
+	/** Create a terminator that terminates the evolution of a population
+	 *  when all loci specified by parameter \e loci (default to all loci)
+	 *  are fixed or lost, namely when no specified locus carries more than
+	 *  one allele. If \e stopAll is set to \c True, the evolution of all
+	 *  replicates of the simulator will be terminated. If this operator is
+	 *  allowed to write to an \e output (default to ""), the generation
+	 *  number, proceeded with an optional \e message, will be written to it.
+	 *  Loci on non-autosomal chromosomes are not supported.
+	 */
+	TerminateIfFixed(const lociList & loci = lociList(), bool stopAll = false,
+		string message = string(), const stringFunc & output = "",
+		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
+		const intList & reps = intList(), const subPopList & subPops = subPopList(),
+		const stringList & infoFields = vectorstr()) :
+		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
+		m_loci(loci), m_stopAll(stopAll), m_message(message)
+	{
+	}
+
+
+	/// HIDDEN Deep copy of a \c TerminateIfFixed terminator
+	virtual BaseOperator * clone() const
+	{
+		return new TerminateIfFixed(*this);
+	}
+
+
+	/// HIDDEN
+	string describe(bool format = true) const;
+
+
+	/// HIDDEN check if the specified loci have stopped segregating.
+	bool apply(Population & pop) const;
+
+	virtual ~TerminateIfFixed()
+	{
+	}
+
+
+private:
+	/// loci to check for fixation
+	const lociList m_loci;
+
+	///
+	const bool m_stopAll;
+
+	/// message to print when terminated
+	const string m_message;
+};
+
+
 /** This operator replaces the current evolving population by a population
  *  loaded from a specified filename if certain condition is met. It is mostly
  *  used to return to a previously saved state if the simulation process
@@ -24,6 +24,17 @@
  */
 #include "outputer.h"
 
+#include "boost_pch.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#ifndef _WIN32
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
 namespace simuPOP {
 
 bool PyOutput::apply(Population & pop) const
@@ -99,6 +110,36 @@ void Dumper::displayStructure(const Population & pop, ostream & out) const
 }
 
 
+void Dumper::displayHexGenotype(const Population & pop, const Individual & ind, ostream & out) const
+{
+	static const char hexDigit[] = "0123456789abcdef";
+
+	// fixed-width hexadecimal allele values (a single digit for the binary
+	// module), assembled into one buffer per individual to bypass the
+	// per-value width and allele name logic of the formatted output
+#ifdef BINARYALLELE
+	const size_t digits = 1;
+#else
+	const size_t digits = sizeof(Allele) * 2;
+#endif
+	size_t ply = pop.ploidy();
+	size_t nLoci = m_loci.empty() ? pop.totNumLoci() : m_loci.size();
+	string line;
+
+	line.reserve(ply * (nLoci * digits + 1));
+	for (size_t p = 0; p < ply; ++p) {
+		if (p > 0)
+			line += ' ';
+		for (size_t i = 0; i < nLoci; ++i) {
+			size_t a = ind.allele(m_loci.empty() ? i : m_loci[i], static_cast<ssize_t>(p));
+			for (size_t d = digits; d > 0; --d)
+				line += hexDigit[(a >> ((d - 1) * 4)) & 0xf];
+		}
+	}
+	out << line;
+}
+
+
 UINT Dumper::displayGenotype(const Population & pop, const subPopList & subPops, ostream & out) const
 {
 	UINT count = 0;
@@ -117,11 +158,19 @@ UINT Dumper::displayGenotype(const Population & pop, const subPopList & subPops,
 
 		const_cast<Population &>(pop).activateVirtualSubPop(*sp);
 		IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop());
+		// a tail window advances the iterator without reading any genotype,
+		// so only the pages of the output individuals are touched
+		if (m_last > 0)
+			for (size_t skip = spSize > m_last ? spSize - m_last : 0; skip > 0 && ind.valid(); --skip)
+				++ind;
 		for ( ; ind.valid(); ++ind, ++count) {
 			out << setw(4) << (&*ind - &*pop.rawIndBegin()) << ": ";
-			ind->display(out, m_width, m_loci, infoIdx);
+			if (m_hex)
+				displayHexGenotype(pop, *ind, out);
+			else
+				ind->display(out, m_width, m_loci, infoIdx);
 			out << endl;
-			if (m_max > 0 && count + 1 >= m_max && count < pop.popSize())
+			if (m_last == 0 && m_max > 0 && count + 1 >= m_max && count < pop.popSize())
 				break;
 		}
 		const_cast<Population &>(pop).deactivateVirtualSubPop(sp->subPop());
@@ -169,7 +218,82 @@ bool Dumper::apply(Population & pop) const
 
 string SavePopulation::describe(bool /* format */) const
 {
-	return "<simuPOP.SavePopulation> save population to file " + m_filename;
+	return "<simuPOP.SavePopulation> save population to file " + m_filename
+	       + (m_async ? " in a background process" : "")
+	       + (m_manifest.empty() ? "" : ", published through manifest " + m_manifest);
+}
+
+
+SavePopulation::~SavePopulation()
+{
+	waitSaves();
+}
+
+
+UINT SavePopulation::pendingSaves() const
+{
+#ifndef _WIN32
+	// reap writers that have finished since the last call
+	for (size_t i = 0; i < m_children.size(); ) {
+		int status = 0;
+		pid_t ret = waitpid(static_cast<pid_t>(m_children[i]), &status, WNOHANG);
+		if (ret == 0)
+			++i;
+		else {
+			if (ret < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+				m_failed = true;
+			m_children.erase(m_children.begin() + i);
+		}
+	}
+#endif
+	return static_cast<UINT>(m_children.size());
+}
+
+
+bool SavePopulation::waitSaves() const
+{
+#ifndef _WIN32
+	for (size_t i = 0; i < m_children.size(); ++i) {
+		int status = 0;
+		pid_t ret = waitpid(static_cast<pid_t>(m_children[i]), &status, 0);
+		if (ret < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			m_failed = true;
+	}
+	m_children.clear();
+#endif
+	bool succeeded = !m_failed;
+	m_failed = false;
+	return succeeded;
+}
+
+
+namespace {
+
+/// move a finished checkpoint to its published name. std::rename
+/// replaces an existing destination atomically on POSIX systems but
+/// fails on Windows, where the destination is removed first.
+void publishFile(const string & tmp, const string & filename)
+{
+	if (std::rename(tmp.c_str(), filename.c_str()) != 0) {
+		std::remove(filename.c_str());
+		std::rename(tmp.c_str(), filename.c_str());
+	}
+}
+
+
+/// point the manifest at the newest complete checkpoint. The manifest
+/// itself is written under a temporary name and renamed so that a
+/// standby reader never observes a partial update.
+void publishManifest(const string & manifest, const string & filename, size_t gen)
+{
+	string tmp = manifest + ".tmp";
+	std::ofstream out(tmp.c_str(), std::ios::trunc);
+
+	out << filename << '\t' << gen << '\n';
+	out.close();
+	publishFile(tmp, manifest);
+}
+
 }
 
 
@@ -188,7 +312,234 @@ bool SavePopulation::apply(Population & pop) const
 		filename = filenameParser.valueAsString();
 	}
 	DBG_DO(DBG_POPULATION, cerr << "Save to file " << filename << endl);
-	pop.save(filename);
+	if (m_skipUnchanged || filename.find("%digest%") != string::npos) {
+		const string digest = pop.genotypeDigest();
+		// content-addressed names: identical content maps to the same file
+		size_t pos;
+		while ((pos = filename.find("%digest%")) != string::npos)
+			filename.replace(pos, 8, digest);
+		if (m_skipUnchanged && digest == m_lastDigest && !m_lastSaved.empty()) {
+			// this checkpoint content is already on disk
+			if (filename == m_lastSaved) {
+				// a standby still needs to learn the current generation
+				if (!m_manifest.empty())
+					publishManifest(m_manifest, filename, pop.gen());
+				return true;
+			}
+#ifndef _WIN32
+			// identical content under a new name: hard-link the previous
+			// checkpoint, after any background writer has finished it
+			if (!m_async || waitSaves()) {
+				unlink(filename.c_str());
+				if (link(m_lastSaved.c_str(), filename.c_str()) == 0) {
+					m_lastSaved = filename;
+					if (!m_manifest.empty())
+						publishManifest(m_manifest, filename, pop.gen());
+					return true;
+				}
+			}
+#endif
+			// fall through to a regular save when linking is unsupported
+		}
+		m_lastDigest = digest;
+	}
+	// in standby mode, write under a temporary name so that the name a
+	// standby can pick up always refers to a complete checkpoint
+	const string target = m_manifest.empty() ? filename : filename + ".part";
+#ifndef _WIN32
+	if (m_async) {
+		// the file written last time may serve as the base of this
+		// snapshot, so a writer still working on it has to finish first.
+		// This also keeps at most one copy-on-write snapshot of the
+		// population alive.
+		bool succeeded = waitSaves();
+		(void)succeeded;
+		DBG_WARNIF(!succeeded,
+			"A background save of operator SavePopulation has failed.");
+		pid_t pid = fork();
+		if (pid == 0) {
+			// child process: serialize the copy-on-write snapshot and exit
+			// without running any cleanup of the parent process
+			try {
+				pop.save(target, m_lastSaved);
+				if (!m_manifest.empty()) {
+					publishFile(target, filename);
+					publishManifest(m_manifest, filename, pop.gen());
+				}
+			} catch (...) {
+				_exit(1);
+			}
+			_exit(0);
+		} else if (pid > 0) {
+			m_children.push_back(pid);
+			m_lastSaved = filename;
+			return true;
+		}
+		// if fork fails, save in the present process
+	}
+#endif
+	// chain binary snapshots: an unchanged generation is then written as
+	// a reference into the previous checkpoint instead of being
+	// re-serialized.
+	pop.save(target, m_lastSaved);
+	if (!m_manifest.empty()) {
+		publishFile(target, filename);
+		publishManifest(m_manifest, filename, pop.gen());
+	}
+	m_lastSaved = filename;
+	return true;
+}
+
+
+string ExportGenotype::describe(bool /* format */) const
+{
+	return "<simuPOP.ExportGenotype> export genotypes to file " + m_filename;
+}
+
+
+namespace {
+
+/// write a fixed-width value to a binary stream
+template <typename T>
+void writeValue(ostream & out, const T & value)
+{
+	out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+}
+
+
+bool ExportGenotype::apply(Population & pop) const
+{
+	if (m_filename.empty())
+		return true;
+
+	string filename;
+
+	if (m_filename[0] != '!')
+		filename = m_filename;
+	else {
+		Expression filenameParser(m_filename.substr(1));
+		filenameParser.setLocalDict(pop.dict());
+		filename = filenameParser.valueAsString();
+	}
+	DBG_DO(DBG_POPULATION, cerr << "Export genotypes to file " << filename << endl);
+
+	pop.syncIndPointers();
+
+	vectoru loci = m_loci;
+	if (loci.empty()) {
+		loci.resize(pop.totNumLoci());
+		for (size_t i = 0; i < loci.size(); ++i)
+			loci[i] = i;
+	}
+	for (size_t i = 0; i < loci.size(); ++i)
+		DBG_FAILIF(loci[i] >= pop.totNumLoci(), IndexError,
+			(boost::format("Locus index %1% out of range of 0 ~ %2%") % loci[i]
+			 % (pop.totNumLoci() - 1)).str());
+
+	boost::iostreams::filtering_ostream out;
+
+	// a ".gz" extension selects gzip compressed output
+	if (filename.size() > 3 && filename.compare(filename.size() - 3, 3, ".gz") == 0)
+		out.push(boost::iostreams::gzip_compressor());
+	// open file to write
+	boost::iostreams::file_sink dest(filename, std::ios::binary);
+	if (!dest.is_open())
+		throw ValueError("Cannot write to file " + filename);
+	out.push(dest);
+	// if out itself get into trouble
+	if (!out)
+		throw ValueError("Cannot export genotypes to file " + filename);
+
+	// the header states the layout of the blocks that follow so that
+	// external readers do not have to be compiled against a particular
+	// allele type.
+	char magic[16] = "simuPOP-geno";
+	writeValue(out, magic);
+	writeValue(out, static_cast<ULONG>(2));                 // layout version
+	writeValue(out, static_cast<ULONG>(sizeof(Allele)));
+	// version 2 states the block encoding explicitly so that readers (and
+	// importGenotype) do not have to guess the writing module from the
+	// allele size, which is ambiguous between some modules.
+#ifdef MUTANTALLELE
+	writeValue(out, static_cast<ULONG>(2));                 // sparse (row, value) pairs
+#elif defined(BINARYALLELE)
+	writeValue(out, static_cast<ULONG>(1));                 // packed bits
+#else
+	writeValue(out, static_cast<ULONG>(0));                 // raw allele values
+#endif
+	writeValue(out, static_cast<ULONG>(pop.ploidy()));
+	writeValue(out, static_cast<ULONG>(pop.popSize()));
+	writeValue(out, static_cast<ULONG>(loci.size()));
+
+	size_t ply = pop.ploidy();
+	size_t rows = pop.popSize() * ply;
+
+#ifdef MUTANTALLELE
+	(void)rows;
+	// a single pass over the compressed storage buckets mutants by their
+	// locus so that the locus-major blocks can be written out without one
+	// map lookup per cell of the matrix.
+	size_t totNumLoci = pop.totNumLoci();
+	vectoru lociMap(totNumLoci, NOT_FOUND);
+	for (size_t i = 0; i < loci.size(); ++i)
+		lociMap[loci[i]] = i;
+	vector<vectoru> rowOf(loci.size());
+	vector<vector<Allele> > valOf(loci.size());
+	RawIndIterator it = pop.rawIndBegin();
+	RawIndIterator it_end = pop.rawIndEnd();
+	for (size_t idx = 0; it != it_end; ++it, ++idx) {
+		GenoIterator git = it->genoBegin();
+		vectorm::val_iterator vit = git.get_val_iterator();
+		vectorm::val_iterator vit_end = it->genoEnd().get_val_iterator();
+		size_t indIndex = git.index();
+		for (; vit != vit_end; ++vit) {
+			size_t rel = vit->first - indIndex;
+			size_t col = lociMap[rel % totNumLoci];
+			if (col == NOT_FOUND)
+				continue;
+			rowOf[col].push_back(idx * ply + rel / totNumLoci);
+			valOf[col].push_back(vit->second);
+		}
+	}
+	// each block lists the non-zero cells of its column as (row, value)
+	// pairs, preceded by the number of pairs.
+	for (size_t i = 0; i < loci.size(); ++i) {
+		writeValue(out, static_cast<ULONG>(rowOf[i].size()));
+		for (size_t j = 0; j < rowOf[i].size(); ++j) {
+			writeValue(out, static_cast<ULONG>(rowOf[i][j]));
+			writeValue(out, valOf[i][j]);
+		}
+	}
+#elif defined(BINARYALLELE)
+	// each block packs one column of the matrix into eight alleles per
+	// byte, least significant bit first.
+	vector<unsigned char> buf((rows + 7) / 8);
+	for (size_t i = 0; i < loci.size(); ++i) {
+		std::fill(buf.begin(), buf.end(), 0);
+		size_t row = 0;
+		RawIndIterator it = pop.rawIndBegin();
+		RawIndIterator it_end = pop.rawIndEnd();
+		for (; it != it_end; ++it)
+			for (size_t p = 0; p < ply; ++p, ++row)
+				if (*(it->genoBegin(p) + loci[i]))
+					buf[row / 8] |= 1 << (row % 8);
+		out.write(reinterpret_cast<const char *>(&buf[0]), buf.size());
+	}
+#else
+	// each block stores one column of the matrix as raw allele values
+	vector<Allele> col(rows);
+	for (size_t i = 0; i < loci.size(); ++i) {
+		size_t row = 0;
+		RawIndIterator it = pop.rawIndBegin();
+		RawIndIterator it_end = pop.rawIndEnd();
+		for (; it != it_end; ++it)
+			for (size_t p = 0; p < ply; ++p, ++row)
+				col[row] = *(it->genoBegin(p) + loci[i]);
+		out.write(reinterpret_cast<const char *>(&col[0]), col.size() * sizeof(Allele));
+	}
+#endif
 	return true;
 }
 
@@ -106,15 +106,24 @@ public:
 	 *  operator will only output individuals in these outputs. Please refer to
 	 *  class \c BaseOperator for a detailed explanation for common parameters
 	 *  such as \e output and \e stage.
+	 *
+	 *  If parameter \e hex is set to \c True, genotypes are written as plain
+	 *  hexadecimal allele values (without allele names, separators or
+	 *  information fields), which is much faster than the formatted output
+	 *  and is intended for eyeballing very large populations. If parameter
+	 *  \e last is set to a positive number, the last \e last individuals of
+	 *  each subpopulation are output instead of the first \e max, without
+	 *  reading the genotypes of the skipped individuals.
 	 */
 	Dumper(bool genotype = true, bool structure = true, const uintList & ancGens = uintList(NULL),
-		int width = 1, UINT max = 100, const uintList & loci = vectoru(), const stringFunc & output = ">",
+		int width = 1, UINT max = 100, const uintList & loci = vectoru(),
+		bool hex = false, UINT last = 0, const stringFunc & output = ">",
 		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList()) :
 		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
 		m_showGenotype(genotype), m_showStructure(structure), m_ancGens(ancGens), m_width(width),
-		m_loci(loci.elems()), m_max(max)
+		m_hex(hex), m_loci(loci.elems()), m_max(max), m_last(last)
 	{
 	}
 
@@ -145,6 +154,8 @@ public:
 private:
 	void displayStructure(const Population & pop, ostream & out) const;
 
+	void displayHexGenotype(const Population & pop, const Individual & ind, ostream & out) const;
+
 	UINT displayGenotype(const Population & pop, const subPopList & subPops, ostream & out) const;
 
 private:
@@ -160,11 +171,17 @@ private:
 	/// disp width when outputing alleles
 	const int m_width;
 
+	/// dump alleles as plain hexadecimal values
+	const bool m_hex;
+
 	///
 	const vectoru m_loci;
 
 	/// only output first ... individuals. Good for large population
 	const UINT m_max;
+
+	/// if set, output the last ... individuals of each subpopulation instead
+	const UINT m_last;
 };
 
 
@@ -178,26 +195,75 @@ public:
 	 *  specifications (\c '', \c 'filename', \c 'filename' prefixed by one
 	 *  or more '>' characters, and \c '!expr') but output from different
 	 *  operators will always replace existing files (effectively ignore
-	 *  '>' specification). Parameter \e subPops is ignored. Please refer to
-	 *  class \c BaseOperator for a detailed description about common operator
-	 *  parameters such as \e stage and \e begin.
+	 *  '>' specification). If \e async is set to \c True on a system that
+	 *  supports it, the population is written by a forked child process
+	 *  that keeps a copy-on-write snapshot of the population, so that
+	 *  evolution can continue while the file is being saved. Functions
+	 *  \c pendingSaves() and \c waitSaves() can be used to check or wait
+	 *  for the completion of such background saves, which are also waited
+	 *  for when the operator is destroyed. If \e skipUnchanged is set to
+	 *  \c True, the genotype digest of the population (c.f.
+	 *  <tt>Population.genotypeDigest()</tt>, backed by the modification
+	 *  counter so unchanged populations do not even rehash) is compared
+	 *  against the previously saved checkpoint: identical content is not
+	 *  written again, but either skipped (same filename) or hard-linked to
+	 *  the previous file (new filename, on systems that support links),
+	 *  which removes the I/O stalls of checkpointing burn-in plateaus. The
+	 *  token <tt>%digest%</tt> in \e output is replaced by the genotype
+	 *  digest, producing content-addressed checkpoint names that
+	 *  deduplicate by construction. If a \e manifest file name is given,
+	 *  every checkpoint is first written under a temporary name and
+	 *  renamed when complete, and \e manifest is then atomically replaced
+	 *  by a single line naming the newest complete checkpoint and its
+	 *  generation number. A standby process on another node, with the
+	 *  output directory on a shared or mirrored filesystem, can follow the
+	 *  manifest and assume the run from the newest checkpoint at any
+	 *  moment without ever observing a partial file; applied at every
+	 *  generation with delta-chained binary snapshots, this bounds the
+	 *  loss on a node failure to the generation being written, while full
+	 *  archives can be taken at any coarser cadence. Parameter \e subPops
+	 *  is ignored. Please refer to class \c BaseOperator for a detailed
+	 *  description about common operator parameters such as \e stage and
+	 *  \e begin.
 	 */
-	SavePopulation(const stringFunc & output = "", int begin = 0, int end = -1,
+	SavePopulation(const stringFunc & output = "", bool async = false,
+		bool skipUnchanged = false, const string & manifest = string(),
+		int begin = 0, int end = -1,
 		int step = 1, const intList & at = vectori(), const intList & reps = intList(),
 		const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr()) :
 		BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
-		m_filename(output.value())
+		m_filename(output.value()), m_async(async), m_skipUnchanged(skipUnchanged),
+		m_manifest(manifest),
+		m_lastSaved(), m_lastDigest(), m_children(), m_failed(false)
 	{
 		DBG_WARNIF(output.empty(), "An empty output string is passed to operator SavePopulation. No file will be saved.");
 	}
 
 
-	/// destructor.
-	~SavePopulation()
+	/// CPPONLY
+	SavePopulation(const SavePopulation & rhs) :
+		BaseOperator(rhs), m_filename(rhs.m_filename), m_async(rhs.m_async),
+		m_skipUnchanged(rhs.m_skipUnchanged), m_manifest(rhs.m_manifest),
+		m_lastSaved(rhs.m_lastSaved),
+		m_lastDigest(rhs.m_lastDigest), m_children(), m_failed(false)
 	{
 	}
 
 
+	/// destructor. Background saves are waited for.
+	~SavePopulation();
+
+	/** Return the number of background save processes started in
+	 *  asynchronous mode that are still writing their files.
+	 */
+	UINT pendingSaves() const;
+
+	/** Wait until all background save processes started in asynchronous
+	 *  mode have finished, and return \c True if all of them (since the
+	 *  last call of this function) succeeded.
+	 */
+	bool waitSaves() const;
+
 	/// HIDDEN Deep copy of a SavePopulation operator.
 	virtual BaseOperator * clone() const
 	{
@@ -214,6 +280,94 @@ public:
 private:
 	/// filename,
 	const string m_filename;
+
+	/// whether or not files are written by forked child processes
+	const bool m_async;
+
+	/// whether or not checkpoints with unchanged genotypes are skipped
+	/// or hard-linked instead of being written again
+	const bool m_skipUnchanged;
+
+	/// manifest file pointing a standby process at the newest complete
+	/// checkpoint, or an empty string when standby publication is off
+	const string m_manifest;
+
+	/// file written by the previous application of this operator, used
+	/// as the base of the next binary snapshot
+	mutable string m_lastSaved;
+
+	/// genotype digest of the previously saved population
+	mutable string m_lastDigest;
+
+	/// ids of forked writer processes that have not been waited for
+	mutable vectori m_children;
+
+	/// whether or not a reaped background save has failed
+	mutable bool m_failed;
+};
+
+
+/** An operator that exports the genotypes of a population to a file in a
+ *  locus-major binary layout, suitable for post-processing with external
+ *  tools without going through Python objects.
+ */
+class ExportGenotype : public BaseOperator
+{
+public:
+	/** Create an operator that writes the genotype matrix of the present
+	 *  generation to file \e output (or a file determined by expression
+	 *  \c '!expr') when it is applied to a population. The file starts
+	 *  with a small header (magic bytes, allele size, block encoding,
+	 *  ploidy, numbers of individuals and loci) followed by one block per
+	 *  locus so that downstream tools can read per-locus columns
+	 *  sequentially. Blocks store raw allele values, packed bits in the
+	 *  binary module, or sparse (row, value) pairs in the mutant module,
+	 *  as stated by the encoding field. Such files can be read back with
+	 *  function \c importGenotype, also when they were written by, or are
+	 *  destined for, a different allele module. If \e output ends
+	 *  in \c '.gz' the file is gzip compressed. A subset of loci can be
+	 *  specified with parameter \e loci (all loci by default). Parameter
+	 *  \e subPops is ignored and genotypes of all individuals are
+	 *  exported. Please refer to class \c BaseOperator for a detailed
+	 *  description about common operator parameters such as \e stage and
+	 *  \e begin.
+	 */
+	ExportGenotype(const stringFunc & output = "", const uintList & loci = vectoru(),
+		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
+		const intList & reps = intList(), const subPopList & subPops = subPopList(),
+		const stringList & infoFields = vectorstr()) :
+		BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
+		m_filename(output.value()), m_loci(loci.elems())
+	{
+		DBG_WARNIF(output.empty(), "An empty output string is passed to operator ExportGenotype. No file will be saved.");
+	}
+
+
+	/// destructor.
+	~ExportGenotype()
+	{
+	}
+
+
+	/// HIDDEN Deep copy of an ExportGenotype operator.
+	virtual BaseOperator * clone() const
+	{
+		return new ExportGenotype(*this);
+	}
+
+
+	/// HIDDEN apply operator to population \e pop.
+	virtual bool apply(Population & pop) const;
+
+	/// HIDDEN
+	string describe(bool format = true) const;
+
+private:
+	/// filename,
+	const string m_filename;
+
+	/// loci to export, all loci if empty.
+	const vectoru m_loci;
 };
 
 }
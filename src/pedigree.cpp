@@ -30,6 +30,10 @@ using std::ofstream;
 
 #include <set>
 
+#if PY_VERSION_HEX >= 0x03000000
+#  define PyInt_FromSize_t(x) PyLong_FromSize_t(x)
+#endif
+
 namespace simuPOP {
 
 Pedigree::Pedigree(const Population & pop, const lociList & loci,
@@ -96,17 +100,50 @@ Pedigree::Pedigree(const Pedigree & rhs) :
 
 void Pedigree::buildIDMap()
 {
-	// build an ID map
+	// build an ID index. IDs assigned by IdTagger increase with the order
+	// in which individuals are stored, so the index is first collected as
+	// intervals of consecutive IDs in consecutive slots, which typically
+	// compresses a whole generation into a single entry.
 	m_idMap.clear();
+	m_idRuns.clear();
 	for (int depth = ancestralGens(); depth >= 0; --depth) {
 		useAncestralGen(depth);
 		for (IndIterator it = indIterator(); it.valid(); ++it) {
 			size_t id = toID(it->info(m_idIdx));
-			DBG_WARNIF(m_idMap.find(id) != m_idMap.end() && *m_idMap[id] != *it,
-				(boost::format("Different individuals share the same ID %1%"
-					           " so only the latest Individual will be used. If this is an "
-					           "age-structured population, you may want to remove parental generations.") % id).str());
-			m_idMap[id] = &*it;
+			if (!m_idRuns.empty()) {
+				IdRun & run = m_idRuns.back();
+				if (id == run.firstID + run.size && &*it == run.first + run.size) {
+					++run.size;
+					continue;
+				}
+			}
+			IdRun run = { id, 1, &*it };
+			m_idRuns.push_back(run);
+		}
+	}
+	std::sort(m_idRuns.begin(), m_idRuns.end(), runOrder);
+	// overlapping runs indicate duplicate IDs (e.g. parents that are kept
+	// around in an age-structured population). The compressed index cannot
+	// express the latest-individual-wins rule for duplicates, so such
+	// pedigrees fall back to the per-individual hash map.
+	bool overlap = false;
+	for (size_t i = 1; i < m_idRuns.size(); ++i)
+		if (m_idRuns[i].firstID - m_idRuns[i - 1].firstID < m_idRuns[i - 1].size) {
+			overlap = true;
+			break;
+		}
+	if (overlap) {
+		m_idRuns.clear();
+		for (int depth = ancestralGens(); depth >= 0; --depth) {
+			useAncestralGen(depth);
+			for (IndIterator it = indIterator(); it.valid(); ++it) {
+				size_t id = toID(it->info(m_idIdx));
+				DBG_WARNIF(m_idMap.find(id) != m_idMap.end() && *m_idMap[id] != *it,
+					(boost::format("Different individuals share the same ID %1%"
+						           " so only the latest Individual will be used. If this is an "
+						           "age-structured population, you may want to remove parental generations.") % id).str());
+				m_idMap[id] = &*it;
+			}
 		}
 	}
 }
@@ -151,12 +188,12 @@ void Pedigree::save(const string & filename, const stringList & fieldList,
 			size_t motherID = 0;
 			if (m_fatherIdx != -1) {
 				fatherID = toID(it->info(m_fatherIdx));
-				if (fatherID && m_idMap.find(fatherID) == m_idMap.end())
+				if (fatherID && findID(fatherID) == NULL)
 					fatherID = 0;
 			}
 			if (m_motherIdx != -1) {
 				motherID = toID(it->info(m_motherIdx));
-				if (motherID && m_idMap.find(motherID) == m_idMap.end())
+				if (motherID && findID(motherID) == NULL)
 					motherID = 0;
 			}
 			char sexChar = it->sex() == MALE ? 'M' : 'F';
@@ -191,19 +228,19 @@ size_t Pedigree::numParents() const
 
 Individual & Pedigree::indByID(double fid) const
 {
-	// essentially m_idMap(toID(fid))
+	// essentially findID(toID(fid))
 	//
 	size_t id = toID(fid);
 
 	DBG_FAILIF(fabs(fid - id) > 1e-8, ValueError,
 		"individual ID has to be integer (or a double round to full iteger).");
 
-	IdMap::iterator it = m_idMap.find(id);
+	Individual * ind = findID(id);
 	// if still cannot be found, raise an IndexError.
-	if (it == m_idMap.end())
+	if (ind == NULL)
 		throw IndexError((boost::format("No individual with ID %1% could be found.") % id).str());
 
-	return *it->second;
+	return *ind;
 }
 
 
@@ -314,10 +351,13 @@ void Pedigree::locateSpouse(SexChoice sexChoice, AffectionStatus affectionChoice
 				if (excludeOutbred) {
 					// if they share a father or a mother.
 					try {
-						double f1 = indByID(m).info(m_fatherIdx);
-						double m1 = indByID(m).info(m_motherIdx);
-						double f2 = indByID(f).info(m_fatherIdx);
-						double m2 = indByID(f).info(m_motherIdx);
+						// locate each parent only once
+						const Individual & mom = indByID(m);
+						const Individual & dad = indByID(f);
+						double f1 = mom.info(m_fatherIdx);
+						double m1 = mom.info(m_motherIdx);
+						double f2 = dad.info(m_fatherIdx);
+						double m2 = dad.info(m_motherIdx);
 						if ((fcmp_ge(f1, 1) && fcmp_eq(f1, f2)) || (fcmp_ge(m1, 1) && fcmp_eq(m1, m2)))
 							continue;
 					} catch (IndexError &) {
@@ -477,14 +517,18 @@ void Pedigree::locateSibling(SexChoice sexChoice, AffectionStatus affectionChoic
 		const vectoru & sibs = it->second;
 		if (sibs.size() <= 1)
 			continue;
+		// resolve IDs of the whole family in one pass, individuals
+		// that cannot be found are ignored.
+		vector<Individual *> sibInds;
+		indsByID(sibs, sibInds);
 		for (size_t i = 0; i < sibs.size(); ++i) {
-			try {
-				Individual & child = indByID(sibs[i]);
+			if (sibInds[i] != NULL) {
+				Individual & child = *sibInds[i];
 				for (size_t j = 0; j < sibs.size(); ++j) {
 					if (i == j)
 						continue;
-					try {
-						Individual & sibling = indByID(sibs[j]);
+					if (sibInds[j] != NULL) {
+						Individual & sibling = *sibInds[j];
 
 						if (numSibling[sibs[i]] < maxSibling &&
 						    acceptableSex(child.sex(), sibling.sex(), sexChoice) &&
@@ -517,12 +561,8 @@ void Pedigree::locateSibling(SexChoice sexChoice, AffectionStatus affectionChoic
 							}
 						}
 						// idx
-					} catch (...) {
-						continue;
 					}
 				}
-			} catch (...) {
-				// if does not found, ignore this couple.
 			}
 		}
 	}
@@ -572,13 +612,17 @@ void Pedigree::locateFullSibling(SexChoice sexChoice, AffectionStatus affectionC
 		const vectoru & sibs = it->second;
 		if (sibs.size() <= 1)
 			continue;
+		// resolve IDs of the whole family in one pass, individuals
+		// that cannot be found are ignored.
+		vector<Individual *> sibInds;
+		indsByID(sibs, sibInds);
 		for (size_t i = 0; i < sibs.size(); ++i) {
-			try {
-				Individual & child = indByID(sibs[i]);
+			if (sibInds[i] != NULL) {
+				Individual & child = *sibInds[i];
 				for (size_t j = 0; j < sibs.size(); ++j) {
-					if (i == j)
+					if (i == j || sibInds[j] == NULL)
 						continue;
-					Individual & sibling = indByID(sibs[j]);
+					Individual & sibling = *sibInds[j];
 
 					if (numSibling[sibs[i]] < maxSibling &&
 					    acceptableSex(child.sex(), sibling.sex(), sexChoice) &&
@@ -611,8 +655,6 @@ void Pedigree::locateFullSibling(SexChoice sexChoice, AffectionStatus affectionC
 						}
 					}                                                                                       // idx
 				}
-			} catch (...) {
-				// if does not found, ignore this couple.
 			}
 		}
 	}
@@ -677,10 +719,12 @@ void Pedigree::locateCommonOffspring(SexChoice sexChoice, AffectionStatus affect
 			bool valid_ma = ma_spouse != -1 && toID(ma_spouse) == p;
 			if (!valid_fa && !valid_ma)
 				continue;
-			// offspring
+			// offspring, resolved in one pass, missing ones are ignored.
+			vector<Individual *> offInds;
+			indsByID(offspring, offInds);
 			for (size_t j = 0; j < offspring.size(); ++j) {
-				try {
-					Individual & child = indByID(offspring[j]);
+				if (offInds[j] != NULL) {
+					Individual & child = *offInds[j];
 					bool valid = acceptableSex(MALE, child.sex(), sexChoice) &&
 					             acceptableAffectionStatus(child.affected(), affectionChoice);
 					// duplicate child
@@ -701,8 +745,6 @@ void Pedigree::locateCommonOffspring(SexChoice sexChoice, AffectionStatus affect
 							++numOffspring[m];
 						}
 					}
-				} catch (...) {
-					// if does not found, ignore this offspring
 				}
 			}
 		} catch (...) {
@@ -791,9 +833,10 @@ bool Pedigree::traceRelatives(const stringMatrix & fieldPath,
 				vectoru newInds;
 				// for all individuals
 				for (size_t i = 0; i < inds.size(); ++i) {
-					// for all fields
+					// locate the individual only once for all fields
+					const Individual & myInd = indByID(inds[i]);
 					for (size_t s = 0; s < fields.size(); ++s) {
-						double sID = indByID(inds[i]).info(fields[s]);
+						double sID = myInd.info(fields[s]);
 						if (sID < 0)
 							continue;
 						Individual & sind = indByID(sID);
@@ -969,7 +1012,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 		if (it->second >= 0)
 			continue;
 		// this guy should exist
-		Individual * ind = m_idMap[it->first];
+		Individual * ind = findID(it->first);
 		Individual * dad = NULL;
 		Individual * mom = NULL;
 		ssize_t dadFam = -2;
@@ -982,7 +1025,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 			// because father exists in famID
 			if (dad_fam != famID.end()) {
 				dadFam = dad_fam->second;
-				dad = m_idMap[dad_id];
+				dad = findID(dad_id);
 			}
 		}
 		if (m_motherIdx != -1) {
@@ -992,7 +1035,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 			// because father exists in famID
 			if (mom_fam != famID.end()) {
 				momFam = mom_fam->second;
-				mom = m_idMap[mom_id];
+				mom = findID(mom_id);
 			}
 		}
 		// CASE TWO: no parent
@@ -1060,7 +1103,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 		ssize_t famID = it->second;
 		++famSize[famID];
 		if (pedIdx >= 0)
-			m_idMap[it->first]->setInfo(static_cast<double>(famID), static_cast<size_t>(pedIdx));
+			findID(it->first)->setInfo(static_cast<double>(famID), static_cast<size_t>(pedIdx));
 	}
 	useAncestralGen(oldGen);
 	return famSize;
@@ -1111,58 +1154,52 @@ vectoru Pedigree::identifyAncestors(const uintList & IDs,
 		const vectoru & inputIDs = IDs.elems();
 		res.reserve(inputIDs.size());
 		for (size_t i = 0; i < inputIDs.size(); ++i)
-			if (m_idMap.find(inputIDs[i]) != m_idMap.end())
+			if (findID(inputIDs[i]) != NULL)
 				res.push_back(inputIDs[i]);
 	}
-	// step 3: trace back like a spider
-	size_t start = 0;
-	while (true) {
-		size_t end = res.size();
-		if (start == end)
-			break;
-		for (size_t i = start; i < end; ++i) {
-			size_t ID = res[i];
+	// step 3: trace backward one generation at a time. Instead of chasing
+	// each lineage separately, the whole frontier is expanded per level:
+	// candidate parent IDs are collected, deduplicated as a sorted batch
+	// and resolved against the ID index in one sweep.
+	vector<Individual *> frontier;
+	indsByID(res, frontier);
+	frontier.erase(std::remove(frontier.begin(), frontier.end(),
+			static_cast<Individual *>(NULL)), frontier.end());
+	vectoru cand;
+	vector<Individual *> parents;
+	while (!frontier.empty()) {
+		cand.clear();
+		for (size_t i = 0; i < frontier.size(); ++i) {
 			// true ID starts from 1
-			size_t father_ID = 0;
-			size_t mother_ID = 0;
-			try {
-				// if this ID exists
-				Individual & ind = indByID(ID);
-				if (m_fatherIdx != -1)
-					father_ID = toID(ind.info(m_fatherIdx));
-				if (m_motherIdx != -1)
-					mother_ID = toID(ind.info(m_motherIdx));
-			} catch (IndexError &) {
-				//
+			if (m_fatherIdx != -1) {
+				size_t father_ID = toID(frontier[i]->info(m_fatherIdx));
+				if (father_ID)
+					cand.push_back(father_ID);
 			}
-			if (father_ID) {
-				try {
-					Individual & father = indByID(father_ID);
-					if (father.marked()) {
-						res.push_back(father_ID);
-						// this father is already included
-						father.setMarked(false);
-					}
-				} catch (IndexError &) {
-					///
-				}
+			if (m_motherIdx != -1) {
+				size_t mother_ID = toID(frontier[i]->info(m_motherIdx));
+				if (mother_ID)
+					cand.push_back(mother_ID);
 			}
-			if (mother_ID) {
-				try {
-					Individual & mother = indByID(mother_ID);
-					if (mother.marked()) {
-						res.push_back(mother_ID);
-						// this mother is already included
-						mother.setMarked(false);
-					}
-				} catch (IndexError &) {
-					///
-				}
+		}
+		// each parent is probed only once per level
+		std::sort(cand.begin(), cand.end());
+		cand.erase(std::unique(cand.begin(), cand.end()), cand.end());
+		// ID lookups dominate the cost of a level and only read the
+		// ID index, so they can be spread over the candidate batch
+		parents.resize(cand.size());
+#pragma omp parallel for if (numThreads() > 1)
+		for (ssize_t i = 0; i < static_cast<ssize_t>(cand.size()); ++i)
+			parents[i] = findID(cand[i]);
+		frontier.clear();
+		for (size_t i = 0; i < cand.size(); ++i) {
+			if (parents[i] != NULL && parents[i]->marked()) {
+				res.push_back(cand[i]);
+				frontier.push_back(parents[i]);
+				// this parent is already included
+				parents[i]->setMarked(false);
 			}
 		}
-		// all parents of individuals between start and end has been located
-		// start to find the parent of these parents
-		start = end;
 	}
 	return res;
 }
@@ -1230,22 +1267,39 @@ vectoru Pedigree::identifyOffspring(const uintList & IDs,
 	const vectoru & inputIDs = IDs.elems();
 	res.reserve(inputIDs.size());
 	for (size_t i = 0; i < inputIDs.size(); ++i)
-		if (m_idMap.find(inputIDs[i]) != m_idMap.end())
+		if (findID(inputIDs[i]) != NULL)
 			res.push_back(inputIDs[i]);
-	size_t start = 0;
-	while (true) {
-		size_t end = res.size();
-		if (start == end)
-			break;
-		for (size_t i = start; i < end; ++i) {
-			size_t ID = res[i];
-			if (offspringMap.find(ID) == offspringMap.end())
+	// trace forward one generation at a time, expanding the whole frontier
+	// per level so that each individual is visited only once even when it
+	// has many ancestors among the starting IDs.
+	vectoru frontier = res;
+	vectoru cand;
+	vector<Individual *> offspring;
+	while (!frontier.empty()) {
+		cand.clear();
+		for (size_t i = 0; i < frontier.size(); ++i) {
+			std::map<size_t, vectoru>::const_iterator rec = offspringMap.find(frontier[i]);
+			if (rec == offspringMap.end())
 				continue;
-			res.insert(res.end(), offspringMap[ID].begin(), offspringMap[ID].end());
+			cand.insert(cand.end(), rec->second.begin(), rec->second.end());
+		}
+		// each offspring is probed only once per level
+		std::sort(cand.begin(), cand.end());
+		cand.erase(std::unique(cand.begin(), cand.end()), cand.end());
+		// lookups only read the ID index and can be spread over the batch
+		offspring.resize(cand.size());
+#pragma omp parallel for if (numThreads() > 1)
+		for (ssize_t i = 0; i < static_cast<ssize_t>(cand.size()); ++i)
+			offspring[i] = findID(cand[i]);
+		frontier.clear();
+		for (size_t i = 0; i < cand.size(); ++i) {
+			// an unmarked individual has been recorded in an earlier level
+			if (offspring[i] != NULL && offspring[i]->marked()) {
+				res.push_back(cand[i]);
+				frontier.push_back(cand[i]);
+				offspring[i]->setMarked(false);
+			}
 		}
-		// all offspring of individuals between start and end has been located
-		// start to find the offspring of these offspring
-		start = end;
 	}
 	// return a unique list
 	std::sort(res.begin(), res.end());
@@ -1255,6 +1309,253 @@ vectoru Pedigree::identifyOffspring(const uintList & IDs,
 }
 
 
+PyObject * Pedigree::kinship(const uintList & IDs, double cutoff) const
+{
+	DBG_FAILIF(m_idIdx == -1, ValueError,
+		"Kinship can only be computed from a pedigree with an ID field.");
+	DBG_FAILIF(m_fatherIdx == -1 && m_motherIdx == -1, ValueError,
+		"Kinship can only be computed from a pedigree with parental information.");
+
+	// step 1: requested individuals
+	vectoru ids;
+	if (IDs.allAvail() || IDs.unspecified()) {
+		ConstRawIndIterator it = rawIndBegin();
+		ConstRawIndIterator itEnd = rawIndEnd();
+		for (; it != itEnd; ++it)
+			ids.push_back(toID(it->info(m_idIdx)));
+	} else {
+		ids = IDs.elems();
+		for (size_t i = 0; i < ids.size(); ++i)
+			if (findID(ids[i]) == NULL)
+				throw IndexError((boost::format("No individual with ID %1% could be found.") % ids[i]).str());
+	}
+
+	// step 2: assign a generation depth to the ancestor closure of the
+	// requested individuals so that parents can be processed before their
+	// offspring. A parent ID without a stored individual is kept as a
+	// founder node, which correctly relates e.g. half sibs of a parent
+	// that is not part of the pedigree object.
+	typedef std::map<size_t, int> DepthMap;
+	DepthMap depth;
+	vectoru stack = ids;
+	while (!stack.empty()) {
+		size_t id = stack.back();
+		DepthMap::iterator dit = depth.insert(DepthMap::value_type(id, -1)).first;
+		if (dit->second >= 0) {
+			stack.pop_back();
+			continue;
+		}
+		size_t dad = fatherOf(id);
+		size_t mom = motherOf(id);
+		int d = 0;
+		bool ready = true;
+		if (dad) {
+			DepthMap::const_iterator pit = depth.find(dad);
+			if (pit == depth.end() || pit->second < 0) {
+				stack.push_back(dad);
+				ready = false;
+			} else if (pit->second + 1 > d)
+				d = pit->second + 1;
+		}
+		if (mom) {
+			DepthMap::const_iterator pit = depth.find(mom);
+			if (pit == depth.end() || pit->second < 0) {
+				stack.push_back(mom);
+				ready = false;
+			} else if (pit->second + 1 > d)
+				d = pit->second + 1;
+		}
+		if (ready) {
+			dit->second = d;
+			stack.pop_back();
+		}
+	}
+
+	// step 3: sort the closure by depth so that the rows of all parents
+	// are finished before the row of any of their offspring
+	vector<std::pair<int, size_t> > order;
+	order.reserve(depth.size());
+	DepthMap::const_iterator mit = depth.begin();
+	DepthMap::const_iterator mitEnd = depth.end();
+	for (; mit != mitEnd; ++mit)
+		order.push_back(std::make_pair(mit->second, mit->first));
+	std::sort(order.begin(), order.end());
+	size_t n = order.size();
+	std::map<size_t, size_t> rowOf;
+	for (size_t i = 0; i < n; ++i)
+		rowOf[order[i].second] = i;
+	vector<ssize_t> dadRow(n, -1);
+	vector<ssize_t> momRow(n, -1);
+	for (size_t i = 0; i < n; ++i) {
+		size_t dad = fatherOf(order[i].second);
+		size_t mom = motherOf(order[i].second);
+		if (dad)
+			dadRow[i] = rowOf[dad];
+		if (mom)
+			momRow[i] = rowOf[mom];
+	}
+
+	// step 4: the tabular (Henderson) recursion
+	//    phi(i, j) = (phi(j, dad) + phi(j, mom)) / 2
+	//    phi(i, i) = (1 + phi(dad, mom)) / 2
+	if (cutoff <= 0) {
+		DBG_WARNIF(n > 32768,
+			"The full kinship matrix of a large pedigree needs a lot of memory. "
+			"Consider passing a positive cutoff to obtain a sparse result.");
+		// full lower-triangular kinship matrix in a flat array
+		vector<double> phi(n * (n + 1) / 2, 0.);
+		for (size_t i = 0; i < n; ++i) {
+			double * row = &phi[i * (i + 1) / 2];
+			ssize_t fr = dadRow[i];
+			ssize_t mr = momRow[i];
+			// every entry of a row only reads finished rows, so the row
+			// can be filled in parallel
+#pragma omp parallel for if (numThreads() > 1)
+			for (ssize_t j = 0; j < static_cast<ssize_t>(i); ++j) {
+				double v = 0;
+				if (fr >= 0)
+					v += fr >= j ? phi[fr * (fr + 1) / 2 + j] : phi[j * (j + 1) / 2 + fr];
+				if (mr >= 0)
+					v += mr >= j ? phi[mr * (mr + 1) / 2 + j] : phi[j * (j + 1) / 2 + mr];
+				row[j] = 0.5 * v;
+			}
+			double fm = 0;
+			if (fr >= 0 && mr >= 0)
+				fm = fr >= mr ? phi[fr * (fr + 1) / 2 + mr] : phi[mr * (mr + 1) / 2 + fr];
+			row[i] = 0.5 + 0.5 * fm;
+		}
+		// rows and columns follow the order of the requested IDs
+		PyObject * res = PyList_New(ids.size());
+		for (size_t i = 0; i < ids.size(); ++i) {
+			size_t ri = rowOf[ids[i]];
+			PyObject * row = PyList_New(ids.size());
+			for (size_t j = 0; j < ids.size(); ++j) {
+				size_t rj = rowOf[ids[j]];
+				size_t a = ri >= rj ? ri : rj;
+				size_t b = ri >= rj ? rj : ri;
+				PyList_SET_ITEM(row, j, PyFloat_FromDouble(phi[a * (a + 1) / 2 + b]));
+			}
+			PyList_SET_ITEM(res, i, row);
+		}
+		return res;
+	}
+
+	// sparse variant: each node keeps column-sorted (row, kinship) pairs
+	// for related nodes only. The row of a node is a merge of the lists
+	// of its parents, so pairs with kinship below the cutoff are dropped
+	// and unrelated parts of the pedigree never meet.
+	typedef std::pair<size_t, double> SparseEntry;
+	vector<vector<SparseEntry> > adj(n);
+	vector<double> diag(n, 0.5);
+	vector<SparseEntry> dadList;
+	vector<SparseEntry> momList;
+	vector<SparseEntry> row;
+	for (size_t i = 0; i < n; ++i) {
+		ssize_t fr = dadRow[i];
+		ssize_t mr = momRow[i];
+		// copies of the parents' lists with their own diagonals inserted,
+		// so that the merge also yields the kinship between i and a parent
+		dadList.clear();
+		if (fr >= 0) {
+			const vector<SparseEntry> & src = adj[fr];
+			size_t k = 0;
+			for (; k < src.size() && src[k].first < static_cast<size_t>(fr); ++k)
+				dadList.push_back(src[k]);
+			dadList.push_back(SparseEntry(fr, diag[fr]));
+			for (; k < src.size(); ++k)
+				dadList.push_back(src[k]);
+		}
+		momList.clear();
+		if (mr >= 0) {
+			const vector<SparseEntry> & src = adj[mr];
+			size_t k = 0;
+			for (; k < src.size() && src[k].first < static_cast<size_t>(mr); ++k)
+				momList.push_back(src[k]);
+			momList.push_back(SparseEntry(mr, diag[mr]));
+			for (; k < src.size(); ++k)
+				momList.push_back(src[k]);
+		}
+		row.clear();
+		size_t a = 0;
+		size_t b = 0;
+		while (a < dadList.size() || b < momList.size()) {
+			size_t col;
+			double v;
+			if (b >= momList.size() || (a < dadList.size() && dadList[a].first < momList[b].first)) {
+				col = dadList[a].first;
+				v = 0.5 * dadList[a].second;
+				++a;
+			} else if (a >= dadList.size() || momList[b].first < dadList[a].first) {
+				col = momList[b].first;
+				v = 0.5 * momList[b].second;
+				++b;
+			} else {
+				col = dadList[a].first;
+				v = 0.5 * (dadList[a].second + momList[b].second);
+				++a;
+				++b;
+			}
+			if (v >= cutoff)
+				row.push_back(SparseEntry(col, v));
+		}
+		// kinship between the two parents for the diagonal
+		double fm = 0;
+		if (fr >= 0 && mr >= 0) {
+			size_t lo = 0;
+			size_t hi = dadList.size();
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+				if (dadList[mid].first < static_cast<size_t>(mr))
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			if (lo < dadList.size() && dadList[lo].first == static_cast<size_t>(mr))
+				fm = dadList[lo].second;
+		}
+		diag[i] = 0.5 + 0.5 * fm;
+		// nodes are processed in increasing row order so the appended
+		// columns keep every list sorted
+		for (size_t k = 0; k < row.size(); ++k)
+			adj[row[k].first].push_back(SparseEntry(i, row[k].second));
+		adj[i] = row;
+	}
+
+	// assemble a dictionary for the requested pairs
+	vector<bool> wanted(n, false);
+	for (size_t i = 0; i < ids.size(); ++i)
+		wanted[rowOf[ids[i]]] = true;
+	PyObject * res = PyDict_New();
+	for (size_t i = 0; i < n; ++i) {
+		if (!wanted[i])
+			continue;
+		size_t idI = order[i].second;
+		PyObject * key = PyTuple_New(2);
+		PyTuple_SET_ITEM(key, 0, PyInt_FromSize_t(idI));
+		PyTuple_SET_ITEM(key, 1, PyInt_FromSize_t(idI));
+		PyObject * val = PyFloat_FromDouble(diag[i]);
+		PyDict_SetItem(res, key, val);
+		Py_DECREF(key);
+		Py_DECREF(val);
+		for (size_t k = 0; k < adj[i].size(); ++k) {
+			size_t j = adj[i][k].first;
+			// entries with j > i cover each pair exactly once
+			if (j <= i || !wanted[j])
+				continue;
+			size_t idJ = order[j].second;
+			key = PyTuple_New(2);
+			PyTuple_SET_ITEM(key, 0, PyInt_FromSize_t(idI <= idJ ? idI : idJ));
+			PyTuple_SET_ITEM(key, 1, PyInt_FromSize_t(idI <= idJ ? idJ : idI));
+			val = PyFloat_FromDouble(adj[i][k].second);
+			PyDict_SetItem(res, key, val);
+			Py_DECREF(key);
+			Py_DECREF(val);
+		}
+	}
+	return res;
+}
+
+
 void Pedigree::removeIndividuals(const uintList & indexes,
                                  const floatList & IDs, const string & idField, PyObject * filter)
 {
@@ -1368,91 +1669,164 @@ Pedigree loadPedigree(const string & file, const string & idField, const string
 	typedef std::tr1::unordered_map<size_t, IndInfo *> IdMap;
 #endif
 	IdMap individuals;
-	while (getline(input, line)) {
-		if (line.empty())
-			continue;
-		//
-		IndInfo * info = NULL;
-		size_t myID = 0;
-		int part = 0;
-		char * p = strtok(const_cast<char *>(line.c_str()), " ");
-		// boost::tokenizer is proven to be too slow..... (5.5s vs. 1.5s)
-		while (p) {
-			char * q = p;
-			p = strtok(NULL, " ");
-			// collect self ID
-			if (part == 0) {
-				myID = atoi(q);
-				if (individuals.find(myID) != individuals.end())
-					throw ValueError((boost::format("Duplicate individual ID %1%") % myID).str());
-				info = (individuals.insert(IdMap::value_type(myID, new IndInfo())).first)->second;
-				++part;
-				continue;
-				// parental ID and sex
-			} else if (part == 1) {
-				if (*q == 'M') {
-					info->sex = MALE;
-					++part;
+	/* files written by PedigreeTagger(..., format='binary') start every
+	   record with the marker bytes 'PB'. A text pedigree always starts with
+	   a numeric ID, so the first byte tells the two formats apart. */
+	if (input.peek() == 'P') {
+		input.close();
+		ifstream bin(file.c_str(), std::ios::in | std::ios::binary);
+		char marker[2];
+		while (bin.read(marker, 2)) {
+			if (marker[0] != 'P' || marker[1] != 'B')
+				throw ValueError("Corrupted record marker in binary pedigree file " + file);
+			uint64_t ids[3] = { 0, 0, 0 };
+			char sexChar = 'M';
+			char affChar = 'U';
+			uint16_t numFields = 0;
+			uint32_t numGeno = 0;
+			bin.read(reinterpret_cast<char *>(ids), sizeof(ids));
+			bin.read(&sexChar, 1);
+			bin.read(&affChar, 1);
+			bin.read(reinterpret_cast<char *>(&numFields), sizeof(numFields));
+			bin.read(reinterpret_cast<char *>(&numGeno), sizeof(numGeno));
+			if (!bin)
+				throw ValueError("Truncated record in binary pedigree file " + file);
+			size_t myID = static_cast<size_t>(ids[0]);
+			if (individuals.find(myID) != individuals.end())
+				throw ValueError((boost::format("Duplicate individual ID %1%") % myID).str());
+			IndInfo * info = (individuals.insert(IdMap::value_type(myID, new IndInfo())).first)->second;
+			info->sex = sexChar == 'M' ? MALE : FEMALE;
+			info->affectionStatus = affChar == 'A';
+			// a parent ID of zero means that the parent is missing
+			for (size_t p = 1; p <= 2; ++p) {
+				size_t id = static_cast<size_t>(ids[p]);
+				if (id == 0)
 					continue;
-				} else if (*q == 'F') {
-					info->sex = FEMALE;
+				info->parents.push_back(id);
+				IdMap::iterator it = individuals.find(id);
+				// this is a parent but we do not know if he or she has parent
+				if (it == individuals.end())
+					individuals[id] = new IndInfo(myID);
+				else
+					it->second->offspring.push_back(myID);
+			}
+			if (info->parents.size() > 2)
+				throw ValueError("At most two parental IDs are allowed");
+			info->fields.resize(numFields);
+			if (numFields > 0)
+				bin.read(reinterpret_cast<char *>(&info->fields[0]),
+					static_cast<std::streamsize>(numFields * sizeof(double)));
+			if (numGeno > 0) {
+				std::vector<uint32_t> geno(numGeno);
+				bin.read(reinterpret_cast<char *>(&geno[0]),
+					static_cast<std::streamsize>(numGeno * sizeof(uint32_t)));
+				info->genotype.reserve(numGeno);
+				for (size_t i = 0; i < geno.size(); ++i)
+					info->genotype.push_back(TO_ALLELE(geno[i]));
+			}
+			if (!bin)
+				throw ValueError("Truncated record in binary pedigree file " + file);
+			if (!info->genotype.empty()) {
+				if (loci.empty()) {
+					loci.push_back(info->genotype.size() / pldy);
+					genoCols = info->genotype.size();
+					if (loci.back() * pldy != genoCols)
+						throw ValueError("Incorrect number of genotype colmns for a diploid population.");
+				} else {
+					if (genoCols != info->genotype.size())
+						throw ValueError("Inconsistent number of columns of genotypes.");
+				}
+			}
+			if (max_parents < info->parents.size())
+				max_parents = info->parents.size();
+		}
+	} else {
+		while (getline(input, line)) {
+			if (line.empty())
+				continue;
+			//
+			IndInfo * info = NULL;
+			size_t myID = 0;
+			int part = 0;
+			char * p = strtok(const_cast<char *>(line.c_str()), " ");
+			// boost::tokenizer is proven to be too slow..... (5.5s vs. 1.5s)
+			while (p) {
+				char * q = p;
+				p = strtok(NULL, " ");
+				// collect self ID
+				if (part == 0) {
+					myID = atoi(q);
+					if (individuals.find(myID) != individuals.end())
+						throw ValueError((boost::format("Duplicate individual ID %1%") % myID).str());
+					info = (individuals.insert(IdMap::value_type(myID, new IndInfo())).first)->second;
 					++part;
 					continue;
-				} else {
-					size_t id = atoi(q);
-					if (id) {
-						info->parents.push_back(id);
-						IdMap::iterator it = individuals.find(id);
-						// this is a parent but we do not know if he or she has parent
-						if (it == individuals.end())
-							individuals[id] = new IndInfo(myID);
-						else
-							it->second->offspring.push_back(myID);
+					// parental ID and sex
+				} else if (part == 1) {
+					if (*q == 'M') {
+						info->sex = MALE;
+						++part;
+						continue;
+					} else if (*q == 'F') {
+						info->sex = FEMALE;
+						++part;
+						continue;
+					} else {
+						size_t id = atoi(q);
+						if (id) {
+							info->parents.push_back(id);
+							IdMap::iterator it = individuals.find(id);
+							// this is a parent but we do not know if he or she has parent
+							if (it == individuals.end())
+								individuals[id] = new IndInfo(myID);
+							else
+								it->second->offspring.push_back(myID);
+						}
+						if (info->parents.size() > 2)
+							throw ValueError("At most two parental IDs are allowed before sex information");
 					}
-					if (info->parents.size() > 2)
-						throw ValueError("At most two parental IDs are allowed before sex information");
+					// parental affection status, can be ignored
+				} else if (part == 2) {
+					if (*q == 'A')
+						info->affectionStatus = true;
+					else if (*q == 'U')
+						info->affectionStatus = false;
+					else
+						++part;
 				}
-				// parental affection status, can be ignored
-			} else if (part == 2) {
-				if (*q == 'A')
-					info->affectionStatus = true;
-				else if (*q == 'U')
-					info->affectionStatus = false;
-				else
-					++part;
-			}
 
-			// information fields, can be ignored
-			if (part == 3) {
-				if (info->fields.size() == infoFields.size())
-					++part;
-				else
-					info->fields.push_back(atof(q));
-			}
+				// information fields, can be ignored
+				if (part == 3) {
+					if (info->fields.size() == infoFields.size())
+						++part;
+					else
+						info->fields.push_back(atof(q));
+				}
 
-			// genotype
-			if (part == 4)
-				info->genotype.push_back(TO_ALLELE(atoi(q)));
-		}
-		// if there is no valid input...
-		if (part == 0)
-			continue;
-		if (!info->genotype.empty()) {
-			if (loci.empty()) {
-				loci.push_back(info->genotype.size() / pldy);
-				genoCols = info->genotype.size();
-				if (loci.back() * pldy != genoCols)
-					throw ValueError("Incorrect number of genotype colmns for a diploid population.");
-			} else {
-				if (genoCols != info->genotype.size())
-					throw ValueError("Inconsistent number of columns of genotypes.");
+				// genotype
+				if (part == 4)
+					info->genotype.push_back(TO_ALLELE(atoi(q)));
+			}
+			// if there is no valid input...
+			if (part == 0)
+				continue;
+			if (!info->genotype.empty()) {
+				if (loci.empty()) {
+					loci.push_back(info->genotype.size() / pldy);
+					genoCols = info->genotype.size();
+					if (loci.back() * pldy != genoCols)
+						throw ValueError("Incorrect number of genotype colmns for a diploid population.");
+				} else {
+					if (genoCols != info->genotype.size())
+						throw ValueError("Inconsistent number of columns of genotypes.");
+				}
 			}
+			//
+			if (max_parents < info->parents.size())
+				max_parents = info->parents.size();
 		}
-		//
-		if (max_parents < info->parents.size())
-			max_parents = info->parents.size();
+		input.close();
 	}
-	input.close();
 	elapsedTime("Readfile");
 	DBG_DO(DBG_POPULATION, cerr << "Information about " << individuals.size() << " individuals are loaded." << endl);
 	// create the top most ancestral generation
@@ -94,10 +94,10 @@ public:
 	{
 		if (id == 0 || m_fatherIdx == -1)
 			return 0;
-		IdMap::iterator it = m_idMap.find(id);
-		if (it == m_idMap.end())
+		Individual * ind = findID(id);
+		if (ind == NULL)
 			return 0;
-		return toID(it->second->info(m_fatherIdx));
+		return toID(ind->info(m_fatherIdx));
 	}
 
 
@@ -107,10 +107,10 @@ public:
 	{
 		if (id == 0 || m_motherIdx == -1)
 			return 0;
-		IdMap::iterator it = m_idMap.find(id);
-		if (it == m_idMap.end())
+		Individual * ind = findID(id);
+		if (ind == NULL)
 			return 0;
-		return toID(it->second->info(m_motherIdx));
+		return toID(ind->info(m_motherIdx));
 	}
 
 
@@ -149,12 +149,24 @@ public:
 	/** CPPONLY */
 	Individual & indByID(size_t id) const
 	{
-		IdMap::iterator it = m_idMap.find(id);
+		Individual * ind = findID(id);
 
 		// if still cannot be found, raise an IndexError.
-		if (it == m_idMap.end())
+		if (ind == NULL)
 			throw IndexError((boost::format("No individual with ID %1% could be found.") % id).str());
-		return *it->second;
+		return *ind;
+	}
+
+
+	/** CPPONLY Resolve a vector of individual IDs in one pass through the
+	 *  ID index. Pointers to located individuals are stored in \e inds,
+	 *  with \c NULL for IDs that could not be found.
+	 */
+	void indsByID(const vectoru & ids, vector<Individual *> & inds) const
+	{
+		inds.resize(ids.size());
+		for (size_t i = 0; i < ids.size(); ++i)
+			inds[i] = findID(ids[i]);
 	}
 
 
@@ -303,6 +315,28 @@ public:
 		const subPopList & subPops = subPopList(),
 		const uintList & ancGens = uintList());
 
+	/** Compute pairwise kinship coefficients between individuals with
+	 *  \e IDs (default to all individuals of the present generation)
+	 *  using the recursive tabular (Henderson) method. All ancestors of
+	 *  the specified individuals are extracted from the pedigree and
+	 *  processed parents before offspring, so the result accounts for
+	 *  arbitrarily distant shared ancestry and inbreeding. A parent who
+	 *  is referred to by an ID but is not present in the pedigree is
+	 *  treated as an unrelated and non-inbred founder. If \e cutoff is
+	 *  zero (default), the full matrix is returned as a list of lists
+	 *  whose rows and columns follow the order of \e IDs. If a positive
+	 *  \e cutoff is given, kinship coefficients smaller than \e cutoff
+	 *  are treated as zero both during the computation and in the
+	 *  result, and a dictionary with keys <tt>(id1, id2)</tt>
+	 *  (<tt>id1 <= id2</tt>) and kinship values is returned. This keeps
+	 *  memory usage proportional to the number of related pairs instead
+	 *  of the square of the pedigree size, at the cost of ignoring
+	 *  remote relationships. The additive relationship (numerator)
+	 *  matrix used by breeding programs is twice the kinship matrix.
+	 *  <group>4-locate</group>
+	 */
+	PyObject * kinship(const uintList & IDs = uintList(), double cutoff = 0) const;
+
 	/** HIDDEN This function has the potential to change individuals in a
 	 *  population so the ID map needs to be rebuilt.
 	 */
@@ -397,6 +431,51 @@ private:
 #else
 	typedef std::tr1::unordered_map<size_t, Individual *> IdMap;
 #endif
+
+	/** A run of consecutive individual IDs stored in consecutive slots of
+	 *  the individual vector of one generation. Operator \c IdTagger hands
+	 *  out IDs in storage order, so a whole generation usually collapses
+	 *  into a single run and the ID index costs a few words per generation
+	 *  instead of a hash map entry per individual.
+	 */
+	struct IdRun
+	{
+		size_t firstID;
+		size_t size;
+		Individual * first;
+	};
+
+	static bool idBeforeRun(size_t id, const IdRun & run)
+	{
+		return id < run.firstID;
+	}
+
+
+	static bool runOrder(const IdRun & a, const IdRun & b)
+	{
+		return a.firstID < b.firstID;
+	}
+
+
+	/// CPPONLY Locate an individual by ID, return NULL for unknown IDs.
+	Individual * findID(size_t id) const
+	{
+		if (!m_idRuns.empty()) {
+			vector<IdRun>::const_iterator r = std::upper_bound(
+				m_idRuns.begin(), m_idRuns.end(), id, idBeforeRun);
+			if (r == m_idRuns.begin())
+				return NULL;
+			--r;
+			return id - r->firstID < r->size ? r->first + (id - r->firstID) : NULL;
+		}
+		IdMap::iterator it = m_idMap.find(id);
+		return it == m_idMap.end() ? NULL : it->second;
+	}
+
+
+	/// interval-compressed ID index, sorted by first ID of each run. It is
+	/// left empty if duplicate IDs force the use of the hash map below.
+	vector<IdRun> m_idRuns;
 	mutable IdMap m_idMap;
 };
 
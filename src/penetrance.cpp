@@ -63,36 +63,52 @@ bool BasePenetrance::apply(Population & pop) const
 			if (sp->isVirtual())
 				pop.activateVirtualSubPop(*sp);
 
+			// affection status is assigned in two passes over blocks of
+			// individuals: penetrance values are first gathered into a
+			// buffer, then compared against a batch of uniform draws.
+			// Separating the (often expensive) penetrance calls from the
+			// random number stream keeps both passes tight loops.
+			const size_t blockSize = 1024;
 			if (numThreads() > 1 && parallelizable()) {
 #pragma omp parallel
 				{
 #ifdef _OPENMP
+					vector<RawIndIterator> block;
+					vectorf pene;
+					block.reserve(blockSize);
 					IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
-					for (; ind.valid(); ++ind) {
-						double p = penet(&pop, ind.rawIter());
-
+					while (ind.valid()) {
+						block.clear();
+						for (; ind.valid() && block.size() < blockSize; ++ind)
+							block.push_back(ind.rawIter());
+						pene.resize(block.size());
+						for (size_t k = 0; k < block.size(); ++k)
+							pene[k] = penet(&pop, block[k]);
 						if (savePene)
-							ind->setInfo(p, infoIdx);
-
-						if (getRNG().randUniform() < p)
-							ind->setAffected(true);
-						else
-							ind->setAffected(false);
+							for (size_t k = 0; k < block.size(); ++k)
+								block[k]->setInfo(pene[k], infoIdx);
+						for (size_t k = 0; k < block.size(); ++k)
+							block[k]->setAffected(getRNG().randUniform() < pene[k]);
 					}
 #endif
 				}
 			} else {
+				vector<RawIndIterator> block;
+				vectorf pene;
+				block.reserve(blockSize);
 				IndIterator ind = pop.indIterator(sp->subPop());
-				for (; ind.valid(); ++ind) {
-					double p = penet(&pop, ind.rawIter());
-
+				while (ind.valid()) {
+					block.clear();
+					for (; ind.valid() && block.size() < blockSize; ++ind)
+						block.push_back(ind.rawIter());
+					pene.resize(block.size());
+					for (size_t k = 0; k < block.size(); ++k)
+						pene[k] = penet(&pop, block[k]);
 					if (savePene)
-						ind->setInfo(p, infoIdx);
-
-					if (getRNG().randUniform() < p)
-						ind->setAffected(true);
-					else
-						ind->setAffected(false);
+						for (size_t k = 0; k < block.size(); ++k)
+							block[k]->setInfo(pene[k], infoIdx);
+					for (size_t k = 0; k < block.size(); ++k)
+						block[k]->setAffected(getRNG().randUniform() < pene[k]);
 				}
 			}
 			if (sp->isVirtual())
@@ -242,22 +258,29 @@ double MaPenetrance::penet(Population * /* pop */, RawIndIterator ind) const
 	UINT index = 0;
 	bool singleST = m_wildtype.size() == 1;
 	const vectoru & loci = m_loci.elems(&*ind);
+	// resolve ploidy and locus layout once instead of through
+	// Individual::allele at each selected locus
+	size_t ply = ind->ploidy();
+	GenoIterator geno = ind->genoBegin();
 
-	DBG_FAILIF((ind->ploidy() == 2 && m_penetrance.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
-		(ind->ploidy() == 1 && m_penetrance.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
+	DBG_FAILIF((ply == 2 && m_penetrance.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
+		(ply == 1 && m_penetrance.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
 		ValueError, "Please specify penetrance for each combination of genotype.");
 
-	for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
-		if (ind->ploidy() == 1) {
-			Allele a = TO_ALLELE(ind->allele(*loc));
+	if (ply == 1) {
+		for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+			Allele a = TO_ALLELE(DEREF_ALLELE(geno + *loc));
 			if (singleST)
 				index = index * 2 + (ALLELE_AS_UNSINGED(a) != m_wildtype[0]);
 			else
 				index = index * 2 + (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(a)) == m_wildtype.end());
-		} else if (ind->ploidy() == 2) {
+		}
+	} else if (ply == 2) {
+		size_t totLoci = ind->totNumLoci();
+		for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
 			// get genotype of ind
-			Allele a = TO_ALLELE(ind->allele(*loc, 0));
-			Allele b = TO_ALLELE(ind->allele(*loc, 1));
+			Allele a = TO_ALLELE(DEREF_ALLELE(geno + *loc));
+			Allele b = TO_ALLELE(DEREF_ALLELE(geno + *loc + totLoci));
 
 			int numWildtype = 0;
 
@@ -274,9 +297,9 @@ double MaPenetrance::penet(Population * /* pop */, RawIndIterator ind) const
 			}
 
 			index = index * 3 + 2 - numWildtype;
-		} else {
-			DBG_FAILIF(true, ValueError, "The MaPenetrance only supports haploid and diploid populations.");
 		}
+	} else {
+		DBG_FAILIF(true, ValueError, "The MaPenetrance only supports haploid and diploid populations.");
 	}
 	return m_penetrance[index];
 }
@@ -345,13 +368,36 @@ double MlPenetrance::penet(Population * pop, RawIndIterator ind) const
 }
 
 
+void PyPenetrance::resolveFields(const GenoStruTrait & trait) const
+{
+	if (m_fieldStruIdx == trait.genoStruIdx())
+		return;
+	// information field arguments are translated into indexes whenever a new
+	// genotypic structure is seen, saving a name lookup per individual
+	m_fieldIdx.assign(m_func.numArgs(), 0);
+	for (size_t i = 0; i < m_func.numArgs(); ++i) {
+		const string & arg = m_func.arg(i);
+		if (arg == "ind" || arg == "geno" || arg == "mut" || arg == "gen" || arg == "pop")
+			continue;
+		DBG_FAILIF(!trait.hasInfoField(arg), ValueError,
+			"Only parameters 'ind', 'geno', 'gen', 'pop' and names of information fields are "
+			"acceptable in function " + m_func.name());
+		m_fieldIdx[i] = trait.infoIdx(arg);
+	}
+	m_fieldStruIdx = trait.genoStruIdx();
+}
+
+
 // the same as PyPenetrance
 double PyPenetrance::penet(Population * pop, RawIndIterator ind) const
 {
+	GILGuard gil;
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
 
+	resolveFields(*ind);
+
 	for (size_t i = 0; i < m_func.numArgs(); ++i) {
 		const string & arg = m_func.arg(i);
 		if (arg == "ind")
@@ -366,12 +412,8 @@ double PyPenetrance::penet(Population * pop, RawIndIterator ind) const
 		} else if (arg == "pop") {
 			DBG_FAILIF(pop == NULL, ValueError, "No valid population reference is passed.");
 			PyTuple_SET_ITEM(args, i, pyPopObj(static_cast<void *>(pop)));
-		} else {
-			DBG_FAILIF(!ind->hasInfoField(arg), ValueError,
-				"Only parameters 'ind', 'geno', 'gen', 'pop' and names of information fields are "
-				"acceptable in function " + m_func.name());
-			PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(ind->info(arg)));
-		}
+		} else
+			PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(ind->info(m_fieldIdx[i])));
 	}
 
 	double penetrance = m_func(PyObj_As_Double, args);
@@ -537,6 +579,7 @@ double PyMlPenetrance::penet(Population * /* pop */, RawIndIterator ind) const
 
 double PyMlPenetrance::getPenetranceValue(const LocGenotype & geno) const
 {
+	GILGuard gil;
 	LocGenotype tmp(geno);
 
 	if (geno.second.size() == 2 && TO_ALLELE(geno.second[0]) > TO_ALLELE(geno.second[1])) {
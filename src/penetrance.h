@@ -126,6 +126,14 @@ public:
 	virtual bool applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
 		Individual * dad = NULL, Individual * mom = NULL) const;
 
+	/// CPPONLY a penetrance operator that assigns affection status to the
+	/// present generation only can join a fused per-individual sweep,
+	/// because applyDuringMating is the per-individual form of apply()
+	virtual bool fusable() const
+	{
+		return m_ancGens.unspecified();
+	}
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -405,7 +413,7 @@ public:
 		const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		BasePenetrance(ancGens, begin, end, step, at, reps, subPops, infoFields),
-		m_func(func), m_loci(loci)
+		m_func(func), m_loci(loci), m_fieldIdx(), m_fieldStruIdx(MaxTraitIndex)
 	{
 		DBG_ASSERT(m_func.isValid(), ValueError, "Passed variable is not a callable python function.");
 	};
@@ -439,11 +447,20 @@ public:
 
 
 private:
+	/// CPPONLY resolve information field arguments of m_func for a genotypic structure
+	void resolveFields(const GenoStruTrait & trait) const;
+
 	/// user supplied python function
 	const pyFunc m_func;
 
 	/// susceptibility loci
 	const lociList m_loci;
+
+	/// indexes of information field arguments, valid for m_fieldStruIdx
+	mutable vectoru m_fieldIdx;
+
+	/// genotypic structure for which m_fieldIdx was resolved
+	mutable TraitIndexType m_fieldStruIdx;
 };
 
 
@@ -0,0 +1,363 @@
+#!/usr/bin/env python
+
+#
+# $File: perf.py $
+#
+# This file is part of simuPOP, a forward-time population genetics
+# simulation environment. Please visit https://github.com/BoPeng/simuPOP
+# for details.
+#
+# Copyright (C) 2004 - 2009 Bo Peng (Bo.Peng@bcm.edu)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+
+"""
+This module provides a small set of canonical end-to-end simulation
+scenarios and a command line driver that times them, so that builds,
+compilers and modules can be compared with the same workloads. Run
+
+    python -m simuPOP.perf
+
+to execute every scenario for every allele module, or pass ``--scenarios``
+and ``--modules`` to restrict the matrix. Each (scenario, module)
+combination is executed in its own subprocess, because an allele module
+can only be selected before ``simuPOP`` is imported; the subprocess
+reports the number of evolved generations, wall time, generations per
+second and its peak resident set size. The canonical scenario sizes
+(for example one million individuals at ten thousand loci for random
+mating) are meant for dedicated benchmark machines; use ``--scale`` to
+shrink them proportionally for a quick smoke test.
+
+The driver doubles as a performance regression gate. Running
+
+    python -m simuPOP.perf --ci test/perf_baselines.json
+
+(also available as ``make perf-ci``) executes the matrix at the scale
+recorded in the baseline file and fails when generations per second drop,
+or peak RSS grows, by more than the recorded budget (5% by default)
+relative to the baselines committed for the benchmark machine. Each cell
+is then run a second time with the ``DBG_PROFILE`` timing surface turned
+on, so that a regression is attributed to mating, statistics,
+serialization or the remaining operators instead of only being reported
+as a slower total; attribution requires a non-optimized build, where the
+evolve loop records per-operator timings in the ``opTime`` variable.
+Baselines are machine specific: record them once per benchmark machine
+with ``make perf-baseline`` (or ``--ci ... --record``) and commit the
+resulting file alongside the code it describes.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import time
+
+__all__ = [
+    'SCENARIOS',
+    'runScenario',
+]
+
+# short module names used on the command line, and the alleleType that
+# selects each of them through simuOpt.setOptions.
+MODULES = {
+    'std': 'short',
+    'ba': 'binary',
+    'la': 'long',
+    'mu': 'mutant',
+    'lin': 'lineage',
+}
+
+
+def _wfRandomMating(scale, gens):
+    '''Wright-Fisher random mating of one million individuals at ten
+    thousand loci on ten chromosomes.'''
+    import simuPOP as sim
+    size = max(int(1000000 * scale), 100)
+    loci = max(int(10000 * scale) // 10, 1)
+    pop = sim.Population(size=size, loci=[loci] * 10)
+    pop.evolve(
+        initOps=[
+            sim.InitSex(),
+            sim.InitGenotype(freq=[0.8, 0.2]),
+        ],
+        matingScheme=sim.RandomMating(),
+        gen=gens,
+    )
+    return pop
+
+
+def _steppingStone(scale, gens):
+    '''one hundred demes of ten thousand individuals in a circular
+    stepping-stone arrangement, with recombination.'''
+    import simuPOP as sim
+    from simuPOP.utils import migrSteppingStoneRates
+    demes = 100
+    size = max(int(10000 * scale), 50)
+    loci = max(int(1000 * scale), 10)
+    pop = sim.Population(size=[size] * demes, loci=loci)
+    pop.evolve(
+        initOps=[
+            sim.InitSex(),
+            sim.InitGenotype(freq=[0.5, 0.5]),
+        ],
+        preOps=sim.Migrator(rate=migrSteppingStoneRates(0.01, demes, circular=True)),
+        matingScheme=sim.RandomMating(ops=sim.Recombinator(rates=0.01)),
+        gen=gens,
+    )
+    return pop
+
+
+def _infiniteSites(scale, gens):
+    '''low-rate mutation over one million mostly wildtype sites, which
+    exercises the sparse storage of the mutant module.'''
+    import simuPOP as sim
+    size = max(int(10000 * scale), 100)
+    loci = max(int(1000000 * scale), 1000)
+    pop = sim.Population(size=size, loci=loci)
+    pop.evolve(
+        initOps=sim.InitSex(),
+        preOps=sim.SNPMutator(u=1e-7),
+        matingScheme=sim.RandomMating(),
+        gen=gens,
+    )
+    return pop
+
+
+# name -> (function, default number of generations, modules that can run it)
+SCENARIOS = {
+    'randomMating': (_wfRandomMating, 10, ['std', 'ba', 'la', 'mu', 'lin']),
+    'steppingStone': (_steppingStone, 10, ['std', 'ba', 'la', 'mu', 'lin']),
+    'infiniteSites': (_infiniteSites, 10, ['mu']),
+}
+
+
+def _peakRSS():
+    '''peak resident set size of this process, in bytes'''
+    import resource
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in bytes on macOS and in kilobytes elsewhere
+    if sys.platform != 'darwin':
+        rss *= 1024
+    return rss
+
+
+def _phaseOf(key):
+    '''map one key of the opTime timing dictionary, which is an operator
+    description or "mating scheme", onto a coarse subsystem'''
+    if key == 'mating scheme':
+        return 'mating'
+    if key.startswith('<simuPOP.Stat>'):
+        return 'stats'
+    if key.startswith('<simuPOP.SavePopulation>') or \
+            key.startswith('<simuPOP.ExportGenotype>'):
+        return 'serialization'
+    return 'operators'
+
+
+def _phaseTimes(opTime):
+    '''aggregate an opTime dictionary into seconds per subsystem'''
+    phases = {}
+    for key, secs in (opTime or {}).items():
+        phase = _phaseOf(key)
+        phases[phase] = phases.get(phase, 0.) + secs
+    return phases
+
+
+def runScenario(scenario, scale=1., gens=None, profile=False):
+    '''Run scenario ``scenario`` in the current process, with the allele
+    module that is already imported, and return a ``(gens, seconds,
+    peakRSS, phases)`` tuple. With ``profile`` set, the DBG_PROFILE debug
+    code is turned on first and ``phases`` maps subsystem names (mating,
+    stats, serialization, operators) to the seconds the last generation
+    spent in them, harvested from the opTime variable; it is empty in
+    optimized builds, where opTime is not recorded. This is also the
+    entry point of the subprocesses spawned by the command line driver.'''
+    func, defGens, _ = SCENARIOS[scenario]
+    if gens is None:
+        gens = defGens
+    if profile:
+        import simuPOP as sim
+        sim.turnOnDebug('DBG_PROFILE')
+    start = time.time()
+    pop = func(scale, gens)
+    elapsed = time.time() - start
+    phases = _phaseTimes(pop.vars().get('opTime', {})) if profile else {}
+    return gens, elapsed, _peakRSS(), phases
+
+
+def _childMain(scenario, scale, gens, profile=False):
+    '''run one scenario and print a machine-readable result line,
+    followed by a line with the per-phase timings when profiling'''
+    evolved, elapsed, rss, phases = runScenario(scenario, scale, gens, profile)
+    sys.stdout.write('%d %.6f %d\n' % (evolved, elapsed, rss))
+    if profile:
+        sys.stdout.write(json.dumps(phases) + '\n')
+
+
+def _runInSubprocess(scenario, module, optimized, scale, gens, profile=False):
+    '''execute one (scenario, module) cell of the benchmark matrix in a
+    fresh interpreter, where the allele module can still be chosen, and
+    return its parsed result and phase timings, or an error message.'''
+    code = (
+        'import simuOpt\n'
+        'simuOpt.setOptions(alleleType=%r, optimized=%r, quiet=True)\n'
+        'from simuPOP import perf\n'
+        "perf._childMain(%r, %r, %r, %r)\n"
+        % (MODULES[module], optimized, scenario, scale, gens, profile)
+    )
+    proc = subprocess.run([sys.executable, '-c', code],
+        stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    if proc.returncode != 0:
+        err = proc.stderr.decode(errors='replace').strip().split('\n')
+        return None, None, err[-1] if err else 'unknown error'
+    lines = proc.stdout.decode().splitlines()
+    phases = json.loads(lines[1]) if profile and len(lines) > 1 else {}
+    return lines[0].split(), phases, None
+
+
+def _reportRegression(scenario, module, reasons, phases, base):
+    '''print one regressed cell, attributing the slowdown to the
+    subsystem whose share of the generation grew the most'''
+    print('%-15s %-8s REGRESSED: %s' % (scenario, module, '; '.join(reasons)))
+    basePhases = base.get('phases', {})
+    if not phases:
+        print('%24s no per-phase attribution (optimized build?)' % '')
+        return
+    growth = []
+    for phase in sorted(set(phases) | set(basePhases)):
+        now, was = phases.get(phase, 0.), basePhases.get(phase, 0.)
+        growth.append((now - was, phase, was, now))
+        print('%24s %-14s %8.4fs -> %8.4fs' % ('', phase, was, now))
+    growth.sort(reverse=True)
+    if growth and growth[0][0] > 0:
+        print('%24s largest growth: %s (+%.4fs per generation)' %
+            ('', growth[0][1], growth[0][0]))
+
+
+def _runCI(args):
+    '''run the regression gate: execute the scenario matrix at the scale
+    recorded in the baseline file, compare each cell against its recorded
+    budget and return a non-zero exit code on any regression. A second,
+    profiled pass per cell supplies the per-phase attribution.'''
+    with open(args.ci) as f:
+        baselines = json.load(f)
+    scale = baselines.get('scale', 0.01)
+    gens = baselines.get('gens', 5)
+    budget = baselines.get('budget', 5.0)
+    cells = baselines.setdefault('cells', {})
+    failed = False
+    print('%-15s %-8s %12s %10s   (budget %.1f%%, scale %g, %d gens)' %
+        ('scenario', 'module', 'gens/sec', 'RSS(MB)', budget, scale, gens))
+    for scenario in sorted(SCENARIOS):
+        for module in sorted(MODULES):
+            if module not in SCENARIOS[scenario][2]:
+                continue
+            # the timed pass runs without profiling so that the timing
+            # surface does not perturb the numbers under comparison
+            result, _, err = _runInSubprocess(scenario, module,
+                args.optimized, scale, gens)
+            if err is None:
+                _, phases, err = _runInSubprocess(scenario, module,
+                    args.optimized, scale, gens, profile=True)
+            if err is not None:
+                print('%-15s %-8s failed: %s' % (scenario, module, err))
+                failed = True
+                continue
+            evolved, elapsed, rss = int(result[0]), float(result[1]), int(result[2])
+            gensPerSec = evolved / elapsed if elapsed > 0 else float('inf')
+            key = '%s/%s' % (scenario, module)
+            if args.record:
+                cells[key] = {
+                    'gensPerSec': gensPerSec,
+                    'peakRSS': rss,
+                    'phases': phases,
+                }
+                print('%-15s %-8s %12.3f %10.1f   recorded' %
+                    (scenario, module, gensPerSec, rss / (1024. * 1024.)))
+                continue
+            base = cells.get(key)
+            if base is None:
+                print('%-15s %-8s %12.3f %10.1f   no baseline, record one '
+                    'with make perf-baseline' %
+                    (scenario, module, gensPerSec, rss / (1024. * 1024.)))
+                failed = True
+                continue
+            reasons = []
+            if gensPerSec < base['gensPerSec'] * (1. - budget / 100.):
+                reasons.append('%.3f gens/sec, baseline %.3f' %
+                    (gensPerSec, base['gensPerSec']))
+            if rss > base['peakRSS'] * (1. + budget / 100.):
+                reasons.append('%.1f MB peak RSS, baseline %.1f' %
+                    (rss / (1024. * 1024.), base['peakRSS'] / (1024. * 1024.)))
+            if reasons:
+                _reportRegression(scenario, module, reasons, phases, base)
+                failed = True
+            else:
+                print('%-15s %-8s %12.3f %10.1f   ok' %
+                    (scenario, module, gensPerSec, rss / (1024. * 1024.)))
+    if args.record:
+        with open(args.ci, 'w') as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print('baselines written to %s' % args.ci)
+    return 1 if failed else 0
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog='python -m simuPOP.perf',
+        description='run canonical simuPOP benchmark scenarios')
+    parser.add_argument('--scenarios', nargs='+', default=sorted(SCENARIOS),
+        choices=sorted(SCENARIOS), help='scenarios to run')
+    parser.add_argument('--modules', nargs='+', default=sorted(MODULES),
+        choices=sorted(MODULES), help='allele modules to benchmark')
+    parser.add_argument('--optimized', action='store_true',
+        help='benchmark the optimized (*op) variants of the modules')
+    parser.add_argument('--scale', type=float, default=1.,
+        help='scale population sizes and numbers of loci of all scenarios')
+    parser.add_argument('--gens', type=int, default=None,
+        help='override the number of generations of all scenarios')
+    parser.add_argument('--ci', metavar='BASELINES',
+        help='compare against the given baseline file and fail on regression')
+    parser.add_argument('--record', action='store_true',
+        help='with --ci, record the measurements of this run as baselines')
+    args = parser.parse_args(argv)
+    if args.ci is not None:
+        return _runCI(args)
+    #
+    print('%-15s %-8s %-10s %6s %10s %12s %10s' %
+        ('scenario', 'module', 'optimized', 'gens', 'time(s)', 'gens/sec', 'RSS(MB)'))
+    failed = False
+    for scenario in args.scenarios:
+        for module in args.modules:
+            if module not in SCENARIOS[scenario][2]:
+                continue
+            result, _, err = _runInSubprocess(scenario, module, args.optimized,
+                args.scale, args.gens)
+            if err is not None:
+                print('%-15s %-8s %-10s failed: %s' %
+                    (scenario, module, args.optimized, err))
+                failed = True
+                continue
+            evolved, elapsed, rss = int(result[0]), float(result[1]), int(result[2])
+            print('%-15s %-8s %-10s %6d %10.2f %12.3f %10.1f' %
+                (scenario, module, args.optimized, evolved, elapsed,
+                 evolved / elapsed if elapsed > 0 else float('inf'),
+                 rss / (1024. * 1024.)))
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -29,6 +29,16 @@
 // for file compression
 #include "boost_pch.hpp"
 
+#include <boost/iostreams/device/array.hpp>
+
+// for memory-mapped loading of binary snapshots
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #if PY_VERSION_HEX >= 0x03000000
 #  define PyInt_FromLong(x) PyLong_FromLong(x)
 #endif
@@ -38,6 +48,60 @@ using std::max_element;
 
 namespace simuPOP {
 
+// Large genotype arrays on 4KB pages cause measurable TLB pressure when
+// mating accesses parents at random, so freshly allocated blocks are
+// advised to the kernel for 2MB transparent huge page backing. The advice
+// is best effort: where huge pages are unavailable it is simply ignored.
+#ifdef MUTANTALLELE
+void adviseHugePages(vectorm & /* geno */)
+{
+	// the compressed mutant storage allocates per node and has no large
+	// contiguous block that huge pages could back
+}
+
+
+#elif defined(BINARYALLELE)
+void adviseHugePages(vectora & /* geno */)
+{
+	// the bit-packed binary representation is already much smaller and
+	// the standard library does not expose its underlying storage
+}
+
+
+#else
+void adviseHugePages(vectora & geno)
+{
+#  if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+	// only blocks spanning several huge pages are worth the system call
+	const size_t hugePageSize = 2 * 1024 * 1024;
+	size_t bytes = geno.size() * sizeof(Allele);
+
+	if (bytes < 4 * hugePageSize)
+		return;
+	// madvise requires a page-aligned start address
+	uintptr_t beg = reinterpret_cast<uintptr_t>(&geno[0]);
+	uintptr_t aligned = (beg + 4095) & ~static_cast<uintptr_t>(4095);
+	madvise(reinterpret_cast<void *>(aligned), bytes - (aligned - beg), MADV_HUGEPAGE);
+#  else
+	(void)geno;
+#  endif
+}
+
+
+#endif
+
+// 64-bit FNV-1a, enough to compare replicate genotypes for deduplication
+// and convergence checks without pulling in a cryptographic dependency
+inline uint64_t fnv1aAppend(uint64_t h, const unsigned char * p, size_t n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		h ^= p[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+
 Population::Population(const uintList & size,
 	float ploidy,
 	const uintList & loci,
@@ -65,10 +129,18 @@ Population::Population(const uintList & size,
 	m_ancestralGens(ancGen),
 	m_vars(NULL, true),
 	m_ancestralPops(0),
+	m_spillFile(),
+	m_spillGens(0),
 	m_curAncestralGen(0),
 	m_indOrdered(true),
 	m_gen(0),
-	m_rep(0)
+	m_rep(0),
+	m_genoModCount(0),
+	m_blobMode(false),
+	m_alleleCntStamp(0),
+	m_indModStamp(g_indGenoModCount),
+	m_modsScoped(true),
+	m_memPeak(0)
 {
 	DBG_DO(DBG_POPULATION, cerr << "Constructor of population is called\n");
 
@@ -124,10 +196,18 @@ Population::Population(const Population & rhs) :
 	m_inds(0),
 	m_ancestralGens(rhs.m_ancestralGens),
 	m_vars(rhs.m_vars),                                                                     // variables will be copied
+	m_spillFile(rhs.m_spillFile),
+	m_spillGens(rhs.m_spillGens),
 	m_curAncestralGen(rhs.m_curAncestralGen),
 	m_indOrdered(true),
 	m_gen(rhs.m_gen),
-	m_rep(rhs.m_rep)
+	m_rep(rhs.m_rep),
+	m_genoModCount(0),
+	m_blobMode(false),
+	m_alleleCntStamp(0),
+	m_indModStamp(g_indGenoModCount),
+	m_modsScoped(true),
+	m_memPeak(0)
 {
 	DBG_DO(DBG_POPULATION,
 		cerr << "Copy constructor of population is called" << endl);
@@ -135,6 +215,7 @@ Population::Population(const Population & rhs) :
 	try {
 		m_inds.resize(rhs.m_popSize);
 		m_genotype.resize(m_popSize * genoSize());
+		adviseHugePages(m_genotype);
 		LINEAGE_EXPR(m_lineage.resize(m_popSize * genoSize()));
 		// have 0 length for mpi/non-head node
 		m_info.resize(rhs.m_popSize * infoSize());
@@ -217,6 +298,8 @@ Population::Population(const Population & rhs) :
 
 void Population::popData::swap(Population & pop)
 {
+	DBG_ASSERT(!m_spilled, SystemError,
+		"A spilled ancestral record must be read back before it is used");
 #ifdef MUTANTALLELE
 	size_t genoSize = 0;
 	if (m_inds.size() != 0)
@@ -230,6 +313,8 @@ void Population::popData::swap(Population & pop)
 	pop.m_info.swap(m_info);
 	pop.m_inds.swap(m_inds);
 	std::swap(pop.m_indOrdered, m_indOrdered);
+	// ancestral records keep no per-subpopulation ordering information
+	pop.m_unorderedSubPops.clear();
 #ifdef MUTANTALLELE
 	// vectorm must be setGenoPtr after swap
 	GenoIterator ptr = pop.m_genotype.begin();
@@ -242,12 +327,40 @@ void Population::popData::swap(Population & pop)
 }
 
 
+void Population::popData::swap(popData & rhs)
+{
+	m_subPopSize.swap(rhs.m_subPopSize);
+	m_subPopNames.swap(rhs.m_subPopNames);
+	m_genotype.swap(rhs.m_genotype);
+	LINEAGE_EXPR(m_lineage.swap(rhs.m_lineage));
+	m_info.swap(rhs.m_info);
+	m_inds.swap(rhs.m_inds);
+	std::swap(m_indOrdered, rhs.m_indOrdered);
+	std::swap(m_spilled, rhs.m_spilled);
+	std::swap(m_spillOffset, rhs.m_spillOffset);
+	std::swap(m_spillSize, rhs.m_spillSize);
+	// no genotype pointer fixup here: in the mutant module the individuals
+	// of both records hold stale pointers after this swap, but every caller
+	// follows up with swap(Population &), which re-establishes them, or
+	// discards the record without touching its genotypes.
+}
+
+
 Population * Population::clone() const
 {
 	return new Population(*this);
 }
 
 
+Population & Population::release()
+{
+	Population * pop = new Population();
+
+	pop->swap(*this);
+	return *pop;
+}
+
+
 size_t Population::subPopByName(const string & name) const
 {
 	vectorstr::const_iterator it = find(m_subPopNames.begin(), m_subPopNames.end(), name);
@@ -315,6 +428,8 @@ void Population::setVirtualSplitter(BaseVspSplitter * vsp)
 		delete m_vspSplitter;
 
 	m_vspSplitter = vsp ? vsp->clone() : NULL;
+	// caches that depend on virtual subpopulation membership are invalidated
+	markGenoModified();
 }
 
 
@@ -326,6 +441,37 @@ size_t Population::numVirtualSubPop() const
 }
 
 
+const subPopList::vectorvsp & Population::allSubPops(bool expandVSP) const
+{
+	size_t numSP = numSubPop();
+	size_t numVSP = expandVSP ? numVirtualSubPop() : 0;
+
+	if (numVSP == 0) {
+		// the cached list is [0, 1, ..., numSubPop() - 1], so a size match
+		// guarantees that the content is still valid
+		if (m_allSubPopCache.size() != numSP) {
+			m_allSubPopCache.clear();
+			m_allSubPopCache.reserve(numSP);
+			for (size_t sp = 0; sp < numSP; ++sp)
+				m_allSubPopCache.push_back(vspID(sp));
+		}
+		return m_allSubPopCache;
+	}
+	// the grid of numSP x numVSP IDs is identified by its size and its last
+	// element, which together determine both factors
+	if (m_allVSPCache.size() != numSP * numVSP ||
+	    m_allVSPCache.back().subPop() != numSP - 1 ||
+	    m_allVSPCache.back().virtualSubPop() != numVSP - 1) {
+		m_allVSPCache.clear();
+		m_allVSPCache.reserve(numSP * numVSP);
+		for (size_t sp = 0; sp < numSP; ++sp)
+			for (size_t vsp = 0; vsp < numVSP; ++vsp)
+				m_allVSPCache.push_back(vspID(sp, vsp));
+	}
+	return m_allVSPCache;
+}
+
+
 void Population::activateVirtualSubPop(vspID subPop) const
 {
 	CHECKRANGESUBPOP(subPop.subPop());
@@ -347,6 +493,38 @@ void Population::deactivateVirtualSubPop(size_t subPop) const
 }
 
 
+size_t Population::indRuns(size_t subPop, vectoru & runs) const
+{
+	CHECKRANGESUBPOP(subPop);
+	runs.clear();
+	const size_t spBegin = m_subPopIndex[subPop];
+	const size_t spEnd = m_subPopIndex[subPop + 1];
+	if (!hasActivatedVirtualSubPop(subPop)) {
+		if (spEnd > spBegin) {
+			runs.push_back(spBegin);
+			runs.push_back(spEnd);
+		}
+		return spEnd - spBegin;
+	}
+	size_t count = 0;
+	size_t i = spBegin;
+	while (i != spEnd) {
+		if (!m_inds[i].visible()) {
+			++i;
+			continue;
+		}
+		size_t r = i + 1;
+		while (r != spEnd && m_inds[r].visible())
+			++r;
+		runs.push_back(i);
+		runs.push_back(r);
+		count += r - i;
+		i = r;
+	}
+	return count;
+}
+
+
 int Population::__cmp__(const Population & rhs) const
 {
 	if (genoStruIdx() != rhs.genoStruIdx()) {
@@ -406,8 +584,11 @@ Individual & Population::indByID(double fid, const uintList & ancGens, const str
 		// search in current, not necessarily the present generation
 		if (gen == m_curAncestralGen)
 			inds = &m_inds;
-		else
-			inds = &m_ancestralPops[gen == 0 ? m_curAncestralGen - 1 : gen - 1].m_inds;
+		else {
+			ssize_t recIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
+			fetchAncestralGen(recIdx + 1);
+			inds = &m_ancestralPops[recIdx].m_inds;
+		}
 		// first try our luck
 		size_t startID = (*inds)[0].intInfo(idx);
 		if (idx >= startID && startID + (*inds).size() > id) {
@@ -472,6 +653,7 @@ Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp)
 		if (gen == m_curAncestralGen)
 			return m_inds[idx];
 		ssize_t genIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
+		fetchAncestralGen(genIdx + 1);
 		DBG_FAILIF(idx > m_ancestralPops[genIdx].m_inds.size(),
 			IndexError, "individual index out of range");
 		return m_ancestralPops[genIdx].m_inds[idx];
@@ -480,6 +662,7 @@ Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp)
 		if (gen == m_curAncestralGen)
 			return m_inds[idx + subPopBegin(subPop)];
 		ssize_t genIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
+		fetchAncestralGen(genIdx + 1);
 		DBG_FAILIF(static_cast<size_t>(subPop) > m_ancestralPops[genIdx].m_subPopSize.size(),
 			IndexError, "subpopulation index out of range");
 		DBG_FAILIF(idx > m_ancestralPops[genIdx].m_subPopSize[subPop],
@@ -509,6 +692,7 @@ const Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp) con
 		if (gen == m_curAncestralGen)
 			return m_inds[idx];
 		ssize_t genIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
+		fetchAncestralGen(genIdx + 1);
 		DBG_FAILIF(idx > m_ancestralPops[genIdx].m_inds.size(),
 			IndexError, "individual index out of range");
 		return m_ancestralPops[genIdx].m_inds[idx];
@@ -517,6 +701,7 @@ const Individual & Population::ancestor(double fidx, ssize_t gen, vspID vsp) con
 		if (gen == m_curAncestralGen)
 			return m_inds[idx + subPopBegin(subPop)];
 		ssize_t genIdx = gen == 0 ? m_curAncestralGen - 1 : gen - 1;
+		fetchAncestralGen(genIdx + 1);
 		DBG_FAILIF(static_cast<size_t>(subPop) > m_ancestralPops[genIdx].m_subPopSize.size(),
 			IndexError, "subpopulation index out of range");
 		DBG_FAILIF(idx > m_ancestralPops[genIdx].m_subPopSize[subPop],
@@ -661,6 +846,7 @@ IndLineageIterator Population::lineageIterator(size_t locus, size_t subPop)
 
 PyObject * Population::lineage(vspID subPopID)
 {
+	GILGuard gil;
 #ifdef LINEAGE
 	DBG_WARNIF(true, "The returned object of function Population.lineage() is a special "
 		             "carray_lineage object that reflects the underlying lineage of a "
@@ -710,6 +896,9 @@ PyObject * Population::genotype(vspID subPopID)
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
 	syncIndPointers();
+	// the returned array is writable and writes through it cannot be
+	// observed, so the export itself invalidates cached statistics
+	markGenoModified();
 	if (!vsp.valid()) {
 		// directly expose values. Do not copy data over.
 		return Allele_Vec_As_NumArray(m_genotype.begin(), m_genotype.end());
@@ -723,6 +912,162 @@ PyObject * Population::genotype(vspID subPopID)
 }
 
 
+#if PY_VERSION_HEX >= 0x03030000
+
+// used as the base address of zero-length views, for which the storage
+// vectors may not provide a dereferenceable pointer
+static char g_emptyPlane[1];
+
+#  ifdef MUTANTALLELE
+/// CPPONLY write stored mutants of a vectorm range into a dense byte buffer
+/// that has been zero-filled beforehand
+struct densePlaneFiller
+{
+	unsigned char * dst;
+	size_t base;
+	void zeroRun(size_t, size_t) const {}
+	void mutant(size_t index, Allele value) const
+	{
+		dst[index - base] = ALLELE_AS_UNSINGED(value);
+	}
+};
+#  endif
+
+#endif
+
+
+PyObject * Population::genotypeView(vspID subPopID)
+{
+#if PY_VERSION_HEX >= 0x03030000
+	DBG_WARNIF(true, "The memoryview returned by Population.genotypeView() maps the "
+		             "underlying genotype storage of a population and will become invalid "
+		             "once the population changes.");
+
+	vspID vsp = subPopID.resolve(*this);
+
+	DBG_FAILIF(vsp.isVirtual(), ValueError,
+		"Function genotypeView currently does not support virtual subpopulation");
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	syncIndPointers();
+	size_t beg = 0;
+	size_t end = m_genotype.size();
+	if (vsp.valid()) {
+		size_t subPop = vsp.subPop();
+		CHECKRANGESUBPOP(subPop);
+		beg = subPopBegin(subPop) * genoSize();
+		end = subPopEnd(subPop) * genoSize();
+	}
+#  if defined(BINARYALLELE) || defined(MUTANTALLELE)
+	// neither the bit storage of the binary module nor the sparse storage
+	// of the mutant module is byte addressable, so a dense projection is
+	// materialized once and exported read-only
+	PyObject * buf = PyBytes_FromStringAndSize(NULL, end - beg);
+	if (buf == NULL)
+		return NULL;
+	unsigned char * dst = reinterpret_cast<unsigned char *>(PyBytes_AS_STRING(buf));
+#    ifdef MUTANTALLELE
+	memset(dst, 0, end - beg);
+	densePlaneFiller filler;
+	filler.dst = dst;
+	filler.base = beg;
+	m_genotype.forEachRun(beg, end, filler);
+#    else
+	for (size_t i = beg; i < end; ++i)
+		dst[i - beg] = m_genotype[i] ? 1 : 0;
+#    endif
+	PyObject * view = PyMemoryView_FromObject(buf);
+	Py_DECREF(buf);
+	return view;
+#  else
+	// the view is writable and writes through it cannot be observed, so
+	// the export itself invalidates cached statistics and digests; see
+	// the staleness note of genotypeView() in population.h
+	markGenoModified();
+	size_t len = (end - beg) * sizeof(Allele);
+	char * ptr = len == 0 ? g_emptyPlane : reinterpret_cast<char *>(&m_genotype[beg]);
+	return PyMemoryView_FromMemory(ptr, len, PyBUF_WRITE);
+#  endif
+#else
+	(void)subPopID;
+	throw SystemError("Population.genotypeView() requires Python 3.3 or later.");
+#endif
+}
+
+
+PyObject * Population::lineageView(vspID subPopID)
+{
+#ifdef LINEAGE
+#  if PY_VERSION_HEX >= 0x03030000
+	DBG_WARNIF(true, "The memoryview returned by Population.lineageView() maps the "
+		             "underlying lineage storage of a population and will become invalid "
+		             "once the population changes.");
+
+	vspID vsp = subPopID.resolve(*this);
+
+	DBG_FAILIF(vsp.isVirtual(), ValueError,
+		"Function lineageView currently does not support virtual subpopulation");
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	syncIndPointers();
+	size_t beg = 0;
+	size_t end = m_lineage.size();
+	if (vsp.valid()) {
+		size_t subPop = vsp.subPop();
+		CHECKRANGESUBPOP(subPop);
+		beg = subPopBegin(subPop) * genoSize();
+		end = subPopEnd(subPop) * genoSize();
+	}
+	size_t len = (end - beg) * sizeof(long);
+	char * ptr = len == 0 ? g_emptyPlane : reinterpret_cast<char *>(&m_lineage[beg]);
+	return PyMemoryView_FromMemory(ptr, len, PyBUF_WRITE);
+#  else
+	(void)subPopID;
+	throw SystemError("Population.lineageView() requires Python 3.3 or later.");
+#  endif
+#else
+	(void)subPopID;
+	Py_INCREF(Py_None);
+	return Py_None;
+#endif
+}
+
+
+PyObject * Population::infoView(vspID subPopID)
+{
+#if PY_VERSION_HEX >= 0x03030000
+	DBG_WARNIF(true, "The memoryview returned by Population.infoView() maps the "
+		             "underlying information fields of a population and will become invalid "
+		             "once the population changes.");
+
+	vspID vsp = subPopID.resolve(*this);
+
+	DBG_FAILIF(vsp.isVirtual(), ValueError,
+		"Function infoView currently does not support virtual subpopulation");
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	syncIndPointers();
+	size_t beg = 0;
+	size_t end = m_info.size();
+	if (vsp.valid()) {
+		size_t subPop = vsp.subPop();
+		CHECKRANGESUBPOP(subPop);
+		beg = subPopBegin(subPop) * infoSize();
+		end = subPopEnd(subPop) * infoSize();
+	}
+	size_t len = (end - beg) * sizeof(double);
+	char * ptr = len == 0 ? g_emptyPlane : reinterpret_cast<char *>(&m_info[beg]);
+	return PyMemoryView_FromMemory(ptr, len, PyBUF_WRITE);
+#else
+	(void)subPopID;
+	throw SystemError("Population.infoView() requires Python 3.3 or later.");
+#endif
+}
+
+
 pyMutantIterator Population::mutants(vspID subPopID)
 {
 	vspID vsp = subPopID.resolve(*this);
@@ -744,8 +1089,66 @@ pyMutantIterator Population::mutants(vspID subPopID)
 }
 
 
+string Population::genotypeDigest(vspID subPopID) const
+{
+	vspID vsp = subPopID.resolve(*this);
+
+	DBG_FAILIF(vsp.isVirtual(), ValueError,
+		"Function genotypeDigest currently does not support virtual subpopulation");
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	size_t key = vsp.valid() ? vsp.subPop() : InvalidValue;
+
+	statCachesCurrent();
+	std::map<size_t, uint64_t>::const_iterator cached = m_digestCache.find(key);
+	uint64_t h = 14695981039346656037ull;
+	if (cached != m_digestCache.end())
+		h = cached->second;
+	else {
+		syncIndPointers();
+		size_t beg = 0;
+		size_t end = popSize() * genoSize();
+		if (vsp.valid()) {
+			size_t subPop = vsp.subPop();
+			CHECKRANGESUBPOP(subPop);
+			beg = subPopBegin(subPop) * genoSize();
+			end = subPopEnd(subPop) * genoSize();
+		}
+#ifdef MUTANTALLELE
+		// hash stored mutants as (position relative to the slice, value)
+		// pairs so that identical sparse contents yield identical digests
+		const vectorm::storage & data = m_genotype.data();
+		vectorm::storage::const_iterator mit = data.lower_bound(beg);
+		vectorm::storage::const_iterator mit_end = data.lower_bound(end);
+		for (; mit != mit_end; ++mit) {
+			uint64_t idx = mit->first - beg;
+			Allele val = mit->second;
+			h = fnv1aAppend(h, reinterpret_cast<const unsigned char *>(&idx), sizeof(idx));
+			h = fnv1aAppend(h, reinterpret_cast<const unsigned char *>(&val), sizeof(val));
+		}
+#elif defined(BINARYALLELE)
+		// vector<bool> does not expose its storage, hash a byte per allele
+		vectora::const_iterator it = m_genotype.begin() + beg;
+		vectora::const_iterator it_end = m_genotype.begin() + end;
+		for (; it != it_end; ++it) {
+			unsigned char b = *it ? 1 : 0;
+			h = fnv1aAppend(h, &b, 1);
+		}
+#else
+		if (end > beg)
+			h = fnv1aAppend(h, reinterpret_cast<const unsigned char *>(&*(m_genotype.begin() + beg)),
+				(end - beg) * sizeof(Allele));
+#endif
+		m_digestCache[key] = h;
+	}
+	return (boost::format("%016x") % h).str();
+}
+
+
 void Population::setGenotype(const uintList & genoList, vspID subPopID)
 {
+	markGenoModified();
 	const vectoru & geno = genoList.elems();
 
 	vspID subPop = subPopID.resolve(*this);
@@ -792,19 +1195,89 @@ void Population::setGenotype(const uintList & genoList, vspID subPopID)
 }
 
 
-void Population::setLineage(const uintList & lineageList, vspID subPopID)
+// fill a contiguous range of genotypes with a single allele, using
+// whatever bulk operation the allele storage of the module supports
+static void fillGenotypeRange(GenoIterator begin, GenoIterator end, Allele allele)
 {
-#ifdef LINEAGE
-	const vectoru & lineage = lineageList.elems();
+#ifdef BINARYALLELE
+	if (allele == 0)
+		clearGenotype(begin, end - begin);
+	else
+		fillGenotype(begin, end - begin);
+#elif defined(MUTANTALLELE)
+	if (allele == 0)
+		clearGenotype(begin, end);
+	else
+		// storing a non-zero allele everywhere defeats the sparse storage,
+		// but remains a valid request
+		for (GenoIterator it = begin; it != end; ++it)
+			REF_ASSIGN_ALLELE(it, allele);
+#else
+	if (begin != end)
+		std::fill(&*begin, &*begin + (end - begin), allele);
+#endif
+}
+
+
+void Population::fillGenotype(ULONG allele, vspID subPopID, const lociList & lociList)
+{
+	DBG_FAILIF(allele > ModuleMaxAllele, ValueError,
+		(boost::format("Allele %1% exceeds the maximum allowed allele state (%2%) of this module")
+		 % allele % ModuleMaxAllele).str());
 
+	markGenoModified();
 	vspID subPop = subPopID.resolve(*this);
 
+#ifdef MUTANTALLELE
+	// clearing everything removes all stored mutants at once
+	if (!subPop.valid() && allele == 0 && lociList.allAvail()) {
+		m_genotype.clear();
+		return;
+	}
+#endif
+
 	syncIndPointers();
+	Allele a = TO_ALLELE(allele);
+	if (lociList.allAvail()) {
+		if (!subPop.valid()) {
+			fillGenotypeRange(m_genotype.begin(), m_genotype.end(), a);
+			return;
+		}
+
+		DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+			"This operation is not allowed when there is an activated virtual subpopulation");
+
+		size_t sp = subPop.subPop();
+		CHECKRANGESUBPOP(sp);
+		if (!subPop.isVirtual()) {
+			fillGenotypeRange(genoBegin(sp, true), genoEnd(sp, true), a);
+		} else {
+			activateVirtualSubPop(subPop);
+			IndIterator it = indIterator(sp);
+			for (; it.valid(); ++it)
+				fillGenotypeRange(it->genoBegin(), it->genoEnd(), a);
+			deactivateVirtualSubPop(subPop.subPop());
+		}
+		return;
+	}
+
+	// fill only the specified loci, on all homologous chromosomes
+	const vectoru & loci = lociList.elems(this);
+	size_t ply = ploidy();
+	size_t totLoci = totNumLoci();
+
+#ifndef OPTIMIZED
+	for (size_t i = 0; i < loci.size(); ++i)
+		CHECKRANGEABSLOCUS(loci[i]);
+#endif
+
 	if (!subPop.valid()) {
-		LineageIterator ptr = m_lineage.begin();
-		size_t sz = lineage.size();
-		for (size_t i = 0; i < popSize() * genoSize(); ++i)
-			*(ptr++) = static_cast<long>(lineage[i % sz]);
+		for (RawIndIterator it = rawIndBegin(); it != rawIndEnd(); ++it) {
+			GenoIterator geno = it->genoBegin();
+			for (size_t p = 0; p < ply; ++p)
+				for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
+					REF_ASSIGN_ALLELE(geno + p * totLoci + *loc, a);
+		}
 		return;
 	}
 
@@ -813,63 +1286,336 @@ void Population::setLineage(const uintList & lineageList, vspID subPopID)
 
 	size_t sp = subPop.subPop();
 	CHECKRANGESUBPOP(sp);
-
-	size_t sz = lineage.size();
 	if (!subPop.isVirtual()) {
-		LineageIterator ptr = lineageBegin(sp, true);
-		for (size_t i = 0; i < subPopSize(sp) * genoSize(); ++i)
-			*(ptr++) = static_cast<long>(lineage[i % sz]);
+		for (RawIndIterator it = rawIndBegin(sp); it != rawIndEnd(sp); ++it) {
+			GenoIterator geno = it->genoBegin();
+			for (size_t p = 0; p < ply; ++p)
+				for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
+					REF_ASSIGN_ALLELE(geno + p * totLoci + *loc, a);
+		}
 	} else {
 		activateVirtualSubPop(subPop);
 		IndIterator it = indIterator(sp);
-		size_t i = 0;
-		for (; it.valid(); ++it)
-			for (LineageIterator git = it->lineageBegin(); git != it->lineageEnd(); ++git, ++i)
-				*git = static_cast<long>(lineage[i % sz]);
+		for (; it.valid(); ++it) {
+			GenoIterator geno = it->genoBegin();
+			for (size_t p = 0; p < ply; ++p)
+				for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
+					REF_ASSIGN_ALLELE(geno + p * totLoci + *loc, a);
+		}
 		deactivateVirtualSubPop(subPop.subPop());
 	}
-#else
-	(void)lineageList;
-	(void)subPopID;
-#endif
 }
 
 
-void Population::validate(const string & msg) const
+void Population::copyGenotypeFrom(const Population & pop, const uintList & indexList)
 {
-#ifdef OPTIMIZED
-	(void)msg;  // avoid a warning message of unused parameter in optmized module
+	DBG_FAILIF(genoStruIdx() != pop.genoStruIdx(), ValueError,
+		"Genotypes can only be copied between populations with identical genotypic structure.");
+	DBG_FAILIF(hasActivatedVirtualSubPop() || pop.hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	const vectoru & indexMap = indexList.elems();
+	bool oneToOne = indexMap.empty();
+
+	DBG_FAILIF(oneToOne && popSize() != pop.popSize(), ValueError,
+		"An index map is needed to copy genotypes between populations of different sizes.");
+	DBG_FAILIF(!oneToOne && indexMap.size() != popSize(), ValueError,
+		"An index map should assign a source individual to each individual of the target population.");
+
+	markGenoModified();
+	syncIndPointers();
+	pop.syncIndPointers();
+
+	for (size_t i = 0; i < popSize(); ++i) {
+		size_t src = oneToOne ? i : indexMap[i];
+		DBG_FAILIF(src >= pop.popSize(), IndexError,
+			(boost::format("Individual index %1% out of range of 0 ~ %2%") % src % (pop.popSize() - 1)).str());
+		const Individual & srcInd = pop.individual(src);
+		Individual & ind = individual(i);
+#ifdef BINARYALLELE
+		copyGenotype(srcInd.genoBegin(), ind.genoBegin(), genoSize());
 #else
-	DBG_ASSERT(m_info.size() == m_popSize * infoSize(), SystemError,
-		msg + "Wrong information size");
-	DBG_ASSERT(m_genotype.size() == m_popSize * genoSize(), SystemError,
-		msg + "Wrong genotype size for this population");
-	ConstInfoIterator ib = m_info.begin();
-	ConstInfoIterator ie = m_info.end();
-#  ifdef MUTANTALLELE
-	// there are trouble with comprison between const and non-const
-	// genotype iterator in mutant modules...
-	m_genotype.validate();
-	GenoIterator gb = const_cast<vectorm &>(m_genotype).begin();
-	GenoIterator ge = const_cast<vectorm &>(m_genotype).end();
-#  else
-	ConstGenoIterator gb = m_genotype.begin();
-	ConstGenoIterator ge = m_genotype.end();
-#  endif
+		copyGenotype(srcInd.genoBegin(), srcInd.genoEnd(), ind.genoBegin());
+#endif
+#ifdef LINEAGE
+		copyLineage(srcInd.lineageBegin(), srcInd.lineageEnd(), ind.lineageBegin());
+#endif
+	}
+}
 
-	if (genoSize() > 0) {
-		for (ConstIndIterator it = indIterator(); it.valid(); ++it) {
-			DBG_ASSERT(it->genoPtr() >= gb && it->genoPtr() < ge, SystemError,
-				msg + "Wrong genotype pointer");
-		}
+
+bool Population::statCachesCurrent() const
+{
+	// individual-level writes (Individual.setAllele, writable genotype
+	// arrays) cannot reach the population that owns their storage and
+	// bump the module-wide counter g_indGenoModCount instead; a change
+	// of that counter dirties the whole genome of every population
+	if (m_indModStamp != g_indGenoModCount) {
+		m_indModStamp = g_indGenoModCount;
+		markGenoModified();
 	}
-	if (infoSize() > 0) {
-		for (ConstIndIterator it = indIterator(); it.valid(); ++it) {
-			DBG_ASSERT(it->infoPtr() >= ib && it->infoPtr() < ie, SystemError,
-				(boost::format("%1% Wrong information field pointer. (number of information fields: %2%)") % msg % infoSize()).str());
+	// entries computed before the last modification are stale. If every
+	// modification since the stamp was scoped to known loci, only entries
+	// at those loci are evicted and the rest of the caches stays usable.
+	if (m_alleleCntStamp != m_genoModCount) {
+		if (m_modsScoped) {
+			ALLELECNTCACHE::iterator ac = m_alleleCntCache.begin();
+			while (ac != m_alleleCntCache.end()) {
+				if (m_dirtyLoci.find(ac->first.first) != m_dirtyLoci.end())
+					m_alleleCntCache.erase(ac++);
+				else
+					++ac;
+			}
+			HETEROCNTCACHE::iterator hc = m_heteroCntCache.begin();
+			while (hc != m_heteroCntCache.end()) {
+				if (m_dirtyLoci.find(hc->first.first) != m_dirtyLoci.end())
+					m_heteroCntCache.erase(hc++);
+				else
+					++hc;
+			}
+			GENOCNTCACHE::iterator gc = m_genoCntCache.begin();
+			while (gc != m_genoCntCache.end()) {
+				if (m_dirtyLoci.find(gc->first.first) != m_dirtyLoci.end())
+					m_genoCntCache.erase(gc++);
+				else
+					++gc;
+			}
+		} else {
+			m_alleleCntCache.clear();
+			m_heteroCntCache.clear();
+			m_genoCntCache.clear();
 		}
+		// digests cover the whole genome
+		m_digestCache.clear();
+		m_dirtyLoci.clear();
+		m_modsScoped = true;
+		m_alleleCntStamp = m_genoModCount;
+		return false;
 	}
-#endif
+	return true;
+}
+
+
+const uintDict * Population::cachedAlleleCnt(size_t loc, vspID vsp, size_t & allAlleles) const
+{
+	// refresh the caches first; entries at unmodified loci remain usable
+	statCachesCurrent();
+	ALLELECNTCACHE::const_iterator it = m_alleleCntCache.find(
+		std::make_pair(loc, std::make_pair(vsp.subPop(), vsp.virtualSubPop())));
+	if (it == m_alleleCntCache.end())
+		return NULL;
+	allAlleles = it->second.second;
+	return &it->second.first;
+}
+
+
+void Population::cacheAlleleCnt(size_t loc, vspID vsp, const uintDict & cnt, size_t allAlleles) const
+{
+	statCachesCurrent();
+	m_alleleCntCache[std::make_pair(loc, std::make_pair(vsp.subPop(), vsp.virtualSubPop()))] =
+		std::make_pair(cnt, allAlleles);
+}
+
+
+bool Population::cachedHeteroCnt(size_t loc, vspID vsp, double & hetero, double & homo) const
+{
+	statCachesCurrent();
+	HETEROCNTCACHE::const_iterator it = m_heteroCntCache.find(
+		std::make_pair(loc, std::make_pair(vsp.subPop(), vsp.virtualSubPop())));
+	if (it == m_heteroCntCache.end())
+		return false;
+	hetero = it->second.first;
+	homo = it->second.second;
+	return true;
+}
+
+
+void Population::cacheHeteroCnt(size_t loc, vspID vsp, double hetero, double homo) const
+{
+	statCachesCurrent();
+	m_heteroCntCache[std::make_pair(loc, std::make_pair(vsp.subPop(), vsp.virtualSubPop()))] =
+		std::make_pair(hetero, homo);
+}
+
+
+const tupleDict * Population::cachedGenoCnt(size_t loc, vspID vsp, size_t & allGenotypes) const
+{
+	statCachesCurrent();
+	GENOCNTCACHE::const_iterator it = m_genoCntCache.find(
+		std::make_pair(loc, std::make_pair(vsp.subPop(), vsp.virtualSubPop())));
+	if (it == m_genoCntCache.end())
+		return NULL;
+	allGenotypes = it->second.second;
+	return &it->second.first;
+}
+
+
+void Population::cacheGenoCnt(size_t loc, vspID vsp, const tupleDict & cnt, size_t allGenotypes) const
+{
+	statCachesCurrent();
+	m_genoCntCache[std::make_pair(loc, std::make_pair(vsp.subPop(), vsp.virtualSubPop()))] =
+		std::make_pair(cnt, allGenotypes);
+}
+
+
+void Population::setLineage(const uintList & lineageList, vspID subPopID)
+{
+#ifdef LINEAGE
+	const vectoru & lineage = lineageList.elems();
+
+	vspID subPop = subPopID.resolve(*this);
+
+	syncIndPointers();
+	if (!subPop.valid()) {
+		LineageIterator ptr = m_lineage.begin();
+		size_t sz = lineage.size();
+		for (size_t i = 0; i < popSize() * genoSize(); ++i)
+			*(ptr++) = static_cast<long>(lineage[i % sz]);
+		return;
+	}
+
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	size_t sp = subPop.subPop();
+	CHECKRANGESUBPOP(sp);
+
+	size_t sz = lineage.size();
+	if (!subPop.isVirtual()) {
+		LineageIterator ptr = lineageBegin(sp, true);
+		for (size_t i = 0; i < subPopSize(sp) * genoSize(); ++i)
+			*(ptr++) = static_cast<long>(lineage[i % sz]);
+	} else {
+		activateVirtualSubPop(subPop);
+		IndIterator it = indIterator(sp);
+		size_t i = 0;
+		for (; it.valid(); ++it)
+			for (LineageIterator git = it->lineageBegin(); git != it->lineageEnd(); ++git, ++i)
+				*git = static_cast<long>(lineage[i % sz]);
+		deactivateVirtualSubPop(subPop.subPop());
+	}
+#else
+	(void)lineageList;
+	(void)subPopID;
+#endif
+}
+
+
+void Population::fillLineage(long lineage, vspID subPopID, const lociList & lociList)
+{
+#ifdef LINEAGE
+	vspID subPop = subPopID.resolve(*this);
+
+	syncIndPointers();
+	if (lociList.allAvail()) {
+		if (!subPop.valid()) {
+			std::fill(m_lineage.begin(), m_lineage.end(), lineage);
+			return;
+		}
+
+		DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+			"This operation is not allowed when there is an activated virtual subpopulation");
+
+		size_t sp = subPop.subPop();
+		CHECKRANGESUBPOP(sp);
+		if (!subPop.isVirtual()) {
+			std::fill(lineageBegin(sp, true), lineageEnd(sp, true), lineage);
+		} else {
+			activateVirtualSubPop(subPop);
+			IndIterator it = indIterator(sp);
+			for (; it.valid(); ++it)
+				std::fill(it->lineageBegin(), it->lineageEnd(), lineage);
+			deactivateVirtualSubPop(subPop.subPop());
+		}
+		return;
+	}
+
+	// fill only the specified loci, on all homologous chromosomes
+	const vectoru & loci = lociList.elems(this);
+	size_t ply = ploidy();
+	size_t totLoci = totNumLoci();
+
+#  ifndef OPTIMIZED
+	for (size_t i = 0; i < loci.size(); ++i)
+		CHECKRANGEABSLOCUS(loci[i]);
+#  endif
+
+	if (!subPop.valid()) {
+		for (RawIndIterator it = rawIndBegin(); it != rawIndEnd(); ++it) {
+			LineageIterator lin = it->lineageBegin();
+			for (size_t p = 0; p < ply; ++p)
+				for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
+					*(lin + p * totLoci + *loc) = lineage;
+		}
+		return;
+	}
+
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	size_t sp = subPop.subPop();
+	CHECKRANGESUBPOP(sp);
+	if (!subPop.isVirtual()) {
+		for (RawIndIterator it = rawIndBegin(sp); it != rawIndEnd(sp); ++it) {
+			LineageIterator lin = it->lineageBegin();
+			for (size_t p = 0; p < ply; ++p)
+				for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
+					*(lin + p * totLoci + *loc) = lineage;
+		}
+	} else {
+		activateVirtualSubPop(subPop);
+		IndIterator it = indIterator(sp);
+		for (; it.valid(); ++it) {
+			LineageIterator lin = it->lineageBegin();
+			for (size_t p = 0; p < ply; ++p)
+				for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc)
+					*(lin + p * totLoci + *loc) = lineage;
+		}
+		deactivateVirtualSubPop(subPop.subPop());
+	}
+#else
+	(void)lineage;
+	(void)subPopID;
+	(void)lociList;
+#endif
+}
+
+
+void Population::validate(const string & msg) const
+{
+#ifdef OPTIMIZED
+	(void)msg;  // avoid a warning message of unused parameter in optmized module
+#else
+	DBG_ASSERT(m_info.size() == m_popSize * infoSize(), SystemError,
+		msg + "Wrong information size");
+	DBG_ASSERT(m_genotype.size() == m_popSize * genoSize(), SystemError,
+		msg + "Wrong genotype size for this population");
+	ConstInfoIterator ib = m_info.begin();
+	ConstInfoIterator ie = m_info.end();
+#  ifdef MUTANTALLELE
+	// there are trouble with comprison between const and non-const
+	// genotype iterator in mutant modules...
+	m_genotype.validate();
+	GenoIterator gb = const_cast<vectorm &>(m_genotype).begin();
+	GenoIterator ge = const_cast<vectorm &>(m_genotype).end();
+#  else
+	ConstGenoIterator gb = m_genotype.begin();
+	ConstGenoIterator ge = m_genotype.end();
+#  endif
+
+	if (genoSize() > 0) {
+		for (ConstIndIterator it = indIterator(); it.valid(); ++it) {
+			DBG_ASSERT(it->genoPtr() >= gb && it->genoPtr() < ge, SystemError,
+				msg + "Wrong genotype pointer");
+		}
+	}
+	if (infoSize() > 0) {
+		for (ConstIndIterator it = indIterator(); it.valid(); ++it) {
+			DBG_ASSERT(it->infoPtr() >= ib && it->infoPtr() < ie, SystemError,
+				(boost::format("%1% Wrong information field pointer. (number of information fields: %2%)") % msg % infoSize()).str());
+		}
+	}
+#endif
 }
 
 
@@ -888,6 +1634,7 @@ void Population::fitSubPopStru(const vectoru & newSubPopSizes,
 			if (step != 0 && m_popSize > MaxIndexSize / step)
 				throw RuntimeError("Population size times number of loci exceed maximum index size.");
 			m_genotype.resize(m_popSize * step);
+			adviseHugePages(m_genotype);
 			LINEAGE_EXPR(m_lineage.resize(m_popSize * step));
 			m_info.resize(m_popSize * is);
 			m_inds.resize(m_popSize);
@@ -906,24 +1653,40 @@ void Population::fitSubPopStru(const vectoru & newSubPopSizes,
 #endif
 				                ).str());
 		}
-		// reset individual pointers
-		InfoIterator infoPtr = m_info.begin();
-		GenoIterator ptr = m_genotype.begin();
-#ifdef LINEAGE
-		LineageIterator lineagePtr = m_lineage.begin();
-		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += is, lineagePtr += step) {
-			m_inds[i].setLineagePtr(lineagePtr);
-#else
-		for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += is) {
+		// reset individual pointers. The loop uses the same static
+		// partitioning as indIterator(subPop, threadID) so that, on
+		// systems that place memory pages on the node of the first
+		// writing thread, individual shells end up near the threads
+		// that later process the same slice during mating and stats.
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
 #endif
-			m_inds[i].setGenoPtr(ptr);
-			m_inds[i].setInfoPtr(infoPtr);
+		for (ssize_t i = 0; i < static_cast<ssize_t>(m_popSize); ++i) {
+			m_inds[i].setGenoPtr(m_genotype.begin() + i * step);
+			LINEAGE_EXPR(m_inds[i].setLineagePtr(m_lineage.begin() + i * step));
+			m_inds[i].setInfoPtr(m_info.begin() + i * is);
 			m_inds[i].setGenoStruIdx(genoStruIdx());
 		}
 		setIndOrdered(true);
 	}
-	// help clear confusing
-	std::fill(m_info.begin(), m_info.end(), 0.);
+	// when the population size is unchanged the individual shells and their
+	// genotype and info pointers from the previous generation are reused as
+	// they are; only the information fields are reset. The reset is split
+	// into one contiguous block per thread, in thread order, so repeated
+	// writes keep information fields on the node of their worker thread.
+#ifdef _OPENMP
+	if (numThreads() > 1) {
+#  pragma omp parallel
+		{
+			size_t id = omp_get_thread_num();
+			size_t blockSize = m_info.size() / numThreads();
+			size_t blockBegin = id * blockSize;
+			size_t blockEnd = id + 1 == numThreads() ? m_info.size() : blockBegin + blockSize;
+			std::fill(m_info.begin() + blockBegin, m_info.begin() + blockEnd, 0.);
+		}
+	} else
+#endif
+	std::fill_n(m_info.begin(), m_info.size(), 0.);
 
 	if (newSubPopNames.empty() || newSubPopNames.size() == newSubPopSizes.size())
 		setSubPopStru(newSubPopSizes, newSubPopNames);
@@ -952,6 +1715,7 @@ void Population::fitGenoStru(size_t stru)
 		useAncestralGen(depth);
 		if (oldSize != newSize) {
 			m_genotype.resize(newSize * popSize());
+			adviseHugePages(m_genotype);
 			LINEAGE_EXPR(m_lineage.resize(newSize * popSize()));
 		}
 		if (oldInfoSize != newInfoSize)
@@ -977,6 +1741,7 @@ void Population::fitGenoStru(size_t stru)
 void Population::setSubPopStru(const vectoru & newSubPopSizes,
                                const vectorstr & newSubPopNames)
 {
+	markGenoModified();
 	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
@@ -997,6 +1762,9 @@ void Population::setSubPopStru(const vectoru & newSubPopSizes,
 	size_t i = 1;
 	for (m_subPopIndex[0] = 0; i <= numSubPop(); ++i)
 		m_subPopIndex[i] = m_subPopIndex[i - 1] + m_subPopSize[i - 1];
+	// renumbering invalidates subpopulation indices recorded for local
+	// restoration (the whole population will be rebuilt if it is unordered)
+	m_unorderedSubPops.clear();
 }
 
 
@@ -1125,14 +1893,16 @@ void Population::sortIndividuals(const stringList & infoList, bool reverse)
 	vectoru fields(infoFields.size());
 	for (size_t i = 0; i < infoFields.size(); ++i)
 		fields[i] = infoIdx(infoFields[i]);
-	for (size_t sp = 0; sp < numSubPop(); ++sp)
+	for (size_t sp = 0; sp < numSubPop(); ++sp) {
 		parallelSort(rawIndBegin(sp), rawIndEnd(sp), indCompare(fields, reverse));
-	setIndOrdered(false);
+		setSubPopUnordered(sp);
+	}
 }
 
 
 void Population::setSubPopByIndInfo(const string & field)
 {
+	markGenoModified();
 	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
@@ -1142,8 +1912,78 @@ void Population::setSubPopByIndInfo(const string & field)
 	// if the population is empty, return directly (#19)
 	if (rawIndBegin() == rawIndEnd())
 		return;
-	// sort individuals first
-	parallelSort(rawIndBegin(), rawIndEnd(), indCompare(info));
+	// Destinations are small subpopulation indexes, so individuals can
+	// usually be arranged by a stable two-pass bucket placement (count,
+	// then copy to final slot) which is O(N) instead of a comparison
+	// sort.  Non-integral or very large values fall back to sorting.
+	bool countable = true;
+	double maxDest = -1.;
+	ConstRawIndIterator cit = rawIndBegin();
+	ConstRawIndIterator cit_end = rawIndEnd();
+	for (; cit != cit_end; ++cit) {
+		double v = cit->info(info);
+		if (v != floor(v) || v >= 1e6) {
+			countable = false;
+			break;
+		}
+		if (v > maxDest)
+			maxDest = v;
+	}
+	if (countable) {
+		// individuals with a negative destination go first (bucket 0) so
+		// that the removal code below can discard them from the front.
+		size_t nBuckets = static_cast<size_t>(maxDest < 0 ? 0 : maxDest) + 2;
+		vector<Individual> arranged(m_popSize);
+		if (numThreads() > 1) {
+#ifdef _OPENMP
+			size_t nTh = numThreads();
+			size_t chunk = m_popSize / nTh;
+			vector<vectoru> cnt(nTh, vectoru(nBuckets, 0));
+#  pragma omp parallel
+			{
+				size_t id = omp_get_thread_num();
+				size_t beg = id * chunk;
+				size_t end = id == nTh - 1 ? m_popSize : beg + chunk;
+				for (size_t i = beg; i < end; ++i) {
+					double v = m_inds[i].info(info);
+					++cnt[id][v < 0 ? 0 : static_cast<size_t>(v) + 1];
+				}
+			}
+			// bucket-major, thread-minor prefix keeps the placement stable
+			vector<vectoru> start(nTh, vectoru(nBuckets, 0));
+			size_t acc = 0;
+			for (size_t b = 0; b < nBuckets; ++b)
+				for (size_t t = 0; t < nTh; ++t) {
+					start[t][b] = acc;
+					acc += cnt[t][b];
+				}
+#  pragma omp parallel
+			{
+				size_t id = omp_get_thread_num();
+				size_t beg = id * chunk;
+				size_t end = id == nTh - 1 ? m_popSize : beg + chunk;
+				for (size_t i = beg; i < end; ++i) {
+					double v = m_inds[i].info(info);
+					arranged[start[id][v < 0 ? 0 : static_cast<size_t>(v) + 1]++] = m_inds[i];
+				}
+			}
+#endif
+		} else {
+			vectoru start(nBuckets + 1, 0);
+			for (size_t i = 0; i < m_popSize; ++i) {
+				double v = m_inds[i].info(info);
+				++start[(v < 0 ? 0 : static_cast<size_t>(v) + 1) + 1];
+			}
+			for (size_t b = 1; b <= nBuckets; ++b)
+				start[b] += start[b - 1];
+			for (size_t i = 0; i < m_popSize; ++i) {
+				double v = m_inds[i].info(info);
+				arranged[start[v < 0 ? 0 : static_cast<size_t>(v) + 1]++] = m_inds[i];
+			}
+		}
+		m_inds.swap(arranged);
+	} else
+		parallelSort(rawIndBegin(), rawIndEnd(), indCompare(info));
 	setIndOrdered(false);
 
 	// sort individuals first
@@ -1231,6 +2071,7 @@ void Population::setSubPopByIndInfo(const string & field)
 
 vectoru Population::splitSubPop(size_t subPop, const vectorf & sizes, const vectorstr & names)
 {
+	markGenoModified();
 	if (sizes.size() <= 1)
 		return vectoru(1, subPop);
 
@@ -1275,7 +2116,23 @@ vectoru Population::splitSubPop(size_t subPop, const vectorf & sizes, const vect
 				ret[i] = sp + i;
 		}
 	}
+	// remap subpopulations recorded for local ordering restoration: pieces
+	// of the split subpopulation remain locally reordered, and indices
+	// after it are shifted by the number of added subpopulations
+	vectoru remapped;
+	remapped.reserve(m_unorderedSubPops.size() + count.size());
+	for (size_t i = 0; i < m_unorderedSubPops.size(); ++i) {
+		size_t u = m_unorderedSubPops[i];
+		if (u < subPop)
+			remapped.push_back(u);
+		else if (u == subPop)
+			for (size_t k = 0; k < count.size(); ++k)
+				remapped.push_back(subPop + k);
+		else
+			remapped.push_back(u + count.size() - 1);
+	}
 	setSubPopStru(subPopSizes, subPopNames);
+	m_unorderedSubPops.swap(remapped);
 	return ret;
 }
 
@@ -1339,7 +2196,7 @@ void Population::removeSubPops(const subPopList & subPops)
 					if (oldInd != newInd) {
 						*newInd = *oldInd;
 						copy(oldInfoPtr, oldInfoPtr + infoStep, newInfoPtr);
-						LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
+						LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
 					}
 					new_genotype.insert(new_genotype.end(), oldPtr, oldPtr + step);
 #else
@@ -1347,7 +2204,7 @@ void Population::removeSubPops(const subPopList & subPops)
 						*newInd = *oldInd;
 						copy(oldPtr, oldPtr + step, newPtr);
 						copy(oldInfoPtr, oldInfoPtr + infoStep, newInfoPtr);
-						LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
+						LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
 					}
 					newPtr += step;
 #endif
@@ -1374,7 +2231,7 @@ void Population::removeSubPops(const subPopList & subPops)
 			if (oldInfoPtr != newInfoPtr) {
 				copy(oldInd, oldInd + spSize, newInd);
 				copy(oldInfoPtr, oldInfoPtr + infoStep * spSize, newInfoPtr);
-				LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step * spSize, newLineagePtr));
+				LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step * spSize, newLineagePtr));
 			}
 			new_genotype.insert(new_genotype.end(), oldPtr, oldPtr + step * spSize);
 #else
@@ -1382,7 +2239,7 @@ void Population::removeSubPops(const subPopList & subPops)
 				copy(oldPtr, oldPtr + step * spSize, newPtr);
 				copy(oldInd, oldInd + spSize, newInd);
 				copy(oldInfoPtr, oldInfoPtr + infoStep * spSize, newInfoPtr);
-				LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step * spSize, newLineagePtr));
+				LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step * spSize, newLineagePtr));
 			}
 			newPtr += step * spSize;
 #endif
@@ -1456,7 +2313,7 @@ void Population::removeMarkedIndividuals()
 				if (oldInd != newInd) {
 					*newInd = *oldInd;
 					copy(oldInfoPtr, oldInfoPtr + infoStep, newInfoPtr);
-					LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
+					LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
 				}
 				new_genotype.insert(new_genotype.end(), oldPtr, oldPtr + step);
 #else
@@ -1464,7 +2321,7 @@ void Population::removeMarkedIndividuals()
 					*newInd = *oldInd;
 					copy(oldPtr, oldPtr + step, newPtr);
 					copy(oldInfoPtr, oldInfoPtr + infoStep, newInfoPtr);
-					LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
+					LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
 				}
 #endif
 				++newInd;
@@ -1511,6 +2368,7 @@ void Population::removeMarkedIndividuals()
 void Population::removeIndividuals(const uintList & indexList, const floatList & IDList,
                                    const string & idField, PyObject * filter)
 {
+	markGenoModified();
 	const vectoru & indexes = indexList.elems();
 	const vectorf & IDs = IDList.elems();
 
@@ -1592,8 +2450,95 @@ void Population::removeIndividuals(const uintList & indexList, const floatList &
 }
 
 
+void Population::keepIndividuals(const uintList & indexList, const floatList & IDList,
+                                 const string & idField, PyObject * filter)
+{
+	markGenoModified();
+	const vectoru & indexes = indexList.elems();
+	const vectorf & IDs = IDList.elems();
+
+	if (IDs.empty() && indexes.empty() && filter == NULL)
+		return;
+
+	DBG_FAILIF(IDs.empty() + indexes.empty() + (filter == NULL) != 2, ValueError,
+		"Please specify only one of parameters indexes, IDs and filter");
+
+	if (!indexes.empty()) {
+		// remove everyone who is not on the list
+		markIndividuals(vspID(), true);
+		for (size_t i = 0; i < indexes.size(); ++i) {
+			DBG_FAILIF(indexes[i] >= m_popSize, IndexError,
+				"individual index out of range.");
+			m_inds[indexes[i]].setMarked(false);
+		}
+		removeMarkedIndividuals();
+		return;
+	}
+	int curGen = m_curAncestralGen;
+	if (!IDs.empty()) {
+		size_t fieldIdx = infoIdx(idField);
+		// keep by ID
+		// first, build a map
+		std::map<size_t, bool > idMap;
+		for (size_t i = 0; i < IDs.size(); ++i)
+			idMap[toID(IDs[i])] = true;
+
+		for (int depth = ancestralGens(); depth >= 0; --depth) {
+			useAncestralGen(depth);
+			markIndividuals(vspID(), true);
+			RawIndIterator it = rawIndBegin();
+			RawIndIterator itEnd = rawIndEnd();
+			for (; it != itEnd; ++it) {
+				size_t id = toID(it->info(fieldIdx));
+				if (idMap.find(id) != idMap.end())
+					it->setMarked(false);
+			}
+			removeMarkedIndividuals();
+		}
+	}
+	if (filter != NULL) {
+		pyFunc func(filter);
+		PyObject * args = PyTuple_New(func.numArgs());
+		//
+		vectoru pars(func.numArgs());
+		for (size_t i = 0; i < func.numArgs(); ++i) {
+			const string & arg = func.arg(i);
+			if (arg == "ind")
+				pars[i] = InvalidValue;
+			else {
+				DBG_FAILIF(!hasInfoField(arg), ValueError,
+					"Only parameters 'ind', and names of information fields are "
+					"acceptable in the filter function");
+				pars[i] = infoIdx(arg);
+			}
+		}
+
+		for (int depth = ancestralGens(); depth >= 0; --depth) {
+			useAncestralGen(depth);
+			markIndividuals(vspID(), true);
+			RawIndIterator it = rawIndBegin();
+			RawIndIterator itEnd = rawIndEnd();
+			for (; it != itEnd; ++it) {
+				for (size_t i = 0; i < func.numArgs(); ++i) {
+					if (pars[i] == InvalidValue)
+						PyTuple_SET_ITEM(args, i, pyIndObj(static_cast<void *>(&*it)));
+					else
+						PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(it->info(pars[i])));
+				}
+				if (func(PyObj_As_Bool, args))
+					it->setMarked(false);
+			}
+			removeMarkedIndividuals();
+		}
+		Py_XDECREF(args);
+	}
+	useAncestralGen(curGen);
+}
+
+
 size_t Population::mergeSubPops(const uintList & subPops, const string & name, int toSubPop)
 {
+	markGenoModified();
 	if (!name.empty() && m_subPopNames.empty())
 		m_subPopNames.resize(numSubPop(), UnnamedSubPop);
 
@@ -1658,8 +2603,11 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 		setSubPopStru(new_size, new_names);
 		return sps[0];
 	}
-	// difficult case.
-	syncIndPointers();
+	// difficult case: the merged subpopulations are not consecutive. Only
+	// the Individual objects are reordered; genotype and information fields
+	// stay in place and each individual keeps pointing to its original
+	// storage, so the physical regrouping is deferred to syncIndPointers()
+	// if and when an operation needs ordered genotypes.
 	// find the new subpop order
 	vectoru sp_order;
 	// subpopulations before toSubPop
@@ -1676,22 +2624,8 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 	DBG_ASSERT(sp_order.size() == numSubPop(), ValueError,
 		"Incorrect resulting subpopulation number, maybe caused by duplicate entries in parameter subPops.");
 
-	size_t step = genoSize();
-	size_t infoStep = infoSize();
 	vector<Individual> new_inds;
-	vectorf new_info;
-#ifdef MUTANTALLELE
-	vectorm new_genotype;
-#else
-	vectora new_genotype;
-	new_genotype.reserve(step * popSize());
-#endif
-#ifdef LINEAGE
-	vectori new_lineage;
-	new_lineage.reserve(step * popSize());
-#endif
 	new_inds.reserve(popSize());
-	new_info.reserve(infoStep * popSize());
 
 	for (size_t sp = 0; sp < numSubPop(); ++sp) {
 		size_t src = sp_order[sp];
@@ -1699,37 +2633,14 @@ size_t Population::mergeSubPops(const uintList & subPops, const string & name, i
 			continue;
 		// do not remove.
 		new_inds.insert(new_inds.end(), rawIndBegin(src), rawIndEnd(src));
-		new_genotype.insert(new_genotype.end(), genoBegin(src, true), genoEnd(src, true));
-		LINEAGE_EXPR(new_lineage.insert(new_lineage.end(), lineageBegin(src, true), lineageEnd(src, true)));
-
-		if (infoStep > 0)
-			new_info.insert(new_info.end(),
-				m_info.begin() + subPopBegin(src) * infoStep,
-				m_info.begin() + (subPopEnd(src) - 1) * infoStep + 1);
 	}
 	//
-	DBG_ASSERT(new_inds.size() == popSize() && new_genotype.size() == popSize() * step
-		&& new_info.size() == popSize() * infoStep, SystemError,
+	DBG_ASSERT(new_inds.size() == popSize(), SystemError,
 		"Incorrect individual manipulation");
 	//
 	m_inds.swap(new_inds);
-	m_genotype.swap(new_genotype);
-	m_info.swap(new_info);
-	LINEAGE_EXPR(m_lineage.swap(new_lineage));
 	setSubPopStru(new_size, new_names);
-	//
-	InfoIterator infoPtr = m_info.begin();
-	GenoIterator ptr = m_genotype.begin();
-	for (size_t i = 0; i < m_popSize; ++i, ptr += step, infoPtr += infoStep) {
-		m_inds[i].setGenoPtr(ptr);
-		m_inds[i].setInfoPtr(infoPtr);
-	}
-#ifdef LINEAGE
-	LineageIterator lineagePtr = m_lineage.begin();
-	for (size_t i = 0; i < m_popSize; ++i, lineagePtr += step) {
-		m_inds[i].setLineagePtr(lineagePtr);
-	}
-#endif
+	setIndOrdered(false);
 	return merged_idx;
 }
 
@@ -1816,6 +2727,7 @@ void Population::addChromFrom(const Population & pop)
 
 void Population::addIndFrom(const Population & pop)
 {
+	markGenoModified();
 	DBG_FAILIF(genoStruIdx() != pop.genoStruIdx(), ValueError,
 		"Cannot add Individual from a population with different genotypic structure.");
 	DBG_FAILIF(ancestralGens() != pop.ancestralGens(), ValueError,
@@ -1872,6 +2784,8 @@ void Population::addIndFrom(const Population & pop)
 	}
 	DBG_ASSERT(m_subPopNames.empty() || m_subPopNames.size() == numSubPop(), SystemError,
 		"subpopulation names can either be empty, or be specified for all subpopulations.");
+	// arrays of all generations just grew, record the high-water mark
+	memSize();
 }
 
 
@@ -2106,6 +3020,7 @@ vectoru Population::addLoci(const uintList & chromList, const floatList & posLis
 
 void Population::resize(const uintList & sizeList, bool propagate)
 {
+	markGenoModified();
 	const vectoru & newSubPopSizes = sizeList.elems();
 
 	DBG_FAILIF(newSubPopSizes.size() != numSubPop(), ValueError,
@@ -2113,6 +3028,61 @@ void Population::resize(const uintList & sizeList, bool propagate)
 
 	size_t newPopSize = accumulate(newSubPopSizes.begin(), newSubPopSizes.end(), size_t(0));
 
+	// when only the trailing subpopulation changes size, which is the
+	// common case for single-population growth models that resize every
+	// generation, the arrays are extended (or truncated) in place: the
+	// retained genotypes are moved in bulk by the underlying vectors and
+	// only the added individuals are filled, instead of copying the whole
+	// population individual by individual.
+	bool tailOnly = true;
+	for (size_t sp = 0; sp + 1 < numSubPop(); ++sp)
+		if (newSubPopSizes[sp] != subPopSize(sp)) {
+			tailOnly = false;
+			break;
+		}
+	if (tailOnly) {
+		// individual i must own slice i of the genotype arrays before the
+		// arrays can be resized underneath them
+		syncIndPointers();
+		size_t oldPopSize = m_popSize;
+		size_t oldSpSize = subPopSize(numSubPop() - 1);
+		size_t step = genoSize();
+		size_t infoStep = infoSize();
+		m_genotype.resize(newPopSize * step);
+		adviseHugePages(m_genotype);
+		m_info.resize(newPopSize * infoStep);
+		LINEAGE_EXPR(m_lineage.resize(newPopSize * step));
+		m_inds.resize(newPopSize);
+		// resizing may move the arrays, so all pointers are re-linked
+		GenoIterator ptr = m_genotype.begin();
+		InfoIterator infoPtr = m_info.begin();
+#ifdef LINEAGE
+		LineageIterator lineagePtr = m_lineage.begin();
+#endif
+		for (size_t i = 0; i < newPopSize; ++i, ptr += step, infoPtr += infoStep) {
+			m_inds[i].setGenoStruIdx(genoStruIdx());
+			m_inds[i].setGenoPtr(ptr);
+			m_inds[i].setInfoPtr(infoPtr);
+#ifdef LINEAGE
+			m_inds[i].setLineagePtr(lineagePtr);
+			lineagePtr += step;
+#endif
+		}
+		// fill the added individuals from existing members of the
+		// subpopulation
+		if (propagate && oldSpSize > 0) {
+			size_t beg = m_subPopIndex[numSubPop() - 1];
+			for (size_t i = oldPopSize; i < newPopSize; ++i)
+				m_inds[i].copyFrom(m_inds[beg + (i - oldPopSize) % oldSpSize]);
+		}
+		m_popSize = newPopSize;
+		m_subPopSize = newSubPopSizes;
+		setIndOrdered(true);
+		for (size_t idx = 1; idx <= numSubPop(); ++idx)
+			m_subPopIndex[idx] = m_subPopIndex[idx - 1] + m_subPopSize[idx - 1];
+		return;
+	}
+
 	// prepare new Population
 	vector<Individual> newInds(newPopSize);
 	vectorf newInfo(newPopSize * infoSize());
@@ -2219,6 +3189,7 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 		//
 		new_inds.resize(sz);
 		new_genotype.resize(sz * step);
+		adviseHugePages(new_genotype);
 		new_info.resize(sz * infoStep);
 		LINEAGE_EXPR(new_lineage.resize(sz * step));
 		//
@@ -2239,7 +3210,7 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 				copy(oldInd->genoBegin(), oldInd->genoEnd(), newPtr);
 #endif
 				copy(oldInd->infoBegin(), oldInd->infoEnd(), newInfoPtr);
-				LINEAGE_EXPR(copy(oldInd->lineageBegin(), oldInd->lineageEnd(), newLineagePtr));
+				LINEAGE_EXPR(copyLineage(oldInd->lineageBegin(), oldInd->lineageEnd(), newLineagePtr));
 				++newInd;
 				newPtr += step;
 				newInfoPtr += infoStep;
@@ -2256,6 +3227,7 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 		}
 		new_inds.resize(sz);
 		new_genotype.resize(sz * step);
+		adviseHugePages(new_genotype);
 		new_info.resize(sz * infoStep);
 		LINEAGE_EXPR(new_lineage.resize(sz * step));
 		//
@@ -2284,7 +3256,7 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 				copy(oldPtr, oldPtr + step * spSize, newPtr);
 #endif
 				copy(oldInfoPtr, oldInfoPtr + infoStep * spSize, newInfoPtr);
-				LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step * spSize, newLineagePtr));
+				LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step * spSize, newLineagePtr));
 
 				oldInd += spSize;
 				oldPtr += step * spSize;
@@ -2317,7 +3289,7 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 						copy(oldPtr, oldPtr + step, newPtr);
 #endif
 						copy(oldInfoPtr, oldInfoPtr + infoStep, newInfoPtr);
-						LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
+						LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
 						++newInd;
 						newPtr += step;
 						newInfoPtr += infoStep;
@@ -2344,6 +3316,7 @@ Population & Population::extractSubPops(const subPopList & subPops, bool rearran
 	size_t sz = std::accumulate(new_size.begin(), new_size.end(), size_t(0));
 	new_inds.resize(sz);
 	new_genotype.resize(sz * step);
+	adviseHugePages(new_genotype);
 	new_info.resize(sz * infoStep);
 	LINEAGE_EXPR(new_lineage.resize(sz * step));
 	//
@@ -2423,7 +3396,7 @@ Population & Population::extractMarkedIndividuals() const
 				copy(oldPtr, oldPtr + step, newPtr);
 #endif
 				copy(oldInfoPtr, oldInfoPtr + infoStep, newInfoPtr);
-				LINEAGE_EXPR(copy(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
+				LINEAGE_EXPR(copyLineage(oldLineagePtr, oldLineagePtr + step, newLineagePtr));
 				++newInd;
 				newPtr += step;
 				newInfoPtr += infoStep;
@@ -2560,6 +3533,81 @@ Population & Population::extractIndividuals(const uintList & indexList,
 }
 
 
+// choose size distinct values in [0, n) without replacement using Floyd's
+// algorithm, which draws one random number per chosen value
+static void chooseWithoutReplacement(size_t n, size_t size, std::set<size_t> & chosen)
+{
+	chosen.clear();
+	for (size_t j = n - size; j < n; ++j) {
+		size_t t = getRNG().randInt(static_cast<unsigned long>(j + 1));
+		if (!chosen.insert(t).second)
+			chosen.insert(j);
+	}
+}
+
+
+Population & Population::randomSample(const uintList & sizeList) const
+{
+	const vectoru & sizes = sizeList.elems();
+
+	DBG_FAILIF(sizes.size() != 1 && sizes.size() != numSubPop(), ValueError,
+		"Please specify a sample size for the whole population or one for each subpopulation.");
+
+	markIndividuals(vspID(), false);
+	std::set<size_t> chosen;
+	for (size_t g = 0; g < sizes.size(); ++g) {
+		size_t beg = sizes.size() == 1 ? 0 : subPopBegin(g);
+		size_t n = (sizes.size() == 1 ? m_popSize : subPopEnd(g)) - beg;
+		chooseWithoutReplacement(n, std::min(sizes[g], n), chosen);
+		std::set<size_t>::const_iterator s = chosen.begin();
+		std::set<size_t>::const_iterator sEnd = chosen.end();
+		for (; s != sEnd; ++s)
+			m_inds[beg + *s].setMarked(true);
+	}
+	return extractMarkedIndividuals();
+}
+
+
+Population & Population::caseControlSample(const uintList & caseList,
+                                           const uintList & controlList) const
+{
+	const vectoru & cases = caseList.elems();
+	const vectoru & controls = controlList.elems();
+
+	DBG_FAILIF(cases.size() != controls.size(), ValueError,
+		"Please specify the same number of case and control sample sizes.");
+	DBG_FAILIF(cases.size() != 1 && cases.size() != numSubPop(), ValueError,
+		"Please specify numbers of cases and controls for the whole population "
+		"or one pair for each subpopulation.");
+
+	markIndividuals(vspID(), false);
+	vectoru aff;
+	vectoru unaff;
+	std::set<size_t> chosen;
+	for (size_t g = 0; g < cases.size(); ++g) {
+		size_t beg = cases.size() == 1 ? 0 : subPopBegin(g);
+		size_t end = cases.size() == 1 ? m_popSize : subPopEnd(g);
+		aff.clear();
+		unaff.clear();
+		for (size_t i = beg; i < end; ++i) {
+			if (m_inds[i].affected())
+				aff.push_back(i);
+			else
+				unaff.push_back(i);
+		}
+		chooseWithoutReplacement(aff.size(), std::min(cases[g], aff.size()), chosen);
+		std::set<size_t>::const_iterator s = chosen.begin();
+		std::set<size_t>::const_iterator sEnd = chosen.end();
+		for (; s != sEnd; ++s)
+			m_inds[aff[*s]].setMarked(true);
+		chooseWithoutReplacement(unaff.size(), std::min(controls[g], unaff.size()), chosen);
+		for (s = chosen.begin(), sEnd = chosen.end(); s != sEnd; ++s)
+			m_inds[unaff[*s]].setMarked(true);
+	}
+	return extractMarkedIndividuals();
+}
+
+
 Population & Population::extract(const lociList & extractedLoci, const stringList & infoFieldList,
                                  const subPopList & _subPops, const uintList & ancGens) const
 {
@@ -2699,8 +3747,10 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 		vectorm new_genotype;
 		// this function uses push_back to insert mutants, which does not
 		// change the size of vectorm... a resize is needed.
-		if (removeLoci)
+		if (removeLoci) {
 			new_genotype.resize(size * step);
+			adviseHugePages(new_genotype);
+		}
 #else
 		vectora new_genotype;
 		new_genotype.reserve(size * step);
@@ -2859,6 +3909,7 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 
 void Population::removeLoci(const lociList & removeList, const lociList & keepList)
 {
+	markGenoModified();
 	if (removeList.unspecified() && keepList.unspecified())
 		return;
 
@@ -3092,6 +4143,7 @@ void Population::recodeAlleles(const uintListFunc & newAlleles, const lociList &
 
 void Population::push(Population & rhs)
 {
+	markGenoModified();
 	if (rhs.genoStruIdx() != genoStruIdx()) {
 		if (m_ancestralGens > 0)
 			throw ValueError("Cannot save a population with different structure as an ancestral population to the existing population");
@@ -3104,13 +4156,27 @@ void Population::push(Population & rhs)
 	// front -1 pop, -2 pop, .... end
 	//
 	if (m_ancestralGens > 0
-	    && ancestralGens() == m_ancestralGens)
+	    && ancestralGens() == m_ancestralGens) {
+		// keep the buffers of the discarded record in the new front record:
+		// the swaps below hand them over to rhs, where the next offspring
+		// generation is built, so genotype sized arrays are recycled instead
+		// of freed and reallocated at every generation. Individuals travel
+		// together with the arrays they point into, so genotype pointers
+		// stay consistent.
+		m_ancestralPops.push_front(popData());
+		m_ancestralPops.front().swap(m_ancestralPops.back());
 		m_ancestralPops.pop_back();
+		// the recycled record is about to receive the parental arrays;
+		// drop any spill state inherited from the discarded record
+		m_ancestralPops.front().m_spilled = false;
+		m_ancestralPops.front().m_spillOffset = 0;
+		m_ancestralPops.front().m_spillSize = 0;
+	} else if (m_ancestralGens != 0)
+		// add a empty popData
+		m_ancestralPops.push_front(popData());
 
 	// save current population
 	if (m_ancestralGens != 0) {
-		// add a empty popData
-		m_ancestralPops.push_front(popData());
 		// get its reference
 		popData & pd = m_ancestralPops.front();
 		// swap with real data
@@ -3130,6 +4196,7 @@ void Population::push(Population & rhs)
 	m_info.swap(rhs.m_info);
 	m_inds.swap(rhs.m_inds);
 	std::swap(m_indOrdered, rhs.m_indOrdered);
+	m_unorderedSubPops.swap(rhs.m_unorderedSubPops);
 
 #ifdef MUTANTALLELE
 	// vectorm must be setGenoPtr after swap
@@ -3145,17 +4212,121 @@ void Population::push(Population & rhs)
 	// (with all datamember copied form rhs
 	// rhs may not be working well since m_genotype etc
 	// may be from ancestral pops
-	if (rhs.m_popSize != rhs.m_inds.size()) {
-		// keep size if pop size is OK.
-		// remove all supopulation structure of rhs
-		rhs.m_popSize = rhs.m_inds.size();
-		rhs.setSubPopStru(rhs.m_subPopSize, rhs.m_subPopNames);
-	}
+	// rhs now holds recycled or empty arrays; make sure its size and
+	// subpopulation structure describe them consistently.
+	rhs.m_popSize = rhs.m_inds.size();
+	rhs.setSubPopStru(rhs.m_subPopSize, rhs.m_subPopNames);
+	// move ancestral generations beyond the cached window to disk before
+	// the new generation starts to grow
+	spillExcessGens();
+	// record the high-water mark now that this population holds both the
+	// new generation and the full ancestral ring
+	memSize();
 	validate("Current population after push and discard:");
 	rhs.validate("Outside Population after push and discard:");
 }
 
 
+namespace {
+
+// approximate heap bytes of one generation's genotype storage
+#ifdef MUTANTALLELE
+size_t genoMemSize(const vectorm & geno)
+{
+	// payload of each stored mutant plus the per-node overhead of the
+	// ordered map (three pointers and a color field, rounded up to
+	// pointer size)
+	return geno.data().size() * (sizeof(std::pair<const size_t, Allele>) + 4 * sizeof(void *));
+}
+
+
+#elif defined(BINARYALLELE)
+size_t genoMemSize(const vectora & geno)
+{
+	return geno.capacity() / 8;
+}
+
+
+#else
+size_t genoMemSize(const vectora & geno)
+{
+	return geno.capacity() * sizeof(Allele);
+}
+
+
+#endif
+}
+
+
+size_t Population::genBytes() const
+{
+	size_t bytes = genoMemSize(m_genotype)
+	               + m_info.capacity() * sizeof(double)
+	               + m_inds.capacity() * sizeof(Individual);
+
+	LINEAGE_EXPR(bytes += m_lineage.capacity() * sizeof(long));
+	return bytes;
+}
+
+
+size_t Population::memSize() const
+{
+	size_t bytes = genBytes();
+
+	for (size_t gen = 0; gen < m_ancestralPops.size(); ++gen) {
+		const popData & pd = m_ancestralPops[gen];
+		bytes += genoMemSize(pd.m_genotype)
+		         + pd.m_info.capacity() * sizeof(double)
+		         + pd.m_inds.capacity() * sizeof(Individual);
+		LINEAGE_EXPR(bytes += pd.m_lineage.capacity() * sizeof(long));
+	}
+	if (bytes > m_memPeak)
+		m_memPeak = bytes;
+	return bytes;
+}
+
+
+PyObject * Population::memoryProfile() const
+{
+	GILGuard gil;
+	size_t genoBytes = genoMemSize(m_genotype);
+	size_t lineageBytes = 0;
+	size_t infoBytes = m_info.capacity() * sizeof(double);
+	size_t indBytes = m_inds.capacity() * sizeof(Individual);
+
+	LINEAGE_EXPR(lineageBytes = m_lineage.capacity() * sizeof(long));
+	size_t ancBytes = 0;
+	for (size_t gen = 0; gen < m_ancestralPops.size(); ++gen) {
+		const popData & pd = m_ancestralPops[gen];
+		ancBytes += genoMemSize(pd.m_genotype)
+		            + pd.m_info.capacity() * sizeof(double)
+		            + pd.m_inds.capacity() * sizeof(Individual);
+		LINEAGE_EXPR(ancBytes += pd.m_lineage.capacity() * sizeof(long));
+	}
+	size_t total = genoBytes + lineageBytes + infoBytes + indBytes + ancBytes;
+	if (total > m_memPeak)
+		m_memPeak = total;
+
+	PyObject * dict = PyDict_New();
+	PyObject * val = NULL;
+	PyDict_SetItemString(dict, "genotype", val = PyInt_FromLong(static_cast<long>(genoBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "lineage", val = PyInt_FromLong(static_cast<long>(lineageBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "info", val = PyInt_FromLong(static_cast<long>(infoBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "individuals", val = PyInt_FromLong(static_cast<long>(indBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "ancestralGens", val = PyInt_FromLong(static_cast<long>(ancBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "total", val = PyInt_FromLong(static_cast<long>(total)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "peak", val = PyInt_FromLong(static_cast<long>(m_memPeak)));
+	Py_DECREF(val);
+	return dict;
+}
+
+
 vectorf Population::indInfo(const uintString & field, vspID subPopID)
 {
 	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
@@ -3163,7 +4334,7 @@ vectorf Population::indInfo(const uintString & field, vspID subPopID)
 	vspID subPop = subPopID.resolve(*this);
 	size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 	vectorf ret;
-	if (subPop.valid()) {
+	if (subPop.valid() && subPop.isVirtual()) {
 		activateVirtualSubPop(subPop);
 		IndInfoIterator it = infoBegin(idx, subPop);
 		IndInfoIterator it_end = infoEnd(idx, subPop);
@@ -3173,11 +4344,16 @@ vectorf Population::indInfo(const uintString & field, vspID subPopID)
 		deactivateVirtualSubPop(subPop.subPop());
 		return ret;
 	} else {
-		IndInfoIterator it = infoBegin(idx);
-		IndInfoIterator it_end = infoEnd(idx);
-		for (; it != it_end; ++it) {
-			ret.push_back(*it);
-		}
+		// gather the column with plain pointer strides. The iterator
+		// interface decides between gapped and individual access on every
+		// dereference, which dominates a scan across a large population.
+		size_t first = subPop.valid() ? m_subPopIndex[subPop.subPop()] : 0;
+		size_t last = subPop.valid() ? m_subPopIndex[subPop.subPop() + 1] : m_popSize;
+		size_t step = infoSize();
+		ret.resize(last - first);
+		InfoIterator src = m_info.begin() + first * step + idx;
+		for (size_t i = 0; i < ret.size(); ++i, src += step)
+			ret[i] = *src;
 		return ret;
 	}
 }
@@ -3348,20 +4524,147 @@ void Population::setIndInfo(const floatList & valueList, const uintString &
 	CHECKRANGEINFO(idx);
 	const vectorf & values = valueList.elems();
 	size_t valueSize = values.size();
-	if (subPop.valid()) {
+	if (subPop.valid() && subPop.isVirtual()) {
 		activateVirtualSubPop(subPop);
 		IndInfoIterator ptr = infoBegin(idx, subPop);
 		for (size_t i = 0; ptr != infoEnd(idx, subPop); ++ptr, ++i)
 			*ptr = static_cast<double>(values[i % valueSize]);
 		deactivateVirtualSubPop(subPop.subPop());
 	} else {
-		IndInfoIterator ptr = infoBegin(idx);
-		for (size_t i = 0; ptr != infoEnd(idx); ++ptr, ++i)
+		// scatter the column with plain pointer strides, see indInfo.
+		size_t first = subPop.valid() ? m_subPopIndex[subPop.subPop()] : 0;
+		size_t last = subPop.valid() ? m_subPopIndex[subPop.subPop() + 1] : m_popSize;
+		size_t step = infoSize();
+		InfoIterator ptr = m_info.begin() + first * step + idx;
+		for (size_t i = 0; i < last - first; ++i, ptr += step)
 			*ptr = static_cast<double>(values[i % valueSize]);
 	}
 }
 
 
+namespace {
+
+// one compiled step of Population::transformInfo
+struct InfoTransformStep
+{
+	size_t m_target;
+	char m_op;
+	// column of the operand field, or -1 for a numeric operand
+	ssize_t m_src;
+	double m_value;
+};
+
+void applyInfoTransform(const std::vector<InfoTransformStep> & steps, double * row)
+{
+	for (size_t s = 0; s < steps.size(); ++s) {
+		const InfoTransformStep & step = steps[s];
+		double operand = step.m_src >= 0 ? row[step.m_src] : step.m_value;
+		double & target = row[step.m_target];
+		switch (step.m_op) {
+		case '=':
+			target = operand;
+			break;
+		case '+':
+			target += operand;
+			break;
+		case '-':
+			target -= operand;
+			break;
+		case '*':
+			target *= operand;
+			break;
+		case '/':
+			target /= operand;
+			break;
+		case '<':
+			target = std::min(target, operand);
+			break;
+		case '>':
+			target = std::max(target, operand);
+			break;
+		}
+	}
+}
+
+}
+
+
+void Population::transformInfo(const stringList & fieldList, const stringList & opList,
+                               const stringList & operandList, vspID subPopID)
+{
+	vspID subPop = subPopID.resolve(*this);
+
+	DBG_FAILIF(subPop.valid() && hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	const vectorstr & fields = fieldList.elems();
+	const vectorstr & ops = opList.elems();
+	const vectorstr & operands = operandList.elems();
+
+	PARAM_FAILIF(fields.size() != ops.size() || fields.size() != operands.size(), ValueError,
+		"Parameters fields, ops, and operands should have the same length.");
+	if (fields.empty())
+		return;
+
+	// compile the pipeline once: resolve field names to columns, map the
+	// operators, and parse numeric operands
+	std::vector<InfoTransformStep> steps(fields.size());
+	for (size_t i = 0; i < fields.size(); ++i) {
+		steps[i].m_target = infoIdx(fields[i]);
+		if (ops[i] == "=")
+			steps[i].m_op = '=';
+		else if (ops[i] == "+")
+			steps[i].m_op = '+';
+		else if (ops[i] == "-")
+			steps[i].m_op = '-';
+		else if (ops[i] == "*")
+			steps[i].m_op = '*';
+		else if (ops[i] == "/")
+			steps[i].m_op = '/';
+		else if (ops[i] == "min")
+			steps[i].m_op = '<';
+		else if (ops[i] == "max")
+			steps[i].m_op = '>';
+		else
+			throw ValueError("Unsupported operator '" + ops[i] +
+				"', please use one of '=', '+', '-', '*', '/', 'min', or 'max'.");
+		if (hasInfoField(operands[i])) {
+			steps[i].m_src = static_cast<ssize_t>(infoIdx(operands[i]));
+			steps[i].m_value = 0.;
+		} else {
+			char * end = NULL;
+			steps[i].m_src = -1;
+			steps[i].m_value = strtod(operands[i].c_str(), &end);
+			PARAM_FAILIF(operands[i].empty() || end == NULL || *end != '\0', ValueError,
+				"Operand '" + operands[i] + "' is neither an information field nor a number.");
+		}
+	}
+
+	if (subPop.valid() && subPop.isVirtual()) {
+		activateVirtualSubPop(subPop);
+		IndIterator it = indIterator(subPop.subPop());
+		for (; it.valid(); ++it)
+			applyInfoTransform(steps, &*it->infoPtr());
+		deactivateVirtualSubPop(subPop.subPop());
+	} else {
+		// stream over the info columns of the (sub)population in one pass
+		size_t first = subPop.valid() ? m_subPopIndex[subPop.subPop()] : 0;
+		size_t last = subPop.valid() ? m_subPopIndex[subPop.subPop() + 1] : m_popSize;
+		size_t step = infoSize();
+		if (indOrdered()) {
+			double * row = &*(m_info.begin() + first * step);
+			for (size_t i = first; i < last; ++i, row += step)
+				applyInfoTransform(steps, row);
+		} else {
+			RawIndIterator it = rawIndBegin() + first;
+			RawIndIterator it_end = rawIndBegin() + last;
+			for (; it != it_end; ++it)
+				applyInfoTransform(steps, &*it->infoPtr());
+		}
+	}
+}
+
+
 void Population::markIndividuals(vspID subPop, bool mark) const
 {
 	if (subPop.valid()) {
@@ -3402,6 +4705,10 @@ void Population::keepAncestralGens(const uintList & ancGens)
 		return;
 
 	useAncestralGen(0);
+	// the record shuffle below swaps arrays between generations, which
+	// requires all of them in memory
+	for (size_t gen = 1; gen <= m_ancestralPops.size(); ++gen)
+		fetchAncestralGen(gen);
 	vectoru gens = ancGens.elems();
 	std::sort(gens.begin(), gens.end());
 	for (size_t genIdx = 0; genIdx < gens.size(); ++genIdx) {
@@ -3447,6 +4754,7 @@ void Population::keepAncestralGens(const uintList & ancGens)
 
 void Population::useAncestralGen(ssize_t idx)
 {
+	markGenoModified();
 	DBG_FAILIF(hasActivatedVirtualSubPop(), RuntimeError, "Can not switch ancestral generation with an activated virtual subpopulation");
 
 	if (idx == m_curAncestralGen)
@@ -3474,6 +4782,7 @@ void Population::useAncestralGen(ssize_t idx)
 	m_curAncestralGen = static_cast<int>(idx);
 	// swap  1 ==> 0, 2 ==> 1
 
+	fetchAncestralGen(idx);
 	popData & pd = m_ancestralPops[m_curAncestralGen - 1];
 	pd.swap(*this);
 	m_popSize = m_inds.size();
@@ -3497,6 +4806,9 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 	size_t size = m_genotype.size();
 	ar & size;
 
+	// in blob mode the genotype, lineage and info payloads are stored as
+	// raw binary blobs by saveSnapshot() and are skipped here.
+	if (!m_blobMode) {
 	bool singleMut = true;
 #ifdef BINARYALLELE
 	size_t singleMutVal = 1;
@@ -3571,7 +4883,9 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 		}
 	}
 #endif
+	}
 
+	if (!m_blobMode) {
 #ifdef LINEAGE
 	DBG_DO(DBG_POPULATION, cerr << "Handling lineage" << endl);
 	if (!m_lineage.empty()) {
@@ -3598,6 +4912,7 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 #endif
 	DBG_DO(DBG_POPULATION, cerr << "Handling information" << endl);
 	ar & m_info;
+	}
 	DBG_DO(DBG_POPULATION, cerr << "Handling Individuals" << endl);
 	ar & m_inds;
 	DBG_DO(DBG_POPULATION, cerr << "Handling ancestral populations" << endl);
@@ -3613,6 +4928,7 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 		size_t size = m_genotype.size();
 		ar & size;
 
+		if (!m_blobMode) {
 		bool singleMut = true;
 #ifdef BINARYALLELE
 		size_t singleMutVal = 1;
@@ -3687,7 +5003,9 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 			}
 		}
 #endif
+		}
 
+		if (!m_blobMode) {
 #ifdef LINEAGE
 		if (!m_lineage.empty()) {
 			int has_lineage = 1;
@@ -3713,6 +5031,7 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 #endif
 
 		ar & m_info;
+		}
 		ar & m_inds;
 	}
 	const_cast<Population *>(this)->useAncestralGen(0);
@@ -3748,6 +5067,9 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 		size_t size;
 		ar & size;
 		m_genotype.resize(size);
+		adviseHugePages(m_genotype);
+		// in blob mode the payload is loaded from blobs by loadSnapshot()
+		if (!m_blobMode) {
 		// number of mutants
 		size_t numMut = 0;
 		bool singleMut = true;
@@ -3776,11 +5098,13 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			m_genotype[pos] = value;
 #endif
 		}
+		}
 	} else if (version == 1) {
 		// a newer version
 		size_t size;
 		ar & size;
 		m_genotype.resize(size);
+		adviseHugePages(m_genotype);
 
 		vectoru mutLoc;
 		bool singleMut;
@@ -3813,6 +5137,7 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			size_t size;
 			ar & size;
 			m_genotype.resize(size);
+			adviseHugePages(m_genotype);
 			GenoIterator ptr = m_genotype.begin();
 			WORDTYPE data = 0;
 			for (size_t i = 0; i < size; ++i) {
@@ -3837,6 +5162,7 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			size_t size;
 			ar & size;
 			m_genotype.resize(size);
+			adviseHugePages(m_genotype);
 			WORDTYPE data = 0;
 			for (size_t i = 0; i < size; ++i) {
 				if (i % 32 == 0)
@@ -3860,6 +5186,7 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			size_t size;
 			ar & size;
 			m_genotype.resize(size);
+			adviseHugePages(m_genotype);
 			GenoIterator ptr = m_genotype.begin();
 			WORDTYPE data = 0;
 			for (size_t i = 0; i < size; ++i) {
@@ -3875,7 +5202,12 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 		}
 #endif
 	}
-	if (version > 0) {
+	if (m_blobMode) {
+#ifdef LINEAGE
+		m_lineage.clear();
+		m_lineage.resize(m_genotype.size(), 0);
+#endif
+	} else if (version > 0) {
 		int has_lineage;
 		ar & has_lineage;
 #ifdef LINEAGE
@@ -3907,7 +5239,8 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 #endif
 	}
 	DBG_DO(DBG_POPULATION, cerr << "Handling info" << endl);
-	ar & m_info;
+	if (!m_blobMode)
+		ar & m_info;
 
 	DBG_DO(DBG_POPULATION, cerr << "Handling Individuals" << endl);
 	ar & m_inds;
@@ -3918,6 +5251,9 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 
 	m_popSize = accumulate(m_subPopSize.begin(), m_subPopSize.end(), size_t(0));
 
+	if (m_blobMode)
+		m_info.resize(m_popSize * infoSize());
+
 	DBG_FAILIF(m_info.size() != m_popSize * infoSize(), ValueError, "Wgong size of info vector");
 
 	if (m_popSize != m_inds.size()) {
@@ -3952,6 +5288,9 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 
 	m_ancestralGens = 0;
 	m_ancestralPops.clear();
+	// a spill log belongs to the population that wrote it
+	m_spillFile.clear();
+	m_spillGens = 0;
 
 	// ancestry populations
 	DBG_DO(DBG_POPULATION, cerr << "Handling ancestral populations" << endl);
@@ -3968,7 +5307,9 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			size_t size;
 			ar & size;
 			pd.m_genotype.resize(size);
+			adviseHugePages(pd.m_genotype);
 
+			if (!m_blobMode) {
 			// number of mutants
 			size_t numMut = 0;
 			bool singleMut = true;
@@ -3997,10 +5338,12 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 				pd.m_genotype[pos] = value;
 #endif
 			}
+			}
 		} else if (version == 1) {
 			size_t size;
 			ar & size;
 			pd.m_genotype.resize(size);
+			adviseHugePages(pd.m_genotype);
 
 			vectoru mutLoc;
 			bool singleMut;
@@ -4034,6 +5377,7 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 				size_t size;
 				ar & size;
 				pd.m_genotype.resize(size);
+				adviseHugePages(pd.m_genotype);
 				ptr = pd.m_genotype.begin();
 				WORDTYPE data = 0;
 				for (size_t i = 0; i < size; ++i) {
@@ -4079,6 +5423,7 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 				size_t size;
 				ar & size;
 				pd.m_genotype.resize(size);
+				adviseHugePages(pd.m_genotype);
 				ptr = pd.m_genotype.begin();
 				WORDTYPE data = 0;
 				for (size_t i = 0; i < size; ++i) {
@@ -4093,7 +5438,12 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			}
 #endif
 		}
-		if (version > 0) {
+		if (m_blobMode) {
+#ifdef LINEAGE
+			pd.m_lineage.clear();
+			pd.m_lineage.resize(pd.m_genotype.size(), 0);
+#endif
+		} else if (version > 0) {
 			int has_lineage;
 			ar & has_lineage;
 #ifdef LINEAGE
@@ -4124,8 +5474,11 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 			pd.m_lineage.resize(pd.m_genotype.size(), 0);
 #endif
 		}
-		ar & pd.m_info;
+		if (!m_blobMode)
+			ar & pd.m_info;
 		ar & pd.m_inds;
+		if (m_blobMode)
+			pd.m_info.resize(pd.m_inds.size() * infoSize());
 		// set pointer after copy this thing again (push_back)
 		m_ancestralPops.push_back(pd);
 		// now set pointers
@@ -4162,96 +5515,939 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 }
 
 
-void Population::save(const string & filename) const
+// The binary snapshot format of saveSnapshot()/loadSnapshot() consists of
+// a fixed header, a text archive with everything but the genotype, lineage
+// and info payloads (written with m_blobMode set), and a page-aligned blob
+// section with the raw arrays of the current and all ancestral generations.
+namespace {
+
+struct SnapshotHeader
 {
-	boost::iostreams::filtering_ostream ofs;
+	char magic[16];
+	size_t version;
+	// sizeof(Allele), or 0 for the mutant module, used to reject
+	// snapshots saved by a different kind of module.
+	size_t alleleSize;
+	size_t metaOffset;
+	size_t metaSize;
+	size_t blobOffset;
+	// length of the base snapshot path stored between the metadata and
+	// the blob section, 0 for a self-contained snapshot
+	size_t baseSize;
+};
+
+const char g_snapMagic[16] = "simuPOP-snap";
+const size_t g_snapPageSize = 4096;
+#if defined(LONGALLELE)
+// version 4 stores genotype blobs chunk run-length encoded on top of the
+// varint encoding of version 3; the version constant is module specific
+// because the blob encoding of other modules is unchanged
+const size_t g_snapVersion = 4;
+#elif !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+// version 3 stores genotype blobs chunk run-length encoded
+const size_t g_snapVersion = 3;
+#else
+const size_t g_snapVersion = 2;
+#endif
 
-	// compress output
-	ofs.push(boost::iostreams::gzip_compressor());
-	// open file to write
-	boost::iostreams::file_sink dest(filename, std::ios::binary);
-	if (!dest.is_open())
-		throw ValueError("Cannot write to file " + filename);
-	ofs.push(dest);
-	// if ofs itself get into trouble
-	if (!ofs)
-		throw ValueError("Cannot save population to file " + filename);
+// FNV-1a, used to recognize per-generation blob groups that a delta
+// snapshot can reference from its base instead of re-writing.
+ULONG snapshotDigest(const char * data, size_t n)
+{
+	ULONG h = 14695981039346656037UL;
 
-	boost::archive::text_oarchive oa(ofs);
-	oa << *this;
+	for (size_t i = 0; i < n; ++i) {
+		h ^= static_cast<unsigned char>(data[i]);
+		h *= 1099511628211UL;
+	}
+	return h;
 }
 
 
-void Population::load(const string & filename)
+#ifdef MUTANTALLELE
+const size_t g_snapAlleleSize = 0;
+#else
+const size_t g_snapAlleleSize = sizeof(Allele);
+#endif
+
+// read and sanity-check a snapshot header; return false for files that
+// are not snapshots of this module
+bool readSnapshotHeader(std::istream & in, SnapshotHeader & header)
 {
-	boost::iostreams::filtering_istream ifs;
+	if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+		return false;
+	return memcmp(header.magic, g_snapMagic, sizeof(header.magic)) == 0 &&
+	       header.version == g_snapVersion &&
+	       header.alleleSize == g_snapAlleleSize;
+}
 
-	ifs.push(boost::iostreams::gzip_decompressor());
-	ifs.push(boost::iostreams::file_source(filename, std::ios::binary));
-	// do not have to test again.
-	if (!ifs)
-		throw ValueError("Can not open file " + filename);
 
-	// try to load the file
-	try {
-		boost::archive::text_iarchive ia(ifs);
-		ia >> *this;
-	} catch (const std::exception & e) {
-		throw ValueError("Failed to load Population " + filename + " (" + e.what() + ")\n");
-	} catch (...) {
-		throw ValueError("Failed to load Population " + filename + ".\n");
+// collect the digests of all blob groups a snapshot advertises,
+// including groups it references from its own base. An unusable base
+// leaves the set empty so that the caller writes a full snapshot.
+void collectSnapshotDigests(const string & filename, std::set<ULONG> & digests)
+{
+	std::ifstream in(filename.c_str(), std::ios::binary);
+	SnapshotHeader header;
+
+	if (!in || !readSnapshotHeader(in, header))
+		return;
+	in.seekg(header.blobOffset);
+	ULONG digest = 0;
+	size_t sz = 0;
+	while (in.read(reinterpret_cast<char *>(&digest), sizeof(digest)) &&
+	       in.read(reinterpret_cast<char *>(&sz), sizeof(sz))) {
+		digests.insert(digest);
+		if (sz > 0)
+			in.seekg(sz, std::ios::cur);
 	}
 }
 
 
-PyObject * Population::vars(vspID vsp)
+// fetch the payload of the blob group with the given digest, following
+// the base chain of the snapshot for reference groups
+bool fetchSnapshotGroup(const string & filename, ULONG digest, std::vector<char> & payload)
 {
-	if (!vsp.valid()) {
-		Py_INCREF(m_vars.dict());
-		return m_vars.dict();
+	std::ifstream in(filename.c_str(), std::ios::binary);
+	SnapshotHeader header;
+
+	if (!in || !readSnapshotHeader(in, header))
+		return false;
+	in.seekg(header.blobOffset);
+	ULONG d = 0;
+	size_t sz = 0;
+	while (in.read(reinterpret_cast<char *>(&d), sizeof(d)) &&
+	       in.read(reinterpret_cast<char *>(&sz), sizeof(sz))) {
+		if (d == digest && sz > 0) {
+			payload.resize(sz);
+			return static_cast<bool>(in.read(&payload[0], sz));
+		}
+		if (sz > 0)
+			in.seekg(sz, std::ios::cur);
 	}
-	DBG_ASSERT(static_cast<size_t>(vsp.subPop()) < numSubPop(),
-		IndexError, (boost::format("Subpop index out of range of 0 ~ %1%") % (numSubPop() - 1)).str());
+	if (header.baseSize == 0)
+		return false;
+	in.clear();
+	in.seekg(header.metaOffset + header.metaSize);
+	string base(header.baseSize, '\0');
+	if (!in.read(&base[0], header.baseSize))
+		return false;
+	return fetchSnapshotGroup(base, digest, payload);
+}
 
-	if (!m_vars.hasVar("subPop"))
-		throw ValueError("Population local namespace does not have key 'subPop'. "
-			             "You may forgot to call the Stat operator, or use the 'vars' parameter "
-			             "to generate subpopulation-specific statistics.");
+template <typename T>
+void writeSnapValue(std::ostream & out, const T & value)
+{
+	out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
 
-	PyObject * spObj = m_vars.getVar("subPop");
-	// vsp? A tube with (sp, vsp)
-	PyObject * key = NULL;
-	if (vsp.isVirtual())
-		key = Py_BuildValue("(ii)", vsp.subPop(), vsp.virtualSubPop());
-	else
-		key = PyInt_FromLong(static_cast<int>(vsp.subPop()));
 
-	spObj = PyDict_GetItem(spObj, key);
+template <typename T>
+void readSnapValue(const char * & ptr, T & value)
+{
+	memcpy(&value, ptr, sizeof(T));
+	ptr += sizeof(T);
+}
 
-	if (spObj == NULL)
-		throw ValueError("Statistics for specified (virtual) subpopulation does not exist.");
 
-	Py_INCREF(spObj);
-	return spObj;
+#ifdef MUTANTALLELE
+void writeGenoBlob(std::ostream & out, const vectorm & geno)
+{
+	// mutants as an index array followed by a value array
+	size_t numMut = geno.data().size();
+
+	writeSnapValue(out, numMut);
+	vectorm::const_val_iterator ptr = geno.begin().get_val_iterator();
+	vectorm::const_val_iterator end = geno.end().get_val_iterator();
+	for (; ptr != end; ++ptr)
+		writeSnapValue(out, ptr->first);
+	ptr = geno.begin().get_val_iterator();
+	for (; ptr != end; ++ptr)
+		writeSnapValue(out, ptr->second);
 }
 
 
-// The same as vars(), but without increasing
-// reference count.
-PyObject * Population::dict(vspID vsp)
+void readGenoBlob(const char * & ptr, vectorm & geno)
 {
-	if (!vsp.valid())
-		return m_vars.dict();
+	size_t numMut = 0;
+
+	readSnapValue(ptr, numMut);
+	const char * idxPtr = ptr;
+	const char * valPtr = ptr + numMut * sizeof(size_t);
+	for (size_t i = 0; i < numMut; ++i) {
+		size_t idx;
+		Allele val;
+		readSnapValue(idxPtr, idx);
+		readSnapValue(valPtr, val);
+		geno.push_back(idx, val);
+	}
+	ptr = valPtr;
+}
 
-	DBG_ASSERT(static_cast<size_t>(vsp.subPop()) < numSubPop(),
-		IndexError, (boost::format("Subpop index out of range of 0 ~ %1%") % (numSubPop() - 1)).str());
 
-	if (!m_vars.hasVar("subPop"))
-		throw ValueError("Population local namespace does not have key 'subPop'. "
-			             "You may forgot to call the Stat operator, or use the 'vars' parameter "
-			             "to generate subpopulation-specific statistics.");
+#elif defined(BINARYALLELE)
+void writeGenoBlob(std::ostream & out, const vectora & geno)
+{
+	// pack alleles into bytes
+	size_t n = geno.size();
+
+	writeSnapValue(out, n);
+	std::vector<unsigned char> buf((n + 7) / 8, 0);
+	for (size_t i = 0; i < n; ++i)
+		if (geno[i])
+			buf[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+	if (!buf.empty())
+		out.write(reinterpret_cast<const char *>(&buf[0]), buf.size());
+}
 
-	PyObject * spObj = m_vars.getVar("subPop");
+
+void readGenoBlob(const char * & ptr, vectora & geno)
+{
+	size_t n = 0;
+
+	readSnapValue(ptr, n);
+	geno.resize(n);
+	for (size_t i = 0; i < n; ++i)
+		geno[i] = (ptr[i / 8] & (1 << (i % 8))) != 0;
+	ptr += (n + 7) / 8;
+}
+
+
+#else
+// the encode buffer is reused across generations and snapshots, so after
+// the first save it is already large enough and encoding does not allocate
+std::vector<unsigned char> & snapEncodeBuf()
+{
+	static std::vector<unsigned char> buf;
+
+	return buf;
+}
+
+
+// genotype blobs are cut into chunks of this many loci; a run of chunks
+// that repeat a single allele collapses to a run length and that allele
+const size_t g_snapChunk = 64;
+
+// write a size as a varint (seven bits per byte, high bit marks a
+// continuation byte)
+void snapPutVarint(std::vector<unsigned char> & buf, size_t v)
+{
+	while (v >= 0x80) {
+		buf.push_back(static_cast<unsigned char>((v & 0x7F) | 0x80));
+		v >>= 7;
+	}
+	buf.push_back(static_cast<unsigned char>(v));
+}
+
+
+size_t snapGetVarint(const unsigned char * & p)
+{
+	size_t v = 0;
+	unsigned shift = 0;
+	unsigned char b;
+
+	do {
+		b = *p++;
+		v |= static_cast<size_t>(b & 0x7F) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return v;
+}
+
+
+void snapPutAllele(std::vector<unsigned char> & buf, Allele a)
+{
+#  ifdef LONGALLELE
+	// nearly all long alleles are small, so they are stored as varints
+	// instead of full-width words
+	while (a >= 0x80) {
+		buf.push_back(static_cast<unsigned char>((a & 0x7F) | 0x80));
+		a >>= 7;
+	}
+	buf.push_back(static_cast<unsigned char>(a));
+#  else
+	buf.push_back(static_cast<unsigned char>(a));
+#  endif
+}
+
+
+Allele snapGetAllele(const unsigned char * & p)
+{
+#  ifdef LONGALLELE
+	Allele a = 0;
+	unsigned shift = 0;
+	unsigned char b;
+
+	do {
+		b = *p++;
+		a |= static_cast<Allele>(b & 0x7F) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return a;
+#  else
+	return static_cast<Allele>(*p++);
+#  endif
+}
+
+
+void writeGenoBlob(std::ostream & out, const vectora & geno)
+{
+	// regions of low diversity, e.g. after a selective sweep, consist of
+	// long stretches of identical alleles. Chunks in which every allele
+	// is the same are therefore not stored verbatim: a run of them, no
+	// matter how long, costs one tag byte, a run length and one allele.
+	size_t n = geno.size();
+
+	writeSnapValue(out, n);
+	std::vector<unsigned char> & buf = snapEncodeBuf();
+	buf.clear();
+	buf.reserve(n / 8 + 16);
+	size_t i = 0;
+	while (i < n) {
+		size_t chunkEnd = std::min(i + g_snapChunk, n);
+		bool mono = true;
+		for (size_t j = i + 1; j < chunkEnd; ++j)
+			if (geno[j] != geno[i]) {
+				mono = false;
+				break;
+			}
+		if (mono) {
+			// extend the run over subsequent chunks with the same allele
+			Allele v = geno[i];
+			size_t runEnd = chunkEnd;
+			while (runEnd < n) {
+				size_t next = std::min(runEnd + g_snapChunk, n);
+				bool same = true;
+				for (size_t j = runEnd; j < next; ++j)
+					if (geno[j] != v) {
+						same = false;
+						break;
+					}
+				if (!same)
+					break;
+				runEnd = next;
+			}
+			buf.push_back(0);
+			snapPutVarint(buf, (runEnd - i + g_snapChunk - 1) / g_snapChunk);
+			snapPutAllele(buf, v);
+			i = runEnd;
+		} else {
+			buf.push_back(1);
+			for (size_t j = i; j < chunkEnd; ++j)
+				snapPutAllele(buf, geno[j]);
+			i = chunkEnd;
+		}
+	}
+	writeSnapValue(out, buf.size());
+	if (!buf.empty())
+		out.write(reinterpret_cast<const char *>(&buf[0]), buf.size());
+}
+
+
+void readGenoBlob(const char * & ptr, vectora & geno)
+{
+	size_t n = 0;
+	size_t nBytes = 0;
+
+	readSnapValue(ptr, n);
+	readSnapValue(ptr, nBytes);
+	geno.resize(n);
+	const unsigned char * p = reinterpret_cast<const unsigned char *>(ptr);
+	size_t i = 0;
+	while (i < n) {
+		unsigned char tag = *p++;
+		if (tag == 0) {
+			size_t chunks = snapGetVarint(p);
+			Allele v = snapGetAllele(p);
+			size_t end = std::min(i + chunks * g_snapChunk, n);
+			for (; i < end; ++i)
+				geno[i] = v;
+		} else {
+			size_t end = std::min(i + g_snapChunk, n);
+			for (; i < end; ++i)
+				geno[i] = snapGetAllele(p);
+		}
+	}
+	ptr += nBytes;
+}
+
+
+#endif
+
+template <typename T>
+void writeArrayBlob(std::ostream & out, const vector<T> & arr)
+{
+	size_t n = arr.size();
+
+	writeSnapValue(out, n);
+	if (n > 0)
+		out.write(reinterpret_cast<const char *>(&arr[0]), n * sizeof(T));
+}
+
+
+template <typename T>
+void readArrayBlob(const char * & ptr, vector<T> & arr)
+{
+	size_t n = 0;
+
+	readSnapValue(ptr, n);
+	arr.resize(n);
+	if (n > 0)
+		memcpy(&arr[0], ptr, n * sizeof(T));
+	ptr += n * sizeof(T);
+}
+
+
+}
+
+
+void Population::setAncestralSpill(const string & filename, int cacheGens)
+{
+	DBG_FAILIF(cacheGens < 0, ValueError, "Parameter cacheGens must be non-negative.");
+
+	useAncestralGen(0);
+	// a previous log (if any) becomes invalid, so read everything back first
+	for (size_t gen = 1; gen <= m_ancestralPops.size(); ++gen)
+		fetchAncestralGen(gen);
+	if (filename.empty()) {
+		m_spillFile.clear();
+		m_spillGens = 0;
+		return;
+	}
+	m_spillFile = filename;
+	m_spillGens = cacheGens;
+	// truncate stale content of an earlier run
+	std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!out)
+		throw ValueError("Can not open spill file " + filename + " to save ancestral generations.");
+	out.close();
+	spillExcessGens();
+}
+
+
+void Population::spillAncestralGen(size_t genIdx) const
+{
+	popData & pd = const_cast<Population *>(this)->m_ancestralPops[genIdx - 1];
+
+	if (pd.m_spilled)
+		return;
+	std::ofstream out(m_spillFile.c_str(), std::ios::binary | std::ios::app);
+	if (!out)
+		throw ValueError("Can not open spill file " + m_spillFile + " to save ancestral generations.");
+	out.seekp(0, std::ios::end);
+	pd.m_spillOffset = static_cast<size_t>(out.tellp());
+	// per-individual flags are the only individual state that cannot be
+	// rebuilt from the genotype, info and lineage arrays
+	size_t numInds = pd.m_inds.size();
+	writeSnapValue(out, numInds);
+	for (size_t i = 0; i < numInds; ++i)
+		writeSnapValue(out, pd.m_inds[i].flags());
+	writeSnapValue(out, pd.m_genotype.size());
+	writeGenoBlob(out, pd.m_genotype);
+	writeArrayBlob(out, pd.m_info);
+#ifdef LINEAGE
+	writeArrayBlob(out, pd.m_lineage);
+#endif
+	writeSnapValue(out, static_cast<char>(pd.m_indOrdered));
+	pd.m_spillSize = static_cast<size_t>(out.tellp()) - pd.m_spillOffset;
+	if (!out)
+		throw ValueError("Failed to write ancestral generation to spill file " + m_spillFile + ".");
+	out.close();
+	// swap with empty temporaries to actually return the memory
+	{
+#ifdef MUTANTALLELE
+		vectorm tmp;
+#else
+		vectora tmp;
+#endif
+		pd.m_genotype.swap(tmp);
+	}
+	vectorf().swap(pd.m_info);
+	vector<Individual>().swap(pd.m_inds);
+#ifdef LINEAGE
+	vectori().swap(pd.m_lineage);
+#endif
+	pd.m_spilled = true;
+}
+
+
+void Population::fetchAncestralGen(size_t genIdx) const
+{
+	popData & pd = const_cast<Population *>(this)->m_ancestralPops[genIdx - 1];
+
+	if (!pd.m_spilled)
+		return;
+	std::ifstream in(m_spillFile.c_str(), std::ios::binary);
+	if (!in)
+		throw ValueError("Can not open spill file " + m_spillFile + " to load an ancestral generation.");
+	std::vector<char> buf(pd.m_spillSize);
+	in.seekg(pd.m_spillOffset);
+	if (!in.read(&buf[0], buf.size()))
+		throw ValueError("Failed to read an ancestral generation from spill file " + m_spillFile + ".");
+	const char * ptr = &buf[0];
+	size_t numInds = 0;
+	readSnapValue(ptr, numInds);
+	pd.m_inds.resize(numInds);
+	for (size_t i = 0; i < numInds; ++i) {
+		unsigned char flags = 0;
+		readSnapValue(ptr, flags);
+		pd.m_inds[i].setFlags(flags);
+	}
+	size_t genoN = 0;
+	readSnapValue(ptr, genoN);
+	pd.m_genotype.resize(genoN);
+	readGenoBlob(ptr, pd.m_genotype);
+	readArrayBlob(ptr, pd.m_info);
+#ifdef LINEAGE
+	readArrayBlob(ptr, pd.m_lineage);
+#endif
+	char ordered = 0;
+	readSnapValue(ptr, ordered);
+	pd.m_indOrdered = ordered != 0;
+	// re-link individual pointers into the freshly read arrays
+	size_t step = genoSize();
+	size_t infoStep = infoSize();
+	GenoIterator gPtr = pd.m_genotype.begin();
+	InfoIterator infoPtr = pd.m_info.begin();
+	for (size_t i = 0; i < numInds; ++i, gPtr += step, infoPtr += infoStep) {
+		pd.m_inds[i].setGenoStruIdx(genoStruIdx());
+		pd.m_inds[i].setGenoPtr(gPtr);
+		pd.m_inds[i].setInfoPtr(infoPtr);
+	}
+#ifdef LINEAGE
+	LineageIterator lPtr = pd.m_lineage.begin();
+	for (size_t i = 0; i < numInds; ++i, lPtr += step)
+		pd.m_inds[i].setLineagePtr(lPtr);
+#endif
+	pd.m_spilled = false;
+}
+
+
+void Population::spillExcessGens() const
+{
+	// spilling swaps nothing with the live arrays, but record genIdx - 1
+	// holds present-generation data while an ancestral generation is in
+	// use, so spill only from the present generation
+	if (m_spillFile.empty() || m_curAncestralGen != 0)
+		return;
+	for (size_t gen = m_ancestralPops.size(); gen > static_cast<size_t>(m_spillGens); --gen)
+		spillAncestralGen(gen);
+}
+
+
+void Population::writeSnapshot(std::ostream & out, const string & base) const
+{
+	// raw arrays are dumped as a whole so individuals must be in order
+	const_cast<Population *>(this)->syncIndPointers();
+
+	// digests of blob groups available from the base snapshot chain. An
+	// unusable base (missing file, different module, or the file being
+	// overwritten) silently degrades to a full snapshot.
+	std::set<ULONG> baseDigests;
+	if (!base.empty())
+		collectSnapshotDigests(base, baseDigests);
+
+	SnapshotHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_snapMagic, sizeof(header.magic));
+	header.version = g_snapVersion;
+	header.alleleSize = g_snapAlleleSize;
+	header.metaOffset = sizeof(SnapshotHeader);
+	header.baseSize = baseDigests.empty() ? 0 : base.size();
+	// placeholder, patched after the metadata size is known
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	// metadata: the regular archive with array payloads skipped
+	m_blobMode = true;
+	try {
+		boost::archive::text_oarchive oa(out);
+		oa << *this;
+	} catch (...) {
+		m_blobMode = false;
+		throw;
+	}
+	m_blobMode = false;
+	header.metaSize = static_cast<size_t>(out.tellp()) - header.metaOffset;
+	if (header.baseSize > 0)
+		out.write(base.data(), base.size());
+
+	// pad the blob section to a page boundary so that mapped blobs are
+	// page aligned
+	size_t end = header.metaOffset + header.metaSize + header.baseSize;
+	header.blobOffset = (end + g_snapPageSize - 1) / g_snapPageSize * g_snapPageSize;
+	for (size_t i = end; i < header.blobOffset; ++i)
+		out.put('\0');
+
+	// one blob group per generation, current generation first. oa << *this
+	// leaves the population at generation 0, in the same order in which
+	// the metadata was written. Groups whose digest is known to the base
+	// chain are written as references (zero payload size).
+	Population * self = const_cast<Population *>(this);
+	for (size_t gen = 0; gen <= m_ancestralPops.size(); ++gen) {
+		self->useAncestralGen(gen);
+		std::ostringstream blob(std::ios::binary);
+		writeGenoBlob(blob, m_genotype);
+		writeArrayBlob(blob, m_info);
+#ifdef LINEAGE
+		writeArrayBlob(blob, m_lineage);
+#endif
+		const string & bytes = blob.str();
+		ULONG digest = snapshotDigest(bytes.data(), bytes.size());
+		writeSnapValue(out, digest);
+		if (baseDigests.find(digest) != baseDigests.end())
+			writeSnapValue(out, size_t(0));
+		else {
+			writeSnapValue(out, bytes.size());
+			out.write(bytes.data(), bytes.size());
+		}
+	}
+	self->useAncestralGen(0);
+
+	// patch the header
+	out.seekp(0);
+	out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+
+void Population::saveSnapshot(const string & filename, const string & base) const
+{
+	std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!out)
+		throw ValueError("Cannot write to file " + filename);
+	writeSnapshot(out, base == filename ? string() : base);
+	if (!out)
+		throw ValueError("Failed to save population to file " + filename);
+}
+
+
+bool Population::parseSnapshot(const char * data, size_t size, const string & name)
+{
+	SnapshotHeader header;
+
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, g_snapMagic, sizeof(header.magic)) != 0)
+		return false;
+	if (header.version != g_snapVersion)
+		throw ValueError("Snapshot " + name + " was saved by an incompatible "
+			             "version of simuPOP and cannot be loaded.");
+	if (header.alleleSize != g_snapAlleleSize)
+		throw ValueError("Snapshot " + name + " was saved by a different kind of "
+			             "simuPOP module and cannot be loaded. Please use the archive "
+			             "format to exchange populations between modules.");
+
+	// metadata
+	boost::iostreams::filtering_istream ifs;
+	ifs.push(boost::iostreams::array_source(data + header.metaOffset, header.metaSize));
+	m_blobMode = true;
+	try {
+		boost::archive::text_iarchive ia(ifs);
+		ia >> *this;
+	} catch (...) {
+		m_blobMode = false;
+		throw;
+	}
+	m_blobMode = false;
+
+	// blob groups, in the order written by saveSnapshot(). Reference
+	// groups are resolved against the base snapshot chain.
+	string base;
+	if (header.baseSize > 0)
+		base.assign(data + header.metaOffset + header.metaSize, header.baseSize);
+	const char * ptr = data + header.blobOffset;
+	std::vector<char> payload;
+	for (size_t gen = 0; gen <= m_ancestralPops.size(); ++gen) {
+		ULONG digest = 0;
+		size_t sz = 0;
+		readSnapValue(ptr, digest);
+		readSnapValue(ptr, sz);
+		const char * gptr = ptr;
+		if (sz > 0)
+			ptr += sz;
+		else {
+			payload.clear();
+			if (base.empty() || !fetchSnapshotGroup(base, digest, payload))
+				throw ValueError("Snapshot " + name + " references data from base "
+					             "snapshot '" + base + "', which is missing or damaged.");
+			gptr = &payload[0];
+		}
+		if (gen == 0) {
+			readGenoBlob(gptr, m_genotype);
+			readArrayBlob(gptr, m_info);
+#ifdef LINEAGE
+			readArrayBlob(gptr, m_lineage);
+#endif
+		} else {
+			popData & pd = m_ancestralPops[gen - 1];
+			readGenoBlob(gptr, pd.m_genotype);
+			readArrayBlob(gptr, pd.m_info);
+#ifdef LINEAGE
+			readArrayBlob(gptr, pd.m_lineage);
+#endif
+		}
+	}
+
+	// re-link individual pointers: loading blobs may relocate array
+	// storage (and inserts mutants after pointers were assigned)
+	size_t infoStep = infoSize();
+	size_t step = genoSize();
+	InfoIterator infoPtr = m_info.begin();
+	GenoIterator gPtr = m_genotype.begin();
+	for (size_t i = 0; i < m_popSize; ++i, gPtr += step, infoPtr += infoStep) {
+		m_inds[i].setGenoPtr(gPtr);
+		m_inds[i].setInfoPtr(infoPtr);
+	}
+#ifdef LINEAGE
+	LineageIterator lPtr = m_lineage.begin();
+	for (size_t i = 0; i < m_popSize; ++i, lPtr += step)
+		m_inds[i].setLineagePtr(lPtr);
+#endif
+	for (size_t ap = 0; ap < m_ancestralPops.size(); ++ap) {
+		popData & pd = m_ancestralPops[ap];
+		infoPtr = pd.m_info.begin();
+		gPtr = pd.m_genotype.begin();
+		for (size_t i = 0; i < pd.m_inds.size(); ++i, gPtr += step, infoPtr += infoStep) {
+			pd.m_inds[i].setGenoPtr(gPtr);
+			pd.m_inds[i].setInfoPtr(infoPtr);
+		}
+#ifdef LINEAGE
+		lPtr = pd.m_lineage.begin();
+		for (size_t i = 0; i < pd.m_inds.size(); ++i, lPtr += step)
+			pd.m_inds[i].setLineagePtr(lPtr);
+#endif
+	}
+	markGenoModified();
+	return true;
+}
+
+
+bool Population::loadSnapshot(const string & filename)
+{
+	{
+		// a cheap probe so that archive files are not read in whole
+		char magic[16];
+		std::ifstream probe(filename.c_str(), std::ios::binary);
+		if (!probe || !probe.read(magic, sizeof(magic)))
+			return false;
+		if (memcmp(magic, g_snapMagic, sizeof(magic)) != 0)
+			return false;
+	}
+
+	// map the file so that blob pages are shared between processes that
+	// load the same snapshot, with a plain read fallback
+	const char * data = NULL;
+	size_t fileSize = 0;
+	std::vector<char> buffer;
+#ifndef _WIN32
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return false;
+	}
+	fileSize = static_cast<size_t>(st.st_size);
+	void * map = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	if (map != MAP_FAILED) {
+		data = reinterpret_cast<const char *>(map);
+#  ifdef MADV_SEQUENTIAL
+		// blobs are consumed front to back exactly once, tell the kernel
+		// so read-ahead is aggressive and consumed pages are reclaimable
+		madvise(map, fileSize, MADV_SEQUENTIAL);
+#  endif
+	}
+#endif
+	if (data == NULL) {
+		std::ifstream ifs(filename.c_str(), std::ios::binary);
+		ifs.seekg(0, std::ios::end);
+		fileSize = static_cast<size_t>(ifs.tellg());
+		ifs.seekg(0, std::ios::beg);
+		buffer.resize(fileSize);
+		if (!ifs.read(&buffer[0], fileSize))
+			throw ValueError("Failed to read snapshot " + filename);
+		data = &buffer[0];
+	}
+
+	bool loaded = false;
+	try {
+		loaded = parseSnapshot(data, fileSize, filename);
+	} catch (...) {
+#ifndef _WIN32
+		if (buffer.empty()) {
+			munmap(const_cast<char *>(data), fileSize);
+			::close(fd);
+		}
+#endif
+		throw;
+	}
+#ifndef _WIN32
+	if (buffer.empty()) {
+		munmap(const_cast<char *>(data), fileSize);
+		::close(fd);
+	}
+#endif
+	return loaded;
+}
+
+
+PyObject * Population::toBytes() const
+{
+	std::ostringstream out(std::ios::binary);
+
+	{
+		// serialization is pure C++ except for pickling the population
+		// variables, which re-acquires the released GIL in SharedVariables
+		GILRelease gil;
+		writeSnapshot(out, string());
+	}
+	const string bytes = out.str();
+
+	return PyBytes_FromStringAndSize(bytes.data(), bytes.size());
+}
+
+
+void Population::fromBytes(PyObject * data)
+{
+	char * buf = NULL;
+	Py_ssize_t len = 0;
+
+	if (data == NULL || PyBytes_AsStringAndSize(data, &buf, &len) != 0)
+		throw ValueError("Parameter data of Population.fromBytes should be a bytes object.");
+	if (!parseSnapshot(buf, static_cast<size_t>(len), "data"))
+		throw ValueError("The passed bytes object does not contain a population "
+			             "snapshot of this kind of simuPOP module.");
+}
+
+
+
+void Population::save(const string & filename, const string & base) const
+{
+	// writing a population is pure C++ except for pickling the population
+	// variables, which re-acquires the released GIL in SharedVariables
+	GILRelease gil;
+
+	// a ".bin" extension selects the binary snapshot format
+	if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".bin") == 0) {
+		saveSnapshot(filename, base);
+		return;
+	}
+
+	boost::iostreams::filtering_ostream ofs;
+
+	// compress output
+	ofs.push(boost::iostreams::gzip_compressor());
+	// open file to write
+	boost::iostreams::file_sink dest(filename, std::ios::binary);
+	if (!dest.is_open())
+		throw ValueError("Cannot write to file " + filename);
+	ofs.push(dest);
+	// if ofs itself get into trouble
+	if (!ofs)
+		throw ValueError("Cannot save population to file " + filename);
+
+	boost::archive::text_oarchive oa(ofs);
+	oa << *this;
+}
+
+
+void Population::load(const string & filename)
+{
+	// binary snapshots are detected by their magic bytes
+	if (loadSnapshot(filename))
+		return;
+
+	// the text archive grammar forces token-by-token reads, and pulling
+	// every token through the decompressor's filter chain dominates load
+	// time for large populations. The archive is therefore decompressed
+	// into memory in one streaming pass first, leaving only the parsing
+	// cost in the token-by-token stage.
+	string buffer;
+	{
+		boost::iostreams::filtering_istream src;
+		src.push(boost::iostreams::gzip_decompressor());
+		src.push(boost::iostreams::file_source(filename, std::ios::binary));
+		// do not have to test again.
+		if (!src)
+			throw ValueError("Can not open file " + filename);
+		try {
+			char chunk[65536];
+			while (src) {
+				src.read(chunk, sizeof(chunk));
+				buffer.append(chunk, static_cast<size_t>(src.gcount()));
+			}
+		} catch (const std::exception & e) {
+			throw ValueError("Failed to load Population " + filename + " (" + e.what() + ")\n");
+		}
+	}
+
+	boost::iostreams::filtering_istream ifs;
+	ifs.push(boost::iostreams::array_source(buffer.data(), buffer.size()));
+
+	// try to load the file
+	try {
+		boost::archive::text_iarchive ia(ifs);
+		ia >> *this;
+	} catch (const std::exception & e) {
+		throw ValueError("Failed to load Population " + filename + " (" + e.what() + ")\n");
+	} catch (...) {
+		throw ValueError("Failed to load Population " + filename + ".\n");
+	}
+}
+
+
+PyObject * Population::vars(vspID vsp)
+{
+	GILGuard gil;
+	if (!vsp.valid()) {
+		Py_INCREF(m_vars.dict());
+		return m_vars.dict();
+	}
+	DBG_ASSERT(static_cast<size_t>(vsp.subPop()) < numSubPop(),
+		IndexError, (boost::format("Subpop index out of range of 0 ~ %1%") % (numSubPop() - 1)).str());
+
+	if (!m_vars.hasVar("subPop"))
+		throw ValueError("Population local namespace does not have key 'subPop'. "
+			             "You may forgot to call the Stat operator, or use the 'vars' parameter "
+			             "to generate subpopulation-specific statistics.");
+
+	PyObject * spObj = m_vars.getVar("subPop");
+	// vsp? A tube with (sp, vsp)
+	PyObject * key = NULL;
+	if (vsp.isVirtual())
+		key = Py_BuildValue("(ii)", vsp.subPop(), vsp.virtualSubPop());
+	else
+		key = PyInt_FromLong(static_cast<int>(vsp.subPop()));
+
+	spObj = PyDict_GetItem(spObj, key);
+
+	if (spObj == NULL)
+		throw ValueError("Statistics for specified (virtual) subpopulation does not exist.");
+
+	Py_INCREF(spObj);
+	return spObj;
+}
+
+
+// The same as vars(), but without increasing
+// reference count.
+PyObject * Population::dict(vspID vsp)
+{
+	GILGuard gil;
+	if (!vsp.valid())
+		return m_vars.dict();
+
+	DBG_ASSERT(static_cast<size_t>(vsp.subPop()) < numSubPop(),
+		IndexError, (boost::format("Subpop index out of range of 0 ~ %1%") % (numSubPop() - 1)).str());
+
+	if (!m_vars.hasVar("subPop"))
+		throw ValueError("Population local namespace does not have key 'subPop'. "
+			             "You may forgot to call the Stat operator, or use the 'vars' parameter "
+			             "to generate subpopulation-specific statistics.");
+
+	PyObject * spObj = m_vars.getVar("subPop");
 	// vsp? A tube with (sp, vsp)
 	PyObject * key = NULL;
 	if (vsp.isVirtual())
@@ -4273,6 +6469,76 @@ void Population::syncIndPointers(bool infoOnly) const
 	if (indOrdered())
 		return;
 
+#ifndef MUTANTALLELE
+	// individuals may have been reordered within a few known
+	// subpopulations only (e.g. a sort or shuffle within one deme), in
+	// which case ordering is restored deme by deme without moving the
+	// storage of the other subpopulations. The compressed storage of the
+	// mutant module does not support in-place splicing, so it always
+	// takes the whole-population path.
+	if (!m_unorderedSubPops.empty()) {
+		size_t is = infoSize();
+		size_t sz = genoSize();
+		Population * self = const_cast<Population *>(this);
+		for (size_t u = 0; u < m_unorderedSubPops.size(); ++u) {
+			size_t sp = m_unorderedSubPops[u];
+			size_t first = subPopBegin(sp);
+			size_t spSize = subPopSize(sp);
+			if (!infoOnly && sz > 0) {
+				vectora tmpGenotype(spSize * sz);
+				vectora::iterator it = tmpGenotype.begin();
+#  ifdef LINEAGE
+				vectori tmpLineage(spSize * sz);
+				vectori::iterator lineagePtr = tmpLineage.begin();
+#  endif
+				for (size_t j = 0; j < spSize; ++j) {
+					Individual & ind = self->m_inds[first + j];
+#  ifdef BINARYALLELE
+					copyGenotype(ind.genoBegin(), it, sz);
+#  else
+					copy(ind.genoBegin(), ind.genoEnd(), it);
+#  endif
+					it += sz;
+#  ifdef LINEAGE
+					copyLineage(ind.lineageBegin(), ind.lineageEnd(), lineagePtr);
+					lineagePtr += sz;
+#  endif
+				}
+#  ifdef BINARYALLELE
+				copyGenotype(tmpGenotype.begin(), self->m_genotype.begin() + first * sz, spSize * sz);
+#  else
+				copy(tmpGenotype.begin(), tmpGenotype.end(), self->m_genotype.begin() + first * sz);
+#  endif
+				LINEAGE_EXPR(copy(tmpLineage.begin(), tmpLineage.end(), self->m_lineage.begin() + first * sz));
+			}
+			if (is > 0) {
+				vectorf tmpInfo(spSize * is);
+				vectorf::iterator infoPtr = tmpInfo.begin();
+				for (size_t j = 0; j < spSize; ++j, infoPtr += is)
+					copy(self->m_inds[first + j].infoBegin(),
+						self->m_inds[first + j].infoEnd(), infoPtr);
+				copy(tmpInfo.begin(), tmpInfo.end(), self->m_info.begin() + first * is);
+			}
+			// point the individuals back at their canonical storage
+			GenoIterator gPtr = self->m_genotype.begin() + first * sz;
+			InfoIterator iPtr = self->m_info.begin() + first * is;
+#  ifdef LINEAGE
+			LineageIterator lPtr = self->m_lineage.begin() + first * sz;
+#  endif
+			for (size_t j = 0; j < spSize; ++j, gPtr += sz, iPtr += is) {
+				if (!infoOnly) {
+					self->m_inds[first + j].setGenoPtr(gPtr);
+					LINEAGE_EXPR(self->m_inds[first + j].setLineagePtr(lPtr));
+				}
+				self->m_inds[first + j].setInfoPtr(iPtr);
+				LINEAGE_EXPR(lPtr += sz);
+			}
+		}
+		setIndOrdered(true);
+		return;
+	}
+#endif
+
 	if (infoOnly) {
 		DBG_DO(DBG_POPULATION, cerr << "Adjust info position " << endl);
 		size_t is = infoSize();
@@ -4321,7 +6587,7 @@ void Population::syncIndPointers(bool infoOnly) const
 			copy(ind->genoBegin(), ind->genoEnd(), it);
 #  endif
 #endif
-			LINEAGE_EXPR(copy(ind->lineageBegin(), ind->lineageEnd(), lineagePtr));
+			LINEAGE_EXPR(copyLineage(ind->lineageBegin(), ind->lineageEnd(), lineagePtr));
 			ind->setGenoPtr(it);
 			LINEAGE_EXPR(ind->setLineagePtr(lineagePtr));
 			it += sz;
@@ -4348,4 +6614,334 @@ Population & loadPopulation(const string & file)
 }
 
 
+// open a file to import, which can be compressed by gzip, for one scanning pass
+static void openImportStream(const string & file, boost::iostreams::filtering_istream & ifs)
+{
+	ifs.reset();
+	if (file.size() > 3 && file.compare(file.size() - 3, 3, ".gz") == 0)
+		ifs.push(boost::iostreams::gzip_decompressor());
+	ifs.push(boost::iostreams::file_source(file, std::ios::binary));
+	if (!ifs.good())
+		throw ValueError("Can not open file " + file + " to import.");
+}
+
+
+// Parse the GT calls of one VCF record and write them to locus loc of all
+// individuals. Returns false for a malformed record or an allele that does
+// not fit the allele type of the module.
+static bool parseVCFRecord(const string & line, size_t loc, size_t totLoci,
+                           size_t ploidy, vector<GenoIterator> & geno)
+{
+	// the first sample field follows nine fixed columns
+	size_t pos = 0;
+
+	for (size_t col = 0; col < 9; ++col) {
+		pos = line.find('\t', pos);
+		if (pos == string::npos)
+			return false;
+		++pos;
+	}
+	size_t numSamples = geno.size();
+	for (size_t i = 0; i < numSamples; ++i) {
+		if (pos >= line.size())
+			return false;
+		for (size_t p = 0; p < ploidy; ++p) {
+			size_t a = 0;
+			if (line[pos] == '.')
+				++pos;
+			else {
+				if (!isdigit(line[pos]))
+					return false;
+				for (; pos < line.size() && isdigit(line[pos]); ++pos)
+					a = a * 10 + (line[pos] - '0');
+				if (a > ModuleMaxAllele)
+					return false;
+			}
+			// the population starts out with all-zero genotype so zero
+			// (reference or missing) calls do not have to be written,
+			// which also keeps the mutant module storage sparse.
+			if (a != 0)
+				REF_ASSIGN_ALLELE(geno[i] + p * totLoci + loc, TO_ALLELE(a));
+			if (p + 1 < ploidy) {
+				if (pos >= line.size() || (line[pos] != '|' && line[pos] != '/'))
+					return false;
+				++pos;
+			}
+		}
+		// skip the other fields of this sample
+		pos = line.find('\t', pos);
+		if (pos == string::npos) {
+			if (i + 1 != numSamples)
+				return false;
+		} else
+			++pos;
+	}
+	return true;
+}
+
+
+Population & importVCF(const string & file)
+{
+	boost::iostreams::filtering_istream ifs;
+
+	openImportStream(file, ifs);
+
+	// pass 1: genotypic structure from the header and record columns
+	string line;
+	size_t numSamples = 0;
+	size_t ploidy = 0;
+	vectorstr chromNames;
+	vectoru lociCounts;
+	vectorf lociPos;
+	vectorstr lociNames;
+	bool useNames = true;
+	std::set<string> seenNames;
+	while (getline(ifs, line)) {
+		if (line.empty())
+			continue;
+		if (line[0] == '#') {
+			if (line.compare(0, 6, "#CHROM") == 0) {
+				size_t tabs = std::count(line.begin(), line.end(), '\t');
+				if (tabs < 9)
+					throw ValueError("VCF file " + file + " does not contain any sample.");
+				numSamples = tabs - 8;
+			}
+			continue;
+		}
+		if (numSamples == 0)
+			throw ValueError("VCF file " + file + " does not have a #CHROM header line.");
+		// CHROM, POS and ID columns
+		size_t tab1 = line.find('\t');
+		size_t tab2 = tab1 == string::npos ? string::npos : line.find('\t', tab1 + 1);
+		size_t tab3 = tab2 == string::npos ? string::npos : line.find('\t', tab2 + 1);
+		if (tab3 == string::npos)
+			throw ValueError("Invalid record in VCF file " + file + ".");
+		string chrom = line.substr(0, tab1);
+		double pos = atof(line.substr(tab1 + 1, tab2 - tab1 - 1).c_str());
+		string id = line.substr(tab2 + 1, tab3 - tab2 - 1);
+		if (chromNames.empty() || chrom != chromNames.back()) {
+			if (std::find(chromNames.begin(), chromNames.end(), chrom) != chromNames.end())
+				throw ValueError("Records of chromosome " + chrom + " are not contiguous in file " + file + ".");
+			chromNames.push_back(chrom);
+			lociCounts.push_back(0);
+		} else if (!lociPos.empty() && pos <= lociPos.back())
+			throw ValueError("Loci positions on chromosome " + chrom + " are not in increasing order in file " + file + ".");
+		++lociCounts.back();
+		lociPos.push_back(pos);
+		// loci are named after record IDs, but only if all records carry
+		// an unique ID.
+		if (useNames && (id == "." || !seenNames.insert(id).second))
+			useNames = false;
+		if (useNames)
+			lociNames.push_back(id);
+		// the ploidy of the population is determined from the first call
+		if (ploidy == 0) {
+			size_t s = line.find('\t', tab3 + 1);             // REF
+			for (size_t col = 0; col < 5 && s != string::npos; ++col)
+				s = line.find('\t', s + 1);                   // ALT..FORMAT
+			if (s == string::npos)
+				throw ValueError("Invalid record in VCF file " + file + ".");
+			ploidy = 1;
+			for (++s; s < line.size() && line[s] != '\t' && line[s] != ':'; ++s)
+				if (line[s] == '|' || line[s] == '/')
+					ploidy = 2;
+		}
+	}
+	if (lociPos.empty())
+		throw ValueError("VCF file " + file + " does not contain any genotype record.");
+
+	Population * pop = new Population(uintList(vectoru(1, numSamples)),
+		static_cast<float>(ploidy), uintList(lociCounts), uintList(),
+		floatList(lociPos), 0, stringList(chromNames), stringMatrix(),
+		useNames ? stringList(lociNames) : stringList());
+
+	// pass 2: stream allele calls directly into the genotype storage
+	size_t totLoci = pop->totNumLoci();
+	vector<GenoIterator> geno;
+	geno.reserve(numSamples);
+	for (size_t i = 0; i < numSamples; ++i)
+		geno.push_back(pop->individual(i).genoBegin());
+
+	openImportStream(file, ifs);
+	size_t loc = 0;
+	ssize_t badRecord = -1;
+	vectorstr records;
+	while (true) {
+		bool more = static_cast<bool>(getline(ifs, line));
+		if (more) {
+			if (line.empty() || line[0] == '#')
+				continue;
+			records.push_back(line);
+		}
+		// records are parsed in chunks so that independent lines, which
+		// write to different loci, can be handled by different threads.
+		if ((records.size() == 256 || !more) && !records.empty()) {
+#if defined(_OPENMP) && !defined(MUTANTALLELE) && !defined(BINARYALLELE)
+			// not for the mutant module, whose compressed storage is not
+			// thread-safe for writing, and not for the binary module,
+			// where calls of adjacent loci share machine words.
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+			for (ssize_t i = 0; i < static_cast<ssize_t>(records.size()); ++i) {
+				if (!parseVCFRecord(records[i], loc + i, totLoci, ploidy, geno))
+					badRecord = static_cast<ssize_t>(loc + i);
+			}
+			if (badRecord >= 0)
+				throw ValueError((boost::format("Invalid genotype record for locus %1% in VCF file %2% "
+										        "(malformed call, inconsistent ploidy or an allele that "
+										        "does not fit the allele type of this module).") % badRecord % file).str());
+			loc += records.size();
+			records.clear();
+		}
+		if (!more)
+			break;
+	}
+	DBG_FAILIF(loc != totLoci, SystemError, "Mismatch between the number of scanned and imported records.");
+	return *pop;
+}
+
+
+// read one fixed-width header value of a binary genotype matrix file
+static ULONG readImportValue(std::istream & ifs, const string & file)
+{
+	ULONG value = 0;
+
+	ifs.read(reinterpret_cast<char *>(&value), sizeof(ULONG));
+	if (!ifs)
+		throw ValueError("Genotype matrix file " + file + " is truncated.");
+	return value;
+}
+
+
+// decode one value of the given stored width from a binary buffer. The
+// format uses native byte order throughout so narrow values occupy the
+// low bytes of a ULONG on the platforms it is exchanged between.
+static size_t decodeImportValue(const char * buf, size_t width)
+{
+	ULONG value = 0;
+
+	memcpy(&value, buf, width);
+	return static_cast<size_t>(value);
+}
+
+
+Population & importGenotype(const string & file)
+{
+	boost::iostreams::filtering_istream ifs;
+
+	openImportStream(file, ifs);
+
+	// the header states the layout of the blocks that follow, see
+	// ExportGenotype::apply for the writing side of the format.
+	char magic[16];
+	char expected[16] = "simuPOP-geno";
+	ifs.read(magic, sizeof(magic));
+	if (!ifs || memcmp(magic, expected, sizeof(magic)) != 0)
+		throw ValueError("File " + file + " is not a simuPOP genotype matrix file.");
+	ULONG version = readImportValue(ifs, file);
+	if (version != 2)
+		throw ValueError((boost::format("Unsupported layout version %1% of genotype matrix file %2%.")
+						  % version % file).str());
+	ULONG alleleSize = readImportValue(ifs, file);
+	ULONG encoding = readImportValue(ifs, file);
+	ULONG ploidy = readImportValue(ifs, file);
+	ULONG popSize = readImportValue(ifs, file);
+	ULONG numLoci = readImportValue(ifs, file);
+	if ((alleleSize != 1 && alleleSize != 2 && alleleSize != 4 && alleleSize != 8) ||
+	    encoding > 2 || ploidy == 0 || popSize == 0 || numLoci == 0)
+		throw ValueError("Invalid header of genotype matrix file " + file + ".");
+
+	Population * pop = new Population(uintList(vectoru(1, popSize)),
+		static_cast<float>(ploidy), uintList(vectoru(1, numLoci)));
+
+	size_t rows = popSize * ploidy;
+	vector<GenoIterator> geno;
+	geno.reserve(popSize);
+	for (size_t i = 0; i < popSize; ++i)
+		geno.push_back(pop->individual(i).genoBegin());
+
+	// a cell of row r belongs to homologous set r % ploidy of individual
+	// r / ploidy, matching the row order written by ExportGenotype. The
+	// population starts out with all-zero genotype so zero cells do not
+	// have to be written, which also keeps the mutant module storage
+	// sparse.
+	if (encoding == 2) {
+		// sparse blocks list the non-zero cells of their column as
+		// (row, value) pairs, preceded by the number of pairs.
+		size_t pairSize = sizeof(ULONG) + alleleSize;
+		vector<char> buf;
+		for (size_t loc = 0; loc < numLoci; ++loc) {
+			ULONG n = readImportValue(ifs, file);
+			if (n > rows)
+				throw ValueError("Invalid block of genotype matrix file " + file + ".");
+			if (n == 0)
+				continue;
+			buf.resize(n * pairSize);
+			ifs.read(&buf[0], buf.size());
+			if (!ifs)
+				throw ValueError("Genotype matrix file " + file + " is truncated.");
+			for (size_t j = 0; j < n; ++j) {
+				size_t row = decodeImportValue(&buf[j * pairSize], sizeof(ULONG));
+				size_t a = decodeImportValue(&buf[j * pairSize + sizeof(ULONG)], alleleSize);
+				if (row >= rows || a > ModuleMaxAllele)
+					throw ValueError((boost::format("Invalid cell for locus %1% in genotype matrix file %2% "
+													"(row out of range or an allele that does not fit the "
+													"allele type of this module).") % loc % file).str());
+				if (a != 0)
+					REF_ASSIGN_ALLELE(geno[row / ploidy] + (row % ploidy) * numLoci + loc, TO_ALLELE(a));
+			}
+		}
+	} else if (encoding == 1) {
+		// packed blocks store eight alleles per byte, least significant
+		// bit first.
+		vector<char> buf((rows + 7) / 8);
+		for (size_t loc = 0; loc < numLoci; ++loc) {
+			ifs.read(&buf[0], buf.size());
+			if (!ifs)
+				throw ValueError("Genotype matrix file " + file + " is truncated.");
+			for (size_t row = 0; row < rows; ++row)
+				if (buf[row / 8] & (1 << (row % 8)))
+					REF_ASSIGN_ALLELE(geno[row / ploidy] + (row % ploidy) * numLoci + loc, TO_ALLELE(1));
+		}
+	} else {
+		// raw blocks store one column of allele values each. Columns are
+		// read in chunks of bounded memory so that independent columns
+		// can be decoded by different threads.
+		size_t colSize = rows * alleleSize;
+		size_t chunk = std::max<size_t>(1, size_t(32 * 1024 * 1024) / colSize);
+		vector<char> buf;
+		size_t loc = 0;
+		ssize_t badLocus = -1;
+		while (loc < numLoci) {
+			size_t n = std::min(chunk, static_cast<size_t>(numLoci) - loc);
+			buf.resize(n * colSize);
+			ifs.read(&buf[0], buf.size());
+			if (!ifs)
+				throw ValueError("Genotype matrix file " + file + " is truncated.");
+#if defined(_OPENMP) && !defined(MUTANTALLELE) && !defined(BINARYALLELE)
+			// columns of the mutant module share its compressed storage
+			// and columns of the binary module share machine words, so
+			// only the other modules decode columns concurrently.
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+			for (ssize_t i = 0; i < static_cast<ssize_t>(n); ++i) {
+				const char * col = &buf[i * colSize];
+				for (size_t row = 0; row < rows; ++row) {
+					size_t a = decodeImportValue(col + row * alleleSize, alleleSize);
+					if (a > ModuleMaxAllele)
+						badLocus = static_cast<ssize_t>(loc + i);
+					else if (a != 0)
+						REF_ASSIGN_ALLELE(geno[row / ploidy] + (row % ploidy) * numLoci + loc + i, TO_ALLELE(a));
+				}
+			}
+			if (badLocus >= 0)
+				throw ValueError((boost::format("An allele of locus %1% in genotype matrix file %2% does "
+												"not fit the allele type of this module.") % badLocus % file).str());
+			loc += n;
+		}
+	}
+	return *pop;
+}
+
+
 }
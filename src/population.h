@@ -121,6 +121,36 @@ public:
 	}
 
 
+	/** Return a list of at most \e size individuals, advancing the
+	 *  iterator past them. An empty list is returned when the iteration
+	 *  is exhausted, so that whole populations can be walked chunk by
+	 *  chunk with far fewer Python-level calls than one call per
+	 *  individual.
+	 */
+	vector<Individual *> nextChunk(size_t size)
+	{
+		vector<Individual *> chunk;
+
+		if (size == 0)
+			return chunk;
+		// the easy (and faster) case: no visibility check is needed so
+		// raw individual slots are handed out directly
+		if (m_allInds) {
+			size_t avail = static_cast<size_t>(m_end - m_index);
+			size_t n = avail < size ? avail : size;
+			chunk.reserve(n);
+			for (size_t i = 0; i < n; ++i, ++m_index)
+				chunk.push_back(&*m_index);
+			return chunk;
+		}
+		// check the visibility of individuals
+		for (; m_index != m_end && chunk.size() < size; ++m_index)
+			if (m_isIteratable(m_index - m_begin))
+				chunk.push_back(&*m_index);
+		return chunk;
+	}
+
+
 private:
 	// current (initial individual)
 	vector<Individual>::iterator m_begin;
@@ -287,11 +317,17 @@ public:
 		std::swap(m_ancestralGens, rhs.m_ancestralGens);
 		m_vars.swap(rhs.m_vars);
 		m_ancestralPops.swap(rhs.m_ancestralPops);
+		m_spillFile.swap(rhs.m_spillFile);
+		std::swap(m_spillGens, rhs.m_spillGens);
 		std::swap(m_curAncestralGen, rhs.m_curAncestralGen);
 		std::swap(m_indOrdered, rhs.m_indOrdered);
+		m_unorderedSubPops.swap(rhs.m_unorderedSubPops);
 		std::swap(m_vspSplitter, rhs.m_vspSplitter);
 		std::swap(rhs.m_gen, m_gen);
 		std::swap(rhs.m_rep, m_rep);
+		// cached statistics refer to the swapped content
+		markGenoModified();
+		rhs.markGenoModified();
 #ifdef MUTANTALLELE
 		// vectorm must be setGenoPtr after swap
 		GenoIterator ptr = m_genotype.begin();
@@ -356,6 +392,14 @@ public:
 	 */
 	size_t numVirtualSubPop() const;
 
+	/** CPPONLY return a cached list of the IDs of all subpopulations, or,
+	 *  if \e expandVSP is set and a splitter is in use, of all virtual
+	 *  subpopulations. Used by subPopList::expandFrom to resolve
+	 *  \c ALL_AVAIL specifications without rebuilding the list for every
+	 *  operator of every generation.
+	 */
+	const subPopList::vectorvsp & allSubPops(bool expandVSP) const;
+
 	/// HIDDEN activate a virtual subpopulation.
 	void activateVirtualSubPop(vspID subPop) const;
 
@@ -671,6 +715,29 @@ public:
 	void setIndOrdered(bool s) const
 	{
 		m_indOrdered = s;
+		// whole-population information overrides any per-subpopulation record
+		m_unorderedSubPops.clear();
+	}
+
+
+	/** CPPONLY Mark the individuals of subpopulation \e subPop as reordered
+	 *  within the subpopulation. Operations that need ordered raw genotypes
+	 *  will then restore this subpopulation in place instead of rebuilding
+	 *  the storage of the whole population.
+	 */
+	void setSubPopUnordered(size_t subPop) const
+	{
+		if (m_indOrdered) {
+			m_indOrdered = false;
+			m_unorderedSubPops.assign(1, subPop);
+		} else if (!m_unorderedSubPops.empty()) {
+			// an empty list with m_indOrdered == false means that the whole
+			// population has to be rebuilt, which covers this subpopulation
+			for (size_t i = 0; i < m_unorderedSubPops.size(); ++i)
+				if (m_unorderedSubPops[i] == subPop)
+					return;
+			m_unorderedSubPops.push_back(subPop);
+		}
 	}
 
 
@@ -715,6 +782,18 @@ public:
 
 #endif
 
+	/** CPPONLY Collect the visible individuals of subpopulation \e subPop
+	 *  as <tt>[begin, end)</tt> pairs of absolute indexes appended to
+	 *  \e runs, and return the number of individuals covered. An activated
+	 *  virtual subpopulation is honored; without one, the whole
+	 *  subpopulation forms a single run. Splitters mark clustered members,
+	 *  so the runs stay few and each can be swept with plain pointers from
+	 *  rawIndBegin(): no visibility test or iterator state per step, and
+	 *  loop bodies that auto-vectorize. \e runs is cleared but keeps its
+	 *  capacity, so a reused buffer makes the sweep allocation free.
+	 */
+	size_t indRuns(size_t subPop, vectoru & runs) const;
+
 	/** CPPONLY Individual iterator: without subPop info
 	 *  The iterator will skip invisible Individuals
 	 */
@@ -873,6 +952,18 @@ public:
 	}
 
 
+#ifdef MUTANTALLELE
+	/// CPPONLY number of mutants (non-zero alleles) currently stored for
+	/// the whole population, maintained by the genotype container
+	size_t totNumMutants() const
+	{
+		return m_genotype.data().size();
+	}
+
+
+#endif
+
+
 #ifdef LINEAGE
 
 	///  CPPONLY allele iterator, go through all lineages one by one, without subPop info
@@ -910,6 +1001,14 @@ public:
 	/**
 	   if order, keep order
 	   if not order, respect subpopulation structure
+
+	   Note that this function is not a gate through which all genotype
+	   access flows: individuals keep direct pointers into m_genotype and
+	   most operators go through them, so per-subpopulation tiles that
+	   compress cold demes and decompress here lazily cannot be made
+	   transparent. Models dominated by untouched demes should use the
+	   mutant module, whose storage is already proportional to the number
+	   of segregating sites rather than to population size.
 	 */
 	GenoIterator genoBegin(size_t subPop, bool order)
 	{
@@ -1051,10 +1150,33 @@ public:
 	/** Return an editable array of the genotype of all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
 	 *  subpopulation \e subPop. Virtual subpopulation is unsupported.
+	 *  Exporting the array invalidates cached statistics, but writes
+	 *  through it later cannot be observed, so statistics calculated
+	 *  between such writes may be served from cache until the next export
+	 *  or genotype-modifying operation.
 	 *  <group>5-genotype</group>
 	 */
 	PyObject * genotype(vspID subPop = vspID());
 
+	/** Return a \c memoryview object that exposes the genotypes of all
+	 *  individuals in a population (if <tt>subPop=[]</tt>, default), or
+	 *  individuals in a subpopulation \e subPop, as raw bytes without
+	 *  copying, so that numpy or scipy can process genotypes in place
+	 *  (e.g. <tt>numpy.frombuffer(view, dtype)</tt> with a dtype whose
+	 *  width matches <tt>moduleInfo()['alleleBits']</tt>). The view is
+	 *  writable and maps the underlying storage directly, except in the
+	 *  binary and mutant modules, where the storage has no byte
+	 *  addressable dense layout and a read-only dense projection with one
+	 *  byte per allele is returned. The view becomes invalid once the
+	 *  population changes. Exporting a writable view invalidates cached
+	 *  statistics and genotype digests, but writes through it later
+	 *  cannot be observed, so results calculated between such writes may
+	 *  be served from cache until the next export or genotype-modifying
+	 *  operation. This function requires Python 3.3 or later.
+	 *  <group>5-genotype</group>
+	 */
+	PyObject * genotypeView(vspID subPop = vspID());
+
 	/** Return an iterator that iterate through mutants of all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
 	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. Each
@@ -1067,6 +1189,18 @@ public:
 	 */
 	pyMutantIterator mutants(vspID subPop = vspID());
 
+	/** Return a hexadecimal digest of the genotypes of all individuals in
+	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
+	 *  subpopulation \e subPop. Virtual subpopulation is unsupported.
+	 *  Populations with the same genotype structure carry identical
+	 *  genotypes if and only if their digests match (up to hash
+	 *  collisions), so replicate deduplication and convergence checks can
+	 *  compare short digests instead of extracting genotypes. The digest
+	 *  is cached and is only recomputed after the population changes.
+	 *  <group>5-genotype</group>
+	 */
+	string genotypeDigest(vspID subPop = vspID()) const;
+
 	/** Return an editable array of the lineage of alleles for all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
 	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. <bf>
@@ -1075,6 +1209,28 @@ public:
 	 */
 	PyObject * lineage(vspID subPop = vspID());
 
+	/** Return a writable \c memoryview object that exposes the allele
+	 *  lineages of all individuals in a population (if <tt>subPop=[]</tt>,
+	 *  default), or individuals in a subpopulation \e subPop, as raw bytes
+	 *  (signed items with the width of a C \c long) without copying. The view
+	 *  becomes invalid once the population changes. <bf>This function
+	 *  returns \c None for modules without lineage information.</bf> This
+	 *  function requires Python 3.3 or later.
+	 *  <group>5-genotype</group>
+	 */
+	PyObject * lineageView(vspID subPop = vspID());
+
+	/** Return a writable \c memoryview object that exposes the information
+	 *  fields of all individuals in a population (if <tt>subPop=[]</tt>,
+	 *  default), or individuals in a subpopulation \e subPop, as raw bytes
+	 *  of double precision values without copying, one consecutive block
+	 *  of <tt>infoSize()</tt> values per individual. The view becomes
+	 *  invalid once the population changes. This function requires Python
+	 *  3.3 or later.
+	 *  <group>8-info</group>
+	 */
+	PyObject * infoView(vspID subPop = vspID());
+
 	/** Fill the genotype of all individuals in a population (if
 	 *  <tt>subPop=[]</tt>) or in a (virtual) subpopulation \e subPop (if
 	 *  <tt>subPop=sp</tt> or <tt>(sp, vsp)</tt>) using a list of alleles
@@ -1084,6 +1240,32 @@ public:
 	 */
 	void setGenotype(const uintList & geno, vspID subPop = vspID());
 
+	/** Fill the genotype at loci \e loci (all loci by default) of all
+	 *  individuals in a population (if <tt>subPop=[]</tt>) or in a (virtual)
+	 *  subpopulation \e subPop (if <tt>subPop=sp</tt> or <tt>(sp, vsp)</tt>)
+	 *  with allele \e allele. Unlike <tt>setGenotype</tt>, which accepts an
+	 *  arbitrary list of alleles and writes them one by one, this function
+	 *  fills whole blocks of genotypes natively and should be preferred when
+	 *  resetting the genotype of a large population to a single allele.
+	 *  <group>5-genotype</group>
+	 */
+	void fillGenotype(ULONG allele, vspID subPop = vspID(),
+		const lociList & loci = lociList());
+
+	/** Replace the genotype of all individuals in the present generation by
+	 *  the genotype of individuals in another population \e pop, which must
+	 *  have the same genotypic structure. If a list \e indexMap is given, the
+	 *  genotype of individual \c i is copied from individual
+	 *  <tt>indexMap[i]</tt> of \e pop, so indexes may repeat and a small
+	 *  founder population can seed a larger one. Otherwise the populations
+	 *  must have the same size and genotypes are copied one to one. Lineage
+	 *  is copied along with genotypes in modules with lineage support. Sex,
+	 *  affection status and information fields are not copied.
+	 *  <group>5-genotype</group>
+	 */
+	void copyGenotypeFrom(const Population & pop,
+		const uintList & indexMap = vectoru());
+
 
 	/** Fill the lineage of all individuals in a population (if
 	 *  <tt>subPop=[]</tt>) or in a (virtual) subpopulation \e subPop (if
@@ -1095,6 +1277,19 @@ public:
 	 */
 	void setLineage(const uintList & geno, vspID subPop = vspID());
 
+	/** Fill the lineage at loci \e loci (all loci by default) of all
+	 *  individuals in a population (if <tt>subPop=[]</tt>) or in a (virtual)
+	 *  subpopulation \e subPop (if <tt>subPop=sp</tt> or <tt>(sp, vsp)</tt>)
+	 *  with value \e lineage. Unlike <tt>setLineage</tt>, which accepts an
+	 *  arbitrary list of values and writes them one by one, this function
+	 *  fills whole blocks of the lineage array natively and should be
+	 *  preferred when marking an epoch over a large population. This
+	 *  function returns directly for modules without lineage information.
+	 *  <group>5-genotype</group>
+	 */
+	void fillLineage(long lineage, vspID subPop = vspID(),
+		const lociList & loci = lociList());
+
 	//@}
 
 	/** @name utility functions, set subpopulation, save and load etc.
@@ -1165,6 +1360,23 @@ public:
 		const floatList & IDs = vectorf(), const string & idField = "ind_id",
 		PyObject * filter = NULL);
 
+	/** Keep individual(s) by absolute indexes (parameter \e indexes), their
+	 *  IDs (parameter \e IDs) at information field \e idField (default to
+	 *  \c "ind_id"), or a filter function (parameter \e filter), and remove
+	 *  all other individuals. The parameters are interpreted as in function
+	 *  <tt>removeIndividuals</tt>, except that matching individuals are
+	 *  kept instead of removed. This is the in-place counterpart of
+	 *  function <tt>extractIndividuals</tt>: retained genotypes and
+	 *  information fields are compacted within the existing storage, so
+	 *  peak memory usage does not include a second copy of the sample.
+	 *  Unlike <tt>extractIndividuals</tt>, ancestral generations and
+	 *  subpopulation structure of the population are kept.
+	 *  <group>7-manipulate</group>
+	 */
+	void keepIndividuals(const uintList & indexes = vectoru(),
+		const floatList & IDs = vectorf(), const string & idField = "ind_id",
+		PyObject * filter = NULL);
+
 	/** Merge subpopulations \e subPops. If \e subPops is \c ALL_AVAIL (default),
 	 *  all subpopulations will be merged. \e subPops do not have to be adjacent
 	 *  to each other. They will all be merged to the subpopulation with the
@@ -1299,6 +1511,38 @@ public:
 		const floatList & IDs = vectorf(), const string & idField = "ind_id",
 		PyObject * filter = NULL) const;
 
+	/** Randomly choose individuals from the present generation without
+	 *  replacement and return them as a new one-generational population.
+	 *  If a single number is given in \e sizes, individuals are drawn from
+	 *  the whole population, otherwise one number per subpopulation has to
+	 *  be given and individuals are drawn from each subpopulation
+	 *  separately. Individuals are chosen directly in the population object
+	 *  (no index list is passed around), so this function is preferred over
+	 *  shuffling indexes and calling <tt>extractIndividuals</tt> for large
+	 *  populations. Sample sizes exceeding the number of available
+	 *  individuals are reduced to it. Extracted individuals keep their
+	 *  original subpopulations.
+	 *  <group>7-manipulate</group>
+	 */
+	Population & randomSample(const uintList & sizes) const;
+
+	/** Randomly choose \e cases affected and \e controls unaffected
+	 *  individuals from the present generation without replacement and
+	 *  return them as a new one-generational population. If single numbers
+	 *  are given, individuals are drawn from the whole population, otherwise
+	 *  one number of cases and controls per subpopulation has to be given
+	 *  and individuals are drawn from each subpopulation separately.
+	 *  Affection status is examined and individuals are chosen directly in
+	 *  the population object, so this function is preferred over collecting
+	 *  and shuffling indexes of affected individuals for large populations.
+	 *  Numbers exceeding the count of available affected or unaffected
+	 *  individuals are reduced to it. Extracted individuals keep their
+	 *  original subpopulations.
+	 *  <group>7-manipulate</group>
+	 */
+	Population & caseControlSample(const uintList & cases,
+		const uintList & controls) const;
+
 	/** Extract subsets of individuals, loci and/or information fields from the
 	 *  current population and create a new population. By default, all
 	 *  genotypes and information fields for all individuals in all ancestral
@@ -1322,6 +1566,14 @@ public:
 	/** Remove \e loci (absolute indexes or names) and genotypes at these loci
 	 *  from the current population. Alternatively, a parameter \e keep can be
 	 *  used to specify loci that will not be removed.
+	 *  \note Both this function and \c extract copy the retained genotypes.
+	 *  A read-only view that shares the genotype array of this population
+	 *  but exposes a subset of loci is not feasible in this design: the
+	 *  position of an allele is computed by plain pointer arithmetic from
+	 *  a locus index, so a view would need an index translation on every
+	 *  allele access, for all modules. To analyze a marker subset without
+	 *  copying, pass the loci of interest to the \e loci parameter of the
+	 *  statistics or export operator instead of extracting a population.
 	 *  <group>7-manipulate</group>
 	 */
 	void removeLoci(const lociList & loci = lociList(NULL), const lociList & keep = lociList(NULL));
@@ -1381,6 +1633,17 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  Return the number of ancestral generations this population is set to
+	 *  keep (c.f. \c setAncestralDepth()), which may be larger than the
+	 *  number currently stored.
+	 */
+	int ancestralDepth() const
+	{
+		return m_ancestralGens;
+	}
+
+
 	/** CPPONLY
 	 *  clear all information field.
 	 */
@@ -1408,6 +1671,25 @@ public:
 	void setIndInfo(const floatList & values, const uintString & field,
 		vspID subPop = vspID());
 
+	/** Apply a pipeline of arithmetic operations to the information fields
+	 *  of all individuals (if <tt>subPop=[]</tt>, default), or of
+	 *  individuals in a (virtual) subpopulation (<tt>subPop=sp</tt> or
+	 *  <tt>(sp, vsp)</tt>), in a single pass over the population. Each step
+	 *  is described by the name of a target field in \e fields, an operator
+	 *  in \e ops (one of <tt>"="</tt>, <tt>"+"</tt>, <tt>"-"</tt>,
+	 *  <tt>"*"</tt>, <tt>"/"</tt>, <tt>"min"</tt> and <tt>"max"</tt>), and
+	 *  an operand in \e operands that is either the name of an information
+	 *  field or a number. Steps are applied in the given order to each
+	 *  individual, so later steps see values written by earlier ones. For
+	 *  example, <tt>pop.transformInfo(['age', 'fitness'], ['+', '*'],
+	 *  ['1', 'survival'])</tt> increases field \c age by one and multiplies
+	 *  field \c fitness by field \c survival, without extracting and
+	 *  writing back a Python list for each field.
+	 *  <group>8-info</group>
+	 */
+	void transformInfo(const stringList & fields, const stringList & ops,
+		const stringList & operands, vspID subPop = vspID());
+
 
 	/// CPPONLY info iterator
 	IndInfoIterator infoBegin(size_t idx)
@@ -1523,6 +1805,21 @@ public:
 	 */
 	void setAncestralDepth(int depth);
 
+	/** Spill ancestral generations beyond the most recent \e cacheGens to an
+	 *  on-disk log \e filename, so that a population evolved with
+	 *  <tt>ancGen=-1</tt> keeps unlimited history at bounded memory usage.
+	 *  Whenever a new generation is pushed, ancestral generations deeper than
+	 *  \e cacheGens are appended to the log and their memory is released;
+	 *  they are read back transparently when they are accessed (e.g. by
+	 *  \c useAncestralGen or \c ancestor). The log is private to this
+	 *  population, is only valid for its lifetime, and grows append-only, so
+	 *  a generation that is read back and spilled again is written anew.
+	 *  Calling this function with an empty \e filename reads all spilled
+	 *  generations back and disables spilling.
+	 *  <group>6-ancestral</group>
+	 */
+	void setAncestralSpill(const string & filename = string(), int cacheGens = 1);
+
 	/// CPPONLY remove certain ancestral generations
 	void keepAncestralGens(const uintList & ancGens);
 
@@ -1548,11 +1845,54 @@ public:
 	 */
 	void syncIndPointers(bool infoOnly = false) const;
 
+	/** Return a dictionary with the approximate number of bytes used by each
+	 *  component of a population: key \c 'genotype' for the genotype of the
+	 *  present generation (for the mutant module this includes the estimated
+	 *  per-mutant overhead of the underlying ordered map), \c 'lineage' for
+	 *  allele lineage (zero for modules without lineage support), \c 'info'
+	 *  for information fields, \c 'individuals' for the individual objects,
+	 *  \c 'ancestralGens' for the same components summed over all stored
+	 *  ancestral generations, \c 'total' for the sum of the above, and
+	 *  \c 'peak' for the largest total seen so far by this population. The
+	 *  peak is refreshed by this function and whenever a generation is
+	 *  pushed (during evolution) or individuals are added, so it can be
+	 *  inspected after an evolutionary process to right-size memory without
+	 *  a heap profiler.
+	 *  <group>8-pop</group>
+	 */
+	PyObject * memoryProfile() const;
+
+	/// CPPONLY refresh and return the peak memory footprint of this
+	/// population in bytes, as reported by memoryProfile().
+	size_t memPeak() const
+	{
+		memSize();
+		return m_memPeak;
+	}
+
+
+	/** CPPONLY
+	 *  Bytes of the genotype, lineage, info and individual arrays of the
+	 *  present generation, excluding stored ancestral generations. Used by
+	 *  Simulator.estimate() to project the footprint of future generations.
+	 */
+	size_t genBytes() const;
+
+	/// CPPONLY total bytes of genotype, lineage, info and individual arrays
+	/// of the present and all ancestral generations; refreshes m_memPeak.
+	size_t memSize() const;
+
 	/** Save population to a file \e filename, which can be loaded by a global
-	 *  function <tt>loadPopulation(filename)</tt>.
+	 *  function <tt>loadPopulation(filename)</tt>. In the binary snapshot
+	 *  format (filename ending in ".bin"), parameter \e base can name a
+	 *  previously saved snapshot; blobs whose content is unchanged are then
+	 *  written as references into \e base instead of being re-serialized,
+	 *  which makes periodic checkpoints of mostly-stable populations much
+	 *  cheaper. Loading such a delta snapshot requires its base snapshot
+	 *  (and the base's own base, if any) to remain available.
 	 *  <group>8-pop</group>
 	 */
-	void save(const string & filename) const;
+	void save(const string & filename, const string & base = string()) const;
 
 	/** CPPONLY load Population from file \e filename
 	 *  <group>8-pop</group>
@@ -1570,6 +1910,23 @@ public:
 	PyObject * vars(vspID subPop = vspID());
 
 
+	/** Keep only the most recent \e keep top-level population variables
+	 *  whose names start with \e prefix, removing older matching variables
+	 *  whenever a new one is set. If a \e file is given, removed variables
+	 *  are appended to it as <tt>name = repr(value)</tt> lines so that the
+	 *  full history of a long unattended run is preserved on disk while
+	 *  the population holds a bounded number of variables in memory.
+	 *  Variables that already match \e prefix are subjected to the policy
+	 *  immediately. Calling this function again with the same \e prefix
+	 *  replaces the previous policy.
+	 *  <group>9-var</group>
+	 */
+	void setVarRetention(const string & prefix, size_t keep = 1, const string & file = string())
+	{
+		m_vars.setVarRetention(prefix, keep, file);
+	}
+
+
 	/// CPPONLY The same as vars(), but without increasing reference count.
 	PyObject * dict(vspID subPop = vspID());
 
@@ -1680,6 +2037,15 @@ private:
 
 	/// store previous populations
 	/// need to store: subPopSize, genotype and m_inds
+	///
+	/// Ancestral generations are stored by swapping the parental arrays
+	/// into this ring (see Population::push), never by copying, so their
+	/// footprint is the retained data itself. Sharing unchanged genotype
+	/// pages with the live generation copy-on-write was considered and
+	/// rejected: individuals and operators hold GenoIterator, a raw
+	/// pointer into m_genotype in most modules, so a page table would
+	/// add an indirection to every allele access. Use the mutant module
+	/// or fewer ancestral generations plus saved snapshots to cut RSS.
 	struct popData
 	{
 		vectoru m_subPopSize;
@@ -1698,13 +2064,37 @@ private:
 		vector<Individual> m_inds;
 		bool m_indOrdered;
 
+		// when m_spilled is set the arrays above are empty and the
+		// record's payload lives at m_spillOffset in the spill log
+		// (see Population::setAncestralSpill)
+		bool m_spilled;
+		size_t m_spillOffset;
+		size_t m_spillSize;
+
+		popData() : m_indOrdered(false), m_spilled(false),
+			m_spillOffset(0), m_spillSize(0)
+		{
+		}
+
+
 		// swap between a popData and existing data.
 		void swap(Population & pop);
 
+		// swap the content of two popData records, used to recycle the
+		// buffers of a discarded record.
+		void swap(popData & rhs);
+
 	};
 
 	std::deque<popData> m_ancestralPops;
 
+	/// spill log for ancestral generations, empty when spilling is disabled
+	string m_spillFile;
+
+	/// number of most recent ancestral generations kept in memory when
+	/// spilling is enabled
+	int m_spillGens;
+
 	/// current ancestral depth
 	int m_curAncestralGen;
 
@@ -1712,9 +2102,92 @@ private:
 	/// within a population.
 	mutable bool m_indOrdered;
 
+	/// subpopulations whose individuals were reordered within the
+	/// subpopulation, recorded for subpopulation-local restoration. Only
+	/// meaningful when m_indOrdered is false; an empty list then means
+	/// that the whole population has to be rebuilt. Transient.
+	mutable vectoru m_unorderedSubPops;
+
 	mutable size_t m_gen;
 	mutable size_t m_rep;
 
+	/// a counter that is bumped whenever genotypes or population structure
+	/// are modified. Cached statistics (e.g. allele counts) record the value
+	/// of this counter when they are computed and are discarded when it no
+	/// longer matches. This member is transient and is not saved.
+	mutable size_t m_genoModCount;
+
+	/// when set, save()/load() archive functions skip the genotype, info
+	/// and lineage payloads, which are stored as raw binary blobs by the
+	/// snapshot format of saveSnapshot()/loadSnapshot(). Transient.
+	mutable bool m_blobMode;
+
+	/// transient cache of allele counts used by statAlleleFreq, keyed by
+	/// locus, subpopulation, and virtual subpopulation, valid as long as
+	/// m_alleleCntStamp == m_genoModCount.
+	typedef std::map<std::pair<size_t, std::pair<size_t, size_t> >,
+	                 std::pair<uintDict, size_t> > ALLELECNTCACHE;
+	mutable ALLELECNTCACHE m_alleleCntCache;
+	mutable size_t m_alleleCntStamp;
+
+	/// last seen value of g_indGenoModCount, which individual-level
+	/// genotype writes bump because they cannot reach this population.
+	/// statCachesCurrent() translates a change of that counter into
+	/// markGenoModified(). Transient.
+	mutable ATOMICLONG m_indModStamp;
+
+	/// loci modified since the caches were stamped, when all modifications
+	/// in that interval were locus-scoped (m_modsScoped). A modification
+	/// without locus information dirties the whole genome and clears the
+	/// scoped flag. Transient.
+	mutable std::set<size_t> m_dirtyLoci;
+	mutable bool m_modsScoped;
+
+	/// transient caches of heterozygote/homozygote counts and genotype
+	/// counts, keyed and invalidated in the same way as m_alleleCntCache.
+	/// They allow one genotype scan to serve the allele, heterozygote and
+	/// genotype frequency components of a single Stat call.
+	typedef std::map<std::pair<size_t, std::pair<size_t, size_t> >,
+	                 std::pair<double, double> > HETEROCNTCACHE;
+	mutable HETEROCNTCACHE m_heteroCntCache;
+	typedef std::map<std::pair<size_t, std::pair<size_t, size_t> >,
+	                 std::pair<tupleDict, size_t> > GENOCNTCACHE;
+	mutable GENOCNTCACHE m_genoCntCache;
+
+	/// transient cache of genotype digests keyed by subpopulation (with
+	/// InvalidValue standing for the whole population), invalidated in the
+	/// same way as m_alleleCntCache.
+	mutable std::map<size_t, uint64_t> m_digestCache;
+
+	/// transient caches of the expansion of ALL_AVAIL subpopulation
+	/// specifications. The content of either list is fully determined by
+	/// the number of (virtual) subpopulations, so allSubPops() validates
+	/// them by size and last element instead of a modification counter.
+	mutable subPopList::vectorvsp m_allSubPopCache;
+	mutable subPopList::vectorvsp m_allVSPCache;
+
+	/// CPPONLY discard entries of the statistics caches that were computed
+	/// before the last modification of the population. Return true if the
+	/// cached entries are still usable.
+	bool statCachesCurrent() const;
+
+	/// high-water mark of the total bytes reported by memoryProfile(),
+	/// refreshed by push() and addIndFrom(). Transient, not saved.
+	mutable size_t m_memPeak;
+
+	/// CPPONLY append ancestral record \e genIdx (1-based) to the spill log
+	/// and release its memory. No-op for records that are already spilled.
+	void spillAncestralGen(size_t genIdx) const;
+
+	/// CPPONLY read ancestral record \e genIdx back from the spill log.
+	/// No-op for records that are in memory.
+	void fetchAncestralGen(size_t genIdx) const;
+
+	/// CPPONLY spill all in-memory ancestral records beyond the cached
+	/// window. No-op when spilling is disabled or an ancestral generation
+	/// is in use.
+	void spillExcessGens() const;
+
 public:
 	/** CPPONLY
 	 *  current replicate in a simulator which is not meaningful for a stand-alone population
@@ -1753,12 +2226,193 @@ public:
 	}
 
 
+	/** CPPONLY
+	 *  Mark genotypes or population structure as modified, which invalidates
+	 *  all cached statistics such as the allele counts kept for repeated
+	 *  calls to Stat(alleleFreq). This is called from functions that modify
+	 *  genotypes (setGenotype, mutators), replace a generation (push), or
+	 *  change subpopulation membership (e.g. migration).
+	 */
+	void markGenoModified() const
+	{
+		++m_genoModCount;
+		m_modsScoped = false;
+	}
+
+
+	/** CPPONLY
+	 *  Mark only \e loci as modified. Cached statistics computed at these
+	 *  loci are discarded by the next Stat call while entries at untouched
+	 *  loci survive, so an operator that perturbs a small genomic region
+	 *  (e.g. a hotspot mutator restricted to one chromosome) does not force
+	 *  monitoring of the rest of the genome to be recomputed. Genotype
+	 *  digests cover the whole genome and are always invalidated.
+	 */
+	void markGenoModified(const vectoru & loci) const
+	{
+		++m_genoModCount;
+		if (m_modsScoped)
+			m_dirtyLoci.insert(loci.begin(), loci.end());
+	}
+
+
+	/** CPPONLY
+	 *  Return the current value of the modification counter, which is
+	 *  incremented whenever genotypes or population structure change. Callers
+	 *  can compare saved values against this counter to decide whether cached
+	 *  population-dependent results are still valid.
+	 */
+	size_t genoModCount() const
+	{
+		return m_genoModCount;
+	}
+
+
+	/** CPPONLY
+	 *  Return cached allele counts at locus \e loc for (virtual)
+	 *  subpopulation \e vsp, and set \e allAlleles to the total number of
+	 *  counted alleles. Return NULL if no entry has been cached since the
+	 *  population was last modified. Cache entries from previous generations
+	 *  are discarded on first access.
+	 */
+	const uintDict * cachedAlleleCnt(size_t loc, vspID vsp, size_t & allAlleles) const;
+
+	/** CPPONLY
+	 *  Record allele counts \e cnt (with \e allAlleles counted alleles in
+	 *  total) at locus \e loc for (virtual) subpopulation \e vsp so that
+	 *  repeated stat calls within a generation do not rescan genotypes.
+	 */
+	void cacheAlleleCnt(size_t loc, vspID vsp, const uintDict & cnt, size_t allAlleles) const;
+
+	/** CPPONLY
+	 *  Retrieve cached heterozygote and homozygote counts at locus \e loc
+	 *  for (virtual) subpopulation \e vsp into \e hetero and \e homo.
+	 *  Return \c false if no entry has been cached since the population was
+	 *  last modified.
+	 */
+	bool cachedHeteroCnt(size_t loc, vspID vsp, double & hetero, double & homo) const;
+
+	/** CPPONLY
+	 *  Record heterozygote count \e hetero and homozygote count \e homo at
+	 *  locus \e loc for (virtual) subpopulation \e vsp.
+	 */
+	void cacheHeteroCnt(size_t loc, vspID vsp, double hetero, double homo) const;
+
+	/** CPPONLY
+	 *  Return cached genotype counts at locus \e loc for (virtual)
+	 *  subpopulation \e vsp, and set \e allGenotypes to the total number of
+	 *  counted genotypes. Return NULL if no entry has been cached since the
+	 *  population was last modified.
+	 */
+	const tupleDict * cachedGenoCnt(size_t loc, vspID vsp, size_t & allGenotypes) const;
+
+	/** CPPONLY
+	 *  Record genotype counts \e cnt (with \e allGenotypes counted genotypes
+	 *  in total) at locus \e loc for (virtual) subpopulation \e vsp.
+	 */
+	void cacheGenoCnt(size_t loc, vspID vsp, const tupleDict & cnt, size_t allGenotypes) const;
+
+	/** CPPONLY
+	 *  Save this population to \e filename in the binary snapshot format,
+	 *  where genotypes, information fields and lineages are stored as
+	 *  page-aligned binary blobs after a small metadata archive. This is
+	 *  used by save() when \e filename ends in ".bin". If \e base names a
+	 *  usable snapshot of the same module, per-generation blobs already
+	 *  present in its chain are written as references instead of data.
+	 */
+	void saveSnapshot(const string & filename, const string & base = string()) const;
+
+	/** CPPONLY
+	 *  Load a population saved by saveSnapshot(). Return false (without
+	 *  modifying this population) if \e filename is not a binary snapshot,
+	 *  so that load() can fall back to the archive format. The file is
+	 *  memory-mapped on platforms that support it, so blob pages are
+	 *  shared between worker processes loading the same snapshot.
+	 */
+	bool loadSnapshot(const string & filename);
+
+	/** Return the content of this population as a Python \c bytes object in
+	 *  the binary snapshot format of saveSnapshot(). Together with function
+	 *  \c fromBytes, this provides an efficient pickle path for populations
+	 *  (registered as <tt>Population.__reduce__</tt>), which avoids the
+	 *  compressed text archive used by save().
+	 *  <group>8-pop</group>
+	 */
+	PyObject * toBytes() const;
+
+	/** Replace the content of this population by the binary snapshot in
+	 *  bytes object \e data, which should have been created by \c toBytes
+	 *  of a module with the same allele type. A \c ValueError will be
+	 *  raised if \e data is not such a snapshot.
+	 *  <group>8-pop</group>
+	 */
+	void fromBytes(PyObject * data);
+
+	/** Transfer the storage of this population to a new population object,
+	 *  which is returned, and leave this population in the state of a newly
+	 *  created empty population. Unlike clone(), no genotypes are copied,
+	 *  so this is the preferred way to hand a population that is no longer
+	 *  needed under its current name to another owner.
+	 *  <group>1-pop</group>
+	 */
+	Population & release();
+
+private:
+	/// CPPONLY write a binary snapshot of this population to stream \e out,
+	/// referencing blobs of snapshot \e base if one is given.
+	void writeSnapshot(std::ostream & out, const string & base) const;
+
+	/// CPPONLY load the binary snapshot in the memory range (\e data,
+	/// \e size), with \e name used in error messages. Return false
+	/// (without modifying this population) if the range does not start
+	/// with a snapshot header of this module.
+	bool parseSnapshot(const char * data, size_t size, const string & name);
+
 };
 
 /** load a population from a file saved by <tt>Population::save()</tt>.
+ *  When many replicate processes on one node start from the same founder
+ *  panel, load it once in a parent process from a binary snapshot (a
+ *  filename ending in ".bin") and \c fork (e.g. with the \c fork start
+ *  method of \c multiprocessing) one worker per replicate: the operating
+ *  system then maps the founder genotypes of all workers to the same
+ *  physical pages and copies only what a worker modifies, so the founder
+ *  panel is resident roughly once instead of once per replicate.
  */
 Population & loadPopulation(const string & file);
 
+/** Import a population from a VCF file \e file, which can be compressed by
+ *  gzip (with filename extension \c .gz). The genotypic structure of the
+ *  population is determined from the \c CHROM, \c POS and \c ID columns of
+ *  the file in a first scanning pass, with loci named after record IDs if
+ *  all records carry an unique ID. Allele calls (\c 0 for the reference
+ *  allele, <tt>1, 2, ...</tt> for alternative alleles, and \c 0 for missing
+ *  calls) are then streamed, in parallel if multiple threads are used,
+ *  directly into the genotype of the samples, which form a single
+ *  subpopulation. The ploidy of the population (1 or 2) is determined from
+ *  the genotype of the first record. A \c ValueError will be raised if an
+ *  allele does not fit the allele type of the current module.
+ */
+Population & importVCF(const string & file);
+
+/** Import a population from a binary genotype matrix \e file, which can be
+ *  compressed by gzip (with filename extension \c .gz) and is typically
+ *  written by operator \c ExportGenotype. The file header determines the
+ *  ploidy, the number of individuals and the number of loci of the imported
+ *  population, whose individuals form a single subpopulation with all loci
+ *  placed on one chromosome. The locus-major blocks of the file (raw allele
+ *  values, packed bits or sparse (row, value) pairs, as stated by the
+ *  header) are decoded, in parallel if multiple threads are used, directly
+ *  into the genotype storage of the current module. Because the layout is a
+ *  plain matrix with a 7-field header, such files can also be produced
+ *  directly from the genotype matrix of external tools, for example from
+ *  the output of a coalescent simulator, to create the founder generation
+ *  of a forward simulation without a text intermediate. Values are stored
+ *  in native byte order and a \c ValueError will be raised if an allele
+ *  does not fit the allele type of the current module.
+ */
+Population & importGenotype(const string & file);
+
 }
 
 
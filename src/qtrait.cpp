@@ -58,11 +58,27 @@ bool BaseQuanTrait::apply(Population & pop) const
 			if (sp->isVirtual())
 				pop.activateVirtualSubPop(*sp);
 
-			IndIterator ind = pop.indIterator(sp->subPop());
-			for (; ind.valid(); ++ind) {
-				qtrait(&*ind, pop.gen(), traits);
-				for (size_t i = 0; i < infoSize(); ++i)
-					ind->setInfo(traits[i], infoIdx[i]);
+			if (numThreads() > 1 && parallelizable()) {
+#pragma omp parallel
+				{
+#ifdef _OPENMP
+					// trait values are evaluated into a per-thread buffer
+					vectorf myTraits(infoSize());
+					IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
+					for (; ind.valid(); ++ind) {
+						qtrait(&*ind, pop.gen(), myTraits);
+						for (size_t i = 0; i < infoSize(); ++i)
+							ind->setInfo(myTraits[i], infoIdx[i]);
+					}
+#endif
+				}
+			} else {
+				IndIterator ind = pop.indIterator(sp->subPop());
+				for (; ind.valid(); ++ind) {
+					qtrait(&*ind, pop.gen(), traits);
+					for (size_t i = 0; i < infoSize(); ++i)
+						ind->setInfo(traits[i], infoIdx[i]);
+				}
 			}
 
 			if (sp->isVirtual())
@@ -90,12 +106,35 @@ bool BaseQuanTrait::applyDuringMating(Population & pop, Population & offPop, Raw
 }
 
 
+void PyQuanTrait::resolveFields(const GenoStruTrait & trait) const
+{
+	if (m_fieldStruIdx == trait.genoStruIdx())
+		return;
+	// name lookups for information field arguments are done here once per
+	// genotypic structure rather than for every individual
+	m_fieldIdx.assign(m_func.numArgs(), 0);
+	for (size_t i = 0; i < m_func.numArgs(); ++i) {
+		const string & arg = m_func.arg(i);
+		if (arg == "ind" || arg == "geno" || arg == "mut" || arg == "gen")
+			continue;
+		DBG_FAILIF(!trait.hasInfoField(arg), ValueError,
+			"Only parameters 'ind', 'geno', 'gen', and names of information fields are "
+			"acceptable in function " + m_func.name());
+		m_fieldIdx[i] = trait.infoIdx(arg);
+	}
+	m_fieldStruIdx = trait.genoStruIdx();
+}
+
+
 void PyQuanTrait::qtrait(Individual * ind, size_t gen, vectorf & traits) const
 {
+	GILGuard gil;
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
 
+	resolveFields(*ind);
+
 	for (size_t i = 0; i < m_func.numArgs(); ++i) {
 		const string & arg = m_func.arg(i);
 		if (arg == "ind")
@@ -106,12 +145,8 @@ void PyQuanTrait::qtrait(Individual * ind, size_t gen, vectorf & traits) const
 			PyTuple_SET_ITEM(args, i, ind->mutAtLoci(m_loci));
 		else if (arg == "gen")
 			PyTuple_SET_ITEM(args, i, PyInt_FromLong(static_cast<long>(gen)));
-		else {
-			DBG_FAILIF(!ind->hasInfoField(arg), ValueError,
-				"Only parameters 'ind', 'geno', 'gen', and names of information fields are "
-				"acceptable in function " + m_func.name());
-			PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(ind->info(arg)));
-		}
+		else
+			PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(ind->info(m_fieldIdx[i])));
 	}
 
 	PyObject * res = PyEval_CallObject(m_func.func(), args);
@@ -139,4 +174,43 @@ void PyQuanTrait::qtrait(Individual * ind, size_t gen, vectorf & traits) const
 }
 
 
+void AdditiveQuanTrait::qtrait(Individual * ind, size_t /* gen */, vectorf & traits) const
+{
+	const vectoru & loci = m_loci.elems(ind);
+
+	// the list of effect sizes has to cover the trait loci, which are only
+	// known here if loci were given as names or as ALL_AVAIL
+	if (loci.size() != m_effects.size())
+		throw ValueError((boost::format("%1% effect sizes are given for %2% trait loci.")
+			              % m_effects.size() % loci.size()).str());
+	double trait = m_baseline;
+
+#ifdef MUTANTALLELE
+	// only mutants are stored, so the dot product reduces to a merge of
+	// the mutant list of this individual with the effect size vector
+	GenoIterator git = ind->genoBegin();
+	GenoIterator git_end = ind->genoEnd();
+	vectorm::val_iterator vit = git.get_val_iterator();
+	vectorm::val_iterator vit_end = git_end.get_val_iterator();
+	size_t indIndex = git.index();
+	size_t totNumLoci = ind->totNumLoci();
+	for (; vit != vit_end; ++vit) {
+		size_t idx = m_loci.indexOf((vit->first - indIndex) % totNumLoci);
+		if (idx != NOT_FOUND)
+			trait += m_effects[idx];
+	}
+#else
+	size_t ply = ind->ploidy();
+	for (size_t i = 0; i < loci.size(); ++i) {
+		size_t dose = 0;
+		for (size_t p = 0; p < ply; ++p)
+			dose += ind->allele(loci[i], static_cast<ssize_t>(p)) != 0 ? 1 : 0;
+		if (dose > 0)
+			trait += m_effects[i] * static_cast<double>(dose);
+	}
+#endif
+	traits[0] = trait;
+}
+
+
 }
@@ -106,6 +106,14 @@ public:
 	bool applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
 		Individual * dad = NULL, Individual * mom = NULL) const;
 
+	/// CPPONLY a quantitative trait operator that works on the present
+	/// generation only can join a fused per-individual sweep, in which
+	/// applyDuringMating stands in for apply() on each individual
+	virtual bool fusable() const
+	{
+		return m_ancGens.unspecified();
+	}
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -153,7 +161,7 @@ public:
 		const intList & at = vectori(), const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		BaseQuanTrait(ancGens, begin, end, step, at, reps, subPops, infoFields),
-		m_func(func), m_loci(loci)
+		m_func(func), m_loci(loci), m_fieldIdx(), m_fieldStruIdx(MaxTraitIndex)
 	{
 		DBG_ASSERT(m_func.isValid(), ValueError, "Passed variable is not a callable python function.");
 
@@ -180,11 +188,96 @@ public:
 
 
 private:
+	/// CPPONLY resolve information field arguments of m_func for a genotypic structure
+	void resolveFields(const GenoStruTrait & trait) const;
+
 	/// user supplied python function
 	const pyFunc m_func;
 
 	/// susceptibility loci
 	const lociList m_loci;
+
+	/// indexes of information field arguments, valid for m_fieldStruIdx
+	mutable vectoru m_fieldIdx;
+
+	/// genotypic structure for which m_fieldIdx was resolved
+	mutable TraitIndexType m_fieldStruIdx;
+};
+
+
+/** This quantitative trait operator assigns a trait field as the weighted
+ *  sum of mutant dosages at specified loci. It is the native equivalent of
+ *  an additive \c PyQuanTrait model and avoids calling a Python function
+ *  for each individual, which makes it suitable for genomic-prediction
+ *  simulations that re-evaluate tens of thousands of causal loci every
+ *  generation.
+ */
+class AdditiveQuanTrait : public BaseQuanTrait
+{
+public:
+	/** Create an additive quantitative trait operator that assigns, to the
+	 *  single trait field specified by parameter \e infoFields (default to
+	 *  \c trait), the sum over specified \e loci (a list of indexes, names,
+	 *  or \c ALL_AVAIL) of an effect size for each non-wildtype (non-zero)
+	 *  allele an individual carries at a locus. Parameter \e effects should
+	 *  list one effect size per specified locus. A homozygous mutant at a
+	 *  locus therefore contributes twice the effect of a heterozygote in a
+	 *  diploid population. An optional \e baseline is added to each trait
+	 *  value. Unlike \c PyQuanTrait, this operator releases the global
+	 *  interpreter lock and calculates trait values of individuals in
+	 *  parallel if multiple threads are available.
+	 */
+	AdditiveQuanTrait(const lociList & loci = lociList(), const floatList & effects = vectorf(),
+		double baseline = 0, const uintList & ancGens = uintList(NULL),
+		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
+		const intList & reps = intList(), const subPopList & subPops = subPopList(),
+		const stringList & infoFields = stringList("trait")) :
+		BaseQuanTrait(ancGens, begin, end, step, at, reps, subPops, infoFields),
+		m_loci(loci), m_effects(effects.elems()), m_baseline(baseline)
+	{
+		if (infoSize() != 1)
+			throw ValueError("AdditiveQuanTrait assigns a single trait field.");
+		if (m_effects.empty())
+			throw ValueError("Please specify an effect size for each locus.");
+	}
+
+
+	/// HIDDEN Deep copy of an additive quantitative trait operator
+	virtual BaseOperator * clone() const
+	{
+		return new AdditiveQuanTrait(*this);
+	}
+
+
+	/** CPPONLY
+	 *  sum effect sizes over mutant dosages
+	 */
+	virtual void qtrait(Individual * ind, size_t gen, vectorf & traits) const;
+
+	/// CPPONLY trait values of individuals are independent
+	bool parallelizable() const
+	{
+		return true;
+	}
+
+
+	/// HIDDEN
+	string describe(bool format = true) const
+	{
+		(void)format;  // avoid warning about unused parameter
+		return "<simuPOP.AdditiveQuanTrait> an additive quantitative trait model";
+	}
+
+
+private:
+	/// trait loci
+	const lociList m_loci;
+
+	/// effect size of each locus
+	const vectorf m_effects;
+
+	/// trait value of an individual without any mutant
+	const double m_baseline;
 };
 
 }
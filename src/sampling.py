@@ -191,26 +191,18 @@ class RandomSampler(BaseSampler):
             # this will produce self.pop.
             self.prepareSample(input_pop, isSequence(self.sizes))
         #
+        # individuals are chosen by the population object itself, which
+        # avoids building and shuffling an index list of the whole population
         if not isSequence(self.sizes):
-            size = self.sizes
-            if size > self.pop.popSize():
-                print('Warning: sample size %d is greater than population size %d.' % (size, self.pop.popSize()))
-                size = self.pop.popSize()
-            # randomly choose size individuals
-            values = list(range(self.pop.popSize()))
-            random.shuffle(values)
-            indexes = values[:size]
+            if self.sizes > self.pop.popSize():
+                print('Warning: sample size %d is greater than population size %d.' % (self.sizes, self.pop.popSize()))
+            return self.pop.randomSample(sizes=[self.sizes])
         else:
-            indexes = []
             for sp in range(self.pop.numSubPop()):
-                size = self.sizes[sp]
-                if size > self.pop.subPopSize(sp):
+                if self.sizes[sp] > self.pop.subPopSize(sp):
                     print('Warning: sample size (%d) at subpopulation %d is greater than subpopulation size %d ' \
-                        % (size, sp, self.pop.subPopSize(sp)))
-                values = list(range(self.pop.subPopBegin(sp), self.pop.subPopEnd(sp)))
-                random.shuffle(values)
-                indexes.extend(values[:size])
-        return self.pop.extractIndividuals(indexes = indexes)
+                        % (self.sizes[sp], sp, self.pop.subPopSize(sp)))
+            return self.pop.randomSample(sizes=self.sizes)
 
 
 def drawRandomSample(pop, sizes, subPops=ALL_AVAIL):
@@ -302,21 +294,25 @@ class CaseControlSampler(BaseSampler):
         '''Draw a case control sample
         '''
         if self.pop is None:
-            # this will produce self.pop and self.affected and self.unaffected
-            self.prepareSample(input_pop)
+            # only trim the population to the specified subpopulations; cases
+            # and controls are located and drawn by the population object
+            # itself, which avoids building and shuffling index lists of all
+            # affected and unaffected individuals
+            BaseSampler.prepareSample(self, input_pop, isSequence(self.cases))
         #
         if not isSequence(self.cases):
-            random.shuffle(self.affected)
-            random.shuffle(self.unaffected)
-            indexes = self.affected[:self.cases] + self.unaffected[:self.controls]
+            sample = self.pop.caseControlSample(cases=[self.cases], controls=[self.controls])
+            if sample.popSize() < self.cases + self.controls:
+                print('Warning: not enough affected or unaffected individuals to draw %d cases and %d controls.' \
+                    % (self.cases, self.controls))
         else:
-            indexes = []
-            for sp in range(self.pop.numSubPop()):
-                random.shuffle(self.affected[sp])
-                random.shuffle(self.unaffected[sp])
-                indexes.extend(self.affected[sp][:self.cases[sp]])
-                indexes.extend(self.unaffected[sp][:self.controls[sp]])
-        return self.pop.extractIndividuals(indexes = indexes)
+            if len(self.cases) != self.pop.numSubPop():
+                raise ValueError('If an list of cases is given, it should be specified for all subpopulations')
+            sample = self.pop.caseControlSample(cases=self.cases, controls=self.controls)
+            if sample.popSize() < sum(self.cases) + sum(self.controls):
+                print('Warning: not enough affected or unaffected individuals to draw %s cases and %s controls.' \
+                    % (self.cases, self.controls))
+        return sample
 
 
 def drawCaseControlSample(pop, cases, controls, subPops=ALL_AVAIL):
@@ -50,16 +50,43 @@ bool BaseSelector::apply(Population & pop) const
 #pragma omp parallel
 			{
 #ifdef _OPENMP
+#  ifdef MUTANTALLELE
+				double wildTypeFitness = -1.;
+#  endif
 				IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
-				for (; ind.valid(); ++ind)
+				for (; ind.valid(); ++ind) {
+#  ifdef MUTANTALLELE
+					// in sparse-mutation models individuals without any
+					// stored mutant share the wild-type fitness, which is
+					// computed at most once per thread per generation.
+					if (ind->genoBegin().get_val_iterator() == ind->genoEnd().get_val_iterator()) {
+						if (wildTypeFitness < 0)
+							wildTypeFitness = indFitness(pop, ind.rawIter());
+						ind->setInfo(wildTypeFitness, fit_id);
+						continue;
+					}
+#  endif
 					ind->setInfo(indFitness(pop, ind.rawIter()), fit_id);
+				}
 #endif
 			}
 
 		} else {
+#ifdef MUTANTALLELE
+			double wildTypeFitness = -1.;
+#endif
 			IndIterator ind = pop.indIterator(sp->subPop());
-			for (; ind.valid(); ++ind)
+			for (; ind.valid(); ++ind) {
+#ifdef MUTANTALLELE
+				if (ind->genoBegin().get_val_iterator() == ind->genoEnd().get_val_iterator()) {
+					if (wildTypeFitness < 0)
+						wildTypeFitness = indFitness(pop, ind.rawIter());
+					ind->setInfo(wildTypeFitness, fit_id);
+					continue;
+				}
+#endif
 				ind->setInfo(indFitness(pop, ind.rawIter()), fit_id);
+			}
 		}
 		if (sp->isVirtual())
 			pop.deactivateVirtualSubPop(sp->subPop());
@@ -171,22 +198,30 @@ double MaSelector::indFitness(Population & pop, RawIndIterator ind) const
 	UINT index = 0;
 	bool singleST = m_wildtype.size() == 1;
 	const vectoru & loci = m_loci.elems(&pop);
+	// ploidy and locus layout are resolved once per individual; going
+	// through Individual::allele would look them up again for each of the
+	// selected loci.
+	size_t ply = ind->ploidy();
+	GenoIterator geno = ind->genoBegin();
 
-	DBG_FAILIF((ind->ploidy() == 2 && m_fitness.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
-		(ind->ploidy() == 1 && m_fitness.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
+	DBG_FAILIF((ply == 2 && m_fitness.size() != static_cast<UINT>(pow(3., static_cast<double>(loci.size())))) ||
+		(ply == 1 && m_fitness.size() != static_cast<UINT>(pow(2., static_cast<double>(loci.size())))),
 		ValueError, "Please specify fitness for each combination of genotype.");
 
-	for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
-		if (ind->ploidy() == 1) {
-			Allele a = TO_ALLELE(ind->allele(*loc));
+	if (ply == 1) {
+		for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
+			Allele a = TO_ALLELE(DEREF_ALLELE(geno + *loc));
 			if (singleST)
 				index = index * 2 + (ALLELE_AS_UNSINGED(a) != m_wildtype[0]);
 			else
 				index = index * 2 + (find(m_wildtype.begin(), m_wildtype.end(), ALLELE_AS_UNSINGED(a)) == m_wildtype.end());
-		} else if (ind->ploidy() == 2) {
+		}
+	} else if (ply == 2) {
+		size_t totLoci = ind->totNumLoci();
+		for (vectoru::const_iterator loc = loci.begin(); loc != loci.end(); ++loc) {
 			// get genotype of ind
-			Allele a = TO_ALLELE(ind->allele(*loc, 0));
-			Allele b = TO_ALLELE(ind->allele(*loc, 1));
+			Allele a = TO_ALLELE(DEREF_ALLELE(geno + *loc));
+			Allele b = TO_ALLELE(DEREF_ALLELE(geno + *loc + totLoci));
 
 			int numWildtype = 0;
 
@@ -203,9 +238,9 @@ double MaSelector::indFitness(Population & pop, RawIndIterator ind) const
 			}
 
 			index = index * 3 + 2 - numWildtype;
-		} else {
-			DBG_FAILIF(true, ValueError, "The MaSelector only supports haploid and diploid populations.");
 		}
+	} else {
+		DBG_FAILIF(true, ValueError, "The MaSelector only supports haploid and diploid populations.");
 	}
 	return m_fitness[index];
 }
@@ -277,12 +312,35 @@ double MlSelector::indFitness(Population & pop, RawIndIterator ind) const
 }
 
 
+void PySelector::resolveFields(const GenoStruTrait & trait) const
+{
+	if (m_fieldStruIdx == trait.genoStruIdx())
+		return;
+	// resolve information field arguments into indexes only once per
+	// genotypic structure, instead of looking up names for each individual
+	m_fieldIdx.assign(m_func.numArgs(), 0);
+	for (size_t i = 0; i < m_func.numArgs(); ++i) {
+		const string & arg = m_func.arg(i);
+		if (arg == "ind" || arg == "geno" || arg == "mut" || arg == "gen" || arg == "pop")
+			continue;
+		DBG_FAILIF(!trait.hasInfoField(arg), ValueError,
+			"Only parameters 'ind', 'geno', 'gen', 'pop' and names of information fields are "
+			"acceptable in function " + m_func.name());
+		m_fieldIdx[i] = trait.infoIdx(arg);
+	}
+	m_fieldStruIdx = trait.genoStruIdx();
+}
+
+
 double PySelector::indFitness(Population & pop, RawIndIterator ind) const
 {
+	GILGuard gil;
 	PyObject * args = PyTuple_New(m_func.numArgs());
 
 	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
 
+	resolveFields(pop);
+
 	for (size_t i = 0; i < m_func.numArgs(); ++i) {
 		const string & arg = m_func.arg(i);
 		if (arg == "ind")
@@ -295,12 +353,8 @@ double PySelector::indFitness(Population & pop, RawIndIterator ind) const
 			PyTuple_SET_ITEM(args, i, PyInt_FromLong(static_cast<long>(pop.gen())));
 		else if (arg == "pop")
 			PyTuple_SET_ITEM(args, i, pyPopObj(static_cast<void *>(&pop)));
-		else {
-			DBG_FAILIF(!ind->hasInfoField(arg), ValueError,
-				"Only parameters 'ind', 'geno', 'gen', 'pop' and names of information fields are "
-				"acceptable in function " + m_func.name());
-			PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(ind->info(arg)));
-		}
+		else
+			PyTuple_SET_ITEM(args, i, PyFloat_FromDouble(ind->info(m_fieldIdx[i])));
 	}
 
 	double fitness = m_func(PyObj_As_Double, args);
@@ -309,6 +363,90 @@ double PySelector::indFitness(Population & pop, RawIndIterator ind) const
 }
 
 
+void PySelector::blockFitness(Population & pop, const std::vector<RawIndIterator> & block,
+	size_t fitID) const
+{
+	GILGuard gil;
+	PyObject * args = PyTuple_New(m_func.numArgs());
+
+	DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
+
+	resolveFields(pop);
+
+	for (size_t i = 0; i < m_func.numArgs(); ++i) {
+		const string & arg = m_func.arg(i);
+		if (arg == "gen")
+			PyTuple_SET_ITEM(args, i, PyInt_FromLong(static_cast<long>(pop.gen())));
+		else if (arg == "pop")
+			PyTuple_SET_ITEM(args, i, pyPopObj(static_cast<void *>(&pop)));
+		else {
+			// each individual contributes one item, being exactly what the
+			// per-individual call would have received for this parameter.
+			PyObject * items = PyTuple_New(block.size());
+			DBG_ASSERT(items, RuntimeError, "Failed to create a parameter tuple");
+			for (size_t k = 0; k < block.size(); ++k) {
+				if (arg == "geno")
+					PyTuple_SET_ITEM(items, k, block[k]->genoAtLoci(m_loci));
+				else if (arg == "mut")
+					PyTuple_SET_ITEM(items, k, block[k]->mutAtLoci(m_loci));
+				else
+					PyTuple_SET_ITEM(items, k, PyFloat_FromDouble(block[k]->info(m_fieldIdx[i])));
+			}
+			PyTuple_SET_ITEM(args, i, items);
+		}
+	}
+
+	vectorf fitness = m_func(PyObj_As_Array, args);
+	Py_XDECREF(args);
+
+	DBG_FAILIF(fitness.size() != block.size(), ValueError,
+		(boost::format("Function %1% returned %2% fitness values for a block of %3% individuals.")
+		 % m_func.name() % fitness.size() % block.size()).str());
+
+	for (size_t k = 0; k < block.size(); ++k)
+		block[k]->setInfo(fitness[k], fitID);
+}
+
+
+bool PySelector::apply(Population & pop) const
+{
+	// without a batch size individuals are evaluated one by one
+	if (m_batch == 0)
+		return BaseSelector::apply(pop);
+
+	size_t fitID = pop.infoIdx(this->infoField(0));
+
+	subPopList subPops = applicableSubPops(pop);
+
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+
+	std::vector<RawIndIterator> block;
+	block.reserve(m_batch);
+
+	for (; sp != spEnd; ++sp) {
+		if (sp->isVirtual())
+			pop.activateVirtualSubPop(*sp);
+		IndIterator ind = pop.indIterator(sp->subPop());
+		for (; ind.valid(); ++ind) {
+			block.push_back(ind.rawIter());
+			if (block.size() == m_batch) {
+				blockFitness(pop, block, fitID);
+				block.clear();
+			}
+		}
+		if (!block.empty()) {
+			blockFitness(pop, block, fitID);
+			block.clear();
+		}
+		if (sp->isVirtual())
+			pop.deactivateVirtualSubPop(sp->subPop());
+	}
+
+	return true;
+}
+
+
 PyMlSelector::PyMlSelector(PyObject * func, int mode,
 	const lociList & loci, const stringFunc & output, int begin, int end, int step, const intList & at,
 	const intList & reps, const subPopList & subPops, const stringList & infoFields) :
@@ -342,6 +480,57 @@ PyMlSelector::PyMlSelector(PyObject * func, int mode,
 }
 
 
+uint64_t PyMlSelector::mutantSetDigest(RawIndIterator ind, const vectoru & loci, size_t ply) const
+{
+	// 64-bit FNV-1a over (chromosome copy, locus, allele) of every non-zero
+	// site at the selected loci
+	uint64_t h = 14695981039346656037ull;
+
+#ifdef MUTANTALLELE
+	size_t numLoci = ind->totNumLoci();
+	for (size_t p = 0; p < ply; ++p) {
+		GenoIterator it = ind->genoBegin(p);
+		GenoIterator it_end = ind->genoEnd(p);
+		vectorm::val_iterator iit = it.get_val_iterator();
+		vectorm::val_iterator iit_end = it_end.get_val_iterator();
+		for (; iit != iit_end; ++iit) {
+			if (iit->second == 0)
+				continue;
+			size_t loc = iit->first % numLoci;
+			if (!m_loci.allAvail() && find(loci.begin(), loci.end(), loc) == loci.end())
+				continue;
+			h = (h ^ (p + 1)) * 1099511628211ull;
+			h = (h ^ loc) * 1099511628211ull;
+			h = (h ^ static_cast<uint64_t>(iit->second)) * 1099511628211ull;
+		}
+	}
+#else
+	for (size_t p = 0; p < ply; ++p) {
+		GenoIterator it = ind->genoBegin(p);
+		if (m_loci.allAvail()) {
+			GenoIterator it_end = ind->genoEnd(p);
+			for (size_t index = 0; it != it_end; ++it, ++index)
+				if (*it != 0) {
+					h = (h ^ (p + 1)) * 1099511628211ull;
+					h = (h ^ index) * 1099511628211ull;
+					h = (h ^ static_cast<uint64_t>(*it)) * 1099511628211ull;
+				}
+		} else {
+			vectoru::const_iterator loc = loci.begin();
+			vectoru::const_iterator locEnd = loci.end();
+			for (; loc != locEnd; ++loc)
+				if (*(it + *loc) != 0) {
+					h = (h ^ (p + 1)) * 1099511628211ull;
+					h = (h ^ *loc) * 1099511628211ull;
+					h = (h ^ static_cast<uint64_t>(*(it + *loc))) * 1099511628211ull;
+				}
+		}
+	}
+#endif
+	return h;
+}
+
+
 double PyMlSelector::indFitness(Population & pop, RawIndIterator ind) const
 {
 	FitnessAccumulator fit(m_mode);
@@ -352,6 +541,14 @@ double PyMlSelector::indFitness(Population & pop, RawIndIterator ind) const
 	if (ind->isHaplodiploid() && ind->sex() == MALE)
 		ply = 1;
 
+	// an individual whose mutant set has been seen before, this generation
+	// or an earlier one, reuses the combined fitness without looking up
+	// the per-mutant fitness values again
+	uint64_t digest = mutantSetDigest(ind, loci, ply);
+	CombinedFitnessCache::const_iterator hit = m_combinedCache.find(digest);
+	if (hit != m_combinedCache.end())
+		return hit->second;
+
 #ifdef MUTANTALLELE
 	if (ply == 1) {
 		vectora geno(1, TO_ALLELE(0));
@@ -459,12 +656,18 @@ double PyMlSelector::indFitness(Population & pop, RawIndIterator ind) const
 		ValueError("Operator PyMlSelector currently only supports haploid and diploid populations");
 	}
 #endif
-	return fit.value();
+	double value = fit.value();
+	m_combinedCache[digest] = value;
+	return value;
 }
 
 
 bool PyMlSelector::apply(Population & pop) const
 {
+	// the cache of combined fitness values holds one entry per distinct
+	// mutant set and is simply dropped when it grows out of proportion
+	if (m_combinedCache.size() > 1048576)
+		m_combinedCache.clear();
 	m_newGenotypes.clear();
 	if (!BaseSelector::apply(pop))
 		return false;
@@ -494,6 +697,7 @@ bool PyMlSelector::apply(Population & pop) const
 
 double PyMlSelector::getFitnessValue(const LocGenotype & geno) const
 {
+	GILGuard gil;
 	LocGenotype tmp(geno);
 
 	if (geno.second.size() == 2 && geno.second[0] > geno.second[1]) {
@@ -576,6 +780,9 @@ double MutSpaceSelector::indFitness(Population & /* pop */, RawIndIterator ind)
 
 bool MutSpaceSelector::apply(Population & pop) const
 {
+	// pick up mutants that entered m_selFactory since the last rebuild so
+	// that the per-individual passes run against the flat sorted arrays.
+	refreshSelIndex();
 	m_newMutants.clear();
 	if (!BaseSelector::apply(pop))
 		return false;
@@ -596,6 +803,7 @@ bool MutSpaceSelector::apply(Population & pop) const
 
 MutSpaceSelector::SelCoef MutSpaceSelector::getFitnessValue(size_t mutant) const
 {
+	GILGuard gil;
 	size_t sz = m_selDist.size();
 	double s = 0;
 	double h = 0.5;
@@ -648,16 +856,54 @@ MutSpaceSelector::SelCoef MutSpaceSelector::getFitnessValue(size_t mutant) const
 }
 
 
+void MutSpaceSelector::refreshSelIndex() const
+{
+	if (m_selPositions.size() == m_selFactory.size())
+		return;
+	m_selPositions.clear();
+	m_selPositions.reserve(m_selFactory.size());
+	SelMap::const_iterator sit = m_selFactory.begin();
+	SelMap::const_iterator sit_end = m_selFactory.end();
+	for (; sit != sit_end; ++sit)
+		m_selPositions.push_back(sit->first);
+	std::sort(m_selPositions.begin(), m_selPositions.end());
+	m_selCoefs.clear();
+	m_selCoefs.reserve(m_selPositions.size());
+	vectoru::const_iterator pit = m_selPositions.begin();
+	vectoru::const_iterator pit_end = m_selPositions.end();
+	for (; pit != pit_end; ++pit)
+		m_selCoefs.push_back(m_selFactory.find(static_cast<unsigned int>(*pit))->second);
+}
+
+
 double MutSpaceSelector::randomSelAddFitness(GenoIterator it, GenoIterator it_end, bool chrX) const
 {
-	double s = 0;
+	// merge-join the sorted mutant list against the sorted coefficient
+	// arrays so that the common case touches two contiguous arrays
+	// instead of probing m_selFactory for each mutant.
+	vectoru muts;
+
+	for (; it != it_end; ++it)
+		if (*it != 0u)
+			muts.push_back(*it);
+	std::sort(muts.begin(), muts.end());
 
-	for (; it != it_end; ++it) {
-		if (*it == 0u)
+	double s = 0;
+	size_t p = 0;
+	size_t np = m_selPositions.size();
+	vectoru::const_iterator mit = muts.begin();
+	vectoru::const_iterator mit_end = muts.end();
+	for (; mit != mit_end; ++mit) {
+		while (p < np && m_selPositions[p] < *mit)
+			++p;
+		if (p < np && m_selPositions[p] == *mit) {
+			s += m_selCoefs[p].first / 2;
 			continue;
-		SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(*it));
+		}
+		// a mutant drawn after the last rebuild, or a new mutant
+		SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(*mit));
 		if (sit == m_selFactory.end())
-			s += getFitnessValue(*it).first / 2.;
+			s += getFitnessValue(*mit).first / 2.;
 		else
 			s += sit->second.first / 2;
 	}
@@ -670,14 +916,29 @@ double MutSpaceSelector::randomSelAddFitness(GenoIterator it, GenoIterator it_en
 
 double MutSpaceSelector::randomSelExpFitness(GenoIterator it, GenoIterator it_end, bool chrX) const
 {
-	double s = 0;
+	// see randomSelAddFitness for the merge-join over the sorted arrays
+	vectoru muts;
+
+	for (; it != it_end; ++it)
+		if (*it != 0u)
+			muts.push_back(*it);
+	std::sort(muts.begin(), muts.end());
 
-	for (; it != it_end; ++it) {
-		if (*it == 0u)
+	double s = 0;
+	size_t p = 0;
+	size_t np = m_selPositions.size();
+	vectoru::const_iterator mit = muts.begin();
+	vectoru::const_iterator mit_end = muts.end();
+	for (; mit != mit_end; ++mit) {
+		while (p < np && m_selPositions[p] < *mit)
+			++p;
+		if (p < np && m_selPositions[p] == *mit) {
+			s += m_selCoefs[p].first / 2;
 			continue;
-		SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(*it));
+		}
+		SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(*mit));
 		if (sit == m_selFactory.end())
-			s += getFitnessValue(*it).first / 2.;
+			s += getFitnessValue(*mit).first / 2.;
 		else
 			s += sit->second.first / 2;
 	}
@@ -690,35 +951,46 @@ double MutSpaceSelector::randomSelExpFitness(GenoIterator it, GenoIterator it_en
 
 double MutSpaceSelector::randomSelMulFitnessExt(GenoIterator it, GenoIterator it_end, bool chrX) const
 {
-	MutCounter cnt;
+	// sorting the mutant list turns homozygote detection into a scan for
+	// runs of equal positions, and lets the coefficient lookup proceed as
+	// a merge-join over the sorted arrays instead of map probes.
+	vectoru muts;
 
-	for (; it != it_end; ++it) {
-		if (*it == 0u)
-			continue;
-		MutCounter::iterator mit = cnt.find(*it);
-		if (mit == cnt.end())
-			cnt[*it] = 1;
-		else
-			++mit->second;
-	}
+	for (; it != it_end; ++it)
+		if (*it != 0u)
+			muts.push_back(*it);
+	std::sort(muts.begin(), muts.end());
 
 	double s = 1;
-	MutCounter::iterator mit = cnt.begin();
-	MutCounter::iterator mit_end = cnt.end();
-	for (; mit != mit_end; ++mit) {
-		SelMap::iterator sit = m_selFactory.find(mit->first);
-		if (sit == m_selFactory.end()) {
-			SelCoef sf = getFitnessValue(mit->first);
-			if (mit->second == 1 && !chrX)
-				s *= 1 - sf.first * sf.second;
-			else
-				s *= 1 - sf.first;
+	size_t p = 0;
+	size_t np = m_selPositions.size();
+	size_t nm = muts.size();
+	for (size_t i = 0; i < nm; ) {
+		size_t mut = muts[i];
+		size_t copies = 1;
+		for (++i; i < nm && muts[i] == mut; ++i)
+			++copies;
+		double sv, hv;
+		while (p < np && m_selPositions[p] < mut)
+			++p;
+		if (p < np && m_selPositions[p] == mut) {
+			sv = m_selCoefs[p].first;
+			hv = m_selCoefs[p].second;
 		} else {
-			if (mit->second == 1 && !chrX)
-				s *= 1 - sit->second.first * sit->second.second;
-			else
-				s *= 1 - sit->second.first;
+			SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(mut));
+			if (sit == m_selFactory.end()) {
+				SelCoef sf = getFitnessValue(mut);
+				sv = sf.first;
+				hv = sf.second;
+			} else {
+				sv = sit->second.first;
+				hv = sit->second.second;
+			}
 		}
+		if (copies == 1 && !chrX)
+			s *= 1 - sv * hv;
+		else
+			s *= 1 - sv;
 	}
 	return s;
 }
@@ -726,35 +998,44 @@ double MutSpaceSelector::randomSelMulFitnessExt(GenoIterator it, GenoIterator it
 
 double MutSpaceSelector::randomSelAddFitnessExt(GenoIterator it, GenoIterator it_end, bool chrX) const
 {
-	MutCounter cnt;
+	// see randomSelMulFitnessExt for the sorted run scan and merge-join
+	vectoru muts;
 
-	for (; it != it_end; ++it) {
-		if (*it == 0u)
-			continue;
-		MutCounter::iterator mit = cnt.find(*it);
-		if (mit == cnt.end())
-			cnt[*it] = 1;
-		else
-			++mit->second;
-	}
+	for (; it != it_end; ++it)
+		if (*it != 0u)
+			muts.push_back(*it);
+	std::sort(muts.begin(), muts.end());
 
 	double s = 0;
-	MutCounter::iterator mit = cnt.begin();
-	MutCounter::iterator mit_end = cnt.end();
-	for (; mit != mit_end; ++mit) {
-		SelMap::iterator sit = m_selFactory.find(mit->first);
-		if (sit == m_selFactory.end()) {
-			SelCoef sf = getFitnessValue(mit->first);
-			if (mit->second == 1 && !chrX)
-				s += sf.first * sf.second;
-			else
-				s += sf.first;
+	size_t p = 0;
+	size_t np = m_selPositions.size();
+	size_t nm = muts.size();
+	for (size_t i = 0; i < nm; ) {
+		size_t mut = muts[i];
+		size_t copies = 1;
+		for (++i; i < nm && muts[i] == mut; ++i)
+			++copies;
+		double sv, hv;
+		while (p < np && m_selPositions[p] < mut)
+			++p;
+		if (p < np && m_selPositions[p] == mut) {
+			sv = m_selCoefs[p].first;
+			hv = m_selCoefs[p].second;
 		} else {
-			if (mit->second == 1 && !chrX)
-				s += sit->second.first * sit->second.second;
-			else
-				s += sit->second.first;
+			SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(mut));
+			if (sit == m_selFactory.end()) {
+				SelCoef sf = getFitnessValue(mut);
+				sv = sf.first;
+				hv = sf.second;
+			} else {
+				sv = sit->second.first;
+				hv = sit->second.second;
+			}
 		}
+		if (copies == 1 && !chrX)
+			s += sv * hv;
+		else
+			s += sv;
 	}
 	return 1 - s > 0 ? 1 - s : 0;
 }
@@ -762,35 +1043,44 @@ double MutSpaceSelector::randomSelAddFitnessExt(GenoIterator it, GenoIterator it
 
 double MutSpaceSelector::randomSelExpFitnessExt(GenoIterator it, GenoIterator it_end, bool chrX) const
 {
-	MutCounter cnt;
+	// see randomSelMulFitnessExt for the sorted run scan and merge-join
+	vectoru muts;
 
-	for (; it != it_end; ++it) {
-		if (*it == 0u)
-			continue;
-		MutCounter::iterator mit = cnt.find(*it);
-		if (mit == cnt.end())
-			cnt[*it] = 1;
-		else
-			++mit->second;
-	}
+	for (; it != it_end; ++it)
+		if (*it != 0u)
+			muts.push_back(*it);
+	std::sort(muts.begin(), muts.end());
 
 	double s = 0;
-	MutCounter::iterator mit = cnt.begin();
-	MutCounter::iterator mit_end = cnt.end();
-	for (; mit != mit_end; ++mit) {
-		SelMap::iterator sit = m_selFactory.find(mit->first);
-		if (sit == m_selFactory.end()) {
-			SelCoef sf = getFitnessValue(mit->first);
-			if (mit->second == 1 && !chrX)
-				s += sf.first * sf.second;
-			else
-				s += sf.first;
+	size_t p = 0;
+	size_t np = m_selPositions.size();
+	size_t nm = muts.size();
+	for (size_t i = 0; i < nm; ) {
+		size_t mut = muts[i];
+		size_t copies = 1;
+		for (++i; i < nm && muts[i] == mut; ++i)
+			++copies;
+		double sv, hv;
+		while (p < np && m_selPositions[p] < mut)
+			++p;
+		if (p < np && m_selPositions[p] == mut) {
+			sv = m_selCoefs[p].first;
+			hv = m_selCoefs[p].second;
 		} else {
-			if (mit->second == 1 && !chrX)
-				s += sit->second.first * sit->second.second;
-			else
-				s += sit->second.first;
+			SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(mut));
+			if (sit == m_selFactory.end()) {
+				SelCoef sf = getFitnessValue(mut);
+				sv = sf.first;
+				hv = sf.second;
+			} else {
+				sv = sit->second.first;
+				hv = sit->second.second;
+			}
 		}
+		if (copies == 1 && !chrX)
+			s += sv * hv;
+		else
+			s += sv;
 	}
 	return exp(-s);
 }
@@ -441,17 +441,32 @@ public:
 	/** Create a Python hybrid selector that passes genotype at specified
 	 *  \e loci, values at specified information fields (if requested) and
 	 *  a generation number to a user-defined function \e func. The return
-	 *  value will be treated as individual fitness.
+	 *  value will be treated as individual fitness. If a positive \e batch
+	 *  size is given, \e func is called once for each block of up to
+	 *  \e batch individuals instead of once per individual. In this mode
+	 *  parameters \c geno, \c mut and information fields are passed as
+	 *  tuples with one item per individual in the block (each item being
+	 *  what the corresponding per-individual call would have received) and
+	 *  \e func has to return a sequence of fitness values of matching
+	 *  length. A batched function that processes these tuples with
+	 *  vectorized (e.g. numpy) operations avoids the overhead of one
+	 *  Python call per individual. Parameter \c ind is not supported in
+	 *  batched mode.
 	 */
-	PySelector(PyObject * func, lociList loci = vectoru(),
+	PySelector(PyObject * func, lociList loci = vectoru(), size_t batch = 0,
 		int begin = 0, int end = -1, int step = 1,
 		const intList & at = vectori(), const intList & reps = intList(), const stringFunc & output = "",
 		const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList("fitness")) :
 		BaseSelector(output, begin, end, step, at, reps, subPops, infoFields),
-		m_func(func), m_loci(loci)
+		m_func(func), m_loci(loci), m_batch(batch),
+		m_fieldIdx(), m_fieldStruIdx(MaxTraitIndex)
 	{
 		DBG_ASSERT(m_func.isValid(), ValueError, "Passed variable is not a callable python function.");
+
+		if (m_batch > 0 && m_func.hasArg("ind"))
+			throw ValueError("Parameter ind is not supported when function " +
+				m_func.name() + " is called in batched mode.");
 	}
 
 
@@ -467,6 +482,9 @@ public:
 	 */
 	virtual double indFitness(Population & pop, RawIndIterator ind) const;
 
+	/// HIDDEN apply the selector, calling \e func in blocks if \e batch > 0
+	bool apply(Population & pop) const;
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -483,12 +501,28 @@ public:
 
 
 private:
+	/// CPPONLY evaluate fitness of a block of individuals with one call
+	void blockFitness(Population & pop, const std::vector<RawIndIterator> & block,
+		size_t fitID) const;
+
+	/// CPPONLY resolve information field arguments of m_func for a genotypic structure
+	void resolveFields(const GenoStruTrait & trait) const;
+
 	/// user supplied python function
 	const pyFunc m_func;
 
 	/// susceptibility loci
 	const lociList m_loci;
 
+	/// number of individuals passed to each call of m_func (0 for one call per individual)
+	const size_t m_batch;
+
+	/// indexes of information field arguments, valid for m_fieldStruIdx
+	mutable vectoru m_fieldIdx;
+
+	/// genotypic structure for which m_fieldIdx was resolved
+	mutable TraitIndexType m_fieldStruIdx;
+
 };
 
 
@@ -564,6 +598,9 @@ public:
 private:
 	double getFitnessValue(const LocGenotype &) const;
 
+	/// CPPONLY digest of the mutant set of an individual at selected loci
+	uint64_t mutantSetDigest(RawIndIterator ind, const vectoru & loci, size_t ply) const;
+
 	///
 	pyFunc m_func;
 
@@ -578,6 +615,19 @@ private:
 
 	mutable std::vector<LocGenotype> m_newGenotypes;
 	mutable GenoSelMap m_fitnessFactory;
+
+	/// combined fitness of previously seen mutant sets, keyed by a digest
+	/// of the non-zero sites at the selected loci. Entries never go stale
+	/// because per-genotype fitness values are kept for the lifetime of
+	/// the operator in m_fitnessFactory.
+#if TR1_SUPPORT == 0
+	typedef std::map<uint64_t, double> CombinedFitnessCache;
+#elif TR1_SUPPORT == 1
+	typedef std::unordered_map<uint64_t, double> CombinedFitnessCache;
+#else
+	typedef std::tr1::unordered_map<uint64_t, double> CombinedFitnessCache;
+#endif
+	mutable CombinedFitnessCache m_combinedCache;
 };
 
 
@@ -666,6 +716,8 @@ public:
 private:
 	SelCoef getFitnessValue(size_t mutant) const;
 
+	/// rebuild the sorted coefficient arrays from m_selFactory
+	void refreshSelIndex() const;
 
 	double randomSelAddFitness(GenoIterator it, GenoIterator it_end, bool maleChrX) const;
 
@@ -697,6 +749,12 @@ private:
 	typedef std::tr1::unordered_map<size_t, size_t> MutCounter;
 #  endif
 	mutable SelMap m_selFactory;
+	// flat arrays sorted by mutant position, rebuilt from m_selFactory
+	// at the beginning of each application of the operator. The per-
+	// individual hot path searches these contiguous arrays; the map is
+	// only probed for mutants that were drawn after the last rebuild.
+	mutable vectoru m_selPositions;
+	mutable std::vector<SelCoef> m_selCoefs;
 	mutable vectoru m_newMutants;
 	// whether or not all markers are additive.
 	mutable bool m_additive;
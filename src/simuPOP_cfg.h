@@ -149,6 +149,17 @@ typedef unsigned int UINT;
 
 // NOTE: the change of allele type here may need similar changes
 // in the wrapper file simuPOP_common.i
+//
+// The allele width of each module is uniform across loci on purpose. A
+// hybrid layout (e.g. a bit plane for biallelic loci plus an exception
+// table for wider loci) has been considered for workloads that only need
+// wide alleles at a few loci, but it cannot be hidden behind GenoIterator:
+// in the non-mutant modules the iterator is a raw pointer into one
+// contiguous array and operators rely on pointer arithmetic (ptr + loc,
+// per-chromosome ranges, memcpy-style transmission) that has no meaning
+// across two planes. Workloads dominated by rare non-wild-type alleles
+// should use the mutant (mu) module, whose sparse storage provides the
+// memory and bandwidth savings without changing the iterator contract.
 #ifdef LONGALLELE
 //#  ifdef _MSC_VER
 // according to MSVC manual, unsigned int is 32 bit, regardless of
@@ -235,11 +235,16 @@ namespace std
 %ignore simuPOP::IndInfoIterator;
 
 %newobject loadPopulation;
+%newobject importVCF;
+%newobject importGenotype;
 
 //%newobject simuPOP::Population::extract;
 %newobject simuPOP::Population::extractSubPops;
 %newobject simuPOP::Population::extractIndividuals;
+%newobject simuPOP::Population::randomSample;
+%newobject simuPOP::Population::caseControlSample;
 %newobject simuPOP::Population::clone;
+%newobject simuPOP::Population::release;
 %newobject simuPOP::Simulator::extract;
 %newobject simuPOP::Simulator::clone;
 %newobject simuPOP::BaseOperator::clone;
@@ -306,6 +311,7 @@ namespace std
 {
     %template()    vector<simuPOP::vspID >;
     %template()    vector<simuPOP::BaseVspSplitter * >;
+    %template()    vector<simuPOP::Individual * >; /* e.g. pyIndIterator::nextChunk */
 }
 
 %include "virtualSubPop.h"
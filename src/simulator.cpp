@@ -25,11 +25,49 @@
 
 #include "simulator.h"
 
+#include <chrono>
+#include <fstream>
 #include <sstream>
 using std::ostringstream;
 
+// for the physical memory probe of Simulator::estimate()
+#ifndef _WIN32
+#  include <unistd.h>
+#endif
+
+#if PY_VERSION_HEX >= 0x03000000
+#  define PyInt_FromLong(x) PyLong_FromLong(x)
+#endif
+
 namespace simuPOP {
 
+// append one telemetry record in the format documented at
+// Simulator::setTelemetryOutput()
+void writeTelemetryRecord(std::ostream & out, UINT rep, long gen, size_t popSize,
+                          double preSecs, double mateSecs, double postSecs, size_t memPeak)
+{
+	uint32_t r = static_cast<uint32_t>(rep);
+	int64_t g = static_cast<int64_t>(gen);
+	uint64_t n = static_cast<uint64_t>(popSize);
+	double wall = std::chrono::duration<double>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	double total = preSecs + mateSecs + postSecs;
+	uint64_t peak = static_cast<uint64_t>(memPeak);
+
+	out.put('S');
+	out.put('T');
+	out.put(static_cast<char>(1));
+	out.write(reinterpret_cast<const char *>(&r), sizeof(r));
+	out.write(reinterpret_cast<const char *>(&g), sizeof(g));
+	out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+	out.write(reinterpret_cast<const char *>(&wall), sizeof(wall));
+	out.write(reinterpret_cast<const char *>(&total), sizeof(total));
+	out.write(reinterpret_cast<const char *>(&preSecs), sizeof(preSecs));
+	out.write(reinterpret_cast<const char *>(&mateSecs), sizeof(mateSecs));
+	out.write(reinterpret_cast<const char *>(&postSecs), sizeof(postSecs));
+	out.write(reinterpret_cast<const char *>(&peak), sizeof(peak));
+}
+
 Population & pyPopIterator::next()
 {
 	if (m_index == m_end)
@@ -121,12 +159,18 @@ Simulator::~Simulator()
 
 	for (UINT i = 0; i < m_pops.size(); ++i)
 		delete m_pops[i];
+
+	for (UINT i = 0; i < m_popSnapshot.size(); ++i)
+		delete m_popSnapshot[i];
+	freeRNGStates(m_rngSnapshot);
 }
 
 
 Simulator::Simulator(const Simulator & rhs) :
 	m_pops(0),
-	m_scratchPop(NULL)
+	m_scratchPop(NULL),
+	m_trackedVars(rhs.m_trackedVars),
+	m_trackedData(rhs.m_trackedData)
 {
 	m_scratchPop = rhs.m_scratchPop->clone();
 	m_pops = vector<Population *>(rhs.m_pops.size());
@@ -164,6 +208,8 @@ Population & Simulator::extract(UINT rep)
 
 	Population * pop = m_pops[rep];
 	m_pops.erase(m_pops.begin() + rep);
+	if (!m_trackedData.empty())
+		m_trackedData.erase(m_trackedData.begin() + rep);
 	return *pop;
 }
 
@@ -179,6 +225,166 @@ void Simulator::add(const Population & pop, bool steal)
 		m_pops.push_back(new Population(pop));
 	PARAM_FAILIF(m_pops.back() == NULL,
 		RuntimeError, "Fail to add new Population.");
+	if (!m_trackedVars.empty())
+		m_trackedData.resize(m_pops.size());
+}
+
+
+void Simulator::snapshotState()
+{
+	// a new snapshot replaces the previous one
+	for (size_t i = 0; i < m_popSnapshot.size(); ++i)
+		delete m_popSnapshot[i];
+	m_popSnapshot.clear();
+	freeRNGStates(m_rngSnapshot);
+
+	m_popSnapshot.resize(m_pops.size());
+	for (size_t i = 0; i < m_pops.size(); ++i)
+		m_popSnapshot[i] = m_pops[i]->clone();
+	snapshotRNGStates(m_rngSnapshot, m_rngDraws);
+}
+
+
+void Simulator::restoreState()
+{
+	PARAM_FAILIF(m_popSnapshot.empty(), RuntimeError,
+		"restoreState() is called before a snapshot is taken by snapshotState().");
+	PARAM_FAILIF(m_popSnapshot.size() != m_pops.size(), RuntimeError,
+		"The number of replicates has changed since the snapshot was taken.");
+
+	// the snapshot is kept so that the simulator can be restored again
+	for (size_t i = 0; i < m_pops.size(); ++i) {
+		delete m_pops[i];
+		m_pops[i] = m_popSnapshot[i]->clone();
+		m_pops[i]->setRep(i);
+	}
+	restoreRNGStates(m_rngSnapshot, m_rngDraws);
+}
+
+
+void Simulator::trackVars(const stringList & vars)
+{
+	m_trackedVars = vars.elems();
+	m_trackedData.assign(m_pops.size(), vectorf());
+}
+
+
+void Simulator::setTelemetryOutput(const string & output)
+{
+	m_telemetryFile = output;
+}
+
+
+vectorf Simulator::trackedVars(int rep) const
+{
+	if (rep >= 0) {
+		if (static_cast<UINT>(rep) >= m_trackedData.size())
+			throw ValueError("Replicate index out of range.");
+		return m_trackedData[rep];
+	}
+	// all replicates in one buffer
+	vectorf res;
+	size_t sz = 0;
+	for (size_t i = 0; i < m_trackedData.size(); ++i)
+		sz += m_trackedData[i].size();
+	res.reserve(sz);
+	for (size_t i = 0; i < m_trackedData.size(); ++i)
+		res.insert(res.end(), m_trackedData[i].begin(), m_trackedData[i].end());
+	return res;
+}
+
+
+PyObject * Simulator::estimate(const MatingScheme & matingScheme, int gen) const
+{
+	GILGuard gil;
+
+	const uintListFunc & szCfg = matingScheme.subPopSizeConfig();
+	size_t fixedSize = 0;
+	for (size_t i = 0; i < szCfg.elems().size(); ++i)
+		fixedSize += szCfg.elems()[i];
+
+	size_t curBytes = 0;
+	size_t offBytes = 0;
+	size_t scratchBytes = 0;
+	size_t ancBytes = 0;
+	size_t peakBytes = 0;
+	bool unbounded = false;
+	for (size_t rep = 0; rep < m_pops.size(); ++rep) {
+		const Population & pop = *m_pops[rep];
+		size_t cur = pop.memSize();
+		size_t genB = pop.genBytes();
+		// for the mutant module this carries the current mutant density of
+		// the replicate into the projection; for the other modules the
+		// genotype bytes per individual are fixed by the geometry.
+		double perInd = pop.popSize() == 0 ? 0. :
+		                static_cast<double>(genB) / pop.popSize();
+		size_t offSize = fixedSize > 0 ? fixedSize : pop.popSize();
+		size_t off = static_cast<size_t>(perInd * offSize);
+		// this gate mirrors the one of MatingScheme::mate(): the in-place
+		// mode buffers only the largest subpopulation, but is silently
+		// skipped when its preconditions do not hold.
+		size_t scratch = off;
+		if (matingScheme.matesInPlace() && pop.ancestralDepth() == 0 &&
+		    szCfg.elems().empty() && !szCfg.func().isValid()) {
+			size_t maxSP = 0;
+			for (size_t sp = 0; sp < pop.numSubPop(); ++sp)
+				maxSP = std::max(maxSP, pop.subPopSize(sp));
+			scratch = static_cast<size_t>(perInd * maxSP);
+		}
+		// generations the ancestral ring will hold after gen generations
+		int depth = pop.ancestralDepth();
+		size_t ringGens = 0;
+		if (depth >= 0)
+			ringGens = gen < 0 ? static_cast<size_t>(depth)
+			           : std::min(static_cast<size_t>(depth),
+							 static_cast<size_t>(pop.ancestralGens() + gen));
+		else if (gen >= 0)
+			ringGens = pop.ancestralGens() + gen;
+		else
+			unbounded = true;
+		size_t ring = std::max(cur - genB,
+			static_cast<size_t>(perInd * offSize) * ringGens);
+
+		curBytes += cur;
+		offBytes += off;
+		ancBytes += ring;
+		scratchBytes = std::max(scratchBytes, scratch);
+		// at the worst point of a generation cycle this replicate holds
+		// the larger of its parental and offspring generations plus its
+		// ancestral ring; the scratch buffer is shared and added once.
+		peakBytes += std::max(genB, off) + ring;
+	}
+	peakBytes += scratchBytes;
+
+	size_t physBytes = 0;
+#if !defined(_WIN32) && defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+	long pages = sysconf(_SC_PHYS_PAGES);
+	long pageSize = sysconf(_SC_PAGESIZE);
+	if (pages > 0 && pageSize > 0)
+		physBytes = static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+#endif
+	(void)unbounded;
+	DBG_WARNIF(unbounded, "The projected peak memory cannot be bounded because "
+		                  "the ancestral depth and the number of generations are both unlimited.");
+	DBG_WARNIF(physBytes > 0 && peakBytes > physBytes,
+		(boost::format("The projected peak memory (%1% bytes) exceeds the physical "
+			           "memory of this machine (%2% bytes).") % peakBytes % physBytes).str());
+
+	PyObject * dict = PyDict_New();
+	PyObject * val = NULL;
+	PyDict_SetItemString(dict, "current", val = PyInt_FromLong(static_cast<long>(curBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "offspring", val = PyInt_FromLong(static_cast<long>(offBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "scratch", val = PyInt_FromLong(static_cast<long>(scratchBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "ancestral", val = PyInt_FromLong(static_cast<long>(ancBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "peak", val = PyInt_FromLong(static_cast<long>(peakBytes)));
+	Py_DECREF(val);
+	PyDict_SetItemString(dict, "physical", val = PyInt_FromLong(static_cast<long>(physBytes)));
+	Py_DECREF(val);
+	return dict;
 }
 
 
@@ -224,6 +430,19 @@ vectoru Simulator::evolve(
 
 	initClock();
 
+	std::ofstream telemetry;
+	if (!m_telemetryFile.empty()) {
+		telemetry.open(m_telemetryFile.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+		if (!telemetry)
+			throw ValueError("Failed to open telemetry output " + m_telemetryFile);
+	}
+
+	// preallocate the recording buffers if the number of generations is known
+	if (!m_trackedVars.empty() && gens > 0)
+		for (size_t rep = 0; rep < m_trackedData.size(); ++rep)
+			m_trackedData[rep].reserve(m_trackedData[rep].size() +
+				static_cast<size_t>(gens) * m_trackedVars.size());
+
 	// appy pre-op, most likely initializer. Do not check if they are active
 	// or if they are successful
 	if (!initOps.empty())
@@ -264,12 +483,23 @@ vectoru Simulator::evolve(
 				fill(activeReps.begin(), activeReps.end(), false);
 				numStopped = activeReps.size();
 			}
+#ifndef OPTIMIZED
+			// per-operator timings of the previous generation are discarded so
+			// that the opTime dictionary only lists operators of this generation
+			if (debug(DBG_PROFILE))
+				curPop.getVars().removeVar("opTime");
+#endif
+			std::chrono::steady_clock::time_point telStart = std::chrono::steady_clock::now();
+			std::chrono::steady_clock::time_point telPre = telStart;
+			std::chrono::steady_clock::time_point telMate = telStart;
+
 			// apply pre-mating ops to current gen()
 			if (!preOps.empty()) {
 				for (it = 0; it < preOps.size(); ++it) {
 					if (!preOps[it]->isActive(curRep, curGen, end, activeReps))
 						continue;
 
+					profileStart();
 					try {
 						if (!preOps[it]->apply(curPop)) {
 							DBG_DO(DBG_SIMULATOR, cerr << "Pre-mating Operator " << preOps[it]->describe() <<
@@ -303,13 +533,18 @@ vectoru Simulator::evolve(
 					}
 
 					elapsedTime("Applied " + preOps[it]->describe());
+					profileOpTime(curPop.getVars(), preOps[it]->describe());
 				}
 			}
 
+			telPre = std::chrono::steady_clock::now();
+			rngManifestCheckpoint(curGen, curRep, "pre");
+
 			if (!activeReps[curRep])
 				continue;
 			elapsedTime((boost::format("Start mating at generation %1%") % curGen).str());
 			// start mating:
+			profileStart();
 			try {
 				if (!const_cast<MatingScheme &>(matingScheme).mate(curPop, scratchPopulation())) {
 					DBG_DO(DBG_SIMULATOR, cerr << "Mating stops at replicate " << curRep << endl);
@@ -340,16 +575,52 @@ vectoru Simulator::evolve(
 			}
 
 			elapsedTime("Mating finished.");
+			profileOpTime(curPop.getVars(), "mating scheme");
+			telMate = std::chrono::steady_clock::now();
+			rngManifestCheckpoint(curGen, curRep, "mate");
 
 			// apply post-mating ops to next gen()
+			//
+			// Post-mating operators are applied to completion before the
+			// next iteration on purpose. They run on the offspring
+			// generation of the very population object that the next
+			// iteration's pre-mating operators and mating scheme modify,
+			// and almost all of them (stats, reporters, expression-gated
+			// operators) read or write the population's Python namespace,
+			// which only one thread may use. Overlapping them with the
+			// next mating phase on a background thread would therefore
+			// race on both the population and the interpreter. Operators
+			// that can profit from multiple threads parallelize
+			// internally over individuals or loci instead.
 			if (!postOps.empty()) {
 				for (it = 0; it < postOps.size(); ++it) {
 					if (!postOps[it]->isActive(curRep, curGen, end, activeReps))
 						continue;
 
+					// a run of consecutive active operators that can all be
+					// applied per individual is fused into a single sweep
+					// over the population, so that each individual is
+					// brought into cache once instead of once per operator
+					vectoru fusedOps;
+					while (it + fusedOps.size() < postOps.size() &&
+					       postOps[it + fusedOps.size()]->fusable() &&
+					       postOps[it + fusedOps.size()]->isActive(curRep, curGen, end, activeReps))
+						fusedOps.push_back(it + fusedOps.size());
+					size_t opIdx = it;
+					const string opDesc = fusedOps.size() > 1 ?
+					                      (boost::format("fused sweep of %1% operators") % fusedOps.size()).str() :
+					                      postOps[it]->describe();
+
+					profileStart();
 					try {
-						if (!postOps[it]->apply(curPop)) {
-							DBG_DO(DBG_SIMULATOR, cerr << "Post-mating Operator " + postOps[it]->describe() +
+						bool succ;
+						if (fusedOps.size() > 1) {
+							succ = postOps.applyFused(fusedOps, curPop, opIdx);
+							it = fusedOps.back();
+						} else
+							succ = postOps[it]->apply(curPop);
+						if (!succ) {
+							DBG_DO(DBG_SIMULATOR, cerr << "Post-mating Operator " + postOps[opIdx]->describe() +
 								" stops at replicate " << curRep << endl);
 							numStopped++;
 							activeReps[curRep] = false;
@@ -360,7 +631,7 @@ vectoru Simulator::evolve(
 							throw StopEvolution("Evolution stopped due to keyboard interruption.");
 					} catch (StopEvolution e) {
 						DBG_DO(DBG_SIMULATOR, cerr	<< "All replicates are stopped due to a StopEvolution exception raised by "
-							                        << "Post-mating Operator " + postOps[it]->describe() +
+							                        << "Post-mating Operator " + postOps[opIdx]->describe() +
 							" stops at replicate " << curRep << endl);
 						if (e.message()[0] != '\0')
 							cerr << e.message() << endl;
@@ -377,9 +648,28 @@ vectoru Simulator::evolve(
 						curGen = newCurGen;
 						DBG_DO(DBG_SIMULATOR, cerr << "Revert to generation " << curGen << endl);
 					}
-					elapsedTime("Applied " + postOps[it]->describe());
+					elapsedTime("Applied " + opDesc);
+					profileOpTime(curPop.getVars(), opDesc);
 				}
 			}
+			rngManifestCheckpoint(curGen, curRep, "post");
+			// emit one binary telemetry record for the generation this
+			// replicate just completed
+			if (telemetry.is_open()) {
+				std::chrono::steady_clock::time_point telEnd = std::chrono::steady_clock::now();
+				writeTelemetryRecord(telemetry, static_cast<UINT>(curRep), curGen,
+					curPop.popSize(),
+					std::chrono::duration<double>(telPre - telStart).count(),
+					std::chrono::duration<double>(telMate - telPre).count(),
+					std::chrono::duration<double>(telEnd - telMate).count(),
+					curPop.memPeak());
+			}
+			// record tracked variables of this generation
+			if (!m_trackedVars.empty()) {
+				vectorf & data = m_trackedData[curRep];
+				for (size_t vi = 0; vi < m_trackedVars.size(); ++vi)
+					data.push_back(curPop.getVars().getVarAsDouble(m_trackedVars[vi]));
+			}
 			// if a replicate stops at a post mating operator, consider one evolved generation.
 			++evolvedGens[curRep];
 			curPop.setGen(curGen + 1);
@@ -389,6 +679,12 @@ vectoru Simulator::evolve(
 		checkRefCount();
 #endif
 
+		// push buffered output of all persistent streams to disk once per
+		// generation instead of once per record.
+		ostreamManager().flushAll();
+		if (telemetry.is_open())
+			telemetry.flush();
+
 		--gens;
 		//
 		//   start 0, gen = 2
@@ -425,12 +721,14 @@ bool Simulator::apply(const opList & ops)
 			if (!ops[it]->isActive(curRep, 0, 0, activeReps, true))
 				continue;
 
+			profileStart();
 			try {
 				ops[it]->apply(curPop);
 			} catch (RevertEvolution e) {
 				//
 			}
 			elapsedTime("Applied " + ops[it]->describe());
+			profileOpTime(curPop.getVars(), ops[it]->describe());
 		}
 	}
 	return true;
@@ -537,4 +835,32 @@ string describeEvolProcess(const opList & initOps,
 }
 
 
+size_t replaySnapshots(const stringList & files, const opList & ops)
+{
+	const vectorstr & names = files.elems();
+
+	// one population is reused for all snapshots: loadSnapshot() replaces
+	// its content in place, so per-snapshot costs are limited to reading
+	// the file and applying the operators.
+	Population pop;
+	vector<bool> activeReps(1, true);
+	size_t replayed = 0;
+
+	for (size_t f = 0; f < names.size(); ++f) {
+		if (!pop.loadSnapshot(names[f]))
+			throw ValueError("File " + names[f] + " is not a binary population snapshot.");
+		++replayed;
+		for (size_t it = 0; it < ops.size(); ++it) {
+			// operator applicability is decided by the generation number
+			// archived in the snapshot, as it would have been during the run
+			if (!ops[it]->isActive(0, static_cast<ssize_t>(pop.gen()), -1, activeReps))
+				continue;
+			if (!ops[it]->apply(pop))
+				return replayed;
+		}
+	}
+	return replayed;
+}
+
+
 }
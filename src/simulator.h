@@ -215,6 +215,13 @@ public:
 	 *  If parameter \e dryrun is set to \c True, this function will print a
 	 *  description of the evolutionary process generated by function
 	 *  \c describeEvolProcess() and exits.
+	 *
+	 *  Replicates are evolved within one process. For parameter sweeps
+	 *  that need many independent replicates on multiple cores, run one
+	 *  process per replicate (e.g. through \c multiprocessing) and start
+	 *  each worker from a population saved in the binary snapshot format
+	 *  (a filename ending in ".bin"): snapshots load through a memory map,
+	 *  so workers do not pay the archive parsing cost per replicate.
 	 *  <group>2-evolve</group>
 	 */
 	vectoru evolve(
@@ -242,6 +249,99 @@ public:
 	}
 
 
+	/** Record the values of variables \e vars from the local namespace of
+	 *  each replicate after the post-mating operators of every generation
+	 *  evolved by subsequent calls to function \c evolve. Variable names can
+	 *  refer to items of list or dictionary variables (e.g.
+	 *  <tt>"alleleFreq{0}{1}"</tt>) but have to resolve to numbers. Recorded
+	 *  values are kept in one buffer per replicate and can be retrieved with
+	 *  function \c trackedVars(), which avoids traversing the namespaces of
+	 *  many replicates from Python when trajectories are aggregated across
+	 *  replicates. Calling this function clears previously recorded values,
+	 *  and an empty list of names (default) stops the recording.
+	 *  <group>9-var</group>
+	 */
+	void trackVars(const stringList & vars = vectorstr());
+
+	/** Return the values recorded by function \c trackVars() as a flat list
+	 *  that contains, for each evolved generation of replicate \e rep, the
+	 *  value of each tracked variable. If \e rep is negative (default),
+	 *  the lists of all replicates are returned as one flat list, replicate
+	 *  by replicate, so that cross-replicate summaries can be computed from
+	 *  a single buffer.
+	 *  <group>9-var</group>
+	 */
+	vectorf trackedVars(int rep = -1) const;
+
+	/** Write one compact binary telemetry record per replicate per
+	 *  generation of subsequent calls to function \c evolve to file
+	 *  \e output, which may be a named pipe watched by a live monitor.
+	 *  Each record consists of characters \c 'S' and \c 'T', a version
+	 *  byte (currently \c 1), the replicate index (32 bit unsigned), the
+	 *  completed generation number (64 bit signed), the offspring
+	 *  population size (64 bit unsigned), the wall clock time in seconds
+	 *  since the epoch, the seconds this replicate spent on the
+	 *  generation in total and in its pre-mating, mating and post-mating
+	 *  phases (doubles), and the peak memory footprint of the population
+	 *  in bytes (64 bit unsigned), all in native byte order. Records are
+	 *  appended and flushed once per generation, and writing them does
+	 *  not enter Python, so the progress of many replicates can be
+	 *  watched without slowing down the evolving processes. An empty
+	 *  \e output (default) stops the recording.
+	 *  <group>2-evolve</group>
+	 */
+	void setTelemetryOutput(const string & output = string());
+
+	/** Project, without allocating anything, the peak memory that evolving
+	 *  the populations of this simulator with mating scheme \e matingScheme
+	 *  for \e gen generations will need, so that misconfigured large runs
+	 *  (and cluster memory requests) can be checked by arithmetic before
+	 *  hours are spent on them. A dictionary is returned with the number of
+	 *  bytes under keys \c 'current' (the replicates as they are now,
+	 *  including stored ancestral generations), \c 'offspring' (one
+	 *  offspring generation of every replicate, sized by the \c subPopSize
+	 *  parameter of \e matingScheme if a fixed size is given, and by the
+	 *  parental sizes otherwise; a demographic function cannot be evaluated
+	 *  in advance), \c 'scratch' (the shared offspring buffer, which holds
+	 *  the largest replicate, or only its largest subpopulation if
+	 *  \e matingScheme mates in place), \c 'ancestral' (the ancestral ring
+	 *  of every replicate once \e gen generations have filled it to the
+	 *  depth set by \c setAncestralDepth()), \c 'peak' (the sum of the
+	 *  above at the worst point of a generation cycle) and \c 'physical'
+	 *  (the physical memory of this machine, or 0 if it cannot be
+	 *  determined). For the mutant module the projection scales the current
+	 *  mutant density of each replicate, so estimates sharpen as a
+	 *  simulation fills in. A warning is raised if the projected peak
+	 *  exceeds the physical memory, or if it cannot be bounded because the
+	 *  ancestral depth and the number of generations are both unlimited.
+	 *  <group>2-evolve</group>
+	 */
+	PyObject * estimate(const MatingScheme & matingScheme = MatingScheme(),
+		int gen = -1) const;
+
+	/** Capture the current state of the simulator in memory: a deep copy
+	 *  of all replicates, including their generation numbers, ancestral
+	 *  generations and local namespaces, together with the states of all
+	 *  random number streams. A later call to \c restoreState() rewinds
+	 *  the simulator to this state without touching the file system,
+	 *  which makes re-running a model many times from the same starting
+	 *  state (e.g. in an approximate Bayesian computation loop) much
+	 *  cheaper than reloading saved populations. Only one snapshot is
+	 *  kept; taking a new one replaces the previous snapshot.
+	 *  <group>2-evolve</group>
+	 */
+	void snapshotState();
+
+	/** Rewind all replicates and random number streams to the state
+	 *  captured by the last call to \c snapshotState(). The snapshot is
+	 *  kept, so a simulator can be restored any number of times. A
+	 *  \c RuntimeError is raised if no snapshot has been taken, or if the
+	 *  number of replicates or of random number streams has changed since
+	 *  the snapshot.
+	 *  <group>2-evolve</group>
+	 */
+	void restoreState();
+
 	/// a Pyton function used to compare the simulator objects
 	/// Note that mating schemes are not tested.
 	int __cmp__(const Simulator & rhs) const;
@@ -261,6 +361,25 @@ private:
 	/// the scratch pop
 	Population * m_scratchPop;
 
+	/// variables recorded at each generation during evolve()
+	vectorstr m_trackedVars;
+
+	/// recorded values, one buffer per replicate
+	vector<vectorf> m_trackedData;
+
+	/// file (or named pipe) that receives binary telemetry records
+	/// during evolve(), empty if telemetry is disabled
+	string m_telemetryFile;
+
+	/// deep copies of the replicates taken by snapshotState()
+	vector<Population *> m_popSnapshot;
+
+	/// random number stream states captured with the snapshot
+	vector<gsl_rng *> m_rngSnapshot;
+
+	/// draw counters of the streams at the time of the snapshot
+	vectoru m_rngDraws;
+
 };
 
 
@@ -278,6 +397,22 @@ string describeEvolProcess(
 	int gen = -1,
 	size_t numRep = 1);
 
+
+/** Load the binary population snapshots \e files (saved during a run with
+ *  filenames ending in ".bin") one by one and apply operators \e ops (e.g.
+ *  a \c Stat configuration that was not recorded when the run was archived)
+ *  to each of them. One population object is reused for all snapshots, so
+ *  replaying a long run does not pay population construction and namespace
+ *  setup costs per generation, and the \e begin, \e end, \e step and \e at
+ *  parameters of the operators are matched against the generation number
+ *  stored in each snapshot. Results left in the population namespace by one
+ *  operator can be consumed by later operators in \e ops (e.g. a \c PyEval
+ *  with an \e output file) before the next snapshot replaces them. This
+ *  function returns the number of snapshots processed and raises a
+ *  \c ValueError if a file is not a binary population snapshot.
+ */
+size_t replaySnapshots(const stringList & files, const opList & ops);
+
 }
 
 #endif
@@ -37,12 +37,15 @@ using std::set;
 #if TR1_SUPPORT == 0
 #  include <map>
 typedef std::map<ULONG, pair<ULONG, ULONG> > IndexMap;
+typedef std::map<size_t, size_t> PackedHaploCnt;
 #elif TR1_SUPPORT == 1
 #  include <unordered_map>
 typedef std::unordered_map<size_t, pair<size_t, size_t> > IndexMap;
+typedef std::unordered_map<size_t, size_t> PackedHaploCnt;
 #else
 #  include <tr1/unordered_map>
 typedef std::tr1::unordered_map<size_t, pair<size_t, size_t> > IndexMap;
+typedef std::tr1::unordered_map<size_t, size_t> PackedHaploCnt;
 #endif
 
 namespace simuPOP {
@@ -59,6 +62,7 @@ string PyEval::describe(bool /* format */) const
 
 string PyEval::evaluate(Population & pop) const
 {
+	GILGuard gil;
 	subPopList subPops = applicableSubPops(pop);
 
 	if (subPops.empty()) {
@@ -119,10 +123,15 @@ bool PyEval::apply(Population & pop) const
 
 string InfoEval::evalInfo(Individual * ind, PyObject * dict) const
 {
-	vectorstr infos = ind->infoFields();
+	GILGuard gil;
+	// field names are identical for all individuals of a population so
+	// the name list is fetched once and kept until clearVars().
+	if (m_infoNames.empty())
+		m_infoNames = ind->infoFields();
+	const vectorstr & infos = m_infoNames;
 
 	for (size_t idx = 0; idx < infos.size(); ++idx) {
-		string name = infos[idx];
+		const string & name = infos[idx];
 		double val = ind->info(idx);
 		// if the value is unchanged, do not set new value
 		if (m_lastValues.size() <= idx || m_lastValues[idx] != val) {
@@ -155,7 +164,13 @@ string InfoEval::evalInfo(Individual * ind, PyObject * dict) const
 		Py_DECREF(indObj);
 	}
 
-	m_expr.setLocalDict(dict);
+	// binding the local dictionary checks for __builtins__ every time,
+	// so it is skipped when evaluating for another individual of the
+	// same population.
+	if (dict != m_lastDict) {
+		m_expr.setLocalDict(dict);
+		m_lastDict = dict;
+	}
 	// evaluate
 	string res = m_expr.valueAsString();
 	// If some statements have been evaluated, the value of field might have been changed
@@ -163,7 +178,7 @@ string InfoEval::evalInfo(Individual * ind, PyObject * dict) const
 	if (!m_expr.stmts().empty()) {
 		for (size_t idx = 0; idx < infos.size(); ++idx) {
 			double info = 0;
-			string name = infos[idx];
+			const string & name = infos[idx];
 			try {
 				PyObject * var = PyDict_GetItemString(dict, name.c_str());
 				PyObj_As_Double(var, info);
@@ -181,6 +196,7 @@ string InfoEval::evalInfo(Individual * ind, PyObject * dict) const
 
 void InfoEval::clearVars(Population & pop) const
 {
+	GILGuard gil;
 	vectorstr infos = pop.infoFields();
 
 	//
@@ -200,6 +216,8 @@ void InfoEval::clearVars(Population & pop) const
 	if (!m_exposeInd.empty())
 		PyDict_DelItemString(pop.dict(), m_exposeInd.c_str());
 	m_lastValues.clear();
+	m_infoNames.clear();
+	m_lastDict = NULL;
 }
 
 
@@ -252,6 +270,38 @@ string InfoExec::describe(bool /* format */) const
 }
 
 
+// apply a deciphered InfoExec statement to one individual
+static void applySimpleStmt(Individual & ind, simpleStmt::OperationType oType,
+                            double oValue, size_t oVarIdx)
+{
+	switch (oType) {
+	case simpleStmt::Assignment:
+		ind.setInfo(oValue, oVarIdx);
+		break;
+	case simpleStmt::Increment:
+		ind.setInfo(ind.info(oVarIdx) + oValue, oVarIdx);
+		break;
+	case simpleStmt::Decrement:
+		ind.setInfo(ind.info(oVarIdx) - oValue, oVarIdx);
+		break;
+	case simpleStmt::MultipliedBy:
+		ind.setInfo(ind.info(oVarIdx) * oValue, oVarIdx);
+		break;
+	case simpleStmt::SetSex:
+		ind.setInfo(ind.sex(), oVarIdx);
+		break;
+	case simpleStmt::SetAffected:
+		ind.setInfo(ind.affected(), oVarIdx);
+		break;
+	case simpleStmt::SetUnaffected:
+		ind.setInfo(!ind.affected(), oVarIdx);
+		break;
+	default:
+		throw RuntimeError("Incorrect operation type");
+	}
+}
+
+
 bool InfoExec::apply(Population & pop) const
 {
 	subPopList subPops = applicableSubPops(pop);
@@ -268,35 +318,25 @@ bool InfoExec::apply(Population & pop) const
 	subPopList::const_iterator spEnd = subPops.end();
 	for ( ; sp != spEnd; ++sp) {
 		pop.activateVirtualSubPop(*sp);
-		IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop());
-		for (; ind.valid(); ++ind) {
-			switch (oType) {
-			case simpleStmt::NoOperation:
-				evalInfo(&*ind, pop.dict());
-				break;
-			case simpleStmt::Assignment:
-				ind->setInfo(oValue, oVarIdx);
-				break;
-			case simpleStmt::Increment:
-				ind->setInfo(ind->info(oVarIdx) + oValue, oVarIdx);
-				break;
-			case simpleStmt::Decrement:
-				ind->setInfo(ind->info(oVarIdx) - oValue, oVarIdx);
-				break;
-			case simpleStmt::MultipliedBy:
-				ind->setInfo(ind->info(oVarIdx) * oValue, oVarIdx);
-				break;
-			case simpleStmt::SetSex:
-				ind->setInfo(ind->sex(), oVarIdx);
-				break;
-			case simpleStmt::SetAffected:
-				ind->setInfo(ind->affected(), oVarIdx);
-				break;
-			case simpleStmt::SetUnaffected:
-				ind->setInfo(!ind->affected(), oVarIdx);
-				break;
-			default:
-				throw RuntimeError("Incorrect operation type");
+		if (numThreads() > 1 && oType != simpleStmt::NoOperation) {
+			// deciphered statements only touch the information fields of
+			// the individual itself so they can be applied in parallel,
+			// unlike statements that go through the interpreter.
+#pragma omp parallel
+			{
+#ifdef _OPENMP
+				IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop(), omp_get_thread_num());
+				for (; ind.valid(); ++ind)
+					applySimpleStmt(*ind, oType, oValue, oVarIdx);
+#endif
+			}
+		} else {
+			IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop());
+			for (; ind.valid(); ++ind) {
+				if (oType == simpleStmt::NoOperation)
+					evalInfo(&*ind, pop.dict());
+				else
+					applySimpleStmt(*ind, oType, oValue, oVarIdx);
 			}
 		}
 		pop.deactivateVirtualSubPop(sp->subPop());
@@ -353,6 +393,10 @@ Stat::Stat(
 	//
 	const lociList & numOfMutants,
 	//
+	bool lineage,
+	//
+	const lociList & ancestry,
+	//
 	const lociList & alleleFreq,
 	//
 	const lociList & heteroFreq,
@@ -369,6 +413,7 @@ Stat::Stat(
 	const stringList & varOfInfo,
 	const stringList & maxOfInfo,
 	const stringList & minOfInfo,
+	const stringList & medianOfInfo,
 	//
 	const intMatrix & LD,
 	//
@@ -384,6 +429,10 @@ Stat::Stat(
 	//
 	const lociList & effectiveSize,
 	//
+	long maxLDPairs,
+	//
+	long LDBand,
+	//
 	const stringList & vars,
 	const string & suffix,
 	// regular parameters
@@ -397,19 +446,21 @@ Stat::Stat(
 	m_numOfAffected(numOfAffected, subPops, vars, suffix),
 	m_numOfSegSites(numOfSegSites, subPops, vars, suffix),
 	m_numOfMutants(numOfMutants, subPops, vars, suffix),
+	m_lineage(lineage, subPops, vars, suffix),
+	m_ancestry(ancestry, subPops, vars, suffix),
 	m_alleleFreq(alleleFreq, subPops, vars, suffix),
 	m_heteroFreq(heteroFreq, homoFreq, subPops, vars, suffix),
 	m_genoFreq(genoFreq, subPops, vars, suffix),
 	m_haploFreq(haploFreq, subPops, vars, suffix),
 	m_haploHomoFreq(haploHeteroFreq, haploHomoFreq, subPops, vars, suffix),
-	m_info(sumOfInfo.elems(), meanOfInfo.elems(), varOfInfo.elems(), maxOfInfo.elems(), minOfInfo.elems(), subPops, vars, suffix),
-	m_LD(LD, subPops, vars, suffix),
+	m_info(sumOfInfo.elems(), meanOfInfo.elems(), varOfInfo.elems(), maxOfInfo.elems(), minOfInfo.elems(), medianOfInfo.elems(), subPops, vars, suffix),
+	m_LD(LD, LDBand, subPops, vars, suffix),
 	m_association(association, subPops, vars, suffix),
 	m_neutrality(neutrality, subPops, vars, suffix),
 	m_structure(structure, subPops, vars, suffix),
 	m_HWE(HWE, subPops, vars, suffix),
 	m_Inbreeding(Inbreeding, subPops, vars, suffix),
-	m_effectiveSize(effectiveSize, subPops, vars, suffix)
+	m_effectiveSize(effectiveSize, subPops, vars, suffix, maxLDPairs)
 {
 	(void)output;  // avoid warning about unused parameter
 }
@@ -425,6 +476,8 @@ string Stat::describe(bool /* format */) const
 	descs.push_back(m_numOfAffected.describe(false));
 	descs.push_back(m_numOfSegSites.describe(false));
 	descs.push_back(m_numOfMutants.describe(false));
+	descs.push_back(m_lineage.describe(false));
+	descs.push_back(m_ancestry.describe(false));
 	descs.push_back(m_alleleFreq.describe(false));
 	descs.push_back(m_heteroFreq.describe(false));
 	descs.push_back(m_genoFreq.describe(false));
@@ -448,11 +501,24 @@ string Stat::describe(bool /* format */) const
 
 bool Stat::apply(Population & pop) const
 {
+	// statistics calculation is dominated by C++ scans of the genotypes,
+	// so the GIL is released for its duration; posting the results as
+	// population variables goes through SharedVariables, which
+	// re-acquires the lock for each access.
+	GILRelease gil;
+
+	// when several components request per-locus counts at the same loci,
+	// one shared genotype scan fills the count caches from which these
+	// components read, instead of each component sweeping the population.
+	fillSharedCnt(pop);
+
 	return m_popSize.apply(pop) &&
 	       m_numOfMales.apply(pop) &&
 	       m_numOfAffected.apply(pop) &&
 	       m_numOfSegSites.apply(pop) &&
 	       m_numOfMutants.apply(pop) &&
+	       m_lineage.apply(pop) &&
+	       m_ancestry.apply(pop) &&
 	       m_alleleFreq.apply(pop) &&
 	       m_heteroFreq.apply(pop) &&
 	       m_genoFreq.apply(pop) &&
@@ -549,28 +615,28 @@ bool statNumOfMales::apply(Population & pop) const
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
+	vectoru runs;
 	for (; sp != spEnd; ++sp) {
 		size_t maleCnt = 0;
 		size_t femaleCnt = 0;
 		size_t totalCnt = 0;
+		// take a run-length encoded snapshot of the (virtual)
+		// subpopulation so that each run can be counted with a plain
+		// index loop instead of a visibility test per individual
 		pop.activateVirtualSubPop(*sp);
+		pop.indRuns(sp->subPop(), runs);
+		pop.deactivateVirtualSubPop(sp->subPop());
 
-#pragma omp parallel reduction (+ : maleCnt,femaleCnt) if(numThreads() > 1)
-		{
-#ifdef _OPENMP
-			IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
-#else
-			IndIterator it = pop.indIterator(sp->subPop());
-#endif
-			for (; it.valid(); ++it)
-				if (it->sex() == MALE)
+		ConstRawIndIterator base = pop.rawIndBegin();
+		for (size_t r = 0; r + 1 < runs.size(); r += 2) {
+#pragma omp parallel for reduction (+ : maleCnt,femaleCnt) if(numThreads() > 1)
+			for (ssize_t i = runs[r]; i < static_cast<ssize_t>(runs[r + 1]); ++i)
+				if ((base + i)->sex() == MALE)
 					maleCnt++;
 				else
 					femaleCnt++;
 		}
 
-		pop.deactivateVirtualSubPop(sp->subPop());
-
 		totalCnt = maleCnt + femaleCnt;
 
 		if (m_vars.contains(numOfMales_sp_String))
@@ -636,28 +702,27 @@ bool statNumOfAffected::apply(Population & pop) const
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
+	vectoru runs;
 	for (; sp != spEnd; ++sp) {
 		size_t affectedCnt = 0;
 		size_t unaffectedCnt = 0;
 		size_t totalCnt = 0;
+		// count each run of visible individuals with a plain index loop
+		// over the run-length encoded (virtual) subpopulation
 		pop.activateVirtualSubPop(*sp);
+		pop.indRuns(sp->subPop(), runs);
+		pop.deactivateVirtualSubPop(sp->subPop());
 
-#pragma omp parallel reduction (+ : affectedCnt,unaffectedCnt) if(numThreads() > 1)
-		{
-#ifdef _OPENMP
-			IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
-#else
-			IndIterator it = pop.indIterator(sp->subPop());
-#endif
-			for (; it.valid(); ++it)
-				if (it->affected())
+		ConstRawIndIterator base = pop.rawIndBegin();
+		for (size_t r = 0; r + 1 < runs.size(); r += 2) {
+#pragma omp parallel for reduction (+ : affectedCnt,unaffectedCnt) if(numThreads() > 1)
+			for (ssize_t i = runs[r]; i < static_cast<ssize_t>(runs[r + 1]); ++i)
+				if ((base + i)->affected())
 					affectedCnt++;
 				else
 					unaffectedCnt++;
 		}
 
-		pop.deactivateVirtualSubPop(sp->subPop());
-
 		totalCnt = affectedCnt + unaffectedCnt;
 
 		if (m_vars.contains(numOfAffected_sp_String))
@@ -701,6 +766,7 @@ statNumOfSegSites::statNumOfSegSites(const lociList & loci, const subPopList & s
 		numOfFixedSites_String, numOfFixedSites_sp_String,
 		segSites_String,		segSites_sp_String,
 		fixedSites_String,		fixedSites_sp_String,
+		siteFreqSpectrum_String, siteFreqSpectrum_sp_String,
 		""
 	};
 	const char * defaultVars[] = { numOfSegSites_String, numOfFixedSites_String, "" };
@@ -732,6 +798,11 @@ bool statNumOfSegSites::apply(Population & pop) const
 
 	std::set<size_t> allFixedSites;
 	std::set<size_t> allSegSites;
+	// non-zero allele count per site, accumulated across subpopulations so
+	// that the population level spectrum reflects combined site frequencies
+	std::map<size_t, size_t> allCopyCnt;
+	bool needSpectrum = m_vars.contains(siteFreqSpectrum_String) ||
+	                    m_vars.contains(siteFreqSpectrum_sp_String);
 	// for each subpopulation.
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator sp = subPops.begin();
@@ -739,6 +810,7 @@ bool statNumOfSegSites::apply(Population & pop) const
 	for (; sp != spEnd; ++sp) {
 		std::set<size_t> fixedSites;
 		std::set<size_t> segSites;
+		std::map<size_t, size_t> copyCnt;
 		pop.activateVirtualSubPop(*sp);
 
 		// go through all loci
@@ -781,6 +853,10 @@ bool statNumOfSegSites::apply(Population & pop) const
 				size_t lociValue = (index_it->first - indIndex) % totNumLoci;
 				if (m_loci.indexOf(lociValue) == NOT_FOUND)
 					continue;
+				// the spectrum only needs the number of non-zero copies per
+				// site, which this sweep visits one by one anyway
+				if (needSpectrum)
+					++copyCnt[lociValue];
 				IndexMap::iterator map_it = indexMap.find(lociValue);
 				if (map_it == indexMap.end())
 					indexMap.insert(IndexMap::value_type(lociValue, std::make_pair(index_it->second, 1)));
@@ -801,17 +877,25 @@ bool statNumOfSegSites::apply(Population & pop) const
 			size_t loc = loci[idx];
 			int isSeg = 2;
 			int isFixed = 2;
+			size_t copies = 0;
 			IndAlleleIterator a = pop.alleleIterator(loc, sp->subPop());
 			if (a.valid()) {
 				Allele first = *a++;
 				if (first == 0)
 					isFixed = 0;
+				else
+					++copies;
 				for (; a.valid(); ++a) {
 					if (*a != first) {
 						isSeg = 1;
 						isFixed = 0;
 					}
-					if (isSeg != 2 && isFixed != 2)
+					// the spectrum needs the non-zero copies of every site,
+					// so the early exit is only taken when it is not asked for
+					if (needSpectrum) {
+						if (*a != 0)
+							++copies;
+					} else if (isSeg != 2 && isFixed != 2)
 						break;
 				}
 			} else {
@@ -822,6 +906,8 @@ bool statNumOfSegSites::apply(Population & pop) const
 				fixedSites.insert((ULONG)loc);
 			else if (isSeg == 1)
 				segSites.insert((ULONG)loc);
+			if (needSpectrum && copies > 0)
+				copyCnt[loc] = copies;
 		}
 #endif
 		pop.deactivateVirtualSubPop(sp->subPop());
@@ -840,9 +926,23 @@ bool statNumOfSegSites::apply(Population & pop) const
 			std::sort(ss.begin(), ss.end());
 			pop.getVars().setVar(subPopVar_String(*sp, segSites_String, m_suffix), ss);
 		}
+		if (m_vars.contains(siteFreqSpectrum_sp_String)) {
+			uintDict spectrum;
+			std::map<size_t, size_t>::const_iterator cit = copyCnt.begin();
+			std::map<size_t, size_t>::const_iterator citEnd = copyCnt.end();
+			for (; cit != citEnd; ++cit)
+				spectrum[cit->second] += 1;
+			pop.getVars().setVar(subPopVar_String(*sp, siteFreqSpectrum_String, m_suffix), spectrum);
+		}
 
 		allFixedSites.insert(fixedSites.begin(), fixedSites.end());
 		allSegSites.insert(segSites.begin(), segSites.end());
+		if (needSpectrum) {
+			std::map<size_t, size_t>::const_iterator cit = copyCnt.begin();
+			std::map<size_t, size_t>::const_iterator citEnd = copyCnt.end();
+			for (; cit != citEnd; ++cit)
+				allCopyCnt[cit->first] += cit->second;
+		}
 	}
 
 	// output whole population
@@ -860,6 +960,14 @@ bool statNumOfSegSites::apply(Population & pop) const
 		std::sort(ss.begin(), ss.end());
 		pop.getVars().setVar(segSites_String + m_suffix, ss);
 	}
+	if (m_vars.contains(siteFreqSpectrum_String)) {
+		uintDict spectrum;
+		std::map<size_t, size_t>::const_iterator cit = allCopyCnt.begin();
+		std::map<size_t, size_t>::const_iterator citEnd = allCopyCnt.end();
+		for (; cit != citEnd; ++cit)
+			spectrum[cit->second] += 1;
+		pop.getVars().setVar(siteFreqSpectrum_String + m_suffix, spectrum);
+	}
 	return true;
 }
 
@@ -896,6 +1004,17 @@ bool statNumOfMutants::apply(Population & pop) const
 
 	size_t allMutantCount = 0;
 
+#ifdef MUTANTALLELE
+	// a sorted copy of the target loci lets the per-individual test below
+	// merge two sorted position lists instead of scanning the whole locus
+	// list for every stored mutant.
+	vectoru sortedLoci;
+	if (!m_loci.allAvail()) {
+		sortedLoci = loci;
+		std::sort(sortedLoci.begin(), sortedLoci.end());
+	}
+#endif
+
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
@@ -910,26 +1029,39 @@ bool statNumOfMutants::apply(Population & pop) const
 			vectorm::val_iterator index_it = it.get_val_iterator();
 			vectorm::val_iterator index_it_end = it_end.get_val_iterator();
 			size_t indIndex = it.index();
-			for (; index_it != index_it_end; ++index_it) {
-				if (m_loci.allAvail()) {
+			if (m_loci.allAvail()) {
+				for (; index_it != index_it_end; ++index_it)
 					if (index_it->second != 0)
 						mutantCount++;
-				} else {
-					for (size_t idx = 0; idx < loci.size(); ++idx) {
-						size_t loc = indIndex + loci[idx];
-						if (index_it->first == loc && index_it->second != 0) {
+			} else {
+				// stored mutants and target loci are both sorted by
+				// position, so one linear merge covers the individual.
+				vectoru::const_iterator lit = sortedLoci.begin();
+				vectoru::const_iterator lit_end = sortedLoci.end();
+				while (index_it != index_it_end && lit != lit_end) {
+					size_t loc = indIndex + *lit;
+					if (index_it->first < loc)
+						++index_it;
+					else if (index_it->first > loc)
+						++lit;
+					else {
+						if (index_it->second != 0)
 							mutantCount++;
-							break;
-						}
+						++index_it;
 					}
 				}
 			}
 #else
 			if (m_loci.allAvail()) {
+#  ifdef BINARYALLELE
+				// count word by word over the underlying bit storage
+				mutantCount += countGenotype(it, it_end - it);
+#  else
 				for (; it != it_end; ++it) {
 					if (*it != 0)
 						mutantCount++;
 				}
+#  endif
 			} else {
 				for (size_t idx = 0; idx < loci.size(); ++idx) {
 					size_t loc = loci[idx];
@@ -951,6 +1083,520 @@ bool statNumOfMutants::apply(Population & pop) const
 }
 
 
+statLineage::statLineage(bool lineage, const subPopList & subPops,
+	const stringList & vars, const string & suffix)
+	: m_isActive(lineage), m_subPops(subPops), m_vars(), m_suffix(suffix)
+{
+	const char * allowedVars[] = {
+		lineageNum_String,		 lineageFreq_String,
+		numOfLineageSegs_String, lineageNum_sp_String,
+		lineageFreq_sp_String,	 numOfLineageSegs_sp_String, ""
+	};
+	const char * defaultVars[] = { lineageNum_String, lineageFreq_String, "" };
+
+	m_vars.obtainFrom(vars, allowedVars, defaultVars);
+
+#ifndef LINEAGE
+	DBG_WARNIF(m_isActive, "Lineage statistics will be empty in non-lineage modules");
+#endif
+}
+
+
+string statLineage::describe(bool /* format */) const
+{
+	return m_isActive ? "tally allelic lineage" : "";
+}
+
+
+bool statLineage::apply(Population & pop) const
+{
+	if (!m_isActive)
+		return true;
+
+	subPopList subPops = m_subPops.expandFrom(pop);
+	subPopList::const_iterator it = subPops.begin();
+	subPopList::const_iterator itEnd = subPops.end();
+#ifdef LINEAGE
+	intDict allCnt;
+	size_t allValues = 0;
+	size_t allSegs = 0;
+	size_t ply = pop.ploidy();
+	size_t numChrom = pop.numChrom();
+	for (; it != itEnd; ++it) {
+		pop.activateVirtualSubPop(*it);
+
+		intDict cnt;
+		size_t values = 0;
+		size_t segs = 0;
+
+		IndIterator ind = pop.indIterator(it->subPop());
+		for (; ind.valid(); ++ind) {
+			// one linear pass over the lineage vector of each individual,
+			// with segment boundaries at chromosome ends
+			for (size_t p = 0; p < ply; ++p) {
+				for (size_t ch = 0; ch < numChrom; ++ch) {
+					LineageIterator a = ind->lineageBegin(p, ch);
+					LineageIterator a_end = ind->lineageEnd(p, ch);
+					if (a == a_end)
+						continue;
+					long last = *a;
+					cnt[*a]++;
+					++values;
+					++segs;
+					for (++a; a != a_end; ++a) {
+						cnt[*a]++;
+						++values;
+						if (*a != last) {
+							++segs;
+							last = *a;
+						}
+					}
+				}
+			}
+		}
+		pop.deactivateVirtualSubPop(it->subPop());
+
+		if (m_vars.contains(lineageNum_sp_String))
+			pop.getVars().setVar(subPopVar_String(*it, lineageNum_String, m_suffix), cnt);
+		if (m_vars.contains(lineageFreq_sp_String)) {
+			intDict freq = cnt;
+			if (values != 0) {
+				intDict::iterator c = freq.begin();
+				intDict::iterator cEnd = freq.end();
+				for (; c != cEnd; ++c)
+					c->second /= static_cast<double>(values);
+			}
+			pop.getVars().setVar(subPopVar_String(*it, lineageFreq_String, m_suffix), freq);
+		}
+		if (m_vars.contains(numOfLineageSegs_sp_String))
+			pop.getVars().setVar(subPopVar_String(*it, numOfLineageSegs_String, m_suffix), segs);
+		//
+		intDict::const_iterator c = cnt.begin();
+		intDict::const_iterator cEnd = cnt.end();
+		for (; c != cEnd; ++c)
+			allCnt[c->first] += c->second;
+		allValues += values;
+		allSegs += segs;
+	}
+	if (m_vars.contains(lineageNum_String))
+		pop.getVars().setVar(lineageNum_String + m_suffix, allCnt);
+	if (m_vars.contains(lineageFreq_String)) {
+		if (allValues != 0) {
+			intDict::iterator c = allCnt.begin();
+			intDict::iterator cEnd = allCnt.end();
+			for (; c != cEnd; ++c)
+				c->second /= static_cast<double>(allValues);
+		}
+		pop.getVars().setVar(lineageFreq_String + m_suffix, allCnt);
+	}
+	if (m_vars.contains(numOfLineageSegs_String))
+		pop.getVars().setVar(numOfLineageSegs_String + m_suffix, allSegs);
+#else
+	// lineage is not tracked in this module, set empty statistics
+	for (; it != itEnd; ++it) {
+		if (m_vars.contains(lineageNum_sp_String))
+			pop.getVars().setVar(subPopVar_String(*it, lineageNum_String, m_suffix), intDict());
+		if (m_vars.contains(lineageFreq_sp_String))
+			pop.getVars().setVar(subPopVar_String(*it, lineageFreq_String, m_suffix), intDict());
+		if (m_vars.contains(numOfLineageSegs_sp_String))
+			pop.getVars().setVar(subPopVar_String(*it, numOfLineageSegs_String, m_suffix), size_t(0));
+	}
+	if (m_vars.contains(lineageNum_String))
+		pop.getVars().setVar(lineageNum_String + m_suffix, intDict());
+	if (m_vars.contains(lineageFreq_String))
+		pop.getVars().setVar(lineageFreq_String + m_suffix, intDict());
+	if (m_vars.contains(numOfLineageSegs_String))
+		pop.getVars().setVar(numOfLineageSegs_String + m_suffix, size_t(0));
+#endif
+	return true;
+}
+
+
+statAncestry::statAncestry(const lociList & loci, const subPopList & subPops,
+	const stringList & vars, const string & suffix)
+	: m_loci(loci), m_subPops(subPops), m_vars(), m_suffix(suffix)
+{
+	const char * allowedVars[] = {
+		ancestryFreq_String,	ancestryDosage_String,
+		ancestryFreq_sp_String, ancestryDosage_sp_String, ""
+	};
+	const char * defaultVars[] = { ancestryFreq_String, ancestryDosage_String, "" };
+
+	m_vars.obtainFrom(vars, allowedVars, defaultVars);
+
+#ifndef LINEAGE
+	DBG_WARNIF(!m_loci.empty(), "Ancestry statistics will be empty in non-lineage modules");
+#endif
+}
+
+
+string statAncestry::describe(bool /* format */) const
+{
+	return m_loci.empty() ? "" : "calculate per-locus ancestry dosage";
+}
+
+
+bool statAncestry::apply(Population & pop) const
+{
+	if (m_loci.empty())
+		return true;
+
+	const vectoru & loci = m_loci.elems(&pop);
+
+	subPopList subPops = m_subPops.expandFrom(pop);
+	subPopList::const_iterator it = subPops.begin();
+	subPopList::const_iterator itEnd = subPops.end();
+#ifdef LINEAGE
+	size_t ply = pop.ploidy();
+	vector<intDict> allCnt(loci.size());
+	vector<tupleDict> allDosage(loci.size());
+	size_t allInds = 0;
+	for (; it != itEnd; ++it) {
+		if (m_vars.contains(ancestryFreq_sp_String))
+			pop.getVars().removeVar(subPopVar_String(*it, ancestryFreq_String, m_suffix));
+		if (m_vars.contains(ancestryDosage_sp_String))
+			pop.getVars().removeVar(subPopVar_String(*it, ancestryDosage_String, m_suffix));
+
+		pop.activateVirtualSubPop(*it);
+
+		vector<intDict> cnt(loci.size());
+		vector<tupleDict> dosage(loci.size());
+		size_t inds = 0;
+
+		IndIterator ind = pop.indIterator(it->subPop());
+		for (; ind.valid(); ++ind, ++inds) {
+			for (size_t idx = 0; idx < loci.size(); ++idx) {
+				size_t loc = loci[idx];
+				intDict & c = cnt[idx];
+				// copies of each ancestry tag carried by this individual
+				std::map<long, int> copies;
+				for (size_t p = 0; p < ply; ++p) {
+					long tag = *(ind->lineageBegin(p) + loc);
+					++c[static_cast<int>(tag)];
+					++copies[tag];
+				}
+				tupleDict & d = dosage[idx];
+				std::map<long, int>::const_iterator t = copies.begin();
+				std::map<long, int>::const_iterator tEnd = copies.end();
+				for (; t != tEnd; ++t) {
+					vectori key(2);
+					key[0] = static_cast<int>(t->first);
+					key[1] = t->second;
+					++d[key];
+				}
+			}
+		}
+		pop.deactivateVirtualSubPop(it->subPop());
+
+		/* the zero-dosage class of a tag is not observed during the scan,
+		   so it is reconstructed as the individuals that carry no copy of
+		   a tag present in the subpopulation. */
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			tupleDict & d = dosage[idx];
+			intDict::const_iterator a = cnt[idx].begin();
+			intDict::const_iterator aEnd = cnt[idx].end();
+			for (; a != aEnd; ++a) {
+				double carriers = 0;
+				vectori key(2);
+				key[0] = a->first;
+				for (size_t n = 1; n <= ply; ++n) {
+					key[1] = static_cast<int>(n);
+					tupleDict::const_iterator f = d.find(key);
+					if (f != d.end())
+						carriers += f->second;
+				}
+				key[1] = 0;
+				d[key] = static_cast<double>(inds) - carriers;
+			}
+		}
+
+		if (m_vars.contains(ancestryFreq_sp_String)) {
+			for (size_t idx = 0; idx < loci.size(); ++idx) {
+				intDict freq = cnt[idx];
+				intDict::iterator c = freq.begin();
+				intDict::iterator cEnd = freq.end();
+				for (; c != cEnd; ++c)
+					c->second /= inds == 0 ? 1. : static_cast<double>(inds * ply);
+				pop.getVars().setVar((boost::format("%1%{%2%}") % subPopVar_String(*it,
+							ancestryFreq_String, m_suffix) % loci[idx]).str(), freq);
+			}
+		}
+		if (m_vars.contains(ancestryDosage_sp_String)) {
+			for (size_t idx = 0; idx < loci.size(); ++idx) {
+				tupleDict spec = dosage[idx];
+				tupleDict::iterator d = spec.begin();
+				tupleDict::iterator dEnd = spec.end();
+				for (; d != dEnd; ++d)
+					d->second /= inds == 0 ? 1. : static_cast<double>(inds);
+				pop.getVars().setVar((boost::format("%1%{%2%}") % subPopVar_String(*it,
+							ancestryDosage_String, m_suffix) % loci[idx]).str(), spec);
+			}
+		}
+		//
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			intDict::const_iterator c = cnt[idx].begin();
+			intDict::const_iterator cEnd = cnt[idx].end();
+			for (; c != cEnd; ++c)
+				allCnt[idx][c->first] += c->second;
+			tupleDict::const_iterator d = dosage[idx].begin();
+			tupleDict::const_iterator dEnd = dosage[idx].end();
+			for (; d != dEnd; ++d)
+				allDosage[idx][d->first] += d->second;
+		}
+		allInds += inds;
+	}
+	if (m_vars.contains(ancestryFreq_String)) {
+		pop.getVars().removeVar(ancestryFreq_String + m_suffix);
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			intDict::iterator c = allCnt[idx].begin();
+			intDict::iterator cEnd = allCnt[idx].end();
+			for (; c != cEnd; ++c)
+				c->second /= allInds == 0 ? 1. : static_cast<double>(allInds * ply);
+			pop.getVars().setVar((boost::format("%1%%2%{%3%}") % ancestryFreq_String
+					% m_suffix % loci[idx]).str(), allCnt[idx]);
+		}
+	}
+	if (m_vars.contains(ancestryDosage_String)) {
+		pop.getVars().removeVar(ancestryDosage_String + m_suffix);
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			tupleDict::iterator d = allDosage[idx].begin();
+			tupleDict::iterator dEnd = allDosage[idx].end();
+			for (; d != dEnd; ++d)
+				d->second /= allInds == 0 ? 1. : static_cast<double>(allInds);
+			pop.getVars().setVar((boost::format("%1%%2%{%3%}") % ancestryDosage_String
+					% m_suffix % loci[idx]).str(), allDosage[idx]);
+		}
+	}
+#else
+	// lineage is not tracked in this module, set empty statistics
+	for (; it != itEnd; ++it) {
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			if (m_vars.contains(ancestryFreq_sp_String))
+				pop.getVars().setVar((boost::format("%1%{%2%}") % subPopVar_String(*it,
+							ancestryFreq_String, m_suffix) % loci[idx]).str(), intDict());
+			if (m_vars.contains(ancestryDosage_sp_String))
+				pop.getVars().setVar((boost::format("%1%{%2%}") % subPopVar_String(*it,
+							ancestryDosage_String, m_suffix) % loci[idx]).str(), tupleDict());
+		}
+	}
+	for (size_t idx = 0; idx < loci.size(); ++idx) {
+		if (m_vars.contains(ancestryFreq_String))
+			pop.getVars().setVar((boost::format("%1%%2%{%3%}") % ancestryFreq_String
+					% m_suffix % loci[idx]).str(), intDict());
+		if (m_vars.contains(ancestryDosage_String))
+			pop.getVars().setVar((boost::format("%1%%2%{%3%}") % ancestryDosage_String
+					% m_suffix % loci[idx]).str(), tupleDict());
+	}
+#endif
+	return true;
+}
+
+
+/* Counting kernels for the frequency stats below. This file is compiled
+   once for each allele module, so the kernels are specialized through the
+   module macros instead of testing storage properties inside the counting
+   loops: the binary module sums bit values directly, the long allele module
+   counts into a dictionary, and the remaining non-mutant modules count into
+   a vector that covers the whole allele range. */
+
+#ifdef LONGALLELE
+void countAllelesAtLoc(IndAlleleIterator a, intDict & alleles, size_t & allAlleles)
+{
+	for (; a.valid(); ++a) {
+		alleles[a.value()]++;
+		allAlleles++;
+	}
+}
+
+
+#elif defined(BINARYALLELE)
+void countAllelesAtLoc(IndAlleleIterator a, vectoru & alleles, size_t & allAlleles)
+{
+	// summing bit values avoids an indexed store for each allele
+	size_t ones = 0;
+
+	for (; a.valid(); ++a) {
+		ones += a.value();
+		allAlleles++;
+	}
+	alleles[0] = allAlleles - ones;
+	alleles[1] = ones;
+}
+
+
+#elif !defined(MUTANTALLELE)
+void countAllelesAtLoc(IndAlleleIterator a, vectoru & alleles, size_t & allAlleles)
+{
+	// counters for the whole allele range avoid a size check for each allele
+	alleles.assign(ModuleMaxAllele + 1, 0);
+	for (; a.valid(); ++a) {
+		alleles[a.value()]++;
+		allAlleles++;
+	}
+	// trim trailing wild type counters so that consumers iterate over the
+	// same range as before
+	size_t last = alleles.size();
+	while (last > 2 && alleles[last - 1] == 0)
+		--last;
+	alleles.resize(last);
+}
+
+
+#endif
+
+#ifdef MUTANTALLELE
+/* one sweep over the stored mutants of each diploid individual replaces a
+   sparse lookup for every locus and ploidy copy */
+void countHeteroAtLoci(Population & pop, size_t subPop, const vectoru & loci,
+                       uintDict & heteroCnt, uintDict & homoCnt)
+{
+	size_t totNumLoci = pop.totNumLoci();
+	// quick membership test of target loci
+	std::vector<bool> onLoci(totNumLoci, false);
+
+	for (size_t idx = 0; idx < loci.size(); ++idx)
+		onLoci[loci[idx]] = true;
+
+	vectoru hetero(totNumLoci, 0);
+	size_t indCnt = 0;
+	IndIterator ind = pop.indIterator(subPop);
+	for (; ind.valid(); ++ind, ++indCnt) {
+		GenoIterator b0 = ind->genoBegin(0);
+		GenoIterator b1 = ind->genoBegin(1);
+		size_t base0 = b0.index();
+		size_t base1 = b1.index();
+		vectorm::val_iterator i0 = b0.get_val_iterator();
+		vectorm::val_iterator i0_end = ind->genoEnd(0).get_val_iterator();
+		vectorm::val_iterator i1 = b1.get_val_iterator();
+		vectorm::val_iterator i1_end = ind->genoEnd(1).get_val_iterator();
+		// merge the two sorted mutant lists of the homologous chromosome
+		// sets; a locus is heterozygous if the two copies carry different
+		// values, where a missing entry stands for the wild type allele.
+		while (i0 != i0_end || i1 != i1_end) {
+			size_t loc0 = i0 != i0_end ? i0->first - base0 : totNumLoci;
+			size_t loc1 = i1 != i1_end ? i1->first - base1 : totNumLoci;
+			if (loc0 < loc1) {
+				if (i0->second != 0 && onLoci[loc0])
+					++hetero[loc0];
+				++i0;
+			} else if (loc1 < loc0) {
+				if (i1->second != 0 && onLoci[loc1])
+					++hetero[loc1];
+				++i1;
+			} else {
+				if (i0->second != i1->second && onLoci[loc0])
+					++hetero[loc0];
+				++i0;
+				++i1;
+			}
+		}
+	}
+	for (size_t idx = 0; idx < loci.size(); ++idx) {
+		size_t loc = loci[idx];
+		heteroCnt[loc] = static_cast<double>(hetero[loc]);
+		homoCnt[loc] = static_cast<double>(indCnt - hetero[loc]);
+	}
+}
+
+
+#else
+void countHeteroAtLoc(IndAlleleIterator a, size_t & hetero, size_t & homo)
+{
+#  ifdef BINARYALLELE
+	// comparison results are summed without branching
+	size_t pairs = 0;
+
+	for (; a.valid(); a += 2) {
+		hetero += a.value() ^ (a + 1).value();
+		++pairs;
+	}
+	homo = pairs - hetero;
+#  else
+	for (; a.valid(); a += 2) {
+		if (a.value() != (a + 1).value())
+			hetero += 1;
+		else
+			homo += 1;
+	}
+#  endif
+}
+
+
+#endif
+
+#ifdef BINARYALLELE
+/* genotypes at a biallelic locus fall into at most 2^ploidy classes, so the
+   autosomal case is counted in a flat array instead of a tuple map */
+void countGenoAtLoc(IndIterator ind, size_t loc, size_t ply,
+                    tupleDict & genotypes, size_t & allGenotypes)
+{
+	vectoru cnt(size_t(1) << ply, 0);
+
+	for (; ind.valid(); ++ind) {
+		size_t key = 0;
+		for (size_t p = 0; p < ply; ++p)
+			key = (key << 1) | ind->allele(loc, p);
+		++cnt[key];
+		++allGenotypes;
+	}
+	for (size_t key = 0; key < cnt.size(); ++key) {
+		if (cnt[key] == 0)
+			continue;
+		vectori genotype(ply);
+		for (size_t p = 0; p < ply; ++p)
+			genotype[p] = (key >> (ply - 1 - p)) & 1;
+		genotypes[genotype] = static_cast<double>(cnt[key]);
+	}
+}
+
+
+#else
+
+// Count genotypes at loc into a fixed-size array indexed by a packed
+// genotype code, which avoids a tuple map node per distinct genotype and a
+// map lookup per individual on (nearly) biallelic loci. Returns false
+// without touching genotypes or allGenotypes if an allele does not fit the
+// packed code, in which case the caller counts into the tuple map instead
+// (the iterator is passed by value, so the caller restarts from the first
+// individual).
+bool countGenoAtLocDense(IndIterator ind, size_t loc, size_t ply,
+                         tupleDict & genotypes, size_t & allGenotypes)
+{
+	// four bits per allele: loci with alleles above 15 are genuinely
+	// multiallelic and stay in the tuple map, as do ploidies for which
+	// the counter array would no longer be small (diploid uses 256).
+	const size_t alleleBits = 4;
+	const size_t maxCode = size_t(1) << alleleBits;
+
+	if (ply * alleleBits > 16)
+		return false;
+	vectoru cnt(size_t(1) << (ply * alleleBits), 0);
+	size_t n = 0;
+	for (; ind.valid(); ++ind) {
+		size_t key = 0;
+		for (size_t p = 0; p < ply; ++p) {
+			size_t a = ind->allele(loc, p);
+			if (a >= maxCode)
+				return false;
+			key = (key << alleleBits) | a;
+		}
+		++cnt[key];
+		++n;
+	}
+	for (size_t key = 0; key < cnt.size(); ++key) {
+		if (cnt[key] == 0)
+			continue;
+		vectori genotype(ply);
+		for (size_t p = 0; p < ply; ++p)
+			genotype[p] = static_cast<int>((key >> (alleleBits * (ply - 1 - p))) & (maxCode - 1));
+		genotypes[genotype] = static_cast<double>(cnt[key]);
+	}
+	allGenotypes += n;
+	return true;
+}
+
+#endif
+
 statAlleleFreq::statAlleleFreq(const lociList & loci, const subPopList & subPops,
 	const stringList & vars, const string & suffix)
 	: m_loci(loci), m_subPops(subPops), m_vars(), m_suffix(suffix)
@@ -1029,44 +1675,82 @@ bool statAlleleFreq::apply(Population & pop) const
 
 		// for each locus, a dict of allele counts
 		std::map<size_t, intDict> loci_alleles;
-		// now we need to go through all alleles
-		IndIterator ind = pop.indIterator(it->subPop());
-		size_t totNumLoci = pop.totNumLoci();
-		for (; ind.valid(); ++ind) {
-			GenoIterator it = ind->genoBegin();
-			GenoIterator it_end = ind->genoEnd();
-			vectorm::val_iterator index_it = it.get_val_iterator();
-			vectorm::val_iterator index_it_end = it_end.get_val_iterator();
-			size_t indIndex = it.index();
-			for (; index_it != index_it_end; ++index_it) {
-				DBG_FAILIF(index_it->second == 0, RuntimeError,
-					"Non-zero allele found for mutant module.");
-				size_t lociValue = (index_it->first - indIndex) % totNumLoci;
-				// if lociValue is unspecified (not ALL_AVAIL)
-				if (m_loci.indexOf(lociValue) == NOT_FOUND)
-					continue;
-				if (!no_sex_chromosome) {
-					size_t p = (index_it->first - indIndex) / totNumLoci;
-					size_t chromType = pop.chromType(pop.chromLocusPair(lociValue).first);
-					if ((ind->sex() == FEMALE && chromType == CHROMOSOME_Y) ||
-					    (ind->sex() == MALE && (
-					                            (chromType == CHROMOSOME_X && p == 1) ||
-					                            (chromType == CHROMOSOME_Y && p == 0))))
+		/* the sweep below visits every mutant stored for the subpopulation,
+		   which is the right thing to do when most loci are needed. When only
+		   a few loci are requested from a population that has accumulated
+		   many mutants, reading the requested loci directly is cheaper even
+		   though each read is a map lookup. The mutant count is maintained by
+		   the genotype container so this choice is re-made for free each time
+		   the statistic is calculated, and follows the density of the
+		   current generation. */
+		bool perLocus = false;
+		if (!m_loci.allAvail() && no_sex_chromosome) {
+			size_t numMutants = pop.totNumMutants();
+			size_t denseReads = loci.size() * pop.subPopSize(*it) * pop.ploidy();
+			// cost of one indexed read, roughly the depth of the mutant map
+			size_t readCost = 1;
+			for (size_t m = numMutants; m > 1; m >>= 1)
+				++readCost;
+			perLocus = denseReads * readCost < numMutants;
+		}
+		DBG_DO(DBG_STATOR, cerr << "Counting alleles with the "
+			<< (perLocus ? "per-locus" : "mutant sweep") << " kernel" << endl);
+		if (perLocus) {
+			size_t ply = pop.ploidy();
+			for (size_t idx = 0; idx < loci.size(); ++idx) {
+				size_t loc = loci[idx];
+				intDict a;
+				IndIterator ind = pop.indIterator(it->subPop());
+				for (; ind.valid(); ++ind)
+					for (size_t p = 0; p < ply; ++p) {
+						ULONG al = ind->allele(loc, static_cast<ssize_t>(p));
+						if (al != 0)
+							++a[static_cast<int>(al)];
+					}
+				// loci without an entry are treated as all wildtype below
+				if (!a.empty())
+					loci_alleles[loc] = a;
+			}
+		} else {
+			// now we need to go through all alleles
+			IndIterator ind = pop.indIterator(it->subPop());
+			size_t totNumLoci = pop.totNumLoci();
+			for (; ind.valid(); ++ind) {
+				GenoIterator it = ind->genoBegin();
+				GenoIterator it_end = ind->genoEnd();
+				vectorm::val_iterator index_it = it.get_val_iterator();
+				vectorm::val_iterator index_it_end = it_end.get_val_iterator();
+				size_t indIndex = it.index();
+				for (; index_it != index_it_end; ++index_it) {
+					DBG_FAILIF(index_it->second == 0, RuntimeError,
+						"Non-zero allele found for mutant module.");
+					size_t lociValue = (index_it->first - indIndex) % totNumLoci;
+					// if lociValue is unspecified (not ALL_AVAIL)
+					if (m_loci.indexOf(lociValue) == NOT_FOUND)
 						continue;
-				}
-				// record allele
-				std::map<size_t, intDict>::iterator allele_it = loci_alleles.find(lociValue);
-				if (allele_it == loci_alleles.end()) {
-					intDict a;
-					a[index_it->second] = 1;
-					loci_alleles.insert(std::map<size_t, intDict>::value_type(lociValue, a));
-				} else {
-					intDict::iterator aa = allele_it->second.find(index_it->second);
-					// a new allele
-					if (aa == allele_it->second.end())
-						allele_it->second[index_it->second] = 1;
-					else
-						aa->second += 1;
+					if (!no_sex_chromosome) {
+						size_t p = (index_it->first - indIndex) / totNumLoci;
+						size_t chromType = pop.chromType(pop.chromLocusPair(lociValue).first);
+						if ((ind->sex() == FEMALE && chromType == CHROMOSOME_Y) ||
+						    (ind->sex() == MALE && (
+						                            (chromType == CHROMOSOME_X && p == 1) ||
+						                            (chromType == CHROMOSOME_Y && p == 0))))
+							continue;
+					}
+					// record allele
+					std::map<size_t, intDict>::iterator allele_it = loci_alleles.find(lociValue);
+					if (allele_it == loci_alleles.end()) {
+						intDict a;
+						a[index_it->second] = 1;
+						loci_alleles.insert(std::map<size_t, intDict>::value_type(lociValue, a));
+					} else {
+						intDict::iterator aa = allele_it->second.find(index_it->second);
+						// a new allele
+						if (aa == allele_it->second.end())
+							allele_it->second[index_it->second] = 1;
+						else
+							aa->second += 1;
+					}
 				}
 			}
 		}
@@ -1125,7 +1809,7 @@ bool statAlleleFreq::apply(Population & pop) const
 #else       // for mutant allele
 
 
-#  pragma omp parallel for if(numThreads() > 1)
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(loci.size())) if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
 			size_t loc = loci[idx];
 
@@ -1136,20 +1820,47 @@ bool statAlleleFreq::apply(Population & pop) const
 #  endif
 			size_t allAlleles = 0;
 
-			// go through all alleles
-			IndAlleleIterator a = pop.alleleIterator(loc, it->subPop());
-			// use allAllelel here because some marker does not have full number
-			// of alleles (e.g. markers on chromosome X and Y).
-			for (; a.valid(); ++a) {
-				Allele v = a.value();
-#  ifndef BINARYALLELE
-#    ifndef LONGALLELE
-				if (v >= alleles.size())
-					alleles.resize(v + 1, 0);
-#    endif
+			// counts of this locus may have been cached by an earlier stat
+			// call on an unchanged population (e.g. a selector or terminator
+			// that computed allele frequencies in the same generation).
+			bool fromCache = false;
+#  pragma omp critical
+			{
+				const uintDict * cached = pop.cachedAlleleCnt(loc, *it, allAlleles);
+				if (cached != NULL) {
+					uintDict::const_iterator ci = cached->begin();
+					uintDict::const_iterator ciEnd = cached->end();
+					for (; ci != ciEnd; ++ci) {
+#  ifdef LONGALLELE
+						alleles[static_cast<int>(ci->first)] = ci->second;
+#  else
+						if (ci->first >= alleles.size())
+							alleles.resize(ci->first + 1, 0);
+						alleles[ci->first] = static_cast<size_t>(ci->second);
 #  endif
-				alleles[v]++;
-				allAlleles++;
+					}
+					fromCache = true;
+				}
+			}
+			if (!fromCache) {
+				// use allAllelel here because some marker does not have full number
+				// of alleles (e.g. markers on chromosome X and Y).
+				countAllelesAtLoc(pop.alleleIterator(loc, it->subPop()), alleles, allAlleles);
+				// stamp the counts so that repeated stat calls within this
+				// generation are served from the cache
+				uintDict d;
+#  ifdef LONGALLELE
+				intDict::const_iterator ci = alleles.begin();
+				intDict::const_iterator ciEnd = alleles.end();
+				for (; ci != ciEnd; ++ci)
+					d[ci->first] = ci->second;
+#  else
+				for (size_t i = 0; i < alleles.size(); ++i)
+					if (alleles[i] != 0)
+						d[i] = static_cast<double>(alleles[i]);
+#  endif
+#  pragma omp critical
+				pop.cacheAlleleCnt(loc, *it, d, allAlleles);
 			}
 			// total allele count
 #  ifdef LONGALLELE
@@ -1295,35 +2006,59 @@ bool statHeteroFreq::apply(Population & pop) const
 		uintDict heteroCnt;
 		uintDict homoCnt;
 
-#pragma omp parallel for if(numThreads() > 1)
+#ifdef MUTANTALLELE
+#  ifndef OPTIMIZED
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			size_t chromType = pop.chromType(pop.chromLocusPair(loci[idx]).first);
+			DBG_FAILIF(chromType == CHROMOSOME_X || chromType == CHROMOSOME_Y || chromType == MITOCHONDRIAL,
+				ValueError, "Heterozygosity count for sex and mitochondrial chromosomes is not supported.");
+		}
+#  endif
+		countHeteroAtLoci(pop, it->subPop(), loci, heteroCnt, homoCnt);
+		for (size_t idx = 0; idx < loci.size(); ++idx) {
+			size_t loc = loci[idx];
+			allHeteroCnt[loc] += heteroCnt[loc];
+			allHomoCnt[loc] += homoCnt[loc];
+		}
+#else
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(loci.size())) if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
 			size_t loc = loci[idx];
 
-#ifndef OPTIMIZED
+#  ifndef OPTIMIZED
 			size_t chromType = pop.chromType(pop.chromLocusPair(loc).first);
 			DBG_FAILIF(chromType == CHROMOSOME_X || chromType == CHROMOSOME_Y || chromType == MITOCHONDRIAL,
 				ValueError, "Heterozygosity count for sex and mitochondrial chromosomes is not supported.");
-#endif
-			size_t hetero = 0;
-			size_t homo = 0;
-
-			// go through all alleles
-			IndAlleleIterator a = pop.alleleIterator(loc, it->subPop());
-			for (; a.valid(); a += 2) {
-				if (a.value() != (a + 1).value())
-					hetero += 1;
-				else
-					homo += 1;
+#  endif
+			double hetero = 0;
+			double homo = 0;
+
+			// counts of this locus may have been filled by the shared
+			// genotype scan of this Stat call, or by an earlier stat call
+			// on an unchanged population.
+			bool fromCache = false;
+#  pragma omp critical
+			fromCache = pop.cachedHeteroCnt(loc, *it, hetero, homo);
+			if (!fromCache) {
+				size_t heteroCount = 0;
+				size_t homoCount = 0;
+				// go through all alleles
+				countHeteroAtLoc(pop.alleleIterator(loc, it->subPop()), heteroCount, homoCount);
+				hetero = static_cast<double>(heteroCount);
+				homo = static_cast<double>(homoCount);
+#  pragma omp critical
+				pop.cacheHeteroCnt(loc, *it, hetero, homo);
 			}
-#pragma omp critical
+#  pragma omp critical
 			{
-				heteroCnt[loc] = static_cast<double>(hetero);
-				homoCnt[loc] = static_cast<double>(homo);
+				heteroCnt[loc] = hetero;
+				homoCnt[loc] = homo;
 				//
 				allHeteroCnt[loc] += heteroCnt[loc];
 				allHomoCnt[loc] += homoCnt[loc];
 			}
 		}
+#endif
 		pop.deactivateVirtualSubPop(it->subPop());
 		// output subpopulation variable?
 		if (m_vars.contains(HeteroNum_sp_String)) {
@@ -1469,42 +2204,66 @@ bool statGenoFreq::apply(Population & pop) const
 
 		pop.activateVirtualSubPop(*it);
 
-#pragma omp parallel for if(numThreads() > 1)
+#pragma omp parallel for schedule(dynamic, ompChunkSize(loci.size())) if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
 			size_t loc = loci[idx];
 
 			tupleDict genotypes;
 			size_t allGenotypes = 0;
 
-			// go through all alleles
-			IndIterator ind = pop.indIterator(it->subPop());
-			// the simple case, the speed is potentially faster
-			if (!pop.isHaplodiploid() && (chromTypes[idx] == AUTOSOME || chromTypes[idx] == CUSTOMIZED)) {
-				for (; ind.valid(); ++ind) {
-					vectori genotype(ply);
-					for (size_t p = 0; p < ply; ++p)
-						genotype[p] = ind->allele(loc, p);
-					genotypes[genotype]++;
-					allGenotypes++;
+			// counts of this locus may have been filled by the shared
+			// genotype scan of this Stat call, or by an earlier stat call
+			// on an unchanged population.
+			bool fromCache = false;
+#pragma omp critical
+			{
+				const tupleDict * cached = pop.cachedGenoCnt(loc, *it, allGenotypes);
+				if (cached != NULL) {
+					genotypes = *cached;
+					fromCache = true;
 				}
-			} else {
-				for (; ind.valid(); ++ind) {
-					vectori genotype;
-					for (size_t p = 0; p < ply; ++p) {
-						if (p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
-							continue;
-						if (chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
-							continue;
-						if (((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
-						     (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
-							continue;
-						if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
-							continue;
-						genotype.push_back(ind->allele(loc, p));
+			}
+			if (!fromCache) {
+				// go through all alleles
+				IndIterator ind = pop.indIterator(it->subPop());
+				// the simple case, the speed is potentially faster
+				if (!pop.isHaplodiploid() && (chromTypes[idx] == AUTOSOME || chromTypes[idx] == CUSTOMIZED)) {
+#ifdef BINARYALLELE
+					countGenoAtLoc(ind, loc, ply, genotypes, allGenotypes);
+#else
+					if (!countGenoAtLocDense(ind, loc, ply, genotypes, allGenotypes)) {
+						for (; ind.valid(); ++ind) {
+							vectori genotype(ply);
+							for (size_t p = 0; p < ply; ++p)
+								genotype[p] = ind->allele(loc, p);
+							genotypes[genotype]++;
+							allGenotypes++;
+						}
+					}
+#endif
+				} else {
+					for (; ind.valid(); ++ind) {
+						vectori genotype;
+						for (size_t p = 0; p < ply; ++p) {
+							if (p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
+								continue;
+							if (chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
+								continue;
+							if (((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
+							     (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+								continue;
+							if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+								continue;
+							genotype.push_back(ind->allele(loc, p));
+						}
+						genotypes[genotype]++;
+						allGenotypes++;
 					}
-					genotypes[genotype]++;
-					allGenotypes++;
 				}
+				// stamp the counts for later stat calls on an unchanged
+				// population
+#pragma omp critical
+				pop.cacheGenoCnt(loc, *it, genotypes, allGenotypes);
 			}
 			// total allele count
 			tupleDict::iterator dct = genotypes.begin();
@@ -1560,6 +2319,121 @@ bool statGenoFreq::apply(Population & pop) const
 }
 
 
+void Stat::fillSharedCnt(Population & pop) const
+{
+#ifdef MUTANTALLELE
+	// the mutant module counts alleles and heterozygotes at all loci in
+	// single sweeps of the sparse mutant lists, which a per-locus genotype
+	// scan cannot improve upon.
+	(void)pop;
+#else
+	const lociList & alleleLoci = m_alleleFreq.loci();
+	const lociList & heteroLoci = m_heteroFreq.loci();
+	const lociList & genoLoci = m_genoFreq.loci();
+
+	// a genotype scan is shared only when it is needed anyway (genoFreq)
+	// and at least one other component requests counts at the same loci.
+	if (genoLoci.empty() || (alleleLoci.empty() && heteroLoci.empty()))
+		return;
+
+	// counts can only be shared between components that collect them over
+	// the same (virtual) subpopulations.
+	subPopList subPops = m_genoFreq.subPops().expandFrom(pop);
+	size_t ply = pop.ploidy();
+	bool shareAllele = !alleleLoci.empty();
+	bool shareHetero = !heteroLoci.empty() && ply == 2;
+	if (shareAllele) {
+		subPopList sp = m_alleleFreq.subPops().expandFrom(pop);
+		shareAllele = sp.size() == subPops.size();
+		for (size_t i = 0; shareAllele && i < sp.size(); ++i)
+			shareAllele = sp[i] == subPops[i];
+	}
+	if (shareHetero) {
+		subPopList sp = m_heteroFreq.subPops().expandFrom(pop);
+		shareHetero = sp.size() == subPops.size();
+		for (size_t i = 0; shareHetero && i < sp.size(); ++i)
+			shareHetero = sp[i] == subPops[i];
+	}
+	if (!shareAllele && !shareHetero)
+		return;
+
+	// restrict the shared scan to loci for which all participating
+	// components count every ploidy copy of every individual, so that
+	// allele and heterozygote counts follow from the genotype classes.
+	// Loci on sex or mitochondrial chromosomes and haplodiploid
+	// populations are left to the specialized scans of each component.
+	const vectoru & loci = genoLoci.elems(&pop);
+	vectoru sharedLoci;
+	for (size_t idx = 0; idx < loci.size(); ++idx) {
+		size_t loc = loci[idx];
+		size_t chromType = pop.chromType(pop.chromLocusPair(loc).first);
+		if (pop.isHaplodiploid() || (chromType != AUTOSOME && chromType != CUSTOMIZED))
+			continue;
+		if ((shareAllele && alleleLoci.indexOf(loc) != NOT_FOUND) ||
+		    (shareHetero && heteroLoci.indexOf(loc) != NOT_FOUND))
+			sharedLoci.push_back(loc);
+	}
+	if (sharedLoci.empty())
+		return;
+
+	subPopList::const_iterator it = subPops.begin();
+	subPopList::const_iterator itEnd = subPops.end();
+	for (; it != itEnd; ++it) {
+		pop.activateVirtualSubPop(*it);
+
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(sharedLoci.size())) if(numThreads() > 1)
+		for (ssize_t idx = 0; idx < static_cast<ssize_t>(sharedLoci.size()); ++idx) {
+			size_t loc = sharedLoci[idx];
+
+			tupleDict genotypes;
+			size_t allGenotypes = 0;
+			IndIterator ind = pop.indIterator(it->subPop());
+#  ifdef BINARYALLELE
+			countGenoAtLoc(ind, loc, ply, genotypes, allGenotypes);
+#  else
+			if (!countGenoAtLocDense(ind, loc, ply, genotypes, allGenotypes)) {
+				for (; ind.valid(); ++ind) {
+					vectori genotype(ply);
+					for (size_t p = 0; p < ply; ++p)
+						genotype[p] = ind->allele(loc, p);
+					genotypes[genotype]++;
+					allGenotypes++;
+				}
+			}
+#  endif
+			// derive allele and heterozygote counts from the genotype
+			// classes
+			uintDict alleles;
+			double hetero = 0;
+			double homo = 0;
+			tupleDict::const_iterator dct = genotypes.begin();
+			tupleDict::const_iterator dctEnd = genotypes.end();
+			for (; dct != dctEnd; ++dct) {
+				const vectori & genotype = dct->first;
+				for (size_t p = 0; p < genotype.size(); ++p)
+					alleles[genotype[p]] += dct->second;
+				if (ply == 2) {
+					if (genotype[0] != genotype[1])
+						hetero += dct->second;
+					else
+						homo += dct->second;
+				}
+			}
+#  pragma omp critical
+			{
+				pop.cacheGenoCnt(loc, *it, genotypes, allGenotypes);
+				if (shareAllele && alleleLoci.indexOf(loc) != NOT_FOUND)
+					pop.cacheAlleleCnt(loc, *it, alleles, allGenotypes * ply);
+				if (shareHetero && heteroLoci.indexOf(loc) != NOT_FOUND)
+					pop.cacheHeteroCnt(loc, *it, hetero, homo);
+			}
+		}
+		pop.deactivateVirtualSubPop(it->subPop());
+	}
+#endif
+}
+
+
 statHaploFreq::statHaploFreq(const intMatrix & haploFreq, const subPopList & subPops,
 	const stringList & vars, const string & suffix)
 	: m_loci(haploFreq.elems()), m_subPops(subPops), m_vars(), m_suffix(suffix)
@@ -1624,7 +2498,7 @@ bool statHaploFreq::apply(Population & pop) const
 
 		pop.activateVirtualSubPop(*it);
 
-#pragma omp parallel for if(numThreads() > 1)
+#pragma omp parallel for schedule(dynamic, ompChunkSize(m_loci.size())) if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(m_loci.size()); ++idx) {
 			const vectori & loci = m_loci[idx];
 			size_t nLoci = loci.size();
@@ -1643,24 +2517,83 @@ bool statHaploFreq::apply(Population & pop) const
 			tupleDict haplotypes;
 			size_t allHaplotypes = 0;
 
-			// go through all individual
-			IndIterator ind = pop.indIterator(it->subPop());
-			for (; ind.valid(); ++ind) {
-				vectori haplotype(loci.size());
-				for (size_t p = 0; p < ply; ++p) {
-					if (p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
-						continue;
-					if (chromType == CHROMOSOME_Y && ind->sex() == FEMALE)
-						continue;
-					if (((chromType == CHROMOSOME_X && p == 1) ||
-					     (chromType == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
-						continue;
-					if (chromType == MITOCHONDRIAL && p > 0)
-						continue;
-					for (size_t idx = 0; idx < nLoci; ++idx)
-						haplotype[idx] = ind->allele(loci[idx], p);
-					haplotypes[haplotype]++;
-					allHaplotypes++;
+			// short haplotypes are packed into a fixed-width integer key and
+			// counted in a hash table: for large populations the per-haplotype
+			// tuple allocation and node rebalancing of the ordered map dominate
+			// this loop. Alleles wider than the packing width (possible in the
+			// long allele modules) are detected and fall back to the tuple map.
+#ifdef BINARYALLELE
+			const size_t alleleBits = 1;
+#else
+			const size_t alleleBits = ModuleMaxAllele <= 255 ? 8 : 16;
+#endif
+			bool packed = nLoci * alleleBits <= sizeof(size_t) * 8;
+			if (packed) {
+				PackedHaploCnt packedCnt;
+				IndIterator ind = pop.indIterator(it->subPop());
+				for (; ind.valid() && packed; ++ind) {
+					for (size_t p = 0; p < ply; ++p) {
+						if (p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
+							continue;
+						if (chromType == CHROMOSOME_Y && ind->sex() == FEMALE)
+							continue;
+						if (((chromType == CHROMOSOME_X && p == 1) ||
+						     (chromType == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+							continue;
+						if (chromType == MITOCHONDRIAL && p > 0)
+							continue;
+						size_t hapKey = 0;
+						for (size_t i = 0; i < nLoci; ++i) {
+							size_t a = ind->allele(loci[i], p);
+							if ((a >> alleleBits) != 0) {
+								packed = false;
+								break;
+							}
+							hapKey = (hapKey << alleleBits) | a;
+						}
+						if (!packed)
+							break;
+						packedCnt[hapKey]++;
+						allHaplotypes++;
+					}
+				}
+				if (packed) {
+					// expand the packed keys back into tuples for the output
+					// variables; there is one entry per distinct haplotype.
+					PackedHaploCnt::const_iterator cnt = packedCnt.begin();
+					PackedHaploCnt::const_iterator cntEnd = packedCnt.end();
+					for (; cnt != cntEnd; ++cnt) {
+						vectori haplotype(nLoci);
+						size_t hapKey = cnt->first;
+						for (size_t i = nLoci; i > 0; --i) {
+							haplotype[i - 1] = hapKey & ((size_t(1) << alleleBits) - 1);
+							hapKey >>= alleleBits;
+						}
+						haplotypes[haplotype] = static_cast<double>(cnt->second);
+					}
+				} else
+					allHaplotypes = 0;
+			}
+			if (!packed) {
+				// go through all individual
+				IndIterator ind = pop.indIterator(it->subPop());
+				for (; ind.valid(); ++ind) {
+					vectori haplotype(loci.size());
+					for (size_t p = 0; p < ply; ++p) {
+						if (p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
+							continue;
+						if (chromType == CHROMOSOME_Y && ind->sex() == FEMALE)
+							continue;
+						if (((chromType == CHROMOSOME_X && p == 1) ||
+						     (chromType == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+							continue;
+						if (chromType == MITOCHONDRIAL && p > 0)
+							continue;
+						for (size_t idx = 0; idx < nLoci; ++idx)
+							haplotype[idx] = ind->allele(loci[idx], p);
+						haplotypes[haplotype]++;
+						allHaplotypes++;
+					}
 				}
 			}
 			// total haplotype count
@@ -1786,7 +2719,7 @@ bool statHaploHomoFreq::apply(Population & pop) const
 		tupleDict heteroCnt;
 		tupleDict homoCnt;
 
-#pragma omp parallel for if(numThreads() > 1)
+#pragma omp parallel for schedule(dynamic, ompChunkSize(m_loci.size())) if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(m_loci.size()); ++idx) {
 			const vectori & loci = m_loci[idx];
 			size_t nLoci = loci.size();
@@ -1803,23 +2736,64 @@ bool statHaploHomoFreq::apply(Population & pop) const
 				DBG_FAILIF(pop.chromType(pop.chromLocusPair(loci[i]).first) != AUTOSOME, ValueError,
 					"Haplotype homozygosity count current only support autosome.");
 			}
-#endif
-			size_t hetero = 0;
-			size_t homo = 0;
-			// go through all individual
-			IndIterator ind = pop.indIterator(it->subPop());
-			for (; ind.valid(); ++ind) {
-				// FIXME: does not consider sex chromosomes
-				bool h = false;
-				for (size_t idx = 0; idx < nLoci; ++idx)
-					if (ind->allele(loci[idx], 0) != ind->allele(loci[idx], 1)) {
-						h = true;
-						break;
+#endif
+			size_t hetero = 0;
+			size_t homo = 0;
+			// short haplotypes use the same fixed-width packing as the
+			// counting loop of statHaploFreq: both strands are extracted once
+			// per individual into packed integers and homozygosity is decided
+			// by a single integer compare. Alleles wider than the packing
+			// width (possible in the long allele modules) fall back to the
+			// locus by locus compare.
+#ifdef BINARYALLELE
+			const size_t alleleBits = 1;
+#else
+			const size_t alleleBits = ModuleMaxAllele <= 255 ? 8 : 16;
+#endif
+			bool packed = nLoci * alleleBits <= sizeof(size_t) * 8;
+			if (packed) {
+				IndIterator ind = pop.indIterator(it->subPop());
+				for (; ind.valid() && packed; ++ind) {
+					size_t key0 = 0;
+					size_t key1 = 0;
+					for (size_t i = 0; i < nLoci; ++i) {
+						size_t a0 = ind->allele(loci[i], 0);
+						size_t a1 = ind->allele(loci[i], 1);
+						if (((a0 | a1) >> alleleBits) != 0) {
+							packed = false;
+							break;
+						}
+						key0 = (key0 << alleleBits) | a0;
+						key1 = (key1 << alleleBits) | a1;
 					}
-				if (h)
-					++hetero;
-				else
-					++homo;
+					if (!packed)
+						break;
+					if (key0 != key1)
+						++hetero;
+					else
+						++homo;
+				}
+				if (!packed) {
+					hetero = 0;
+					homo = 0;
+				}
+			}
+			if (!packed) {
+				// go through all individual
+				IndIterator ind = pop.indIterator(it->subPop());
+				for (; ind.valid(); ++ind) {
+					// FIXME: does not consider sex chromosomes
+					bool h = false;
+					for (size_t idx = 0; idx < nLoci; ++idx)
+						if (ind->allele(loci[idx], 0) != ind->allele(loci[idx], 1)) {
+							h = true;
+							break;
+						}
+					if (h)
+						++hetero;
+					else
+						++homo;
+				}
 			}
 #pragma omp critical
 			{
@@ -1891,17 +2865,17 @@ bool statHaploHomoFreq::apply(Population & pop) const
 
 statInfo::statInfo(const vectorstr & sumOfInfo, const vectorstr & meanOfInfo,
 	const vectorstr & varOfInfo, const vectorstr & maxOfInfo,
-	const vectorstr & minOfInfo,
+	const vectorstr & minOfInfo, const vectorstr & medianOfInfo,
 	const subPopList & subPops, const stringList & vars, const string & suffix)
 	: m_sumOfInfo(sumOfInfo), m_meanOfInfo(meanOfInfo), m_varOfInfo(varOfInfo),
-	m_maxOfInfo(maxOfInfo), m_minOfInfo(minOfInfo),
+	m_maxOfInfo(maxOfInfo), m_minOfInfo(minOfInfo), m_medianOfInfo(medianOfInfo),
 	m_subPops(subPops), m_vars(), m_suffix(suffix)
 {
 	const char * allowedVars[] = {
 		SumOfInfo_String,	 MeanOfInfo_String,	   VarOfInfo_String,
-		MaxOfInfo_String,	 MinOfInfo_String,
+		MaxOfInfo_String,	 MinOfInfo_String,	   MedianOfInfo_String,
 		SumOfInfo_sp_String, MeanOfInfo_sp_String, VarOfInfo_sp_String,
-		MaxOfInfo_sp_String, MinOfInfo_sp_String,
+		MaxOfInfo_sp_String, MinOfInfo_sp_String,  MedianOfInfo_sp_String,
 		""
 	};
 	const char * defaultVars[] = { "" };
@@ -1918,6 +2892,8 @@ statInfo::statInfo(const vectorstr & sumOfInfo, const vectorstr & meanOfInfo,
 			m_vars.push_back(MaxOfInfo_String);
 		if (!m_minOfInfo.empty())
 			m_vars.push_back(MinOfInfo_String);
+		if (!m_medianOfInfo.empty())
+			m_vars.push_back(MedianOfInfo_String);
 	}
 }
 
@@ -1925,7 +2901,7 @@ statInfo::statInfo(const vectorstr & sumOfInfo, const vectorstr & meanOfInfo,
 string statInfo::describe(bool /* format */) const
 {
 	if (m_sumOfInfo.empty() && m_meanOfInfo.empty() && m_varOfInfo.empty()
-	    && m_maxOfInfo.empty() && m_minOfInfo.empty())
+	    && m_maxOfInfo.empty() && m_minOfInfo.empty() && m_medianOfInfo.empty())
 		return "";
 
 	string desc = "calculate\n<ul>/n";
@@ -1974,6 +2950,15 @@ string statInfo::describe(bool /* format */) const
 		}
 		desc += "\n";
 	}
+	if (!m_medianOfInfo.empty()) {
+		desc += "<li>Median of information fields ";
+		for (size_t i = 0; i < m_medianOfInfo.size(); ++i) {
+			if (i != 0)
+				desc += ", ";
+			desc += m_medianOfInfo[i];
+		}
+		desc += "\n";
+	}
 	desc += "</ul>";
 	return desc;
 }
@@ -1982,7 +2967,7 @@ string statInfo::describe(bool /* format */) const
 bool statInfo::apply(Population & pop) const
 {
 	if (m_sumOfInfo.empty() && m_meanOfInfo.empty() && m_varOfInfo.empty()
-	    && m_maxOfInfo.empty() && m_minOfInfo.empty())
+	    && m_maxOfInfo.empty() && m_minOfInfo.empty() && m_medianOfInfo.empty())
 		return true;
 
 	// field indexes
@@ -1991,12 +2976,14 @@ bool statInfo::apply(Population & pop) const
 	size_t numVarFld = m_varOfInfo.size();
 	size_t numMaxFld = m_maxOfInfo.size();
 	size_t numMinFld = m_minOfInfo.size();
+	size_t numMedianFld = m_medianOfInfo.size();
 	//
 	vectoru sumOfInfo(m_sumOfInfo.size());
 	vectoru meanOfInfo(m_meanOfInfo.size());
 	vectoru varOfInfo(m_varOfInfo.size());
 	vectoru maxOfInfo(m_maxOfInfo.size());
 	vectoru minOfInfo(m_minOfInfo.size());
+	vectoru medianOfInfo(m_medianOfInfo.size());
 	for (size_t i = 0; i < numSumFld; ++i)
 		sumOfInfo[i] = pop.infoIdx(m_sumOfInfo[i]);
 	for (size_t i = 0; i < numMeanFld; ++i)
@@ -2007,6 +2994,8 @@ bool statInfo::apply(Population & pop) const
 		maxOfInfo[i] = pop.infoIdx(m_maxOfInfo[i]);
 	for (size_t i = 0; i < numMinFld; ++i)
 		minOfInfo[i] = pop.infoIdx(m_minOfInfo[i]);
+	for (size_t i = 0; i < numMedianFld; ++i)
+		medianOfInfo[i] = pop.infoIdx(m_medianOfInfo[i]);
 
 	vectorf allSumVal(numSumFld);
 	vectorf allMeanSumVal(numMeanFld);
@@ -2016,6 +3005,9 @@ bool statInfo::apply(Population & pop) const
 	vectoru allVarNumVal(numVarFld);
 	vectorf allMaxVal(0);
 	vectorf allMinVal(0);
+	// median needs the values themselves, not a summary that can be
+	// accumulated, so the columns are collected and selected at the end
+	vector<vectorf> allMedianVal(numMedianFld);
 	// for each subpopulation.
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator sp = subPops.begin();
@@ -2031,6 +3023,7 @@ bool statInfo::apply(Population & pop) const
 		vectoru varNumVal(numVarFld, 0);
 		vectorf maxVal(0);
 		vectorf minVal(0);
+		vector<vectorf> medianVal(numMedianFld);
 
 		pop.activateVirtualSubPop(*sp);
 
@@ -2067,6 +3060,8 @@ bool statInfo::apply(Population & pop) const
 						minVal[i] = it->info(minOfInfo[i]);
 				}
 			}
+			for (size_t i = 0; i < numMedianFld; ++i)
+				medianVal[i].push_back(it->info(medianOfInfo[i]));
 		}
 
 		pop.deactivateVirtualSubPop(sp->subPop());
@@ -2100,6 +3095,9 @@ bool statInfo::apply(Population & pop) const
 					if (allMinVal[i] > minVal[i])
 						allMinVal[i] = minVal[i];
 			}
+			for (size_t i = 0; i < numMedianFld; ++i)
+				allMedianVal[i].insert(allMedianVal[i].end(),
+					medianVal[i].begin(), medianVal[i].end());
 			allIndCnt += indCnt;
 		}
 		// output variable
@@ -2134,6 +3132,20 @@ bool statInfo::apply(Population & pop) const
 				dct[m_minOfInfo[i]] = indCnt == 0 ? MISSING_VALUE : minVal[i];
 			pop.getVars().setVar(subPopVar_String(*sp, MinOfInfo_String, m_suffix), dct);
 		}
+		if (m_vars.contains(MedianOfInfo_sp_String)) {
+			strDict dct;
+			for (size_t i = 0; i < numMedianFld; ++i) {
+				if (indCnt == 0)
+					dct[m_medianOfInfo[i]] = MISSING_VALUE;
+				else {
+					// selection is O(N), no full sort of the column is needed
+					vectorf::iterator mid = medianVal[i].begin() + medianVal[i].size() / 2;
+					std::nth_element(medianVal[i].begin(), mid, medianVal[i].end());
+					dct[m_medianOfInfo[i]] = *mid;
+				}
+			}
+			pop.getVars().setVar(subPopVar_String(*sp, MedianOfInfo_String, m_suffix), dct);
+		}
 	}
 	if (m_vars.contains(SumOfInfo_String)) {
 		strDict dct;
@@ -2166,25 +3178,44 @@ bool statInfo::apply(Population & pop) const
 			dct[m_minOfInfo[i]] = allIndCnt == 0 ? MISSING_VALUE : allMinVal[i];
 		pop.getVars().setVar(MinOfInfo_String + m_suffix, dct);
 	}
+	if (m_vars.contains(MedianOfInfo_String)) {
+		strDict dct;
+		for (size_t i = 0; i < numMedianFld; ++i) {
+			if (allIndCnt == 0)
+				dct[m_medianOfInfo[i]] = MISSING_VALUE;
+			else {
+				vectorf::iterator mid = allMedianVal[i].begin() + allMedianVal[i].size() / 2;
+				std::nth_element(allMedianVal[i].begin(), mid, allMedianVal[i].end());
+				dct[m_medianOfInfo[i]] = *mid;
+			}
+		}
+		pop.getVars().setVar(MedianOfInfo_String + m_suffix, dct);
+	}
 	return true;
 }
 
 
-statLD::statLD(const intMatrix & LD,  const subPopList & subPops,
+statLD::statLD(const intMatrix & LD,  long band, const subPopList & subPops,
 	const stringList & vars, const string & suffix)
-	: m_LD(LD.elems()), m_subPops(subPops), m_vars(), m_suffix(suffix)
+	: m_LD(LD.elems()), m_band(band), m_subPops(subPops), m_vars(), m_suffix(suffix)
 {
 	const char * allowedVars[] = {
-		LD_String,		 LD_prime_String,		R2_String,
-		ChiSq_String,	 ChiSq_p_String,		CramerV_String,
-		LD_sp_String,	 LD_prime_sp_String,	R2_sp_String,
-		ChiSq_sp_String, ChiSq_p_sp_String,		CramerV_sp_String,
+		LD_String,			 LD_prime_String,		 R2_String,
+		ChiSq_String,		 ChiSq_p_String,		 CramerV_String,
+		LD_sp_String,		 LD_prime_sp_String,	 R2_sp_String,
+		ChiSq_sp_String,	 ChiSq_p_sp_String,		 CramerV_sp_String,
+		LD_arr_String,		 LD_prime_arr_String,	 R2_arr_String,
+		ChiSq_arr_String,	 ChiSq_p_arr_String,	 CramerV_arr_String,
+		LD_arr_sp_String,	 LD_prime_arr_sp_String, R2_arr_sp_String,
+		ChiSq_arr_sp_String, ChiSq_p_arr_sp_String,	 CramerV_arr_sp_String,
+		LD_band_String,		 LD_prime_band_String,	 R2_band_String,
 		""
 	};
 	const char * defaultVars[] = { LD_String, LD_prime_String, R2_String, "" };
 
 	m_vars.obtainFrom(vars, allowedVars, defaultVars);
 
+	DBG_FAILIF(m_band < 0, ValueError, "Parameter LDBand should be a non-negative number of loci.");
 	for (size_t i = 0; i < m_LD.size(); ++i) {
 		DBG_FAILIF(m_LD[i].size() != 2 && m_LD[i].size() != 4, ValueError,
 			"Parameter LD should be a list of loci pairs with optional primary alleles.");
@@ -2196,7 +3227,7 @@ string statLD::describe(bool /* format */) const
 {
 	string desc;
 
-	if (!m_LD.empty())
+	if (!m_LD.empty() || m_band > 0)
 		desc += "calculate Linkage disequilibrium";
 	return desc;
 }
@@ -2404,6 +3435,164 @@ void statLD::calculateLD(const vectoru & lociMap, const ALLELECNTLIST & alleleCn
 }
 
 
+bool statLD::pairLDMeasures(const ALLELECNT & alleleCnt1, const ALLELECNT & alleleCnt2,
+                            const HAPLOCNT & haploCnt, double & D, double & D_prime, double & R2)
+{
+	double allHaplo = 0;
+	HAPLOCNT::const_iterator hCnt = haploCnt.begin();
+	HAPLOCNT::const_iterator hCntEnd = haploCnt.end();
+
+	for (; hCnt != hCntEnd; ++hCnt)
+		allHaplo += hCnt->second;
+	if (allHaplo == 0)
+		return false;
+	double allAlleles1 = 0;
+	ALLELECNT::const_iterator cnt = alleleCnt1.begin();
+	for (; cnt != alleleCnt1.end(); ++cnt)
+		allAlleles1 += cnt->second;
+	double allAlleles2 = 0;
+	for (cnt = alleleCnt2.begin(); cnt != alleleCnt2.end(); ++cnt)
+		allAlleles2 += cnt->second;
+	size_t nAllele1 = alleleCnt1.size();
+	size_t nAllele2 = alleleCnt2.size();
+	D = 0;
+	D_prime = 0;
+	R2 = 0;
+	ALLELECNT::const_iterator cnt1 = alleleCnt1.begin();
+	for (; cnt1 != alleleCnt1.end(); ++cnt1) {
+		ALLELECNT::const_iterator cnt2 = alleleCnt2.begin();
+		for (; cnt2 != alleleCnt2.end(); ++cnt2) {
+			double P_A = cnt1->second / allAlleles1;
+			double P_B = cnt2->second / allAlleles2;
+			double P_AB = 0;
+			HAPLOCNT::const_iterator h = haploCnt.find(HAPLOCNT::key_type(cnt1->first, cnt2->first));
+			if (h != haploCnt.end())
+				P_AB = h->second / allHaplo;
+			// the same measures as the no-primary-allele branch of calculateLD
+			double d = P_AB - P_A * P_B;
+			double D_max = d > 0 ? std::min(P_A * (1 - P_B), (1 - P_A) * P_B) : std::min(P_A * P_B, (1 - P_A) * (1 - P_B));
+			double Dp = fcmp_eq(D_max, 0.) ? 0. : d / D_max;
+			Dp = std::min(std::max(Dp, -1.0), 1.0);
+			double r2 = (fcmp_eq(P_A, 0) || fcmp_eq(P_B, 0) || fcmp_eq(P_A, 1) || fcmp_eq(P_B, 1)) ? 0. : d * d / P_A / (1 - P_A) / P_B / (1 - P_B);
+			if (nAllele1 <= 2 && nAllele2 <= 2) {
+				// for the monomorphic or diallelic case, there is no need to do an average.
+				D = fabs(d);
+				D_prime = fabs(Dp);
+				R2 = r2;
+				return true;
+			}
+			D += P_A * P_B * fabs(d);
+			D_prime += P_A * P_B * fabs(Dp);
+			R2 += P_A * P_B * r2;
+		}
+	}
+	return true;
+}
+
+
+bool statLD::applyBand(Population & pop) const
+{
+	size_t band = static_cast<size_t>(m_band);
+	size_t totLoci = pop.totNumLoci();
+	size_t ply = pop.ploidy();
+	bool wantLD = m_vars.contains(LD_band_String) || m_vars.contains(LD_String);
+	bool wantDp = m_vars.contains(LD_prime_band_String) || m_vars.contains(LD_prime_String);
+	bool wantR2 = m_vars.contains(R2_band_String) || m_vars.contains(R2_String);
+
+	if (!wantLD && !wantDp && !wantR2)
+		return true;
+
+	// the band buffers use a packed layout: the measure between loci i and
+	// i + d is stored at offset i * band + d - 1, and entries of pairs that
+	// fall off the end of a chromosome remain NaN
+	double nan = std::numeric_limits<double>::quiet_NaN();
+	vectorf LD(wantLD ? totLoci * band : 0, nan);
+	vectorf D_prime(wantDp ? totLoci * band : 0, nan);
+	vectorf R2(wantR2 ? totLoci * band : 0, nan);
+
+	subPopList subPops = m_subPops.expandFrom(pop);
+	for (size_t ch = 0; ch < pop.numChrom(); ++ch) {
+		size_t chBegin = pop.chromBegin(ch);
+		size_t nLoci = pop.numLoci(ch);
+		size_t chromType = pop.chromType(ch);
+		if (nLoci < 2)
+			continue;
+		// extract the columns of one chromosome at a time, so that the
+		// transient copy is bounded by the largest chromosome instead of
+		// the whole genome
+		vector<vectora> columns(nLoci);
+		subPopList::const_iterator it = subPops.begin();
+		subPopList::const_iterator itEnd = subPops.end();
+		for (; it != itEnd; ++it) {
+			pop.activateVirtualSubPop(*it);
+			IndIterator ind = pop.indIterator(it->subPop());
+			for (; ind.valid(); ++ind) {
+				for (size_t p = 0; p < ply; ++p) {
+					if (ply == 2 && p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
+						continue;
+					if (ply == 2 && chromType == CHROMOSOME_Y && ind->sex() == FEMALE)
+						continue;
+					if (ply == 2 && ((chromType == CHROMOSOME_X && p == 1) ||
+					                 (chromType == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+						continue;
+					if (chromType == MITOCHONDRIAL && p > 0)
+						continue;
+					GenoIterator geno = ind->genoBegin(p);
+					for (size_t idx = 0; idx < nLoci; ++idx)
+						columns[idx].push_back(DEREF_ALLELE(geno + chBegin + idx));
+				}
+			}
+			pop.deactivateVirtualSubPop(it->subPop());
+		}
+		// per-locus allele counts, computed once and shared by all pairs
+		// of the band
+		ALLELECNTLIST alleleCnt(nLoci);
+#ifdef _OPENMP
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(nLoci)) if(numThreads() > 1)
+#endif
+		for (ssize_t idx = 0; idx < static_cast<ssize_t>(nLoci); ++idx) {
+			const vectora & col = columns[idx];
+			ALLELECNT & cnt = alleleCnt[idx];
+			for (size_t i = 0; i < col.size(); ++i)
+				cnt[col[i]]++;
+		}
+		// each row of the band owns its slice of the buffers, so threads
+		// write without synchronization
+#ifdef _OPENMP
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(nLoci)) if(numThreads() > 1)
+#endif
+		for (ssize_t idx = 0; idx < static_cast<ssize_t>(nLoci); ++idx) {
+			const vectora & col1 = columns[idx];
+			for (size_t d = 1; d <= band && static_cast<size_t>(idx) + d < nLoci; ++d) {
+				const vectora & col2 = columns[idx + d];
+				HAPLOCNT haploCnt;
+				for (size_t i = 0; i < col1.size(); ++i)
+					haploCnt[HAPLOCNT::key_type(col1[i], col2[i])]++;
+				double D = 0;
+				double Dp = 0;
+				double r2 = 0;
+				if (!pairLDMeasures(alleleCnt[idx], alleleCnt[idx + d], haploCnt, D, Dp, r2))
+					continue;
+				size_t pos = (chBegin + idx) * band + d - 1;
+				if (wantLD)
+					LD[pos] = D;
+				if (wantDp)
+					D_prime[pos] = Dp;
+				if (wantR2)
+					R2[pos] = r2;
+			}
+		}
+	}
+	if (wantLD)
+		pop.getVars().setVarArray(LD_band_String + m_suffix, LD);
+	if (wantDp)
+		pop.getVars().setVarArray(LD_prime_band_String + m_suffix, D_prime);
+	if (wantR2)
+		pop.getVars().setVarArray(R2_band_String + m_suffix, R2);
+	return true;
+}
+
+
 void statLD::outputVar(Population & pop, const string & name, const vectorf & value) const
 {
 	if (value.empty())
@@ -2426,6 +3615,8 @@ void statLD::outputVar(Population & pop, const string & name, const vectorf & va
 
 bool statLD::apply(Population & pop) const
 {
+	if (m_band > 0)
+		applyBand(pop);
 	if (m_LD.empty())
 		return true;
 
@@ -2460,8 +3651,10 @@ bool statLD::apply(Population & pop) const
 	size_t ply = pop.ploidy();
 	for (; it != itEnd; ++it) {
 		const char * spVars[] = {
-			LD_sp_String,	 LD_prime_sp_String,	R2_sp_String,
-			ChiSq_sp_String, ChiSq_p_sp_String,		CramerV_sp_String,
+			LD_sp_String,		 LD_prime_sp_String,	 R2_sp_String,
+			ChiSq_sp_String,	 ChiSq_p_sp_String,		 CramerV_sp_String,
+			LD_arr_sp_String,	 LD_prime_arr_sp_String, R2_arr_sp_String,
+			ChiSq_arr_sp_String, ChiSq_p_arr_sp_String,	 CramerV_arr_sp_String,
 			""
 		};
 		for (size_t i = 0; spVars[i][0]; ++i) {
@@ -2474,38 +3667,56 @@ bool statLD::apply(Population & pop) const
 		ALLELECNTLIST alleleCnt(loci.size());
 		HAPLOCNTLIST haploCnt(m_LD.size());
 
-		// count allele and genotype
-		IndIterator ind = pop.indIterator(it->subPop());
-		for (; ind.valid(); ++ind) {
-			for (size_t p = 0; p < ply; ++p) {
-				if (ply == 2 && p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
-					continue;
-				GenoIterator geno = ind->genoBegin(p);
-				// allele frequency
-				for (size_t idx = 0; idx < nLoci; ++idx) {
-					if (ply == 2 && chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
-						continue;
-					if (ply == 2 && ((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
-					                 (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
-						continue;
-					if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
-						continue;
-					alleleCnt[idx][DEREF_ALLELE(geno + loci[idx])]++;
-				}
-				// haplotype frequency
-				for (size_t idx = 0; idx < nLD; ++idx) {
-					size_t chromType = chromTypes[lociMap[m_LD[idx][0]]];
-					if (chromType == CHROMOSOME_Y && ind->sex() == FEMALE)
-						continue;
-					if (((chromType == CHROMOSOME_X && p == 1) ||
-					     (chromType == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
-						continue;
-					if (chromType == MITOCHONDRIAL && p > 0)
+		// Extract each locus column once into a packed buffer with a single
+		// pass over individuals. Counting loci and pairs from these buffers
+		// reads sequential memory instead of re-walking genotypes for every
+		// requested pair, which matters most when many sliding-window pairs
+		// share loci.
+		vector<vectora> columns(nLoci);
+		{
+			IndIterator ind = pop.indIterator(it->subPop());
+			for (; ind.valid(); ++ind) {
+				for (size_t p = 0; p < ply; ++p) {
+					if (ply == 2 && p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
 						continue;
-					haploCnt[idx][HAPLOCNT::key_type(DEREF_ALLELE(geno + m_LD[idx][0]), DEREF_ALLELE(geno + m_LD[idx][1]))]++;
+					GenoIterator geno = ind->genoBegin(p);
+					for (size_t idx = 0; idx < nLoci; ++idx) {
+						if (ply == 2 && chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
+							continue;
+						if (ply == 2 && ((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
+						                 (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+							continue;
+						if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+							continue;
+						columns[idx].push_back(DEREF_ALLELE(geno + loci[idx]));
+					}
 				}
 			}
 		}
+		// each locus (or locus pair) owns its tally, so threads fill
+		// them without synchronization; dynamic scheduling balances
+		// loci whose allele spectra differ in cost.
+#ifdef _OPENMP
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(nLoci)) if(numThreads() > 1 && nLoci + nLD > 2)
+#endif
+		for (ssize_t idx = 0; idx < static_cast<ssize_t>(nLoci); ++idx) {
+			const vectora & col = columns[idx];
+			ALLELECNT & cnt = alleleCnt[idx];
+			for (size_t i = 0; i < col.size(); ++i)
+				cnt[col[i]]++;
+		}
+#ifdef _OPENMP
+#  pragma omp parallel for schedule(dynamic, ompChunkSize(nLD)) if(numThreads() > 1 && nLoci + nLD > 2)
+#endif
+		for (ssize_t idx = 0; idx < static_cast<ssize_t>(nLD); ++idx) {
+			// both loci of a pair are on chromosomes of the same type so
+			// their columns were filled in lockstep and align element-wise.
+			const vectora & col1 = columns[lociMap[m_LD[idx][0]]];
+			const vectora & col2 = columns[lociMap[m_LD[idx][1]]];
+			HAPLOCNT & cnt = haploCnt[idx];
+			for (size_t i = 0; i < col1.size(); ++i)
+				cnt[HAPLOCNT::key_type(col1[i], col2[i])]++;
+		}
 		pop.deactivateVirtualSubPop(it->subPop());
 		// add to all count
 		for (size_t idx = 0; idx < nLoci; ++idx) {
@@ -2523,13 +3734,15 @@ bool statLD::apply(Population & pop) const
 		}
 		// calculate statistics
 		size_t ldSize = 0;
-		if (m_vars.contains(LD_sp_String) || m_vars.contains(LD_prime_sp_String) || m_vars.contains(R2_sp_String))
+		if (m_vars.contains(LD_sp_String) || m_vars.contains(LD_prime_sp_String) || m_vars.contains(R2_sp_String) ||
+		    m_vars.contains(LD_arr_sp_String) || m_vars.contains(LD_prime_arr_sp_String) || m_vars.contains(R2_arr_sp_String))
 			ldSize = m_LD.size();
 		vectorf LD(ldSize);
 		vectorf D_prime(ldSize);
 		vectorf R2(ldSize);
 		size_t assoSize = 0;
-		if (m_vars.contains(ChiSq_sp_String) || m_vars.contains(ChiSq_p_sp_String) || m_vars.contains(CramerV_sp_String))
+		if (m_vars.contains(ChiSq_sp_String) || m_vars.contains(ChiSq_p_sp_String) || m_vars.contains(CramerV_sp_String) ||
+		    m_vars.contains(ChiSq_arr_sp_String) || m_vars.contains(ChiSq_p_arr_sp_String) || m_vars.contains(CramerV_arr_sp_String))
 			assoSize = m_LD.size();
 		vectorf ChiSq(assoSize);
 		vectorf ChiSq_p(assoSize);
@@ -2550,17 +3763,32 @@ bool statLD::apply(Population & pop) const
 			outputVar(pop, subPopVar_String(*it, ChiSq_p_String, m_suffix), ChiSq_p);
 		if (m_vars.contains(CramerV_sp_String))
 			outputVar(pop, subPopVar_String(*it, CramerV_String, m_suffix), CramerV);
+		// flat typed arrays in the order of the specified locus pairs
+		if (m_vars.contains(LD_arr_sp_String))
+			pop.getVars().setVarArray(subPopVar_String(*it, LD_arr_String, m_suffix), LD);
+		if (m_vars.contains(LD_prime_arr_sp_String))
+			pop.getVars().setVarArray(subPopVar_String(*it, LD_prime_arr_String, m_suffix), D_prime);
+		if (m_vars.contains(R2_arr_sp_String))
+			pop.getVars().setVarArray(subPopVar_String(*it, R2_arr_String, m_suffix), R2);
+		if (m_vars.contains(ChiSq_arr_sp_String))
+			pop.getVars().setVarArray(subPopVar_String(*it, ChiSq_arr_String, m_suffix), ChiSq);
+		if (m_vars.contains(ChiSq_p_arr_sp_String))
+			pop.getVars().setVarArray(subPopVar_String(*it, ChiSq_p_arr_String, m_suffix), ChiSq_p);
+		if (m_vars.contains(CramerV_arr_sp_String))
+			pop.getVars().setVarArray(subPopVar_String(*it, CramerV_arr_String, m_suffix), CramerV);
 	}
 	// output statistics for all (virtual) subpopulations
 	// calculate statistics
 	size_t ldSize = 0;
-	if (m_vars.contains(LD_String) || m_vars.contains(LD_prime_String) || m_vars.contains(R2_String))
+	if (m_vars.contains(LD_String) || m_vars.contains(LD_prime_String) || m_vars.contains(R2_String) ||
+	    m_vars.contains(LD_arr_String) || m_vars.contains(LD_prime_arr_String) || m_vars.contains(R2_arr_String))
 		ldSize = m_LD.size();
 	vectorf LD(ldSize);
 	vectorf D_prime(ldSize);
 	vectorf R2(ldSize);
 	size_t assoSize = 0;
-	if (m_vars.contains(ChiSq_String) || m_vars.contains(ChiSq_p_String) || m_vars.contains(CramerV_String))
+	if (m_vars.contains(ChiSq_String) || m_vars.contains(ChiSq_p_String) || m_vars.contains(CramerV_String) ||
+	    m_vars.contains(ChiSq_arr_String) || m_vars.contains(ChiSq_p_arr_String) || m_vars.contains(CramerV_arr_String))
 		assoSize = m_LD.size();
 	vectorf ChiSq(assoSize);
 	vectorf ChiSq_p(assoSize);
@@ -2581,6 +3809,19 @@ bool statLD::apply(Population & pop) const
 		outputVar(pop, ChiSq_p_String + m_suffix, ChiSq_p);
 	if (m_vars.contains(CramerV_String))
 		outputVar(pop, CramerV_String + m_suffix, CramerV);
+	// flat typed arrays in the order of the specified locus pairs
+	if (m_vars.contains(LD_arr_String))
+		pop.getVars().setVarArray(LD_arr_String + m_suffix, LD);
+	if (m_vars.contains(LD_prime_arr_String))
+		pop.getVars().setVarArray(LD_prime_arr_String + m_suffix, D_prime);
+	if (m_vars.contains(R2_arr_String))
+		pop.getVars().setVarArray(R2_arr_String + m_suffix, R2);
+	if (m_vars.contains(ChiSq_arr_String))
+		pop.getVars().setVarArray(ChiSq_arr_String + m_suffix, ChiSq);
+	if (m_vars.contains(ChiSq_p_arr_String))
+		pop.getVars().setVarArray(ChiSq_p_arr_String + m_suffix, ChiSq_p);
+	if (m_vars.contains(CramerV_arr_String))
+		pop.getVars().setVarArray(CramerV_arr_String + m_suffix, CramerV);
 	return true;
 }
 
@@ -2791,44 +4032,113 @@ bool statAssociation::apply(Population & pop) const
 
 		pop.activateVirtualSubPop(*it);
 
-		IndIterator ind = pop.indIterator(it->subPop());
-		for (; ind.valid(); ++ind) {
-			if (hasAlleleTest) {
-				for (size_t p = 0; p < ply; ++p) {
-					if (ply == 2 && p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
-						continue;
-					GenoIterator geno = ind->genoBegin(p);
-					// allele count
-					for (size_t idx = 0; idx < nLoci; ++idx) {
-						if (ply == 2 && chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
-							continue;
-						if (ply == 2 && ((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
-						                 (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+		if (numThreads() > 1) {
+#ifdef _OPENMP
+			// per-thread counting with a merge under a critical section
+#  pragma omp parallel
+			{
+				ALLELECNTLIST localCaseAllele(nLoci);
+				ALLELECNTLIST localCtrlAllele(nLoci);
+				GENOCNTLIST localCaseGeno(nLoci);
+				GENOCNTLIST localCtrlGeno(nLoci);
+				IndIterator ind = pop.indIterator(it->subPop(), omp_get_thread_num());
+				for (; ind.valid(); ++ind) {
+				if (hasAlleleTest) {
+					for (size_t p = 0; p < ply; ++p) {
+						if (ply == 2 && p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
 							continue;
-						if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+						GenoIterator geno = ind->genoBegin(p);
+						// allele count
+						for (size_t idx = 0; idx < nLoci; ++idx) {
+							if (ply == 2 && chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
+								continue;
+							if (ply == 2 && ((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
+							                 (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+								continue;
+							if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+								continue;
+							if (ind->affected())
+								localCaseAllele[idx][DEREF_ALLELE(geno + loci[idx])]++;
+							else
+								localCtrlAllele[idx][DEREF_ALLELE(geno + loci[idx])]++;
+						}
+					}
+				}
+				// genotype
+				if (hasGenoTest) {
+					GenoIterator geno1 = ind->genoBegin(0);
+					GenoIterator geno2 = ind->genoBegin(1);
+					for (size_t idx = 0; idx < nLoci; ++idx) {
+						if (chromTypes[idx] == CHROMOSOME_X || chromTypes[idx] == CHROMOSOME_Y || chromTypes[idx] == MITOCHONDRIAL)
 							continue;
+						Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
+						Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
+						if (a1 > a2)
+							std::swap(a1, a2);
 						if (ind->affected())
-							caseAlleleCnt[idx][DEREF_ALLELE(geno + loci[idx])]++;
+							localCaseGeno[idx][GENOCNT::key_type(a1, a2)]++;
 						else
-							ctrlAlleleCnt[idx][DEREF_ALLELE(geno + loci[idx])]++;
+							localCtrlGeno[idx][GENOCNT::key_type(a1, a2)]++;
 					}
 				}
-			}
-			// genotype
-			if (hasGenoTest) {
-				GenoIterator geno1 = ind->genoBegin(0);
-				GenoIterator geno2 = ind->genoBegin(1);
+				}
+#  pragma omp critical
 				for (size_t idx = 0; idx < nLoci; ++idx) {
-					if (chromTypes[idx] == CHROMOSOME_X || chromTypes[idx] == CHROMOSOME_Y || chromTypes[idx] == MITOCHONDRIAL)
-						continue;
-					Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
-					Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
-					if (a1 > a2)
-						std::swap(a1, a2);
-					if (ind->affected())
-						caseGenoCnt[idx][GENOCNT::key_type(a1, a2)]++;
-					else
-						ctrlGenoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+					ALLELECNT::const_iterator ac = localCaseAllele[idx].begin();
+					for (; ac != localCaseAllele[idx].end(); ++ac)
+						caseAlleleCnt[idx][ac->first] += ac->second;
+					ac = localCtrlAllele[idx].begin();
+					for (; ac != localCtrlAllele[idx].end(); ++ac)
+						ctrlAlleleCnt[idx][ac->first] += ac->second;
+					GENOCNT::const_iterator gc = localCaseGeno[idx].begin();
+					for (; gc != localCaseGeno[idx].end(); ++gc)
+						caseGenoCnt[idx][gc->first] += gc->second;
+					gc = localCtrlGeno[idx].begin();
+					for (; gc != localCtrlGeno[idx].end(); ++gc)
+						ctrlGenoCnt[idx][gc->first] += gc->second;
+				}
+			}
+#endif
+		} else {
+			IndIterator ind = pop.indIterator(it->subPop());
+			for (; ind.valid(); ++ind) {
+				if (hasAlleleTest) {
+					for (size_t p = 0; p < ply; ++p) {
+						if (ply == 2 && p == 1 && ind->sex() == MALE && pop.isHaplodiploid())
+							continue;
+						GenoIterator geno = ind->genoBegin(p);
+						// allele count
+						for (size_t idx = 0; idx < nLoci; ++idx) {
+							if (ply == 2 && chromTypes[idx] == CHROMOSOME_Y && ind->sex() == FEMALE)
+								continue;
+							if (ply == 2 && ((chromTypes[idx] == CHROMOSOME_X && p == 1) ||
+							                 (chromTypes[idx] == CHROMOSOME_Y && p == 0)) && ind->sex() == MALE)
+								continue;
+							if (chromTypes[idx] == MITOCHONDRIAL && p > 0)
+								continue;
+							if (ind->affected())
+								caseAlleleCnt[idx][DEREF_ALLELE(geno + loci[idx])]++;
+							else
+								ctrlAlleleCnt[idx][DEREF_ALLELE(geno + loci[idx])]++;
+						}
+					}
+				}
+				// genotype
+				if (hasGenoTest) {
+					GenoIterator geno1 = ind->genoBegin(0);
+					GenoIterator geno2 = ind->genoBegin(1);
+					for (size_t idx = 0; idx < nLoci; ++idx) {
+						if (chromTypes[idx] == CHROMOSOME_X || chromTypes[idx] == CHROMOSOME_Y || chromTypes[idx] == MITOCHONDRIAL)
+							continue;
+						Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
+						Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
+						if (a1 > a2)
+							std::swap(a1, a2);
+						if (ind->affected())
+							caseGenoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+						else
+							ctrlGenoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+					}
 				}
 			}
 		}
@@ -2838,8 +4148,14 @@ bool statAssociation::apply(Population & pop) const
 		if (m_vars.contains(Allele_ChiSq_sp_String) || m_vars.contains(Allele_ChiSq_p_sp_String)) {
 			uintDict chisq;
 			uintDict chisq_p;
-			for (size_t i = 0; i < loci.size(); ++i)
-				alleleChiSqTest(caseAlleleCnt[i], ctrlAlleleCnt[i], chisq[loci[i]], chisq_p[loci[i]]);
+			vectorf stats(nLoci), pvals(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+			for (size_t i = 0; i < nLoci; ++i)
+				alleleChiSqTest(caseAlleleCnt[i], ctrlAlleleCnt[i], stats[i], pvals[i]);
+			for (size_t i = 0; i < nLoci; ++i) {
+				chisq[loci[i]] = stats[i];
+				chisq_p[loci[i]] = pvals[i];
+			}
 			if (m_vars.contains(Allele_ChiSq_sp_String))
 				pop.getVars().setVar(subPopVar_String(*it, Allele_ChiSq_String, m_suffix), chisq);
 			if (m_vars.contains(Allele_ChiSq_p_sp_String))
@@ -2848,8 +4164,14 @@ bool statAssociation::apply(Population & pop) const
 		if (m_vars.contains(Geno_ChiSq_sp_String) || m_vars.contains(Geno_ChiSq_p_sp_String)) {
 			uintDict chisq;
 			uintDict chisq_p;
-			for (size_t i = 0; i < loci.size(); ++i)
-				genoChiSqTest(caseGenoCnt[i], ctrlGenoCnt[i], chisq[loci[i]], chisq_p[loci[i]]);
+			vectorf stats(nLoci), pvals(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+			for (size_t i = 0; i < nLoci; ++i)
+				genoChiSqTest(caseGenoCnt[i], ctrlGenoCnt[i], stats[i], pvals[i]);
+			for (size_t i = 0; i < nLoci; ++i) {
+				chisq[loci[i]] = stats[i];
+				chisq_p[loci[i]] = pvals[i];
+			}
 			if (m_vars.contains(Geno_ChiSq_sp_String))
 				pop.getVars().setVar(subPopVar_String(*it, Geno_ChiSq_String, m_suffix), chisq);
 			if (m_vars.contains(Geno_ChiSq_p_sp_String))
@@ -2857,8 +4179,12 @@ bool statAssociation::apply(Population & pop) const
 		}
 		if (m_vars.contains(Armitage_p_sp_String)) {
 			uintDict pvalues;
-			for (size_t i = 0; i < loci.size(); ++i)
-				pvalues[loci[i]] = armitageTest(caseGenoCnt[i], ctrlGenoCnt[i]);
+			vectorf pvals(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+			for (size_t i = 0; i < nLoci; ++i)
+				pvals[i] = armitageTest(caseGenoCnt[i], ctrlGenoCnt[i]);
+			for (size_t i = 0; i < nLoci; ++i)
+				pvalues[loci[i]] = pvals[i];
 			pop.getVars().setVar(subPopVar_String(*it, Armitage_p_String, m_suffix), pvalues);
 		}
 		// total allele count
@@ -2891,9 +4217,15 @@ bool statAssociation::apply(Population & pop) const
 	if (m_vars.contains(Allele_ChiSq_String) || m_vars.contains(Allele_ChiSq_p_String)) {
 		uintDict chisq;
 		uintDict chisq_p;
-		for (size_t i = 0; i < loci.size(); ++i)
+		vectorf stats(nLoci), pvals(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+		for (size_t i = 0; i < nLoci; ++i)
 			alleleChiSqTest(allCaseAlleleCnt[i], allCtrlAlleleCnt[i],
-				chisq[loci[i]], chisq_p[loci[i]]);
+				stats[i], pvals[i]);
+		for (size_t i = 0; i < nLoci; ++i) {
+			chisq[loci[i]] = stats[i];
+			chisq_p[loci[i]] = pvals[i];
+		}
 		// output variable.
 		if (m_vars.contains(Allele_ChiSq_String))
 			pop.getVars().setVar(Allele_ChiSq_String + m_suffix, chisq);
@@ -2903,9 +4235,15 @@ bool statAssociation::apply(Population & pop) const
 	if (m_vars.contains(Geno_ChiSq_String) || m_vars.contains(Geno_ChiSq_p_String)) {
 		uintDict chisq;
 		uintDict chisq_p;
-		for (size_t i = 0; i < loci.size(); ++i)
+		vectorf stats(nLoci), pvals(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+		for (size_t i = 0; i < nLoci; ++i)
 			genoChiSqTest(allCaseGenoCnt[i], allCtrlGenoCnt[i],
-				chisq[loci[i]], chisq_p[loci[i]]);
+				stats[i], pvals[i]);
+		for (size_t i = 0; i < nLoci; ++i) {
+			chisq[loci[i]] = stats[i];
+			chisq_p[loci[i]] = pvals[i];
+		}
 		if (m_vars.contains(Geno_ChiSq_String))
 			pop.getVars().setVar(Geno_ChiSq_String + m_suffix, chisq);
 		if (m_vars.contains(Geno_ChiSq_p_String))
@@ -2913,8 +4251,12 @@ bool statAssociation::apply(Population & pop) const
 	}
 	if (m_vars.contains(Armitage_p_String)) {
 		uintDict pvalues;
-		for (size_t i = 0; i < loci.size(); ++i)
-			pvalues[loci[i]] = armitageTest(allCaseGenoCnt[i], allCtrlGenoCnt[i]);
+		vectorf pvals(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+		for (size_t i = 0; i < nLoci; ++i)
+			pvals[i] = armitageTest(allCaseGenoCnt[i], allCtrlGenoCnt[i]);
+		for (size_t i = 0; i < nLoci; ++i)
+			pvalues[loci[i]] = pvals[i];
 		pop.getVars().setVar(Armitage_p_String + m_suffix, pvalues);
 	}
 	return true;
@@ -2946,49 +4288,75 @@ string statNeutrality::describe(bool /* format */) const
 
 double statNeutrality::calcPi(HAPLOLIST::const_iterator begin, HAPLOLIST::const_iterator end) const
 {
-	double diffCnt = 0;
-	int numComparison = 0;
+	size_t numSeq = end - begin;
+
+	// return 0 if there is only one sequence
+	if (numSeq < 2)
+		return 0;
 
-	if (numThreads() > 1) {
+	double numComparison = numSeq * (numSeq - 1.) / 2.;
+	size_t numLoci = begin->size();
+	double diffCnt = 0;
+	// Instead of comparing all pairs of sequences, which is
+	// O(numSeq^2 x numLoci), alleles are counted at each locus. With
+	// cnt_a copies of allele a among numSeq sequences, the number of
+	// pairs of sequences that differ at this locus is
+	// C(numSeq, 2) - sum_a C(cnt_a, 2), which yields exactly the same
+	// diffCnt as the pairwise scan. Loci are independent so the counting
+	// pass is parallelized over loci.
 #ifdef _OPENMP
-		size_t size = end - begin;
-#  pragma omp parallel reduction(+ : diffCnt, numComparison)
-		{
-			size_t id = omp_get_thread_num();
-			HAPLOLIST::const_iterator it = begin + id * (size / numThreads());
-			HAPLOLIST::const_iterator itEnd = id == numThreads() - 1 ? end : it + (size / numThreads());
-			for (; it != itEnd; ++it) {
-				HAPLOLIST::const_iterator it1 = it;
-				for (++it1; it1 != end; ++it1) {
-					const vectora & seq1 = *it;
-					const vectora & seq2 = *it1;
-					size_t sz = seq1.size();
-					for (size_t i = 0; i < sz; ++i)
-						diffCnt += seq1[i] != seq2[i];
-					++numComparison;
-				}
-			}
-		}
+#  pragma omp parallel for reduction(+ : diffCnt) if(numThreads() > 1)
+#endif
+	for (ssize_t idx = 0; idx < static_cast<ssize_t>(numLoci); ++idx) {
+#ifdef BINARYALLELE
+		// for the binary module, the count of allele 1 is enough.
+		size_t cnt = 0;
+		for (HAPLOLIST::const_iterator it = begin; it != end; ++it)
+			cnt += (*it)[idx];
+		diffCnt += static_cast<double>(cnt) * (numSeq - cnt);
+#else
+		map<Allele, size_t> alleleCnt;
+		for (HAPLOLIST::const_iterator it = begin; it != end; ++it)
+			++alleleCnt[(*it)[idx]];
+		double sameCnt = 0;
+		map<Allele, size_t>::const_iterator cnt = alleleCnt.begin();
+		map<Allele, size_t>::const_iterator cntEnd = alleleCnt.end();
+		for (; cnt != cntEnd; ++cnt)
+			sameCnt += cnt->second * (cnt->second - 1.) / 2.;
+		diffCnt += numComparison - sameCnt;
 #endif
-	}   else{
-		HAPLOLIST::const_iterator it = begin;
-		for (; it != end; ++it) {
-			HAPLOLIST::const_iterator it1 = it;
-			for (++it1; it1 != end; ++it1) {
-				const vectora & seq1 = *it;
-				const vectora & seq2 = *it1;
-				size_t sz = seq1.size();
-				for (size_t i = 0; i < sz; ++i)
-					diffCnt += seq1[i] != seq2[i];
-				++numComparison;
-			}
-		}
 	}
-	// return 0 if there is only one sequence
-	return numComparison == 0 ? 0 : diffCnt / numComparison;
+	return diffCnt / numComparison;
 }
 
 
+#ifdef MUTANTALLELE
+/* fills requested positions of a haplotype from the mutant entries of one
+   chromosome copy. Reference-allele runs need no work because the
+   haplotype is pre-filled with zero. */
+struct neutralityHaploFiller
+{
+	vectora * hap;
+	const std::map<size_t, size_t> * pos;
+	size_t base;
+
+	void zeroRun(size_t /* start */, size_t /* length */) const
+	{
+	}
+
+
+	void mutant(size_t index, Allele value) const
+	{
+		std::map<size_t, size_t>::const_iterator it = pos->find(index - base);
+
+		if (it != pos->end())
+			(*hap)[it->second] = value;
+	}
+
+
+};
+#endif
+
 bool statNeutrality::apply(Population & pop) const
 {
 	if (m_loci.empty())
@@ -3006,6 +4374,12 @@ bool statNeutrality::apply(Population & pop) const
 #endif
 	// count for all specified subpopulations
 	HAPLOLIST allHaplotypes;
+#ifdef MUTANTALLELE
+	// haplotype position of each requested locus, for the mutant sweep
+	std::map<size_t, size_t> lociPos;
+	for (size_t idx = 0; idx < nLoci; ++idx)
+		lociPos[loci[idx]] = idx;
+#endif
 	// selected (virtual) subpopulatons.
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator it = subPops.begin();
@@ -3029,8 +4403,20 @@ bool statNeutrality::apply(Population & pop) const
 					continue;
 				if (chromType == MITOCHONDRIAL && p > 0)
 					continue;
+#ifdef MUTANTALLELE
+				// one ordered sweep over the stored mutants of this
+				// chromosome copy replaces a container probe per locus
+				std::fill(haplotype.begin(), haplotype.end(), TO_ALLELE(0));
+				GenoIterator git = ind->genoBegin(p);
+				neutralityHaploFiller filler;
+				filler.hap = &haplotype;
+				filler.pos = &lociPos;
+				filler.base = git.index();
+				git().forEachRun(git.index(), ind->genoEnd(p).index(), filler);
+#else
 				for (size_t idx = 0; idx < nLoci; ++idx)
 					haplotype[idx] = TO_ALLELE(ind->allele(loci[idx], p));
+#endif
 				allHaplotypes.push_back(haplotype);
 			}
 		}
@@ -3071,51 +4457,36 @@ string statStructure::describe(bool /* format */) const
 }
 
 
-void statStructure::calcGst_Nei73(const vectoru & loci, const vectoru & n_i, LOCIFREQLIST & alleleFreq,
-                                  const ALLELELIST & alleles, double & Gst, uintDict & gst) const
+void statStructure::calcGst_Nei73(const vectoru & loci, const vectoru & n_i, const LOCISUMSLIST & sums,
+                                  double & Gst, uintDict & gst) const
 {
 	double H_t_all = 0.;
 	double D_st_all = 0.;
 
-	size_t numSP = n_i.size();
+	double r = static_cast<double>(n_i.size());
 	double n = static_cast<double>(accumulate(n_i.begin(), n_i.end(), size_t(0)));
 
 	// for each locus
 	for (size_t st = 0; st < loci.size(); ++st) {
 		size_t loc = loci[st];
-		// D_st = Sum_i,j D_ij / s^2
+		// D_st = Sum_i,j D_ij / s^2 with
+		// D_ij = Sum_k (x_ik - x_jk)^2 / 2 (i,j are subpops, k is allele).
+		// The pairwise sum over subpopulations expands to the running
+		// sums: Sum_i,j (x_ik - x_jk)^2 = 2 (r Q2_k - Q1_k^2), so the
+		// frequencies themselves are no longer needed here.
 		double D_st = 0;
-		// i, j for subpopulation
-		for (size_t i = 0; i < numSP; ++i) {
-			for (size_t j = 0; j < numSP; ++j) {
-				// D_ij = Sum_k (x_ik - x_jk)^2 /2 (i,j are subpops, k is allele)
-				double D_ij = 0;
-				// for each allele
-				ALLELES::const_iterator aIt = alleles[st].begin();
-				ALLELES::const_iterator aEnd = alleles[st].end();
-				for (; aIt != aEnd; ++aIt) {
-					Allele allele = aIt->first;
-					D_ij += pow(alleleFreq[i][loc][allele] - alleleFreq[j][loc][allele], 2);
-				}
-				D_ij /= 2.;
-				D_st += D_ij;
-			}
-		}
-		D_st /= (numSP * numSP);
 		//
 		// J_t = Sum_k (x_dot_k^2)
 		//
 		// NOTE: w_i is chosen as n_i/n instead of 1/numSP as
 		// used in the paper.
 		double J_t = 0;
-		ALLELES::const_iterator aIt = alleles[st].begin();
-		ALLELES::const_iterator aEnd = alleles[st].end();
+		ALLELESUMS::const_iterator aIt = sums[st].begin();
+		ALLELESUMS::const_iterator aEnd = sums[st].end();
 		for (; aIt != aEnd; ++aIt) {
-			Allele allele = aIt->first;
-			double x_dotk = 0;
-			for (size_t i = 0; i < numSP; ++i)
-				x_dotk += n_i[i] * alleleFreq[i][loc][allele];
-			x_dotk /= n;
+			const alleleSums & s = aIt->second;
+			D_st += (r * s.Q2 - s.Q1 * s.Q1) / (r * r);
+			double x_dotk = s.W1 / n;
 			J_t += pow(x_dotk, 2);
 		}
 		gst[loc] = fcmp_eq(J_t, 1.0) ? 0 : D_st / (1.0 - J_t);
@@ -3126,16 +4497,14 @@ void statStructure::calcGst_Nei73(const vectoru & loci, const vectoru & n_i, LOC
 }
 
 
-void statStructure::calcFst_WC84(const vectoru & loci, const vectoru & n_i, LOCIFREQLIST & alleleFreq, LOCIFREQLIST & heteroFreq,
-                                 const ALLELELIST & alleles, double & Fst, double & Fis, double & Fit,
+void statStructure::calcFst_WC84(const vectoru & loci, const vectoru & n_i, const LOCISUMSLIST & sums,
+                                 double & Fst, double & Fis, double & Fit,
                                  uintDict & fst, uintDict & fis, uintDict & fit) const
 {
 	double aa = 0.;
 	double bb = 0.;
 	double cc = 0.;
 
-	// vector to store p[i]
-	vectorf p_i = vectorf(n_i.size());
 	double n = static_cast<double>(accumulate(n_i.begin(), n_i.end(), size_t(0)));
 
 	// calculate Fst for each locus
@@ -3155,39 +4524,28 @@ void statStructure::calcFst_WC84(const vectoru & loci, const vectoru & n_i, LOCI
 
 		double a = 0.0, b = 0.0, c = 0.0;
 
-		ALLELES::const_iterator aIt = alleles[st].begin();
-		ALLELES::const_iterator aEnd = alleles[st].end();
+		ALLELESUMS::const_iterator aIt = sums[st].begin();
+		ALLELESUMS::const_iterator aEnd = sums[st].end();
 		for (; aIt != aEnd; ++aIt) {
-			Allele allele = aIt->first;
-			// p_i
-			for (int sp = 0; sp < r; ++sp)
-				p_i[sp] = alleleFreq[sp][loc][allele];
+			const alleleSums & s = aIt->second;
 
 			// p_bar (there are 2n alleles, but this does not affect the result)
-			double p_bar = 0;
-			for (int sp = 0; sp < r; ++sp)
-				p_bar += n_i[sp] * p_i[sp];
-			p_bar /= n;
+			double p_bar = s.W1 / n;
 
-			// s^2
-			double s_2 = 0;
-			for (int sp = 0; sp < r; ++sp)
-				s_2 += n_i[sp] * (p_i[sp] - p_bar) * (p_i[sp] - p_bar);
-			s_2 /= (r - 1) * n_bar;
+			// s^2; the weighted sum of squared deviations from p_bar
+			// expands to W2 - W1^2 / n over the running sums
+			double s_2 = (s.W2 - s.W1 * s.W1 / n) / ((r - 1) * n_bar);
 
 			// h_bar
-			double h_bar = 0;
-			for (int sp = 0; sp < r; ++sp)
-				h_bar += heteroFreq[sp][loc][allele] * n_i[sp];
-			h_bar /= n;
+			double h_bar = s.H / n;
 
 			// a, b, c
 			a += n_bar / n_c * (s_2 - (p_bar * (1 - p_bar) - (r - 1.) / r * s_2 - h_bar / 4.) / (n_bar - 1.));
 			b += n_bar / (n_bar - 1) * (p_bar * (1 - p_bar) - (r - 1) / r * s_2 - (2 * n_bar - 1) / (4. * n_bar) * h_bar);
 			c += h_bar / 2.;
 
-			DBG_DO(DBG_STATOR, cerr << "allele " << allele << "\tn_c: " << n_c
-				                    << "\tp_i: " << p_i << "\tp_bar: " << p_bar << "\ts^2: " << s_2 << "\th_bar:"
+			DBG_DO(DBG_STATOR, cerr << "allele " << aIt->first << "\tn_c: " << n_c
+				                    << "\tp_bar: " << p_bar << "\ts^2: " << s_2 << "\th_bar:"
 				                    << h_bar << "\ta: " << a << "\tb: " << b << "\tc: " << c << endl);
 		}                                                                                 // each allele
 
@@ -3227,11 +4585,13 @@ bool statStructure::apply(Population & pop) const
 	subPopList subPops = m_subPops.expandFrom(pop);
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
-	// count for all specified subpopulations
+	// count for all specified subpopulations. Only running per-locus sums
+	// are kept across subpopulations: the frequency maps of one
+	// subpopulation are folded into them and discarded before the next
+	// subpopulation is scanned, so memory use does not grow with the
+	// number of subpopulations.
 	vectoru n_i(0);
-	ALLELELIST allAlleles(loci.size());
-	LOCIFREQLIST alleleFreq(subPops.size());
-	LOCIFREQLIST heteroFreq(subPops.size());
+	LOCISUMSLIST lociSums(loci.size());
 	for (size_t spIdx = 0; it != itEnd; ++it, ++spIdx) {
 		if (m_vars.contains(AlleleNum_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, AlleleNum_String, m_suffix));
@@ -3243,9 +4603,8 @@ bool statStructure::apply(Population & pop) const
 		size_t spSize = 0;
 		for (size_t idx = 0; idx < loci.size(); ++idx) {
 			size_t loc = loci[idx];
-			FREQ & af = alleleFreq[spIdx][loc];
-			FREQ & hf = heteroFreq[spIdx][loc];
-			ALLELES & alleles = allAlleles[idx];
+			FREQ af;
+			FREQ hf;
 			size_t cnt = 0;
 
 			if (use_observed_het) {
@@ -3260,8 +4619,6 @@ bool statStructure::apply(Population & pop) const
 					++af[a2];
 					hf[a1] += a1 != a2;
 					hf[a2] += a1 != a2;
-					alleles[a1] = true;
-					alleles[a2] = true;
 				}
 				// allele frequency
 				map<size_t, float>::iterator it = af.begin();
@@ -3283,7 +4640,6 @@ bool statStructure::apply(Population & pop) const
 					++a;
 					++af[c];
 					++hf[c];
-					alleles[c] = true;
 				}
 				// allele frequency
 				map<size_t, float>::iterator it = af.begin();
@@ -3299,6 +4655,24 @@ bool statStructure::apply(Population & pop) const
 				//
 				spSize = cnt;
 			}
+			// fold the frequencies of this subpopulation into the running
+			// per-locus sums and let af and hf go out of scope
+			ALLELESUMS & sums = lociSums[idx];
+			double ni = static_cast<double>(cnt);
+			FREQ::const_iterator fIt = af.begin();
+			FREQ::const_iterator fEnd = af.end();
+			for (; fIt != fEnd; ++fIt) {
+				alleleSums & s = sums[fIt->first];
+				double p = fIt->second;
+				s.W1 += ni * p;
+				s.W2 += ni * p * p;
+				s.Q1 += p;
+				s.Q2 += p * p;
+			}
+			fIt = hf.begin();
+			fEnd = hf.end();
+			for (; fIt != fEnd; ++fIt)
+				sums[fIt->first].H += ni * fIt->second;
 		}
 		// (virtual) subpopulation size
 		n_i.push_back(spSize);
@@ -3308,7 +4682,7 @@ bool statStructure::apply(Population & pop) const
 	// Nei's Gst
 	double Gst = 0;
 	uintDict gst;
-	calcGst_Nei73(loci, n_i, alleleFreq, allAlleles, Gst, gst);
+	calcGst_Nei73(loci, n_i, lociSums, Gst, gst);
 	if (m_vars.contains(Gst_String))
 		pop.getVars().setVar(Gst_String + m_suffix, Gst);
 	if (m_vars.contains(gst_String))
@@ -3321,7 +4695,7 @@ bool statStructure::apply(Population & pop) const
 	uintDict fst;
 	uintDict fis;
 	uintDict fit;
-	calcFst_WC84(loci, n_i, alleleFreq, heteroFreq, allAlleles, Fst, Fis, Fit, fst, fis, fit);
+	calcFst_WC84(loci, n_i, lociSums, Fst, Fis, Fit, fst, fis, fit);
 	// post results
 	if (m_vars.contains(Fst_String))
 		pop.getVars().setVar(Fst_String + m_suffix, Fst);
@@ -3412,16 +4786,47 @@ bool statHWE::apply(Population & pop) const
 
 		pop.activateVirtualSubPop(*it);
 
-		IndIterator ind = pop.indIterator(it->subPop());
-		for (; ind.valid(); ++ind) {
-			GenoIterator geno1 = ind->genoBegin(0);
-			GenoIterator geno2 = ind->genoBegin(1);
-			for (size_t idx = 0; idx < nLoci; ++idx) {
-				Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
-				Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
-				if (a1 > a2)
-					std::swap(a1, a2);
-				genoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+		if (numThreads() > 1) {
+#ifdef _OPENMP
+			// each thread counts its share of individuals into local maps
+			// that are merged under a critical section, the same pattern
+			// used by the allele frequency counters.
+#  pragma omp parallel
+			{
+				GENOCNTLIST localCnt(nLoci);
+				IndIterator ind = pop.indIterator(it->subPop(), omp_get_thread_num());
+				for (; ind.valid(); ++ind) {
+					GenoIterator geno1 = ind->genoBegin(0);
+					GenoIterator geno2 = ind->genoBegin(1);
+					for (size_t idx = 0; idx < nLoci; ++idx) {
+						Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
+						Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
+						if (a1 > a2)
+							std::swap(a1, a2);
+						localCnt[idx][GENOCNT::key_type(a1, a2)]++;
+					}
+				}
+#  pragma omp critical
+				for (size_t idx = 0; idx < nLoci; ++idx) {
+					GENOCNT::const_iterator cnt = localCnt[idx].begin();
+					GENOCNT::const_iterator cntEnd = localCnt[idx].end();
+					for (; cnt != cntEnd; ++cnt)
+						genoCnt[idx][cnt->first] += cnt->second;
+				}
+			}
+#endif
+		} else {
+			IndIterator ind = pop.indIterator(it->subPop());
+			for (; ind.valid(); ++ind) {
+				GenoIterator geno1 = ind->genoBegin(0);
+				GenoIterator geno2 = ind->genoBegin(1);
+				for (size_t idx = 0; idx < nLoci; ++idx) {
+					Allele a1 = DEREF_ALLELE(geno1 + loci[idx]);
+					Allele a2 = DEREF_ALLELE(geno2 + loci[idx]);
+					if (a1 > a2)
+						std::swap(a1, a2);
+					genoCnt[idx][GENOCNT::key_type(a1, a2)]++;
+				}
 			}
 		}
 		pop.deactivateVirtualSubPop(it->subPop());
@@ -3429,9 +4834,12 @@ bool statHWE::apply(Population & pop) const
 		// output variable.
 		if (m_vars.contains(HWE_sp_String)) {
 			uintDict hwe;
-			for (size_t i = 0; i < loci.size(); ++i) {
-				hwe[loci[i]] = hweTest(mapToCount(genoCnt[i]));
-			}
+			vectorf pvalues(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+			for (size_t i = 0; i < nLoci; ++i)
+				pvalues[i] = hweTest(mapToCount(genoCnt[i]));
+			for (size_t i = 0; i < nLoci; ++i)
+				hwe[loci[i]] = pvalues[i];
 			pop.getVars().setVar(subPopVar_String(*it, HWE_String, m_suffix), hwe);
 		}
 		for (size_t idx = 0; idx < nLoci; ++idx) {
@@ -3444,8 +4852,12 @@ bool statHWE::apply(Population & pop) const
 	//
 	if (m_vars.contains(HWE_String)) {
 		uintDict hwe;
-		for (size_t i = 0; i < loci.size(); ++i)
-			hwe[loci[i]] = hweTest(mapToCount(allGenoCnt[i]));
+		vectorf pvalues(nLoci);
+#pragma omp parallel for if(numThreads() > 1) schedule(dynamic, ompChunkSize(nLoci))
+		for (size_t i = 0; i < nLoci; ++i)
+			pvalues[i] = hweTest(mapToCount(allGenoCnt[i]));
+		for (size_t i = 0; i < nLoci; ++i)
+			hwe[loci[i]] = pvalues[i];
 		pop.getVars().setVar(HWE_String + m_suffix, hwe);
 	}
 	return true;
@@ -3507,7 +4919,7 @@ bool statInbreeding::apply(Population & pop) const
 		uintDict IBDCnt;
 		uintDict IBSCnt;
 
-#pragma omp parallel for if(numThreads() > 1)
+#pragma omp parallel for schedule(dynamic, ompChunkSize(loci.size())) if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
 			size_t loc = loci[idx];
 
@@ -3599,8 +5011,9 @@ bool statInbreeding::apply(Population & pop) const
 
 
 statEffectiveSize::statEffectiveSize(const lociList & loci,  const subPopList & subPops,
-	const stringList & vars, const string & suffix)
-	: m_loci(loci), m_subPops(subPops), m_vars(), m_suffix(suffix)
+	const stringList & vars, const string & suffix, long maxLDPairs)
+	: m_loci(loci), m_subPops(subPops), m_vars(), m_suffix(suffix),
+	m_maxLDPairs(maxLDPairs)
 {
 	const char * allowedVars[] = {
 		Ne_demo_base_String,	 Ne_demo_base_sp_String,
@@ -4594,107 +6007,150 @@ bool statEffectiveSize::LDEffectiveSize(Population & pop) const
 	// selected (virtual) subpopulatons.
 	subPopList subPops = m_subPops.expandFrom(pop);
 	//
-	LDLIST all_ld;
-
-	vector<LDLIST> subpop_ld(subPops.size());
-
 	bool all_stat = m_vars.contains(Ne_LD_String) || m_vars.contains(Ne_LD_mono_String);
 	bool subpop_stat = m_vars.contains(Ne_LD_sp_String) || m_vars.contains(Ne_LD_mono_sp_String);
+
+	size_t nLoci = loci.size();
+	// extract genotypes at the specified loci into per-locus columns with one
+	// pass over each (virtual) subpopulation, so that the pair loop below
+	// reads compact arrays instead of scanning all individuals once per pair
 	vectoru subpop_size(subPops.size());
-	for (size_t locIdx1 = 0; locIdx1 + 1 < loci.size(); ++locIdx1) {
-		for (size_t locIdx2 = locIdx1 + 1; locIdx2 < loci.size(); ++locIdx2) {
-			size_t loc1 = loci[locIdx1];
-			size_t loc2 = loci[locIdx2];
-			// accumulate genotypes
-			GENOTYPECNT all_geno_cnt;
-			HOMOCNT all_homo_cnt_i;
-			HOMOCNT all_homo_cnt_j;
-			ALLELECNT all_allele_cnt_i;
-			ALLELECNT all_allele_cnt_j;
-
-			subPopList::const_iterator sp = subPops.begin();
-			subPopList::const_iterator spEnd = subPops.end();
-			for (size_t spIdx = 0; sp != spEnd; ++sp, ++spIdx) {
-				pop.activateVirtualSubPop(*sp);
-
-				HOMOCNT homo_cnt_i;
-				HOMOCNT homo_cnt_j;
-				ALLELECNT allele_cnt_i;
-				ALLELECNT allele_cnt_j;
-				GENOTYPECNT geno_cnt;
-				size_t N = 0;
-				IndIterator ind = pop.indIterator(sp->subPop());
-				for (; ind.valid(); ++ind, ++N) {
-					Allele a1 = TO_ALLELE(ind->allele(loc1, 0));
-					Allele a2 = TO_ALLELE(ind->allele(loc1, 1));
-					Allele b1 = TO_ALLELE(ind->allele(loc2, 0));
-					Allele b2 = TO_ALLELE(ind->allele(loc2, 1));
-					//
-					if (a1 == a2)
-						++homo_cnt_i[a1];
-					if (b1 == b2)
-						++homo_cnt_j[b1];
-					++allele_cnt_i[a1];
-					++allele_cnt_i[a2];
-					++allele_cnt_j[b1];
-					++allele_cnt_j[b2];
-					//
-					GENOTYPE alleles(4);
-					// a1,b1  a2,b2
-					// we need to assign it in two cases
-					//    a1,b1  a2,b2
-					// and
-					//    a2,b2  a1,b1
-					// for maternal and paternal counts
-					alleles[0] = a1;
-					alleles[1] = b1;
-					alleles[2] = a2;
-					alleles[3] = b2;
-					++geno_cnt[alleles];
-					alleles[0] = a2;
-					alleles[1] = b2;
-					alleles[2] = a1;
-					alleles[3] = b1;
-					++geno_cnt[alleles];
-				}
-				pop.deactivateVirtualSubPop(sp->subPop());
-				if (subpop_stat)
-					subpop_ld[spIdx].push_back(Burrows(N, allele_cnt_i, allele_cnt_j,
-							homo_cnt_i, homo_cnt_j, geno_cnt));
-				subpop_size[spIdx] = N;
-				if (all_stat) {
-					// homozygote
-					HOMOCNT::iterator hit = homo_cnt_i.begin();
-					HOMOCNT::iterator hit_end = homo_cnt_i.end();
-					for (; hit != hit_end; ++hit)
-						all_homo_cnt_i[hit->first] += hit->second;
-					//
-					hit = homo_cnt_j.begin();
-					hit_end = homo_cnt_j.end();
-					for (; hit != hit_end; ++hit)
-						all_homo_cnt_j[hit->first] += hit->second;
-					// allele
-					ALLELECNT::iterator ait = allele_cnt_i.begin();
-					ALLELECNT::iterator ait_end = allele_cnt_i.end();
-					for (; ait != ait_end; ++ait)
-						all_allele_cnt_i[ait->first] += ait->second;
-					//
-					ait = allele_cnt_j.begin();
-					ait_end = allele_cnt_j.end();
-					for (; ait != ait_end; ++ait)
-						all_allele_cnt_j[ait->first] += ait->second;
-					// genotype
-					GENOTYPECNT::iterator git = geno_cnt.begin();
-					GENOTYPECNT::iterator git_end = geno_cnt.end();
-					for (; git != git_end; ++git)
-						all_geno_cnt[git->first] += git->second;
-				}
+	vector<vector<vectora> > spCols(subPops.size());
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+	for (size_t spIdx = 0; sp != spEnd; ++sp, ++spIdx) {
+		pop.activateVirtualSubPop(*sp);
+		vector<vectora> & cols = spCols[spIdx];
+		cols.resize(nLoci);
+		size_t N = 0;
+		IndIterator ind = pop.indIterator(sp->subPop());
+		for (; ind.valid(); ++ind, ++N) {
+			for (size_t locIdx = 0; locIdx < nLoci; ++locIdx) {
+				cols[locIdx].push_back(TO_ALLELE(ind->allele(loci[locIdx], 0)));
+				cols[locIdx].push_back(TO_ALLELE(ind->allele(loci[locIdx], 1)));
+			}
+		}
+		pop.deactivateVirtualSubPop(sp->subPop());
+		subpop_size[spIdx] = N;
+	}
+
+	// enumerate pairs of loci. e.g.
+	// when number of loci is 4
+	// 0-1 0-2 0-3
+	//     1-2 1-3
+	//         2-3
+	// and there will be 6=4*3/2 pairs.
+	size_t nPairs = nLoci >= 2 ? nLoci * (nLoci - 1) / 2 : 0;
+	vectoru pairs(nPairs);
+	for (size_t i = 0, p = 0; i + 1 < nLoci; ++i)
+		for (size_t j = i + 1; j < nLoci; ++j, ++p)
+			pairs[p] = i * nLoci + j;
+	if (m_maxLDPairs > 0 && static_cast<size_t>(m_maxLDPairs) < nPairs) {
+		// a partial Fisher-Yates shuffle draws maxLDPairs distinct pairs
+		for (size_t i = 0; i < static_cast<size_t>(m_maxLDPairs); ++i)
+			std::swap(pairs[i], pairs[i + getRNG().randInt(nPairs - i)]);
+		pairs.resize(m_maxLDPairs);
+		std::sort(pairs.begin(), pairs.end());
+	}
+
+	LDLIST all_ld(all_stat ? pairs.size() : 0);
+	vector<LDLIST> subpop_ld(subPops.size());
+	if (subpop_stat)
+		for (size_t spIdx = 0; spIdx < subPops.size(); ++spIdx)
+			subpop_ld[spIdx].resize(pairs.size());
+
+	// pairs are independent of each other and each iteration writes to its
+	// own slot of all_ld and subpop_ld, so results do not depend on the
+	// number of threads
+#pragma omp parallel for schedule(dynamic, ompChunkSize(pairs.size())) if(numThreads() > 1)
+	for (ssize_t pairIdx = 0; pairIdx < static_cast<ssize_t>(pairs.size()); ++pairIdx) {
+		size_t locIdx1 = pairs[pairIdx] / nLoci;
+		size_t locIdx2 = pairs[pairIdx] % nLoci;
+		// accumulate genotypes
+		GENOTYPECNT all_geno_cnt;
+		HOMOCNT all_homo_cnt_i;
+		HOMOCNT all_homo_cnt_j;
+		ALLELECNT all_allele_cnt_i;
+		ALLELECNT all_allele_cnt_j;
+
+		for (size_t spIdx = 0; spIdx < subPops.size(); ++spIdx) {
+			const vectora & col1 = spCols[spIdx][locIdx1];
+			const vectora & col2 = spCols[spIdx][locIdx2];
+			size_t N = subpop_size[spIdx];
+
+			HOMOCNT homo_cnt_i;
+			HOMOCNT homo_cnt_j;
+			ALLELECNT allele_cnt_i;
+			ALLELECNT allele_cnt_j;
+			GENOTYPECNT geno_cnt;
+			GENOTYPE alleles(4);
+			for (size_t k = 0; k < N; ++k) {
+				Allele a1 = col1[2 * k];
+				Allele a2 = col1[2 * k + 1];
+				Allele b1 = col2[2 * k];
+				Allele b2 = col2[2 * k + 1];
+				//
+				if (a1 == a2)
+					++homo_cnt_i[a1];
+				if (b1 == b2)
+					++homo_cnt_j[b1];
+				++allele_cnt_i[a1];
+				++allele_cnt_i[a2];
+				++allele_cnt_j[b1];
+				++allele_cnt_j[b2];
+				//
+				// a1,b1  a2,b2
+				// we need to assign it in two cases
+				//    a1,b1  a2,b2
+				// and
+				//    a2,b2  a1,b1
+				// for maternal and paternal counts
+				alleles[0] = a1;
+				alleles[1] = b1;
+				alleles[2] = a2;
+				alleles[3] = b2;
+				++geno_cnt[alleles];
+				alleles[0] = a2;
+				alleles[1] = b2;
+				alleles[2] = a1;
+				alleles[3] = b1;
+				++geno_cnt[alleles];
+			}
+			if (subpop_stat)
+				subpop_ld[spIdx][pairIdx] = Burrows(N, allele_cnt_i, allele_cnt_j,
+					homo_cnt_i, homo_cnt_j, geno_cnt);
+			if (all_stat) {
+				// homozygote
+				HOMOCNT::iterator hit = homo_cnt_i.begin();
+				HOMOCNT::iterator hit_end = homo_cnt_i.end();
+				for (; hit != hit_end; ++hit)
+					all_homo_cnt_i[hit->first] += hit->second;
+				//
+				hit = homo_cnt_j.begin();
+				hit_end = homo_cnt_j.end();
+				for (; hit != hit_end; ++hit)
+					all_homo_cnt_j[hit->first] += hit->second;
+				// allele
+				ALLELECNT::iterator ait = allele_cnt_i.begin();
+				ALLELECNT::iterator ait_end = allele_cnt_i.end();
+				for (; ait != ait_end; ++ait)
+					all_allele_cnt_i[ait->first] += ait->second;
+				//
+				ait = allele_cnt_j.begin();
+				ait_end = allele_cnt_j.end();
+				for (; ait != ait_end; ++ait)
+					all_allele_cnt_j[ait->first] += ait->second;
+				// genotype
+				GENOTYPECNT::iterator git = geno_cnt.begin();
+				GENOTYPECNT::iterator git_end = geno_cnt.end();
+				for (; git != git_end; ++git)
+					all_geno_cnt[git->first] += git->second;
 			}
-			if (all_stat)
-				all_ld.push_back(Burrows(accumulate(subpop_size.begin(), subpop_size.end(), 0),
-						all_allele_cnt_i, all_allele_cnt_j,
-						all_homo_cnt_i, all_homo_cnt_j, all_geno_cnt));
 		}
+		if (all_stat)
+			all_ld[pairIdx] = Burrows(accumulate(subpop_size.begin(), subpop_size.end(), 0),
+				all_allele_cnt_i, all_allele_cnt_j,
+				all_homo_cnt_i, all_homo_cnt_j, all_geno_cnt);
 	}
 	// step 2, after we get all the pairwise ld values, ...
 	vectorstr cutoff_keys;
@@ -199,7 +199,8 @@ public:
 		const stringFunc & output = ">", int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr())
 		: BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
-		m_expr(expr, stmts), m_exposeInd(exposeInd), m_lastValues()
+		m_expr(expr, stmts), m_exposeInd(exposeInd), m_lastValues(),
+		m_infoNames(), m_lastDict(NULL)
 	{
 		(void)usePopVars;  // this parameter is obsolete, use (void) to avoid a warning message
 		DBG_WARNIF(debug(DBG_COMPATIBILITY) && usePopVars, "WARNING: parameter usePopVars is obsolete.");
@@ -241,6 +242,13 @@ protected:
 	/// if the next individual holds the same value at an information field
 	/// existing variable will not be set again.
 	mutable vectorf m_lastValues;
+	/// information field names, cached between clearVars() calls so that
+	/// evaluating an expression for each individual does not copy the
+	/// name list again and again.
+	mutable vectorstr m_infoNames;
+	/// the dictionary the expression was last bound to, so that the
+	/// local dictionary is only re-assigned when it actually changes.
+	mutable PyObject * m_lastDict;
 };
 
 /** Operator \c InfoExec is similar to \c InfoEval in that it works at the
@@ -403,6 +411,8 @@ private:
 #define  fixedSites_String           "fixedSites"
 #define  segSites_sp_String          "segSites_sp"
 #define  fixedSites_sp_String        "fixedSites_sp"
+#define  siteFreqSpectrum_String     "siteFreqSpectrum"
+#define  siteFreqSpectrum_sp_String  "siteFreqSpectrum_sp"
 
 public:
 	statNumOfSegSites(const lociList & loci, const subPopList & subPops,
@@ -446,6 +456,60 @@ private:
 };
 
 
+/// CPPONLY
+class statLineage
+{
+private:
+#define  lineageNum_String           "lineageNum"
+#define  lineageFreq_String          "lineageFreq"
+#define  numOfLineageSegs_String     "numOfLineageSegs"
+#define  lineageNum_sp_String        "lineageNum_sp"
+#define  lineageFreq_sp_String       "lineageFreq_sp"
+#define  numOfLineageSegs_sp_String  "numOfLineageSegs_sp"
+
+public:
+	statLineage(bool lineage, const subPopList & subPops,
+		const stringList & vars, const string & suffix);
+
+	string describe(bool format = true) const;
+
+	bool apply(Population & pop) const;
+
+private:
+	/// whether or not to tally lineage values
+	bool m_isActive;
+	subPopList m_subPops;
+	stringList m_vars;
+	string m_suffix;
+};
+
+
+/// CPPONLY
+class statAncestry
+{
+private:
+#define  ancestryFreq_String         "ancestryFreq"
+#define  ancestryDosage_String       "ancestryDosage"
+#define  ancestryFreq_sp_String      "ancestryFreq_sp"
+#define  ancestryDosage_sp_String    "ancestryDosage_sp"
+
+public:
+	statAncestry(const lociList & loci, const subPopList & subPops,
+		const stringList & vars, const string & suffix);
+
+	string describe(bool format = true) const;
+
+	bool apply(Population & pop) const;
+
+private:
+	/// loci at which ancestry composition is measured
+	lociList m_loci;
+	subPopList m_subPops;
+	stringList m_vars;
+	string m_suffix;
+};
+
+
 /// CPPONLY
 class statAlleleFreq
 {
@@ -473,6 +537,20 @@ public:
 
 	bool apply(Population & pop) const;
 
+	/// CPPONLY loci at which allele frequencies are requested
+	const lociList & loci() const
+	{
+		return m_loci;
+	}
+
+
+	/// CPPONLY (virtual) subpopulations over which counts are collected
+	const subPopList & subPops() const
+	{
+		return m_subPops;
+	}
+
+
 private:
 	/// which alleles?
 	lociList m_loci;
@@ -504,6 +582,20 @@ public:
 
 	bool apply(Population & pop) const;
 
+	/// CPPONLY loci at which heterozygosity is requested
+	const lociList & loci() const
+	{
+		return m_loci;
+	}
+
+
+	/// CPPONLY (virtual) subpopulations over which counts are collected
+	const subPopList & subPops() const
+	{
+		return m_subPops;
+	}
+
+
 private:
 	/// heteroFreq
 	lociList m_loci;
@@ -531,6 +623,20 @@ public:
 
 	bool apply(Population & pop) const;
 
+	/// CPPONLY loci at which genotype frequencies are requested
+	const lociList & loci() const
+	{
+		return m_loci;
+	}
+
+
+	/// CPPONLY (virtual) subpopulations over which counts are collected
+	const subPopList & subPops() const
+	{
+		return m_subPops;
+	}
+
+
 private:
 	/// which genotypes
 	lociList m_loci;
@@ -622,16 +728,19 @@ private:
 #define  VarOfInfo_String         "varOfInfo"
 #define  MaxOfInfo_String         "maxOfInfo"
 #define  MinOfInfo_String         "minOfInfo"
+#define  MedianOfInfo_String      "medianOfInfo"
 #define  SumOfInfo_sp_String      "sumOfInfo_sp"
 #define  MeanOfInfo_sp_String     "meanOfInfo_sp"
 #define  VarOfInfo_sp_String      "varOfInfo_sp"
 #define  MaxOfInfo_sp_String      "maxOfInfo_sp"
 #define  MinOfInfo_sp_String      "minOfInfo_sp"
+#define  MedianOfInfo_sp_String   "medianOfInfo_sp"
 
 public:
 	statInfo(const vectorstr & sumOfInfo, const vectorstr & meanOfInfo,
 		const vectorstr & varOfInfo, const vectorstr & maxOfInfo,
-		const vectorstr & minOfInfo, const subPopList & subPops,
+		const vectorstr & minOfInfo, const vectorstr & medianOfInfo,
+		const subPopList & subPops,
 		const stringList & vars, const string & suffix);
 
 
@@ -650,6 +759,7 @@ private:
 	vectorstr m_varOfInfo;
 	vectorstr m_maxOfInfo;
 	vectorstr m_minOfInfo;
+	vectorstr m_medianOfInfo;
 
 	subPopList m_subPops;
 	stringList m_vars;
@@ -675,6 +785,26 @@ private:
 #define   ChiSq_p_sp_String    "LD_ChiSq_p_sp"
 #define   CramerV_sp_String    "CramerV_sp"
 
+// flat typed-array variants of the variables above
+#define   LD_arr_String        "LD_arr"
+#define   LD_prime_arr_String  "LD_prime_arr"
+#define   R2_arr_String        "R2_arr"
+#define   ChiSq_arr_String     "LD_ChiSq_arr"
+#define   ChiSq_p_arr_String   "LD_ChiSq_p_arr"
+#define   CramerV_arr_String   "CramerV_arr"
+
+#define   LD_arr_sp_String       "LD_arr_sp"
+#define   LD_prime_arr_sp_String "LD_prime_arr_sp"
+#define   R2_arr_sp_String       "R2_arr_sp"
+#define   ChiSq_arr_sp_String    "LD_ChiSq_arr_sp"
+#define   ChiSq_p_arr_sp_String  "LD_ChiSq_p_arr_sp"
+#define   CramerV_arr_sp_String  "CramerV_arr_sp"
+
+// packed band buffers filled when parameter LDBand is used
+#define   LD_band_String        "LD_band"
+#define   LD_prime_band_String  "LD_prime_band"
+#define   R2_band_String        "R2_band"
+
 public:
 	// In the previous versions (< 0.9.6), statLD relies statAlleleFreq
 	// and statHaploFreq to obtain allele and haplotype frequencies. This
@@ -685,7 +815,7 @@ public:
 	// calculated only once. However, this appear to be a rare case that does
 	// not worth special optimization. The newer version calculates allele and
 	// haplotype frequencies locally and in a more readable way.
-	statLD(const intMatrix & LD, const subPopList & subPops,
+	statLD(const intMatrix & LD, long band, const subPopList & subPops,
 		const stringList & vars, const string & suffix);
 
 	string describe(bool format = true) const;
@@ -705,12 +835,23 @@ private:
 		vectorf & LD, vectorf & D_prime, vectorf & R2, vectorf & ChiSq, vectorf & ChiSq_p,
 		vectorf & CramerV) const;
 
+	// allele-frequency weighted LD measures of a single locus pair, used
+	// by the banded path
+	static bool pairLDMeasures(const ALLELECNT & alleleCnt1, const ALLELECNT & alleleCnt2,
+		const HAPLOCNT & haploCnt, double & D, double & D_prime, double & R2);
+
+	// fill the packed band buffers for all within-band locus pairs
+	bool applyBand(Population & pop) const;
+
 	void outputVar(Population & pop, const string & name, const vectorf & value) const;
 
 private:
 	/// LD
 	matrixi m_LD;
 
+	/// width of the band of locus pairs covered by parameter LDBand
+	long m_band;
+
 	subPopList m_subPops;
 	stringList m_vars;
 	string m_suffix;
@@ -823,16 +964,34 @@ public:
 
 private:
 	typedef map<size_t, float> FREQ;
-	typedef map<size_t, FREQ> LOCIFREQ;
-	typedef vector<LOCIFREQ> LOCIFREQLIST;
-	typedef map<Allele, bool> ALLELES;
-	typedef vector<ALLELES> ALLELELIST;
-
-	void calcGst_Nei73(const vectoru & loci, const vectoru & n_i, LOCIFREQLIST & alleleFreq,
-		const ALLELELIST & alleles, double & Gst, uintDict & gst) const;
 
-	void calcFst_WC84(const vectoru & loci, const vectoru & n_i, LOCIFREQLIST & alleleFreq, LOCIFREQLIST & heteroFreq,
-		const ALLELELIST & alleles, double & Fst, double & Fis, double & Fit,
+	// running sums for one allele at one locus, accumulated while the
+	// subpopulations are scanned one by one: W1 = sum of n_i p_i, W2 =
+	// sum of n_i p_i^2, Q1 = sum of p_i, Q2 = sum of p_i^2 and H = sum
+	// of n_i h_i, where p_i and h_i are the allele and heterozygote
+	// frequencies in subpopulation i. Both estimators below are computed
+	// from these sums alone, so frequency maps of all subpopulations
+	// never have to be held in memory at the same time.
+	struct alleleSums
+	{
+		alleleSums() : W1(0), W2(0), Q1(0), Q2(0), H(0)
+		{
+		}
+
+		double W1;
+		double W2;
+		double Q1;
+		double Q2;
+		double H;
+	};
+	typedef map<size_t, alleleSums> ALLELESUMS;
+	typedef vector<ALLELESUMS> LOCISUMSLIST;
+
+	void calcGst_Nei73(const vectoru & loci, const vectoru & n_i, const LOCISUMSLIST & sums,
+		double & Gst, uintDict & gst) const;
+
+	void calcFst_WC84(const vectoru & loci, const vectoru & n_i, const LOCISUMSLIST & sums,
+		double & Fst, double & Fis, double & Fit,
 		uintDict & fst, uintDict & fis, uintDict & fit) const;
 
 private:
@@ -967,7 +1126,7 @@ private:
 
 public:
 	statEffectiveSize(const lociList & loci, const subPopList & subPops,
-		const stringList & vars, const string & suffix);
+		const stringList & vars, const string & suffix, long maxLDPairs = 0);
 
 
 	string describe(bool format = true) const;
@@ -985,6 +1144,7 @@ private:
 	subPopList m_subPops;
 	stringList m_vars;
 	string m_suffix;
+	long m_maxLDPairs;
 };
 
 
@@ -1113,6 +1273,12 @@ public:
 	 *      or specified (virtual) subpopulations.
 	 *  \li \c fixedSites_sp: A list of sites with one non-zero allele in
 	 *      in each (virtual) subpopulations.
+	 *  \li \c siteFreqSpectrum: A dictionary with number of non-zero alleles
+	 *      at a site as keys and number of sites with that many non-zero
+	 *      alleles as values, for all or specified (virtual) subpopulations.
+	 *      Sites without any non-zero allele are not counted.
+	 *  \li \c siteFreqSpectrum_sp: The site frequency spectrum in each
+	 *      (virtual) subpopulation.
 	 *
 	 *  <b>numOfMutants</b>: Parameter \e numOfMutants accepts a list of loci
 	 *  (loci indexes, names, or \c ALL_AVAIL) and count the number of mutants
@@ -1123,6 +1289,52 @@ public:
 	 *  \li \c numOfMutants_sp: Number of mutants in each (virtual)
 	 *      subpopulations.
 	 *
+	 *  <b>lineage</b>: If \e lineage=True, tally the lineage values of all
+	 *  alleles of individuals in all or specified (virtual) subpopulations
+	 *  in one pass over the lineage vectors. The lineage of each allele
+	 *  records, depending on how it is tracked, the ID of the founder or of
+	 *  the most recent mutation event it descends from, so these statistics
+	 *  measure founder genome contributions. Contiguous runs of the same
+	 *  lineage value along each chromosome copy are counted as segments.
+	 *  This parameter is only meaningful in lineage modules and sets empty
+	 *  statistics otherwise. It sets variables
+	 *  \li \c lineageNum (default): Number of alleles with each lineage
+	 *      value, as a dictionary indexed by lineage values, in all or
+	 *      specified (virtual) subpopulations.
+	 *  \li \c lineageFreq (default): Proportion of alleles with each
+	 *      lineage value in all or specified (virtual) subpopulations.
+	 *  \li \c numOfLineageSegs: Number of contiguous segments of identical
+	 *      lineage values along all chromosome copies, in all or specified
+	 *      (virtual) subpopulations.
+	 *  \li \c lineageNum_sp: Number of alleles with each lineage value in
+	 *      each (virtual) subpopulation.
+	 *  \li \c lineageFreq_sp: Proportion of alleles with each lineage
+	 *      value in each (virtual) subpopulation.
+	 *  \li \c numOfLineageSegs_sp: Number of contiguous segments of
+	 *      identical lineage values in each (virtual) subpopulation.
+	 *
+	 *  <b>ancestry</b>: This parameter accepts a list of loci (loci indexes,
+	 *  names, or \c ALL_AVAIL) at which the ancestral composition of the
+	 *  population will be measured from allelic lineage. If founders are
+	 *  tagged with their population of origin (e.g. using \c InitLineage
+	 *  with one value per source population), the lineage of each allele
+	 *  identifies the ancestry it descends from and is preserved by the
+	 *  genotype transmitters, so these statistics report, locus by locus,
+	 *  how the ancestries are represented. This parameter is only meaningful
+	 *  in lineage modules and sets empty statistics otherwise. It sets
+	 *  variables
+	 *  \li \c ancestryFreq (default): <tt>ancestryFreq[loc][tag]</tt> is the
+	 *      proportion of allele copies at locus \c loc that carry lineage
+	 *      value \c tag, in all or specified (virtual) subpopulations.
+	 *  \li \c ancestryDosage (default): <tt>ancestryDosage[loc][(tag, d)]</tt>
+	 *      is the proportion of individuals that carry exactly \c d copies
+	 *      (<tt>0 <= d <= ploidy</tt>) of lineage value \c tag at locus
+	 *      \c loc, in all or specified (virtual) subpopulations.
+	 *  \li \c ancestryFreq_sp: Ancestry proportions in each (virtual)
+	 *      subpopulation.
+	 *  \li \c ancestryDosage_sp: Ancestry dosage spectra in each (virtual)
+	 *      subpopulation.
+	 *
 	 *  <b>alleleFreq</b>: This parameter accepts a list of loci (loci indexes,
 	 *  names, or \c ALL_AVAIL), at which allele frequencies will be calculated.
 	 *  This statistic outputs the following variables, all of which are
@@ -1235,10 +1447,11 @@ public:
 	 *  \li \c haploHomoNum_sp: A dictionary of number of homozygotes in each
 	 *       (virtual) subpopulation.
 	 *
-	 *  <b>sumOfinfo</b>, <b>meanOfInfo</b>, <b>varOfInfo</b>, <b>maxOfInfo</b>
-	 *  and <b>minOfInfo</b>: Each of these five parameters accepts a list of
+	 *  <b>sumOfinfo</b>, <b>meanOfInfo</b>, <b>varOfInfo</b>, <b>maxOfInfo</b>,
+	 *  <b>minOfInfo</b> and <b>medianOfInfo</b>: Each of these six parameters
+	 *  accepts a list of
 	 *  information fields. For each information field, the sum, mean, variance,
-	 *  maximum or minimal (depending on the specified parameter(s)) of this
+	 *  maximum, minimal or median (depending on the specified parameter(s)) of this
 	 *  information field at iddividuals in all or specified (virtual)
 	 *  subpopulations will be calculated. The results will be put into the
 	 *  following population variables:
@@ -1254,6 +1467,10 @@ public:
 	 *       maximum value of information fields of all individuals.
 	 *  \li \c minOfInfo (default for \e minOfInfo): A dictionary of the
 	 *       minimal value of information fields of all individuals.
+	 *  \li \c medianOfInfo (default for \e medianOfInfo): A dictionary of the
+	 *       median (the middle value, or the larger of the two middle values
+	 *       for an even number of individuals) of information fields of all
+	 *       individuals.
 	 *  \li \c sumOfInfo_sp: A dictionary of the sum of information fields of
 	 *       individuals in each subpopulation.
 	 *  \li \c meanOfInfo_sp: A dictionary of the mean of information fields of
@@ -1264,6 +1481,8 @@ public:
 	 *       fields of individuals in each subpopulation.
 	 *  \li \c minOfInfo_sp: A dictionary of the minimal value of information
 	 *       fields of individuals in each subpopulation.
+	 *  \li \c medianOfInfo_sp: A dictionary of the median of information
+	 *       fields of individuals in each subpopulation.
 	 *
 	 *  <b>LD</b>: Parameter \c LD accepts one or a list of loci pairs (e.g.
 	 *  <tt>LD=[[0,1], [2,3]]</tt>) with optional primary alleles at both loci
@@ -1300,6 +1519,29 @@ public:
 	 *  \li \c LD_ChiSq_p_sp p value for the ChiSq statistics for each
 	 *       (virtual) subpopulation.
 	 *  \li \c CramerV_sp Cramer V statistics for each (virtual) subpopulation.
+	 *  \li \c LD_arr, \c LD_prime_arr, \c R2_arr, \c LD_ChiSq_arr,
+	 *       \c LD_ChiSq_p_arr, \c CramerV_arr The same measures published as
+	 *       a single flat typed array (an \c array.array of doubles that
+	 *       supports the buffer protocol) in the order of the specified locus
+	 *       pairs, instead of nested dictionaries indexed by loci. Creating
+	 *       one array is much cheaper than populating dictionaries when many
+	 *       locus pairs are requested every generation. Variants with
+	 *       suffix \c _sp (e.g. \c LD_arr_sp) publish one such array for
+	 *       each (virtual) subpopulation.
+	 *
+	 *  A positive parameter \e LDBand computes the basic LD, D' and R2
+	 *  measures for all pairs of loci that are at most \e LDBand loci apart
+	 *  on the same chromosome, without the pairs being listed in parameter
+	 *  \e LD. The results are published as packed band buffers \c LD_band,
+	 *  \c LD_prime_band and \c R2_band (typed arrays of doubles), where the
+	 *  measure between loci \c i and <tt>i + d</tt> is stored at offset
+	 *  <tt>i * LDBand + d - 1</tt> and entries of pairs that cross a
+	 *  chromosome boundary are \c NaN. This layout holds genome-wide LD
+	 *  maps in a single buffer of <tt>totNumLoci * LDBand</tt> doubles.
+	 *  Band results are calculated from individuals in the (virtual)
+	 *  subpopulations of parameter \e subPops combined; which of the three
+	 *  measures are filled follows the \c LD, \c LD_prime and \c R2
+	 *  selections of parameter \e vars (all three by default).
 	 *
 	 *  <b>association</b>: Parameter \c association accepts a list of loci,
 	 *  which can be a list of indexes, names, or \c ALL_AVAIL. At each locus,
@@ -1509,6 +1751,10 @@ public:
 	 *       to a random sample of the population. 95% CI is calculated using a
 	 *       Jackknife estimated effective number of independent alleles. Please
 	 *       refer to relevant papers and the LDNe user's guide for details.
+	 *       Because LD is measured between all pairs of specified loci, the
+	 *       cost of this method grows quadratically with the number of loci.
+	 *       A positive parameter \e maxLDPairs limits the calculation to a
+	 *       random sample of \e maxLDPairs pairs of loci.
 	 *  \li \c Ne_LD_sp Estimate LD-based effective population size for each
 	 *       specified (virtual) subpopulation.
 	 *  \li \c Ne_LD_mono A version of Ne_LD that assumes monogamy (see Waples 2006
@@ -1525,6 +1771,10 @@ public:
 		//
 		const lociList & numOfMutants = vectoru(),
 		//
+		bool lineage = false,
+		//
+		const lociList & ancestry = vectoru(),
+		//
 		const lociList & alleleFreq = vectoru(),
 		//
 		const lociList & heteroFreq = vectoru(),
@@ -1541,6 +1791,7 @@ public:
 		const stringList & varOfInfo = vectorstr(),
 		const stringList & maxOfInfo = vectorstr(),
 		const stringList & minOfInfo = vectorstr(),
+		const stringList & medianOfInfo = vectorstr(),
 		//
 		const intMatrix & LD = intMatrix(),
 		//
@@ -1556,6 +1807,10 @@ public:
 		//
 		const lociList & effectiveSize = vectoru(),
 		//
+		long maxLDPairs = 0,
+		//
+		long LDBand = 0,
+		//
 		const stringList & vars = stringList(),
 		const string & suffix = string(),
 		// regular parameters
@@ -1586,12 +1841,23 @@ public:
 	/// HIDDEN apply the \c Stat operator
 	virtual bool apply(Population & pop) const;
 
+private:
+	/** CPPONLY Fill the allele, heterozygote and genotype count caches of
+	 *  \e pop with a single genotype scan for loci that are requested by
+	 *  more than one of the corresponding components, so that these
+	 *  components read from the caches instead of each rescanning the
+	 *  population.
+	 */
+	void fillSharedCnt(Population & pop) const;
+
 private:
 	const statPopSize m_popSize;
 	const statNumOfMales m_numOfMales;
 	const statNumOfAffected m_numOfAffected;
 	const statNumOfSegSites m_numOfSegSites;
 	const statNumOfMutants m_numOfMutants;
+	const statLineage m_lineage;
+	const statAncestry m_ancestry;
 	const statAlleleFreq m_alleleFreq;
 	const statHeteroFreq m_heteroFreq;
 	const statGenoFreq m_genoFreq;
@@ -35,11 +35,57 @@ namespace simuPOP {
 // treats 0 as missing.
 ATOMICLONG g_indID = 1;
 
+#ifdef _OPENMP
+// number of IDs a thread leases from the shared counter at a time during
+// parallel offspring generation. A larger block reduces contention on
+// g_indID but leaves a larger unused gap in the ID sequence when a mating
+// phase ends.
+#  define INDID_BLOCK 1024
+
+// a leased range [next, end) of individual IDs, padded to a cache line so
+// that the hot per-thread counters do not share one
+struct IdBlock
+{
+	ATOMICLONG next;
+	ATOMICLONG end;
+	char padding[64 - 2 * sizeof(ATOMICLONG)];
+};
+
+static vector<IdBlock> & indIDBlocks()
+{
+	static vector<IdBlock> blocks(omp_get_max_threads());
+
+	return blocks;
+}
+
+
+#endif
 
 void IdTagger::reset(ULONG startID)
 {
 	DBG_FAILIF(startID == 0, ValueError, "individual ID must start from 1.");
 	g_indID = startID;
+#ifdef _OPENMP
+	// previously leased ID blocks may contain IDs beyond startID
+	vector<IdBlock> & blocks = indIDBlocks();
+	for (size_t i = 0; i < blocks.size(); ++i)
+		blocks[i].next = blocks[i].end = 0;
+#endif
+}
+
+
+void IdTagger::initializeIfNeeded(const Individual & /* ind */) const
+{
+#ifdef _OPENMP
+	// blocks leased during a previous mating phase would hand out IDs that
+	// are smaller than IDs assigned since, violating the rule that an
+	// offspring's ID is larger than the IDs of its parents. This function
+	// runs before the parallel region of each mating phase, so the blocks
+	// can be discarded without synchronization.
+	vector<IdBlock> & blocks = indIDBlocks();
+	for (size_t i = 0; i < blocks.size(); ++i)
+		blocks[i].next = blocks[i].end = 0;
+#endif
 }
 
 
@@ -81,8 +127,18 @@ bool IdTagger::applyDuringMating(Population & pop, Population & offPop, RawIndIt
 	DBG_FAILIF(mom != NULL && mom->info(idx) >= g_indID, RuntimeError,
 		"Matental ID is larger than or equal to offspring ID (wrong startID?).");
 #ifdef _OPENMP
-	ATOMICLONG id = fetchAndIncrement(&g_indID);
-	offspring->setInfo(static_cast<long>(id), idx);
+	if (numThreads() > 1) {
+		// take the next ID from the block this thread has leased, and
+		// lease a new block from the shared counter when it runs out, so
+		// that the hot loop only touches thread-local counters.
+		IdBlock & blk = indIDBlocks()[omp_get_thread_num()];
+		if (blk.next == blk.end) {
+			blk.next = fetchAndAdd(&g_indID, INDID_BLOCK);
+			blk.end = blk.next + INDID_BLOCK;
+		}
+		offspring->setInfo(static_cast<long>(blk.next++), idx);
+	} else
+		offspring->setInfo(static_cast<long>(g_indID++), idx);
 #else
 	offspring->setInfo(static_cast<long>(g_indID++), idx);
 #endif
@@ -90,7 +146,18 @@ bool IdTagger::applyDuringMating(Population & pop, Population & offPop, RawIndIt
 }
 
 
-bool InheritTagger::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
+void InheritTagger::initializeIfNeeded(const Individual & ind) const
+{
+	if (m_lastGenoStru == ind.genoStruIdx())
+		return;
+	m_fieldIdx.clear();
+	for (size_t i = 0; i < infoSize(); ++i)
+		m_fieldIdx.push_back(ind.infoIdx(infoField(i)));
+	m_lastGenoStru = ind.genoStruIdx();
+}
+
+
+bool InheritTagger::applyDuringMating(Population & /* pop */, Population & offPop, RawIndIterator offspring,
                                       Individual * dad, Individual * mom) const
 {
 	// if offspring does not belong to subPops, do nothing, but does not fail.
@@ -101,8 +168,12 @@ bool InheritTagger::applyDuringMating(Population & pop, Population & offPop, Raw
 	if (sz == 0)
 		return true;
 
+	// the field indexes are usually resolved before the offspring loop starts
+	// so this is almost always a single integer comparison.
+	initializeIfNeeded(*offspring);
+
 	for (size_t i = 0; i < sz; ++i) {
-		size_t idx = pop.infoIdx(infoField(i));
+		size_t idx = m_fieldIdx[i];
 
 		if (m_mode == PATERNAL) {
 			DBG_FAILIF(dad == NULL, RuntimeError,
@@ -163,6 +234,17 @@ string InheritTagger::describe(bool /* format */) const
 }
 
 
+void SummaryTagger::initializeIfNeeded(const Individual & ind) const
+{
+	if (m_lastGenoStru == ind.genoStruIdx())
+		return;
+	m_fieldIdx.clear();
+	for (size_t i = 0; i < infoSize(); ++i)
+		m_fieldIdx.push_back(ind.infoIdx(infoField(i)));
+	m_lastGenoStru = ind.genoStruIdx();
+}
+
+
 bool SummaryTagger::applyDuringMating(Population & /* pop */, Population & offPop, RawIndIterator offspring,
                                       Individual * dad, Individual * mom) const
 {
@@ -172,6 +254,8 @@ bool SummaryTagger::applyDuringMating(Population & /* pop */, Population & offPo
 	DBG_FAILIF(mom == NULL && dad == NULL, RuntimeError,
 		"Invalid father and mother for SummaryTagger.");
 
+	initializeIfNeeded(*offspring);
+
 	size_t sz = infoSize();
 
 	if (m_mode == MEAN) {
@@ -179,63 +263,63 @@ bool SummaryTagger::applyDuringMating(Population & /* pop */, Population & offPo
 		size_t cnt = 0;
 		for (size_t i = 0; i < sz - 1; ++i) {
 			if (dad != 0) {
-				all += dad->info(infoField(i));
+				all += dad->info(m_fieldIdx[i]);
 				cnt += 1;
 			}
 			if (mom != 0) {
-				all += mom->info(infoField(i));
+				all += mom->info(m_fieldIdx[i]);
 				cnt += 1;
 			}
 		}
-		offspring->setInfo(all / cnt, infoField(sz - 1));
+		offspring->setInfo(all / cnt, m_fieldIdx[sz - 1]);
 	}  else if (m_mode == MAXIMUM) {
 		double dadMax = 0;
 		double momMax = 0;
 		if (dad != NULL) {
-			double dadMax = dad->info(infoField(0));
+			double dadMax = dad->info(m_fieldIdx[0]);
 			for (size_t i = 1; i < sz - 1; ++i)
-				dadMax = std::max(dadMax, dad->info(infoField(i)));
+				dadMax = std::max(dadMax, dad->info(m_fieldIdx[i]));
 		}
 		if (mom != NULL) {
-			double momMax = mom->info(infoField(0));
+			double momMax = mom->info(m_fieldIdx[0]);
 			for (size_t i = 1; i < sz - 1; ++i)
-				momMax = std::max(momMax, mom->info(infoField(i)));
+				momMax = std::max(momMax, mom->info(m_fieldIdx[i]));
 		}
 		double allMax = dad == NULL ? momMax : (mom == NULL ? dadMax : std::max(dadMax, momMax));
-		offspring->setInfo(allMax, infoField(sz - 1));
+		offspring->setInfo(allMax, m_fieldIdx[sz - 1]);
 	}  else if (m_mode == MINIMUM) {
 		double dadMin = 0;
 		double momMin = 0;
 		if (dad != NULL) {
-			double dadMin = dad->info(infoField(0));
+			double dadMin = dad->info(m_fieldIdx[0]);
 			for (size_t i = 1; i < sz - 1; ++i)
-				dadMin = std::min(dadMin, dad->info(infoField(i)));
+				dadMin = std::min(dadMin, dad->info(m_fieldIdx[i]));
 		}
 		if (mom != NULL) {
-			double momMin = mom->info(infoField(0));
+			double momMin = mom->info(m_fieldIdx[0]);
 			for (size_t i = 1; i < sz - 1; ++i)
-				momMin = std::min(momMin, mom->info(infoField(i)));
+				momMin = std::min(momMin, mom->info(m_fieldIdx[i]));
 		}
 		double allMin = dad == NULL ? momMin : (mom == NULL ? dadMin : std::min(dadMin, momMin));
-		offspring->setInfo(allMin, infoField(sz - 1));
+		offspring->setInfo(allMin, m_fieldIdx[sz - 1]);
 	}  else if (m_mode == SUMMATION) {
 		double all = 0;
 		for (size_t i = 0; i < sz - 1; ++i) {
 			if (dad != 0)
-				all += dad->info(infoField(i));
+				all += dad->info(m_fieldIdx[i]);
 			if (mom != 0)
-				all += mom->info(infoField(i));
+				all += mom->info(m_fieldIdx[i]);
 		}
-		offspring->setInfo(all, infoField(sz - 1));
+		offspring->setInfo(all, m_fieldIdx[sz - 1]);
 	}  else if (m_mode == MULTIPLICATION) {
 		double all = 1.;
 		for (size_t i = 0; i < sz - 1; ++i) {
 			if (dad != 0)
-				all *= dad->info(infoField(i));
+				all *= dad->info(m_fieldIdx[i]);
 			if (mom != 0)
-				all *= mom->info(infoField(i));
+				all *= mom->info(m_fieldIdx[i]);
 		}
-		offspring->setInfo(all, infoField(sz - 1));
+		offspring->setInfo(all, m_fieldIdx[sz - 1]);
 	} else {
 		DBG_FAILIF(true, ValueError, "Invalid inheritance mode");
 	}
@@ -257,6 +341,17 @@ string ParentsTagger::describe(bool /* format */) const
 }
 
 
+void ParentsTagger::initializeIfNeeded(const Individual & ind) const
+{
+	if (m_lastGenoStru == ind.genoStruIdx())
+		return;
+	m_fieldIdx.clear();
+	for (size_t i = 0; i < infoSize(); ++i)
+		m_fieldIdx.push_back(ind.infoIdx(infoField(i)));
+	m_lastGenoStru = ind.genoStruIdx();
+}
+
+
 bool ParentsTagger::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                       Individual * dad, Individual * mom) const
 {
@@ -266,16 +361,21 @@ bool ParentsTagger::applyDuringMating(Population & pop, Population & offPop, Raw
 	DBG_FAILIF(mom == NULL && dad == NULL, ValueError,
 		"Both parents are invalid");
 
+	initializeIfNeeded(*offspring);
+
+	// resolve the first parental individual only once per offspring
+	const Individual * base = &*pop.indIterator();
+
 	// record to one or two information fields
 	size_t is = infoSize();
 	if (is == 1) {
 		if (dad != NULL)
-			offspring->setInfo(static_cast<double>(dad - &*pop.indIterator()), infoField(0));
+			offspring->setInfo(static_cast<double>(dad - base), m_fieldIdx[0]);
 		else if (mom != NULL)
-			offspring->setInfo(static_cast<double>(mom - &*pop.indIterator()), infoField(0));
+			offspring->setInfo(static_cast<double>(mom - base), m_fieldIdx[0]);
 	} else if (is == 2) {
-		offspring->setInfo(static_cast<double>(dad == NULL ? -1 : dad - &*pop.indIterator()), infoField(0));
-		offspring->setInfo(static_cast<double>(mom == NULL ? -1 : mom - &*pop.indIterator()), infoField(1));
+		offspring->setInfo(static_cast<double>(dad == NULL ? -1 : dad - base), m_fieldIdx[0]);
+		offspring->setInfo(static_cast<double>(mom == NULL ? -1 : mom - base), m_fieldIdx[1]);
 	}
 	return true;
 }
@@ -311,9 +411,13 @@ string PedigreeTagger::describe(bool /* format */) const
 }
 
 
-void PedigreeTagger::outputIndividual(ostream & out, const Individual * ind,
+void PedigreeTagger::formatIndividual(string & rec, const Individual * ind,
                                       const vectorf & IDs) const
 {
+	if (m_format == "binary") {
+		formatIndividualBinary(rec, ind, IDs);
+		return;
+	}
 	// out << .... is very slow compared to the sprintf implementation.
 	//
 	// three numbers (maximum 20 charameters) + M F, the buffer should be long enough
@@ -327,30 +431,99 @@ void PedigreeTagger::outputIndividual(ostream & out, const Individual * ind,
 		sprintf(buffer, SIZE_T_FORMAT " " SIZE_T_FORMAT " %c %c", (unsigned long)toID(ind->info(m_idField)), toID(IDs[0]), sexChar, affChar);
 	else
 		sprintf(buffer, SIZE_T_FORMAT " " SIZE_T_FORMAT " " SIZE_T_FORMAT " %c %c", toID(ind->info(m_idField)), toID(IDs[0]), toID(IDs[1]), sexChar, affChar);
-	out << buffer;
-	// it is difficult to create buffers for the following, but we do not really care
-	// because writing information fields and genotype is rare.
+	rec += buffer;
+	// information fields and genotype are formatted one value at a time
+	// but we do not really care because writing them is rare.
 	if (m_outputFields.allAvail())
-		for (size_t i = 0; i < ind->infoSize(); ++i)
-			out << ' ' << ind->info(i);
+		for (size_t i = 0; i < ind->infoSize(); ++i) {
+			sprintf(buffer, " %g", ind->info(i));
+			rec += buffer;
+		}
 	else if (!m_outputFields.elems().empty()) {
 		const vectorstr & fields = m_outputFields.elems();
-		for (size_t i = 0; i < fields.size(); ++i)
-			out << ' ' << ind->info(fields[i]);
+		for (size_t i = 0; i < fields.size(); ++i) {
+			sprintf(buffer, " %g", ind->info(fields[i]));
+			rec += buffer;
+		}
 	}
 	if (m_outputLoci.allAvail()) {
 		size_t pldy = ind->ploidy();
 		for (size_t i = 0; i < ind->totNumLoci(); ++i)
-			for (size_t p = 0; p < pldy; ++p)
-				out << ' ' << ind->allele(i, p);
+			for (size_t p = 0; p < pldy; ++p) {
+				sprintf(buffer, " %lu", static_cast<unsigned long>(ind->allele(i, p)));
+				rec += buffer;
+			}
 	} else if (!m_outputLoci.elems().empty()) {
 		size_t pldy = ind->ploidy();
 		const vectoru & loci = m_outputLoci.elems();
 		for (size_t i = 0; i < loci.size(); ++i)
+			for (size_t p = 0; p < pldy; ++p) {
+				sprintf(buffer, " %lu", static_cast<unsigned long>(ind->allele(loci[i], p)));
+				rec += buffer;
+			}
+	}
+	rec += '\n';
+}
+
+
+void PedigreeTagger::formatIndividualBinary(string & rec, const Individual * ind,
+                                            const vectorf & IDs) const
+{
+	/* every record starts with the marker bytes 'PB' and carries its own
+	   field and genotype counts, so binary files stay appendable through
+	   the '>>file' output specification without a file header that would
+	   have to be rewritten on every session. */
+	uint64_t ids[3] = { toID(ind->info(m_idField)), 0, 0 };
+
+	if (IDs.size() > 0)
+		ids[1] = toID(IDs[0]);
+	if (IDs.size() > 1)
+		ids[2] = toID(IDs[1]);
+	// values are collected first so that their counts can precede them
+	vectorf fields;
+	if (m_outputFields.allAvail())
+		for (size_t i = 0; i < ind->infoSize(); ++i)
+			fields.push_back(ind->info(i));
+	else if (!m_outputFields.elems().empty()) {
+		const vectorstr & names = m_outputFields.elems();
+		for (size_t i = 0; i < names.size(); ++i)
+			fields.push_back(ind->info(names[i]));
+	}
+	std::vector<uint32_t> geno;
+	size_t pldy = ind->ploidy();
+	if (m_outputLoci.allAvail()) {
+		for (size_t i = 0; i < ind->totNumLoci(); ++i)
 			for (size_t p = 0; p < pldy; ++p)
-				out << ' ' << ind->allele(loci[i], p);
+				geno.push_back(static_cast<uint32_t>(ind->allele(i, p)));
+	} else if (!m_outputLoci.elems().empty()) {
+		const vectoru & loci = m_outputLoci.elems();
+		for (size_t i = 0; i < loci.size(); ++i)
+			for (size_t p = 0; p < pldy; ++p)
+				geno.push_back(static_cast<uint32_t>(ind->allele(loci[i], p)));
 	}
-	out << '\n';
+	uint16_t numFields = static_cast<uint16_t>(fields.size());
+	uint32_t numGeno = static_cast<uint32_t>(geno.size());
+	rec += 'P';
+	rec += 'B';
+	rec.append(reinterpret_cast<const char *>(ids), sizeof(ids));
+	rec += ind->sex() == MALE ? 'M' : 'F';
+	rec += ind->affected() ? 'A' : 'U';
+	rec.append(reinterpret_cast<const char *>(&numFields), sizeof(numFields));
+	rec.append(reinterpret_cast<const char *>(&numGeno), sizeof(numGeno));
+	if (!fields.empty())
+		rec.append(reinterpret_cast<const char *>(&fields[0]), fields.size() * sizeof(double));
+	if (!geno.empty())
+		rec.append(reinterpret_cast<const char *>(&geno[0]), geno.size() * sizeof(uint32_t));
+}
+
+
+void PedigreeTagger::outputIndividual(ostream & out, const Individual * ind,
+                                      const vectorf & IDs) const
+{
+	string rec;
+
+	formatIndividual(rec, ind, IDs);
+	out << rec;
 }
 
 
@@ -363,6 +536,12 @@ bool PedigreeTagger::apply(Population & pop) const
 	std::map<size_t, int> idMap;
 
 	ostream & out = getOstream(pop.dict());
+	// records buffered by applyDuringMating have to go out first to keep
+	// the pedigree file in order.
+	if (!m_recordBuffer.empty()) {
+		out << m_recordBuffer;
+		m_recordBuffer.clear();
+	}
 	size_t is = infoSize();
 	vectorf IDs(is);
 	vectoru idx(is);
@@ -420,8 +599,14 @@ bool PedigreeTagger::applyDuringMating(Population & pop, Population & offPop, Ra
 	if (noOutput())
 		return true;
 
-	ostream & out = getOstream(pop.dict());
-	outputIndividual(out, &*offspring, IDs);
+	// Formatted records are accumulated and written in large chunks so
+	// that the evolve loop does not synchronize with the output device
+	// for every single offspring.
+	formatIndividual(m_recordBuffer, &*offspring, IDs);
+	if (m_recordBuffer.size() >= 0x10000) {
+		getOstream(pop.dict()) << m_recordBuffer;
+		m_recordBuffer.clear();
+	}
 	return true;
 }
 
@@ -429,6 +614,7 @@ bool PedigreeTagger::applyDuringMating(Population & pop, Population & offPop, Ra
 bool PyTagger::applyDuringMating(Population & /* pop */, Population & offPop, RawIndIterator offspring,
                                  Individual * dad, Individual * mom) const
 {
+	GILGuard gil;
 	// if offspring does not belong to subPops, do nothing, but does not fail.
 	if (!applicableToAllOffspring() && !applicableToOffspring(offPop, offspring))
 		return true;
@@ -94,6 +94,12 @@ public:
 	bool applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
 		Individual * dad = NULL, Individual * mom = NULL) const;
 
+	/** CPPONLY Discard ID blocks leased by previous mating phases so that
+	 *  all offspring of this phase get IDs larger than any parental ID.
+	 *  This function is called before the parallel region starts.
+	 */
+	void initializeIfNeeded(const Individual & ind) const;
+
 	/// HIDDEN Deep copy of an \c IdTagger
 	virtual BaseOperator * clone() const
 	{
@@ -142,7 +148,8 @@ public:
 		const intList & at = vectori(), const intList & reps = intList(),
 		const subPopList & subPops = subPopList(), const stringFunc & output = "",
 		const stringList & infoFields = vectorstr()) :
-		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields), m_mode(mode)
+		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
+		m_mode(mode), m_lastGenoStru(MaxTraitIndex)
 	{
 	};
 
@@ -154,6 +161,12 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+	/** CPPONLY Resolve the names of the information fields to indexes once
+	 *  per genotypic structure so that tagging each offspring does not
+	 *  repeat the name lookups.
+	 */
+	void initializeIfNeeded(const Individual & ind) const;
+
 	/** CPPONLY
 	 *  apply the \c InheritTagger
 	 */
@@ -176,6 +189,12 @@ public:
 
 private:
 	const int m_mode;
+
+	/// genotypic structure for which m_fieldIdx was resolved
+	mutable TraitIndexType m_lastGenoStru;
+
+	/// indexes of the information fields, set by initializeIfNeeded
+	mutable vectoru m_fieldIdx;
 };
 
 /** A summary tagger summarize values of one or more parental information field
@@ -203,7 +222,8 @@ public:
 		const intList & at = vectori(), const intList & reps = intList(),
 		const subPopList & subPops = subPopList(), const stringFunc & output = "",
 		const stringList & infoFields = vectorstr()) :
-		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields), m_mode(mode)
+		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
+		m_mode(mode), m_lastGenoStru(MaxTraitIndex)
 	{
 		DBG_FAILIF(infoFields.elems().size() < 2, ValueError,
 			"Please specify at least one parental field and one offspring field.");
@@ -222,6 +242,12 @@ public:
 	}
 
 
+	/** CPPONLY Look up the indexes of the parental and offspring fields for
+	 *  the current genotypic structure, so that they are not looked up by
+	 *  name for every offspring.
+	 */
+	void initializeIfNeeded(const Individual & ind) const;
+
 	/** CPPONLY
 	 *  apply the \c SummaryTagger
 	 */
@@ -237,6 +263,12 @@ public:
 
 private:
 	const int m_mode;
+
+	/// genotypic structure for which m_fieldIdx was resolved
+	mutable TraitIndexType m_lastGenoStru;
+
+	/// indexes of the information fields, set by initializeIfNeeded
+	mutable vectoru m_fieldIdx;
 };
 
 
@@ -266,7 +298,8 @@ public:
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringFunc & output = "",
 		const stringList & infoFields = stringList("father_idx", "mother_idx")) :
-		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields)
+		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
+		m_lastGenoStru(MaxTraitIndex)
 	{
 	}
 
@@ -287,6 +320,11 @@ public:
 	string describe(bool format = true) const;
 
 
+	/** CPPONLY Translate the field names to indexes whenever the genotypic
+	 *  structure changes, instead of once per offspring.
+	 */
+	void initializeIfNeeded(const Individual & ind) const;
+
 	/** CPPONLY
 	 * apply the \c ParentsTagger
 	 */
@@ -300,6 +338,12 @@ public:
 	}
 
 
+private:
+	/// genotypic structure for which m_fieldIdx was resolved
+	mutable TraitIndexType m_lastGenoStru;
+
+	/// indexes of the information fields, set by initializeIfNeeded
+	mutable vectoru m_fieldIdx;
 };
 
 
@@ -392,6 +436,13 @@ public:
 	 *  will be ignored if only one parent is involved. This file format
 	 *  can be loaded using function \c loadPedigree.
 	 *
+	 *  If parameter \e format is set to \c 'binary' (default to \c 'text'),
+	 *  the same records are written as fixed-width binary values, which
+	 *  produces smaller files that can be loaded by \c loadPedigree many
+	 *  times faster because no number parsing is involved. The two formats
+	 *  are recognized automatically by \c loadPedigree. Binary pedigree
+	 *  files are not portable across platforms with different byte orders.
+	 *
 	 *  Because only offspring will be outputed, individuals in the top-most
 	 *  ancestral generation will not be outputed. This is usually not a
 	 *  problem because individuals who have offspring in the next generation
@@ -410,15 +461,29 @@ public:
 		const stringList & outputFields = vectorstr(), const uintList & outputLoci = vectoru(),
 		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
-		const stringList & infoFields = stringList("father_id", "mother_id")) :
+		const stringList & infoFields = stringList("father_id", "mother_id"),
+		const string & format = "text") :
 		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
-		m_idField(idField), m_outputFields(outputFields), m_outputLoci(outputLoci)
+		m_idField(idField), m_outputFields(outputFields), m_outputLoci(outputLoci),
+		m_format(format)
 	{
+		if (format != "text" && format != "binary")
+			throw ValueError("Parameter format should be either 'text' or 'binary'.");
 	}
 
 
 	virtual ~PedigreeTagger()
 	{
+		// write out records that are still buffered when the last copy of
+		// this operator goes out of scope.
+		if (!m_recordBuffer.empty()) {
+			try {
+				getOstream() << m_recordBuffer;
+			} catch (...) {
+				// an expression output cannot be evaluated without a
+				// population so pending records have to be dropped.
+			}
+		}
 	}
 
 
@@ -450,6 +515,12 @@ public:
 
 
 private:
+	void formatIndividual(string & rec, const Individual * ind,
+		const vectorf & IDs) const;
+
+	void formatIndividualBinary(string & rec, const Individual * ind,
+		const vectorf & IDs) const;
+
 	void outputIndividual(ostream & out, const Individual * ind,
 		const vectorf & IDs) const;
 
@@ -457,6 +528,11 @@ private:
 	const string m_idField;
 	stringList m_outputFields;
 	uintList m_outputLoci;
+	const string m_format;
+	/// formatted but not yet written pedigree records. Records are flushed
+	/// in large chunks so that tagging each offspring does not have to
+	/// synchronize with the output device.
+	mutable string m_recordBuffer;
 };
 
 
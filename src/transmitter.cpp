@@ -51,6 +51,7 @@ void GenoTransmitter::initialize(const Individual & ind) const
 		else
 			m_lociToCopy.push_back(ind.numLoci(ch));
 	m_ploidy = ind.ploidy();
+	m_totNumLoci = ind.totNumLoci();
 	m_chromIdx = ind.chromIndex();
 }
 
@@ -59,21 +60,23 @@ void GenoTransmitter::clearChromosome(const Individual & ind, int ploidy, size_t
 {
 	initializeIfNeeded(ind);
 
+	// compute iterators from the cached layout instead of looking up the
+	// shared genotypic structure for every call
+	GenoIterator geno = ind.genoBegin() + ploidy * m_totNumLoci;
+
 #ifdef BINARYALLELE
-	clearGenotype(ind.genoBegin(ploidy) + m_chromIdx[chrom], m_lociToCopy[chrom]);
+	clearGenotype(geno + m_chromIdx[chrom], m_lociToCopy[chrom]);
 #else
 	DBG_FAILIF(m_chromIdx.empty(), ValueError, "GenoTransmitter is not initialized properly");
 #  ifdef MUTANTALLELE
-	clearGenotype(ind.genoBegin(ploidy) + m_chromIdx[chrom],
-		ind.genoBegin(ploidy) + m_chromIdx[chrom + 1]);
+	clearGenotype(geno + m_chromIdx[chrom], geno + m_chromIdx[chrom + 1]);
 #  else
-	fill(ind.genoBegin(ploidy) + m_chromIdx[chrom],
-		ind.genoBegin(ploidy) + m_chromIdx[chrom + 1], 0);
+	fill(geno + m_chromIdx[chrom], geno + m_chromIdx[chrom + 1], 0);
 #  endif
 #endif
 #ifdef LINEAGE
-	fill(ind.lineageBegin(ploidy) + m_chromIdx[chrom],
-		ind.lineageBegin(ploidy) + m_chromIdx[chrom + 1], 0);
+	LineageIterator lineage = ind.lineageBegin() + ploidy * m_totNumLoci;
+	fill(lineage + m_chromIdx[chrom], lineage + m_chromIdx[chrom + 1], 0);
 #endif
 }
 
@@ -83,22 +86,19 @@ void GenoTransmitter::copyChromosome(const Individual & parent, int parPloidy,
 {
 	initializeIfNeeded(offspring);
 
+	GenoIterator parGeno = parent.genoBegin() + parPloidy * m_totNumLoci;
+	GenoIterator offGeno = offspring.genoBegin() + ploidy * m_totNumLoci;
+
 #ifdef BINARYALLELE
-	copyGenotype(parent.genoBegin(parPloidy) + m_chromIdx[chrom],
-		offspring.genoBegin(ploidy) + m_chromIdx[chrom],
+	copyGenotype(parGeno + m_chromIdx[chrom],
+		offGeno + m_chromIdx[chrom],
 		m_lociToCopy[chrom]);
 #else
 	DBG_FAILIF(m_chromIdx.empty(), ValueError,
 		"GenoTransmitter is not properly initialized.");
-#  ifdef MUTANTALLELE
-	copyGenotype(parent.genoBegin(parPloidy) + m_chromIdx[chrom],
-		parent.genoBegin(parPloidy) + m_chromIdx[chrom + 1],
-		offspring.genoBegin(ploidy) + m_chromIdx[chrom]);
-#  else
-	copy(parent.genoBegin(parPloidy) + m_chromIdx[chrom],
-		parent.genoBegin(parPloidy) + m_chromIdx[chrom + 1],
-		offspring.genoBegin(ploidy) + m_chromIdx[chrom]);
-#  endif
+	copyGenotype(parGeno + m_chromIdx[chrom],
+		parGeno + m_chromIdx[chrom + 1],
+		offGeno + m_chromIdx[chrom]);
 #endif
 
 #ifdef LINEAGE
@@ -114,44 +114,44 @@ void GenoTransmitter::copyChromosomes(const Individual & parent,
 {
 	initializeIfNeeded(offspring);
 
+	// iterators are computed from the cached layout; every genoBegin(p, ch)
+	// call would look up the shared genotypic structure again
+	GenoIterator parGeno = parent.genoBegin() + parPloidy * m_totNumLoci;
+	GenoIterator offGeno = offspring.genoBegin() + ploidy * m_totNumLoci;
+#ifdef LINEAGE
+	LineageIterator parLin = parent.lineageBegin() + parPloidy * m_totNumLoci;
+	LineageIterator offLin = offspring.lineageBegin() + ploidy * m_totNumLoci;
+#endif
+
 	// troublesome ...
 	if (m_hasCustomizedChroms) {
-		for (size_t ch = 0; ch < parent.numChrom(); ++ch) {
+		for (size_t ch = 0; ch < m_lociToCopy.size(); ++ch) {
 			if (m_lociToCopy[ch] == 0)
 				continue;
-			GenoIterator par = parent.genoBegin(parPloidy, ch);
-			GenoIterator off = offspring.genoBegin(ploidy, ch);
+			GenoIterator par = parGeno + m_chromIdx[ch];
+			GenoIterator off = offGeno + m_chromIdx[ch];
 
 #ifdef LINEAGE
-			LineageIterator parLineage = parent.lineageBegin(parPloidy, ch);
-			LineageIterator offLineage = offspring.lineageBegin(ploidy, ch);
-			LineageIterator lineage_end = parent.lineageEnd(parPloidy, ch);
+			LineageIterator parLineage = parLin + m_chromIdx[ch];
+			LineageIterator offLineage = offLin + m_chromIdx[ch];
+			LineageIterator lineage_end = parLin + m_chromIdx[ch + 1];
 #endif
 
 #ifdef BINARYALLELE
 			copyGenotype(par, off, m_lociToCopy[ch]);
 #else
-			GenoIterator par_end = parent.genoEnd(parPloidy, ch);
-#  ifdef MUTANTALLELE
+			GenoIterator par_end = parGeno + m_chromIdx[ch + 1];
 			copyGenotype(par, par_end, off);
-#  else
-			copy(par, par_end, off);
-#  endif
 #endif
-			LINEAGE_EXPR(copy(parLineage, lineage_end, offLineage));
+			LINEAGE_EXPR(copyLineage(parLineage, lineage_end, offLineage));
 		}
 	} else {             // easy
 #ifdef BINARYALLELE
-		copyGenotype(parent.genoBegin(parPloidy), offspring.genoBegin(ploidy),
-			offspring.totNumLoci());
+		copyGenotype(parGeno, offGeno, m_totNumLoci);
 #else
-#  ifdef MUTANTALLELE
-		copyGenotype(parent.genoBegin(parPloidy), parent.genoEnd(parPloidy), offspring.genoBegin(ploidy));
-#  else
-		copy(parent.genoBegin(parPloidy), parent.genoEnd(parPloidy), offspring.genoBegin(ploidy));
-#  endif
+		copyGenotype(parGeno, parGeno + m_totNumLoci, offGeno);
 #endif
-		LINEAGE_EXPR(copy(parent.lineageBegin(parPloidy), parent.lineageEnd(parPloidy), offspring.lineageBegin(ploidy)));
+		LINEAGE_EXPR(copyLineage(parLin, parLin + m_totNumLoci, offLin));
 	}
 }
 
@@ -180,69 +180,71 @@ bool CloneGenoTransmitter::applyDuringMating(Population & pop, Population & offP
 	if (!m_chroms.allAvail()) {
 		const vectoru chroms = m_chroms.elems();
 		for (size_t p = 0; p != m_ploidy; ++p) {
+			// compute iterators of this homologous set from the cached
+			// layout instead of the shared genotypic structure
+			GenoIterator parGeno = parent->genoBegin() + p * m_totNumLoci;
+			GenoIterator offGeno = offspring->genoBegin() + p * m_totNumLoci;
+#ifdef LINEAGE
+			LineageIterator parLin = parent->lineageBegin() + p * m_totNumLoci;
+			LineageIterator offLin = offspring->lineageBegin() + p * m_totNumLoci;
+#endif
 			for (size_t i = 0; i < chroms.size(); ++i) {
 				size_t ch = chroms[i];
-				GenoIterator par = parent->genoBegin(p, ch);
-				GenoIterator off = offspring->genoBegin(p, ch);
+				GenoIterator par = parGeno + m_chromIdx[ch];
+				GenoIterator off = offGeno + m_chromIdx[ch];
 
 #ifdef LINEAGE
-				LineageIterator parLineage = parent->lineageBegin(p, ch);
-				LineageIterator offLineage = offspring->lineageBegin(p, ch);
-				LineageIterator lineage_end = parent->lineageEnd(p, ch);
+				LineageIterator parLineage = parLin + m_chromIdx[ch];
+				LineageIterator offLineage = offLin + m_chromIdx[ch];
+				LineageIterator lineage_end = parLin + m_chromIdx[ch + 1];
 #endif
 
 #ifdef BINARYALLELE
-				copyGenotype(par, off, offspring->numLoci(ch));
+				copyGenotype(par, off, m_chromIdx[ch + 1] - m_chromIdx[ch]);
 #else
-				GenoIterator par_end = parent->genoEnd(p, ch);
-#  ifdef MUTANTALLELE
+				GenoIterator par_end = parGeno + m_chromIdx[ch + 1];
 				copyGenotype(par, par_end, off);
-#  else
-				copy(par, par_end, off);
-#  endif
 #endif
-				LINEAGE_EXPR(copy(parLineage, lineage_end, offLineage));
+				LINEAGE_EXPR(copyLineage(parLineage, lineage_end, offLineage));
 			}
 		}
 	} else if (m_hasCustomizedChroms) {
 		for (size_t p = 0; p != m_ploidy; ++p) {
-			for (size_t ch = 0; ch < pop.numChrom(); ++ch) {
+			GenoIterator parGeno = parent->genoBegin() + p * m_totNumLoci;
+			GenoIterator offGeno = offspring->genoBegin() + p * m_totNumLoci;
+#ifdef LINEAGE
+			LineageIterator parLin = parent->lineageBegin() + p * m_totNumLoci;
+			LineageIterator offLin = offspring->lineageBegin() + p * m_totNumLoci;
+#endif
+			for (size_t ch = 0; ch < m_lociToCopy.size(); ++ch) {
 				if (m_lociToCopy[ch] == 0)
 					continue;
-				GenoIterator par = parent->genoBegin(p, ch);
-				GenoIterator off = offspring->genoBegin(p, ch);
+				GenoIterator par = parGeno + m_chromIdx[ch];
+				GenoIterator off = offGeno + m_chromIdx[ch];
 
 #ifdef LINEAGE
-				LineageIterator parLineage = parent->lineageBegin(p, ch);
-				LineageIterator offLineage = offspring->lineageBegin(p, ch);
-				LineageIterator lineage_end = parent->lineageEnd(p, ch);
+				LineageIterator parLineage = parLin + m_chromIdx[ch];
+				LineageIterator offLineage = offLin + m_chromIdx[ch];
+				LineageIterator lineage_end = parLin + m_chromIdx[ch + 1];
 #endif
 
 #ifdef BINARYALLELE
 				copyGenotype(par, off, m_lociToCopy[ch]);
 #else
-				GenoIterator par_end = parent->genoEnd(p, ch);
-#  ifdef MUTANTALLELE
+				GenoIterator par_end = parGeno + m_chromIdx[ch + 1];
 				copyGenotype(par, par_end, off);
-#  else
-				copy(par, par_end, off);
-#  endif
 #endif
-				LINEAGE_EXPR(copy(parLineage, lineage_end, offLineage));
+				LINEAGE_EXPR(copyLineage(parLineage, lineage_end, offLineage));
 			}
 		}
 	} else {             // easy
 #ifdef BINARYALLELE
 		copyGenotype(parent->genoBegin(), offspring->genoBegin(),
-			offspring->genoSize());
+			m_ploidy * m_totNumLoci);
 #else
-#  ifdef MUTANTALLELE
 		copyGenotype(parent->genoBegin(), parent->genoEnd(), offspring->genoBegin());
-#  else
-		copy(parent->genoBegin(), parent->genoEnd(), offspring->genoBegin());
-#  endif
 #endif
-		LINEAGE_EXPR(copy(parent->lineageBegin(), parent->lineageEnd(), offspring->lineageBegin()));
+		LINEAGE_EXPR(copyLineage(parent->lineageBegin(), parent->lineageEnd(), offspring->lineageBegin()));
 	}
 	// for clone transmitter, sex is also transmitted
 	offspring->setSex(parent->sex());
@@ -267,6 +269,8 @@ void MendelianGenoTransmitter::initialize(const Individual & ind) const
 	m_chromY = ind.chromY();
 	m_mitochondrial = ind.mitochondrial();
 	m_numChrom = ind.numChrom();
+	m_simpleLayout = m_chromX < 0 && m_chromY < 0 && m_mitochondrial < 0 &&
+	                 !m_hasCustomizedChroms;
 }
 
 
@@ -278,9 +282,9 @@ void MendelianGenoTransmitter::transmitGenotype(const Individual & parent,
 	// current parental ploidy (copy from which chromosome copy)
 	int parPloidy = 0;
 
-#ifdef BINARYALLELE
+#ifndef MUTANTALLELE
 	// for the simple case, use faster algorithm
-	if (m_chromX < 0 && m_chromY < 0 && !m_hasCustomizedChroms) {
+	if (m_simpleLayout) {
 		// pointer to parental, and offspring chromosome copies
 		GenoIterator par[2];
 		GenoIterator off;
@@ -299,6 +303,47 @@ void MendelianGenoTransmitter::transmitGenotype(const Individual & parent,
 		offLineage = offspring.lineageBegin(ploidy);
 #  endif
 
+#  if defined(_OPENMP) && !defined(BINARYALLELE)
+		// one offspring of a very long genome is itself a sizable copying
+		// job. Chromosomes are inherited independently, so when the family
+		// loop is not already running in parallel, draw the parental copy
+		// of every chromosome up front and spread the resulting block
+		// copies over the available threads. The binary module is left
+		// out because adjacent blocks can share a machine word at an
+		// unaligned chromosome boundary.
+		if (numThreads() > 1 && !omp_in_parallel() && m_numChrom > 1 &&
+		    m_chromIdx[m_numChrom] >= 100000) {
+			// adjacent chromosomes inherited from the same parental copy
+			// merge into a single block, as in the sequential path below
+			vectoru blockBegin, blockEnd;
+			vectori blockPloidy;
+			int cur = getRNG().randBit();
+			size_t begin = 0;
+			for (size_t ch = 0; ch + 1 < m_numChrom; ++ch) {
+				int next = getRNG().randBit();
+				if (next != cur) {
+					blockBegin.push_back(begin);
+					blockEnd.push_back(m_chromIdx[ch + 1]);
+					blockPloidy.push_back(cur);
+					begin = m_chromIdx[ch + 1];
+					cur = next;
+				}
+			}
+			blockBegin.push_back(begin);
+			blockEnd.push_back(m_chromIdx[m_numChrom]);
+			blockPloidy.push_back(cur);
+#    pragma omp parallel for schedule(dynamic, ompChunkSize(blockBegin.size()))
+			for (ssize_t i = 0; i < static_cast<ssize_t>(blockBegin.size()); ++i) {
+				int pp = static_cast<int>(blockPloidy[i]);
+				copyGenotype(par[pp] + blockBegin[i], par[pp] + blockEnd[i],
+					off + blockBegin[i]);
+				LINEAGE_EXPR(copyLineage(parLineage[pp] + blockBegin[i],
+						parLineage[pp] + blockEnd[i],
+						offLineage + blockBegin[i]));
+			}
+			return;
+		}
+#  endif
 		//
 		//
 		// 1. try to copy in blocks,
@@ -330,8 +375,13 @@ void MendelianGenoTransmitter::transmitGenotype(const Individual & parent,
 					off[parBegin] = par[parPloidy][parBegin];
 					LINEAGE_EXPR(offLineage[parBegin] = parLineage[parPloidy][parBegin]);
 				} else {
+#  ifdef BINARYALLELE
 					copyGenotype(par[parPloidy] + parBegin, off + parBegin, length);
-					LINEAGE_EXPR(copy(parLineage[parPloidy] + parBegin,
+#  else
+					copyGenotype(par[parPloidy] + parBegin, par[parPloidy] + parEnd,
+						off + parBegin);
+#  endif
+					LINEAGE_EXPR(copyLineage(parLineage[parPloidy] + parBegin,
 							parLineage[parPloidy] + parBegin + length,
 							offLineage + parBegin));
 				}
@@ -516,7 +566,7 @@ bool MitochondrialGenoTransmitter::applyDuringMating(Population & pop, Populatio
 		copy(par, par_end, off);
 #  endif
 #endif
-		LINEAGE_EXPR(copy(parLineage, lineage_end, offLineage));
+		LINEAGE_EXPR(copyLineage(parLineage, lineage_end, offLineage));
 		for (size_t p = 1; p < pldy; ++p)
 			clearChromosome(*offspring, 1, static_cast<int>(*it));
 	}
@@ -562,7 +612,7 @@ string Recombinator::describe(bool /* format */) const
 }
 
 
-size_t Recombinator::markersConverted(size_t index, const Individual & ind) const
+size_t Recombinator::markersConverted(size_t index, const Individual & /* ind */) const
 {
 	int mode = static_cast<int>(m_convMode[0]);
 
@@ -577,7 +627,7 @@ size_t Recombinator::markersConverted(size_t index, const Individual & ind) cons
 			num = getRNG().randGeometric(m_convMode[2]);
 
 		// if conversion reaches end of chromosome, it is an recombination event
-		if (num == 0 || num >= ind.lociLeft(index))
+		if (num == 0 || num >= m_lociLeft[index])
 			return 0;
 		else
 			return num;
@@ -591,15 +641,83 @@ size_t Recombinator::markersConverted(size_t index, const Individual & ind) cons
 		// recombination starts 'before' index so we assume that it happens
 		// randomly (uniformly) between this and previous marker
 		if (index > 0)
-			len -= getRNG().randUniform() * ind.lociDist(index - 1, index);
-		if (len <= 0. || len >= ind.distLeft(index))
+			len -= getRNG().randUniform() * (m_lociPos[index] - m_lociPos[index - 1]);
+		if (len <= 0. || len >= m_distLeft[index])
 			return 0;
-		else
-			return ind.lociCovered(index, len);
+		// first locus whose position lies beyond the converted tract
+		vectorf::const_iterator it = std::upper_bound(
+			m_lociPos.begin() + index + 1,
+			m_lociPos.begin() + index + m_lociLeft[index],
+			m_lociPos[index] + len);
+		return static_cast<size_t>(it - (m_lociPos.begin() + index));
 	}
 }
 
 
+/** CPPONLY a fully prepared recombination plan: everything initialize()
+ *  derives from the genotypic structure and the operator parameters, but
+ *  not the per-operator trial generators, which are bound to the random
+ *  number streams of their own operator.
+ */
+struct RecombinationPlan
+{
+	vectorf lociPos;
+	vectoru lociLeft;
+	vectorf distLeft;
+	int customizedBegin;
+	int customizedEnd;
+	vectoru recBeforeLoci;
+	vectorf vecP;
+	int algorithm;
+};
+
+// Plans are kept for the whole session in a registry keyed by (genotypic
+// structure index, parameter digest). Driver scripts that steer a
+// simulation through many short evolve() calls construct fresh operators
+// for each call, so the per-operator m_lastGenoStru guard never gets a
+// chance to help; the registry lets the new instance adopt the plan an
+// earlier instance computed for the same structure and parameters.
+typedef std::map<std::pair<size_t, uint64_t>, RecombinationPlan> RecombinationPlanMap;
+static RecombinationPlanMap g_recombinationPlans;
+
+static uint64_t planHashAppend(uint64_t h, const void * p, size_t n)
+{
+	const unsigned char * s = reinterpret_cast<const unsigned char *>(p);
+
+	for (size_t i = 0; i < n; ++i) {
+		h ^= s[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+
+uint64_t Recombinator::parameterDigest(const Individual & ind) const
+{
+	uint64_t h = 14695981039346656037ull;
+	size_t n = m_rates.size();
+
+	h = planHashAppend(h, &n, sizeof(n));
+	if (n > 0)
+		h = planHashAppend(h, &m_rates[0], n * sizeof(double));
+	h = planHashAppend(h, &m_intensity, sizeof(m_intensity));
+	n = m_convMode.size();
+	h = planHashAppend(h, &n, sizeof(n));
+	if (n > 0)
+		h = planHashAppend(h, &m_convMode[0], n * sizeof(double));
+	bool allAvail = m_loci.allAvail();
+	h = planHashAppend(h, &allAvail, sizeof(allAvail));
+	if (!allAvail) {
+		const vectoru & loci = m_loci.elems(&ind);
+		n = loci.size();
+		h = planHashAppend(h, &n, sizeof(n));
+		if (n > 0)
+			h = planHashAppend(h, &loci[0], n * sizeof(size_t));
+	}
+	return h;
+}
+
+
 void Recombinator::initialize(const Individual & ind) const
 {
 	GenoTransmitter::initialize(ind);
@@ -607,6 +725,57 @@ void Recombinator::initialize(const Individual & ind) const
 	m_chromX = ind.chromX();
 	m_chromY = ind.chromY();
 	m_mitochondrial = ind.mitochondrial();
+
+	// adopt a plan prepared by a previous instance for the same structure
+	// and parameters, if there is one. This lookup happens in the serial
+	// setup step of the offspring generator, before any parallel region.
+	std::pair<size_t, uint64_t> planKey(ind.genoStruIdx(), parameterDigest(ind));
+	RecombinationPlanMap::const_iterator planIt = g_recombinationPlans.find(planKey);
+	if (planIt != g_recombinationPlans.end()) {
+		const RecombinationPlan & plan = planIt->second;
+		m_lociPos = plan.lociPos;
+		m_lociLeft = plan.lociLeft;
+		m_distLeft = plan.distLeft;
+		m_customizedBegin = plan.customizedBegin;
+		m_customizedEnd = plan.customizedEnd;
+		m_recBeforeLoci = plan.recBeforeLoci;
+		m_algorithm = plan.algorithm;
+		if (plan.vecP.empty())
+			return;
+		if (m_algorithm == 2) {
+			// mirror the uniform-rare shortcut of the full computation
+			if (m_rates.empty())
+				const_cast<vectorf &>(m_rates).push_back(plan.vecP[0]);
+		} else {
+			// trial generators stay per-operator: they draw from the
+			// random number streams the operator was constructed with
+#ifdef _OPENMP
+			for (size_t i = 0; i < numThreads(); i++)
+				m_bt[i].setParameter(plan.vecP);
+#else
+			m_bt.setParameter(plan.vecP);
+#endif
+		}
+		DBG_DO(DBG_TRANSMITTER, cerr << "Algorithm " << m_algorithm << " is being used (cached plan)" << endl);
+		return;
+	}
+	// flatten the chromosome structure into per-locus arrays, so that the
+	// conversion handling of the per-crossover path looks up positions and
+	// remaining chromosome lengths by direct indexing
+	size_t totLoci = ind.totNumLoci();
+	m_lociPos.resize(totLoci);
+	m_lociLeft.resize(totLoci);
+	m_distLeft.resize(totLoci);
+	for (size_t loc = 0; loc < totLoci; ++loc)
+		m_lociPos[loc] = ind.locusPos(loc);
+	for (size_t ch = 0; ch < ind.numChrom(); ++ch) {
+		size_t chBegin = ind.chromBegin(ch);
+		size_t chEnd = ind.chromEnd(ch);
+		for (size_t loc = chBegin; loc < chEnd; ++loc) {
+			m_lociLeft[loc] = chEnd - loc;
+			m_distLeft[loc] = m_lociPos[chEnd - 1] - m_lociPos[loc];
+		}
+	}
 	if (!ind.customizedChroms().empty()) {
 		m_customizedBegin = static_cast<int>(ind.chromBegin(ind.customizedChroms()[0]));
 		m_customizedEnd = static_cast<int>(ind.chromEnd(ind.customizedChroms().back()));
@@ -641,6 +810,9 @@ void Recombinator::initialize(const Individual & ind) const
 
 	m_recBeforeLoci.clear();
 	vecP.clear();
+	// number of intervals at which recombination may be attempted, before
+	// zero-rate intervals are dropped; used only to choose an algorithm
+	size_t numIntervals = 0;
 	for (size_t ch = 0; ch < ind.numChrom(); ++ch) {
 		size_t chBegin = ind.chromBegin(ch);
 		size_t chEnd = ind.chromEnd(ch);
@@ -660,7 +832,6 @@ void Recombinator::initialize(const Individual & ind) const
 		if (m_loci.allAvail() && m_rates.size() == 1) {
 			// get loci distance * m_rates and then recombinant points
 			for (size_t loc = chBegin; loc < chEnd - 1; ++loc) {
-				m_recBeforeLoci.push_back(loc + 1);
 				double r = useLociDist ? ((ind.locusPos(loc + 1) - ind.locusPos(loc)) * m_intensity) : m_rates[0];
 
 				DBG_WARNIF(fcmp_gt(r, 0.5),
@@ -668,6 +839,14 @@ void Recombinator::initialize(const Individual & ind) const
 						           " ) and it is set to 0.5. This may happen \n"
 						           "when you use recombination m_intensity instead of m_rates, and your loci \n"
 						           "distance is too high.)") % loc % r).str());
+				++numIntervals;
+				// a zero-rate interval can never recombine, so it needs no
+				// trial slot; hot/cold genetic maps become a compressed
+				// list over which trials and breakpoint scans jump directly
+				// from one region of nonzero rate to the next
+				if (r == 0.)
+					continue;
+				m_recBeforeLoci.push_back(loc + 1);
 				vecP.push_back(min(0.5, r));
 			}
 		} else {
@@ -686,24 +865,34 @@ void Recombinator::initialize(const Individual & ind) const
 						r = max(m_rates[0], 0.);
 					else
 						r = m_rates[pos];
-					m_recBeforeLoci.push_back(loc + 1);
-					vecP.push_back(min(0.5, r));
 
-					DBG_ASSERT(fcmp_ge(vecP[vecP.size() - 1], 0) && fcmp_le(vecP[vecP.size() - 1], 1),
+					DBG_ASSERT(fcmp_ge(min(0.5, r), 0) && fcmp_le(min(0.5, r), 1),
 						ValueError,
 						"Recombination m_rates should be in [0,1]. (Maybe your loci distance is too high.)");
+					++numIntervals;
+					// skip intervals at which recombination can not happen
+					if (r == 0.)
+						continue;
+					m_recBeforeLoci.push_back(loc + 1);
+					vecP.push_back(min(0.5, r));
 				}
 			}
 		}
 		// after each chromosome ...
+		++numIntervals;
 		m_recBeforeLoci.push_back(chEnd);
 		vecP.push_back(0.5);
 	}
 	//DBG_DO(DBG_TRANSMITTER, cerr	<< "Specify after Loci. With m_rates "
 	//	                            << vecP << " before " << m_recBeforeLoci << endl);
 
-	if (vecP.empty())
+	if (vecP.empty()) {
+		// nothing will recombine under these parameters; remember that
+		// outcome as well, it is reached by the same O(loci) scan
+		m_algorithm = 0;
+		storePlan(planKey, vecP);
 		return;
+	}
 
 	DBG_ASSERT(vecP.size() == m_recBeforeLoci.size(), SystemError,
 		"Rate and before loci should have the same length.");
@@ -719,7 +908,12 @@ void Recombinator::initialize(const Individual & ind) const
 	// a variable to tell it.
 	bool uniform_rare = true;
 	double uniform_rate = vecP[0];
-	for (size_t i = 0; i < static_cast<size_t>(vecP.size() - 1); ++i) {
+	// dropped zero-rate intervals leave gaps in m_recBeforeLoci, which the
+	// consecutiveness test below rejects, so the uniform-rate shortcut is
+	// only taken when every interval kept its slot
+	if (vecP.size() != numIntervals)
+		uniform_rare = false;
+	for (size_t i = 0; uniform_rare && i < static_cast<size_t>(vecP.size() - 1); ++i) {
 		if (vecP[i] > 1e-2 || fcmp_ne(vecP[i], uniform_rate)) {
 			uniform_rare = false;
 			break;
@@ -739,7 +933,10 @@ void Recombinator::initialize(const Individual & ind) const
 	// handling of sex chromosomes etc.
 	//
 	// average recombination rate > 0.01, or with sex chromosomes
-	if (fabs(std::accumulate(vecP.begin(), vecP.end(), 0.) - 0.5 * ind.numChrom()) > 0.01 * vecP.size()
+	// the density heuristic uses the number of intervals before zero-rate
+	// ones were dropped: dropping them concentrates the remaining rates but
+	// does not make the genome-wide recombination landscape any denser
+	if (fabs(std::accumulate(vecP.begin(), vecP.end(), 0.) - 0.5 * ind.numChrom()) > 0.01 * numIntervals
 	    || m_chromX > 0 || m_customizedBegin > 0)
 		m_algorithm = 0;
 	else if (uniform_rare) {
@@ -760,11 +957,30 @@ void Recombinator::initialize(const Individual & ind) const
 		m_bt.setParameter(vecP);
 #endif
 	}
+	storePlan(planKey, vecP);
 
 	DBG_DO(DBG_TRANSMITTER, cerr << "Algorithm " << m_algorithm << " is being used " << endl);
 }
 
 
+void Recombinator::storePlan(const std::pair<size_t, uint64_t> & key, const vectorf & vecP) const
+{
+	// plans are small (a few vectors over the loci), but an unbounded
+	// registry would leak in scripts that scan many parameter settings
+	if (g_recombinationPlans.size() > 256)
+		g_recombinationPlans.clear();
+	RecombinationPlan & plan = g_recombinationPlans[key];
+	plan.lociPos = m_lociPos;
+	plan.lociLeft = m_lociLeft;
+	plan.distLeft = m_distLeft;
+	plan.customizedBegin = m_customizedBegin;
+	plan.customizedEnd = m_customizedEnd;
+	plan.recBeforeLoci = m_recBeforeLoci;
+	plan.vecP = vecP;
+	plan.algorithm = m_algorithm;
+}
+
+
 void Recombinator::transmitGenotype(const Individual & parent,
                                     Individual & offspring, int ploidy) const
 {
@@ -831,8 +1047,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			forceFirstEnd = static_cast<int>(parent.chromEnd(m_chromX));
 		}
 	}
-	// get a new set of values.
-	// const BoolResults& bs = bt.trial();
+	// get a new set of values. The trial table is generated in batches of
+	// trials (one row of breakpoint bits per transmitted chromosome set),
+	// so this normally just advances to the next pre-generated row.
 	if (m_algorithm != 2)
 		bt.trial();
 	int curCp = m_algorithm == 2 ? getRNG().randBit() : (bt.trialSucc(m_recBeforeLoci.size() - 1) ? 0 : 1);
@@ -864,6 +1081,38 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		// negative means no conversion is pending.
 		ssize_t convCount = -1;
 		size_t gtEnd = m_recBeforeLoci.back();
+#ifndef MUTANTALLELE
+		// Copying allele by allele is slow: it goes through bit proxies in
+		// the binary module and adds a second per-locus assignment in the
+		// lineage module.  Instead of copying at each locus, accumulate the
+		// run of loci that come from the same parental strand and splice it
+		// into the offspring with a block copy (of both genotype and
+		// lineage, if tracked) whenever the strand switches, a skipped
+		// region starts, or the chromosomes end.
+		size_t segBegin = 0;
+		bool segActive = false;
+#  ifdef BINARYALLELE
+#    define FLUSH_SEGMENT(end)                                              \
+	do {                                                                    \
+		if (segActive) {                                                    \
+			copyGenotype(cp[curCp] + segBegin, off + segBegin,              \
+				(end) - segBegin);                                          \
+			segActive = false;                                              \
+		}                                                                   \
+	} while (false)
+#  else
+#    define FLUSH_SEGMENT(end)                                              \
+	do {                                                                    \
+		if (segActive) {                                                    \
+			copyGenotype(cp[curCp] + segBegin, cp[curCp] + (end),           \
+				off + segBegin);                                            \
+			LINEAGE_EXPR(copyLineage(lineagep[curCp] + segBegin,            \
+					lineagep[curCp] + (end), lineageOff + segBegin));       \
+			segActive = false;                                              \
+		}                                                                   \
+	} while (false)
+#  endif
+#endif
 		for (size_t gt = 0, bl = 0; gt < gtEnd; ++gt, --convCount) {
 			// do not copy genotype in the ignored region.
 			if ((ignoreBegin < 0 || gt < static_cast<size_t>(ignoreBegin) || gt >= static_cast<size_t>(ignoreEnd)) &&
@@ -877,23 +1126,40 @@ void Recombinator::transmitGenotype(const Individual & parent,
 					to_next = min((cp[curCp] + gt).to_next(), (off + gt).to_next());
 				}
 #else
-				off[gt] = cp[curCp][gt];
+				if (!segActive) {
+					segBegin = gt;
+					segActive = true;
+				}
 #endif
-				LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
 			}
+#ifndef MUTANTALLELE
+			else
+				FLUSH_SEGMENT(gt);
+#endif
 			// look ahead
 			if (convCount == 0) {             // conversion ...
 				if (forceFirstBegin > 0 && gt + 1 >= static_cast<size_t>(forceFirstBegin)
 				    && gt + 1 < static_cast<size_t>(forceFirstEnd)) {
 					if (curCp != 0 && m_debugOutput)
 						*m_debugOutput << ' ' << gt;
+#ifndef MUTANTALLELE
+					if (curCp != 0)
+						FLUSH_SEGMENT(gt + 1);
+#endif
 					curCp = 0;
 				} else if (forceSecondBegin > 0 && gt + 1 >= static_cast<size_t>(forceSecondBegin)
 				           && gt + 1 < static_cast<size_t>(forceSecondEnd)) {
 					if (curCp != 1 && m_debugOutput)
 						*m_debugOutput << ' ' << gt;
+#ifndef MUTANTALLELE
+					if (curCp != 1)
+						FLUSH_SEGMENT(gt + 1);
+#endif
 					curCp = 1;
 				} else {
+#ifndef MUTANTALLELE
+					FLUSH_SEGMENT(gt + 1);
+#endif
 					curCp = (curCp + 1) % 2;
 					if (m_debugOutput)
 						*m_debugOutput << ' ' << gt;
@@ -908,22 +1174,33 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				    && gt + 1 < static_cast<size_t>(forceFirstEnd)) {
 					if (curCp != 0 && m_debugOutput)
 						*m_debugOutput << ' ' << gt;
+#ifndef MUTANTALLELE
+					if (curCp != 0)
+						FLUSH_SEGMENT(gt + 1);
+#endif
 					curCp = 0;
 					convCount = -1;
 				} else if (forceSecondBegin >= 0 && gt + 1 >= static_cast<size_t>(forceSecondBegin)
 				           && gt + 1 < static_cast<size_t>(forceSecondEnd)) {
 					if (curCp != 1 && m_debugOutput)
 						*m_debugOutput << ' ' << gt;
+#ifndef MUTANTALLELE
+					if (curCp != 1)
+						FLUSH_SEGMENT(gt + 1);
+#endif
 					curCp = 1;
 					convCount = -1;
 				} else if (convCount < 0 && bt.trialSucc(bl)) {
 					// recombination (if convCount == 0, a conversion event is ending)
+#ifndef MUTANTALLELE
+					FLUSH_SEGMENT(gt + 1);
+#endif
 					curCp = (curCp + 1) % 2;
 					if (m_debugOutput)
 						*m_debugOutput << ' ' << gt;
 					// if conversion happens
 					if (withConversion &&
-					    parent.lociLeft(gt) != 1 &&             // can not be at the end of a chromosome
+					    m_lociLeft[gt] != 1 &&             // can not be at the end of a chromosome
 					    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 						// convCount will be decreased, until reconversion completes
 						// or another recombination happens
@@ -935,6 +1212,10 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				++bl;
 			}
 		}
+#ifndef MUTANTALLELE
+		FLUSH_SEGMENT(gtEnd);
+#  undef FLUSH_SEGMENT
+#endif
 	} else if (m_algorithm == 1) {
 #ifndef BINARYALLELE
 		size_t gt = 0, gtEnd = 0;
@@ -943,22 +1224,18 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		ssize_t convCount = -1;
 		size_t convEnd;
 		if (pos != Bernullitrials_T::npos) {
-			// first piece
-#  ifdef MUTANTALLELE
+			// first piece. Segments between breakpoints are spliced with the
+			// block-copy copyGenotype overloads in every module instead of
+			// one assignment per locus.
 			copyGenotype(cp[curCp] + gt, cp[curCp] + m_recBeforeLoci[pos], off + gt);
+			LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 			gt = m_recBeforeLoci[pos];
-#  else
-			for (; gt < m_recBeforeLoci[pos]; ++gt) {
-				off[gt] = cp[curCp][gt];
-				LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-			}
-#  endif
 			curCp = (curCp + 1) % 2;
 			if (m_debugOutput)
 				*m_debugOutput << ' ' << gt - 1;
 			//
 			if (withConversion &&
-			    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+			    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 			    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 				convCount = markersConverted(gt, parent);
 			}
@@ -970,15 +1247,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				if (convCount > 0) {
 					convEnd = gt + convCount;
 					if (convEnd < gtEnd) {
-#  ifdef MUTANTALLELE
 						copyGenotype(cp[curCp] + gt, cp[curCp] + convEnd, off + gt);
+						LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + convEnd, lineageOff + gt));
 						gt = convEnd;
-#  else
-						for (; gt < convEnd; ++gt) {
-							off[gt] = cp[curCp][gt];
-							LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-						}
-#  endif
 						curCp = (curCp + 1) % 2;
 						if (m_debugOutput)
 							*m_debugOutput << ' ' << gt - 1;
@@ -987,22 +1258,16 @@ void Recombinator::transmitGenotype(const Individual & parent,
 					convCount = -1;
 				}
 				// copy from the end of conversion to this recombination point
-#  ifdef MUTANTALLELE
 				copyGenotype(cp[curCp] + gt, cp[curCp] + gtEnd, off + gt);
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
 				gt = gtEnd;
-#  else
-				for (; gt < gtEnd; ++gt) {
-					off[gt] = cp[curCp][gt];
-					LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-				}
-#  endif
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 				//
 				// conversion event for this recombination event
 				if (withConversion &&
-				    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+				    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 				    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 					// convCount will be decreased, until reconversion completes
 					// or another recombination happens
@@ -1015,29 +1280,17 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		if (convCount > 0) {
 			convEnd = gt + convCount;
 			if (convEnd < gtEnd) {
-#  ifdef MUTANTALLELE
 				copyGenotype(cp[curCp] + gt, cp[curCp] + convEnd, off + gt);
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + convEnd, lineageOff + gt));
 				gt = convEnd;
-#  else
-				for (; gt < convEnd; ++gt) {
-					off[gt] = cp[curCp][gt];
-					LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-				}
-#  endif
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 			}
 		}
-#  ifdef MUTANTALLELE
 		copyGenotype(cp[curCp] + gt, cp[curCp] + gtEnd, off + gt);
+		LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
 		gt = gtEnd;
-#  else
-		for (; gt < gtEnd; ++gt) {
-			off[gt] = cp[curCp][gt];
-			LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-		}
-#  endif
 #else
 		size_t gt = 0, gtEnd = 0;
 		size_t pos = bt.probFirstSucc();
@@ -1050,13 +1303,13 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
 			// for binary module, this is not needed, but it is kept here anyway, in case some
 			// people would like to implement lineage feature for binary modules
-			LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
+			LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 			gt = gtEnd;
 			curCp = (curCp + 1) % 2;
 			if (m_debugOutput)
 				*m_debugOutput << ' ' << gt - 1;
 			if (withConversion &&
-			    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+			    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 			    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 				convCount = markersConverted(gt, parent);
 			}
@@ -1068,7 +1321,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 					if (convEnd < gtEnd) {
 						copyGenotype(cp[curCp] + gt, off + gt, convCount);
 						// not used for binary module
-						LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
+						LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 						gt = convEnd;
 						curCp = (curCp + 1) % 2;
 						if (m_debugOutput)
@@ -1080,14 +1333,14 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				// copy from the end of conversion to the next recombination point
 				copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
 				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 				gt = gtEnd;
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 				// conversion event for this recombination event
 				if (withConversion &&
-				    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+				    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 				    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 					// convCount will be decreased, until reconversion completes
 					// or another recombination happens
@@ -1102,7 +1355,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			if (convEnd < gtEnd) {
 				copyGenotype(cp[curCp] + gt, off + gt, convCount);
 				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 				gt = convEnd;
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
@@ -1111,7 +1364,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		}
 		copyGenotype(cp[curCp] + gt, off + gt, gtEnd - gt);
 		// not used for binary module
-		LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
+		LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
 #endif
 	} else {
 #ifndef BINARYALLELE
@@ -1128,21 +1381,15 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		size_t convEnd;
 		if (pos != Bernullitrials_T::npos) {
 			// first piece
-#  ifdef MUTANTALLELE
 			copyGenotype(cp[curCp] + gt, cp[curCp] + m_recBeforeLoci[pos], off + gt);
+			LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 			gt = m_recBeforeLoci[pos];
-#  else
-			for (; gt < m_recBeforeLoci[pos]; ++gt) {
-				off[gt] = cp[curCp][gt];
-				LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-			}
-#  endif
 			curCp = (curCp + 1) % 2;
 			if (m_debugOutput)
 				*m_debugOutput << ' ' << gt - 1;
 			//
 			if (withConversion &&
-			    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+			    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 			    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 				convCount = markersConverted(gt, parent);
 			}
@@ -1160,15 +1407,9 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				if (convCount > 0) {
 					convEnd = gt + convCount;
 					if (convEnd < gtEnd) {
-#  ifdef MUTANTALLELE
 						copyGenotype(cp[curCp] + gt, cp[curCp] + convEnd, off + gt);
+						LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + convEnd, lineageOff + gt));
 						gt = convEnd;
-#  else
-						for (; gt < convEnd; ++gt) {
-							off[gt] = cp[curCp][gt];
-							LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-						}
-#  endif
 						curCp = (curCp + 1) % 2;
 						if (m_debugOutput)
 							*m_debugOutput << ' ' << gt - 1;
@@ -1177,22 +1418,16 @@ void Recombinator::transmitGenotype(const Individual & parent,
 					convCount = -1;
 				}
 				// copy from the end of conversion to this recombination point
-#  ifdef MUTANTALLELE
 				copyGenotype(cp[curCp] + gt, cp[curCp] + gtEnd, off + gt);
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
 				gt = gtEnd;
-#  else
-				for (; gt < gtEnd; ++gt) {
-					off[gt] = cp[curCp][gt];
-					LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-				}
-#  endif
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 				//
 				// conversion event for this recombination event
 				if (withConversion &&
-				    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+				    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 				    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 					// convCount will be decreased, until reconversion completes
 					// or another recombination happens
@@ -1206,29 +1441,17 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		if (convCount > 0) {
 			convEnd = gt + convCount;
 			if (convEnd < gtEnd) {
-#  ifdef MUTANTALLELE
 				copyGenotype(cp[curCp] + gt, cp[curCp] + convEnd, off + gt);
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + convEnd, lineageOff + gt));
 				gt = convEnd;
-#  else
-				for (; gt < convEnd; ++gt) {
-					off[gt] = cp[curCp][gt];
-					LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-				}
-#  endif
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 			}
 		}
-#  ifdef MUTANTALLELE
 		copyGenotype(cp[curCp] + gt, cp[curCp] + gtEnd, off + gt);
+		LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
 		gt = gtEnd;
-#  else
-		for (; gt < gtEnd; ++gt) {
-			off[gt] = cp[curCp][gt];
-			LINEAGE_EXPR(lineageOff[gt] = lineagep[curCp][gt]);
-		}
-#  endif
 #else       // binary alleles
 		size_t gt = 0, gtEnd = 0;
 		size_t step = getRNG().randGeometric(m_rates[0]);
@@ -1242,13 +1465,13 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
 			// for binary module, this is not needed, but it is kept here anyway, in case some
 			// people would like to implement lineage feature for binary modules
-			LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
+			LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 			gt = gtEnd;
 			curCp = (curCp + 1) % 2;
 			if (m_debugOutput)
 				*m_debugOutput << ' ' << gt - 1;
 			if (withConversion &&
-			    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+			    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 			    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 				convCount = markersConverted(gt, parent);
 			}
@@ -1266,7 +1489,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 					if (convEnd < gtEnd) {
 						copyGenotype(cp[curCp] + gt, off + gt, convCount);
 						// not used for binary module
-						LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
+						LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 						gt = convEnd;
 						curCp = (curCp + 1) % 2;
 						if (m_debugOutput)
@@ -1278,14 +1501,14 @@ void Recombinator::transmitGenotype(const Individual & parent,
 				// copy from the end of conversion to the next recombination point
 				copyGenotype(cp[curCp] + gt, off + gt, m_recBeforeLoci[pos] - gt);
 				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + m_recBeforeLoci[pos], lineageOff + gt));
 				gt = gtEnd;
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
 					*m_debugOutput << ' ' << gt - 1;
 				// conversion event for this recombination event
 				if (withConversion &&
-				    parent.lociLeft(gt - 1) != 1 &&             // can not be at the end of a chromosome
+				    m_lociLeft[gt - 1] != 1 &&             // can not be at the end of a chromosome
 				    (m_convMode[1] == 1. || getRNG().randUniform() < m_convMode[1])) {
 					// convCount will be decreased, until reconversion completes
 					// or another recombination happens
@@ -1300,7 +1523,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 			if (convEnd < gtEnd) {
 				copyGenotype(cp[curCp] + gt, off + gt, convCount);
 				// not used for binary module
-				LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
+				LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gt + convCount, lineageOff + gt));
 				gt = convEnd;
 				curCp = (curCp + 1) % 2;
 				if (m_debugOutput)
@@ -1309,7 +1532,7 @@ void Recombinator::transmitGenotype(const Individual & parent,
 		}
 		copyGenotype(cp[curCp] + gt, off + gt, gtEnd - gt);
 		// not used for binary module
-		LINEAGE_EXPR(copy(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
+		LINEAGE_EXPR(copyLineage(lineagep[curCp] + gt, lineagep[curCp] + gtEnd, lineageOff + gt));
 #endif
 	}
 
@@ -1351,6 +1574,29 @@ bool Recombinator::applyDuringMating(Population & pop, Population & offPop, RawI
 		m_debugOutput = &getOstream(pop.dict());
 	else
 		m_debugOutput = NULL;
+#if defined(_OPENMP) && !defined(MUTANTALLELE) && !defined(BINARYALLELE)
+	// the two transmitted gametes share no state: each thread has its own
+	// trial table and RNG stream, and they write to different homologous
+	// sets of the offspring. For a long genome this puts a second core to
+	// work on one offspring when the family loop itself is not running in
+	// parallel. Splitting a single gamete by chromosome would not pay
+	// here, because the breakpoint scan carries the current strand and a
+	// possible pending conversion across the whole genome. The two
+	// homologous sets of the binary module can share the machine word at
+	// their boundary, and the compressed mutant storage cannot take
+	// concurrent writers, so both keep the sequential path.
+	if (numThreads() > 1 && !omp_in_parallel() && m_debugOutput == NULL &&
+	    offspring->totNumLoci() >= 100000) {
+#  pragma omp parallel sections num_threads(2)
+		{
+#  pragma omp section
+			transmitGenotype(*(mom ? mom : dad), *offspring, 0);
+#  pragma omp section
+			transmitGenotype(*(dad ? dad : mom), *offspring, 1);
+		}
+		return true;
+	}
+#endif
 	transmitGenotype(*(mom ? mom : dad), *offspring, 0);
 	transmitGenotype(*(dad ? dad : mom), *offspring, 1);
 
@@ -51,7 +51,7 @@ public:
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
-		m_lastGenoStru(MaxTraitIndex), m_ploidy(0), m_hasCustomizedChroms(false), m_lociToCopy(0), m_chromIdx(0)
+		m_lastGenoStru(MaxTraitIndex), m_ploidy(0), m_totNumLoci(0), m_hasCustomizedChroms(false), m_lociToCopy(0), m_chromIdx(0)
 	{
 	}
 
@@ -128,6 +128,7 @@ protected:
 	// cache some genostructor information for
 	// faster performance
 	mutable UINT m_ploidy;
+	mutable size_t m_totNumLoci;
 	mutable bool m_hasCustomizedChroms;
 	mutable vectoru m_lociToCopy;
 	mutable vectoru m_chromIdx;
@@ -140,6 +141,17 @@ protected:
  *  addition to genotypes on all non-customized or specified chromosomes, sex
  *  and information fields are by default also coped copied from parent to
  *  offspring.
+ *
+ *  Implementation note: interning identical genomes (one shared copy per
+ *  distinct genotype, duplicated on the first mutation) has been considered
+ *  for clonal models but does not fit the storage model. Individuals expose
+ *  their genotypes as raw iterators into a flat per-generation array (or the
+ *  compressed array of the mutant module), and operators read and write
+ *  through these iterators with plain pointer arithmetic, so shared storage
+ *  would require an indirection plus a write barrier on every allele access.
+ *  For large clonal simulations the mutant module already keeps memory
+ *  proportional to the number of derived alleles rather than the genome
+ *  length, which is the practical substitute.
  */
 class CloneGenoTransmitter : public GenoTransmitter
 {
@@ -218,7 +230,8 @@ public:
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr()) :
 		GenoTransmitter(output, begin, end, step, at, reps, subPops, infoFields),
-		m_chromX(-1), m_chromY(-1), m_mitochondrial(-1), m_numChrom(0)
+		m_chromX(-1), m_chromY(-1), m_mitochondrial(-1), m_numChrom(0),
+		m_simpleLayout(false)
 	{
 	}
 
@@ -276,6 +289,11 @@ protected:
 	mutable int m_mitochondrial;
 
 	mutable size_t m_numChrom;
+
+	// true when the genome consists of autosomes only, decided once in
+	// initialize so that transmitGenotype can take its block-copy path
+	// without re-testing the layout for every offspring.
+	mutable bool m_simpleLayout;
 };
 
 
@@ -638,6 +656,14 @@ private:
 	/// determine number of markers to convert
 	size_t markersConverted(size_t index, const Individual & ind) const;
 
+	/// digest of the parameters that determine the recombination plan,
+	/// used with the genotypic structure index to key the session-level
+	/// plan registry
+	uint64_t parameterDigest(const Individual & ind) const;
+
+	/// publish the plan computed by initialize() to the registry
+	void storePlan(const std::pair<size_t, uint64_t> & key, const vectorf & vecP) const;
+
 private:
 	/// intensity
 	const double m_intensity;
@@ -651,6 +677,14 @@ private:
 	/// position to recombine, changed to fit a special pop
 	mutable vectoru m_recBeforeLoci;
 
+	/// per-locus copies of the locus positions, the number of loci and the
+	/// map distance left on the chromosome, flattened by initialize() so
+	/// that gene conversion handling resolves them by direct indexing
+	/// instead of scanning the chromosome structure per crossover
+	mutable vectorf m_lociPos;
+	mutable vectoru m_lociLeft;
+	mutable vectorf m_distLeft;
+
 	const vectorf m_convMode;
 
 	// locataion of special chromosomes
@@ -159,6 +159,9 @@ namespace simuPOP {
 // debug codes in a bitset.
 std::bitset<DBG_CODE_LENGTH> g_dbgCode;
 
+// per-thread nesting depth of phases that run with the GIL released
+thread_local int GILRelease::s_depth = 0;
+
 
 #ifndef OPTIMIZED
 #  include <time.h>
@@ -180,6 +183,32 @@ void elapsedTime(const string & name)
 }
 
 
+clock_t g_opClock;
+
+void profileStart()
+{
+	if (debug(DBG_PROFILE))
+		g_opClock = clock();
+}
+
+
+void profileOpTime(SharedVariables & vars, const string & name)
+{
+	if (debug(DBG_PROFILE)) {
+		double secs = static_cast<double>(clock() - g_opClock) / CLOCKS_PER_SEC;
+		// operator descriptions can contain characters that the name parser of
+		// setVar would interpret as subscripts or quotes, so they are filtered
+		// out of the key.
+		string key;
+		for (size_t i = 0; i < name.size(); ++i)
+			if (name[i] != '{' && name[i] != '}' && name[i] != '[' &&
+			    name[i] != ']' && name[i] != '\'' && name[i] != '"')
+				key += name[i];
+		vars.setVar("opTime{'" + key + "'}", secs);
+	}
+}
+
+
 #endif
 
 
@@ -478,6 +507,31 @@ UINT numThreads()
 }
 
 
+UINT ompChunkSize(size_t iters)
+{
+#ifdef _OPENMP
+	// leave about eight chunks per thread so that skewed iteration costs
+	// can still be balanced, without one dispatch per iteration when
+	// there are many cheap ones
+	size_t chunk = iters / (g_numThreads * 8);
+	if (chunk < 1)
+		chunk = 1;
+#  ifndef OPTIMIZED
+	if (debug(DBG_PROFILE)) {
+		string msg = (boost::format("dynamic loops with %1% iterations are scheduled with chunk size %2%")
+			      % iters % chunk).str();
+		if (!repeatedWarning(msg))
+			cerr << msg << endl;
+	}
+#  endif
+	return static_cast<UINT>(chunk);
+#else
+	(void)iters;
+	return 1;
+#endif
+}
+
+
 ATOMICLONG fetchAndIncrement(ATOMICLONG * val)
 {
 	if (g_numThreads == 1)
@@ -498,6 +552,23 @@ ATOMICLONG fetchAndIncrement(ATOMICLONG * val)
 }
 
 
+ATOMICLONG fetchAndAdd(ATOMICLONG * val, ATOMICLONG inc)
+{
+	if (g_numThreads == 1) {
+		ATOMICLONG prev = *val;
+		*val += inc;
+		return prev;
+	} else
+#ifdef _WIN64
+		return InterlockedExchangeAdd64(val, inc);
+#elif defined(_WIN32)
+		return InterlockedExchangeAdd(val, inc);
+#else
+		return __sync_fetch_and_add(val, inc);
+#endif
+}
+
+
 // return the global RNG
 RNG & getRNG()
 {
@@ -513,6 +584,142 @@ RNG & getRNG()
 }
 
 
+// manifest of random number consumption, written or verified by
+// rngManifestCheckpoint()
+string g_rngManifestFile;
+bool g_rngManifestVerify = false;
+ofstream g_rngManifestOut;
+ifstream g_rngManifestIn;
+size_t g_rngManifestLine = 0;
+unsigned long g_rngManifestDigest = 0;
+
+// collect pointers to the random number streams of all threads
+void collectRNGStreams(vector<RNG *> & streams)
+{
+#ifdef _OPENMP
+#  if THREADPRIVATE_SUPPORT == 0
+	streams = g_RNGs;
+#  else
+	streams.resize(g_numThreads);
+#    pragma omp parallel
+	{
+		streams[omp_get_thread_num()] = g_RNG;
+	}
+#  endif
+#else
+	streams.assign(1, &g_RNG);
+#endif
+}
+
+
+void setRNGManifest(const string & output, bool verify)
+{
+	if (g_rngManifestOut.is_open())
+		g_rngManifestOut.close();
+	if (g_rngManifestIn.is_open())
+		g_rngManifestIn.close();
+	g_rngManifestFile = output;
+	g_rngManifestVerify = verify;
+	g_rngManifestLine = 0;
+	g_rngManifestDigest = 0;
+	if (output.empty())
+		return;
+
+	vector<RNG *> streams;
+	collectRNGStreams(streams);
+	// the header pins the generator, base seed and number of streams, so
+	// that a manifest cannot appear to verify a run that was configured
+	// differently
+	string header = (boost::format("simuPOP-rng-manifest 1 %1% %2% %3%")
+		             % streams[0]->name() % streams[0]->seed() % streams.size()).str();
+	if (verify) {
+		g_rngManifestIn.open(output.c_str());
+		if (!g_rngManifestIn)
+			throw ValueError("Failed to open random number manifest " + output);
+		string line;
+		std::getline(g_rngManifestIn, line);
+		g_rngManifestLine = 1;
+		if (line != header)
+			throw RuntimeError((boost::format("Random number manifest %1% was recorded with a different "
+				                              "generator, seed or number of threads (\"%2%\", this run \"%3%\").")
+				                % output % line % header).str());
+	} else {
+		g_rngManifestOut.open(output.c_str());
+		if (!g_rngManifestOut)
+			throw ValueError("Failed to open random number manifest " + output);
+		g_rngManifestOut << header << '\n';
+	}
+}
+
+
+void rngManifestCheckpoint(ssize_t gen, size_t rep, const char * phase)
+{
+	if (g_rngManifestFile.empty())
+		return;
+
+	vector<RNG *> streams;
+	collectRNGStreams(streams);
+	// fold the state digests of all streams into a rolling digest, so that
+	// a divergence keeps all later checkpoints different as well
+	for (size_t i = 0; i < streams.size(); ++i)
+		g_rngManifestDigest = (g_rngManifestDigest * 16777619UL
+		                       ^ streams[i]->stateDigest()) & 0xFFFFFFFFUL;
+
+	ostringstream line;
+	line << gen << '\t' << rep << '\t' << phase << '\t';
+	for (size_t i = 0; i < streams.size(); ++i)
+		line << (i == 0 ? "" : " ") << streams[i]->draws();
+	line << '\t' << std::hex << g_rngManifestDigest;
+
+	if (g_rngManifestVerify) {
+		string recorded;
+		if (!std::getline(g_rngManifestIn, recorded))
+			throw RuntimeError((boost::format("Random number manifest %1% ends after line %2% "
+				                              "but this run consumes more random numbers.")
+				                % g_rngManifestFile % g_rngManifestLine).str());
+		++g_rngManifestLine;
+		if (recorded != line.str())
+			throw RuntimeError((boost::format("Random number consumption diverges from manifest %1% "
+				                              "at line %2%: recorded \"%3%\", this run \"%4%\".")
+				                % g_rngManifestFile % g_rngManifestLine % recorded % line.str()).str());
+	} else
+		g_rngManifestOut << line.str() << '\n';
+}
+
+
+void snapshotRNGStates(vector<gsl_rng *> & states, vectoru & draws)
+{
+	vector<RNG *> streams;
+	collectRNGStreams(streams);
+	states.resize(streams.size());
+	draws.resize(streams.size());
+	for (size_t i = 0; i < streams.size(); ++i) {
+		states[i] = streams[i]->saveState();
+		draws[i] = streams[i]->draws();
+	}
+}
+
+
+void restoreRNGStates(const vector<gsl_rng *> & states, const vectoru & draws)
+{
+	vector<RNG *> streams;
+	collectRNGStreams(streams);
+	if (streams.size() != states.size())
+		throw RuntimeError("The number of random number streams has changed "
+			               "since their states were captured.");
+	for (size_t i = 0; i < streams.size(); ++i)
+		streams[i]->restoreState(states[i], static_cast<unsigned long>(draws[i]));
+}
+
+
+void freeRNGStates(vector<gsl_rng *> & states)
+{
+	for (size_t i = 0; i < states.size(); ++i)
+		gsl_rng_free(states[i]);
+	states.clear();
+}
+
+
 }
 
 namespace std {
@@ -910,6 +1117,7 @@ void cleanupCircularRefs()
 
 pyFunc::pyFunc(PyObject * func) : m_func(func), m_numArgs(0), m_circular_self(NULL)
 {
+	GILGuard gil;
 	if (!m_func.isValid())
 		return;
 
@@ -1070,6 +1278,7 @@ pyFunc::pyFunc(PyObject * func) : m_func(func), m_numArgs(0), m_circular_self(NU
 
 void pyGenerator::set(PyObject * gen)
 {
+	GILGuard gil;
 	Py_XDECREF(m_iterator);
 	Py_XDECREF(m_generator);
 
@@ -1094,6 +1303,7 @@ void pyGenerator::set(PyObject * gen)
 
 PyObject * pyGenerator::next()
 {
+	GILGuard gil;
 	PyObject * obj = PyIter_Next(m_iterator);
 
 #ifndef OPTIMIZED
@@ -1227,10 +1437,16 @@ const vectoru & lociList::elems(const GenoStruTrait * trait) const
 		else if (m_status == FROM_FUNC)
 			throw ValueError("Calling a function for lociList from this operator is not allowed.");
 		else if (m_status == ALL_AVAIL) {
+			// the expansion is the identity mapping so only a new tail has
+			// to be filled when the number of loci changes
+			size_t oldSize = m_elems.size();
 			m_elems.resize(trait->totNumLoci());
-			for (size_t i = 0; i < m_elems.size(); ++i)
+			for (size_t i = oldSize; i < m_elems.size(); ++i)
 				m_elems[i] = i;
 		}
+		// positions resolved against the previous structure are invalid
+		if (m_status != REGULAR)
+			m_lociMap.clear();
 		m_trait = trait->genoStruIdx();
 	}
 	return m_elems;
@@ -1267,10 +1483,15 @@ const vectoru & lociList::elems(const Population * trait) const
 			Py_XDECREF(args);
 			m_func_gen = trait->gen();
 		} else if (m_status == ALL_AVAIL) {
+			// identity mapping, only a new tail needs to be filled
+			size_t oldSize = m_elems.size();
 			m_elems.resize(trait->totNumLoci());
-			for (size_t i = 0; i < m_elems.size(); ++i)
+			for (size_t i = oldSize; i < m_elems.size(); ++i)
 				m_elems[i] = i;
 		}
+		// indexes cached by indexOf() refer to the previous resolution
+		if (m_status != REGULAR)
+			m_lociMap.clear();
 		m_trait = trait->genoStruIdx();
 	}
 	return m_elems;
@@ -1507,7 +1728,8 @@ string PyObj_AsString(PyObject * str)
 
 // copy constructor
 SharedVariables::SharedVariables(const SharedVariables & rhs)
-	: m_ownVars(rhs.m_ownVars)
+	: m_ownVars(rhs.m_ownVars), m_firstKey(NULL), m_groupKey(NULL),
+	m_retention(rhs.m_retention)
 {
 	if (rhs.m_ownVars) {
 		m_dict = PyDict_New();
@@ -1529,6 +1751,8 @@ SharedVariables::~SharedVariables()
 	if (m_ownVars) {
 		PyDict_Clear(m_dict);
 		Py_DECREF(m_dict);
+		Py_XDECREF(m_firstKey);
+		Py_XDECREF(m_groupKey);
 	}
 }
 
@@ -1536,6 +1760,7 @@ SharedVariables::~SharedVariables()
 // setvars C++ ==> Python
 PyObject * SharedVariables::setVar(const string & name, const PyObject * val)
 {
+	GILGuard gil;
 	// find the first piece
 	size_t i, s;
 
@@ -1548,9 +1773,23 @@ PyObject * SharedVariables::setVar(const string & name, const PyObject * val)
 	// keytype (if curType = 1) (0 for string, 1 for num)
 	size_t curType = 1;
 	PyObject * curParent = m_dict;                            // should be always valid
-	PyObject * curKey = PyString_FromString(const_cast<char *>(name.substr(0, i).c_str()));
+	PyObject * curKey;
+	// reuse the cached key object of the leading identifier, which is the
+	// same (e.g. subPop) for every per-subpopulation variable a stat sets.
+	if (m_firstKey != NULL && i == m_firstName.size() &&
+	    name.compare(0, i, m_firstName) == 0) {
+		curKey = m_firstKey;
+		Py_INCREF(curKey);
+	} else {
+		curKey = PyString_FromString(const_cast<char *>(name.substr(0, i).c_str()));
+		Py_XDECREF(m_firstKey);
+		m_firstName = name.substr(0, i);
+		m_firstKey = curKey;
+		Py_INCREF(m_firstKey);
+	}
 	size_t curIdx = 0;
 	PyObject * curChild = NULL;
+	bool firstGroup = true;
 
 next:
 	// get par[1] (dict), curChild can be null, or borrow ref
@@ -1615,6 +1854,7 @@ next:
 		Py_XDECREF(curKey);
 		curKey = NULL;
 		curIdx = idx;
+		firstGroup = false;
 		i++;
 
 		goto next;
@@ -1643,22 +1883,38 @@ next:
 
 		PyObject * childKey;
 
-		if (keyType == 0)
-			childKey = PyInt_FromString(const_cast<char *>(name.substr(s, i - s).c_str()), NULL, 0);
-		else if (keyType == 3) {
-			PyObject * key_str = PyString_FromString(const_cast<char *>(name.substr(s, i - s).c_str()));
-			childKey = PyFloat_FromString(key_str, NULL);
-		} else if (keyType == 1) {
-			vectori key;
-			for (size_t j = s + 1, k = j; j < i; j = k + 1) {
-				for (k = j + 1; k < i && name[k] != ',' && name[k] != ')'; ++k) ;
-				key.push_back(atoi(name.substr(j, k - j).c_str()));
+		if (firstGroup && m_groupKey != NULL && i - s == m_groupText.size() &&
+		    name.compare(s, i - s, m_groupText) == 0) {
+			// same (subpopulation) key as a previous write, reuse it
+			childKey = m_groupKey;
+			Py_INCREF(childKey);
+		} else {
+			if (keyType == 0)
+				childKey = PyInt_FromString(const_cast<char *>(name.substr(s, i - s).c_str()), NULL, 0);
+			else if (keyType == 3) {
+				PyObject * key_str = PyString_FromString(const_cast<char *>(name.substr(s, i - s).c_str()));
+				childKey = PyFloat_FromString(key_str, NULL);
+			} else if (keyType == 1) {
+				vectori key;
+				for (size_t j = s + 1, k = j; j < i; j = k + 1) {
+					for (k = j + 1; k < i && name[k] != ',' && name[k] != ')'; ++k) ;
+					key.push_back(atoi(name.substr(j, k - j).c_str()));
+				}
+				childKey = PyTuple_New(key.size());
+				for (size_t j = 0; j < key.size(); ++j)
+					PyTuple_SetItem(childKey, j, PyInt_FromLong(key[j]));
+			} else
+				childKey = PyString_FromString(const_cast<char *>(name.substr(s + 1, i - s - 2).c_str()));
+			// only the key directly following the identifier is cached,
+			// deeper keys (e.g. haplotypes, alleles) vary per write.
+			if (firstGroup) {
+				Py_XDECREF(m_groupKey);
+				m_groupText = name.substr(s, i - s);
+				m_groupKey = childKey;
+				Py_INCREF(m_groupKey);
 			}
-			childKey = PyTuple_New(key.size());
-			for (size_t j = 0; j < key.size(); ++j)
-				PyTuple_SetItem(childKey, j, PyInt_FromLong(key[j]));
-		} else
-			childKey = PyString_FromString(const_cast<char *>(name.substr(s + 1, i - s - 2).c_str()));
+		}
+		firstGroup = false;
 		// not exist
 		if (curChild == NULL || !PyDict_Check(curChild)) {
 			// create dictionary with given key, append
@@ -1696,12 +1952,15 @@ next:
 			PyList_SetItem(curParent, curIdx, const_cast<PyObject *>(val));
 		Py_XDECREF(curKey);
 	}
+	if (!m_retention.empty())
+		applyRetention(name.substr(0, name.find_first_of("[{")));
 	return const_cast<PyObject *>(val);
 }
 
 
 PyObject * SharedVariables::getVar(const string & name, bool nameError) const
 {
+	GILGuard gil;
 	DBG_ASSERT(m_dict != NULL, ValueError,
 		"Shared variables are not associated with any Python variable. You populaiton might not be part of a simulator.");
 
@@ -1808,6 +2067,7 @@ next:
 
 void SharedVariables::removeVar(const string & name)
 {
+	GILGuard gil;
 	DBG_ASSERT(m_dict != NULL, ValueError,
 		"Shared variables are not associated with any Python variable. You populaiton might not be part of a simulator.");
 
@@ -1914,8 +2174,94 @@ next:
 }
 
 
+void SharedVariables::setVarRetention(const string & prefix, size_t keep, const string & spillFile)
+{
+	DBG_FAILIF(prefix.empty(), ValueError,
+		"A non-empty variable prefix is needed for a retention policy.");
+	DBG_FAILIF(keep == 0, ValueError,
+		"At least one variable has to be retained.");
+
+	// replace an existing policy with the same prefix
+	vector<VarRetention>::iterator pit = m_retention.begin();
+	vector<VarRetention>::iterator pit_end = m_retention.end();
+	for (; pit != pit_end; ++pit) {
+		if (pit->m_prefix != prefix)
+			continue;
+		pit->m_keep = keep;
+		pit->m_spillFile = spillFile;
+		while (pit->m_names.size() > keep) {
+			evictVar(*pit, pit->m_names.front());
+			pit->m_names.pop_front();
+		}
+		return;
+	}
+	m_retention.push_back(VarRetention(prefix, keep, spillFile));
+	// pick up matching variables that already exist in the dictionary,
+	// in dictionary (insertion) order
+	GILGuard gil;
+	VarRetention & policy = m_retention.back();
+	PyObject * key = NULL;
+	PyObject * value = NULL;
+	Py_ssize_t pos = 0;
+	while (PyDict_Next(m_dict, &pos, &key, &value)) {
+		string name;
+		PyObj_As_String(key, name);
+		if (name.compare(0, prefix.size(), prefix) == 0)
+			policy.m_names.push_back(name);
+	}
+	while (policy.m_names.size() > keep) {
+		evictVar(policy, policy.m_names.front());
+		policy.m_names.pop_front();
+	}
+}
+
+
+void SharedVariables::applyRetention(const string & name)
+{
+	vector<VarRetention>::iterator pit = m_retention.begin();
+	vector<VarRetention>::iterator pit_end = m_retention.end();
+
+	for (; pit != pit_end; ++pit) {
+		if (name.compare(0, pit->m_prefix.size(), pit->m_prefix) != 0)
+			continue;
+		// rewriting a retained variable does not change its age
+		if (find(pit->m_names.begin(), pit->m_names.end(), name) != pit->m_names.end())
+			continue;
+		pit->m_names.push_back(name);
+		while (pit->m_names.size() > pit->m_keep) {
+			evictVar(*pit, pit->m_names.front());
+			pit->m_names.pop_front();
+		}
+	}
+}
+
+
+void SharedVariables::evictVar(const VarRetention & policy, const string & name)
+{
+	GILGuard gil;
+	PyObject * val = PyDict_GetItemString(m_dict, const_cast<char *>(name.c_str()));
+
+	// the variable might have been removed by other means
+	if (val == NULL)
+		return;
+	if (!policy.m_spillFile.empty()) {
+		PyObject * repr = PyObject_Repr(val);
+		if (repr == NULL)
+			throw RuntimeError("Failed to represent evicted variable " + name + " as a string.");
+		string text = PyObj_AsString(repr);
+		Py_DECREF(repr);
+		ofstream spill(policy.m_spillFile.c_str(), std::ios::app);
+		if (!spill)
+			throw ValueError("Can not open file " + policy.m_spillFile + " to append evicted variables.");
+		spill << name << " = " << text << '\n';
+	}
+	PyDict_DelItemString(m_dict, const_cast<char *>(name.c_str()));
+}
+
+
 PyObject * SharedVariables::setVar(const string & name, const bool val)
 {
+	GILGuard gil;
 	PyObject * obj = val ? Py_True : Py_False;
 
 	Py_INCREF(obj);
@@ -1925,30 +2271,35 @@ PyObject * SharedVariables::setVar(const string & name, const bool val)
 
 PyObject * SharedVariables::setVar(const string & name, const long val)
 {
+	GILGuard gil;
 	return setVar(name, PyInt_FromLong(val));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const size_t val)
 {
+	GILGuard gil;
 	return setVar(name, PyInt_FromSize_t(val));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const double val)
 {
+	GILGuard gil;
 	return setVar(name, PyFloat_FromDouble(val));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const string & val)
 {
+	GILGuard gil;
 	return setVar(name, Py_BuildValue("s", val.c_str()));
 }
 
 
 PyObject * SharedVariables::setVar(const string & name, const vectori & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyList_New(0);
 	PyObject * item;
 
@@ -1964,6 +2315,7 @@ PyObject * SharedVariables::setVar(const string & name, const vectori & val)
 
 PyObject * SharedVariables::setVar(const string & name, const vectoru & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyList_New(0);
 	PyObject * item;
 
@@ -1980,6 +2332,7 @@ PyObject * SharedVariables::setVar(const string & name, const vectoru & val)
 //CPPONLY
 PyObject * SharedVariables::setVar(const string & name, const vectorf & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyList_New(0);
 	PyObject * item;
 
@@ -1993,8 +2346,37 @@ PyObject * SharedVariables::setVar(const string & name, const vectorf & val)
 }
 
 
+PyObject * SharedVariables::setVarArray(const string & name, const vectorf & val)
+{
+	GILGuard gil;
+	// an array.array('d') supports the buffer protocol and is built from
+	// the raw bytes of val in a single call, so no intermediate Python
+	// float objects are created
+	PyObject * mod = PyImport_ImportModule("array");
+
+	if (mod == NULL)
+		throw SystemError("Failed to import the array module");
+	const char * buf = val.empty() ? "" : reinterpret_cast<const char *>(&val[0]);
+#if PY_VERSION_HEX >= 0x03000000
+	PyObject * obj = PyObject_CallMethod(mod, "array", "sy#", "d",
+		buf, static_cast<Py_ssize_t>(val.size() * sizeof(double)));
+#else
+	PyObject * obj = PyObject_CallMethod(mod, "array", "ss#", "d",
+		buf, static_cast<Py_ssize_t>(val.size() * sizeof(double)));
+#endif
+	Py_DECREF(mod);
+	if (obj == NULL) {
+		PyErr_Print();
+		PyErr_Clear();
+		throw SystemError("Failed to create a typed array for variable " + name);
+	}
+	return setVar(name, obj);
+}
+
+
 PyObject * SharedVariables::setVar(const string & name, const strDict & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyDict_New();
 	PyObject * v;
 
@@ -2013,6 +2395,7 @@ PyObject * SharedVariables::setVar(const string & name, const strDict & val)
 
 PyObject * SharedVariables::setVar(const string & name, const intDict & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyDefDict_New();
 	PyObject * u, * v;
 
@@ -2030,6 +2413,7 @@ PyObject * SharedVariables::setVar(const string & name, const intDict & val)
 
 void SharedVariables::getVarAsIntDict(const string & name, uintDict & res, bool nameError) const
 {
+	GILGuard gil;
 	res.clear();
 	PyObject * obj = getVar(name, nameError);
 
@@ -2046,6 +2430,7 @@ void SharedVariables::getVarAsIntDict(const string & name, uintDict & res, bool
 
 void SharedVariables::getVectorVarAsIntDict(const string & name, uintDict & res, bool nameError) const
 {
+	GILGuard gil;
 	res.clear();
 	PyObject * obj = getVar(name, nameError);
 
@@ -2061,6 +2446,7 @@ void SharedVariables::getVectorVarAsIntDict(const string & name, uintDict & res,
 
 PyObject * SharedVariables::setVar(const string & name, const uintDict & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyDefDict_New();
 	PyObject * u, * v;
 
@@ -2077,6 +2463,7 @@ PyObject * SharedVariables::setVar(const string & name, const uintDict & val)
 
 PyObject * SharedVariables::setVar(const string & name, const tupleDict & val)
 {
+	GILGuard gil;
 	PyObject * obj = PyDefDict_New();
 	PyObject * u, * v;
 
@@ -2402,6 +2789,7 @@ PyObject * loadObj(const string & vars, size_t & offset)
 
 string SharedVariables::to_pickle() const
 {
+	GILGuard gil;
 #if PY_VERSION_HEX >= 0x03000000
 	PyObject * pickle = PyImport_ImportModule("pickle");
 #else
@@ -2477,6 +2865,7 @@ string SharedVariables::asString() const
 
 void SharedVariables::fromString(const string & vars)
 {
+	GILGuard gil;
 	size_t offset = 0;
 	PyObject * obj = loadObj(vars, offset);
 
@@ -2494,6 +2883,7 @@ void SharedVariables::fromString(const string & vars)
 
 void SharedVariables::from_pickle(const string & vars)
 {
+	GILGuard gil;
 #if PY_VERSION_HEX >= 0x03000000
 	PyObject * pickle = PyImport_ImportModule("pickle");
 #else
@@ -2598,7 +2988,9 @@ string shorten(const string & val, size_t length)
 
 Expression::Expression(const Expression & rhs)
 	: m_exprString(rhs.m_exprString), m_stmtsString(rhs.m_stmtsString),
-	m_expr(rhs.m_expr), m_stmts(rhs.m_stmts), m_locals(rhs.m_locals)
+	m_expr(rhs.m_expr), m_stmts(rhs.m_stmts), m_condOp(rhs.m_condOp),
+	m_condVar(rhs.m_condVar), m_condMod(rhs.m_condMod),
+	m_condValue(rhs.m_condValue), m_locals(rhs.m_locals)
 {
 	Py_XINCREF(m_expr);
 	Py_XINCREF(m_stmts);
@@ -2615,6 +3007,7 @@ Expression::~Expression()
 
 void Expression::compileExpr(const string & expr)
 {
+	GILGuard gil;
 	if (m_expr != NULL) {
 		// discard previous
 		Py_XDECREF(m_expr);
@@ -2622,6 +3015,7 @@ void Expression::compileExpr(const string & expr)
 	}
 
 	m_exprString = expr;
+	compileCond(expr);
 
 	if (expr.empty())
 		return;
@@ -2634,6 +3028,102 @@ void Expression::compileExpr(const string & expr)
 }
 
 
+void Expression::compileCond(const string & expr)
+{
+	m_condOp = NoCondition;
+
+	if (expr.empty())
+		return;
+
+	// var op number, or var % k op number, e.g. 'alleleFreq[0][1] < 0.05'
+	// with the subscripts flattened away is not supported, but 'gen > 100'
+	// or 'gen % 10 == 0' or 'numOfMales >= 500' are.
+	const regex cond("\\s*([\\w]+)\\s*(?:%\\s*([\\d]+)\\s*)?(==|!=|<=|>=|<|>)\\s*([-]*[\\d\\.]+)\\s*");
+
+	cmatch matches;
+
+	if (!regex_match(expr.c_str(), matches, cond))
+		return;
+
+	long mod = 0;
+	double value = 0;
+	try {
+		if (matches[2].matched)
+			mod = boost::lexical_cast<long>(string(matches[2].first, matches[2].second));
+		value = boost::lexical_cast<double>(string(matches[4].first, matches[4].second));
+	} catch (...) {
+		return;
+	}
+	if (matches[2].matched && mod <= 0)
+		return;
+
+	string op = string(matches[3].first, matches[3].second);
+	if (op == "<")
+		m_condOp = CondLT;
+	else if (op == "<=")
+		m_condOp = CondLE;
+	else if (op == ">")
+		m_condOp = CondGT;
+	else if (op == ">=")
+		m_condOp = CondGE;
+	else if (op == "==")
+		m_condOp = CondEQ;
+	else
+		m_condOp = CondNE;
+	m_condVar = string(matches[1].first, matches[1].second);
+	m_condMod = mod;
+	m_condValue = value;
+	DBG_DO(DBG_DEVEL, cerr << "Decipher gating predicate on variable " << m_condVar
+		                   << " with operation " << m_condOp << " and value " << m_condValue << endl);
+}
+
+
+bool Expression::evaluateCond(bool & value) const
+{
+	// a borrowed reference
+	PyObject * obj = PyDict_GetItemString(m_locals, m_condVar.c_str());
+
+	if (obj == NULL)
+		return false;
+	double lhs = 0;
+	if (m_condMod != 0) {
+		// a modulus only makes sense for an integer variable
+		if (!PyInt_Check(obj))
+			return false;
+		lhs = static_cast<double>(PyInt_AsLong(obj) % m_condMod);
+	} else if (PyFloat_Check(obj))
+		lhs = PyFloat_AS_DOUBLE(obj);
+	else if (PyInt_Check(obj))
+		lhs = static_cast<double>(PyInt_AsLong(obj));
+	else
+		// leave non-scalar variables to the compiled byte code
+		return false;
+	switch (m_condOp) {
+	case CondLT:
+		value = lhs < m_condValue;
+		break;
+	case CondLE:
+		value = lhs <= m_condValue;
+		break;
+	case CondGT:
+		value = lhs > m_condValue;
+		break;
+	case CondGE:
+		value = lhs >= m_condValue;
+		break;
+	case CondEQ:
+		value = lhs == m_condValue;
+		break;
+	case CondNE:
+		value = lhs != m_condValue;
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+
 void Expression::compileStmts(const string & stmts)
 {
 	if (m_stmts != NULL) {
@@ -2659,6 +3149,7 @@ void Expression::compileStmts(const string & stmts)
 // python expression
 PyObject * Expression::evaluate() const
 {
+	GILGuard gil;
 	if (m_expr == NULL && m_stmts == NULL)
 		return NULL;
 
@@ -2709,6 +3200,15 @@ PyObject * Expression::evaluate() const
 
 bool Expression::valueAsBool() const
 {
+	GILGuard gil;
+	// gating predicates deciphered at construction time are evaluated
+	// with a single dictionary lookup, without entering the interpreter.
+	if (m_condOp != NoCondition && m_stmts == NULL) {
+		bool val;
+		if (evaluateCond(val))
+			return val;
+	}
+
 	PyObject * res = evaluate();
 
 	if (res == NULL)
@@ -2722,6 +3222,7 @@ bool Expression::valueAsBool() const
 
 long Expression::valueAsInt() const
 {
+	GILGuard gil;
 	PyObject * res = evaluate();
 
 	if (res == NULL)
@@ -2735,6 +3236,7 @@ long Expression::valueAsInt() const
 
 double Expression::valueAsDouble() const
 {
+	GILGuard gil;
 	PyObject * res = evaluate();
 
 	if (res == NULL)
@@ -2748,6 +3250,7 @@ double Expression::valueAsDouble() const
 
 string Expression::valueAsString() const
 {
+	GILGuard gil;
 	PyObject * res = evaluate();
 
 	if (res == NULL)
@@ -2761,6 +3264,7 @@ string Expression::valueAsString() const
 
 vectorf Expression::valueAsArray() const
 {
+	GILGuard gil;
 	PyObject * res = evaluate();
 
 	if (res == NULL)
@@ -2850,19 +3354,34 @@ StreamElem::StreamElem(const string & name, bool readable, bool realAppend, bool
 	} else {                                                                          // no string, usual file
 		m_append = realAppend;
 		m_type = FSTREAM;
+		// Reporting operators write many small pieces so a large private
+		// buffer coalesces them into a few big system writes. The buffer
+		// has to be installed before the file is opened to take effect,
+		// which is why streams are default-constructed and opened later.
+		m_buffer.resize(0x100000);
 		if (readable) {
+			fstream * stream = new fstream();
+			stream->rdbuf()->pubsetbuf(&m_buffer[0], m_buffer.size());
 			if (realAppend)     // readable , append
-				m_stream = new fstream(name.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
+				stream->open(name.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
 			else                // readable, ! append
 				// existing file will be truncated...
-				m_stream = new fstream(name.c_str(),  std::ios::in | std::ios::trunc | std::ios::out);
+				stream->open(name.c_str(),  std::ios::in | std::ios::trunc | std::ios::out);
+			m_stream = stream;
 		} else {
 			if (realAppend) {     // ! readable, append
-				m_stream = new ofstream(name.c_str(), std::ios::out | std::ios::app);
+				ofstream * stream = new ofstream();
+				stream->rdbuf()->pubsetbuf(&m_buffer[0], m_buffer.size());
+				stream->open(name.c_str(), std::ios::out | std::ios::app);
+				m_stream = stream;
 				m_type = OFSTREAM;
-			} else                //  !readable, !append )
+			} else {              //  !readable, !append )
+				fstream * stream = new fstream();
+				stream->rdbuf()->pubsetbuf(&m_buffer[0], m_buffer.size());
 				// existing file will be truncated...
-				m_stream = new fstream(name.c_str(),  std::ios::trunc | std::ios::out);
+				stream->open(name.c_str(),  std::ios::trunc | std::ios::out);
+				m_stream = stream;
+			}
 		}
 	}
 
@@ -2883,6 +3402,9 @@ StreamElem::StreamElem(const StreamElem & rhs)
 	m_append = rhs.m_append;
 	m_stream = rhs.m_stream;
 	const_cast<StreamElem &>(rhs).m_stream = NULL;
+	// the stream buffer points into m_buffer so ownership has to move
+	// along with the stream itself (swap keeps the allocation in place).
+	m_buffer.swap(const_cast<StreamElem &>(rhs).m_buffer);
 }
 
 
@@ -2918,7 +3440,10 @@ void StreamElem::makeReadable()
 	delete m_stream;
 
 	// try to keep file content
-	m_stream = new fstream(m_filename.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
+	fstream * stream = new fstream();
+	stream->rdbuf()->pubsetbuf(&m_buffer[0], m_buffer.size());
+	stream->open(m_filename.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
+	m_stream = stream;
 
 	if (m_stream == NULL || !*m_stream)
 		throw ValueError("Can not re-open specified file.");
@@ -3055,6 +3580,14 @@ void OstreamManager::closeOstream(const string & filename)
 }
 
 
+// flush all files, called at generation boundaries
+void OstreamManager::flushAll()
+{
+	for (ostreamMapIterator it = m_ostreams.begin(), itEnd = m_ostreams.end(); it != itEnd; ++it)
+		it->second.stream()->flush();
+}
+
+
 // close all files and clean the map
 void OstreamManager::closeAll()
 {
@@ -3434,6 +3967,22 @@ void RNG::set(const char * rng, unsigned long seed)
 	gsl_rng_set(m_RNG, m_seed);
 	m_bitByte = 0;
 	m_bitIndex = 0;
+	m_draws = 0;
+}
+
+
+unsigned long RNG::stateDigest() const
+{
+	const unsigned char * state = reinterpret_cast<const unsigned char *>(gsl_rng_state(m_RNG));
+	size_t n = gsl_rng_size(m_RNG);
+	// 32-bit FNV-1a, which fits unsigned long on all supported platforms
+	unsigned long h = 2166136261UL;
+
+	for (size_t i = 0; i < n; ++i) {
+		h ^= state[i];
+		h = (h * 16777619UL) & 0xFFFFFFFFUL;
+	}
+	return h;
 }
 
 
@@ -3488,6 +4037,7 @@ ULONG RNG::randTruncatedPoisson(double lambda)
 
 	// we have to use a special method that maps back from cdf.
 	double p0 = gsl_ran_poisson_pdf(0, lambda);
+	++m_draws;
 	double p = gsl_rng_uniform(m_RNG) * (1 - p0) + p0;
 	if (p + 1.01 * GSL_DBL_EPSILON >= 1.)
 		return MaxRandomNumber;
@@ -3568,6 +4118,7 @@ ULONG RNG::randTruncatedBinomial(UINT n, double pr)
 		return n;  // covers the full range of the distribution
 
 	double p0 = gsl_ran_binomial_pdf(0, pr, n);
+	++m_draws;
 	double p = gsl_rng_uniform(m_RNG) * (1 - p0) + p0;
 	if (p + 1.01 * GSL_DBL_EPSILON >= 1.)
 		return n;
@@ -3878,12 +4429,63 @@ size_t WeightedSampler::draw()
 }
 
 
+size_t WeightedSampler::draw(double u)
+{
+	switch (m_algorithm) {
+	case 1:
+		// only return one
+		return m_param;
+	case 2:
+		// all weights are the same
+		return static_cast<size_t>(u * m_param);
+	case 3: {
+		double rN = u * m_N;
+
+		size_t K = static_cast<size_t>(rN);
+
+		rN -= K;
+
+		if (rN < m_q[K])
+			return K;
+		else
+			return m_a[K];
+	}
+	default:
+		// exact proportions keep their own sequence and invalid samplers
+		// should raise the same error as the regular draw().
+		return draw();
+	}
+	// should never be reached
+	return 0;
+}
+
+
+void WeightedSampler::drawSamples(ULONG num, vectoru & res)
+{
+	res.resize(num);
+	// only samplers that consume one uniform deviate per draw (equal
+	// weights and the alias table) benefit from batched deviates. The
+	// exact-proportion sampler walks its own shuffled sequence.
+	if (m_algorithm != 2 && m_algorithm != 3) {
+		for (size_t i = 0; i < num; ++i)
+			res[i] = draw();
+		return;
+	}
+	double buf[256];
+	for (size_t i = 0; i < num; i += 256) {
+		size_t batch = std::min<size_t>(num - i, 256);
+		getRNG().fillUniform(buf, batch);
+		for (size_t j = 0; j < batch; ++j)
+			res[i + j] = draw(buf[j]);
+	}
+}
+
+
 vectoru WeightedSampler::drawSamples(ULONG num)
 {
-	vectoru res(num);
+	vectoru res;
 
-	for (size_t i = 0; i < num; ++i)
-		res[i] = draw();
+	drawSamples(num, res);
 	return res;
 }
 
@@ -3891,6 +4493,42 @@ vectoru WeightedSampler::drawSamples(ULONG num)
 // this is used for Bernullitrials and copyGenotype
 WORDTYPE g_bitMask[WORDBIT];
 
+
+void RNG::fillBits(WORDTYPE * buf, size_t n)
+{
+	WORDTYPE tmp;
+	size_t blk = n / WORDBIT;
+	size_t rest = n - blk * WORDBIT;
+
+	for (size_t i = 0; i < blk; ++i) {
+		// even if the block size is large (I can not set it to int16_t)
+		// I only take the last 16 bit of a rng
+		// for the quality of random bits.
+		*buf = 0;
+		for (size_t b = 0; b < WORDBIT / 16; ++b) {
+			tmp = randInt(0xFFFF);
+			*buf |= (0xFFFF & tmp) << (b * 16);
+		}
+		buf++;
+	}
+	// last block
+	if (rest != 0) {
+		*buf = 0;
+		size_t b = 0;
+		for (b = 0; b < rest / 16; ++b) {
+			tmp = randInt(0xFFFF);
+			*buf |= (0xFFFF & tmp) << (b * 16);
+		}
+		// last bits
+		rest -= b * 16;
+		if (rest != 0) {
+			tmp = randInt(0xFFFF);
+			*buf |= (g_bitMask[rest] & tmp) << b * 16;
+		}
+	}
+}
+
+
 Bernullitrials::Bernullitrials(RNG & /* rng */)
 	: m_N(0), m_prob(0), m_table(0), m_pointer(0),
 	m_cur(npos)
@@ -4008,41 +4646,9 @@ void Bernullitrials::doTrial()
 		if (prob == 0.) {
 			setAll(cl, false);
 		} else if (prob == 0.5) {                                 // random 0,1 bit, this will be quicker
-			// set to 0..
-			setAll(cl, false);
-			// treat a randInt as random bits and set them directly.
+			// treat random words as random bits and set them directly.
 			// I.e., we will call 1/16 or 1/32 times of rng for this specifal case.
-			// first several blocks
-			// WORDTYPE * ptr = BITPTR(succ.begin());
-			WORDTYPE tmp;
-			size_t blk = m_N / WORDBIT;
-			size_t rest = m_N - blk * WORDBIT;
-			for (size_t i = 0; i < blk; ++i) {
-				// even if the block size is large (I can not set it to int16_t)
-				// I only take the last 16 bit of a rng
-				// for the quality of random bits.
-				*ptr = 0;
-				for (size_t b = 0; b < WORDBIT / 16; ++b) {
-					// blocks[i] = static_cast<int16_t>(getRNG().randGet());
-					tmp = getRNG().randInt(0xFFFF);
-					*ptr |= (0xFFFF & tmp) << (b * 16);
-				}
-				ptr++;
-			}
-			// last block
-			if (rest != 0) {
-				size_t b = 0;
-				for (b = 0; b < rest / 16; ++b) {
-					tmp = getRNG().randInt(0xFFFF);
-					*ptr |= (0xFFFF & tmp) << (b * 16);
-				}
-				// last bits
-				rest -= b * 16;
-				if (rest != 0) {
-					tmp = getRNG().randInt(0xFFFF);
-					*ptr |= (g_bitMask[rest] & tmp) << b * 16;
-				}
-			}
+			getRNG().fillBits(ptr, m_N);
 		}
 		// algorithm i Sheldon Ross' book simulation (4ed), page 54
 		else if (prob < 0.5) {
@@ -4267,13 +4873,19 @@ void Bernullitrials_T::setAll(size_t idx, bool v)
 
 void Bernullitrials_T::doTrial()
 {
-	// reset all values to 0
+	// the table is regenerated every m_N trials, so each row is allocated
+	// only when its geometry changes and is otherwise wiped word by word.
+	// This keeps the storage (and the cached word pointers) stable across
+	// batches instead of rebuilding m_N bit vectors per batch.
+	size_t nWords = m_prob.size() / WORDBIT + (m_prob.size() % WORDBIT != 0 ? 1 : 0);
 	BitSet::iterator beg_it;
 	for (size_t i = 0; i < m_N; ++i) {
-		m_table[i].clear();
-		m_table[i].resize(m_prob.size(), 0);
-		beg_it = m_table[i].begin();
-		m_pointer[i] = const_cast<WORDTYPE *>(BITPTR(beg_it));
+		if (m_table[i].size() != m_prob.size()) {
+			m_table[i].assign(m_prob.size(), false);
+			beg_it = m_table[i].begin();
+			m_pointer[i] = const_cast<WORDTYPE *>(BITPTR(beg_it));
+		} else
+			std::fill(m_pointer[i], m_pointer[i] + nWords, WORDTYPE(0));
 	}
 	// for each column
 	for (size_t cl = 0, clEnd = m_prob.size(); cl < clEnd; ++cl) {
@@ -4299,12 +4911,32 @@ void Bernullitrials_T::doTrial()
 				else
 					break;
 			}
+		} else if (prob == 0.5) {
+			// a random bit per trial (e.g. free recombination between
+			// chromosomes). Draw whole words of random bits at a time and
+			// scatter them to column cl of each row, using 1/WORDBIT of
+			// the random numbers a per-trial comparison would need.
+			WORDTYPE buf[4];
+			for (size_t i = 0; i < m_N; ) {
+				size_t batch = std::min<size_t>(m_N - i, 4 * WORDBIT);
+				getRNG().fillBits(buf, batch);
+				for (size_t j = 0; j < batch; ++j, ++i)
+					if (getBit(buf, j))
+						setBit(m_pointer[i], cl);
+			}
 		} else if (prob == 1.) {
 			setAll(cl, true);
 		} else {                                                                  // 1 > m_proc[cl] > 0.5
-			for (size_t i = 0; i < m_N; ++i)
-				if (getRNG().randUniform() < prob)
-					setBit(m_pointer[i], cl);
+			// draw the uniform deviates in batches to avoid the per-trial
+			// dispatch overhead of randUniform().
+			double buf[256];
+			for (size_t i = 0; i < m_N; ) {
+				size_t batch = std::min<size_t>(m_N - i, 256);
+				getRNG().fillUniform(buf, batch);
+				for (size_t j = 0; j < batch; ++j, ++i)
+					if (buf[j] < prob)
+						setBit(m_pointer[i], cl);
+			}
 		}
 	}
 	m_cur = 0;
@@ -4592,6 +5224,15 @@ PyObject * moduleInfo()
 #endif
 	Py_DECREF(val);
 
+	// ploidy baked in at compile time by a fixed-geometry build, 0 for
+	// regular builds that read it from the genotypic structure
+#ifdef FIXED_PLOIDY
+	PyDict_SetItem(dict, PyString_FromString("fixedPloidy"), val = PyInt_FromLong(FIXED_PLOIDY));
+#else
+	PyDict_SetItem(dict, PyString_FromString("fixedPloidy"), val = PyInt_FromLong(0));
+#endif
+	Py_DECREF(val);
+
 #ifndef COMPILER
 #  ifdef __GNUC__
 #    define COMPILER "[GCC " __VERSION__ "]"
@@ -4921,6 +5562,66 @@ void clearGenotype(GenoIterator to, size_t n)
 }
 
 
+void fillGenotype(GenoIterator to, size_t n)
+{
+	WORDTYPE * to_p = const_cast<WORDTYPE *>(BITPTR(to));
+	size_t to_off = BITOFF(to);
+
+	for (size_t i = 0; i < n; ++i) {
+		*to_p |= 1UL << to_off;
+		if (to_off++ == WORDBIT - 1) {
+			// whole words in the middle of the range are set in one go
+			while (i + WORDBIT < n) {
+				*++to_p = ~WORDTYPE(0);
+				i += WORDBIT;
+			}
+			++to_p;
+			to_off = 0;
+		}
+	}
+}
+
+
+// word-level population count, with a portable fallback for compilers
+// without the builtin
+inline size_t popWordCount(WORDTYPE w)
+{
+#  if defined(__GNUC__) || defined(__clang__)
+	return static_cast<size_t>(__builtin_popcountl(w));
+#  else
+	size_t c = 0;
+	for (; w != 0; w &= w - 1)
+		++c;
+	return c;
+#  endif
+}
+
+
+size_t countGenotype(GenoIterator it, size_t n)
+{
+	const WORDTYPE * ptr = BITPTR(it);
+	size_t off = BITOFF(it);
+	size_t cnt = 0;
+
+	if (n == 0)
+		return 0;
+	// leading bits up to the first word boundary
+	if (off != 0) {
+		size_t m = n < WORDBIT - off ? n : WORDBIT - off;
+		cnt += popWordCount((*ptr >> off) & g_bitMask[m]);
+		n -= m;
+		++ptr;
+	}
+	// whole words
+	for (; n >= WORDBIT; n -= WORDBIT)
+		cnt += popWordCount(*ptr++);
+	// trailing bits
+	if (n > 0)
+		cnt += popWordCount(*ptr & g_bitMask[n]);
+	return cnt;
+}
+
+
 #endif
 
 #ifdef MUTANTALLELE
@@ -74,6 +74,9 @@ using std::setw;
 
 #include <set>
 
+#include <deque>
+using std::deque;
+
 /// for ranr generator
 #include "gsl/gsl_sys.h"                                           // for floating point comparison
 #include "gsl/gsl_rng.h"
@@ -121,6 +124,8 @@ void turnOnDebug(const string & code = string());
  */
 void turnOffDebug(const string & code = "DBG_ALL");
 
+class SharedVariables;
+
 #ifndef OPTIMIZED
 /// CPPONLY test if one code is turned on, CPPONLY
 bool debug(DBG_CODE code);
@@ -133,9 +138,20 @@ void initClock();
 
 void elapsedTime(const string & name);
 
+/// CPPONLY mark the start of a per-operator timing interval
+void profileStart();
+
+/// CPPONLY when debug code \c DBG_PROFILE is turned on, record the time in
+/// seconds since the last call to \c profileStart() to dictionary variable
+/// \c opTime of \e vars, keyed by \e name. The dictionary is refreshed at
+/// every generation and can be retrieved like any other shared variable.
+void profileOpTime(SharedVariables & vars, const string & name);
+
 #else
 #  define initClock();
 #  define elapsedTime(name);
+#  define profileStart();
+#  define profileOpTime(vars, name);
 #endif
 
 #ifdef Py_REF_DEBUG
@@ -164,9 +180,59 @@ void setOptions(const int numThreads = -1, const char * name = NULL, unsigned lo
 /// CPPONLY get number of thread in openMP
 UINT numThreads();
 
+/** CPPONLY return the chunk size used by dynamically scheduled openMP loops
+ *  with \e iters iterations. The default chunk size of one pays a scheduling
+ *  round-trip per iteration, which dominates when iterations (e.g. loci) are
+ *  many and cheap, so the chunk is enlarged with the trip count while leaving
+ *  several chunks per thread to absorb uneven iteration costs. The chosen
+ *  size is reported when debug code \c DBG_PROFILE is turned on.
+ */
+UINT ompChunkSize(size_t iters);
+
+/** Start writing a manifest of random number consumption to file \e output,
+ *  or, if \e verify is \c True, verify subsequent evolutionary processes
+ *  against a manifest recorded earlier to \e output. A manifest consists of
+ *  a header identifying the random number generator, its base seed and the
+ *  number of streams (one per thread), followed by one line per replicate
+ *  per phase (pre-mating, mating, post-mating) per generation, carrying the
+ *  generation and replicate numbers, the phase name, the number of variates
+ *  each stream has drawn so far (c.f. <tt>RNG.draws()</tt>), and a rolling
+ *  digest of the internal states of all streams. Two runs that produce the
+ *  same manifest consumed random numbers identically, so the
+ *  reproducibility of a long run can be audited from its logs in seconds
+ *  instead of re-running it and comparing populations. In verify mode a
+ *  \c RuntimeError is raised at the first checkpoint that diverges from the
+ *  recorded manifest, naming the offending line. An empty \e output
+ *  (default) stops recording or verification.
+ */
+void setRNGManifest(const string & output = string(), bool verify = false);
+
+/** CPPONLY record or verify one manifest checkpoint for phase \e phase of
+ *  generation \e gen of replicate \e rep. No-op when no manifest is active.
+ */
+void rngManifestCheckpoint(ssize_t gen, size_t rep, const char * phase);
+
+/** CPPONLY capture the states of all random number streams. Generator
+ *  states are stored in \e states and draw counters in \e draws, and have
+ *  to be released by \c freeRNGStates().
+ */
+void snapshotRNGStates(vector<gsl_rng *> & states, vectoru & draws);
+
+/** CPPONLY rewind all random number streams to states captured by
+ *  \c snapshotRNGStates(). A \c RuntimeError is raised if the number of
+ *  streams has changed since the capture.
+ */
+void restoreRNGStates(const vector<gsl_rng *> & states, const vectoru & draws);
+
+/// CPPONLY release generator states captured by snapshotRNGStates
+void freeRNGStates(vector<gsl_rng *> & states);
+
 /// CPPONLY return val and increase val by 1, ensuring thread safety
 ATOMICLONG fetchAndIncrement(ATOMICLONG * val);
 
+/// CPPONLY return val and increase val by inc, ensuring thread safety
+ATOMICLONG fetchAndAdd(ATOMICLONG * val, ATOMICLONG inc);
+
 /// CPPONLY parallel sort by using tbb or gnu parallel
 template<class T1, class T2>
 void parallelSort(T1 start, T1 end, T2 cmp)
@@ -261,6 +327,87 @@ unsigned pow3(unsigned n);
 
 namespace simuPOP {
 
+// ////////////////////////////////////////////////////////////
+// / GIL handling
+// ////////////////////////////////////////////////////////////
+
+// the wrapper generator does not need (and may not be able to parse)
+// these guards
+#ifndef SWIG
+
+/** A RAII guard that releases the Python global interpreter lock for the
+ *  duration of a long-running C++ phase (mating, statistics calculation,
+ *  saving a population), so that Python threads of the same process, for
+ *  example monitor threads or threads driving other simulators, can run
+ *  concurrently with it. Only the outermost guard of a thread actually
+ *  releases the lock, so released phases may nest (an operator can save
+ *  a population during evolution). The protocol is: any code that may
+ *  call back into Python while such a phase is running must hold a
+ *  GILGuard for the duration of the callback.
+ *  CPPONLY
+ */
+class GILRelease
+{
+public:
+	GILRelease() : m_state(NULL)
+	{
+		if (++s_depth == 1 && Py_IsInitialized())
+			m_state = PyEval_SaveThread();
+	}
+
+
+	~GILRelease()
+	{
+		if (m_state != NULL)
+			PyEval_RestoreThread(m_state);
+		--s_depth;
+	}
+
+
+private:
+	GILRelease(const GILRelease &);
+	GILRelease & operator=(const GILRelease &);
+
+	PyThreadState * m_state;
+
+	// per-thread nesting depth of released phases
+	static thread_local int s_depth;
+};
+
+
+/** A RAII guard that makes sure the calling thread holds the Python
+ *  global interpreter lock. It is held by the Python entry points of the
+ *  C++ core (function callbacks, expression evaluation and population
+ *  variable access), which keeps them safe when they are reached from a
+ *  phase that runs under a GILRelease guard. Acquiring the lock when it
+ *  is already held is cheap, so these entry points do not need to know
+ *  whether such a phase is active.
+ *  CPPONLY
+ */
+class GILGuard
+{
+public:
+	GILGuard() : m_state(PyGILState_Ensure())
+	{
+	}
+
+
+	~GILGuard()
+	{
+		PyGILState_Release(m_state);
+	}
+
+
+private:
+	GILGuard(const GILGuard &);
+	GILGuard & operator=(const GILGuard &);
+
+	PyGILState_STATE m_state;
+};
+
+#endif  // SWIG
+
+
 // ////////////////////////////////////////////////////////////
 // / Parameter polymorphism
 // ////////////////////////////////////////////////////////////
@@ -371,6 +518,7 @@ public:
 	template <typename T>
 	T operator()(void converter(PyObject *, T &), const char * format, ...) const
 	{
+		GILGuard gil;
 		va_list argptr;
 
 		va_start(argptr, format);
@@ -394,6 +542,7 @@ public:
 	template <typename T>
 	T operator()(void converter(PyObject *, T &), PyObject * arglist) const
 	{
+		GILGuard gil;
 		PyObject * pyResult = PyObject_CallObject(m_func.object(), arglist);
 
 		if (pyResult == NULL) {
@@ -410,6 +559,7 @@ public:
 
 	PyObject * operator()(const char * format, ...) const
 	{
+		GILGuard gil;
 		va_list argptr;
 
 		va_start(argptr, format);
@@ -429,6 +579,7 @@ public:
 
 	PyObject * operator()(PyObject * args) const
 	{
+		GILGuard gil;
 		PyObject * pyResult = PyObject_CallObject(m_func.object(), args);
 
 		if (pyResult == NULL) {
@@ -1123,14 +1274,16 @@ class SharedVariables
 {
 public:
 	/// CPPONLY
-	SharedVariables() : m_dict(NULL), m_ownVars(false)
+	SharedVariables() : m_dict(NULL), m_ownVars(false),
+		m_firstKey(NULL), m_groupKey(NULL)
 	{
 	}
 
 
 	/// CPPONLY
 	SharedVariables(PyObject * dict, bool ownVars)
-		: m_dict(dict), m_ownVars(ownVars)
+		: m_dict(dict), m_ownVars(ownVars),
+		m_firstKey(NULL), m_groupKey(NULL)
 	{
 		// if not given a pre-existing dictionary, create one
 		if (m_dict == NULL)
@@ -1151,6 +1304,11 @@ public:
 	{
 		std::swap(m_dict, rhs.m_dict);
 		std::swap(m_ownVars, rhs.m_ownVars);
+		std::swap(m_firstName, rhs.m_firstName);
+		std::swap(m_firstKey, rhs.m_firstKey);
+		std::swap(m_groupText, rhs.m_groupText);
+		std::swap(m_groupKey, rhs.m_groupKey);
+		m_retention.swap(rhs.m_retention);
 	}
 
 
@@ -1214,6 +1372,10 @@ public:
 	///CPPONLY
 	PyObject * setVar(const string & name, const vectorf & val);
 
+	///CPPONLY set a variable to a typed array ('d') built from the raw
+	/// bytes of val in a single call, instead of one Python float per value
+	PyObject * setVarArray(const string & name, const vectorf & val);
+
 	///CPPONLY
 	PyObject * setVar(const string & name, const strDict & val);
 
@@ -1281,6 +1443,10 @@ public:
 	}
 
 
+	/// CPPONLY keep only the most recent \c keep top-level variables whose
+	/// names start with \c prefix, appending evicted ones to \c spillFile
+	void setVarRetention(const string & prefix, size_t keep, const string & spillFile = string());
+
 	/// CPPONLY, save m_dist as string
 	string asString() const;
 
@@ -1294,12 +1460,57 @@ public:
 	void from_pickle(const string & vars);
 
 private:
+	/// Retention policy for per-generation variables. Reporters that set
+	/// one top-level variable per generation (e.g. alleleFreq_1000) grow
+	/// the dictionary without bound during a long unattended run. A
+	/// policy keeps the most recent variables that share a prefix and
+	/// evicts older ones, optionally spilling them to an append-only
+	/// file so that the full history remains available on disk.
+	struct VarRetention
+	{
+		VarRetention(const string & prefix, size_t keep, const string & spillFile)
+			: m_prefix(prefix), m_keep(keep), m_spillFile(spillFile), m_names()
+		{
+		}
+
+
+		string m_prefix;
+		size_t m_keep;
+		string m_spillFile;
+		/// retained variable names, oldest first
+		deque<string> m_names;
+	};
+
+	/// record a newly set top-level variable against the retention
+	/// policies and evict the oldest variables beyond a policy's capacity
+	void applyRetention(const string & name);
+
+	/// spill a variable to the policy's file and remove it from the
+	/// dictionary
+	void evictVar(const VarRetention & policy, const string & name);
+
 	/// the list
 	PyObject * m_dict;
 
 	/// whether or not the object owns the dictionary
 	bool m_ownVars;
 
+	/// Cached key objects for the leading pieces of variable names. Stats
+	/// applied with vars(subPop=True) set one variable per (virtual)
+	/// subpopulation and the names all start with the same identifier
+	/// (e.g. subPop) followed by a subpopulation key that repeats across
+	/// consecutive writes. Caching the key objects avoids creating and
+	/// hashing them again for every write. Only immutable key objects are
+	/// cached, never positions in the dictionary tree, so the cache
+	/// cannot become stale when the dictionary is changed from Python.
+	mutable string m_firstName;
+	mutable PyObject * m_firstKey;
+	mutable string m_groupText;
+	mutable PyObject * m_groupKey;
+
+	/// retention policies for per-generation variables
+	vector<VarRetention> m_retention;
+
 };
 
 /** CPPONLY
@@ -1346,7 +1557,8 @@ class Expression
 public:
 	Expression(const string & expr = string(), const string & stmts = string(),
 		PyObject * locals = NULL)
-		: m_expr(NULL), m_stmts(NULL), m_locals(locals)
+		: m_expr(NULL), m_stmts(NULL), m_condOp(NoCondition), m_condMod(0),
+		m_condValue(0), m_locals(locals)
 	{
 		if (m_locals == NULL)
 			m_locals = mainVars().dict();
@@ -1398,6 +1610,8 @@ public:
 	 */
 	void setLocalDict(PyObject * dict) const
 	{
+		GILGuard gil;
+
 		m_locals = dict;
 		if (PyDict_GetItemString(m_locals, "__builtins__") == NULL)
 			if (PyDict_SetItemString(m_locals, "__builtins__", PyEval_GetBuiltins()) != 0)
@@ -1444,6 +1658,18 @@ public:
 	/// CPPONLY  return array value
 	vectorf valueAsArray() const;
 
+private:
+	/// comparison operator of a simple gating predicate (see compileCond)
+	enum CondOperation {
+		NoCondition = 100,
+		CondLT = 101,
+		CondLE = 102,
+		CondGT = 103,
+		CondGE = 104,
+		CondEQ = 105,
+		CondNE = 106,
+	};
+
 private:
 	/// compile expression into byte code
 	void compileExpr(const string & expr);
@@ -1451,12 +1677,29 @@ private:
 	/// compile statements into byte code
 	void compileStmts(const string & stmts);
 
+	/** Decipher simple gating predicates of the form
+	 *  <tt>var [%% k] op number</tt> so that valueAsBool() can evaluate
+	 *  them with a dictionary lookup instead of entering the Python
+	 *  interpreter. Expressions that do not match this form are left to
+	 *  the compiled byte code.
+	 */
+	void compileCond(const string & expr);
+
+	/// evaluate a deciphered predicate, return false if var is not a scalar
+	bool evaluateCond(bool & value) const;
+
 	string m_exprString;
 	string m_stmtsString;
 
 	/// compiled code
 	PyObject * m_expr, * m_stmts;
 
+	/// deciphered form of a simple gating predicate, if any
+	CondOperation m_condOp;
+	string m_condVar;
+	long m_condMod;
+	double m_condValue;
+
 	/// local namespace
 	mutable PyObject * m_locals;
 };
@@ -1582,6 +1825,12 @@ private:
 
 	/// file name.
 	string m_filename;
+
+	/// large private stream buffer for file-backed streams. Reporting
+	/// operators tend to issue many tiny writes so a big buffer cuts
+	/// the number of system calls considerably. It has to outlive
+	/// m_stream and is handed over when ownership of m_stream moves.
+	vector<char> m_buffer;
 };
 
 // ////////////////////////////////////////////////////////////
@@ -1615,6 +1864,13 @@ public:
 	/// CPPONLY
 	void closeOstream(const string & filename);
 
+	/** CPPONLY flush all registered ostreams without closing them.
+	 * Because persistent streams carry large private buffers, this is
+	 * called at generation boundaries so that output reaches disk in a
+	 * few big writes instead of one write per record.
+	 */
+	void flushAll();
+
 	/// CPPONLY close all files and clean the map
 	void closeAll();
 
@@ -1869,6 +2125,44 @@ public:
 	}
 
 
+	/** Return the number of variates drawn from this generator since its
+	 *  seed was last set. Batched draws count one per variate, shuffling a
+	 *  sequence counts one per element, and random bits count one per 16
+	 *  bits. Together with the seed and generator name, matching draw
+	 *  counts across runs (c.f. the manifest written by function
+	 *  \c setRNGManifest()) identify identical random number consumption.
+	 *  <group>2-info</group>
+	 */
+	unsigned long draws() const
+	{
+		return m_draws;
+	}
+
+
+	/** CPPONLY FNV-1a digest of the internal state of the underlying
+	 *  generator, folded into the rolling digest of manifest checkpoints.
+	 */
+	unsigned long stateDigest() const;
+
+	/** CPPONLY Return a copy of the state of the underlying generator,
+	 *  owned by the caller, that can later be passed to \c restoreState().
+	 */
+	gsl_rng * saveState() const
+	{
+		return gsl_rng_clone(m_RNG);
+	}
+
+
+	/** CPPONLY Rewind the generator to a state captured by \c saveState()
+	 *  and reset the draw counter to the value recorded with it.
+	 */
+	void restoreState(const gsl_rng * state, unsigned long draws)
+	{
+		gsl_rng_memcpy(m_RNG, state);
+		m_draws = draws;
+	}
+
+
 	/// CPPONLY
 	static unsigned long generateRandomSeed();
 
@@ -1878,6 +2172,7 @@ public:
 	 */
 	double randUniform()
 	{
+		++m_draws;
 		return gsl_rng_uniform(m_RNG);
 	}
 
@@ -1887,11 +2182,32 @@ public:
 	 */
 	bool randBit();
 
+	/** CPPONLY Fill caller-provided buffer \e buf with \e n independent
+	 *  uniform [0, 1) deviates. Hot samplers that consume one deviate per
+	 *  trial should draw them in batches through this function instead of
+	 *  paying the GSL dispatch overhead once per randUniform() call.
+	 */
+	void fillUniform(double * buf, size_t n)
+	{
+		m_draws += n;
+		for (size_t i = 0; i < n; ++i)
+			buf[i] = gsl_rng_uniform(m_RNG);
+	}
+
+
+	/** CPPONLY Fill \e buf with \e n random bits, packed WORDBIT bits to a
+	 *  word. Trailing bits of the last word are set to zero. Like randBit(),
+	 *  only the last 16 bits of each generator draw are used for the quality
+	 *  of the random bits.
+	 */
+	void fillBits(WORDTYPE * buf, size_t n);
+
 	/** return a random number in the range of <tt>[0, 1, 2, ... n-1]</tt>
 	 *  <group>3-rng</group>
 	 */
 	unsigned long int randInt(unsigned long int n)
 	{
+		++m_draws;
 		return gsl_rng_uniform_int(m_RNG, n);
 	}
 
@@ -1902,6 +2218,7 @@ public:
 	 */
 	double randNormal(double mu, double sigma)
 	{
+		++m_draws;
 		return gsl_ran_gaussian(m_RNG, sigma) + mu;
 	}
 
@@ -1912,6 +2229,7 @@ public:
 	 */
 	double randExponential(double mu)
 	{
+		++m_draws;
 		return gsl_ran_exponential(m_RNG, mu);
 	}
 
@@ -1922,6 +2240,7 @@ public:
 	 */
 	double randGamma(double a, double b)
 	{
+		++m_draws;
 		return gsl_ran_gamma(m_RNG, a, b);
 	}
 
@@ -1932,6 +2251,7 @@ public:
 	 */
 	double randChisq(double nu)
 	{
+		++m_draws;
 		return gsl_ran_chisq(m_RNG, nu);
 	}
 
@@ -1942,6 +2262,7 @@ public:
 	 */
 	long randGeometric(double p)
 	{
+		++m_draws;
 		return gsl_ran_geometric(m_RNG, p);
 	}
 
@@ -1954,6 +2275,7 @@ public:
 	{
 		DBG_FAILIF(n <= 0, ValueError, "RandBinomial: n should be positive.");
 
+		++m_draws;
 		return gsl_ran_binomial(m_RNG, p, n);
 	}
 
@@ -1964,6 +2286,7 @@ public:
 	 */
 	ULONG randPoisson(double mu)
 	{
+		++m_draws;
 		return gsl_ran_poisson(m_RNG, mu);
 	}
 
@@ -1988,6 +2311,7 @@ public:
 		// the size of n is not checked!
 		vector<unsigned int> val(p.size());
 		vectoru res(p.size());
+		++m_draws;
 		gsl_ran_multinomial(m_RNG, p.size(), N, &p[0], &val[0]);
 		for (size_t i = 0; i < p.size(); ++i)
 			res[i] = val[i];
@@ -2003,6 +2327,7 @@ public:
 	{
 		// use the STL random shuffle function but a GSL random number
 		// generator.
+		m_draws += std::distance(begin, end);
 		RNG_func rng(m_RNG);
 
 #ifdef BOOST_COMPUTE_USE_CPP11
@@ -2030,6 +2355,10 @@ private:
 	/// to reset a RNG when a new seed is set.
 	uint16_t m_bitByte;
 	UINT m_bitIndex;
+
+	/// variates drawn since the seed was last set, mutable because
+	/// randomShuffle is a const method
+	mutable unsigned long m_draws;
 };
 
 /// return the currently used random number generator
@@ -2099,7 +2428,7 @@ public:
 	 *  numbers will be returned in \e N returned numbers.
 	 */
 	WeightedSampler(const vectorf & weights = vectorf(), ULONG N = 0)
-		: m_algorithm(0), m_q(0), m_a(0), m_param(0),
+		: m_algorithm(0), m_q(0), m_a(0), m_HL(0), m_param(0),
 		m_sequence(0), m_index(0)
 	{
 
@@ -2190,8 +2519,12 @@ public:
 			for (size_t i = 0; i < m_N; ++i)
 				m_a[i] = i;
 			// use two sets H and L
-			// for efficiency purpose, use a single vector.
-			size_t * HL = new size_t[m_N];
+			// for efficiency purpose, use a single vector. The vector is
+			// a member so that repeated set() calls (e.g. once per
+			// subpopulation per generation under selection) reuse its
+			// capacity instead of going back to the allocator.
+			m_HL.resize(m_N);
+			size_t * HL = &m_HL[0];
 			size_t * L = HL;
 			size_t * H = HL + m_N - 1;                                 // point to the end.
 
@@ -2216,7 +2549,6 @@ public:
 					++H;                                                                // remove k from H
 				}
 			}
-			delete[] HL;
 		} else {
 			m_algorithm = 4;
 			for (size_t i = 0; i < sz; ++i) {
@@ -2251,10 +2583,23 @@ public:
 	 */
 	size_t draw();
 
+	/** CPPONLY Draw a random number using a pre-generated uniform random
+	 *  deviate \e u from [0, 1), which allows callers to generate random
+	 *  numbers in batches (see \c RNG::fillUniform). Samplers that return
+	 *  exact proportions ignore \e u and use the regular generator.
+	 */
+	size_t draw(double u);
+
 	/** Returns a list of \e n random numbers
 	 */
 	vectoru drawSamples(ULONG n = 1);
 
+	/** CPPONLY Fill \e res with \e n random numbers. Uniform deviates are
+	 *  drawn in batches (see \c RNG::fillUniform) so that alias-table
+	 *  samplers amortize random number generator calls across draws.
+	 */
+	void drawSamples(ULONG n, vectoru & res);
+
 private:
 	/// which algorithm to use
 	int m_algorithm;
@@ -2268,6 +2613,10 @@ private:
 	///
 	vectoru m_a;
 
+	/// scratch used when the alias table is built, kept as a member so
+	/// its storage survives between generations
+	vectoru m_HL;
+
 	///
 	size_t m_param;
 
@@ -2555,6 +2904,18 @@ void copyGenotype(GenoIterator fr, GenoIterator to, size_t n);
 /// will not do here.
 void clearGenotype(GenoIterator to, size_t n);
 
+/// CPPONLY
+/// Set the \e n alleles starting at \e to to one, word by word. This is
+/// the all-ones counterpart of clearGenotype, used when a population is
+/// deliberately filled with the mutant allele.
+void fillGenotype(GenoIterator to, size_t n);
+
+/// CPPONLY
+/// Count the number of 1 alleles among the \e n alleles starting at
+/// \e it, one population count per word of the underlying storage
+/// instead of one test per bit.
+size_t countGenotype(GenoIterator it, size_t n);
+
 #  ifndef OPTIMIZED
 void testCopyGenotype();
 
@@ -2570,6 +2931,38 @@ void copyGenotype(const ConstGenoIterator begin, const ConstGenoIterator end,
 /// CPPONLY
 void clearGenotype(GenoIterator begin, GenoIterator end);
 
+#endif
+
+#if !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+/// CPPONLY
+/// Bulk-copy alleles between spans of contiguous vectora storage. A single
+/// memcpy per span is used instead of an element-wise loop, which matters
+/// in non-optimized builds where checked iterators prevent std::copy from
+/// being lowered to a block copy.
+inline void copyGenotype(ConstGenoIterator begin, ConstGenoIterator end,
+                         GenoIterator it)
+{
+	if (begin != end)
+		memcpy(&*it, &*begin, (end - begin) * sizeof(Allele));
+}
+
+
+#endif
+
+#ifdef LINEAGE
+/// CPPONLY
+/// Bulk-copy lineage values between spans of contiguous lineage storage,
+/// the lineage counterpart of copyGenotype. Transmitters copy the lineage
+/// of a segment with one call to this function so that lineage tracking
+/// adds a block copy, not a per-allele loop, to each transmitted segment.
+inline void copyLineage(ConstLineageIterator begin, ConstLineageIterator end,
+                        LineageIterator it)
+{
+	if (begin != end)
+		memcpy(&*it, &*begin, (end - begin) * sizeof(long));
+}
+
+
 #endif
 
 
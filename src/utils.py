@@ -56,7 +56,7 @@ import time
 from simuOpt import simuOptions
 
 from simuPOP import moduleInfo, MALE, FEMALE, Population, PointMutator, getRNG,\
-    ALL_AVAIL, PyOperator, stat
+    ALL_AVAIL, PyOperator, stat, importVCF
 import collections
 
 def viewVars(var, gui=None):
@@ -3091,6 +3091,17 @@ def importPopulation(format, filename, *args, **kwargs):
         subpopulations have different segregating sites. If ``mergeBy`` is set
         to ``"chrom"``, the replicates will be presented as separate chromosomes,
         each with a different set of loci determined by segregating sites.
+
+    VCF (Variant Call Format). Files in this format, optionally compressed by
+    gzip (with filename extension ``.gz``), are imported at the C++ level so
+    that allele calls are streamed directly into the genotype of the resulting
+    population. Chromosomes, loci positions and loci names (if all records
+    carry an unique ID) are determined from the ``CHROM``, ``POS`` and ``ID``
+    columns of the file, and the ploidy of the population (1 or 2) is
+    determined from the genotype of the first record. The reference allele is
+    imported as allele 0, alternative alleles as alleles 1, 2, ..., and
+    missing calls as allele 0. This format does not accept additional
+    parameters.
     '''
     if format.lower() == 'genepop':
         importer = GenePopImporter(*args, **kwargs)
@@ -3100,6 +3111,10 @@ def importPopulation(format, filename, *args, **kwargs):
         importer = PhylipImporter(*args, **kwargs)
     elif format.lower() == 'ms':
         importer = MSImporter(*args, **kwargs)
+    elif format.lower() == 'vcf':
+        # VCF files are imported at the C++ level, which streams allele calls
+        # directly into the genotype of the population.
+        return importVCF(filename)
     else:
         raise ValueError('Importing genotypes in format %s is currently not supported' % format)
     return importer.importFrom(filename)
@@ -231,23 +231,21 @@ subPopList subPopList::expandFrom(const Population & pop) const
 		"Only when no subpopulation is specified can this function be called."
 		"This is likely caused by the use of persistent subPops for different populations.");
 	vectorvsp vsps;
-	if (allAvail()) {
-		for (int sp = 0; sp < static_cast<int>(pop.numSubPop()); ++sp)
-			vsps.push_back(vspID(sp));
-	} else {
+	if (allAvail())
+		// the expansion of ALL_AVAIL is cached on the population, where it
+		// is shared by every operator applied to it
+		return subPopList(pop.allSubPops(false));
+	else {
 		// otherwise, handle vsps such as (ALL_AVAIL, vsp)
 		vectorvsp::const_iterator it = m_subPops.begin();
 		vectorvsp::const_iterator it_end = m_subPops.end();
 		for (; it != it_end; ++it) {
-			if (it->allAvailSP()) {
+			if (it->allAvailSP() && it->allAvailVSP()) {
+				const vectorvsp & all = pop.allSubPops(true);
+				vsps.insert(vsps.end(), all.begin(), all.end());
+			} else if (it->allAvailSP()) {
 				for (int sp = 0; sp < static_cast<int>(pop.numSubPop()); ++sp) {
-					if (it->allAvailVSP()) {
-						if (pop.numVirtualSubPop() == 0)
-							vsps.push_back(vspID(sp));
-						else
-							for (int vsp = 0; vsp < static_cast<int>(pop.numVirtualSubPop()); ++vsp)
-								vsps.push_back(vspID(sp, vsp));
-					} else if (it->vspName().empty()) {
+					if (it->vspName().empty()) {
 						DBG_FAILIF(it->virtualSubPop() >= pop.numVirtualSubPop(), ValueError,
 							(boost::format("Virtual subpop index out of range: %1% specified with %2% vsps"
 							) % it->virtualSubPop() % pop.numVirtualSubPop()).str());
@@ -309,6 +307,14 @@ size_t BaseVspSplitter::countVisibleInds(const Population & pop, size_t subPop)
 }
 
 
+void BaseVspSplitter::restrictMask(const Population & pop, size_t subPop, size_t virtualSubPop, std::vector<char> & mask) const
+{
+	for (size_t i = 0; i < mask.size(); ++i)
+		if (mask[i] && !contains(pop, i, vspID(subPop, virtualSubPop)))
+			mask[i] = 0;
+}
+
+
 size_t BaseVspSplitter::vspByName(const string & vspName) const
 {
 	if (!m_names.empty()) {
@@ -534,19 +540,14 @@ size_t ProductSplitter::size(const Population & pop, size_t subPop, size_t virtu
 	DBG_FAILIF(virtualSubPop >= m_numVSP, IndexError, "Subpopulation index out of range.");
 
 	const vectoru & idx = m_subIndexes[virtualSubPop];
-	size_t count = 0;
+	std::vector<char> mask(pop.subPopSize(subPop), 1);
 
-	for (size_t i = 0; i < pop.subPopSize(subPop); ++i) {
-		bool ok = true;
-		for (size_t s = 0; s < m_splitters.size(); ++s) {
-			if (!m_splitters[s]->contains(pop, i, vspID(subPop, idx[s]))) {
-				ok = false;
-				break;
-			}
-		}
-		if (ok)
+	for (size_t s = 0; s < m_splitters.size(); ++s)
+		m_splitters[s]->restrictMask(pop, subPop, idx[s], mask);
+	size_t count = 0;
+	for (size_t i = 0; i < mask.size(); ++i)
+		if (mask[i])
 			++count;
-	}
 	return count;
 }
 
@@ -568,16 +569,16 @@ void ProductSplitter::activate(const Population & pop, size_t subPop, size_t vir
 	DBG_FAILIF(virtualSubPop >= m_numVSP, IndexError, "Subpopulation index out of range.");
 	const vectoru & idx = m_subIndexes[virtualSubPop];
 
-	for (size_t i = 0; i < pop.subPopSize(subPop); ++i) {
-		bool ok = true;
-		for (size_t s = 0; s < m_splitters.size(); ++s) {
-			if (!m_splitters[s]->contains(pop, i, vspID(subPop, idx[s]))) {
-				ok = false;
-				break;
-			}
-		}
-		pop.individual(i, subPop).setVisible(ok);
-	}
+	// Classify through a membership mask so that each component resolves
+	// its parameters (such as the index of an information field) once per
+	// sweep instead of once per individual.
+	std::vector<char> mask(pop.subPopSize(subPop), 1);
+
+	for (size_t s = 0; s < m_splitters.size(); ++s)
+		m_splitters[s]->restrictMask(pop, subPop, idx[s], mask);
+	ConstRawIndIterator it = pop.rawIndBegin(subPop);
+	for (size_t i = 0; i < mask.size(); ++i, ++it)
+		it->setVisible(mask[i] != 0);
 	m_activated = subPop;
 }
 
@@ -629,14 +630,33 @@ bool SexSplitter::contains(const Population & pop, size_t ind, vspID vsp) const
 
 void SexSplitter::activate(const Population & pop, size_t subPop, size_t virtualSubPop)
 {
-	Sex s = virtualSubPop == 0 ? MALE : FEMALE;
-
 	ConstRawIndIterator it = pop.rawIndBegin(subPop);
 	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
 
+	// A heterogeneous mating scheme activates the VSPs of a subpopulation
+	// one after another without deactivating in between, and parental sex
+	// does not change while parents are being chosen. The visibility bits
+	// of the previous activation are therefore still valid: activating the
+	// same VSP again costs nothing, and activating the complementary VSP
+	// only has to flip each bit instead of partitioning by sex again. This
+	// shortcut is taken only when this splitter is attached to the
+	// population directly, because inside a combined or product splitter
+	// a sibling splitter may have overwritten the bits.
+	if (m_activated == subPop && pop.virtualSplitter() == this) {
+		if (virtualSubPop == m_lastVSP)
+			return;
+		for (; it != it_end; ++it)
+			it->setVisible(!it->visible());
+		m_lastVSP = virtualSubPop;
+		return;
+	}
+
+	Sex s = virtualSubPop == 0 ? MALE : FEMALE;
+
 	for (; it != it_end; ++it)
 		it->setVisible(it->sex() == s);
 	m_activated = subPop;
+	m_lastVSP = virtualSubPop;
 }
 
 
@@ -840,47 +860,115 @@ bool InfoSplitter::contains(const Population & pop, size_t ind, vspID vsp) const
 }
 
 
+void InfoSplitter::restrictMask(const Population & pop, size_t subPop, size_t virtualSubPop, std::vector<char> & mask) const
+{
+	size_t idx = pop.infoIdx(m_info);
+
+	ConstRawIndIterator it = pop.rawIndBegin(subPop);
+
+	DBG_ASSERT(mask.size() == static_cast<size_t>(pop.rawIndEnd(subPop) - it), SystemError,
+		"Membership mask does not match subpopulation size.");
+
+	if (!m_values.empty()) {
+		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_values.size(), IndexError,
+			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % (m_values.size() - 1)).str());
+		double v = m_values[virtualSubPop];
+		for (size_t i = 0; i < mask.size(); ++i, ++it)
+			if (mask[i] && !fcmp_eq(it->info(idx), v))
+				mask[i] = 0;
+		return;
+	}
+	// cutoff values and ranges both reduce to a half-open interval
+	double v1 = 0;
+	double v2 = 0;
+	bool noLower = false;
+	bool noUpper = false;
+	if (!m_cutoff.empty()) {
+		DBG_FAILIF(static_cast<UINT>(virtualSubPop) > m_cutoff.size(), IndexError,
+			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_cutoff.size()).str());
+		noLower = virtualSubPop == 0;
+		noUpper = static_cast<UINT>(virtualSubPop) == m_cutoff.size();
+		if (!noLower)
+			v1 = m_cutoff[virtualSubPop - 1];
+		if (!noUpper)
+			v2 = m_cutoff[virtualSubPop];
+	} else {
+		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_ranges.size(), IndexError,
+			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % (m_ranges.size() - 1)).str());
+		v1 = m_ranges[virtualSubPop][0];
+		v2 = m_ranges[virtualSubPop][1];
+	}
+	for (size_t i = 0; i < mask.size(); ++i, ++it) {
+		if (!mask[i])
+			continue;
+		double v = it->info(idx);
+		if ((!noLower && v < v1) || (!noUpper && v >= v2))
+			mask[i] = 0;
+	}
+}
+
+
 void InfoSplitter::activate(const Population & pop, size_t subPop, size_t virtualSubPop)
 {
 	size_t idx = pop.infoIdx(m_info);
 
 	ConstRawIndIterator it = pop.rawIndBegin(subPop);
 	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
+	ssize_t n = it_end - it;
 
+	// visibility flags of different individuals are independent, and the
+	// same virtual subpopulations tend to be activated by a dozen
+	// operators per generation, so the predicate scan is parallelized.
 	if (!m_cutoff.empty()) {
 		DBG_FAILIF(static_cast<UINT>(virtualSubPop) > m_cutoff.size(), IndexError,
 			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_cutoff.size()).str());
 
 		// using cutoff, below
 		if (virtualSubPop == 0) {
-			for (; it != it_end; ++it)
-				it->setVisible(it->info(idx) < m_cutoff[0]);
+			double v0 = m_cutoff[0];
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+			for (ssize_t i = 0; i < n; ++i)
+				(it + i)->setVisible((it + i)->info(idx) < v0);
 		} else if (static_cast<size_t>(virtualSubPop) == m_cutoff.size()) {
 			double v = m_cutoff.back();
-			for (; it != it_end; ++it)
-				it->setVisible(it->info(idx) >= v);
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+			for (ssize_t i = 0; i < n; ++i)
+				(it + i)->setVisible((it + i)->info(idx) >= v);
 		} else {         // in between
 			double v1 = m_cutoff[virtualSubPop - 1];
 			double v2 = m_cutoff[virtualSubPop];
-			for (; it != it_end; ++it) {
-				double v = it->info(idx);
-				it->setVisible(v >= v1 && v < v2);
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+			for (ssize_t i = 0; i < n; ++i) {
+				double v = (it + i)->info(idx);
+				(it + i)->setVisible(v >= v1 && v < v2);
 			}
 		}
 	} else if (!m_values.empty()) {
 		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_values.size(), IndexError,
 			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_values.size()).str());
 		double v = m_values[virtualSubPop];
-		for (; it != it_end; ++it)
-			it->setVisible(fcmp_eq(it->info(idx), v));
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+		for (ssize_t i = 0; i < n; ++i)
+			(it + i)->setVisible(fcmp_eq((it + i)->info(idx), v));
 	} else {
 		DBG_FAILIF(static_cast<size_t>(virtualSubPop) >= m_ranges.size(), IndexError,
 			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_ranges.size()).str());
 		double v1 = m_ranges[virtualSubPop][0];
 		double v2 = m_ranges[virtualSubPop][1];
-		for (; it != it_end; ++it) {
-			double v = it->info(idx);
-			it->setVisible(v >= v1 && v < v2);
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+		for (ssize_t i = 0; i < n; ++i) {
+			double v = (it + i)->info(idx);
+			(it + i)->setVisible(v >= v1 && v < v2);
 		}
 	}
 	m_activated = subPop;
@@ -919,8 +1007,10 @@ string InfoSplitter::name(size_t sp) const
 }
 
 
-ProportionSplitter::ProportionSplitter(vectorf const & proportions, const stringList & names)
-	: BaseVspSplitter(names), m_proportions(proportions)
+ProportionSplitter::ProportionSplitter(vectorf const & proportions, const stringList & names,
+	bool random)
+	: BaseVspSplitter(names), m_proportions(proportions), m_random(random),
+	m_seed(random ? getRNG().randInt(std::numeric_limits<unsigned long>::max()) : 0)
 {
 	DBG_ASSERT(fcmp_eq(std::accumulate(proportions.begin(),
 				proportions.end(), 0.), 1.), ValueError,
@@ -928,12 +1018,44 @@ ProportionSplitter::ProportionSplitter(vectorf const & proportions, const string
 }
 
 
+size_t ProportionSplitter::vspOfInd(size_t idx) const
+{
+	// mix the individual index with the splitter seed into a value that is
+	// uniform in [0, 1), so that membership can be decided independently
+	// for each individual without shuffling or storing index vectors.
+	unsigned long long h = static_cast<unsigned long long>(idx) + 0x9e3779b97f4a7c15ULL
+	                       + static_cast<unsigned long long>(m_seed);
+
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	h ^= h >> 31;
+	double u = static_cast<double>(h >> 11) * (1.0 / 9007199254740992.0);
+
+	double cum = 0.;
+	for (size_t sp = 0; sp + 1 < m_proportions.size(); ++sp) {
+		cum += m_proportions[sp];
+		if (u < cum)
+			return sp;
+	}
+	return m_proportions.size() - 1;
+}
+
+
 size_t ProportionSplitter::size(const Population & pop, size_t subPop, size_t virtualSubPop) const
 {
 	if (virtualSubPop == InvalidValue)
 		return countVisibleInds(pop, subPop);
 	DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_proportions.size(), IndexError,
 		"Virtual subpopulation index out of range");
+	if (m_random) {
+		// sizes of randomly assigned VSPs follow from the assignment hash
+		size_t spSize = pop.subPopSize(subPop);
+		size_t cnt = 0;
+		for (size_t idx = 0; idx < spSize; ++idx)
+			if (vspOfInd(idx) == virtualSubPop)
+				++cnt;
+		return cnt;
+	}
 	//
 	if (static_cast<UINT>(virtualSubPop) < m_proportions.size() - 1)
 		return static_cast<size_t>(pop.subPopSize(subPop) * m_proportions[virtualSubPop]);
@@ -958,6 +1080,9 @@ bool ProportionSplitter::contains(const Population & pop, size_t ind, vspID vsp)
 	DBG_FAILIF(static_cast<UINT>(vsp.virtualSubPop()) >= m_proportions.size(), IndexError,
 		"Virtual subpopulation index out of range");
 
+	if (m_random)
+		return vspOfInd(ind) == vsp.virtualSubPop();
+
 	size_t size = pop.subPopSize(vsp.subPop());
 	vectoru count(m_proportions.size());
 	propToCount(m_proportions.begin(), m_proportions.end(), size, count);
@@ -979,6 +1104,17 @@ void ProportionSplitter::activate(const Population & pop, size_t subPop, size_t
 	DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_proportions.size(), IndexError,
 		"Virtual subpopulation index out of range");
 
+	if (m_random) {
+		// membership is decided per individual from the assignment hash, in
+		// one pass and without an index vector
+		ConstRawIndIterator it = pop.rawIndBegin(subPop);
+		ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
+		for (size_t idx = 0; it != it_end; ++it, ++idx)
+			it->setVisible(vspOfInd(idx) == virtualSubPop);
+		m_activated = subPop;
+		return;
+	}
+
 	size_t size = pop.subPopSize(subPop);
 	vectoru count(m_proportions.size());
 	propToCount(m_proportions.begin(), m_proportions.end(), size, count);
@@ -1135,8 +1271,14 @@ void GenotypeSplitter::activate(const Population & pop, size_t subPop, size_t vi
 	const vectori & alleles = m_alleles[virtualSubPop];
 	ConstRawIndIterator it = pop.rawIndBegin(subPop);
 	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
-	for (; it != it_end; ++it)
-		it->setVisible(match(&*it, alleles));
+	ssize_t n = it_end - it;
+	// genotype matching reads shared data and writes only the visibility
+	// flag of each individual, so individuals can be matched concurrently
+#ifdef _OPENMP
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+	for (ssize_t i = 0; i < n; ++i)
+		(it + i)->setVisible(match(&*(it + i), alleles));
 	m_activated = subPop;
 }
 
@@ -1191,17 +1333,17 @@ bool GenotypeSplitter::match(const Individual * it, const vectori & alleles) con
 	DBG_FAILIF(alleles.size() != choices * ploidy * numLoci,
 		ValueError, "Given genotype does not match population ploidy.");
 
-	for (unsigned t = 0; t < choices; ++t) {
-		vectori partial(alleles.begin() + t * ploidy * numLoci,
-		                alleles.begin() + (t + 1) * ploidy * numLoci);
-		if (matchSingle(it, partial))
+	// each choice is matched in place: copying it into a partial genotype
+	// would allocate once per individual of the scanned subpopulation
+	for (unsigned t = 0; t < choices; ++t)
+		if (matchSingle(it, alleles, t * ploidy * numLoci))
 			return true;
-	}
 	return false;
 }
 
 
-bool GenotypeSplitter::matchSingle(const Individual * it, const vectori & alleles) const
+bool GenotypeSplitter::matchSingle(const Individual * it, const vectori & alleles,
+                                   size_t offset) const
 {
 	int ploidy = it->ploidy();
 	const vectoru & loci = m_loci.elems((const GenoStruTrait *)(it));
@@ -1213,7 +1355,7 @@ bool GenotypeSplitter::matchSingle(const Individual * it, const vectori & allele
 		uintList::const_iterator loc_end = loci.end();
 		for (; loc != loc_end; ++loc)
 			for (int p = 0; p < ploidy; ++p)
-				if (static_cast<int>(it->allele(*loc, p)) != alleles[idx++])
+				if (static_cast<int>(it->allele(*loc, p)) != alleles[offset + idx++])
 					return false;
 		return true;
 	} else if (ploidy == 2) {
@@ -1224,8 +1366,8 @@ bool GenotypeSplitter::matchSingle(const Individual * it, const vectori & allele
 		for (; loc != loc_end; ++loc, ++idx) {
 			int a1 = it->allele(*loc, 0);
 			int a2 = it->allele(*loc, 1);
-			int a3 = alleles[idx];
-			int a4 = alleles[idx + numLoci];
+			int a3 = alleles[offset + idx];
+			int a4 = alleles[offset + idx + numLoci];
 			if (!((a1 == a3 && a2 == a4) || (a1 == a4 && a2 == a3)))
 				return false;
 		}
@@ -1240,7 +1382,7 @@ bool GenotypeSplitter::matchSingle(const Individual * it, const vectori & allele
 		for (; loc != loc_end; ++loc, ++idx) {
 			for (int p = 0; p < ploidy; ++p) {
 				v1[p] = it->allele(*loc, p);
-				v2[p] = alleles[idx + p * numLoci];
+				v2[p] = alleles[offset + idx + p * numLoci];
 			}
 			std::sort(v1.begin(), v1.end());
 			std::sort(v2.begin(), v2.end());
@@ -335,6 +335,16 @@ public:
 	 */
 	virtual bool contains(const Population & pop, size_t ind, vspID vsp) const = 0;
 
+	/** Clear entries of \e mask (one entry per individual of \e subPop)
+	 *  for individuals that do not belong to VSP \e virtualSubPop. The
+	 *  default implementation tests individuals one by one; splitters
+	 *  whose membership test is expensive override it with a sweep that
+	 *  resolves their parameters only once.
+	 *  CPPONLY
+	 */
+	virtual void restrictMask(const Population & pop, size_t subPop, size_t virtualSubPop,
+		std::vector<char> & mask) const;
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	virtual void activate(const Population & pop, size_t subPop, size_t virtualSubPop) = 0;
@@ -549,7 +559,8 @@ public:
 	 *  are named \c Male and \c Female unless a new set of names are specified
 	 *  by parameter \e names.
 	 */
-	SexSplitter(const stringList & names = vectorstr()) : BaseVspSplitter(names)
+	SexSplitter(const stringList & names = vectorstr()) : BaseVspSplitter(names),
+		m_lastVSP(InvalidValue)
 	{
 	}
 
@@ -589,6 +600,10 @@ public:
 	 */
 	string name(size_t vsp) const;
 
+private:
+	/// VSP of the last activation, so that repeated activations on a
+	/// still-activated subpopulation can reuse the visibility bits.
+	size_t m_lastVSP;
 };
 
 
@@ -695,6 +710,12 @@ public:
 	 */
 	bool contains(const Population & pop, size_t ind, vspID vsp) const;
 
+	/// clear mask entries of individuals outside the given vsp, resolving
+	/// the information field only once for the whole sweep.
+	/// CPPONLY
+	void restrictMask(const Population & pop, size_t subPop, size_t virtualSubPop,
+		std::vector<char> & mask) const;
+
 	/// mark individuals in the given vsp as visible, and others invisible.
 	/// CPPONLY
 	void activate(const Population & pop, size_t subPop, size_t virtualSubPop);
@@ -726,11 +747,19 @@ class ProportionSplitter : public BaseVspSplitter
 public:
 	/** Create a splitter that divides subpopulations by \e proportions, which
 	 *  should be a list of float numbers (between \c 0 and \c 1) that add up
-	 *  to \c 1.  A default set of names are given to each VSP unless a new set
-	 *  of names is given by parameter \e names.
+	 *  to \c 1. By default, the first VSP consists of the first
+	 *  <tt>proportions[0]</tt> individuals of each subpopulation, the second
+	 *  VSP consists of the next <tt>proportions[1]</tt> individuals, and so
+	 *  on. If parameter \e random is set to \c True, individuals are
+	 *  assigned to VSPs randomly. The assignment is decided by a random
+	 *  number seed drawn when the splitter is created, so it does not depend
+	 *  on the order in which VSPs are activated, and stays the same for
+	 *  individuals that keep their index across activations. A default set
+	 *  of names are given to each VSP unless a new set of names is given by
+	 *  parameter \e names.
 	 */
 	ProportionSplitter(vectorf const & proportions = vectorf(),
-		const stringList & names = vectorstr());
+		const stringList & names = vectorstr(), bool random = false);
 
 	/// HIDDEN
 	BaseVspSplitter * clone() const
@@ -764,8 +793,16 @@ public:
 	 */
 	string name(size_t vsp) const;
 
+private:
+	/// CPPONLY VSP that individual \e idx is assigned to in random mode
+	size_t vspOfInd(size_t idx) const;
+
 private:
 	vectorf m_proportions;
+	///
+	bool m_random;
+	/// seed of the hash that assigns individuals to VSPs in random mode
+	size_t m_seed;
 };
 
 
@@ -898,7 +935,8 @@ public:
 private:
 	bool match(const Individual * ind, const vectori & alleles) const;
 
-	bool matchSingle(const Individual * ind, const vectori & alleles) const;
+	bool matchSingle(const Individual * ind, const vectori & alleles,
+		size_t offset) const;
 
 private:
 	lociList m_loci;
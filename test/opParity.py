@@ -0,0 +1,183 @@
+#!/usr/bin/env python
+#
+# Purpose:
+#    paired benchmark of the standard and optimized (*op) builds of each
+#    simuPOP module, to decide which build to deploy for a given workload
+#
+# Usage:
+#
+#     opParity.py [-j #] [moduleName1] [moduleName2] ...
+#
+# where
+#     moduleName is one of std, ba, la, mu, lin (default: all of them).
+#     -j # specifies the number of threads (default: all threads).
+#
+# For every module pair (std/op, ba/baop, la/laop, mu/muop, lin/linop,
+# following the MODULES list of setup.py) this script runs the same
+# per-operator scenarios on a grid of population size x number of loci in
+# both builds, each in a fresh child process, and prints a speedup table
+# (standard time / optimized time, > 1 means the optimized build wins).
+#
+# Threshold model: the optimized build removes parameter and range checks
+# whose cost is proportional to the number of genotype accesses, so its
+# advantage grows with size * loci. For each operator the table is followed
+# by the smallest size * loci product from which the optimized build won
+# every larger scenario (the breakeven point); below it the builds are
+# within noise and thread startup costs can make the optimized build
+# slower on small populations. Deployment rule of thumb: pick the
+# optimized build for a workload whose size * loci is above the breakeven
+# of its dominant operator, and the standard build (which also retains
+# diagnostics) otherwise.
+#
+# Results are also appended to opParity.json, one record per module pair,
+# so deployment configuration can be derived by other tools.
+#
+import os, sys, json, subprocess, tempfile
+
+# modules are benchmarked in pairs, standard against optimized, following
+# the MODULES list in setup.py
+PAIRS = [
+    ('std', 'op', 'short'),
+    ('ba', 'baop', 'binary'),
+    ('la', 'laop', 'long'),
+    ('mu', 'muop', 'mutant'),
+    ('lin', 'linop', 'lineage'),
+]
+
+# the grid of scenarios; sizes x loci spans the range where the builds
+# have been observed to change order
+SIZES = [1000, 10000, 100000]
+LOCI = [10, 100, 1000]
+
+# number of repeats per measurement, the minimum is reported
+REPEATS = 3
+
+
+def scenarios():
+    '''Per-operator scenarios, each is (name, setup, statement). The
+    statement is timed; the setup is not.'''
+    return [
+        ('initGenotype',
+            'pop = Population(size=size, loci=loci)',
+            'initGenotype(pop, freq=[0.6, 0.4])'),
+        ('randomMating',
+            'pop = Population(size=size, loci=loci, infoFields="fitness")\n'
+            'initSex(pop)\n'
+            'initGenotype(pop, freq=[0.6, 0.4])',
+            'pop.evolve(matingScheme=RandomMating(), gen=3)'),
+        ('statAlleleFreq',
+            'pop = Population(size=size, loci=loci)\n'
+            'initGenotype(pop, freq=[0.6, 0.4])',
+            'stat(pop, alleleFreq=ALL_AVAIL)'),
+        ('snpMutator',
+            'pop = Population(size=size, loci=loci)\n'
+            'initGenotype(pop, freq=[0.6, 0.4])\n'
+            'mut = SNPMutator(u=0.01, v=0.01)',
+            'mut.apply(pop)'),
+        ('migrator',
+            'pop = Population(size=[size // 2, size - size // 2], loci=loci)\n'
+            'initSex(pop)',
+            'migrate(pop, rate=[[0, 0.1], [0.1, 0]])'),
+    ]
+
+
+def runChild(alleleType, optimized, numThreads, outFile):
+    '''Run all scenarios in the requested build and write timings to
+    outFile as JSON. This runs in a child process because a build can be
+    loaded only once per process.'''
+    import simuOpt
+    simuOpt.setOptions(alleleType=alleleType, optimized=optimized,
+        quiet=True, numThreads=numThreads)
+    import timeit
+    from simuPOP import Population, RandomMating, ALL_AVAIL, moduleInfo
+    from simuPOP import initGenotype, initSex, stat, migrate, SNPMutator
+    env = globals().copy()
+    env.update(locals())
+    results = {}
+    for size in SIZES:
+        for loci in LOCI:
+            # skip scenarios that would not fit in memory
+            if size * loci * moduleInfo()['alleleBits'] / 8 > 2e9:
+                continue
+            for name, setup, stmt in scenarios():
+                env['size'] = size
+                env['loci'] = loci
+                timer = timeit.Timer(stmt, setup, globals=env)
+                results['%s/%d/%d' % (name, size, loci)] = \
+                    min(timer.repeat(repeat=REPEATS, number=1))
+    out = open(outFile, 'w')
+    json.dump(results, out)
+    out.close()
+
+
+def breakeven(rows):
+    '''Return the smallest size * loci from which the optimized build won
+    every scenario at that product or above, or None if it never did.'''
+    rows = sorted(rows, key=lambda r: r[0] * r[1])
+    best = None
+    for i, (size, loci, speedup) in enumerate(rows):
+        if all(r[2] > 1 for r in rows[i:]):
+            best = size * loci
+            break
+    return best
+
+
+def comparePair(std, op, alleleType, numThreads):
+    print('%s vs %s (alleleType=%s)' % (std, op, alleleType))
+    timings = {}
+    for optimized, build in ((False, std), (True, op)):
+        handle, outFile = tempfile.mkstemp(suffix='.json')
+        os.close(handle)
+        ret = subprocess.call([sys.executable, sys.argv[0], '--run-child',
+            alleleType, '1' if optimized else '0', str(numThreads or 0), outFile])
+        if ret != 0:
+            print('Error: module %s exited with %d, pair skipped' % (build, ret))
+            os.remove(outFile)
+            return None
+        timings[build] = json.load(open(outFile))
+        os.remove(outFile)
+    record = {'pair': '%s/%s' % (std, op), 'alleleType': alleleType,
+        'speedup': {}, 'breakeven': {}}
+    for name, _setup, _stmt in scenarios():
+        rows = []
+        for key, tStd in sorted(timings[std].items()):
+            scen, size, loci = key.split('/')
+            if scen != name or key not in timings[op]:
+                continue
+            tOp = timings[op][key]
+            speedup = tStd / tOp if tOp > 0 else float('inf')
+            rows.append((int(size), int(loci), speedup))
+            record['speedup'][key] = speedup
+        print('  %-14s' % name + ' '.join(
+            ['%dx%d: %5.2f' % r for r in sorted(rows, key=lambda r: r[0] * r[1])]))
+        point = breakeven(rows)
+        record['breakeven'][name] = point
+        if point is None:
+            print('    no consistent winner; keep the standard build')
+        else:
+            print('    optimized build wins from size*loci >= %d' % point)
+    log = open('opParity.json', 'a')
+    log.write(json.dumps(record) + '\n')
+    log.close()
+    return record
+
+
+if __name__ == '__main__':
+    if '--run-child' in sys.argv:
+        idx = sys.argv.index('--run-child')
+        alleleType, optimized, numThreads, outFile = sys.argv[idx + 1:idx + 5]
+        runChild(alleleType, optimized == '1', int(numThreads) or None, outFile)
+        sys.exit(0)
+    #
+    numThreads = None
+    if '-j' in sys.argv:
+        idx = sys.argv.index('-j')
+        numThreads = int(sys.argv[idx + 1])
+        sys.argv.pop(idx + 1)
+        sys.argv.pop(idx)
+    #
+    selected = [x for x in sys.argv[1:] if not x.startswith('-')]
+    for std, op, alleleType in PAIRS:
+        if selected and std not in selected:
+            continue
+        comparePair(std, op, alleleType, numThreads)
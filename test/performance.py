@@ -16,16 +16,19 @@
 #     performance.py [-a] [-b|s|l] [-j #] [testname1] [testname2] ...
 #
 # where
-#     testname can be any string within a test. If -b (binary) -s (short) or -l (long)
-#     allele type is unspecified this script will be run for all three allele types.
+#     testname can be any string within a test. If -b (binary) -s (short) -l (long)
+#     -m (mutant) or -n (lineage) allele type is unspecified this script will be
+#     run for all allele types.
 #     -j # specifies number of threads, all threads will be used by default.
+#     -json appends one machine readable record per test case to performance.json,
+#     so that results can be tracked across revisions by other tools.
 #
 #     -a analysis mode. list performance test results in performance.csv in a
 #        more readable format.
 # All the test results will be written to a file 'performance.log'
 #
 #
-import os, sys, time, platform, logging, subprocess, timeit, random, csv
+import os, sys, time, platform, logging, subprocess, timeit, random, csv, json
 
 try:
     from itertools import product
@@ -43,11 +46,15 @@ if sys.version_info[0] >= 3:
     def callable(obj):
         return hasattr(obj, '__call__')
 
+# target of the -json option, set from the command line
+jsonOutput = None
+
 class PerformanceTest:
     def __init__(self, desc, logger):
         self.description = desc
         self.expected_time = 0
         self.logger = logger
+        self.cases = []
         # machine name, os, CPU, time
         uname = platform.uname()
         self.logger.debug('Host: %s (%s, %s, %s)' % (uname[1], uname[0], uname[4], uname[5]))
@@ -66,6 +73,32 @@ class PerformanceTest:
         '''Run all tests and record the result to a log file.'''
         results = self.run()
         self.logger.info(', '.join(['%s' % x for x in results]))
+        if jsonOutput:
+            self.saveJson(jsonOutput)
+
+    def saveJson(self, filename):
+        '''Append results of this test to a machine readable file, one JSON
+        record per test case. Tests that time a fixed number of repeats also
+        report the average time per operation in nanoseconds.'''
+        uname = platform.uname()
+        info = moduleInfo()
+        out = open(filename, 'a')
+        for case in self.cases:
+            record = {
+                'test': self.__class__.__name__,
+                'case': case['case'],
+                'result': case['result'],
+                'date': time.strftime('%Y-%m-%dT%H:%M:%S'),
+                'machine': uname[1],
+                'module': info['alleleType'],
+                'threads': info['threads'],
+                'optimized': info['optimized'],
+                'revision': info['revision'],
+            }
+            if hasattr(self, 'repeats') and self.repeats > 0 and case['result']:
+                record['ns_per_op'] = case['result'] * 1e9 / self.repeats
+            out.write(json.dumps(record) + '\n')
+        out.close()
 
     def sequentialRun(self, **kwargs):
         '''
@@ -78,7 +111,7 @@ class PerformanceTest:
         This function should return the return value of each test
         '''
         results = []
-        keys = kwargs.keys()
+        keys = list(kwargs.keys())
         for arg in zip(*[kwargs[x] for x in keys]):
             kwarg = dict(zip(keys, arg))
             case_desc = ', '.join(['%s=%s' % (x, kwarg[x].__name__ if callable(kwarg[x]) else kwarg[x]) for x in keys])
@@ -86,10 +119,12 @@ class PerformanceTest:
                 res = self._run(**kwarg)
                 self.logger.debug('%s: %s' % (case_desc, res))
                 results.append(res)
-            except Exception,e:
-                print e
+                self.cases.append({'case': case_desc, 'result': res})
+            except Exception as e:
+                print(e)
                 self.logger.debug('%s: failed' % case_desc)
                 results.append(0)
+                self.cases.append({'case': case_desc, 'result': 0})
                 pass
         return results
 
@@ -116,8 +151,10 @@ class PerformanceTest:
                 res = self._run(**kwarg)
                 self.logger.debug('%s: %s' % (case_desc, res))
                 results.append(res)
+                self.cases.append({'case': case_desc, 'result': res})
             except:
                 self.logger.debug('%s: failed' % case_desc)
+                self.cases.append({'case': case_desc, 'result': 0})
                 results.append(0)
                 pass
         return results
@@ -430,6 +467,32 @@ class TestRecombinator(PerformanceTest):
         )
         return gens
 
+class TestMendelianGenoTransmitter(PerformanceTest):
+    def __init__(self, logger, time=30):
+        PerformanceTest.__init__(self, 'MendelianGenoTransmitter with sequential parents, results are number of generations in %d seconds.' % int(time),
+            logger)
+        self.time = time
+
+    def run(self):
+        # overall running case
+        return self.productRun(size=[10000, 100000], loci=[10, 100, 10000])
+
+    def _run(self, size, loci):
+        # single test case
+        if size * loci * moduleInfo()['alleleBits'] / 8 > 1e9:
+            return 0
+        pop = Population(size=size, loci=loci)
+        # sequential parent choice keeps the cost of choosing parents low so
+        # that genotype transmission dominates the measurement
+        gens = pop.evolve(
+            initOps=InitSex(),
+            preOps=TicToc(output='', stopAfter=self.time),
+            matingScheme=HomoMating(
+                chooser=CombinedParentsChooser(SequentialParentChooser(MALE_ONLY), SequentialParentChooser(FEMALE_ONLY)),
+                generator=OffspringGenerator(ops=MendelianGenoTransmitter())),
+        )
+        return gens
+
 class TestCombinedParentsChooser(PerformanceTest):
     def __init__(self, logger, time=30):
         PerformanceTest.__init__(self, 'CombinedParentsChooser, results are number of generations in %d seconds.' % int(time),
@@ -1311,6 +1374,27 @@ class TestGenoIterator(PerformanceTest):
             'pop=getTestGenoIterPop(%d, %d, %d)' % (args[0], args[1], args[2]))
         return t.timeit(number=self.repeats)
 
+class TestPopulationPush(PerformanceTest):
+    def __init__(self, logger, repeats=10):
+        PerformanceTest.__init__(self, 'Population.push, results are time (not processor time) to push a prepared offspring generation for %d times.' % int(repeats),
+            logger)
+        self.repeats = repeats
+
+    def run(self):
+        # overall running case
+        return self.productRun(size=[10000, 100000], loci=[100, 10000])
+
+    def _run(self, size, loci):
+        # single test case
+        if size * loci * moduleInfo()['alleleBits'] / 8 > 1e9:
+            return 0
+        t = timeit.Timer(
+            setup = 'from __main__ import Population\n'
+                'pop = Population(size=%d, loci=%d)\n'
+                'scratches = [pop.clone() for i in range(%d)]' % (size, loci, self.repeats),
+            stmt = 'pop.push(scratches.pop())')
+        return t.timeit(number=self.repeats)
+
 def analyze(test):
     '''Output performance statistics for a test
     '''
@@ -1335,29 +1419,29 @@ def analyze(test):
         pfRecords = [rec for rec in records if (rec[3], rec[4]) == pf]
         revs = list(set([rec[7] for rec in pfRecords]))
         revs.sort()
-        print test, pf[0], pf[1], revs
+        print(test, pf[0], pf[1], revs)
         numStat = len(pfRecords) - 9
         for stat in range(9, len(pfRecords[0])):
-            print 'STAT %2d' % (stat - 8),
+            print('STAT %2d' % (stat - 8), end=' ')
             # each stat, for different revisions, and type
-            for type in ['short', 'long', 'binary', 'mutant']:
-                print '|' if len(revs) < 4 else '\n %3s|' % type[0],
+            for type in ['short', 'long', 'binary', 'mutant', 'lineage']:
+                print('|' if len(revs) < 4 else '\n %3s|' % type[0], end=' ')
                 for rev in revs:
                     one = [rec for rec in pfRecords if rec[8] == type and rec[7] == rev]
                     if len(one) == 0:
-                        print '     ??',
+                        print('     ??', end=' ')
                     elif len(one) == 1:
                         if '.' in one[0][stat]:
-                            print '%7.2f' % float(one[0][stat]),
+                            print('%7.2f' % float(one[0][stat]), end=' ')
                         else:
-                            print '%7s' % (one[0][stat]),
+                            print('%7s' % (one[0][stat]), end=' ')
                     else:
                         if '.' in one[0][stat]:
-                            print '%17s' % ('(%7.2f - %7.2f)' % (min([float(x[stat]) for x in one]), max([float(x[stat]) for x in one]))),
+                            print('%17s' % ('(%7.2f - %7.2f)' % (min([float(x[stat]) for x in one]), max([float(x[stat]) for x in one]))), end=' ')
                         else:
-                            print '%17s' % ('(%d - %d)' % (min([int(x[stat]) for x in one]), max([int(x[stat]) for x in one]))),
-            print
-        print
+                            print('%17s' % ('(%d - %d)' % (min([int(x[stat]) for x in one]), max([int(x[stat]) for x in one]))), end=' ')
+            print()
+        print()
       
 if __name__ == '__main__':
     # 
@@ -1393,15 +1477,22 @@ if __name__ == '__main__':
     elif '-m' in sys.argv:
         alleleType = 'mutant'
         sys.argv.remove('-m')
+    elif '-n' in sys.argv:
+        alleleType = 'lineage'
+        sys.argv.remove('-n')
     #
     if alleleType == 'all':
-        for t in ['s', 'l', 'b', 'm']:
+        for t in ['s', 'l', 'b', 'm', 'n']:
             ret = subprocess.call([sys.executable, sys.argv[0], '-%s' % t] + sys.argv[1:])
             if ret != 0:  # if crash or killed
-                print 'Error: A non-zero return value is returned for module %s' % t
+                print('Error: A non-zero return value is returned for module %s' % t)
                 sys.exit(ret)
         sys.exit(0)
     #    
+    if '-json' in sys.argv:
+        sys.argv.remove('-json')
+        jsonOutput = 'performance.json'
+    #
     numThreads = None
     if '-j' in sys.argv:
         idx = sys.argv.index('-j')
@@ -862,6 +862,66 @@ class TestPopulation(unittest.TestCase):
         for idx,ind in enumerate(pop.individuals()):
             self.assertEqual(ind.lineage(), range((idx*2+1)*20, (idx*2+2)*20))
 
+    def testKeepIndividuals(self):
+        'Testing Population::keepIndividuals(inds)'
+        pop = self.getPop(size=[20, 100, 30], subPopNames=['sp1', 'sp2', 'sp3'])
+        pop1 = pop.clone()
+        inds = list(range(15)) + list(range(30, 40))
+        random.shuffle(inds)
+        pop.keepIndividuals(inds)
+        # keeping is the mirror image of removing everyone else
+        pop2 = pop1.clone()
+        pop2.removeIndividuals([x for x in range(150) if x not in inds])
+        self.assertEqual(pop, pop2)
+        self.assertEqual(pop.subPopSizes(), (15, 10, 0))
+        # empty subpopulations and their names survive
+        self.assertEqual(pop.subPopNames(), pop1.subPopNames())
+        for idx in range(15):
+            self.assertEqual(pop1.individual(idx), pop.individual(idx))
+        for idx in range(15, 25):
+            self.assertEqual(pop1.individual(idx + 15), pop.individual(idx))
+        # pop.keepIndividuals([]) should not change anything
+        pop = pop1.clone()
+        pop.keepIndividuals([])
+        self.assertEqual(pop, pop1)
+        pop.keepIndividuals(2)
+        self.assertEqual(pop.popSize(), 1)
+        self.assertEqual(pop.individual(0), pop1.individual(2))
+        pop = pop1.clone()
+        self.assertRaises(IndexError, pop.keepIndividuals, 500)
+        #
+        # by ID, applied to all ancestral generations
+        pop = self.getPop(size=[100, 200], loci=[2, 3, 1], ancGen=5,
+            infoFields=['ind_id'])
+        IdTagger().reset(1)
+        tagID(pop)
+        kept = set([random.randint(1, 1800) for x in range(600)])
+        pop1 = pop.clone()
+        pop1.keepIndividuals(IDs=list(kept))
+        sz1 = 0
+        for gen in range(6):
+            pop.useAncestralGen(gen)
+            pop1.useAncestralGen(gen)
+            sz1 += pop1.popSize()
+            for ind in pop1.individuals():
+                self.assertEqual(ind.ind_id in kept, True)
+                self.assertEqual(ind, pop.indByID(ind.ind_id), gen)
+        # IDs are unique, so each kept ID survives exactly once
+        self.assertEqual(sz1, len(kept))
+        pop.useAncestralGen(0)
+        # keep multiple individuals that share an info value
+        pop = Population(10, infoFields='x')
+        pop.setIndInfo([1, 2, 2, 3, 4, 5, 2, 3, 4, 3], 'x')
+        pop.keepIndividuals(IDs=2, idField='x')
+        self.assertEqual(pop.popSize(), 3)
+        self.assertEqual(pop.indInfo('x'), (2, 2, 2))
+        # by filter function
+        pop = Population(10, infoFields='x')
+        pop.setIndInfo([1, 2, 2, 3, 4, 5, 2, 3, 4, 3], 'x')
+        pop.keepIndividuals(filter=lambda ind: ind.x in [3, 4])
+        self.assertEqual(pop.popSize(), 5)
+        self.assertEqual(pop.indInfo('x'), (3, 4, 3, 4, 3))
+
     def testExtractSubPops(self):
         'Testing Population::extractSubPops()'
         pop = self.getPop(size=[0, 100, 0, 20, 30, 0, 50], subPopNames=['A', 'B', 'C', 'D', 'E', 'F', 'G'])
@@ -1789,6 +1849,107 @@ class TestPopulation(unittest.TestCase):
         IDs = pop.identifyOffspring(anc)
         len(IDs) > 20
 
+    def testToBytes(self):
+        'Testing Population::toBytes(), fromBytes(data) and pickling'
+        pop = self.getPop(ancGen=3, infoFields=['a', 'b'])
+        for gen in range(pop.ancestralGens(), -1, -1):
+            pop.useAncestralGen(gen)
+            initGenotype(pop, freq=[0.3, 0.7])
+            initSex(pop)
+        pop.useAncestralGen(0)
+        stat(pop, alleleFreq=[0])
+        data = pop.toBytes()
+        self.assertEqual(type(data), bytes)
+        pop1 = Population()
+        pop1.fromBytes(data)
+        for gen in range(pop.ancestralGens(), -1, -1):
+            pop.useAncestralGen(gen)
+            pop1.useAncestralGen(gen)
+            self.assertEqual(pop, pop1)
+            self.assertEqual(pop.indInfo('a'), pop1.indInfo('a'))
+        # population variables travel with the bytes object
+        self.assertEqual(pop.dvars().alleleFreq[0][1],
+            pop1.dvars().alleleFreq[0][1])
+        # garbage is rejected without changing the population
+        self.assertRaises(ValueError, pop1.fromBytes, b'not a population')
+        self.assertEqual(pop, pop1)
+        # pickle and deep copy go through the same path
+        import pickle
+        pop2 = pickle.loads(pickle.dumps(pop))
+        self.assertEqual(pop, pop2)
+        self.assertEqual(pop2.ancestralGens(), pop.ancestralGens())
+        pop3 = copy.deepcopy(pop)
+        self.assertEqual(pop, pop3)
+
+    def testRelease(self):
+        'Testing Population::release()'
+        pop = self.getPop(size=100)
+        pop1 = pop.clone()
+        pop2 = pop.release()
+        self.assertEqual(pop1, pop2)
+        # the source is left as a newly created empty population
+        self.assertEqual(pop.popSize(), 0)
+        self.assertEqual(pop.totNumLoci(), 0)
+
+    def testKinship(self):
+        'Testing Pedigree::kinship'
+        # a hand-built three generation pedigree: founders 1 and 2, full
+        # sibs 3 and 4, and inbred individual 5 with parents 3 and 4
+        pop = Population(2, infoFields=['ind_id', 'father_id', 'mother_id'])
+        pop.setIndInfo([1, 2], 'ind_id')
+        pop.individual(0).setSex(MALE)
+        pop.individual(1).setSex(FEMALE)
+        pop.setAncestralDepth(2)
+        pop1 = Population(2, infoFields=['ind_id', 'father_id', 'mother_id'])
+        pop1.setIndInfo([3, 4], 'ind_id')
+        pop1.setIndInfo([1, 1], 'father_id')
+        pop1.setIndInfo([2, 2], 'mother_id')
+        pop1.individual(0).setSex(MALE)
+        pop1.individual(1).setSex(FEMALE)
+        pop.push(pop1)
+        pop2 = Population(1, infoFields=['ind_id', 'father_id', 'mother_id'])
+        pop2.setIndInfo([5], 'ind_id')
+        pop2.setIndInfo([3], 'father_id')
+        pop2.setIndInfo([4], 'mother_id')
+        pop.push(pop2)
+        ped = Pedigree(pop, infoFields=ALL_AVAIL)
+        k = ped.kinship(IDs=[1, 2, 3, 4, 5])
+        # unrelated, non-inbred founders
+        self.assertEqual(k[0][0], 0.5)
+        self.assertEqual(k[1][1], 0.5)
+        self.assertEqual(k[0][1], 0)
+        # parent-offspring and full sibs
+        self.assertEqual(k[0][2], 0.25)
+        self.assertEqual(k[1][3], 0.25)
+        self.assertEqual(k[2][3], 0.25)
+        # offspring of full sibs is inbred
+        self.assertEqual(k[4][4], 0.625)
+        self.assertEqual(k[2][4], 0.375)
+        self.assertEqual(k[0][4], 0.25)
+        # the matrix is symmetric
+        for i in range(5):
+            for j in range(5):
+                self.assertEqual(k[i][j], k[j][i])
+        # by default, the present generation
+        self.assertEqual(ped.kinship(), [[0.625]])
+        # a small cutoff removes no relationship but returns a sparse
+        # dictionary of related pairs
+        sparse = ped.kinship(IDs=[1, 2, 3, 4, 5], cutoff=0.01)
+        self.assertEqual(len(sparse), 14)
+        for (id1, id2), f in sparse.items():
+            self.assertTrue(id1 <= id2)
+            self.assertEqual(f, k[int(id1) - 1][int(id2) - 1])
+        self.assertEqual((1, 2) in sparse, False)
+        # parents missing from the pedigree are treated as founders, but
+        # shared parent IDs still relate their offspring
+        pop.keepAncestralGens([0, 1])
+        ped = Pedigree(pop, infoFields=ALL_AVAIL)
+        k = ped.kinship(IDs=[3, 4, 5])
+        self.assertEqual(k[0][1], 0.25)
+        self.assertEqual(k[2][2], 0.625)
+        # an unknown ID is an error
+        self.assertRaises(IndexError, ped.kinship, IDs=[1, 3])
+
     def testDescribeEvolProcess(self):
         'Testing population::evolve(dryrun=True'
         pop = Population(100, loci=3)
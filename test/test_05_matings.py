@@ -833,6 +833,48 @@ class TestMatingSchemes(unittest.TestCase):
                     ]),
             gen=100)
 
+    def testMixedMating(self):
+        'Test MixedMating'
+        def homoPop(size):
+            # half of the parents homozygous wildtype, half homozygous
+            # mutant, so that any outcross between the two types yields a
+            # heterozygote while selfing preserves homozygosity
+            pop = Population(size, loci=1)
+            for idx, ind in enumerate(pop.individuals()):
+                ind.setGenotype([idx % 2])
+            return pop
+        # pure selfing never creates a heterozygote
+        pop = homoPop(1000)
+        pop.evolve(
+            matingScheme=MixedMating(probOfSelfing=1),
+            gen=5)
+        stat(pop, heteroFreq=[0])
+        self.assertEqual(pop.dvars().heteroFreq[0], 0)
+        # pure outcrossing pairs the two types half of the time
+        pop = homoPop(10000)
+        pop.evolve(
+            matingScheme=MixedMating(probOfSelfing=0),
+            gen=1)
+        stat(pop, heteroFreq=[0])
+        self.assertTrue(pop.dvars().heteroFreq[0] > 0.4)
+        self.assertTrue(pop.dvars().heteroFreq[0] < 0.6)
+        # half of the families are selfed
+        pop = homoPop(10000)
+        pop.evolve(
+            matingScheme=MixedMating(probOfSelfing=0.5),
+            gen=1)
+        stat(pop, heteroFreq=[0])
+        self.assertTrue(pop.dvars().heteroFreq[0] > 0.17)
+        self.assertTrue(pop.dvars().heteroFreq[0] < 0.33)
+        # demographic parameters and empty subpopulations are handled by
+        # the common MatingScheme machinery
+        pop = Population([2000, 4000, 0], loci=1)
+        pop.evolve(
+            matingScheme=MixedMating(probOfSelfing=0.3,
+                subPopSize=[1000, 3000, 0]),
+            gen=1)
+        self.assertEqual(pop.subPopSizes(), (1000, 3000, 0))
+
 if __name__ == '__main__':
     unittest.main()
     sys.exit(0)
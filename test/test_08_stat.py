@@ -451,17 +451,40 @@ class TestStat(unittest.TestCase):
         self.assertEqual(pop.dvars().maxOfInfo['y'], 10)
         self.assertEqual(pop.dvars().minOfInfo['y'], 4)
         #
+        # median, defined as the larger of the two middle values for an
+        # even number of individuals
+        pop = Population(size=[4, 6], infoFields='x')
+        pop.setIndInfo([5, 1, 3, 9], field='x', subPop=0)
+        pop.setIndInfo([2, 8, 4, 6, 10, 12], field='x', subPop=1)
+        stat(pop, medianOfInfo='x', vars=['medianOfInfo', 'medianOfInfo_sp'])
+        self.assertEqual(pop.dvars().medianOfInfo['x'], 6)
+        self.assertEqual(pop.dvars(0).medianOfInfo['x'], 5)
+        self.assertEqual(pop.dvars(1).medianOfInfo['x'], 8)
+        # odd number of individuals, the unique middle value
+        pop = Population(size=5, infoFields='x')
+        pop.setIndInfo([7, 1, 3, 9, 5], field='x')
+        stat(pop, medianOfInfo='x')
+        self.assertEqual(pop.dvars().medianOfInfo['x'], 5)
+        # median of a virtual subpopulation
+        pop = Population(size=10, infoFields='x')
+        initSex(pop, sex=[MALE, FEMALE])
+        pop.setVirtualSplitter(SexSplitter())
+        pop.setIndInfo(range(10), field='x')
+        stat(pop, medianOfInfo='x', subPops=[(0, 0)])
+        self.assertEqual(pop.dvars().medianOfInfo['x'], 4)
+        #
         # test cases with NO item, so mean, min, max etc should return None
         # 
         # Before 1.1.3, this results in seg dump
         pop = Population(size=[500, 0, 1000], infoFields=['x', 'y', 'z'])
         initSex(pop, sex=[MALE, FEMALE])
         stat(pop, meanOfInfo='x', minOfInfo='x', maxOfInfo='x', varOfInfo='x',
-            subPops=1)
+            medianOfInfo='x', subPops=1)
         self.assertEqual(pop.dvars().meanOfInfo['x'], None)
         self.assertEqual(pop.dvars().varOfInfo['x'], None)
         self.assertEqual(pop.dvars().minOfInfo['x'], None)
         self.assertEqual(pop.dvars().maxOfInfo['x'], None)
+        self.assertEqual(pop.dvars().medianOfInfo['x'], None)
 
 
     def testFst(self):
@@ -68,6 +68,44 @@ class TestQuanTrait(unittest.TestCase):
             return random.normalvariate(0, 0.5*sum(geno) ), 1
         pyQuanTrait(pop, loci=[2,6], func=qt1, infoFields=['qtrait1', 'qtrait2'])
 
+    def testAdditiveQuanTrait(self):
+        'Testing the additive quantitative trait operator'
+        # trait values follow mutant dosage deterministically
+        additiveQuanTrait(self.pop, loci=[0], effects=[0.5], baseline=1,
+            infoFields='qtrait')
+        for ind in self.pop.individuals([0, 0]):
+            self.assertEqual(ind.qtrait, 1)
+        for ind in self.pop.individuals([0, 1]):
+            self.assertEqual(ind.qtrait, 1.5)
+        for ind in self.pop.individuals([0, 2]):
+            self.assertEqual(ind.qtrait, 2)
+        # multi-locus, summed over loci
+        pop = Population(1000, loci=[3, 5], infoFields='qtrait')
+        initGenotype(pop, freq=[.3, .7])
+        additiveQuanTrait(pop, loci=[2, 6], effects=[1, 10], infoFields='qtrait')
+        for ind in pop.individuals():
+            dosage2 = (ind.allele(2, 0) != 0) + (ind.allele(2, 1) != 0)
+            dosage6 = (ind.allele(6, 0) != 0) + (ind.allele(6, 1) != 0)
+            self.assertEqual(ind.qtrait, dosage2 + 10 * dosage6)
+        # one effect size is needed for each locus
+        self.assertRaises(ValueError, additiveQuanTrait, pop, loci=[2, 6],
+            effects=[1], infoFields='qtrait')
+        # during evolution, together with ancestral generations
+        pop = Population(1000, loci=[2], ancGen=2, infoFields='qtrait')
+        pop.evolve(
+            initOps=[InitSex(), InitGenotype(freq=[.5, .5])],
+            matingScheme=RandomMating(),
+            postOps=AdditiveQuanTrait(loci=ALL_AVAIL, effects=[2, 3],
+                ancGens=ALL_AVAIL, infoFields='qtrait'),
+            gen=3)
+        for gen in range(pop.ancestralGens() + 1):
+            pop.useAncestralGen(gen)
+            for ind in pop.individuals():
+                dosage = [(ind.allele(x, p) != 0) for x in [0, 1] for p in [0, 1]]
+                self.assertEqual(ind.qtrait,
+                    2 * (dosage[0] + dosage[1]) + 3 * (dosage[2] + dosage[3]))
+        pop.useAncestralGen(0)
+
     def testAncestralGen(self):
         'Testing parameter ancestralGen of qtrait... (FIXME)'
         # test the ancestralGen parameter of qtrait
@@ -73,5 +73,53 @@ class TestTerminator(unittest.TestCase):
             pop.dvars().alleleFreq[0][0] == 1, True)
 
 
+    def testTerminateIfFixed(self):
+        'Testing operator TerminateIfFixed that checks genotypes directly'
+        # a fixed population stops immediately
+        pop = Population(size=100, loci=[2])
+        initGenotype(pop, genotype=[1])
+        gens = pop.evolve(
+            matingScheme=RandomMating(),
+            postOps=TerminateIfFixed(),
+            gen=10)
+        self.assertEqual(gens, 1)
+        # a locus that still segregates keeps the evolution going
+        pop = Population(size=100, loci=[2])
+        initGenotype(pop, genotype=[1])
+        initGenotype(pop, freq=[0.5, 0.5], loci=1)
+        gens = pop.evolve(
+            initOps=InitSex(),
+            matingScheme=RandomMating(),
+            postOps=TerminateIfFixed(loci=[1]),
+            gen=10)
+        self.assertTrue(gens > 1)
+        stat(pop, alleleFreq=[1])
+        if gens < 10:
+            # stopped because locus 1 was fixed or lost
+            self.assertEqual(pop.dvars().alleleFreq[1][1] in (0, 1), True)
+        # the checked loci can exclude the segregating one
+        pop = Population(size=100, loci=[2])
+        initGenotype(pop, genotype=[1])
+        initGenotype(pop, freq=[0.5, 0.5], loci=1)
+        gens = pop.evolve(
+            initOps=InitSex(),
+            matingScheme=RandomMating(),
+            postOps=TerminateIfFixed(loci=[0]),
+            gen=10)
+        self.assertEqual(gens, 1)
+        # agreement with TerminateIf on alleleNum, and stopAll
+        pop = Population(size=50, loci=[1])
+        simu = Simulator(pop, rep=3)
+        gens = simu.evolve(
+            initOps=[InitSex(), InitGenotype(freq=[0.5, 0.5])],
+            matingScheme=RandomMating(),
+            postOps=TerminateIfFixed(stopAll=True))
+        # all replicates stopped at or before the first fixed one
+        for rep in range(3):
+            stat(simu.population(rep), alleleFreq=[0])
+        self.assertEqual(True in [
+            simu.population(rep).dvars().alleleFreq[0][0] in (0, 1)
+            for rep in range(3)], True)
+
 if __name__ == '__main__':
     unittest.main()
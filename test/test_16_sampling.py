@@ -122,6 +122,49 @@ class TestSampling(unittest.TestCase):
             for ind in s.individuals():
                 self.assertEqual(ind.sex(), MALE)
 
+    def testNativeRandomSample(self):
+        'Testing Population::randomSample(sizes)'
+        s = self.pop.randomSample(sizes=[100])
+        self.assertEqual(s.popSize(), 100)
+        self.assertEqual(s.ancestralGens(), 0)
+        # drawn without replacement, and identical to the sampled individuals
+        self.assertEqual(len(set(s.indInfo('oldindex'))), 100)
+        for ind in s.individuals():
+            self.assertEqual(ind, self.pop.individual(int(ind.oldindex)))
+        # one size per subpopulation
+        s = self.pop.randomSample(sizes=[20, 80])
+        self.assertEqual(s.subPopSizes(), (20, 80))
+        for sp in range(2):
+            for ind in s.individuals(sp):
+                self.assertEqual(self.pop.subPopIndPair(int(ind.oldindex))[0], sp)
+        # sizes larger than a subpopulation are reduced to it
+        s = self.pop.randomSample(sizes=[self.pop.subPopSize(0) + 100, 10])
+        self.assertEqual(s.subPopSizes(), (self.pop.subPopSize(0), 10))
+        # the population itself is not changed
+        self.assertEqual(self.pop.ancestralGens(), 1)
+
+    def testNativeCaseControlSample(self):
+        'Testing Population::caseControlSample(cases, controls)'
+        stat(self.pop, numOfAffected=True, vars=['numOfAffected', 'numOfAffected_sp'])
+        s = self.pop.caseControlSample(cases=[10], controls=[20])
+        self.assertEqual(s.popSize(), 30)
+        self.assertEqual(len(set(s.indInfo('oldindex'))), 30)
+        self.assertEqual(sum([ind.affected() for ind in s.individuals()]), 10)
+        for ind in s.individuals():
+            self.assertEqual(ind, self.pop.individual(int(ind.oldindex)))
+        # per-subpopulation counts keep the subpopulation structure
+        s = self.pop.caseControlSample(cases=[1, 2], controls=[5, 4])
+        self.assertEqual(s.subPopSizes(), (6, 6))
+        for sp, cases in enumerate([1, 2]):
+            self.assertEqual(
+                sum([ind.affected() for ind in s.individuals(sp)]), cases)
+            for ind in s.individuals(sp):
+                self.assertEqual(self.pop.subPopIndPair(int(ind.oldindex))[0], sp)
+        # requests beyond the number of affected individuals are reduced
+        s = self.pop.caseControlSample(
+            cases=[self.pop.dvars().numOfAffected + 10], controls=[0])
+        self.assertEqual(s.popSize(), self.pop.dvars().numOfAffected)
+
     def testCaseControlSample(self):
         'Testing case control sampling (incomplete)'
         # case control sampling.
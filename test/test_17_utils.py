@@ -1276,6 +1276,79 @@ class TestUtils(unittest.TestCase):
         # cleanup
         os.remove('pop.phy')
 
+    def writeVCF(self, filename, records, samples=3):
+        with open(filename, 'w') as vcf:
+            vcf.write('##fileformat=VCFv4.2\n')
+            vcf.write('\t'.join(['#CHROM', 'POS', 'ID', 'REF', 'ALT', 'QUAL',
+                'FILTER', 'INFO', 'FORMAT'] +
+                ['S%d' % x for x in range(samples)]) + '\n')
+            for rec in records:
+                vcf.write('\t'.join(rec) + '\n')
+
+    def testImportVCF(self):
+        'Testing import population from a file in VCF format'
+        self.writeVCF('pop.vcf', [
+            ['1', '100', 'rs1', 'A', 'T', '.', '.', '.', 'GT', '0|1', '1|1', '0|0'],
+            ['1', '200', 'rs2', 'G', 'C', '.', '.', '.', 'GT', '0/1', '1|0', './.'],
+            ['2', '50', 'rs3', 'C', 'G', '.', '.', '.', 'GT', '1|0', '0|0', '0|1'],
+        ])
+        pop = importPopulation(format='vcf', filename='pop.vcf')
+        self.assertEqual(pop.popSize(), 3)
+        self.assertEqual(pop.numSubPop(), 1)
+        self.assertEqual(pop.ploidy(), 2)
+        self.assertEqual(pop.numChrom(), 2)
+        self.assertEqual(pop.chromNames(), ('1', '2'))
+        self.assertEqual(pop.numLoci(), (2, 1))
+        self.assertEqual(pop.lociPos(), (100, 200, 50))
+        # record IDs are unique so they become loci names
+        self.assertEqual(pop.lociNames(), ('rs1', 'rs2', 'rs3'))
+        # allele calls, with missing calls imported as the reference allele
+        self.assertEqual(list(pop.individual(0).genotype()), [0, 0, 1, 1, 1, 0])
+        self.assertEqual(list(pop.individual(1).genotype()), [1, 1, 0, 1, 0, 0])
+        self.assertEqual(list(pop.individual(2).genotype()), [0, 0, 0, 0, 0, 1])
+        # records without an unique ID leave loci unnamed
+        self.writeVCF('pop.vcf', [
+            ['1', '100', '.', 'A', 'T', '.', '.', '.', 'GT', '0|1', '1|1', '0|0'],
+            ['1', '200', '.', 'G', 'C', '.', '.', '.', 'GT', '0|1', '1|0', '0|0'],
+        ])
+        pop = importPopulation(format='vcf', filename='pop.vcf')
+        self.assertEqual(pop.lociNames(), ())
+        # the ploidy is determined from the first genotype
+        self.writeVCF('pop.vcf', [
+            ['1', '100', 'rs1', 'A', 'T', '.', '.', '.', 'GT', '0', '1', '1'],
+        ])
+        pop = importPopulation(format='vcf', filename='pop.vcf')
+        self.assertEqual(pop.ploidy(), 1)
+        self.assertEqual(list(pop.genotype()), [0, 1, 1])
+        # gzip compressed input
+        import gzip, shutil
+        with open('pop.vcf', 'rb') as src, gzip.open('pop.vcf.gz', 'wb') as dst:
+            shutil.copyfileobj(src, dst)
+        pop1 = importPopulation(format='vcf', filename='pop.vcf.gz')
+        self.assertEqual(pop, pop1)
+        # multiple alternative alleles
+        self.writeVCF('pop.vcf', [
+            ['1', '100', 'rs1', 'A', 'T,C', '.', '.', '.', 'GT', '0|2', '1|1', '2|2'],
+        ])
+        if moduleInfo()['alleleType'] == 'binary':
+            # allele 2 does not fit a binary module
+            self.assertRaises(ValueError, importPopulation, format='vcf',
+                filename='pop.vcf')
+        else:
+            pop = importPopulation(format='vcf', filename='pop.vcf')
+            self.assertEqual(list(pop.genotype()), [0, 2, 1, 1, 2, 2])
+        # a file without sample or header is rejected
+        self.writeVCF('pop.vcf', [], samples=0)
+        self.assertRaises(ValueError, importPopulation, format='vcf',
+            filename='pop.vcf')
+        with open('pop.vcf', 'w') as vcf:
+            vcf.write('1\t100\trs1\tA\tT\t.\t.\t.\tGT\t0|1\n')
+        self.assertRaises(ValueError, importPopulation, format='vcf',
+            filename='pop.vcf')
+        # cleanup
+        os.remove('pop.vcf')
+        os.remove('pop.vcf.gz')
+
     def pyFunc(self, line):
         pass
 
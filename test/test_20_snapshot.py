@@ -0,0 +1,153 @@
+#!/usr/bin/env python
+#
+# Purpose:
+#  testing the binary snapshot format of Population::save and
+#  loadPopulation (filenames ending in '.bin'), including delta
+#  snapshots that reference a base snapshot.
+#
+# $LastChangedRevision$
+# $LastChangedDate$
+#
+
+import unittest, os, sys, random
+from simuOpt import setOptions
+setOptions(quiet=True)
+new_argv = []
+for arg in sys.argv:
+    if arg in ['short', 'long', 'binary', 'mutant', 'lineage']:
+        setOptions(alleleType = arg)
+    elif arg.startswith('-j'):
+        setOptions(numThreads = int(arg[2:]))
+    else:
+        new_argv.append(arg)
+
+sys.argv=new_argv
+from simuPOP import *
+
+class TestSnapshot(unittest.TestCase):
+
+    def getPop(self, size=[20, 80], loci=[1, 2], infoFields=['a', 'b'], ancGen=0):
+        pop = Population(size=size, ploidy=2, loci=loci, infoFields=infoFields,
+            ancGen=ancGen)
+        for gen in range(ancGen + 1):
+            initGenotype(pop, freq=[0.3, 0.7])
+            initSex(pop)
+            initInfo(pop, lambda:random.randint(0, 40), infoFields=infoFields)
+            if gen != ancGen:
+                pop.push(Population(size=size, ploidy=2, loci=loci,
+                    infoFields=infoFields))
+        return pop
+
+    def removeFiles(self, *files):
+        for file in files:
+            if os.path.isfile(file):
+                os.remove(file)
+
+    def testRoundTrip(self):
+        'Testing Population::save(filename) in the binary snapshot format'
+        pop = self.getPop(ancGen=3)
+        stat(pop, alleleFreq=list(range(pop.totNumLoci())))
+        a = pop.dvars().alleleFreq[0][1]
+        pop.save('snap.bin')
+        pop1 = loadPopulation('snap.bin')
+        for gen in range(pop.ancestralGens(), -1, -1):
+            pop.useAncestralGen(gen)
+            pop1.useAncestralGen(gen)
+            self.assertEqual(pop, pop1)
+            self.assertEqual(pop.indInfo('a'), pop1.indInfo('a'))
+            self.assertEqual(pop.indInfo('b'), pop1.indInfo('b'))
+        # population variables are part of the snapshot
+        self.assertEqual(a, pop1.dvars().alleleFreq[0][1])
+        self.removeFiles('snap.bin')
+
+    def testEmptyPopulation(self):
+        'Testing binary snapshots of populations without individuals or loci'
+        for pop in [Population(), Population(size=100),
+                Population(size=0, loci=[2, 3])]:
+            pop.save('snap.bin')
+            pop1 = loadPopulation('snap.bin')
+            self.assertEqual(pop, pop1)
+        self.removeFiles('snap.bin')
+
+    def testMonomorphicGenotype(self):
+        'Testing binary snapshots of entirely monomorphic populations'
+        # runs of identical genotype chunks are stored run-length encoded
+        for allele in [0, 1]:
+            pop = Population(size=[100, 100], loci=[60, 73])
+            initGenotype(pop, genotype=[allele])
+            pop.save('snap.bin')
+            pop1 = loadPopulation('snap.bin')
+            self.assertEqual(pop, pop1)
+            self.assertEqual(pop1.genotype(),
+                [allele] * (pop.popSize() * pop.totNumLoci() * 2))
+        self.removeFiles('snap.bin')
+
+    def testPartlyMonomorphicGenotype(self):
+        'Testing binary snapshots with monomorphic runs ending in mid-chunk'
+        # genotypes are chunked in units of 64 alleles, so use sizes and
+        # run lengths that are not multiples of 64
+        pop = Population(size=91, loci=[17])
+        geno = [1] * 97 + [random.randint(0, 1) for x in range(91 * 17 * 2 - 97)]
+        pop.setGenotype(geno)
+        pop.save('snap.bin')
+        pop1 = loadPopulation('snap.bin')
+        self.assertEqual(pop, pop1)
+        # a monomorphic run that reaches the (partial) last chunk
+        pop.setGenotype([random.randint(0, 1) for x in range(100)] + \
+            [1] * (91 * 17 * 2 - 100))
+        pop.save('snap.bin')
+        pop1 = loadPopulation('snap.bin')
+        self.assertEqual(pop, pop1)
+        self.removeFiles('snap.bin')
+
+    def testDeltaSnapshot(self):
+        'Testing Population::save(filename, base)'
+        pop = self.getPop(size=[200, 300], loci=[100], ancGen=2)
+        pop.save('base.bin')
+        # nothing changed, so all blob groups of the delta are references
+        pop.save('delta.bin', base='base.bin')
+        self.assertTrue(os.path.getsize('delta.bin') < os.path.getsize('base.bin'))
+        pop1 = loadPopulation('delta.bin')
+        self.assertEqual(pop, pop1)
+        # change the present generation; ancestral generations are still
+        # referenced but the changed generation has to be written in full
+        initGenotype(pop, freq=[0.7, 0.3])
+        pop.save('delta2.bin', base='delta.bin')
+        pop1 = loadPopulation('delta2.bin')
+        for gen in range(pop.ancestralGens(), -1, -1):
+            pop.useAncestralGen(gen)
+            pop1.useAncestralGen(gen)
+            self.assertEqual(pop, pop1)
+        pop.useAncestralGen(0)
+        # the chain delta2 -> delta -> base resolves across both levels
+        self.removeFiles('delta.bin')
+        self.assertRaises(ValueError, loadPopulation, 'delta2.bin')
+        # an overwritten base no longer carries the referenced digests
+        pop.save('delta.bin', base='base.bin')
+        Population(size=10, loci=[100]).save('base.bin')
+        self.assertRaises(ValueError, loadPopulation, 'delta.bin')
+        self.removeFiles('base.bin', 'delta.bin', 'delta2.bin')
+
+    def testDamagedSnapshot(self):
+        'Testing loading of truncated or corrupted snapshot files'
+        pop = self.getPop()
+        pop.save('snap.bin')
+        # a truncated header does not look like a snapshot (or any other
+        # population file)
+        with open('snap.bin', 'rb') as src:
+            head = src.read(12)
+        with open('trunc.bin', 'wb') as dst:
+            dst.write(head)
+        self.assertRaises(ValueError, loadPopulation, 'trunc.bin')
+        # garbage is rejected by the magic bytes of both formats
+        with open('trunc.bin', 'wb') as dst:
+            dst.write(b'this is not a simuPOP population file')
+        self.assertRaises(ValueError, loadPopulation, 'trunc.bin')
+        with open('trunc.bin', 'wb') as dst:
+            pass
+        self.assertRaises(ValueError, loadPopulation, 'trunc.bin')
+        self.removeFiles('snap.bin', 'trunc.bin')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python
+#
+# Purpose:
+#  testing the performance regression gate of simuPOP.perf (--ci and
+#  --record), with the subprocess runner stubbed out so that no real
+#  benchmark is executed.
+#
+# $LastChangedRevision$
+# $LastChangedDate$
+#
+
+import unittest, os, sys, io, json
+from simuOpt import setOptions
+setOptions(quiet=True)
+new_argv = []
+for arg in sys.argv:
+    if arg in ['short', 'long', 'binary', 'mutant', 'lineage']:
+        setOptions(alleleType = arg)
+    elif arg.startswith('-j'):
+        setOptions(numThreads = int(arg[2:]))
+    else:
+        new_argv.append(arg)
+
+sys.argv=new_argv
+from simuPOP import perf
+
+
+class TestPerfCI(unittest.TestCase):
+    '''exercise _runCI through perf.main with _runInSubprocess replaced
+    by a stub, so that the pass/fail decision of the gate can be pinned
+    without running (or even building) the real benchmark matrix.'''
+
+    baselineFile = 'perf_ci_test.json'
+
+    def setUp(self):
+        self.realRunner = perf._runInSubprocess
+        # result served for every cell: 5 generations in one second at
+        # 1000000 bytes of peak RSS, with one attributed phase
+        self.evolved = 5
+        self.elapsed = 1.0
+        self.rss = 1000000
+        self.phases = {'mating': 0.1}
+        def stub(scenario, module, optimized, scale, gens, profile=False):
+            result = ('%d %f %d' % (self.evolved, self.elapsed, self.rss)).split()
+            return result, self.phases if profile else {}, None
+        perf._runInSubprocess = stub
+        with open(self.baselineFile, 'w') as f:
+            json.dump({'budget': 5.0, 'scale': 0.01, 'gens': 5, 'cells': {}}, f)
+
+    def tearDown(self):
+        perf._runInSubprocess = self.realRunner
+        if os.path.isfile(self.baselineFile):
+            os.remove(self.baselineFile)
+
+    def runGate(self, record=False):
+        'run the gate quietly and return (exit code, printed report)'
+        argv = ['--ci', self.baselineFile] + (['--record'] if record else [])
+        out, sys.stdout = sys.stdout, io.StringIO()
+        try:
+            code = perf.main(argv)
+            return code, sys.stdout.getvalue()
+        finally:
+            sys.stdout = out
+
+    def testRecord(self):
+        'Testing that --record writes a baseline for every benchmark cell'
+        code, _ = self.runGate(record=True)
+        self.assertEqual(code, 0)
+        with open(self.baselineFile) as f:
+            baselines = json.load(f)
+        # one cell for every module that can run each scenario
+        keys = ['%s/%s' % (scenario, module)
+            for scenario in perf.SCENARIOS
+            for module in perf.SCENARIOS[scenario][2]]
+        self.assertEqual(sorted(baselines['cells']), sorted(keys))
+        for cell in baselines['cells'].values():
+            self.assertEqual(cell['gensPerSec'], self.evolved / self.elapsed)
+            self.assertEqual(cell['peakRSS'], self.rss)
+            self.assertEqual(cell['phases'], self.phases)
+
+    def testMissingBaseline(self):
+        'Testing that a cell without a recorded baseline fails the gate'
+        code, _ = self.runGate(record=True)
+        self.assertEqual(code, 0)
+        with open(self.baselineFile) as f:
+            baselines = json.load(f)
+        baselines['cells'].pop('randomMating/std')
+        with open(self.baselineFile, 'w') as f:
+            json.dump(baselines, f)
+        code, report = self.runGate()
+        self.assertEqual(code, 1)
+        self.assertIn('no baseline', report)
+
+    def testWithinBudget(self):
+        'Testing that changes within the budget pass the gate'
+        code, _ = self.runGate(record=True)
+        self.assertEqual(code, 0)
+        # 2% slower and 2% more memory, against a 5% budget
+        self.elapsed = 1.02
+        self.rss = 1020000
+        code, report = self.runGate()
+        self.assertEqual(code, 0)
+        self.assertNotIn('REGRESSED', report)
+
+    def testSpeedRegression(self):
+        'Testing that a gens/sec drop beyond the budget fails the gate'
+        code, _ = self.runGate(record=True)
+        self.assertEqual(code, 0)
+        self.elapsed = 2.0
+        code, report = self.runGate()
+        self.assertEqual(code, 1)
+        self.assertIn('REGRESSED', report)
+        self.assertIn('gens/sec', report)
+
+    def testMemoryRegression(self):
+        'Testing that peak RSS growth beyond the budget fails the gate'
+        code, _ = self.runGate(record=True)
+        self.assertEqual(code, 0)
+        self.rss = 2000000
+        code, report = self.runGate()
+        self.assertEqual(code, 1)
+        self.assertIn('REGRESSED', report)
+        self.assertIn('peak RSS', report)
+
+    def testFailedCell(self):
+        'Testing that a crashing benchmark cell fails the gate'
+        code, _ = self.runGate(record=True)
+        self.assertEqual(code, 0)
+        def stub(scenario, module, optimized, scale, gens, profile=False):
+            return None, None, 'MemoryError'
+        perf._runInSubprocess = stub
+        code, report = self.runGate()
+        self.assertEqual(code, 1)
+        self.assertIn('failed: MemoryError', report)
+
+
+if __name__ == '__main__':
+    unittest.main()